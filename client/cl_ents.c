@@ -199,36 +199,18 @@ Returns the entity number and the header bits
 */
 int bitcounts[32]; /// just for protocol profiling
 int CL_ParseEntityBits(unsigned *bits) {
-  unsigned b, total;
-  int i;
-  int number;
+  int i, number;
 
-  total = MSG_ReadByte(&net_message);
-  if(total & U_MOREBITS1) {
-    b = MSG_ReadByte(&net_message);
-    total |= b << 8;
-  }
-  if(total & U_MOREBITS2) {
-    b = MSG_ReadByte(&net_message);
-    total |= b << 16;
-  }
-  if(total & U_MOREBITS3) {
-    b = MSG_ReadByte(&net_message);
-    total |= b << 24;
-  }
+  if(cls.serverProtocol == PROTOCOL_VERSION)
+    return MSG_ReadPackedEntityBits(&net_message, bits);
+
+  number = MSG_ReadEntityBits(&net_message, bits);
 
   // count the bits for net profiling
   for(i = 0; i < 32; i++)
-    if(total & (1 << i))
+    if(*bits & (1 << i))
       bitcounts[i]++;
 
-  if(total & U_NUMBER16)
-    number = MSG_ReadShort(&net_message);
-  else
-    number = MSG_ReadByte(&net_message);
-
-  *bits = total;
-
   return number;
 }
 
@@ -246,71 +228,10 @@ void CL_ParseDelta(entity_state_t *from, entity_state_t *to, int number, int bit
   VectorCopy(from->origin, to->old_origin);
   to->number = number;
 
-  if(bits & U_MODEL)
-    to->modelindex = MSG_ReadByte(&net_message);
-  if(bits & U_MODEL2)
-    to->modelindex2 = MSG_ReadByte(&net_message);
-  if(bits & U_MODEL3)
-    to->modelindex3 = MSG_ReadByte(&net_message);
-  if(bits & U_MODEL4)
-    to->modelindex4 = MSG_ReadByte(&net_message);
-
-  if(bits & U_FRAME8)
-    to->frame = MSG_ReadByte(&net_message);
-  if(bits & U_FRAME16)
-    to->frame = MSG_ReadShort(&net_message);
-
-  if((bits & U_SKIN8) && (bits & U_SKIN16)) // used for laser colors
-    to->skinnum = MSG_ReadLong(&net_message);
-  else if(bits & U_SKIN8)
-    to->skinnum = MSG_ReadByte(&net_message);
-  else if(bits & U_SKIN16)
-    to->skinnum = MSG_ReadShort(&net_message);
-
-  if((bits & (U_EFFECTS8 | U_EFFECTS16)) == (U_EFFECTS8 | U_EFFECTS16))
-    to->effects = MSG_ReadLong(&net_message);
-  else if(bits & U_EFFECTS8)
-    to->effects = MSG_ReadByte(&net_message);
-  else if(bits & U_EFFECTS16)
-    to->effects = MSG_ReadShort(&net_message);
-
-  if((bits & (U_RENDERFX8 | U_RENDERFX16)) == (U_RENDERFX8 | U_RENDERFX16))
-    to->renderfx = MSG_ReadLong(&net_message);
-  else if(bits & U_RENDERFX8)
-    to->renderfx = MSG_ReadByte(&net_message);
-  else if(bits & U_RENDERFX16)
-    to->renderfx = MSG_ReadShort(&net_message);
-
-  if(bits & U_ORIGIN1)
-    to->origin[0] = MSG_ReadCoord(&net_message);
-  if(bits & U_ORIGIN2)
-    to->origin[1] = MSG_ReadCoord(&net_message);
-  if(bits & U_ORIGIN3)
-    to->origin[2] = MSG_ReadCoord(&net_message);
-
-  if(bits & U_ANGLE1)
-    to->angles[0] = MSG_ReadAngle(&net_message);
-  if(bits & U_ANGLE2)
-    to->angles[1] = MSG_ReadAngle(&net_message);
-  if(bits & U_ANGLE3)
-    to->angles[2] = MSG_ReadAngle(&net_message);
-
-  if(bits & U_OLDORIGIN)
-    MSG_ReadPos(&net_message, to->old_origin);
-
-  if(bits & U_SOUND)
-    to->sound = MSG_ReadByte(&net_message);
-
-  if(bits & U_EVENT)
-    to->event = MSG_ReadByte(&net_message);
+  if(cls.serverProtocol == PROTOCOL_VERSION)
+    MSG_ReadPackedDeltaEntity(&net_message, from, to, bits);
   else
-    to->event = 0;
-
-  if(bits & U_SOLID)
-    to->solid = MSG_ReadShort(&net_message);
-
-  if(bits & U_CMODEL_INDEX)
-    to->cmodel_index = MSG_ReadByte(&net_message);
+    MSG_ReadDeltaEntity(&net_message, to, bits);
 }
 
 /*
@@ -353,8 +274,13 @@ void CL_DeltaEntity(frame_t *frame, int newnum, entity_state_t *old, int bits) {
       VectorCopy(state->old_origin, ent->prev.origin);
       VectorCopy(state->old_origin, ent->lerp_origin);
     }
-  } else { // shuffle the last state to previous
+    ent->lerptime = cl.frame.servertime;
+  } else if(!VectorCompare(state->origin, ent->current.origin) || !VectorCompare(state->angles, ent->current.angles) ||
+            state->frame != ent->current.frame) {
+    // shuffle the last state to previous.  Above 10 Hz most frames don't
+    // move anything, those keep lerping from the last game frame
     ent->prev = ent->current;
+    ent->lerptime = cl.frame.servertime;
   }
 
   ent->serverframe = cl.frame.serverframe;
@@ -477,14 +403,13 @@ void CL_ParsePacketEntities(frame_t *oldframe, frame_t *newframe) {
 
 /*
 ===================
-CL_ParsePlayerstate
+CL_ParsePackedPlayerstate
+
+CL_ParsePlayerstate for PROTOCOL_VERSION
 ===================
 */
-void CL_ParsePlayerstate(frame_t *oldframe, frame_t *newframe) {
-  int flags;
+static void CL_ParsePackedPlayerstate(frame_t *oldframe, frame_t *newframe) {
   player_state_t *state;
-  int i;
-  int statbits;
 
   state = &newframe->playerstate;
 
@@ -494,100 +419,37 @@ void CL_ParsePlayerstate(frame_t *oldframe, frame_t *newframe) {
   else
     memset(state, 0, sizeof(*state));
 
-  flags = MSG_ReadShort(&net_message);
-
-  //
-  // parse the pmove_state_t
-  //
-  if(flags & PS_M_TYPE)
-    state->pmove.pm_type = MSG_ReadByte(&net_message);
-
-  if(flags & PS_M_ORIGIN) {
-    state->pmove.origin[0] = MSG_ReadShort(&net_message);
-    state->pmove.origin[1] = MSG_ReadShort(&net_message);
-    state->pmove.origin[2] = MSG_ReadShort(&net_message);
-  }
-
-  if(flags & PS_M_VELOCITY) {
-    state->pmove.velocity[0] = MSG_ReadShort(&net_message);
-    state->pmove.velocity[1] = MSG_ReadShort(&net_message);
-    state->pmove.velocity[2] = MSG_ReadShort(&net_message);
-  }
-
-  if(flags & PS_M_TIME)
-    state->pmove.pm_time = MSG_ReadByte(&net_message);
-
-  if(flags & PS_M_FLAGS)
-    state->pmove.pm_flags = MSG_ReadByte(&net_message);
-
-  if(flags & PS_M_GRAVITY)
-    state->pmove.gravity = MSG_ReadShort(&net_message);
-
-  if(flags & PS_M_DELTA_ANGLES) {
-    state->pmove.delta_angles[0] = MSG_ReadShort(&net_message);
-    state->pmove.delta_angles[1] = MSG_ReadShort(&net_message);
-    state->pmove.delta_angles[2] = MSG_ReadShort(&net_message);
-  }
+  MSG_ReadPackedPlayerstate(&net_message, state, (newframe->serverframe - newframe->deltaframe) * cl.frametime);
 
   if(cl.attractloop)
     state->pmove.pm_type = PM_FREEZE; // demo playback
+}
 
-  //
-  // parse the rest of the player_state_t
-  //
-  if(flags & PS_VIEWOFFSET) {
-    state->viewoffset[0] = MSG_ReadChar(&net_message) * 0.25;
-    state->viewoffset[1] = MSG_ReadChar(&net_message) * 0.25;
-    state->viewoffset[2] = MSG_ReadChar(&net_message) * 0.25;
-  }
-
-  if(flags & PS_VIEWANGLES) {
-    state->viewangles[0] = MSG_ReadAngle16(&net_message);
-    state->viewangles[1] = MSG_ReadAngle16(&net_message);
-    state->viewangles[2] = MSG_ReadAngle16(&net_message);
-  }
-
-  if(flags & PS_KICKANGLES) {
-    state->kick_angles[0] = MSG_ReadChar(&net_message) * 0.25;
-    state->kick_angles[1] = MSG_ReadChar(&net_message) * 0.25;
-    state->kick_angles[2] = MSG_ReadChar(&net_message) * 0.25;
-  }
-
-  if(flags & PS_WEAPONINDEX) {
-    state->gunindex = MSG_ReadByte(&net_message);
-  }
-
-  if(flags & PS_WEAPONFRAME) {
-    state->gunframe = MSG_ReadByte(&net_message);
-    state->gunoffset[0] = MSG_ReadChar(&net_message) * 0.25;
-    state->gunoffset[1] = MSG_ReadChar(&net_message) * 0.25;
-    state->gunoffset[2] = MSG_ReadChar(&net_message) * 0.25;
-    state->gunangles[0] = MSG_ReadChar(&net_message) * 0.25;
-    state->gunangles[1] = MSG_ReadChar(&net_message) * 0.25;
-    state->gunangles[2] = MSG_ReadChar(&net_message) * 0.25;
-  }
+/*
+===================
+CL_ParsePlayerstate
+===================
+*/
+void CL_ParsePlayerstate(frame_t *oldframe, frame_t *newframe) {
+  player_state_t *state;
 
-  if(flags & PS_BLEND) {
-    state->blend[0] = MSG_ReadByte(&net_message) / 255.0;
-    state->blend[1] = MSG_ReadByte(&net_message) / 255.0;
-    state->blend[2] = MSG_ReadByte(&net_message) / 255.0;
-    state->blend[3] = MSG_ReadByte(&net_message) / 255.0;
+  if(cls.serverProtocol == PROTOCOL_VERSION) {
+    CL_ParsePackedPlayerstate(oldframe, newframe);
+    return;
   }
 
-  if(flags & PS_FOV)
-    state->fov = MSG_ReadByte(&net_message);
+  state = &newframe->playerstate;
 
-  if(flags & PS_RDFLAGS)
-    state->rdflags = MSG_ReadByte(&net_message);
+  // clear to old value before delta parsing
+  if(oldframe)
+    *state = oldframe->playerstate;
+  else
+    memset(state, 0, sizeof(*state));
 
-  if(flags & PS_CMODEL_INDEX)
-    state->cmodel_index = MSG_ReadByte(&net_message);
+  MSG_ReadDeltaPlayerstate(&net_message, state);
 
-  // parse stats
-  statbits = MSG_ReadLong(&net_message);
-  for(i = 0; i < MAX_STATS; i++)
-    if(statbits & (1 << i))
-      state->stats[i] = MSG_ReadShort(&net_message);
+  if(cl.attractloop)
+    state->pmove.pm_type = PM_FREEZE; // demo playback
 }
 
 /*
@@ -630,7 +492,7 @@ void CL_ParseFrame(void) {
 
   cl.frame.serverframe = MSG_ReadLong(&net_message);
   cl.frame.deltaframe = MSG_ReadLong(&net_message);
-  cl.frame.servertime = cl.frame.serverframe * 100;
+  cl.frame.servertime = cl.frame.serverframe * cl.frametime;
 
   // BIG HACK to let old demos continue to work
   if(cls.serverProtocol != 26)
@@ -664,8 +526,8 @@ void CL_ParseFrame(void) {
   // clamp time
   if(cl.time > cl.frame.servertime)
     cl.time = cl.frame.servertime;
-  else if(cl.time < cl.frame.servertime - 100)
-    cl.time = cl.frame.servertime - 100;
+  else if(cl.time < cl.frame.servertime - cl.frametime)
+    cl.time = cl.frame.servertime - cl.frametime;
 
   // read areabits
   len = MSG_ReadByte(&net_message);
@@ -766,6 +628,30 @@ struct model_s *S_RegisterSexedModel(entity_state_t *ent, char *base) {
   return mdl;
 }
 
+/*
+===============
+CL_EntityLerpFrac
+
+How far an entity is from prev to current.  The game moves entities every
+GAME_FRAMEMSEC, so the move is spread over that rather than over one server
+frame, which above 10 Hz would make it a jump followed by a standstill.  At
+10 Hz this is cl.lerpfrac
+===============
+*/
+static float CL_EntityLerpFrac(centity_t *cent) {
+  float frac;
+
+  if(cl_timedemo->value)
+    return 1.0;
+
+  frac = (cl.time - cent->lerptime + cl.frametime) / (float)GAME_FRAMEMSEC;
+  if(frac < 0)
+    return 0;
+  if(frac > 1)
+    return 1;
+  return frac;
+}
+
 /*
 ===============
 CL_AddPacketEntities
@@ -782,6 +668,7 @@ void CL_AddPacketEntities(frame_t *frame) {
   int autoanim;
   clientinfo_t *ci;
   unsigned int effects, renderfx;
+  float lerpfrac;
 
   // bonus items rotate at a fixed rate
   autorotate = anglemod(cl.time / 10);
@@ -795,6 +682,7 @@ void CL_AddPacketEntities(frame_t *frame) {
     s1 = &cl_parse_entities[(frame->parse_entities + pnum) & (MAX_PARSE_ENTITIES - 1)];
 
     cent = &cl_entities[s1->number];
+    lerpfrac = CL_EntityLerpFrac(cent);
 
     effects = s1->effects;
     renderfx = s1->renderfx;
@@ -839,7 +727,7 @@ void CL_AddPacketEntities(frame_t *frame) {
     // pmm
     //======
     ent.oldframe = cent->prev.frame;
-    ent.backlerp = 1.0 - cl.lerpfrac;
+    ent.backlerp = 1.0 - lerpfrac;
 
     if(renderfx & (RF_FRAMELERP | RF_BEAM)) { // step origin discretely, because the frames
       // do the animation properly
@@ -848,7 +736,7 @@ void CL_AddPacketEntities(frame_t *frame) {
     } else { // interpolate origin
       for(i = 0; i < 3; i++) {
         ent.origin[i] = ent.oldorigin[i] =
-            cent->prev.origin[i] + cl.lerpfrac * (cent->current.origin[i] - cent->prev.origin[i]);
+            cent->prev.origin[i] + lerpfrac * (cent->current.origin[i] - cent->prev.origin[i]);
       }
     }
 
@@ -934,7 +822,7 @@ void CL_AddPacketEntities(frame_t *frame) {
       for(i = 0; i < 3; i++) {
         a1 = cent->current.angles[i];
         a2 = cent->prev.angles[i];
-        ent.angles[i] = LerpAngle(a2, a1, cl.lerpfrac);
+        ent.angles[i] = LerpAngle(a2, a1, lerpfrac);
       }
     }
 
@@ -1299,13 +1187,13 @@ void CL_AddEntities(void) {
       Com_Printf("high clamp %i\n", cl.time - cl.frame.servertime);
     cl.time = cl.frame.servertime;
     cl.lerpfrac = 1.0;
-  } else if(cl.time < cl.frame.servertime - 100) {
+  } else if(cl.time < cl.frame.servertime - cl.frametime) {
     if(cl_showclamp->value)
-      Com_Printf("low clamp %i\n", cl.frame.servertime - 100 - cl.time);
-    cl.time = cl.frame.servertime - 100;
+      Com_Printf("low clamp %i\n", cl.frame.servertime - cl.frametime - cl.time);
+    cl.time = cl.frame.servertime - cl.frametime;
     cl.lerpfrac = 0;
   } else
-    cl.lerpfrac = 1.0 - (cl.frame.servertime - cl.time) * 0.01;
+    cl.lerpfrac = 1.0 - (cl.frame.servertime - cl.time) / (float)cl.frametime;
 
   if(cl_timedemo->value)
     cl.lerpfrac = 1.0;
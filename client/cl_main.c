@@ -47,6 +47,8 @@ cvar_t *cl_autoskins;
 cvar_t *cl_footsteps;
 cvar_t *cl_timeout;
 cvar_t *cl_predict;
+cvar_t *cl_predictcache;
+cvar_t *cl_predictrecord;
 // cvar_t	*cl_minfps;
 cvar_t *cl_maxfps;
 cvar_t *cl_gun;
@@ -142,6 +144,7 @@ void CL_Stop_f(void) {
   fclose(cls.demofile);
   cls.demofile = NULL;
   cls.demorecording = false;
+  CL_StopPredictionRecord();
   Com_Printf("Stopped demo.\n");
 }
 
@@ -192,6 +195,9 @@ void CL_Record_f(void) {
   }
   cls.demorecording = true;
 
+  if(cl_predictrecord->value)
+    CL_StartPredictionRecord(Cmd_Argv(1));
+
   // don't start saving messages until a non-delta compressed message is received
   cls.demowaiting = true;
 
@@ -202,7 +208,7 @@ void CL_Record_f(void) {
 
   // send the serverdata
   MSG_WriteByte(&buf, svc_serverdata);
-  MSG_WriteLong(&buf, PROTOCOL_VERSION);
+  MSG_WriteLong(&buf, cls.serverProtocol); // the recorded frames are in it
   MSG_WriteLong(&buf, 0x10000 + cl.servercount);
   MSG_WriteByte(&buf, 1); // demos are always attract loops
   MSG_WriteString(&buf, cl.gamedir);
@@ -241,7 +247,10 @@ void CL_Record_f(void) {
     }
 
     MSG_WriteByte(&buf, svc_spawnbaseline);
-    MSG_WriteDeltaEntity(&nullstate, &cl_entities[i].baseline, &buf, true, true);
+    if(cls.serverProtocol == PROTOCOL_VERSION)
+      MSG_WritePackedDeltaEntity(&nullstate, &cl_entities[i].baseline, &buf, true, true);
+    else
+      MSG_WriteDeltaEntity(&nullstate, &cl_entities[i].baseline, &buf, true, true);
   }
 
   MSG_WriteByte(&buf, svc_stufftext);
@@ -544,6 +553,7 @@ void CL_ClearState(void) {
   // wipe the entire cl structure
   memset(&cl, 0, sizeof(cl));
   memset(&cl_entities, 0, sizeof(cl_entities));
+  cl.frametime = 100;
 
   SZ_Clear(&cls.netchan.message);
 }
@@ -1336,6 +1346,8 @@ void CL_InitLocal(void) {
   cl_noskins = Cvar_Get("cl_noskins", "0", 0);
   cl_autoskins = Cvar_Get("cl_autoskins", "0", 0);
   cl_predict = Cvar_Get("cl_predict", "1", 0);
+  cl_predictcache = Cvar_Get("cl_predictcache", "1", 0);
+  cl_predictrecord = Cvar_Get("cl_predictrecord", "0", 0);
   //	cl_minfps = Cvar_Get ("cl_minfps", "5", 0);
   cl_maxfps = Cvar_Get("cl_maxfps", "90", 0);
 
@@ -1604,11 +1616,9 @@ void CL_Frame(int msec) {
     CL_PrepRefresh();
 
   // update the screen
-  if(host_speeds->value)
-    time_before_ref = Sys_Milliseconds();
+  Prof_Begin("SCR_UpdateScreen");
   SCR_UpdateScreen();
-  if(host_speeds->value)
-    time_after_ref = Sys_Milliseconds();
+  Prof_End();
 
   // update audio
   S_Update(cl.refdef.vieworg, cl.v_forward, cl.v_right, cl.v_up);
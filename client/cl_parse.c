@@ -286,9 +286,8 @@ void CL_ParseServerData(void) {
   i = MSG_ReadLong(&net_message);
   cls.serverProtocol = i;
 
-  // BIG HACK to let demos from release work with the 3.0x patch!!!
-  if(Com_ServerState() && PROTOCOL_VERSION == 34) {
-  } else if(i != PROTOCOL_VERSION)
+  // servers and server demos still speak the old protocol to old clients
+  if(i != PROTOCOL_VERSION && i != PROTOCOL_VERSION_OLD)
     Com_Error(ERR_DROP, "Server returned version %i, not %i", i, PROTOCOL_VERSION);
 
   cl.servercount = MSG_ReadLong(&net_message);
@@ -489,6 +488,8 @@ void CL_ParseConfigString(void) {
 
   if(i >= CS_LIGHTS && i < CS_LIGHTS + MAX_LIGHTSTYLES)
     CL_SetLightstyle(i - CS_LIGHTS);
+  else if(i == CS_FRAMETIME)
+    cl.frametime = atoi(s) > 0 ? atoi(s) : 100;
   else if(i == CS_CDTRACK) {
     // if (cl.refresh_prepped)
     // 	CDAudio_Play (atoi(cl.configstrings[CS_CDTRACK]), true);
@@ -19,6 +19,16 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 */
 
 #include "client.h"
+#include "cl_pred.h"
+
+// Pmove's cache is indexed by the same command sequence as cl.cmds
+_Static_assert(PM_CACHE_SIZE == CMD_BACKUP, "PM_CACHE_SIZE must match CMD_BACKUP");
+
+static predrec_solid_t pred_solids[MAX_EDICTS]; // the solids of one frame
+static int pred_numsolids;
+static bool pred_recordedworld;
+static unsigned pred_recordworld;
+static int pred_recordsequence;
 
 /*
 ===================
@@ -173,6 +183,141 @@ int CL_PMpointcontents(int cmodel_index, vec3_t point) {
   return contents;
 }
 
+/*
+================
+CL_PredictionWorld
+
+Collects the entities CL_ClipMoveToEntities and CL_PMpointcontents
+collide with into pred_solids, and returns a hash of them.  Moves cached
+against one key are only reused while it stays the same.
+================
+*/
+static unsigned CL_PredictionWorld(int cmodel_index) {
+  int i, num;
+  entity_state_t *ent;
+  predrec_solid_t *solid;
+  const byte *b;
+  unsigned hash;
+
+  pred_numsolids = 0;
+  hash = 2166136261u ^ cmodel_index;
+
+  for(i = 0; i < cl.frame.num_entities; i++) {
+    num = (cl.frame.parse_entities + i) & (MAX_PARSE_ENTITIES - 1);
+    ent = &cl_parse_entities[num];
+
+    if(!ent->solid || ent->number == cl.playernum + 1 || ent->cmodel_index != cmodel_index)
+      continue;
+
+    solid = &pred_solids[pred_numsolids++];
+    solid->number = ent->number;
+    solid->solid = ent->solid;
+    VectorCopy(ent->origin, solid->origin);
+    if(ent->solid == 31) { // special value for bmodel
+      solid->modelindex = ent->modelindex;
+      solid->modelindex2 = ent->modelindex2;
+      VectorCopy(ent->angles, solid->angles);
+    } else { // a box doesn't care what it looks like or which way it faces
+      solid->modelindex = solid->modelindex2 = 0;
+      VectorClear(solid->angles);
+    }
+
+    for(b = (const byte *)solid; b < (const byte *)(solid + 1); b++)
+      hash = (hash ^ *b) * 16777619u;
+  }
+
+  return hash;
+}
+
+/*
+====================
+CL_StartPredictionRecord
+
+Opens demos/<demoname>.prd, see cl_pred.h
+====================
+*/
+void CL_StartPredictionRecord(const char *demoname) {
+  char name[MAX_OSPATH];
+  predrec_header_t header;
+  char *p;
+  int i;
+
+  Com_sprintf(name, sizeof(name), "%s/demos/%s.prd", FS_Gamedir(), demoname);
+  cls.predictfile = fopen(name, "wb");
+  if(!cls.predictfile) {
+    Com_Printf("ERROR: couldn't open %s.\n", name);
+    return;
+  }
+
+  memset(&header, 0, sizeof(header));
+  header.ident = PREDREC_IDENT;
+  header.version = PREDREC_VERSION;
+  for(i = 0; i < CMODEL_COUNT; i++) {
+    strncpy(header.maps[i], cl.configstrings[CS_MODELS + 1 + i], sizeof(header.maps[i]) - 1);
+    p = strchr(header.maps[i], ';');
+    if(p)
+      *p = 0;
+  }
+  fwrite(&header, sizeof(header), 1, cls.predictfile);
+
+  pred_recordedworld = false;
+  pred_recordsequence = cls.netchan.incoming_acknowledged;
+  Com_Printf("recording prediction to %s.\n", name);
+}
+
+void CL_StopPredictionRecord(void) {
+  byte type;
+
+  if(!cls.predictfile)
+    return;
+
+  type = PREDREC_END;
+  fwrite(&type, 1, 1, cls.predictfile);
+  fclose(cls.predictfile);
+  cls.predictfile = NULL;
+}
+
+static void CL_RecordPrediction(const pmove_t *pm, int ack, int current, unsigned world) {
+  predrec_world_t w;
+  predrec_cmd_t c;
+  predrec_predict_t p;
+  byte type;
+
+  if(!pred_recordedworld || world != pred_recordworld) {
+    type = PREDREC_WORLD;
+    w.world = world;
+    w.numsolids = pred_numsolids;
+    fwrite(&type, 1, 1, cls.predictfile);
+    fwrite(&w, sizeof(w), 1, cls.predictfile);
+    fwrite(pred_solids, sizeof(pred_solids[0]), pred_numsolids, cls.predictfile);
+    pred_recordedworld = true;
+    pred_recordworld = world;
+  }
+
+  // commands are written once, as they are first predicted
+  if(pred_recordsequence < ack)
+    pred_recordsequence = ack;
+  while(++pred_recordsequence < current) {
+    type = PREDREC_CMD;
+    c.sequence = pred_recordsequence;
+    c.cmd = cl.cmds[pred_recordsequence & (CMD_BACKUP - 1)];
+    fwrite(&type, 1, 1, cls.predictfile);
+    fwrite(&c, sizeof(c), 1, cls.predictfile);
+  }
+  pred_recordsequence = current - 1;
+
+  memset(&p, 0, sizeof(p));
+  type = PREDREC_PREDICT;
+  p.ack = ack;
+  p.current = current;
+  p.cmodel_index = pm->cmodel_index;
+  p.airaccelerate = pm_airaccelerate;
+  p.world = world;
+  p.s = pm->s;
+  fwrite(&type, 1, 1, cls.predictfile);
+  fwrite(&p, sizeof(p), 1, cls.predictfile);
+}
+
 /*
 =================
 CL_PredictMovement
@@ -184,11 +329,11 @@ void CL_PredictMovement(void) {
   int ack, current;
   int frame;
   int oldframe;
-  usercmd_t *cmd;
   pmove_t pm;
   int i;
   int step;
   int oldz;
+  unsigned world;
 
   if(cls.state != ca_active)
     return;
@@ -225,18 +370,20 @@ void CL_PredictMovement(void) {
 
   //	SCR_DebugGraph (current - ack - 1, 0);
 
-  frame = 0;
+  world = CL_PredictionWorld(pm.cmodel_index);
 
-  // run frames
-  while(++ack < current) {
-    frame = ack & (CMD_BACKUP - 1);
-    cmd = &cl.cmds[frame];
+  if(cls.predictfile)
+    CL_RecordPrediction(&pm, ack, current, world);
 
-    pm.cmd = *cmd;
-    Pmove(&pm);
+  // run frames, only the ones the cache doesn't already hold
+  if(!cl_predictcache->value)
+    cl.predict_cache.valid = false;
+  Pmove_Predict(&cl.predict_cache, &pm, cl.cmds, ack, current, world);
 
-    // save for debug checking
-    VectorCopy(pm.s.origin, cl.predicted_origins[frame]);
+  // save for debug checking
+  while(++ack < current) {
+    frame = ack & (CMD_BACKUP - 1);
+    VectorCopy(cl.predict_cache.states[frame].origin, cl.predicted_origins[frame]);
   }
 
   oldframe = (ack - 2) & (CMD_BACKUP - 1);
@@ -0,0 +1,69 @@
+/*
+Copyright (C) 1997-2001 Id Software, Inc.
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+// cl_pred.h -- prediction records
+//
+// With cl_predictrecord set, recording a demo also writes demos/<name>.prd,
+// everything CL_PredictMovement ran Pmove with: the commands, the states
+// the server acknowledged them with and the solid entities they were traced
+// against.  predict_bench replays it without a server or a renderer.
+//
+// The header is followed by records, each a type byte and its struct, in
+// host byte order.
+
+#define PREDREC_IDENT (('R' << 24) + ('D' << 16) + ('R' << 8) + 'P') // "PRDR"
+#define PREDREC_VERSION 1
+
+typedef struct {
+  int ident;
+  int version;
+  char maps[CMODEL_COUNT][MAX_QPATH]; // empty for unused cmodels
+} predrec_header_t;
+
+#define PREDREC_CMD 'c'     // predrec_cmd_t, once for each command sent
+#define PREDREC_WORLD 'w'   // predrec_world_t then its solids, when the key changes
+#define PREDREC_PREDICT 'p' // predrec_predict_t, each CL_PredictMovement
+#define PREDREC_END 'e'
+
+typedef struct {
+  int sequence;
+  usercmd_t cmd;
+} predrec_cmd_t;
+
+typedef struct {
+  unsigned world;
+  int numsolids;
+} predrec_world_t;
+
+// an entity the player collides with, also what the world key is a hash of
+typedef struct {
+  int number;
+  int solid; // 31 for an inline model, an encoded box otherwise
+  int modelindex, modelindex2;
+  vec3_t origin;
+  vec3_t angles; // zero for boxes
+} predrec_solid_t;
+
+typedef struct {
+  int ack, current;
+  int cmodel_index;
+  float airaccelerate;
+  unsigned world;
+  pmove_state_t s; // as the server acknowledged ack
+} predrec_predict_t;
@@ -463,7 +463,9 @@ void V_RenderView(float stereo_separation) {
           (int (*)(const void *, const void *))entitycmpfnc);
   }
 
+  Prof_Begin("R_RenderFrame");
   re.RenderFrame(&cl.refdef);
+  Prof_End();
   if(cl_stats->value)
     Com_Printf("ent:%i  lt:%i\n", r_numentities, r_numdlights);
   if(log_stats->value && (log_stats_file != 0))
@@ -75,6 +75,7 @@ typedef struct {
   entity_state_t prev; // will always be valid, but might just be a copy of current
 
   int serverframe; // if not current, this ent isn't in the frame
+  int lerptime;    // servertime the move from prev to current was received
 
   int trailcount;     // for diminishing grenade trails
   vec3_t lerp_origin; // for trails (variable hz)
@@ -119,6 +120,7 @@ typedef struct {
   usercmd_t cmds[CMD_BACKUP];             // each mesage will send several old cmds
   int cmd_time[CMD_BACKUP];               // time sent, for calculating pings
   short predicted_origins[CMD_BACKUP][3]; // for debug comparing against server
+  pmcache_t predict_cache;                // moves CL_PredictMovement can reuse
 
   float predicted_step; // for stair up smoothing
   unsigned predicted_step_time;
@@ -141,6 +143,7 @@ typedef struct {
   int time;       // this is the time value that the client
                   // is rendering at.  always <= cls.realtime
   float lerpfrac; // between oldframe and frame
+  int frametime;  // msec per server frame, from CS_FRAMETIME
 
   refdef_t refdef;
 
@@ -245,6 +248,7 @@ typedef struct {
   bool demorecording;
   bool demowaiting; // don't record until a non-delta message is received
   FILE *demofile;
+  FILE *predictfile; // cl_predictrecord, alongside demofile
 } client_static_t;
 
 extern client_static_t cls;
@@ -262,6 +266,8 @@ extern cvar_t *cl_add_blend;
 extern cvar_t *cl_add_lights;
 extern cvar_t *cl_add_entities;
 extern cvar_t *cl_predict;
+extern cvar_t *cl_predictcache;
+extern cvar_t *cl_predictrecord;
 extern cvar_t *cl_footsteps;
 extern cvar_t *cl_noskins;
 extern cvar_t *cl_autoskins;
@@ -312,10 +318,13 @@ typedef struct {
 extern centity_t cl_entities[MAX_EDICTS];
 extern cdlight_t cl_dlights[MAX_DLIGHTS];
 
-// the cl_parse_entities must be large enough to hold UPDATE_BACKUP frames of
-// entities, so that when a delta compressed message arives from the server
-// it can be un-deltad from the original
-#define MAX_PARSE_ENTITIES 1024
+// the cl_parse_entities must be large enough to hold UPDATE_BACKUP_MSEC of
+// frames at 100 Hz, so that when a delta compressed message arives from the
+// server it can be un-deltad from the original.  That is 160 frames of 64
+// entities, about 1.4 MB of entity_state_t against 88 KB for the 1024 a
+// 10 Hz server needs; deltas from further back are refused and the server
+// sends a full frame instead
+#define MAX_PARSE_ENTITIES 16384
 extern entity_state_t cl_parse_entities[MAX_PARSE_ENTITIES];
 
 //=============================================================================
@@ -578,6 +587,8 @@ void CL_DrawInventory(void);
 // cl_pred.c
 //
 void CL_PredictMovement(void);
+void CL_StartPredictionRecord(const char *demoname);
+void CL_StopPredictionRecord(void);
 
 // UI
 void UI_SetTexture(const char *name);
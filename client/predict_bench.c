@@ -0,0 +1,353 @@
+/*
+Copyright (C) 1997-2001 Id Software, Inc.
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+// predict_bench.c -- replays client prediction from a demo, no server or renderer
+//
+// usage: predict_bench <file.prd> <gamedir> [iterations]
+//
+// Record a demo with cl_predictrecord 1 to get the .prd next to it.  The
+// maps it names are read from under gamedir, so maps in a pak have to be
+// extracted first.  Every prediction is run once with the cache and once
+// without, both have to end in the same state, then each way is timed.
+// Reads the record on the host that wrote it.
+
+#include "../qcommon/qcommon.h"
+
+#include "cl_pred.h"
+
+#include <uv.h>
+
+// the collision model reads its maps straight from under gamedir
+void FS_Read(void *buffer, int len, FILE *f) {
+  if(fread(buffer, 1, len, f) != len)
+    Com_Error(ERR_FATAL, "FS_Read: short read");
+}
+
+static const char *gamedir;
+
+int FS_MapFile(const char *path, const void **data) {
+  char name[MAX_OSPATH];
+  FILE *file;
+  void *buf;
+  long len;
+
+  snprintf(name, sizeof(name), "%s/%s", gamedir, path);
+  file = fopen(name, "rb");
+  if(!file) {
+    *data = NULL;
+    return -1;
+  }
+  fseek(file, 0, SEEK_END);
+  len = ftell(file);
+  fseek(file, 0, SEEK_SET);
+  buf = malloc(len);
+  if(fread(buf, 1, len, file) != len)
+    Com_Error(ERR_FATAL, "couldn't read %s", name);
+  fclose(file);
+
+  *data = buf;
+  return len;
+}
+
+void FS_UnmapFile(const void *data) { free((void *)data); }
+
+typedef struct {
+  byte type;
+  int index; // into cmds, worlds or predicts
+} benchrecord_t;
+
+typedef struct {
+  int numsolids;
+  predrec_solid_t *solids;
+} benchworld_t;
+
+static cmodel_t *clip[CMODEL_COUNT][MAX_MODELS];
+
+static int numrecords, numcmds, numworlds, numpredicts;
+static benchrecord_t *records;
+static predrec_cmd_t *cmds;
+static benchworld_t *worlds;
+static predrec_predict_t *predicts;
+
+static const benchworld_t *world; // the one traces collide with
+
+/*
+================
+Bench_ClipMoveToSolids
+
+CL_ClipMoveToEntities over the recorded solids
+================
+*/
+static void Bench_ClipMoveToSolids(int cmodel_index, vec3_t start, vec3_t mins, vec3_t maxs, vec3_t end, trace_t *tr) {
+  int i, x, zd, zu;
+  trace_t trace;
+  int headnode;
+  predrec_solid_t *ent;
+  vec3_t bmins, bmaxs;
+
+  for(i = 0; i < world->numsolids; i++) {
+    ent = &world->solids[i];
+
+    if(ent->solid == 31) {
+      if(!clip[ent->modelindex - 1][ent->modelindex2])
+        continue;
+      headnode = clip[ent->modelindex - 1][ent->modelindex2]->headnode;
+    } else {
+      x = 8 * (ent->solid & 31);
+      zd = 8 * ((ent->solid >> 5) & 31);
+      zu = 8 * ((ent->solid >> 10) & 63) - 32;
+
+      bmins[0] = bmins[1] = -x;
+      bmaxs[0] = bmaxs[1] = x;
+      bmins[2] = -zd;
+      bmaxs[2] = zu;
+
+      headnode = CM_HeadnodeForBox(cmodel_index, bmins, bmaxs);
+    }
+
+    if(tr->allsolid)
+      return;
+
+    trace = CM_TransformedBoxTrace(cmodel_index, start, end, mins, maxs, headnode, MASK_PLAYERSOLID, ent->origin,
+                                   ent->angles);
+
+    if(trace.allsolid || trace.startsolid || trace.fraction < tr->fraction) {
+      trace.ent = (struct edict_s *)ent;
+      if(tr->startsolid) {
+        *tr = trace;
+        tr->startsolid = true;
+      } else
+        *tr = trace;
+    } else if(trace.startsolid)
+      tr->startsolid = true;
+  }
+}
+
+static trace_t Bench_PMTrace(int cmodel_index, vec3_t start, vec3_t mins, vec3_t maxs, vec3_t end) {
+  trace_t t;
+
+  t = CM_BoxTrace(cmodel_index, start, end, mins, maxs, 0, MASK_PLAYERSOLID);
+  if(t.fraction < 1.0)
+    t.ent = (struct edict_s *)1;
+
+  Bench_ClipMoveToSolids(cmodel_index, start, mins, maxs, end, &t);
+
+  return t;
+}
+
+static int Bench_PMpointcontents(int cmodel_index, vec3_t point) {
+  int i, contents;
+  predrec_solid_t *ent;
+
+  contents = CM_PointContents(cmodel_index, point, 0);
+
+  for(i = 0; i < world->numsolids; i++) {
+    ent = &world->solids[i];
+    if(ent->solid != 31 || !clip[ent->modelindex - 1][ent->modelindex2])
+      continue;
+
+    contents |= CM_TransformedPointContents(cmodel_index, point, clip[ent->modelindex - 1][ent->modelindex2]->headnode,
+                                            ent->origin, ent->angles);
+  }
+
+  return contents;
+}
+
+static void Bench_Read(FILE *file, void *data, int size) {
+  if(fread(data, 1, size, file) != size)
+    Com_Error(ERR_FATAL, "record ends early");
+}
+
+static void *Bench_Grow(void *list, int count, int size) {
+  if(count & (count - 1))
+    return list;
+  return realloc(list, (count ? count * 2 : 1) * size);
+}
+
+/*
+================
+Bench_LoadRecord
+
+Reads every record into memory and loads the maps the way
+CL_PrepRefresh does
+================
+*/
+static void Bench_LoadRecord(const char *name) {
+  predrec_header_t header;
+  predrec_world_t w;
+  benchworld_t *bw;
+  unsigned checksum;
+  char inline_name[16];
+  FILE *file;
+  byte type;
+  int i, k;
+
+  file = fopen(name, "rb");
+  if(!file)
+    Com_Error(ERR_FATAL, "couldn't open %s", name);
+
+  Bench_Read(file, &header, sizeof(header));
+  if(header.ident != PREDREC_IDENT || header.version != PREDREC_VERSION)
+    Com_Error(ERR_FATAL, "%s is not a version %i prediction record", name, PREDREC_VERSION);
+
+  for(i = 0; i < CMODEL_COUNT; i++) {
+    if(!header.maps[i][0])
+      continue;
+    clip[i][0] = CM_LoadMap(i, header.maps[i], true, &checksum);
+    for(k = 1; k < CM_NumInlineModels(i); k++) {
+      sprintf(inline_name, "*%i", k);
+      clip[i][k] = CM_InlineModel(i, inline_name);
+    }
+    printf("%s: %i inline models\n", header.maps[i], CM_NumInlineModels(i));
+  }
+
+  for(;;) {
+    Bench_Read(file, &type, 1);
+    if(type == PREDREC_END)
+      break;
+
+    records = Bench_Grow(records, numrecords, sizeof(*records));
+    records[numrecords].type = type;
+
+    switch(type) {
+    case PREDREC_CMD:
+      cmds = Bench_Grow(cmds, numcmds, sizeof(*cmds));
+      Bench_Read(file, &cmds[numcmds], sizeof(*cmds));
+      records[numrecords++].index = numcmds++;
+      break;
+    case PREDREC_WORLD:
+      Bench_Read(file, &w, sizeof(w));
+      worlds = Bench_Grow(worlds, numworlds, sizeof(*worlds));
+      bw = &worlds[numworlds];
+      bw->numsolids = w.numsolids;
+      bw->solids = malloc(w.numsolids * sizeof(*bw->solids) + 1);
+      Bench_Read(file, bw->solids, w.numsolids * sizeof(*bw->solids));
+      records[numrecords++].index = numworlds++;
+      break;
+    case PREDREC_PREDICT:
+      predicts = Bench_Grow(predicts, numpredicts, sizeof(*predicts));
+      Bench_Read(file, &predicts[numpredicts], sizeof(*predicts));
+      records[numrecords++].index = numpredicts++;
+      break;
+    default:
+      Com_Error(ERR_FATAL, "bad record type %i", type);
+    }
+  }
+
+  fclose(file);
+  printf("%i predictions, %i commands, %i solid entity sets\n", numpredicts, numcmds, numworlds);
+}
+
+/*
+================
+Bench_Run
+
+Replays every record, keeping the predicted states in results if it is
+not NULL.  Returns the number of Pmove calls.
+================
+*/
+static int Bench_Run(bool cache, pmove_t *results) {
+  usercmd_t ring[PM_CACHE_SIZE];
+  pmcache_t pmcache;
+  predrec_predict_t *p;
+  pmove_t pm;
+  int i, count;
+
+  memset(ring, 0, sizeof(ring));
+  memset(&pmcache, 0, sizeof(pmcache));
+  world = NULL;
+  count = 0;
+
+  for(i = 0; i < numrecords; i++) {
+    switch(records[i].type) {
+    case PREDREC_CMD:
+      ring[cmds[records[i].index].sequence & (PM_CACHE_SIZE - 1)] = cmds[records[i].index].cmd;
+      break;
+    case PREDREC_WORLD:
+      world = &worlds[records[i].index];
+      break;
+    case PREDREC_PREDICT:
+      p = &predicts[records[i].index];
+
+      // the same setup as CL_PredictMovement
+      memset(&pm, 0, sizeof(pm));
+      pm.cmodel_index = p->cmodel_index;
+      pm.trace = Bench_PMTrace;
+      pm.pointcontents = Bench_PMpointcontents;
+      pm_airaccelerate = p->airaccelerate;
+      pm.s = p->s;
+
+      if(!cache)
+        pmcache.valid = false;
+      count += Pmove_Predict(&pmcache, &pm, ring, p->ack, p->current, p->world);
+
+      if(results)
+        results[records[i].index] = pm;
+      break;
+    }
+  }
+
+  return count;
+}
+
+int main(int argc, char **argv) {
+  pmove_t *results[2];
+  int iterations, i, cache, count, mismatches;
+  uint64_t start, time[2];
+
+  if(argc < 3) {
+    printf("usage: predict_bench <file.prd> <gamedir> [iterations]\n");
+    return 1;
+  }
+
+  gamedir = argv[2];
+  iterations = argc > 3 ? atoi(argv[3]) : 10;
+  if(iterations < 1)
+    iterations = 1;
+
+  Bench_LoadRecord(argv[1]);
+
+  // the cache has to predict exactly what running every command does
+  for(cache = 0; cache < 2; cache++) {
+    results[cache] = calloc(numpredicts + 1, sizeof(pmove_t));
+    Bench_Run(cache, results[cache]);
+  }
+  mismatches = 0;
+  for(i = 0; i < numpredicts; i++) {
+    if(memcmp(results[0][i].s.origin, results[1][i].s.origin, sizeof(results[0][i].s.origin)) ||
+       memcmp(results[0][i].s.velocity, results[1][i].s.velocity, sizeof(results[0][i].s.velocity)) ||
+       results[0][i].s.pm_flags != results[1][i].s.pm_flags ||
+       !VectorCompare(results[0][i].viewangles, results[1][i].viewangles))
+      mismatches++;
+  }
+
+  printf("%i iterations, %i mismatches\n", iterations, mismatches);
+  printf("mode     pmoves/prediction  msec/iteration  usec/prediction\n");
+  for(cache = 0; cache < 2; cache++) {
+    start = uv_hrtime();
+    for(i = 0; i < iterations; i++)
+      count = Bench_Run(cache, NULL);
+    time[cache] = uv_hrtime() - start;
+
+    printf("%-8s %17.2f %15.3f %16.3f\n", cache ? "cache" : "full", (double)count / (numpredicts ? numpredicts : 1),
+           time[cache] / 1e6 / iterations, time[cache] / 1e3 / iterations / (numpredicts ? numpredicts : 1));
+  }
+
+  return 0;
+}
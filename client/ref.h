@@ -218,6 +218,11 @@ typedef struct {
   bool (*Vid_GetModeInfo)(int *width, int *height, int mode);
   void (*Vid_MenuInit)(void);
   void (*Vid_NewWindow)(int width, int height);
+
+  // worker threads for the CPU side of drawing
+  jobpool_t *(*Job_CreatePool)(int numthreads);
+  void (*Job_DestroyPool)(jobpool_t *pool);
+  void (*Job_Run)(jobpool_t *pool, jobfunc_t func, void *data);
 } refimport_t;
 
 // this is the only function actually exported at the linker level
@@ -1019,7 +1019,9 @@ void S_Update_(void) {
   if(endtime - soundtime > samps)
     endtime = soundtime + samps;
 
+  Prof_Begin("S_PaintChannels");
   S_PaintChannels(endtime);
+  Prof_End();
 
   SNDDMA_Submit();
 }
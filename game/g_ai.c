@@ -270,6 +270,44 @@ bool visible(edict_t *self, edict_t *other) {
   return false;
 }
 
+/*
+=============
+visible_batch
+
+visible() for several others at once, the sight lines are traced
+together.  Fills in visible[i] for each of others[i].
+=============
+*/
+#define MAX_VISIBLE_BATCH 32
+
+void visible_batch(edict_t *self, edict_t **others, int count, bool *visible) {
+  vec3_t starts[MAX_VISIBLE_BATCH];
+  vec3_t ends[MAX_VISIBLE_BATCH];
+  int which[MAX_VISIBLE_BATCH];
+  trace_t trace[MAX_VISIBLE_BATCH];
+  int i, j, n;
+
+  for(i = 0; i < count; i += MAX_VISIBLE_BATCH) {
+    n = 0;
+    for(j = i; j < count && j < i + MAX_VISIBLE_BATCH; j++) {
+      visible[j] = false;
+      if(self->s.cmodel_index != others[j]->s.cmodel_index)
+        continue;
+
+      VectorCopy(self->s.origin, starts[n]);
+      starts[n][2] += self->viewheight;
+      VectorCopy(others[j]->s.origin, ends[n]);
+      ends[n][2] += others[j]->viewheight;
+      which[n++] = j;
+    }
+
+    gi.tracebatch(self->s.cmodel_index, n, starts, ends, vec3_origin, vec3_origin, self, MASK_OPAQUE, trace);
+
+    for(j = 0; j < n; j++)
+      visible[which[j]] = trace[j].fraction == 1.0;
+  }
+}
+
 /*
 =============
 infront
@@ -340,7 +378,7 @@ void FoundTarget(edict_t *self) {
   self->monsterinfo.aiflags |= AI_COMBAT_POINT;
 
   // clear the targetname, that point is ours!
-  self->movetarget->targetname = NULL;
+  G_SetTargetname(self->movetarget, NULL);
   self->monsterinfo.pausetime = 0;
 
   // run for it
@@ -214,7 +214,7 @@ void Cmd_Give_f(edict_t *ent) {
   if(give_all || Q_stricmp(name, "Power Shield") == 0) {
     it = FindItem("Power Shield");
     it_ent = G_Spawn(ent->s.cmodel_index);
-    it_ent->classname = it->classname;
+    G_SetClassname(it_ent, it->classname);
     SpawnItem(it_ent, it);
     Touch_Item(it_ent, ent, NULL, NULL);
     if(it_ent->inuse)
@@ -260,7 +260,7 @@ void Cmd_Give_f(edict_t *ent) {
       ent->client->pers.inventory[index] += it->quantity;
   } else {
     it_ent = G_Spawn(ent->s.cmodel_index);
-    it_ent->classname = it->classname;
+    G_SetClassname(it_ent, it->classname);
     SpawnItem(it_ent, it);
     Touch_Item(it_ent, ent, NULL, NULL);
     if(it_ent->inuse)
@@ -1316,7 +1316,7 @@ void SP_func_water(edict_t *self) {
   if(self->wait == -1)
     self->spawnflags |= DOOR_TOGGLE;
 
-  self->classname = "func_door";
+  G_SetClassname(self, "func_door");
 
   gi.linkentity(self);
 }
@@ -1822,7 +1822,7 @@ void SP_func_door_secret(edict_t *ent) {
     ent->touch = door_touch;
   }
 
-  ent->classname = "func_door";
+  G_SetClassname(ent, "func_door");
 
   gi.linkentity(ent);
 }
@@ -71,19 +71,17 @@ FindItemByClassname
 
 ===============
 */
+static nametable_t item_classnames[MAX_ITEMS];
+static int num_item_classnames;
+
+static nametable_t item_pickupnames[MAX_ITEMS];
+static int num_item_pickupnames;
+
 gitem_t *FindItemByClassname(char *classname) {
   int i;
-  gitem_t *it;
-
-  it = itemlist;
-  for(i = 0; i < game.num_items; i++, it++) {
-    if(!it->classname)
-      continue;
-    if(!Q_stricmp(it->classname, classname))
-      return it;
-  }
 
-  return NULL;
+  i = G_FindName(item_classnames, num_item_classnames, classname, strlen(classname), true);
+  return i < 0 ? NULL : &itemlist[i];
 }
 
 /*
@@ -94,17 +92,9 @@ FindItem
 */
 gitem_t *FindItem(char *pickup_name) {
   int i;
-  gitem_t *it;
-
-  it = itemlist;
-  for(i = 0; i < game.num_items; i++, it++) {
-    if(!it->pickup_name)
-      continue;
-    if(!Q_stricmp(it->pickup_name, pickup_name))
-      return it;
-  }
 
-  return NULL;
+  i = G_FindName(item_pickupnames, num_item_pickupnames, pickup_name, strlen(pickup_name), true);
+  return i < 0 ? NULL : &itemlist[i];
 }
 
 //======================================================================
@@ -746,14 +736,14 @@ void Touch_Item(edict_t *ent, edict_t *other, cplane_t *plane, csurface_t *surf)
 
 //======================================================================
 
-static void drop_temp_touch(edict_t *ent, edict_t *other, cplane_t *plane, csurface_t *surf) {
+void drop_temp_touch(edict_t *ent, edict_t *other, cplane_t *plane, csurface_t *surf) {
   if(other == ent->owner)
     return;
 
   Touch_Item(ent, other, plane, surf);
 }
 
-static void drop_make_touchable(edict_t *ent) {
+void drop_make_touchable(edict_t *ent) {
   ent->touch = Touch_Item;
   if(deathmatch->value) {
     ent->nextthink = level.time + 29;
@@ -768,7 +758,7 @@ edict_t *Drop_Item(edict_t *ent, gitem_t *item) {
 
   dropped = G_Spawn(ent->s.cmodel_index);
 
-  dropped->classname = item->classname;
+  G_SetClassname(dropped, item->classname);
   dropped->item = item;
   dropped->spawnflags = DROPPED_ITEM;
   dropped->s.effects = item->world_model_flags;
@@ -1455,7 +1445,28 @@ void SP_item_health_mega(edict_t *self) {
   self->style = HEALTH_IGNORE_MAX | HEALTH_TIMED;
 }
 
-void InitItems(void) { game.num_items = sizeof(itemlist) / sizeof(itemlist[0]) - 1; }
+/*
+===============
+InitItems
+
+Counts the items and sorts their names for FindItem and FindItemByClassname
+===============
+*/
+void InitItems(void) {
+  int i;
+
+  game.num_items = sizeof(itemlist) / sizeof(itemlist[0]) - 1;
+
+  num_item_classnames = num_item_pickupnames = 0;
+  for(i = 0; i < game.num_items; i++) {
+    if(itemlist[i].classname)
+      item_classnames[num_item_classnames++] = (nametable_t){itemlist[i].classname, i};
+    if(itemlist[i].pickup_name)
+      item_pickupnames[num_item_pickupnames++] = (nametable_t){itemlist[i].pickup_name, i};
+  }
+  G_SortNames(item_classnames, num_item_classnames, true);
+  G_SortNames(item_pickupnames, num_item_pickupnames, true);
+}
 
 /*
 ===============
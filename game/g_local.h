@@ -631,7 +631,6 @@ struct field_value {
 
 typedef struct {
   char *name;
-  // int ofs;
   fieldtype_t type;
   int flags;
 
@@ -639,6 +638,8 @@ typedef struct {
   struct field_value (*get)(const edict_t *ent);
 
   void (*set_temp)(spawn_temp_t *ent, struct field_value value);
+
+  uintptr_t ofs; // pointer fields only, where savegames patch the struct
 } field_t;
 
 extern field_t fields[];
@@ -676,12 +677,18 @@ void Touch_Item(edict_t *ent, edict_t *other, cplane_t *plane, csurface_t *surf)
 bool KillBox(edict_t *ent);
 void G_ProjectSource(vec3_t point, vec3_t distance, vec3_t forward, vec3_t right, vec3_t result);
 edict_t *G_Find(int cmodel_index, edict_t *from, int fieldofs, char *match);
+edict_t *G_FindLinear(int cmodel_index, edict_t *from, int fieldofs, char *match);
+void G_SetClassname(edict_t *ent, char *classname);
+void G_SetTargetname(edict_t *ent, char *targetname);
+void G_UnlinkNames(edict_t *ent);
+void G_ClearNameIndex(void);
 edict_t *findradius(edict_t *from, vec3_t org, float rad);
 edict_t *G_PickTarget(int cmodel_index, char *targetname);
 void G_UseTargets(edict_t *ent, edict_t *activator);
 void G_SetMovedir(vec3_t angles, vec3_t movedir);
 
 void G_InitEdict(int cmodel_index, edict_t *e);
+void G_SpawnEntityHandle(edict_t *e);
 edict_t *G_Spawn(int cmodel_index);
 void G_FreeEdict(edict_t *e);
 
@@ -690,6 +697,14 @@ void G_TouchSolids(edict_t *ent);
 
 char *G_CopyString(char *in);
 
+typedef struct {
+  const char *name;
+  int index; // in the table the names came from
+} nametable_t;
+
+void G_SortNames(nametable_t *names, int count, bool nocase);
+int G_FindName(const nametable_t *names, int count, const char *key, int len, bool nocase);
+
 float *tv(float x, float y, float z);
 char *vtos(vec3_t v);
 
@@ -770,6 +785,7 @@ int range(edict_t *self, edict_t *other);
 void FoundTarget(edict_t *self);
 bool infront(edict_t *self, edict_t *other);
 bool visible(edict_t *self, edict_t *other);
+void visible_batch(edict_t *self, edict_t **others, int count, bool *visible);
 bool FacingIdeal(edict_t *self);
 
 //
@@ -855,6 +871,16 @@ void M_ChangeYaw(edict_t *ent);
 //
 void G_RunEntity(edict_t *ent);
 
+//
+// g_spawn.c
+//
+void ED_InitSpawnTables(void);
+
+//
+// g_save.c
+//
+void InitSaveTables(void);
+
 //
 // g_main.c
 //
@@ -1068,6 +1094,10 @@ struct edict_s {
   char *combattarget;
   edict_t *target_ent;
 
+  // G_Find index chains, only G_SetClassname and G_SetTargetname touch these
+  edict_t *classname_next, *targetname_next;
+  int classname_bucket, targetname_bucket; // bucket + 1, 0 when not indexed
+
   float speed, accel, decel;
   vec3_t movedir;
   vec3_t pos1, pos2;
@@ -209,7 +209,7 @@ edict_t *CreateTargetChangeLevel(char *map) {
   edict_t *ent;
 
   ent = G_Spawn(0);
-  ent->classname = "target_changelevel";
+  G_SetClassname(ent, "target_changelevel");
   Com_sprintf(level.nextmap, sizeof(level.nextmap), "%s", map);
   ent->map = level.nextmap;
   return ent;
@@ -387,7 +387,9 @@ void G_RunFrame(void) {
       continue;
     }
 
+    gi.ProfileBegin("G_RunEntity");
     G_RunEntity(ent);
+    gi.ProfileEnd();
   }
 
   // see if it is time to end a deathmatch
@@ -269,7 +269,7 @@ void ThrowDebris(edict_t *self, char *modelname, float speed, vec3_t origin) {
   chunk->nextthink = level.time + 5 + random() * 5;
   chunk->s.frame = 0;
   chunk->flags = 0;
-  chunk->classname = "debris";
+  G_SetClassname(chunk, "debris");
   chunk->takedamage = DAMAGE_YES;
   chunk->die = debris_die;
   gi.linkentity(chunk);
@@ -473,7 +473,7 @@ void SP_info_notnull(edict_t *self) {
 
 #define START_OFF 1
 
-static void light_use(edict_t *self, edict_t *other, edict_t *activator) {
+void light_use(edict_t *self, edict_t *other, edict_t *activator) {
   if(self->spawnflags & START_OFF) {
     gi.configstring(CS_LIGHTS + self->style, "m");
     self->spawnflags &= ~START_OFF;
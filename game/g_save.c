@@ -20,11 +20,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 #include "g_local.h"
 
-// #define Function(f) {#f, f}
-
-// mmove_t mmove_reloc;
-
-static void set_classname(edict_t *e, struct field_value value) { e->classname = value.string; }
+static void set_classname(edict_t *e, struct field_value value) { G_SetClassname(e, value.string); }
 static struct field_value get_classname(const edict_t *e) {
   return (struct field_value){.type = F_LSTRING, .string = e->classname};
 }
@@ -59,7 +55,7 @@ static struct field_value get_target(const edict_t *e) {
   return (struct field_value){.type = F_LSTRING, .string = e->target};
 }
 
-static void set_targetname(edict_t *e, struct field_value value) { e->targetname = value.string; }
+static void set_targetname(edict_t *e, struct field_value value) { G_SetTargetname(e, value.string); }
 static struct field_value get_targetname(const edict_t *e) {
   return (struct field_value){.type = F_LSTRING, .string = e->targetname};
 }
@@ -187,33 +183,8 @@ static struct field_value get_angle(const edict_t *e) {
   return (struct field_value){.type = F_ANGLEHACK, .floating = e->s.angles[1]};
 }
 
-// {"goalentity", FOFS(goalentity), F_EDICT, FFL_NOSPAWN}, {"movetarget", FOFS(movetarget), F_EDICT, FFL_NOSPAWN},
-// {"enemy", FOFS(enemy), F_EDICT, FFL_NOSPAWN}, {"oldenemy", FOFS(oldenemy), F_EDICT, FFL_NOSPAWN},
-// {"activator", FOFS(activator), F_EDICT, FFL_NOSPAWN}, {"groundentity", FOFS(groundentity), F_EDICT, FFL_NOSPAWN},
-// {"teamchain", FOFS(teamchain), F_EDICT, FFL_NOSPAWN}, {"teammaster", FOFS(teammaster), F_EDICT, FFL_NOSPAWN},
-// {"owner", FOFS(owner), F_EDICT, FFL_NOSPAWN}, {"mynoise", FOFS(mynoise), F_EDICT, FFL_NOSPAWN},
-// {"mynoise2", FOFS(mynoise2), F_EDICT, FFL_NOSPAWN}, {"target_ent", FOFS(target_ent), F_EDICT, FFL_NOSPAWN},
-// {"chain", FOFS(chain), F_EDICT, FFL_NOSPAWN},
-
-// {"prethink", FOFS(prethink), F_FUNCTION, FFL_NOSPAWN}, {"think", FOFS(think), F_FUNCTION, FFL_NOSPAWN},
-// {"blocked", FOFS(blocked), F_FUNCTION, FFL_NOSPAWN}, {"touch", FOFS(touch), F_FUNCTION, FFL_NOSPAWN},
-// {"use", FOFS(use), F_FUNCTION, FFL_NOSPAWN}, {"pain", FOFS(pain), F_FUNCTION, FFL_NOSPAWN},
-// {"die", FOFS(die), F_FUNCTION, FFL_NOSPAWN},
-
-// {"stand", FOFS(monsterinfo.stand), F_FUNCTION, FFL_NOSPAWN},
-// {"idle", FOFS(monsterinfo.idle), F_FUNCTION, FFL_NOSPAWN},
-// {"search", FOFS(monsterinfo.search), F_FUNCTION, FFL_NOSPAWN},
-// {"walk", FOFS(monsterinfo.walk), F_FUNCTION, FFL_NOSPAWN}, {"run", FOFS(monsterinfo.run), F_FUNCTION, FFL_NOSPAWN},
-// {"dodge", FOFS(monsterinfo.dodge), F_FUNCTION, FFL_NOSPAWN},
-// {"attack", FOFS(monsterinfo.attack), F_FUNCTION, FFL_NOSPAWN},
-// {"melee", FOFS(monsterinfo.melee), F_FUNCTION, FFL_NOSPAWN},
-// {"sight", FOFS(monsterinfo.sight), F_FUNCTION, FFL_NOSPAWN},
-// {"checkattack", FOFS(monsterinfo.checkattack), F_FUNCTION, FFL_NOSPAWN},
-// {"currentmove", FOFS(monsterinfo.currentmove), F_MMOVE, FFL_NOSPAWN},
-
-// {"endfunc", FOFS(moveinfo.endfunc), F_FUNCTION, FFL_NOSPAWN},
-
 static void set_item_spawn(edict_t *e, struct field_value value) { e->item = value.item; }
+static struct field_value get_item(const edict_t *e) { return (struct field_value){.type = F_ITEM, .item = e->item}; }
 
 // temp spawn vars -- only valid when the spawn function is called
 static void set_lip(spawn_temp_t *st, struct field_value value) { st->lip = value.integer; }
@@ -232,20 +203,20 @@ static void set_minpitch(spawn_temp_t *st, struct field_value value) { st->minpi
 static void set_maxpitch(spawn_temp_t *st, struct field_value value) { st->maxpitch = value.floating; }
 static void set_nextmap(spawn_temp_t *st, struct field_value value) { st->nextmap = value.string; }
 
-field_t fields[] = {{"classname", F_LSTRING, 0, set_classname, get_classname},
-                    {"model", F_LSTRING, 0, set_model, get_model},
+field_t fields[] = {{"classname", F_LSTRING, 0, set_classname, get_classname, .ofs = FOFS(classname)},
+                    {"model", F_LSTRING, 0, set_model, get_model, .ofs = FOFS(model)},
                     {"spawnflags", F_INT, 0, set_spawnflags, get_spawnflags},
                     {"speed", F_FLOAT, 0, set_speed, get_speed},
                     {"accel", F_FLOAT, 0, set_accel, get_accel},
                     {"decel", F_FLOAT, 0, set_decel, get_decel},
-                    {"target", F_LSTRING, 0, set_target, get_target},
-                    {"targetname", F_LSTRING, 0, set_targetname, get_targetname},
-                    {"pathtarget", F_LSTRING, 0, set_pathtarget, get_pathtarget},
-                    {"deathtarget", F_LSTRING, 0, set_deathtarget, get_deathtarget},
-                    {"killtarget", F_LSTRING, 0, set_killtarget, get_killtarget},
-                    {"combattarget", F_LSTRING, 0, set_combattarget, get_combattarget},
-                    {"message", F_LSTRING, 0, set_message, get_message},
-                    {"team", F_LSTRING, 0, set_team, get_team},
+                    {"target", F_LSTRING, 0, set_target, get_target, .ofs = FOFS(target)},
+                    {"targetname", F_LSTRING, 0, set_targetname, get_targetname, .ofs = FOFS(targetname)},
+                    {"pathtarget", F_LSTRING, 0, set_pathtarget, get_pathtarget, .ofs = FOFS(pathtarget)},
+                    {"deathtarget", F_LSTRING, 0, set_deathtarget, get_deathtarget, .ofs = FOFS(deathtarget)},
+                    {"killtarget", F_LSTRING, 0, set_killtarget, get_killtarget, .ofs = FOFS(killtarget)},
+                    {"combattarget", F_LSTRING, 0, set_combattarget, get_combattarget, .ofs = FOFS(combattarget)},
+                    {"message", F_LSTRING, 0, set_message, get_message, .ofs = FOFS(message)},
+                    {"team", F_LSTRING, 0, set_team, get_team, .ofs = FOFS(team)},
                     {"wait", F_FLOAT, 0, set_wait, get_wait},
                     {"delay", F_FLOAT, 0, set_delay, get_delay},
                     {"random", F_FLOAT, 0, set_random, get_random},
@@ -260,46 +231,48 @@ field_t fields[] = {{"classname", F_LSTRING, 0, set_classname, get_classname},
                     {"mass", F_INT, 0, set_mass, get_mass},
                     {"volume", F_FLOAT, 0, set_volume, get_volume},
                     {"attenuation", F_FLOAT, 0, set_attenuation, get_attenuation},
-                    {"map", F_LSTRING, 0, set_map, get_map},
+                    {"map", F_LSTRING, 0, set_map, get_map, .ofs = FOFS(map)},
                     {"origin", F_VECTOR, 0, set_origin, get_origin},
                     {"angles", F_VECTOR, 0, set_angles, get_angles},
                     {"angle", F_ANGLEHACK, 0, set_angle, get_angle},
 
-                    // {"goalentity", FOFS(goalentity), F_EDICT, FFL_NOSPAWN},
-                    // {"movetarget", FOFS(movetarget), F_EDICT, FFL_NOSPAWN},
-                    // {"enemy", FOFS(enemy), F_EDICT, FFL_NOSPAWN},
-                    // {"oldenemy", FOFS(oldenemy), F_EDICT, FFL_NOSPAWN},
-                    // {"activator", FOFS(activator), F_EDICT, FFL_NOSPAWN},
-                    // {"groundentity", FOFS(groundentity), F_EDICT, FFL_NOSPAWN},
-                    // {"teamchain", FOFS(teamchain), F_EDICT, FFL_NOSPAWN},
-                    // {"teammaster", FOFS(teammaster), F_EDICT, FFL_NOSPAWN},
-                    // {"owner", FOFS(owner), F_EDICT, FFL_NOSPAWN},
-                    // {"mynoise", FOFS(mynoise), F_EDICT, FFL_NOSPAWN},
-                    // {"mynoise2", FOFS(mynoise2), F_EDICT, FFL_NOSPAWN},
-                    // {"target_ent", FOFS(target_ent), F_EDICT, FFL_NOSPAWN},
-                    // {"chain", FOFS(chain), F_EDICT, FFL_NOSPAWN},
-
-                    // {"prethink", FOFS(prethink), F_FUNCTION, FFL_NOSPAWN},
-                    // {"think", FOFS(think), F_FUNCTION, FFL_NOSPAWN},
-                    // {"blocked", FOFS(blocked), F_FUNCTION, FFL_NOSPAWN},
-                    // {"touch", FOFS(touch), F_FUNCTION, FFL_NOSPAWN},
-                    // {"use", FOFS(use), F_FUNCTION, FFL_NOSPAWN},
-                    // {"pain", FOFS(pain), F_FUNCTION, FFL_NOSPAWN},
-                    // {"die", FOFS(die), F_FUNCTION, FFL_NOSPAWN},
-
-                    // {"stand", FOFS(monsterinfo.stand), F_FUNCTION, FFL_NOSPAWN},
-                    // {"idle", FOFS(monsterinfo.idle), F_FUNCTION, FFL_NOSPAWN},
-                    // {"search", FOFS(monsterinfo.search), F_FUNCTION, FFL_NOSPAWN},
-                    // {"walk", FOFS(monsterinfo.walk), F_FUNCTION, FFL_NOSPAWN},
-                    // {"run", FOFS(monsterinfo.run), F_FUNCTION, FFL_NOSPAWN},
-                    // {"dodge", FOFS(monsterinfo.dodge), F_FUNCTION, FFL_NOSPAWN},
-                    // {"attack", FOFS(monsterinfo.attack), F_FUNCTION, FFL_NOSPAWN},
-                    // {"melee", FOFS(monsterinfo.melee), F_FUNCTION, FFL_NOSPAWN},
-                    // {"sight", FOFS(monsterinfo.sight), F_FUNCTION, FFL_NOSPAWN},
-                    // {"checkattack", FOFS(monsterinfo.checkattack), F_FUNCTION, FFL_NOSPAWN},
-                    // {"currentmove", FOFS(monsterinfo.currentmove), F_MMOVE, FFL_NOSPAWN},
-
-                    // {"endfunc", FOFS(moveinfo.endfunc), F_FUNCTION, FFL_NOSPAWN},
+                    // only saved, the entity string never sets these
+                    {"client", F_CLIENT, FFL_NOSPAWN, .ofs = FOFS(client)},
+                    {"goalentity", F_EDICT, FFL_NOSPAWN, .ofs = FOFS(goalentity)},
+                    {"movetarget", F_EDICT, FFL_NOSPAWN, .ofs = FOFS(movetarget)},
+                    {"enemy", F_EDICT, FFL_NOSPAWN, .ofs = FOFS(enemy)},
+                    {"oldenemy", F_EDICT, FFL_NOSPAWN, .ofs = FOFS(oldenemy)},
+                    {"activator", F_EDICT, FFL_NOSPAWN, .ofs = FOFS(activator)},
+                    {"groundentity", F_EDICT, FFL_NOSPAWN, .ofs = FOFS(groundentity)},
+                    {"teamchain", F_EDICT, FFL_NOSPAWN, .ofs = FOFS(teamchain)},
+                    {"teammaster", F_EDICT, FFL_NOSPAWN, .ofs = FOFS(teammaster)},
+                    {"owner", F_EDICT, FFL_NOSPAWN, .ofs = FOFS(owner)},
+                    {"mynoise", F_EDICT, FFL_NOSPAWN, .ofs = FOFS(mynoise)},
+                    {"mynoise2", F_EDICT, FFL_NOSPAWN, .ofs = FOFS(mynoise2)},
+                    {"target_ent", F_EDICT, FFL_NOSPAWN, .ofs = FOFS(target_ent)},
+                    {"chain", F_EDICT, FFL_NOSPAWN, .ofs = FOFS(chain)},
+
+                    {"prethink", F_FUNCTION, FFL_NOSPAWN, .ofs = FOFS(prethink)},
+                    {"think", F_FUNCTION, FFL_NOSPAWN, .ofs = FOFS(think)},
+                    {"blocked", F_FUNCTION, FFL_NOSPAWN, .ofs = FOFS(blocked)},
+                    {"touch", F_FUNCTION, FFL_NOSPAWN, .ofs = FOFS(touch)},
+                    {"use", F_FUNCTION, FFL_NOSPAWN, .ofs = FOFS(use)},
+                    {"pain", F_FUNCTION, FFL_NOSPAWN, .ofs = FOFS(pain)},
+                    {"die", F_FUNCTION, FFL_NOSPAWN, .ofs = FOFS(die)},
+
+                    {"stand", F_FUNCTION, FFL_NOSPAWN, .ofs = FOFS(monsterinfo.stand)},
+                    {"idle", F_FUNCTION, FFL_NOSPAWN, .ofs = FOFS(monsterinfo.idle)},
+                    {"search", F_FUNCTION, FFL_NOSPAWN, .ofs = FOFS(monsterinfo.search)},
+                    {"walk", F_FUNCTION, FFL_NOSPAWN, .ofs = FOFS(monsterinfo.walk)},
+                    {"run", F_FUNCTION, FFL_NOSPAWN, .ofs = FOFS(monsterinfo.run)},
+                    {"dodge", F_FUNCTION, FFL_NOSPAWN, .ofs = FOFS(monsterinfo.dodge)},
+                    {"attack", F_FUNCTION, FFL_NOSPAWN, .ofs = FOFS(monsterinfo.attack)},
+                    {"melee", F_FUNCTION, FFL_NOSPAWN, .ofs = FOFS(monsterinfo.melee)},
+                    {"sight", F_FUNCTION, FFL_NOSPAWN, .ofs = FOFS(monsterinfo.sight)},
+                    {"checkattack", F_FUNCTION, FFL_NOSPAWN, .ofs = FOFS(monsterinfo.checkattack)},
+                    {"currentmove", F_MMOVE, FFL_NOSPAWN, .ofs = FOFS(monsterinfo.currentmove)},
+
+                    {"endfunc", F_FUNCTION, FFL_NOSPAWN, .ofs = FOFS(moveinfo.endfunc)},
 
                     // temp spawn vars -- only valid when the spawn function is called
                     {"lip", F_INT, FFL_SPAWNTEMP, NULL, NULL, set_lip},
@@ -310,7 +283,7 @@ field_t fields[] = {{"classname", F_LSTRING, 0, set_classname, get_classname},
                     {"item", F_LSTRING, FFL_SPAWNTEMP, NULL, NULL, set_item_temp},
 
                     // need for item field in edict struct, FFL_SPAWNTEMP item will be skipped on saves
-                    {"item", F_ITEM, 0, set_item_spawn, NULL},
+                    {"item", F_ITEM, 0, set_item_spawn, get_item, .ofs = FOFS(item)},
 
                     {"gravity", F_LSTRING, FFL_SPAWNTEMP, NULL, NULL, set_gravity},
                     {"sky", F_LSTRING, FFL_SPAWNTEMP, NULL, NULL, set_sky},
@@ -326,26 +299,24 @@ field_t fields[] = {{"classname", F_LSTRING, 0, set_classname, get_classname},
 
 };
 
-// field_t		levelfields[] =
-// {
-// 	{"changemap", LLOFS(changemap), F_LSTRING},
+static field_t levelfields[] = {{"changemap", F_LSTRING, .ofs = LLOFS(changemap)},
 
-// 	{"sight_client", LLOFS(sight_client), F_EDICT},
-// 	{"sight_entity", LLOFS(sight_entity), F_EDICT},
-// 	{"sound_entity", LLOFS(sound_entity), F_EDICT},
-// 	{"sound2_entity", LLOFS(sound2_entity), F_EDICT},
+                                {"sight_client", F_EDICT, .ofs = LLOFS(sight_client)},
+                                {"sight_entity", F_EDICT, .ofs = LLOFS(sight_entity)},
+                                {"sound_entity", F_EDICT, .ofs = LLOFS(sound_entity)},
+                                {"sound2_entity", F_EDICT, .ofs = LLOFS(sound2_entity)},
+                                {"current_entity", F_EDICT, .ofs = LLOFS(current_entity)},
 
-// 	{NULL, 0, F_INT}
-// };
+                                {NULL}};
 
-// field_t		clientfields[] =
-// {
-// 	{"pers.weapon", CLOFS(pers.weapon), F_ITEM},
-// 	{"pers.lastweapon", CLOFS(pers.lastweapon), F_ITEM},
-// 	{"newweapon", CLOFS(newweapon), F_ITEM},
+static field_t clientfields[] = {{"pers.weapon", F_ITEM, .ofs = CLOFS(pers.weapon)},
+                                 {"pers.lastweapon", F_ITEM, .ofs = CLOFS(pers.lastweapon)},
+                                 {"resp.coop_respawn.weapon", F_ITEM, .ofs = CLOFS(resp.coop_respawn.weapon)},
+                                 {"resp.coop_respawn.lastweapon", F_ITEM, .ofs = CLOFS(resp.coop_respawn.lastweapon)},
+                                 {"newweapon", F_ITEM, .ofs = CLOFS(newweapon)},
+                                 {"chase_target", F_EDICT, .ofs = CLOFS(chase_target)},
 
-// 	{NULL, 0, F_INT}
-// };
+                                 {NULL}};
 
 /*
 ============
@@ -410,6 +381,8 @@ void InitGame(void) {
 
   // items
   InitItems();
+  ED_InitSpawnTables();
+  InitSaveTables();
 
   Com_sprintf(game.helpmessage1, sizeof(game.helpmessage1), "");
 
@@ -427,213 +400,393 @@ void InitGame(void) {
   globals.num_edicts = game.maxclients + 1;
 }
 
-//=========================================================
+/*
+===============================================================================
+
+SAVEGAMES
+
+Savegames are binary snapshots of the game structs, tied to the build that
+wrote them by the struct sizes in the header.  Each struct is copied whole
+and then the pointer fields of its field table are patched in the copy:
+strings become their length with the characters following the struct,
+edicts, clients and items become an index, -1 for NULL, and functions and
+mmove_ts become the hash of their name in g_saveptrs.h, 0 for NULL.
+
+A whole file is built in memory and handed to gi.WriteSave in one piece,
+and read back with one gi.ReadSave, so the server can keep it as a file or
+as a row of its database.
+
+===============================================================================
+*/
+
+#define SAVE_MAGIC (('V' << 24) + ('A' << 16) + ('S' << 8) + 'Q') // "QSAV"
+#define SAVE_VERSION 1
+
+typedef struct {
+  int magic;
+  int version;
+  int sizes[4]; // game_locals_t, level_locals_t, gclient_t, edict_t
+} saveheader_t;
+
+typedef struct {
+  byte *data;
+  int cursize;
+  int maxsize;
+} savebuf_t;
+
+typedef struct {
+  const char *name;
+  byte *data;
+  int readcount;
+  int cursize;
+} loadbuf_t;
+
+typedef struct {
+  const char *name;
+  void *pointer;
+  unsigned hash;
+} savepointer_t;
+
+typedef struct {
+  savepointer_t *pointers; // sorted by address
+  savepointer_t **byhash;
+  int count;
+} savetable_t;
+
+#define SAVE_FUNCTION(f) {#f, (void *)f}
+#define SAVE_MMOVE(m) {#m, &m}
+
+#include "g_saveptrs.h"
+
+#define NUM_SAVE_FUNCTIONS (sizeof(save_functions) / sizeof(save_functions[0]))
+#define NUM_SAVE_MMOVES (sizeof(save_mmoves) / sizeof(save_mmoves[0]))
+
+static savepointer_t *functions_byhash[NUM_SAVE_FUNCTIONS];
+static savepointer_t *mmoves_byhash[NUM_SAVE_MMOVES];
+
+static savetable_t function_table = {save_functions, functions_byhash, NUM_SAVE_FUNCTIONS};
+static savetable_t mmove_table = {save_mmoves, mmoves_byhash, NUM_SAVE_MMOVES};
+
+// FNV-1a, it has to stay the same for old saves to load
+static unsigned SaveHash(const char *name) {
+  unsigned hash = 2166136261u;
+
+  while(*name)
+    hash = (hash ^ (byte)*name++) * 16777619u;
+  return hash;
+}
+
+static int SavePointerCompare(const void *a, const void *b) {
+  uintptr_t pa = (uintptr_t)((const savepointer_t *)a)->pointer;
+  uintptr_t pb = (uintptr_t)((const savepointer_t *)b)->pointer;
 
-// void WriteField1(FILE *f, field_t *field, byte *base) {
-//   void *p;
-//   int len;
-//   int index;
-
-//   if(field->flags & FFL_SPAWNTEMP)
-//     return;
-
-//   p = (void *)(base + field->ofs);
-//   switch(field->type) {
-//   case F_INT:
-//   case F_FLOAT:
-//   case F_ANGLEHACK:
-//   case F_VECTOR:
-//   case F_IGNORE:
-//     break;
-
-//   case F_LSTRING:
-//   case F_GSTRING:
-//     if(*(char **)p)
-//       len = strlen(*(char **)p) + 1;
-//     else
-//       len = 0;
-//     *(int *)p = len;
-//     break;
-//   case F_EDICT:
-//     if(*(edict_t **)p == NULL)
-//       index = -1;
-//     else
-//       index = *(edict_t **)p - g_edicts;
-//     *(int *)p = index;
-//     break;
-//   case F_CLIENT:
-//     if(*(gclient_t **)p == NULL)
-//       index = -1;
-//     else
-//       index = *(gclient_t **)p - game.clients;
-//     *(int *)p = index;
-//     break;
-//   case F_ITEM:
-//     if(*(edict_t **)p == NULL)
-//       index = -1;
-//     else
-//       index = *(gitem_t **)p - itemlist;
-//     *(int *)p = index;
-//     break;
-
-//   // relative to code segment
-//   case F_FUNCTION:
-//     if(*(byte **)p == NULL)
-//       index = 0;
-//     else
-//       index = *(byte **)p - ((byte *)InitGame);
-//     *(int *)p = index;
-//     break;
-
-//   // relative to data segment
-//   case F_MMOVE:
-//     if(*(byte **)p == NULL)
-//       index = 0;
-//     else
-//       index = *(byte **)p - (byte *)&mmove_reloc;
-//     *(int *)p = index;
-//     break;
-
-//   default:
-//     gi.error("WriteEdict: unknown field type");
-//   }
-// }
-
-// void WriteField2(FILE *f, field_t *field, byte *base) {
-//   int len;
-//   void *p;
-
-//   if(field->flags & FFL_SPAWNTEMP)
-//     return;
-
-//   p = (void *)(base + field->ofs);
-//   switch(field->type) {
-//   case F_LSTRING:
-//     if(*(char **)p) {
-//       len = strlen(*(char **)p) + 1;
-//       fwrite(*(char **)p, len, 1, f);
-//     }
-//     break;
-//   }
-// }
-
-// void ReadField(FILE *f, field_t *field, byte *base) {
-//   void *p;
-//   int len;
-//   int index;
-
-//   if(field->flags & FFL_SPAWNTEMP)
-//     return;
-
-//   p = (void *)(base + field->ofs);
-//   switch(field->type) {
-//   case F_INT:
-//   case F_FLOAT:
-//   case F_ANGLEHACK:
-//   case F_VECTOR:
-//   case F_IGNORE:
-//     break;
-
-//   case F_LSTRING:
-//     len = *(int *)p;
-//     if(!len)
-//       *(char **)p = NULL;
-//     else {
-//       *(char **)p = gi.TagMalloc(len, TAG_LEVEL);
-//       fread(*(char **)p, len, 1, f);
-//     }
-//     break;
-//   case F_EDICT:
-//     index = *(int *)p;
-//     if(index == -1)
-//       *(edict_t **)p = NULL;
-//     else
-//       *(edict_t **)p = &g_edicts[index];
-//     break;
-//   case F_CLIENT:
-//     index = *(int *)p;
-//     if(index == -1)
-//       *(gclient_t **)p = NULL;
-//     else
-//       *(gclient_t **)p = &game.clients[index];
-//     break;
-//   case F_ITEM:
-//     index = *(int *)p;
-//     if(index == -1)
-//       *(gitem_t **)p = NULL;
-//     else
-//       *(gitem_t **)p = &itemlist[index];
-//     break;
-
-//   // relative to code segment
-//   case F_FUNCTION:
-//     index = *(int *)p;
-//     if(index == 0)
-//       *(byte **)p = NULL;
-//     else
-//       *(byte **)p = ((byte *)InitGame) + index;
-//     break;
-
-//   // relative to data segment
-//   case F_MMOVE:
-//     index = *(int *)p;
-//     if(index == 0)
-//       *(byte **)p = NULL;
-//     else
-//       *(byte **)p = (byte *)&mmove_reloc + index;
-//     break;
-
-//   default:
-//     gi.error("ReadEdict: unknown field type");
-//   }
-// }
+  return pa < pb ? -1 : pa > pb;
+}
+
+static int SaveHashCompare(const void *a, const void *b) {
+  unsigned ha = (*(savepointer_t *const *)a)->hash;
+  unsigned hb = (*(savepointer_t *const *)b)->hash;
+
+  return ha < hb ? -1 : ha > hb;
+}
+
+/*
+============
+InitSaveTable
+
+Sorts a pointer table both ways once, a name that hashes like another
+(or like NULL) would make its saves load the wrong pointer
+============
+*/
+static void InitSaveTable(savetable_t *table) {
+  int i;
+
+  for(i = 0; i < table->count; i++)
+    table->pointers[i].hash = SaveHash(table->pointers[i].name);
+  qsort(table->pointers, table->count, sizeof(table->pointers[0]), SavePointerCompare);
+
+  for(i = 0; i < table->count; i++)
+    table->byhash[i] = &table->pointers[i];
+  qsort(table->byhash, table->count, sizeof(table->byhash[0]), SaveHashCompare);
+
+  for(i = 0; i < table->count; i++) {
+    if(!table->byhash[i]->hash)
+      gi.error("InitSaveTable: %s hashes to 0", table->byhash[i]->name);
+    if(i && table->byhash[i]->hash == table->byhash[i - 1]->hash)
+      gi.error("InitSaveTable: %s and %s have the same hash", table->byhash[i]->name, table->byhash[i - 1]->name);
+  }
+}
+
+void InitSaveTables(void) {
+  InitSaveTable(&function_table);
+  InitSaveTable(&mmove_table);
+}
+
+static unsigned SavePointerHash(savetable_t *table, void *pointer, const field_t *field) {
+  savepointer_t key, *found;
+
+  if(!pointer)
+    return 0;
+
+  key.pointer = pointer;
+  found = bsearch(&key, table->pointers, table->count, sizeof(table->pointers[0]), SavePointerCompare);
+  if(!found) {
+    gi.dprintf("%s %p is not in g_saveptrs.h, saved as NULL\n", field->name, pointer);
+    return 0;
+  }
+  return found->hash;
+}
+
+static void *SavePointerForHash(savetable_t *table, unsigned hash, const field_t *field) {
+  savepointer_t key, *keyptr, **found;
+
+  if(!hash)
+    return NULL;
+
+  key.hash = hash;
+  keyptr = &key;
+  found = bsearch(&keyptr, table->byhash, table->count, sizeof(table->byhash[0]), SaveHashCompare);
+  if(!found)
+    gi.error("%s %08x is not in g_saveptrs.h", field->name, hash);
+  return (*found)->pointer;
+}
 
 //=========================================================
 
-// /*
-// ==============
-// WriteClient
+static void *Save_Reserve(savebuf_t *buf, int length) {
+  byte *data;
+
+  if(buf->cursize + length > buf->maxsize) {
+    while(buf->cursize + length > buf->maxsize)
+      buf->maxsize *= 2;
+    data = gi.TagMalloc(buf->maxsize, TAG_GAME);
+    memcpy(data, buf->data, buf->cursize);
+    gi.TagFree(buf->data);
+    buf->data = data;
+  }
 
-// All pointer variables (except function pointers) must be handled specially.
-// ==============
-// */
-// void WriteClient(FILE *f, gclient_t *client) {
-//   field_t *field;
-//   gclient_t temp;
+  data = buf->data + buf->cursize;
+  buf->cursize += length;
+  return data;
+}
+
+static void Save_Write(savebuf_t *buf, const void *data, int length) {
+  memcpy(Save_Reserve(buf, length), data, length);
+}
+
+static void Save_WriteInt(savebuf_t *buf, int value) { Save_Write(buf, &value, sizeof(value)); }
+
+static void Save_Begin(savebuf_t *buf, int estimate) {
+  saveheader_t header = {SAVE_MAGIC,
+                         SAVE_VERSION,
+                         {sizeof(game_locals_t), sizeof(level_locals_t), sizeof(gclient_t), sizeof(edict_t)}};
+
+  buf->maxsize = sizeof(header) + estimate;
+  buf->data = gi.TagMalloc(buf->maxsize, TAG_GAME);
+  buf->cursize = 0;
+  Save_Write(buf, &header, sizeof(header));
+}
+
+static void Save_End(savebuf_t *buf, const char *filename) {
+  bool ok;
+
+  ok = gi.WriteSave(filename, buf->data, buf->cursize);
+  gi.TagFree(buf->data);
+  if(!ok)
+    gi.error("Couldn't write %s", filename);
+}
+
+static void Load_Read(loadbuf_t *buf, void *data, int length) {
+  if(buf->readcount + length > buf->cursize)
+    gi.error("%s is truncated", buf->name);
+  memcpy(data, buf->data + buf->readcount, length);
+  buf->readcount += length;
+}
+
+static int Load_ReadInt(loadbuf_t *buf) {
+  int value;
 
-//   // all of the ints, floats, and vectors stay as they are
-//   temp = *client;
+  Load_Read(buf, &value, sizeof(value));
+  return value;
+}
+
+static void Load_Begin(loadbuf_t *buf, const char *filename) {
+  saveheader_t header;
+  void *data;
+
+  buf->name = filename;
+  buf->cursize = gi.ReadSave(filename, &data);
+  if(buf->cursize < 0)
+    gi.error("Couldn't read %s", filename);
+  buf->data = data;
+  buf->readcount = 0;
+
+  Load_Read(buf, &header, sizeof(header));
+  if(header.magic != SAVE_MAGIC || header.version != SAVE_VERSION || header.sizes[0] != sizeof(game_locals_t) ||
+     header.sizes[1] != sizeof(level_locals_t) || header.sizes[2] != sizeof(gclient_t) ||
+     header.sizes[3] != sizeof(edict_t)) {
+    gi.TagFree(buf->data);
+    gi.error("%s is from a different version of the game", filename);
+  }
+}
+
+static void Load_End(loadbuf_t *buf) { gi.TagFree(buf->data); }
+
+//=========================================================
+
+static void Save_PatchSlot(byte *slot, int value) {
+  memset(slot, 0, sizeof(void *));
+  memcpy(slot, &value, sizeof(value));
+}
+
+/*
+============
+WriteStruct
 
-//   // change the pointers to lengths or indexes
-//   for(field = clientfields; field->name; field++) {
-//     WriteField1(f, field, (byte *)&temp);
-//   }
+Copies the struct and patches its pointer fields in the copy, then
+appends the strings. Edict fields go through their getters.
+============
+*/
+static void WriteStruct(savebuf_t *buf, const field_t *fields, const void *base, int size) {
+  const field_t *field;
+  const char *string;
+  byte *temp;
+  void *p;
+  int index;
+
+  temp = Save_Reserve(buf, size);
+  memcpy(temp, base, size);
+
+  for(field = fields; field->name; field++) {
+    if(field->flags & FFL_SPAWNTEMP || !field->ofs)
+      continue;
+
+    // every pointer member of the union is at the same place
+    p = field->get ? field->get(base).function : *(void **)((byte *)base + field->ofs);
+
+    switch(field->type) {
+    case F_LSTRING:
+    case F_GSTRING:
+      index = p ? strlen(p) + 1 : 0;
+      break;
+    case F_EDICT:
+      index = p ? (edict_t *)p - g_edicts : -1;
+      break;
+    case F_CLIENT:
+      index = p ? (gclient_t *)p - game.clients : -1;
+      break;
+    case F_ITEM:
+      index = p ? (gitem_t *)p - itemlist : -1;
+      break;
+    case F_FUNCTION:
+      index = SavePointerHash(&function_table, p, field);
+      break;
+    case F_MMOVE:
+      index = SavePointerHash(&mmove_table, p, field);
+      break;
+    default:
+      gi.error("WriteStruct: bad field type %i for %s", field->type, field->name);
+    }
+    Save_PatchSlot(temp + field->ofs, index);
+  }
+
+  for(field = fields; field->name; field++) {
+    if(field->flags & FFL_SPAWNTEMP || !field->ofs || (field->type != F_LSTRING && field->type != F_GSTRING))
+      continue;
+
+    string = field->get ? field->get(base).string : *(char **)((byte *)base + field->ofs);
+    if(string)
+      Save_Write(buf, string, strlen(string) + 1);
+  }
+}
 
-//   // write the block
-//   fwrite(&temp, sizeof(temp), 1, f);
+/*
+============
+ReadStruct
 
-//   // now write any allocated data following the edict
-//   for(field = clientfields; field->name; field++) {
-//     WriteField2(f, field, (byte *)client);
-//   }
-// }
+Reads the struct over base and turns its patched pointer fields back into
+pointers. Edict fields go through their setters so classnames and
+targetnames are indexed again.
+============
+*/
+static void ReadStruct(loadbuf_t *buf, const field_t *fields, void *base, int size) {
+  const field_t *field;
+  struct field_value value;
+  void **p;
+  int index;
+
+  Load_Read(buf, base, size);
+
+  for(field = fields; field->name; field++) {
+    if(field->flags & FFL_SPAWNTEMP || !field->ofs)
+      continue;
+
+    p = (void **)((byte *)base + field->ofs);
+    index = *(int *)p;
+    *p = NULL;
+
+    value.type = field->type;
+    switch(field->type) {
+    case F_LSTRING:
+    case F_GSTRING:
+      value.string = NULL;
+      if(index) {
+        value.string = gi.TagMalloc(index, field->type == F_LSTRING ? TAG_LEVEL : TAG_GAME);
+        Load_Read(buf, value.string, index);
+        value.string[index - 1] = 0;
+      }
+      break;
+    case F_EDICT:
+      if(index < -1 || index >= game.maxentities)
+        gi.error("ReadStruct: bad %s %i", field->name, index);
+      value.edict = index == -1 ? NULL : &g_edicts[index];
+      break;
+    case F_CLIENT:
+      if(index < -1 || index >= game.maxclients)
+        gi.error("ReadStruct: bad %s %i", field->name, index);
+      value.client = index == -1 ? NULL : &game.clients[index];
+      break;
+    case F_ITEM:
+      if(index < -1 || index >= game.num_items)
+        gi.error("ReadStruct: bad %s %i", field->name, index);
+      value.item = index == -1 ? NULL : &itemlist[index];
+      break;
+    case F_FUNCTION:
+      value.function = SavePointerForHash(&function_table, index, field);
+      break;
+    case F_MMOVE:
+      *p = SavePointerForHash(&mmove_table, index, field);
+      continue;
+    default:
+      gi.error("ReadStruct: bad field type %i for %s", field->type, field->name);
+    }
+
+    if(field->set)
+      field->set(base, value);
+    else
+      *p = value.function;
+  }
+}
 
-// /*
-// ==============
-// ReadClient
+/*
+============
+WriteEdict
 
-// All pointer variables (except function pointers) must be handled specially.
-// ==============
-// */
-// void ReadClient(FILE *f, gclient_t *client) {
-//   field_t *field;
+Leaves out the state that is rebuilt on load: the world links, the
+G_Find chains and the ECS entity
+============
+*/
+static void WriteEdict(savebuf_t *buf, edict_t *ent) {
+  edict_t temp;
 
-//   fread(client, sizeof(*client), 1, f);
+  temp = *ent;
+  memset(&temp.area, 0, sizeof(temp.area));
+  temp.classname_next = temp.targetname_next = NULL;
+  temp.classname_bucket = temp.targetname_bucket = 0;
+  temp.entity_handle = 0;
 
-//   for(field = clientfields; field->name; field++) {
-//     ReadField(f, field, (byte *)client);
-//   }
-// }
+  WriteStruct(buf, fields, &temp, sizeof(temp));
+}
 
 /*
 ============
@@ -650,153 +803,57 @@ last save position.
 ============
 */
 void WriteGame(char *filename, bool autosave) {
-  gi.dprintf("unimplemented (WriteGame)");
-  //   FILE *f;
-  //   int i;
-  //   char str[16];
-
-  //   if(!autosave)
-  //     SaveClientData();
+  savebuf_t buf;
+  game_locals_t temp;
+  int i;
 
-  //   f = fopen(filename, "wb");
-  //   if(!f)
-  //     gi.error("Couldn't open %s", filename);
+  if(!autosave)
+    SaveClientData();
 
-  //   memset(str, 0, sizeof(str));
-  //   strcpy(str, __DATE__);
-  //   fwrite(str, sizeof(str), 1, f);
+  Save_Begin(&buf, sizeof(game) + game.maxclients * sizeof(gclient_t));
 
-  //   game.autosaved = autosave;
-  //   fwrite(&game, sizeof(game), 1, f);
-  //   game.autosaved = false;
+  temp = game;
+  temp.autosaved = autosave;
+  temp.clients = NULL;
+  Save_Write(&buf, &temp, sizeof(temp));
 
-  //   for(i = 0; i < game.maxclients; i++)
-  //     WriteClient(f, &game.clients[i]);
+  for(i = 0; i < game.maxclients; i++)
+    WriteStruct(&buf, clientfields, &game.clients[i], sizeof(gclient_t));
 
-  //   fclose(f);
+  Save_End(&buf, filename);
 }
 
-void ReadGame(char *filename) {
-  gi.error("unimplemented (ReadGame)");
-  //   FILE *f;
-  //   int i;
-  //   char str[16];
-
-  //   gi.FreeTags(TAG_GAME);
+/*
+============
+ReadGame
 
-  //   f = fopen(filename, "rb");
-  //   if(!f)
-  //     gi.error("Couldn't open %s", filename);
+InitGame has already allocated the edicts and clients for the latched
+maxclients and maxentities the server restored
+============
+*/
+void ReadGame(char *filename) {
+  loadbuf_t buf;
+  game_locals_t temp;
+  int i;
 
-  //   fread(str, sizeof(str), 1, f);
-  //   if(strcmp(str, __DATE__)) {
-  //     fclose(f);
-  //     gi.error("Savegame from an older version.\n");
-  //   }
+  Load_Begin(&buf, filename);
 
-  //   g_edicts = gi.TagMalloc(game.maxentities * sizeof(g_edicts[0]), TAG_GAME);
-  //   globals.edicts = g_edicts;
+  Load_Read(&buf, &temp, sizeof(temp));
+  if(temp.maxclients != game.maxclients || temp.maxentities != game.maxentities) {
+    Load_End(&buf);
+    gi.error("%s was saved with %i clients and %i entities", filename, temp.maxclients, temp.maxentities);
+  }
+  temp.clients = game.clients;
+  game = temp;
 
-  //   fread(&game, sizeof(game), 1, f);
-  //   game.clients = gi.TagMalloc(game.maxclients * sizeof(game.clients[0]), TAG_GAME);
-  //   for(i = 0; i < game.maxclients; i++)
-  //     ReadClient(f, &game.clients[i]);
+  for(i = 0; i < game.maxclients; i++)
+    ReadStruct(&buf, clientfields, &game.clients[i], sizeof(gclient_t));
 
-  //   fclose(f);
+  Load_End(&buf);
 }
 
 //==========================================================
 
-// /*
-// ==============
-// WriteEdict
-
-// All pointer variables (except function pointers) must be handled specially.
-// ==============
-// */
-// void WriteEdict(FILE *f, edict_t *ent) {
-//   field_t *field;
-//   edict_t temp;
-
-//   // all of the ints, floats, and vectors stay as they are
-//   temp = *ent;
-
-//   // change the pointers to lengths or indexes
-//   for(field = fields; field->name; field++) {
-//     WriteField1(f, field, (byte *)&temp);
-//   }
-
-//   // write the block
-//   fwrite(&temp, sizeof(temp), 1, f);
-
-//   // now write any allocated data following the edict
-//   for(field = fields; field->name; field++) {
-//     WriteField2(f, field, (byte *)ent);
-//   }
-// }
-
-// /*
-// ==============
-// WriteLevelLocals
-
-// All pointer variables (except function pointers) must be handled specially.
-// ==============
-// */
-// void WriteLevelLocals(FILE *f) {
-//   field_t *field;
-//   level_locals_t temp;
-
-//   // all of the ints, floats, and vectors stay as they are
-//   temp = level;
-
-//   // change the pointers to lengths or indexes
-//   for(field = levelfields; field->name; field++) {
-//     WriteField1(f, field, (byte *)&temp);
-//   }
-
-//   // write the block
-//   fwrite(&temp, sizeof(temp), 1, f);
-
-//   // now write any allocated data following the edict
-//   for(field = levelfields; field->name; field++) {
-//     WriteField2(f, field, (byte *)&level);
-//   }
-// }
-
-// /*
-// ==============
-// ReadEdict
-
-// All pointer variables (except function pointers) must be handled specially.
-// ==============
-// */
-// void ReadEdict(FILE *f, edict_t *ent) {
-//   field_t *field;
-
-//   fread(ent, sizeof(*ent), 1, f);
-
-//   for(field = fields; field->name; field++) {
-//     ReadField(f, field, (byte *)ent);
-//   }
-// }
-
-// /*
-// ==============
-// ReadLevelLocals
-
-// All pointer variables (except function pointers) must be handled specially.
-// ==============
-// */
-// void ReadLevelLocals(FILE *f) {
-//   field_t *field;
-
-//   fread(&level, sizeof(level), 1, f);
-
-//   for(field = levelfields; field->name; field++) {
-//     ReadField(f, field, (byte *)&level);
-//   }
-// }
-
 /*
 =================
 WriteLevel
@@ -804,39 +861,22 @@ WriteLevel
 =================
 */
 void WriteLevel(char *filename) {
-  gi.dprintf("unimplemented (WriteLevel)");
-  //   int i;
-  //   edict_t *ent;
-  //   FILE *f;
-  //   void *base;
-
-  //   f = fopen(filename, "wb");
-  //   if(!f)
-  //     gi.error("Couldn't open %s", filename);
-
-  //   // write out edict size for checking
-  //   i = sizeof(edict_t);
-  //   fwrite(&i, sizeof(i), 1, f);
+  savebuf_t buf;
+  int i;
 
-  //   // write out a function pointer for checking
-  //   base = (void *)InitGame;
-  //   fwrite(&base, sizeof(base), 1, f);
+  Save_Begin(&buf, sizeof(level) + globals.num_edicts * (sizeof(int) + sizeof(edict_t)));
 
-  //   // write out level_locals_t
-  //   WriteLevelLocals(f);
+  WriteStruct(&buf, levelfields, &level, sizeof(level));
 
-  //   // write out all the entities
-  //   for(i = 0; i < globals.num_edicts; i++) {
-  //     ent = &g_edicts[i];
-  //     if(!ent->inuse)
-  //       continue;
-  //     fwrite(&i, sizeof(i), 1, f);
-  //     WriteEdict(f, ent);
-  //   }
-  //   i = -1;
-  //   fwrite(&i, sizeof(i), 1, f);
+  for(i = 0; i < globals.num_edicts; i++) {
+    if(!g_edicts[i].inuse)
+      continue;
+    Save_WriteInt(&buf, i);
+    WriteEdict(&buf, &g_edicts[i]);
+  }
+  Save_WriteInt(&buf, -1);
 
-  //   fclose(f);
+  Save_End(&buf, filename);
 }
 
 /*
@@ -856,85 +896,69 @@ No clients are connected yet.
 =================
 */
 void ReadLevel(char *filename) {
-  gi.error("unimplemented (ReadLevel)");
-
-  //   int entnum;
-  //   FILE *f;
-  //   int i;
-  //   void *base;
-  //   edict_t *ent;
-
-  //   f = fopen(filename, "rb");
-  //   if(!f)
-  //     gi.error("Couldn't open %s", filename);
-
-  //   // free any dynamic memory allocated by loading the level
-  //   // base state
-  //   gi.FreeTags(TAG_LEVEL);
-
-  //   // wipe all the entities
-  //   memset(g_edicts, 0, game.maxentities * sizeof(g_edicts[0]));
-  //   globals.num_edicts = maxclients->value + 1;
-
-  //   // check edict size
-  //   fread(&i, sizeof(i), 1, f);
-  //   if(i != sizeof(edict_t)) {
-  //     fclose(f);
-  //     gi.error("ReadLevel: mismatched edict size");
-  //   }
-
-  //   // check function pointer base address
-  //   fread(&base, sizeof(base), 1, f);
-  // #ifdef _WIN32
-  //   if(base != (void *)InitGame) {
-  //     fclose(f);
-  //     gi.error("ReadLevel: function pointers have moved");
-  //   }
-  // #else
-  //   gi.dprintf("Function offsets %d\n", ((byte *)base) - ((byte *)InitGame));
-  // #endif
-
-  //   // load the level locals
-  //   ReadLevelLocals(f);
-
-  //   // load all the entities
-  //   while(1) {
-  //     if(fread(&entnum, sizeof(entnum), 1, f) != 1) {
-  //       fclose(f);
-  //       gi.error("ReadLevel: failed to read entnum");
-  //     }
-  //     if(entnum == -1)
-  //       break;
-  //     if(entnum >= globals.num_edicts)
-  //       globals.num_edicts = entnum + 1;
-
-  //     ent = &g_edicts[entnum];
-  //     ReadEdict(f, ent);
-
-  //     // let the server rebuild world links for this ent
-  //     memset(&ent->area, 0, sizeof(ent->area));
-  //     gi.linkentity(ent);
-  //   }
-
-  //   fclose(f);
-
-  //   // mark all clients as unconnected
-  //   for(i = 0; i < maxclients->value; i++) {
-  //     ent = &g_edicts[i + 1];
-  //     ent->client = game.clients + i;
-  //     ent->client->pers.connected = false;
-  //   }
-
-  //   // do any load time things at this point
-  //   for(i = 0; i < globals.num_edicts; i++) {
-  //     ent = &g_edicts[i];
-
-  //     if(!ent->inuse)
-  //       continue;
-
-  //     // fire any cross-level triggers
-  //     if(ent->classname)
-  //       if(strcmp(ent->classname, "target_crosslevel_target") == 0)
-  //         ent->nextthink = level.time + ent->delay;
-  //   }
+  loadbuf_t buf;
+  edict_t *ent;
+  int entnum;
+  int i;
+
+  Load_Begin(&buf, filename);
+
+  // the entities SpawnEntities made are replaced wholesale
+  for(i = 0; i < game.maxentities; i++) {
+    if(g_edicts[i].entity_handle &&
+       alias_ecs_despawn(GAME_ECS_INSTANCE(), 1, &g_edicts[i].entity_handle) != ALIAS_ECS_SUCCESS)
+      gi.error("failed to despawn alias ECS entity with edict\n");
+  }
+  G_ClearNameIndex();
+
+  // free any dynamic memory allocated by loading the level
+  // base state
+  gi.FreeTags(TAG_LEVEL);
+
+  // wipe all the entities
+  memset(g_edicts, 0, game.maxentities * sizeof(g_edicts[0]));
+  globals.num_edicts = maxclients->value + 1;
+
+  // load the level locals
+  ReadStruct(&buf, levelfields, &level, sizeof(level));
+
+  // load all the entities
+  while(1) {
+    entnum = Load_ReadInt(&buf);
+    if(entnum == -1)
+      break;
+    if(entnum < 0 || entnum >= game.maxentities)
+      gi.error("ReadLevel: bad entity number %i", entnum);
+    if(entnum >= globals.num_edicts)
+      globals.num_edicts = entnum + 1;
+
+    ent = &g_edicts[entnum];
+    ReadStruct(&buf, fields, ent, sizeof(*ent));
+    G_SpawnEntityHandle(ent);
+
+    // let the server rebuild world links for this ent
+    gi.linkentity(ent);
+  }
+
+  Load_End(&buf);
+
+  // mark all clients as unconnected
+  for(i = 0; i < maxclients->value; i++) {
+    ent = &g_edicts[i + 1];
+    ent->client = game.clients + i;
+    ent->client->pers.connected = false;
+  }
+
+  // do any load time things at this point
+  for(i = 0; i < globals.num_edicts; i++) {
+    ent = &g_edicts[i];
+
+    if(!ent->inuse)
+      continue;
+
+    // fire any cross-level triggers
+    if(ent->classname)
+      if(strcmp(ent->classname, "target_crosslevel_target") == 0)
+        ent->nextthink = level.time + ent->delay;
+  }
 }
@@ -0,0 +1,1704 @@
+/*
+Copyright (C) 1997-2001 Id Software, Inc.
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+// g_saveptrs.h -- every function and mmove_t a savegame can point at
+//
+// Only g_save.c includes this.  Saved pointers are stored as the hash of
+// the name they have here, so entries can be added or moved freely, but
+// renaming one breaks the savegames that hold it.  A think, touch, use,
+// pain, die, blocked, endfunc or monsterinfo callback that is missing
+// from here is dropped from the save with a warning.
+
+// functions
+
+// g_ai.c
+bool M_CheckAttack(edict_t *self);
+
+// g_cmds.c
+void ClientCommand(edict_t *ent);
+
+// g_func.c
+void AngleMove_Begin(edict_t *ent);
+void AngleMove_Done(edict_t *ent);
+void AngleMove_Final(edict_t *ent);
+void Move_Begin(edict_t *ent);
+void Move_Done(edict_t *ent);
+void Move_Final(edict_t *ent);
+void Think_AccelMove(edict_t *ent);
+void Think_CalcMoveSpeed(edict_t *self);
+void Think_SpawnDoorTrigger(edict_t *ent);
+void Touch_DoorTrigger(edict_t *self, edict_t *other, cplane_t *plane, csurface_t *surf);
+void Touch_Plat_Center(edict_t *ent, edict_t *other, cplane_t *plane, csurface_t *surf);
+void Use_Plat(edict_t *ent, edict_t *other, edict_t *activator);
+void button_done(edict_t *self);
+void button_killed(edict_t *self, edict_t *inflictor, edict_t *attacker, int damage, vec3_t point);
+void button_return(edict_t *self);
+void button_touch(edict_t *self, edict_t *other, cplane_t *plane, csurface_t *surf);
+void button_use(edict_t *self, edict_t *other, edict_t *activator);
+void button_wait(edict_t *self);
+void door_blocked(edict_t *self, edict_t *other);
+void door_go_down(edict_t *self);
+void door_hit_bottom(edict_t *self);
+void door_hit_top(edict_t *self);
+void door_killed(edict_t *self, edict_t *inflictor, edict_t *attacker, int damage, vec3_t point);
+void door_secret_blocked(edict_t *self, edict_t *other);
+void door_secret_die(edict_t *self, edict_t *inflictor, edict_t *attacker, int damage, vec3_t point);
+void door_secret_done(edict_t *self);
+void door_secret_move1(edict_t *self);
+void door_secret_move2(edict_t *self);
+void door_secret_move3(edict_t *self);
+void door_secret_move4(edict_t *self);
+void door_secret_move5(edict_t *self);
+void door_secret_move6(edict_t *self);
+void door_secret_use(edict_t *self, edict_t *other, edict_t *activator);
+void door_touch(edict_t *self, edict_t *other, cplane_t *plane, csurface_t *surf);
+void door_use(edict_t *self, edict_t *other, edict_t *activator);
+void func_conveyor_use(edict_t *self, edict_t *other, edict_t *activator);
+void func_timer_think(edict_t *self);
+void func_timer_use(edict_t *self, edict_t *other, edict_t *activator);
+void func_train_find(edict_t *self);
+void plat_blocked(edict_t *self, edict_t *other);
+void plat_go_down(edict_t *ent);
+void plat_hit_bottom(edict_t *ent);
+void plat_hit_top(edict_t *ent);
+void rotating_blocked(edict_t *self, edict_t *other);
+void rotating_touch(edict_t *self, edict_t *other, cplane_t *plane, csurface_t *surf);
+void rotating_use(edict_t *self, edict_t *other, edict_t *activator);
+void train_blocked(edict_t *self, edict_t *other);
+void train_next(edict_t *self);
+void train_use(edict_t *self, edict_t *other, edict_t *activator);
+void train_wait(edict_t *self);
+void trigger_elevator_init(edict_t *self);
+void trigger_elevator_use(edict_t *self, edict_t *other, edict_t *activator);
+void use_killbox(edict_t *self, edict_t *other, edict_t *activator);
+
+// g_items.c
+void DoRespawn(edict_t *ent);
+void MegaHealth_think(edict_t *self);
+void Touch_Item(edict_t *ent, edict_t *other, cplane_t *plane, csurface_t *surf);
+void Use_Item(edict_t *ent, edict_t *other, edict_t *activator);
+void drop_make_touchable(edict_t *ent);
+void drop_temp_touch(edict_t *ent, edict_t *other, cplane_t *plane, csurface_t *surf);
+void droptofloor(edict_t *ent);
+
+// g_misc.c
+void TH_viewthing(edict_t *ent);
+void Use_Areaportal(edict_t *ent, edict_t *other, edict_t *activator);
+void barrel_delay(edict_t *self, edict_t *inflictor, edict_t *attacker, int damage, vec3_t point);
+void barrel_explode(edict_t *self);
+void barrel_touch(edict_t *self, edict_t *other, cplane_t *plane, csurface_t *surf);
+void commander_body_drop(edict_t *self);
+void commander_body_think(edict_t *self);
+void commander_body_use(edict_t *self, edict_t *other, edict_t *activator);
+void debris_die(edict_t *self, edict_t *inflictor, edict_t *attacker, int damage, vec3_t point);
+void func_clock_think(edict_t *self);
+void func_clock_use(edict_t *self, edict_t *other, edict_t *activator);
+void func_explosive_explode(edict_t *self, edict_t *inflictor, edict_t *attacker, int damage, vec3_t point);
+void func_explosive_spawn(edict_t *self, edict_t *other, edict_t *activator);
+void func_explosive_use(edict_t *self, edict_t *other, edict_t *activator);
+void func_object_release(edict_t *self);
+void func_object_touch(edict_t *self, edict_t *other, cplane_t *plane, csurface_t *surf);
+void func_object_use(edict_t *self, edict_t *other, edict_t *activator);
+void func_wall_use(edict_t *self, edict_t *other, edict_t *activator);
+void gib_die(edict_t *self, edict_t *inflictor, edict_t *attacker, int damage, vec3_t point);
+void gib_think(edict_t *self);
+void gib_touch(edict_t *self, edict_t *other, cplane_t *plane, csurface_t *surf);
+void light_use(edict_t *self, edict_t *other, edict_t *activator);
+void misc_banner_think(edict_t *ent);
+void misc_blackhole_think(edict_t *self);
+void misc_blackhole_use(edict_t *ent, edict_t *other, edict_t *activator);
+void misc_deadsoldier_die(edict_t *self, edict_t *inflictor, edict_t *attacker, int damage, vec3_t point);
+void misc_easterchick2_think(edict_t *self);
+void misc_easterchick_think(edict_t *self);
+void misc_eastertank_think(edict_t *self);
+void misc_satellite_dish_think(edict_t *self);
+void misc_satellite_dish_use(edict_t *self, edict_t *other, edict_t *activator);
+void misc_strogg_ship_use(edict_t *self, edict_t *other, edict_t *activator);
+void misc_viper_bomb_prethink(edict_t *self);
+void misc_viper_bomb_touch(edict_t *self, edict_t *other, cplane_t *plane, csurface_t *surf);
+void misc_viper_bomb_use(edict_t *self, edict_t *other, edict_t *activator);
+void misc_viper_use(edict_t *self, edict_t *other, edict_t *activator);
+void path_corner_touch(edict_t *self, edict_t *other, cplane_t *plane, csurface_t *surf);
+void point_combat_touch(edict_t *self, edict_t *other, cplane_t *plane, csurface_t *surf);
+void redeploy_touch(edict_t *self, edict_t *other, cplane_t *plane, csurface_t *surf);
+void target_string_use(edict_t *self, edict_t *other, edict_t *activator);
+void teleporter_touch(edict_t *self, edict_t *other, cplane_t *plane, csurface_t *surf);
+
+// g_monster.c
+void M_FliesOff(edict_t *self);
+void M_FliesOn(edict_t *self);
+void M_droptofloor(edict_t *ent);
+void flymonster_start_go(edict_t *self);
+void monster_think(edict_t *self);
+void monster_triggered_spawn(edict_t *self);
+void monster_triggered_spawn_use(edict_t *self, edict_t *other, edict_t *activator);
+void monster_use(edict_t *self, edict_t *other, edict_t *activator);
+void swimmonster_start_go(edict_t *self);
+void walkmonster_start_go(edict_t *self);
+
+// g_target.c
+void Use_Target_Help(edict_t *ent, edict_t *other, edict_t *activator);
+void Use_Target_Speaker(edict_t *ent, edict_t *other, edict_t *activator);
+void Use_Target_Tent(edict_t *ent, edict_t *other, edict_t *activator);
+void target_crosslevel_target_think(edict_t *self);
+void target_earthquake_think(edict_t *self);
+void target_earthquake_use(edict_t *self, edict_t *other, edict_t *activator);
+void target_explosion_explode(edict_t *self);
+void target_laser_start(edict_t *self);
+void target_laser_think(edict_t *self);
+void target_laser_use(edict_t *self, edict_t *other, edict_t *activator);
+void target_lightramp_think(edict_t *self);
+void target_lightramp_use(edict_t *self, edict_t *other, edict_t *activator);
+void trigger_crosslevel_trigger_use(edict_t *self, edict_t *other, edict_t *activator);
+void use_target_blaster(edict_t *self, edict_t *other, edict_t *activator);
+void use_target_changelevel(edict_t *self, edict_t *other, edict_t *activator);
+void use_target_explosion(edict_t *self, edict_t *other, edict_t *activator);
+void use_target_goal(edict_t *ent, edict_t *other, edict_t *activator);
+void use_target_secret(edict_t *ent, edict_t *other, edict_t *activator);
+void use_target_spawner(edict_t *self, edict_t *other, edict_t *activator);
+void use_target_splash(edict_t *self, edict_t *other, edict_t *activator);
+
+// g_trigger.c
+void Touch_Multi(edict_t *self, edict_t *other, cplane_t *plane, csurface_t *surf);
+void Use_Multi(edict_t *ent, edict_t *other, edict_t *activator);
+void hurt_touch(edict_t *self, edict_t *other, cplane_t *plane, csurface_t *surf);
+void hurt_use(edict_t *self, edict_t *other, edict_t *activator);
+void multi_wait(edict_t *ent);
+void trigger_counter_use(edict_t *self, edict_t *other, edict_t *activator);
+void trigger_enable(edict_t *self, edict_t *other, edict_t *activator);
+void trigger_gravity_touch(edict_t *self, edict_t *other, cplane_t *plane, csurface_t *surf);
+void trigger_key_use(edict_t *self, edict_t *other, edict_t *activator);
+void trigger_monsterjump_touch(edict_t *self, edict_t *other, cplane_t *plane, csurface_t *surf);
+void trigger_push_touch(edict_t *self, edict_t *other, cplane_t *plane, csurface_t *surf);
+void trigger_relay_use(edict_t *self, edict_t *other, edict_t *activator);
+
+// g_turret.c
+void turret_blocked(edict_t *self, edict_t *other);
+void turret_breach_finish_init(edict_t *self);
+void turret_breach_think(edict_t *self);
+void turret_driver_die(edict_t *self, edict_t *inflictor, edict_t *attacker, int damage, vec3_t point);
+void turret_driver_link(edict_t *self);
+void turret_driver_think(edict_t *self);
+
+// g_utils.c
+void G_FreeEdict(edict_t *ed);
+void Think_Delay(edict_t *ent);
+
+// g_weapon.c
+void Grenade_Explode(edict_t *ent);
+void Grenade_Touch(edict_t *ent, edict_t *other, cplane_t *plane, csurface_t *surf);
+void bfg_explode(edict_t *self);
+void bfg_think(edict_t *self);
+void bfg_touch(edict_t *self, edict_t *other, cplane_t *plane, csurface_t *surf);
+void blaster_touch(edict_t *self, edict_t *other, cplane_t *plane, csurface_t *surf);
+void rocket_touch(edict_t *ent, edict_t *other, cplane_t *plane, csurface_t *surf);
+
+// monster/m_actor.c
+void actor_attack(edict_t *self);
+void actor_die(edict_t *self, edict_t *inflictor, edict_t *attacker, int damage, vec3_t point);
+void actor_fire(edict_t *self);
+void actor_pain(edict_t *self, edict_t *other, float kick, int damage);
+void actor_run(edict_t *self);
+void actor_stand(edict_t *self);
+void actor_use(edict_t *self, edict_t *other, edict_t *activator);
+void actor_walk(edict_t *self);
+void target_actor_touch(edict_t *self, edict_t *other, cplane_t *plane, csurface_t *surf);
+
+// monster/m_berserk.c
+void berserk_attack_club(edict_t *self);
+void berserk_attack_spike(edict_t *self);
+void berserk_die(edict_t *self, edict_t *inflictor, edict_t *attacker, int damage, vec3_t point);
+void berserk_fidget(edict_t *self);
+void berserk_melee(edict_t *self);
+void berserk_pain(edict_t *self, edict_t *other, float kick, int damage);
+void berserk_run(edict_t *self);
+void berserk_search(edict_t *self);
+void berserk_sight(edict_t *self, edict_t *other);
+void berserk_stand(edict_t *self);
+void berserk_strike(edict_t *self);
+void berserk_swing(edict_t *self);
+void berserk_walk(edict_t *self);
+
+// monster/m_boss2.c
+void Boss2MachineGun(edict_t *self);
+void Boss2Rocket(edict_t *self);
+bool Boss2_CheckAttack(edict_t *self);
+void boss2_attack(edict_t *self);
+void boss2_die(edict_t *self, edict_t *inflictor, edict_t *attacker, int damage, vec3_t point);
+void boss2_pain(edict_t *self, edict_t *other, float kick, int damage);
+void boss2_run(edict_t *self);
+void boss2_search(edict_t *self);
+void boss2_stand(edict_t *self);
+void boss2_walk(edict_t *self);
+
+// monster/m_boss3.c
+void Think_Boss3Stand(edict_t *ent);
+void Use_Boss3(edict_t *ent, edict_t *other, edict_t *activator);
+
+// monster/m_boss31.c
+bool Jorg_CheckAttack(edict_t *self);
+void jorgBFG(edict_t *self);
+void jorg_attack(edict_t *self);
+void jorg_die(edict_t *self, edict_t *inflictor, edict_t *attacker, int damage, vec3_t point);
+void jorg_firebullet(edict_t *self);
+void jorg_idle(edict_t *self);
+void jorg_pain(edict_t *self, edict_t *other, float kick, int damage);
+void jorg_run(edict_t *self);
+void jorg_search(edict_t *self);
+void jorg_stand(edict_t *self);
+void jorg_step_left(edict_t *self);
+void jorg_step_right(edict_t *self);
+void jorg_walk(edict_t *self);
+
+// monster/m_boss32.c
+void MakronHyperblaster(edict_t *self);
+void MakronRailgun(edict_t *self);
+void MakronSaveloc(edict_t *self);
+void MakronSpawn(edict_t *self);
+void MakronToss(edict_t *self);
+bool Makron_CheckAttack(edict_t *self);
+void makronBFG(edict_t *self);
+void makron_attack(edict_t *self);
+void makron_brainsplorch(edict_t *self);
+void makron_die(edict_t *self, edict_t *inflictor, edict_t *attacker, int damage, vec3_t point);
+void makron_hit(edict_t *self);
+void makron_pain(edict_t *self, edict_t *other, float kick, int damage);
+void makron_popup(edict_t *self);
+void makron_prerailgun(edict_t *self);
+void makron_run(edict_t *self);
+void makron_sight(edict_t *self, edict_t *other);
+void makron_stand(edict_t *self);
+void makron_step_left(edict_t *self);
+void makron_step_right(edict_t *self);
+void makron_taunt(edict_t *self);
+void makron_torso_think(edict_t *self);
+void makron_walk(edict_t *self);
+
+// monster/m_brain.c
+void brain_chest_closed(edict_t *self);
+void brain_chest_open(edict_t *self);
+void brain_die(edict_t *self, edict_t *inflictor, edict_t *attacker, int damage, vec3_t point);
+void brain_dodge(edict_t *self, edict_t *attacker, float eta);
+void brain_duck_down(edict_t *self);
+void brain_duck_hold(edict_t *self);
+void brain_duck_up(edict_t *self);
+void brain_hit_left(edict_t *self);
+void brain_hit_right(edict_t *self);
+void brain_idle(edict_t *self);
+void brain_melee(edict_t *self);
+void brain_pain(edict_t *self, edict_t *other, float kick, int damage);
+void brain_run(edict_t *self);
+void brain_search(edict_t *self);
+void brain_sight(edict_t *self, edict_t *other);
+void brain_stand(edict_t *self);
+void brain_swing_left(edict_t *self);
+void brain_swing_right(edict_t *self);
+void brain_tentacle_attack(edict_t *self);
+void brain_walk(edict_t *self);
+void brain_walk2_cycle(edict_t *self);
+
+// monster/m_chick.c
+void ChickMoan(edict_t *self);
+void ChickReload(edict_t *self);
+void ChickRocket(edict_t *self);
+void ChickSlash(edict_t *self);
+void Chick_PreAttack1(edict_t *self);
+void chick_attack(edict_t *self);
+void chick_die(edict_t *self, edict_t *inflictor, edict_t *attacker, int damage, vec3_t point);
+void chick_dodge(edict_t *self, edict_t *attacker, float eta);
+void chick_duck_down(edict_t *self);
+void chick_duck_hold(edict_t *self);
+void chick_duck_up(edict_t *self);
+void chick_fidget(edict_t *self);
+void chick_melee(edict_t *self);
+void chick_pain(edict_t *self, edict_t *other, float kick, int damage);
+void chick_run(edict_t *self);
+void chick_sight(edict_t *self, edict_t *other);
+void chick_stand(edict_t *self);
+void chick_walk(edict_t *self);
+
+// monster/m_flipper.c
+void flipper_bite(edict_t *self);
+void flipper_die(edict_t *self, edict_t *inflictor, edict_t *attacker, int damage, vec3_t point);
+void flipper_melee(edict_t *self);
+void flipper_pain(edict_t *self, edict_t *other, float kick, int damage);
+void flipper_preattack(edict_t *self);
+void flipper_sight(edict_t *self, edict_t *other);
+void flipper_stand(edict_t *self);
+void flipper_start_run(edict_t *self);
+void flipper_walk(edict_t *self);
+
+// monster/m_float.c
+void floater_attack(edict_t *self);
+void floater_die(edict_t *self, edict_t *inflictor, edict_t *attacker, int damage, vec3_t point);
+void floater_fire_blaster(edict_t *self);
+void floater_idle(edict_t *self);
+void floater_melee(edict_t *self);
+void floater_pain(edict_t *self, edict_t *other, float kick, int damage);
+void floater_run(edict_t *self);
+void floater_sight(edict_t *self, edict_t *other);
+void floater_stand(edict_t *self);
+void floater_walk(edict_t *self);
+void floater_wham(edict_t *self);
+void floater_zap(edict_t *self);
+
+// monster/m_flyer.c
+void flyer_attack(edict_t *self);
+void flyer_die(edict_t *self, edict_t *inflictor, edict_t *attacker, int damage, vec3_t point);
+void flyer_fireleft(edict_t *self);
+void flyer_fireright(edict_t *self);
+void flyer_idle(edict_t *self);
+void flyer_melee(edict_t *self);
+void flyer_pain(edict_t *self, edict_t *other, float kick, int damage);
+void flyer_pop_blades(edict_t *self);
+void flyer_run(edict_t *self);
+void flyer_sight(edict_t *self, edict_t *other);
+void flyer_slash_left(edict_t *self);
+void flyer_slash_right(edict_t *self);
+void flyer_stand(edict_t *self);
+void flyer_walk(edict_t *self);
+
+// monster/m_gladiator.c
+void GaldiatorMelee(edict_t *self);
+void GladiatorGun(edict_t *self);
+void gladiator_attack(edict_t *self);
+void gladiator_cleaver_swing(edict_t *self);
+void gladiator_die(edict_t *self, edict_t *inflictor, edict_t *attacker, int damage, vec3_t point);
+void gladiator_idle(edict_t *self);
+void gladiator_melee(edict_t *self);
+void gladiator_pain(edict_t *self, edict_t *other, float kick, int damage);
+void gladiator_run(edict_t *self);
+void gladiator_search(edict_t *self);
+void gladiator_sight(edict_t *self, edict_t *other);
+void gladiator_stand(edict_t *self);
+void gladiator_walk(edict_t *self);
+
+// monster/m_gunner.c
+void GunnerFire(edict_t *self);
+void GunnerGrenade(edict_t *self);
+void gunner_attack(edict_t *self);
+void gunner_die(edict_t *self, edict_t *inflictor, edict_t *attacker, int damage, vec3_t point);
+void gunner_dodge(edict_t *self, edict_t *attacker, float eta);
+void gunner_duck_down(edict_t *self);
+void gunner_duck_hold(edict_t *self);
+void gunner_duck_up(edict_t *self);
+void gunner_fidget(edict_t *self);
+void gunner_idlesound(edict_t *self);
+void gunner_opengun(edict_t *self);
+void gunner_pain(edict_t *self, edict_t *other, float kick, int damage);
+void gunner_run(edict_t *self);
+void gunner_search(edict_t *self);
+void gunner_sight(edict_t *self, edict_t *other);
+void gunner_stand(edict_t *self);
+void gunner_walk(edict_t *self);
+
+// monster/m_hover.c
+void hover_deadthink(edict_t *self);
+void hover_die(edict_t *self, edict_t *inflictor, edict_t *attacker, int damage, vec3_t point);
+void hover_fire_blaster(edict_t *self);
+void hover_pain(edict_t *self, edict_t *other, float kick, int damage);
+void hover_reattack(edict_t *self);
+void hover_run(edict_t *self);
+void hover_search(edict_t *self);
+void hover_sight(edict_t *self, edict_t *other);
+void hover_stand(edict_t *self);
+void hover_start_attack(edict_t *self);
+void hover_walk(edict_t *self);
+
+// monster/m_infantry.c
+void InfantryMachineGun(edict_t *self);
+void infantry_attack(edict_t *self);
+void infantry_cock_gun(edict_t *self);
+void infantry_die(edict_t *self, edict_t *inflictor, edict_t *attacker, int damage, vec3_t point);
+void infantry_dodge(edict_t *self, edict_t *attacker, float eta);
+void infantry_duck_down(edict_t *self);
+void infantry_duck_hold(edict_t *self);
+void infantry_duck_up(edict_t *self);
+void infantry_fidget(edict_t *self);
+void infantry_fire(edict_t *self);
+void infantry_pain(edict_t *self, edict_t *other, float kick, int damage);
+void infantry_run(edict_t *self);
+void infantry_sight(edict_t *self, edict_t *other);
+void infantry_smack(edict_t *self);
+void infantry_stand(edict_t *self);
+void infantry_swing(edict_t *self);
+void infantry_walk(edict_t *self);
+
+// monster/m_insane.c
+void insane_die(edict_t *self, edict_t *inflictor, edict_t *attacker, int damage, vec3_t point);
+void insane_fist(edict_t *self);
+void insane_moan(edict_t *self);
+void insane_pain(edict_t *self, edict_t *other, float kick, int damage);
+void insane_run(edict_t *self);
+void insane_scream(edict_t *self);
+void insane_shake(edict_t *self);
+void insane_stand(edict_t *self);
+void insane_walk(edict_t *self);
+
+// monster/m_medic.c
+void medic_attack(edict_t *self);
+void medic_cable_attack(edict_t *self);
+bool medic_checkattack(edict_t *self);
+void medic_die(edict_t *self, edict_t *inflictor, edict_t *attacker, int damage, vec3_t point);
+void medic_dodge(edict_t *self, edict_t *attacker, float eta);
+void medic_duck_down(edict_t *self);
+void medic_duck_hold(edict_t *self);
+void medic_duck_up(edict_t *self);
+void medic_fire_blaster(edict_t *self);
+void medic_hook_launch(edict_t *self);
+void medic_hook_retract(edict_t *self);
+void medic_idle(edict_t *self);
+void medic_pain(edict_t *self, edict_t *other, float kick, int damage);
+void medic_run(edict_t *self);
+void medic_search(edict_t *self);
+void medic_sight(edict_t *self, edict_t *other);
+void medic_stand(edict_t *self);
+void medic_walk(edict_t *self);
+
+// monster/m_mutant.c
+void mutant_check_landing(edict_t *self);
+bool mutant_checkattack(edict_t *self);
+void mutant_die(edict_t *self, edict_t *inflictor, edict_t *attacker, int damage, vec3_t point);
+void mutant_hit_left(edict_t *self);
+void mutant_hit_right(edict_t *self);
+void mutant_idle(edict_t *self);
+void mutant_idle_loop(edict_t *self);
+void mutant_jump(edict_t *self);
+void mutant_jump_takeoff(edict_t *self);
+void mutant_jump_touch(edict_t *self, edict_t *other, cplane_t *plane, csurface_t *surf);
+void mutant_melee(edict_t *self);
+void mutant_pain(edict_t *self, edict_t *other, float kick, int damage);
+void mutant_run(edict_t *self);
+void mutant_search(edict_t *self);
+void mutant_sight(edict_t *self, edict_t *other);
+void mutant_stand(edict_t *self);
+void mutant_step(edict_t *self);
+void mutant_walk(edict_t *self);
+
+// monster/m_parasite.c
+void parasite_attack(edict_t *self);
+void parasite_die(edict_t *self, edict_t *inflictor, edict_t *attacker, int damage, vec3_t point);
+void parasite_drain_attack(edict_t *self);
+void parasite_idle(edict_t *self);
+void parasite_launch(edict_t *self);
+void parasite_pain(edict_t *self, edict_t *other, float kick, int damage);
+void parasite_reel_in(edict_t *self);
+void parasite_scratch(edict_t *self);
+void parasite_sight(edict_t *self, edict_t *other);
+void parasite_stand(edict_t *self);
+void parasite_start_run(edict_t *self);
+void parasite_start_walk(edict_t *self);
+void parasite_tap(edict_t *self);
+
+// monster/m_soldier.c
+void soldier_attack(edict_t *self);
+void soldier_attack1_refire1(edict_t *self);
+void soldier_attack1_refire2(edict_t *self);
+void soldier_attack2_refire1(edict_t *self);
+void soldier_attack2_refire2(edict_t *self);
+void soldier_attack3_refire(edict_t *self);
+void soldier_cock(edict_t *self);
+void soldier_die(edict_t *self, edict_t *inflictor, edict_t *attacker, int damage, vec3_t point);
+void soldier_dodge(edict_t *self, edict_t *attacker, float eta);
+void soldier_duck_down(edict_t *self);
+void soldier_duck_hold(edict_t *self);
+void soldier_duck_up(edict_t *self);
+void soldier_fire1(edict_t *self);
+void soldier_fire2(edict_t *self);
+void soldier_fire3(edict_t *self);
+void soldier_fire4(edict_t *self);
+void soldier_fire5(edict_t *self);
+void soldier_fire6(edict_t *self);
+void soldier_fire7(edict_t *self);
+void soldier_fire8(edict_t *self);
+void soldier_idle(edict_t *self);
+void soldier_pain(edict_t *self, edict_t *other, float kick, int damage);
+void soldier_run(edict_t *self);
+void soldier_sight(edict_t *self, edict_t *other);
+void soldier_stand(edict_t *self);
+void soldier_walk(edict_t *self);
+void soldier_walk1_random(edict_t *self);
+
+// monster/m_supertank.c
+void BossExplode(edict_t *self);
+void TreadSound(edict_t *self);
+void supertankMachineGun(edict_t *self);
+void supertankRocket(edict_t *self);
+void supertank_attack(edict_t *self);
+void supertank_die(edict_t *self, edict_t *inflictor, edict_t *attacker, int damage, vec3_t point);
+void supertank_pain(edict_t *self, edict_t *other, float kick, int damage);
+void supertank_run(edict_t *self);
+void supertank_search(edict_t *self);
+void supertank_stand(edict_t *self);
+void supertank_walk(edict_t *self);
+
+// monster/m_tank.c
+void TankBlaster(edict_t *self);
+void TankMachineGun(edict_t *self);
+void TankRocket(edict_t *self);
+void TankStrike(edict_t *self);
+void tank_attack(edict_t *self);
+void tank_die(edict_t *self, edict_t *inflictor, edict_t *attacker, int damage, vec3_t point);
+void tank_footstep(edict_t *self);
+void tank_idle(edict_t *self);
+void tank_pain(edict_t *self, edict_t *other, float kick, int damage);
+void tank_run(edict_t *self);
+void tank_sight(edict_t *self, edict_t *other);
+void tank_stand(edict_t *self);
+void tank_thud(edict_t *self);
+void tank_walk(edict_t *self);
+void tank_windup(edict_t *self);
+
+// player/p_client.c
+void ClientBegin(edict_t *ent);
+void ClientDisconnect(edict_t *ent);
+void SP_CreateCoopSpots(edict_t *self);
+void SP_FixCoopSpots(edict_t *self);
+void body_die(edict_t *self, edict_t *inflictor, edict_t *attacker, int damage, vec3_t point);
+void player_die(edict_t *self, edict_t *inflictor, edict_t *attacker, int damage, vec3_t point);
+void player_pain(edict_t *self, edict_t *other, float kick, int damage);
+
+// player/p_weapon.c
+void Chaingun_Fire(edict_t *ent);
+void Machinegun_Fire(edict_t *ent);
+void Weapon_Blaster_Fire(edict_t *ent);
+void Weapon_HyperBlaster_Fire(edict_t *ent);
+void Weapon_RocketLauncher_Fire(edict_t *ent);
+void weapon_bfg_fire(edict_t *ent);
+void weapon_grenadelauncher_fire(edict_t *ent);
+void weapon_railgun_fire(edict_t *ent);
+void weapon_shotgun_fire(edict_t *ent);
+void weapon_supershotgun_fire(edict_t *ent);
+
+// monster moves
+
+// monster/m_actor.c
+extern mmove_t actor_move_attack;
+extern mmove_t actor_move_death1;
+extern mmove_t actor_move_death2;
+extern mmove_t actor_move_flipoff;
+extern mmove_t actor_move_pain1;
+extern mmove_t actor_move_pain2;
+extern mmove_t actor_move_pain3;
+extern mmove_t actor_move_run;
+extern mmove_t actor_move_stand;
+extern mmove_t actor_move_taunt;
+extern mmove_t actor_move_walk;
+
+// monster/m_berserk.c
+extern mmove_t berserk_move_attack_club;
+extern mmove_t berserk_move_attack_spike;
+extern mmove_t berserk_move_attack_strike;
+extern mmove_t berserk_move_death1;
+extern mmove_t berserk_move_death2;
+extern mmove_t berserk_move_pain1;
+extern mmove_t berserk_move_pain2;
+extern mmove_t berserk_move_run1;
+extern mmove_t berserk_move_stand;
+extern mmove_t berserk_move_stand_fidget;
+extern mmove_t berserk_move_walk;
+
+// monster/m_boss2.c
+extern mmove_t boss2_move_attack_mg;
+extern mmove_t boss2_move_attack_post_mg;
+extern mmove_t boss2_move_attack_pre_mg;
+extern mmove_t boss2_move_attack_rocket;
+extern mmove_t boss2_move_death;
+extern mmove_t boss2_move_fidget;
+extern mmove_t boss2_move_pain_heavy;
+extern mmove_t boss2_move_pain_light;
+extern mmove_t boss2_move_run;
+extern mmove_t boss2_move_stand;
+extern mmove_t boss2_move_walk;
+
+// monster/m_boss31.c
+extern mmove_t jorg_move_attack1;
+extern mmove_t jorg_move_attack2;
+extern mmove_t jorg_move_death;
+extern mmove_t jorg_move_end_attack1;
+extern mmove_t jorg_move_end_walk;
+extern mmove_t jorg_move_pain1;
+extern mmove_t jorg_move_pain2;
+extern mmove_t jorg_move_pain3;
+extern mmove_t jorg_move_run;
+extern mmove_t jorg_move_stand;
+extern mmove_t jorg_move_start_attack1;
+extern mmove_t jorg_move_start_walk;
+extern mmove_t jorg_move_walk;
+
+// monster/m_boss32.c
+extern mmove_t makron_move_attack3;
+extern mmove_t makron_move_attack4;
+extern mmove_t makron_move_attack5;
+extern mmove_t makron_move_death2;
+extern mmove_t makron_move_death3;
+extern mmove_t makron_move_pain4;
+extern mmove_t makron_move_pain5;
+extern mmove_t makron_move_pain6;
+extern mmove_t makron_move_run;
+extern mmove_t makron_move_sight;
+extern mmove_t makron_move_stand;
+extern mmove_t makron_move_walk;
+
+// monster/m_brain.c
+extern mmove_t brain_move_attack1;
+extern mmove_t brain_move_attack2;
+extern mmove_t brain_move_death1;
+extern mmove_t brain_move_death2;
+extern mmove_t brain_move_defense;
+extern mmove_t brain_move_duck;
+extern mmove_t brain_move_idle;
+extern mmove_t brain_move_pain1;
+extern mmove_t brain_move_pain2;
+extern mmove_t brain_move_pain3;
+extern mmove_t brain_move_run;
+extern mmove_t brain_move_stand;
+extern mmove_t brain_move_walk1;
+extern mmove_t brain_move_walk2;
+
+// monster/m_chick.c
+extern mmove_t chick_move_attack1;
+extern mmove_t chick_move_death1;
+extern mmove_t chick_move_death2;
+extern mmove_t chick_move_duck;
+extern mmove_t chick_move_end_attack1;
+extern mmove_t chick_move_end_slash;
+extern mmove_t chick_move_fidget;
+extern mmove_t chick_move_pain1;
+extern mmove_t chick_move_pain2;
+extern mmove_t chick_move_pain3;
+extern mmove_t chick_move_run;
+extern mmove_t chick_move_slash;
+extern mmove_t chick_move_stand;
+extern mmove_t chick_move_start_attack1;
+extern mmove_t chick_move_start_run;
+extern mmove_t chick_move_start_slash;
+extern mmove_t chick_move_walk;
+
+// monster/m_flipper.c
+extern mmove_t flipper_move_attack;
+extern mmove_t flipper_move_death;
+extern mmove_t flipper_move_pain1;
+extern mmove_t flipper_move_pain2;
+extern mmove_t flipper_move_run_loop;
+extern mmove_t flipper_move_run_start;
+extern mmove_t flipper_move_stand;
+extern mmove_t flipper_move_start_run;
+extern mmove_t flipper_move_walk;
+
+// monster/m_float.c
+extern mmove_t floater_move_activate;
+extern mmove_t floater_move_attack1;
+extern mmove_t floater_move_attack2;
+extern mmove_t floater_move_attack3;
+extern mmove_t floater_move_death;
+extern mmove_t floater_move_pain1;
+extern mmove_t floater_move_pain2;
+extern mmove_t floater_move_pain3;
+extern mmove_t floater_move_run;
+extern mmove_t floater_move_stand1;
+extern mmove_t floater_move_stand2;
+extern mmove_t floater_move_walk;
+
+// monster/m_flyer.c
+extern mmove_t flyer_move_attack2;
+extern mmove_t flyer_move_bankleft;
+extern mmove_t flyer_move_bankright;
+extern mmove_t flyer_move_defense;
+extern mmove_t flyer_move_end_melee;
+extern mmove_t flyer_move_loop_melee;
+extern mmove_t flyer_move_pain1;
+extern mmove_t flyer_move_pain2;
+extern mmove_t flyer_move_pain3;
+extern mmove_t flyer_move_rollleft;
+extern mmove_t flyer_move_rollright;
+extern mmove_t flyer_move_run;
+extern mmove_t flyer_move_stand;
+extern mmove_t flyer_move_start;
+extern mmove_t flyer_move_start_melee;
+extern mmove_t flyer_move_stop;
+extern mmove_t flyer_move_walk;
+
+// monster/m_gladiator.c
+extern mmove_t gladiator_move_attack_gun;
+extern mmove_t gladiator_move_attack_melee;
+extern mmove_t gladiator_move_death;
+extern mmove_t gladiator_move_pain;
+extern mmove_t gladiator_move_pain_air;
+extern mmove_t gladiator_move_run;
+extern mmove_t gladiator_move_stand;
+extern mmove_t gladiator_move_walk;
+
+// monster/m_gunner.c
+extern mmove_t gunner_move_attack_chain;
+extern mmove_t gunner_move_attack_grenade;
+extern mmove_t gunner_move_death;
+extern mmove_t gunner_move_duck;
+extern mmove_t gunner_move_endfire_chain;
+extern mmove_t gunner_move_fidget;
+extern mmove_t gunner_move_fire_chain;
+extern mmove_t gunner_move_pain1;
+extern mmove_t gunner_move_pain2;
+extern mmove_t gunner_move_pain3;
+extern mmove_t gunner_move_run;
+extern mmove_t gunner_move_runandshoot;
+extern mmove_t gunner_move_stand;
+extern mmove_t gunner_move_walk;
+
+// monster/m_hover.c
+extern mmove_t hover_move_attack1;
+extern mmove_t hover_move_backward;
+extern mmove_t hover_move_death1;
+extern mmove_t hover_move_end_attack;
+extern mmove_t hover_move_forward;
+extern mmove_t hover_move_land;
+extern mmove_t hover_move_pain1;
+extern mmove_t hover_move_pain2;
+extern mmove_t hover_move_pain3;
+extern mmove_t hover_move_run;
+extern mmove_t hover_move_stand;
+extern mmove_t hover_move_start_attack;
+extern mmove_t hover_move_stop1;
+extern mmove_t hover_move_stop2;
+extern mmove_t hover_move_takeoff;
+extern mmove_t hover_move_walk;
+
+// monster/m_infantry.c
+extern mmove_t infantry_move_attack1;
+extern mmove_t infantry_move_attack2;
+extern mmove_t infantry_move_death1;
+extern mmove_t infantry_move_death2;
+extern mmove_t infantry_move_death3;
+extern mmove_t infantry_move_duck;
+extern mmove_t infantry_move_fidget;
+extern mmove_t infantry_move_pain1;
+extern mmove_t infantry_move_pain2;
+extern mmove_t infantry_move_run;
+extern mmove_t infantry_move_stand;
+extern mmove_t infantry_move_walk;
+
+// monster/m_insane.c
+extern mmove_t insane_move_crawl;
+extern mmove_t insane_move_crawl_death;
+extern mmove_t insane_move_crawl_pain;
+extern mmove_t insane_move_cross;
+extern mmove_t insane_move_down;
+extern mmove_t insane_move_downtoup;
+extern mmove_t insane_move_jumpdown;
+extern mmove_t insane_move_run_insane;
+extern mmove_t insane_move_run_normal;
+extern mmove_t insane_move_runcrawl;
+extern mmove_t insane_move_stand_death;
+extern mmove_t insane_move_stand_insane;
+extern mmove_t insane_move_stand_normal;
+extern mmove_t insane_move_stand_pain;
+extern mmove_t insane_move_struggle_cross;
+extern mmove_t insane_move_uptodown;
+extern mmove_t insane_move_walk_insane;
+extern mmove_t insane_move_walk_normal;
+
+// monster/m_medic.c
+extern mmove_t medic_move_attackBlaster;
+extern mmove_t medic_move_attackCable;
+extern mmove_t medic_move_attackHyperBlaster;
+extern mmove_t medic_move_death;
+extern mmove_t medic_move_duck;
+extern mmove_t medic_move_pain1;
+extern mmove_t medic_move_pain2;
+extern mmove_t medic_move_run;
+extern mmove_t medic_move_stand;
+extern mmove_t medic_move_walk;
+
+// monster/m_mutant.c
+extern mmove_t mutant_move_attack;
+extern mmove_t mutant_move_death1;
+extern mmove_t mutant_move_death2;
+extern mmove_t mutant_move_idle;
+extern mmove_t mutant_move_jump;
+extern mmove_t mutant_move_pain1;
+extern mmove_t mutant_move_pain2;
+extern mmove_t mutant_move_pain3;
+extern mmove_t mutant_move_run;
+extern mmove_t mutant_move_stand;
+extern mmove_t mutant_move_start_walk;
+extern mmove_t mutant_move_walk;
+
+// monster/m_parasite.c
+extern mmove_t parasite_move_break;
+extern mmove_t parasite_move_death;
+extern mmove_t parasite_move_drain;
+extern mmove_t parasite_move_end_fidget;
+extern mmove_t parasite_move_fidget;
+extern mmove_t parasite_move_pain1;
+extern mmove_t parasite_move_run;
+extern mmove_t parasite_move_stand;
+extern mmove_t parasite_move_start_fidget;
+extern mmove_t parasite_move_start_run;
+extern mmove_t parasite_move_start_walk;
+extern mmove_t parasite_move_stop_run;
+extern mmove_t parasite_move_stop_walk;
+extern mmove_t parasite_move_walk;
+
+// monster/m_soldier.c
+extern mmove_t soldier_move_attack1;
+extern mmove_t soldier_move_attack2;
+extern mmove_t soldier_move_attack3;
+extern mmove_t soldier_move_attack4;
+extern mmove_t soldier_move_attack5;
+extern mmove_t soldier_move_attack6;
+extern mmove_t soldier_move_death1;
+extern mmove_t soldier_move_death2;
+extern mmove_t soldier_move_death3;
+extern mmove_t soldier_move_death4;
+extern mmove_t soldier_move_death5;
+extern mmove_t soldier_move_death6;
+extern mmove_t soldier_move_duck;
+extern mmove_t soldier_move_pain1;
+extern mmove_t soldier_move_pain2;
+extern mmove_t soldier_move_pain3;
+extern mmove_t soldier_move_pain4;
+extern mmove_t soldier_move_run;
+extern mmove_t soldier_move_stand1;
+extern mmove_t soldier_move_stand3;
+extern mmove_t soldier_move_stand4;
+extern mmove_t soldier_move_start_run;
+extern mmove_t soldier_move_walk1;
+extern mmove_t soldier_move_walk2;
+
+// monster/m_supertank.c
+extern mmove_t supertank_move_attack1;
+extern mmove_t supertank_move_attack2;
+extern mmove_t supertank_move_attack3;
+extern mmove_t supertank_move_attack4;
+extern mmove_t supertank_move_backward;
+extern mmove_t supertank_move_death;
+extern mmove_t supertank_move_end_attack1;
+extern mmove_t supertank_move_forward;
+extern mmove_t supertank_move_pain1;
+extern mmove_t supertank_move_pain2;
+extern mmove_t supertank_move_pain3;
+extern mmove_t supertank_move_run;
+extern mmove_t supertank_move_stand;
+extern mmove_t supertank_move_turn_left;
+extern mmove_t supertank_move_turn_right;
+
+// monster/m_tank.c
+extern mmove_t tank_move_attack_blast;
+extern mmove_t tank_move_attack_chain;
+extern mmove_t tank_move_attack_fire_rocket;
+extern mmove_t tank_move_attack_post_blast;
+extern mmove_t tank_move_attack_post_rocket;
+extern mmove_t tank_move_attack_pre_rocket;
+extern mmove_t tank_move_attack_strike;
+extern mmove_t tank_move_death;
+extern mmove_t tank_move_pain1;
+extern mmove_t tank_move_pain2;
+extern mmove_t tank_move_pain3;
+extern mmove_t tank_move_reattack_blast;
+extern mmove_t tank_move_run;
+extern mmove_t tank_move_stand;
+extern mmove_t tank_move_start_run;
+extern mmove_t tank_move_start_walk;
+extern mmove_t tank_move_stop_run;
+extern mmove_t tank_move_stop_walk;
+extern mmove_t tank_move_walk;
+
+static savepointer_t save_functions[] = {
+    SAVE_FUNCTION(AngleMove_Begin),
+    SAVE_FUNCTION(AngleMove_Done),
+    SAVE_FUNCTION(AngleMove_Final),
+    SAVE_FUNCTION(Boss2MachineGun),
+    SAVE_FUNCTION(Boss2Rocket),
+    SAVE_FUNCTION(Boss2_CheckAttack),
+    SAVE_FUNCTION(BossExplode),
+    SAVE_FUNCTION(Chaingun_Fire),
+    SAVE_FUNCTION(ChickMoan),
+    SAVE_FUNCTION(ChickReload),
+    SAVE_FUNCTION(ChickRocket),
+    SAVE_FUNCTION(ChickSlash),
+    SAVE_FUNCTION(Chick_PreAttack1),
+    SAVE_FUNCTION(ClientBegin),
+    SAVE_FUNCTION(ClientCommand),
+    SAVE_FUNCTION(ClientDisconnect),
+    SAVE_FUNCTION(DoRespawn),
+    SAVE_FUNCTION(G_FreeEdict),
+    SAVE_FUNCTION(GaldiatorMelee),
+    SAVE_FUNCTION(GladiatorGun),
+    SAVE_FUNCTION(Grenade_Explode),
+    SAVE_FUNCTION(Grenade_Touch),
+    SAVE_FUNCTION(GunnerFire),
+    SAVE_FUNCTION(GunnerGrenade),
+    SAVE_FUNCTION(InfantryMachineGun),
+    SAVE_FUNCTION(Jorg_CheckAttack),
+    SAVE_FUNCTION(M_CheckAttack),
+    SAVE_FUNCTION(M_FliesOff),
+    SAVE_FUNCTION(M_FliesOn),
+    SAVE_FUNCTION(M_droptofloor),
+    SAVE_FUNCTION(Machinegun_Fire),
+    SAVE_FUNCTION(MakronHyperblaster),
+    SAVE_FUNCTION(MakronRailgun),
+    SAVE_FUNCTION(MakronSaveloc),
+    SAVE_FUNCTION(MakronSpawn),
+    SAVE_FUNCTION(MakronToss),
+    SAVE_FUNCTION(Makron_CheckAttack),
+    SAVE_FUNCTION(MegaHealth_think),
+    SAVE_FUNCTION(Move_Begin),
+    SAVE_FUNCTION(Move_Done),
+    SAVE_FUNCTION(Move_Final),
+    SAVE_FUNCTION(SP_CreateCoopSpots),
+    SAVE_FUNCTION(SP_FixCoopSpots),
+    SAVE_FUNCTION(TH_viewthing),
+    SAVE_FUNCTION(TankBlaster),
+    SAVE_FUNCTION(TankMachineGun),
+    SAVE_FUNCTION(TankRocket),
+    SAVE_FUNCTION(TankStrike),
+    SAVE_FUNCTION(Think_AccelMove),
+    SAVE_FUNCTION(Think_Boss3Stand),
+    SAVE_FUNCTION(Think_CalcMoveSpeed),
+    SAVE_FUNCTION(Think_Delay),
+    SAVE_FUNCTION(Think_SpawnDoorTrigger),
+    SAVE_FUNCTION(Touch_DoorTrigger),
+    SAVE_FUNCTION(Touch_Item),
+    SAVE_FUNCTION(Touch_Multi),
+    SAVE_FUNCTION(Touch_Plat_Center),
+    SAVE_FUNCTION(TreadSound),
+    SAVE_FUNCTION(Use_Areaportal),
+    SAVE_FUNCTION(Use_Boss3),
+    SAVE_FUNCTION(Use_Item),
+    SAVE_FUNCTION(Use_Multi),
+    SAVE_FUNCTION(Use_Plat),
+    SAVE_FUNCTION(Use_Target_Help),
+    SAVE_FUNCTION(Use_Target_Speaker),
+    SAVE_FUNCTION(Use_Target_Tent),
+    SAVE_FUNCTION(Weapon_Blaster_Fire),
+    SAVE_FUNCTION(Weapon_HyperBlaster_Fire),
+    SAVE_FUNCTION(Weapon_RocketLauncher_Fire),
+    SAVE_FUNCTION(actor_attack),
+    SAVE_FUNCTION(actor_die),
+    SAVE_FUNCTION(actor_fire),
+    SAVE_FUNCTION(actor_pain),
+    SAVE_FUNCTION(actor_run),
+    SAVE_FUNCTION(actor_stand),
+    SAVE_FUNCTION(actor_use),
+    SAVE_FUNCTION(actor_walk),
+    SAVE_FUNCTION(barrel_delay),
+    SAVE_FUNCTION(barrel_explode),
+    SAVE_FUNCTION(barrel_touch),
+    SAVE_FUNCTION(berserk_attack_club),
+    SAVE_FUNCTION(berserk_attack_spike),
+    SAVE_FUNCTION(berserk_die),
+    SAVE_FUNCTION(berserk_fidget),
+    SAVE_FUNCTION(berserk_melee),
+    SAVE_FUNCTION(berserk_pain),
+    SAVE_FUNCTION(berserk_run),
+    SAVE_FUNCTION(berserk_search),
+    SAVE_FUNCTION(berserk_sight),
+    SAVE_FUNCTION(berserk_stand),
+    SAVE_FUNCTION(berserk_strike),
+    SAVE_FUNCTION(berserk_swing),
+    SAVE_FUNCTION(berserk_walk),
+    SAVE_FUNCTION(bfg_explode),
+    SAVE_FUNCTION(bfg_think),
+    SAVE_FUNCTION(bfg_touch),
+    SAVE_FUNCTION(blaster_touch),
+    SAVE_FUNCTION(body_die),
+    SAVE_FUNCTION(boss2_attack),
+    SAVE_FUNCTION(boss2_die),
+    SAVE_FUNCTION(boss2_pain),
+    SAVE_FUNCTION(boss2_run),
+    SAVE_FUNCTION(boss2_search),
+    SAVE_FUNCTION(boss2_stand),
+    SAVE_FUNCTION(boss2_walk),
+    SAVE_FUNCTION(brain_chest_closed),
+    SAVE_FUNCTION(brain_chest_open),
+    SAVE_FUNCTION(brain_die),
+    SAVE_FUNCTION(brain_dodge),
+    SAVE_FUNCTION(brain_duck_down),
+    SAVE_FUNCTION(brain_duck_hold),
+    SAVE_FUNCTION(brain_duck_up),
+    SAVE_FUNCTION(brain_hit_left),
+    SAVE_FUNCTION(brain_hit_right),
+    SAVE_FUNCTION(brain_idle),
+    SAVE_FUNCTION(brain_melee),
+    SAVE_FUNCTION(brain_pain),
+    SAVE_FUNCTION(brain_run),
+    SAVE_FUNCTION(brain_search),
+    SAVE_FUNCTION(brain_sight),
+    SAVE_FUNCTION(brain_stand),
+    SAVE_FUNCTION(brain_swing_left),
+    SAVE_FUNCTION(brain_swing_right),
+    SAVE_FUNCTION(brain_tentacle_attack),
+    SAVE_FUNCTION(brain_walk),
+    SAVE_FUNCTION(brain_walk2_cycle),
+    SAVE_FUNCTION(button_done),
+    SAVE_FUNCTION(button_killed),
+    SAVE_FUNCTION(button_return),
+    SAVE_FUNCTION(button_touch),
+    SAVE_FUNCTION(button_use),
+    SAVE_FUNCTION(button_wait),
+    SAVE_FUNCTION(chick_attack),
+    SAVE_FUNCTION(chick_die),
+    SAVE_FUNCTION(chick_dodge),
+    SAVE_FUNCTION(chick_duck_down),
+    SAVE_FUNCTION(chick_duck_hold),
+    SAVE_FUNCTION(chick_duck_up),
+    SAVE_FUNCTION(chick_fidget),
+    SAVE_FUNCTION(chick_melee),
+    SAVE_FUNCTION(chick_pain),
+    SAVE_FUNCTION(chick_run),
+    SAVE_FUNCTION(chick_sight),
+    SAVE_FUNCTION(chick_stand),
+    SAVE_FUNCTION(chick_walk),
+    SAVE_FUNCTION(commander_body_drop),
+    SAVE_FUNCTION(commander_body_think),
+    SAVE_FUNCTION(commander_body_use),
+    SAVE_FUNCTION(debris_die),
+    SAVE_FUNCTION(door_blocked),
+    SAVE_FUNCTION(door_go_down),
+    SAVE_FUNCTION(door_hit_bottom),
+    SAVE_FUNCTION(door_hit_top),
+    SAVE_FUNCTION(door_killed),
+    SAVE_FUNCTION(door_secret_blocked),
+    SAVE_FUNCTION(door_secret_die),
+    SAVE_FUNCTION(door_secret_done),
+    SAVE_FUNCTION(door_secret_move1),
+    SAVE_FUNCTION(door_secret_move2),
+    SAVE_FUNCTION(door_secret_move3),
+    SAVE_FUNCTION(door_secret_move4),
+    SAVE_FUNCTION(door_secret_move5),
+    SAVE_FUNCTION(door_secret_move6),
+    SAVE_FUNCTION(door_secret_use),
+    SAVE_FUNCTION(door_touch),
+    SAVE_FUNCTION(door_use),
+    SAVE_FUNCTION(drop_make_touchable),
+    SAVE_FUNCTION(drop_temp_touch),
+    SAVE_FUNCTION(droptofloor),
+    SAVE_FUNCTION(flipper_bite),
+    SAVE_FUNCTION(flipper_die),
+    SAVE_FUNCTION(flipper_melee),
+    SAVE_FUNCTION(flipper_pain),
+    SAVE_FUNCTION(flipper_preattack),
+    SAVE_FUNCTION(flipper_sight),
+    SAVE_FUNCTION(flipper_stand),
+    SAVE_FUNCTION(flipper_start_run),
+    SAVE_FUNCTION(flipper_walk),
+    SAVE_FUNCTION(floater_attack),
+    SAVE_FUNCTION(floater_die),
+    SAVE_FUNCTION(floater_fire_blaster),
+    SAVE_FUNCTION(floater_idle),
+    SAVE_FUNCTION(floater_melee),
+    SAVE_FUNCTION(floater_pain),
+    SAVE_FUNCTION(floater_run),
+    SAVE_FUNCTION(floater_sight),
+    SAVE_FUNCTION(floater_stand),
+    SAVE_FUNCTION(floater_walk),
+    SAVE_FUNCTION(floater_wham),
+    SAVE_FUNCTION(floater_zap),
+    SAVE_FUNCTION(flyer_attack),
+    SAVE_FUNCTION(flyer_die),
+    SAVE_FUNCTION(flyer_fireleft),
+    SAVE_FUNCTION(flyer_fireright),
+    SAVE_FUNCTION(flyer_idle),
+    SAVE_FUNCTION(flyer_melee),
+    SAVE_FUNCTION(flyer_pain),
+    SAVE_FUNCTION(flyer_pop_blades),
+    SAVE_FUNCTION(flyer_run),
+    SAVE_FUNCTION(flyer_sight),
+    SAVE_FUNCTION(flyer_slash_left),
+    SAVE_FUNCTION(flyer_slash_right),
+    SAVE_FUNCTION(flyer_stand),
+    SAVE_FUNCTION(flyer_walk),
+    SAVE_FUNCTION(flymonster_start_go),
+    SAVE_FUNCTION(func_clock_think),
+    SAVE_FUNCTION(func_clock_use),
+    SAVE_FUNCTION(func_conveyor_use),
+    SAVE_FUNCTION(func_explosive_explode),
+    SAVE_FUNCTION(func_explosive_spawn),
+    SAVE_FUNCTION(func_explosive_use),
+    SAVE_FUNCTION(func_object_release),
+    SAVE_FUNCTION(func_object_touch),
+    SAVE_FUNCTION(func_object_use),
+    SAVE_FUNCTION(func_timer_think),
+    SAVE_FUNCTION(func_timer_use),
+    SAVE_FUNCTION(func_train_find),
+    SAVE_FUNCTION(func_wall_use),
+    SAVE_FUNCTION(gib_die),
+    SAVE_FUNCTION(gib_think),
+    SAVE_FUNCTION(gib_touch),
+    SAVE_FUNCTION(gladiator_attack),
+    SAVE_FUNCTION(gladiator_cleaver_swing),
+    SAVE_FUNCTION(gladiator_die),
+    SAVE_FUNCTION(gladiator_idle),
+    SAVE_FUNCTION(gladiator_melee),
+    SAVE_FUNCTION(gladiator_pain),
+    SAVE_FUNCTION(gladiator_run),
+    SAVE_FUNCTION(gladiator_search),
+    SAVE_FUNCTION(gladiator_sight),
+    SAVE_FUNCTION(gladiator_stand),
+    SAVE_FUNCTION(gladiator_walk),
+    SAVE_FUNCTION(gunner_attack),
+    SAVE_FUNCTION(gunner_die),
+    SAVE_FUNCTION(gunner_dodge),
+    SAVE_FUNCTION(gunner_duck_down),
+    SAVE_FUNCTION(gunner_duck_hold),
+    SAVE_FUNCTION(gunner_duck_up),
+    SAVE_FUNCTION(gunner_fidget),
+    SAVE_FUNCTION(gunner_idlesound),
+    SAVE_FUNCTION(gunner_opengun),
+    SAVE_FUNCTION(gunner_pain),
+    SAVE_FUNCTION(gunner_run),
+    SAVE_FUNCTION(gunner_search),
+    SAVE_FUNCTION(gunner_sight),
+    SAVE_FUNCTION(gunner_stand),
+    SAVE_FUNCTION(gunner_walk),
+    SAVE_FUNCTION(hover_deadthink),
+    SAVE_FUNCTION(hover_die),
+    SAVE_FUNCTION(hover_fire_blaster),
+    SAVE_FUNCTION(hover_pain),
+    SAVE_FUNCTION(hover_reattack),
+    SAVE_FUNCTION(hover_run),
+    SAVE_FUNCTION(hover_search),
+    SAVE_FUNCTION(hover_sight),
+    SAVE_FUNCTION(hover_stand),
+    SAVE_FUNCTION(hover_start_attack),
+    SAVE_FUNCTION(hover_walk),
+    SAVE_FUNCTION(hurt_touch),
+    SAVE_FUNCTION(hurt_use),
+    SAVE_FUNCTION(infantry_attack),
+    SAVE_FUNCTION(infantry_cock_gun),
+    SAVE_FUNCTION(infantry_die),
+    SAVE_FUNCTION(infantry_dodge),
+    SAVE_FUNCTION(infantry_duck_down),
+    SAVE_FUNCTION(infantry_duck_hold),
+    SAVE_FUNCTION(infantry_duck_up),
+    SAVE_FUNCTION(infantry_fidget),
+    SAVE_FUNCTION(infantry_fire),
+    SAVE_FUNCTION(infantry_pain),
+    SAVE_FUNCTION(infantry_run),
+    SAVE_FUNCTION(infantry_sight),
+    SAVE_FUNCTION(infantry_smack),
+    SAVE_FUNCTION(infantry_stand),
+    SAVE_FUNCTION(infantry_swing),
+    SAVE_FUNCTION(infantry_walk),
+    SAVE_FUNCTION(insane_die),
+    SAVE_FUNCTION(insane_fist),
+    SAVE_FUNCTION(insane_moan),
+    SAVE_FUNCTION(insane_pain),
+    SAVE_FUNCTION(insane_run),
+    SAVE_FUNCTION(insane_scream),
+    SAVE_FUNCTION(insane_shake),
+    SAVE_FUNCTION(insane_stand),
+    SAVE_FUNCTION(insane_walk),
+    SAVE_FUNCTION(jorgBFG),
+    SAVE_FUNCTION(jorg_attack),
+    SAVE_FUNCTION(jorg_die),
+    SAVE_FUNCTION(jorg_firebullet),
+    SAVE_FUNCTION(jorg_idle),
+    SAVE_FUNCTION(jorg_pain),
+    SAVE_FUNCTION(jorg_run),
+    SAVE_FUNCTION(jorg_search),
+    SAVE_FUNCTION(jorg_stand),
+    SAVE_FUNCTION(jorg_step_left),
+    SAVE_FUNCTION(jorg_step_right),
+    SAVE_FUNCTION(jorg_walk),
+    SAVE_FUNCTION(light_use),
+    SAVE_FUNCTION(makronBFG),
+    SAVE_FUNCTION(makron_attack),
+    SAVE_FUNCTION(makron_brainsplorch),
+    SAVE_FUNCTION(makron_die),
+    SAVE_FUNCTION(makron_hit),
+    SAVE_FUNCTION(makron_pain),
+    SAVE_FUNCTION(makron_popup),
+    SAVE_FUNCTION(makron_prerailgun),
+    SAVE_FUNCTION(makron_run),
+    SAVE_FUNCTION(makron_sight),
+    SAVE_FUNCTION(makron_stand),
+    SAVE_FUNCTION(makron_step_left),
+    SAVE_FUNCTION(makron_step_right),
+    SAVE_FUNCTION(makron_taunt),
+    SAVE_FUNCTION(makron_torso_think),
+    SAVE_FUNCTION(makron_walk),
+    SAVE_FUNCTION(medic_attack),
+    SAVE_FUNCTION(medic_cable_attack),
+    SAVE_FUNCTION(medic_checkattack),
+    SAVE_FUNCTION(medic_die),
+    SAVE_FUNCTION(medic_dodge),
+    SAVE_FUNCTION(medic_duck_down),
+    SAVE_FUNCTION(medic_duck_hold),
+    SAVE_FUNCTION(medic_duck_up),
+    SAVE_FUNCTION(medic_fire_blaster),
+    SAVE_FUNCTION(medic_hook_launch),
+    SAVE_FUNCTION(medic_hook_retract),
+    SAVE_FUNCTION(medic_idle),
+    SAVE_FUNCTION(medic_pain),
+    SAVE_FUNCTION(medic_run),
+    SAVE_FUNCTION(medic_search),
+    SAVE_FUNCTION(medic_sight),
+    SAVE_FUNCTION(medic_stand),
+    SAVE_FUNCTION(medic_walk),
+    SAVE_FUNCTION(misc_banner_think),
+    SAVE_FUNCTION(misc_blackhole_think),
+    SAVE_FUNCTION(misc_blackhole_use),
+    SAVE_FUNCTION(misc_deadsoldier_die),
+    SAVE_FUNCTION(misc_easterchick2_think),
+    SAVE_FUNCTION(misc_easterchick_think),
+    SAVE_FUNCTION(misc_eastertank_think),
+    SAVE_FUNCTION(misc_satellite_dish_think),
+    SAVE_FUNCTION(misc_satellite_dish_use),
+    SAVE_FUNCTION(misc_strogg_ship_use),
+    SAVE_FUNCTION(misc_viper_bomb_prethink),
+    SAVE_FUNCTION(misc_viper_bomb_touch),
+    SAVE_FUNCTION(misc_viper_bomb_use),
+    SAVE_FUNCTION(misc_viper_use),
+    SAVE_FUNCTION(monster_think),
+    SAVE_FUNCTION(monster_triggered_spawn),
+    SAVE_FUNCTION(monster_triggered_spawn_use),
+    SAVE_FUNCTION(monster_use),
+    SAVE_FUNCTION(multi_wait),
+    SAVE_FUNCTION(mutant_check_landing),
+    SAVE_FUNCTION(mutant_checkattack),
+    SAVE_FUNCTION(mutant_die),
+    SAVE_FUNCTION(mutant_hit_left),
+    SAVE_FUNCTION(mutant_hit_right),
+    SAVE_FUNCTION(mutant_idle),
+    SAVE_FUNCTION(mutant_idle_loop),
+    SAVE_FUNCTION(mutant_jump),
+    SAVE_FUNCTION(mutant_jump_takeoff),
+    SAVE_FUNCTION(mutant_jump_touch),
+    SAVE_FUNCTION(mutant_melee),
+    SAVE_FUNCTION(mutant_pain),
+    SAVE_FUNCTION(mutant_run),
+    SAVE_FUNCTION(mutant_search),
+    SAVE_FUNCTION(mutant_sight),
+    SAVE_FUNCTION(mutant_stand),
+    SAVE_FUNCTION(mutant_step),
+    SAVE_FUNCTION(mutant_walk),
+    SAVE_FUNCTION(parasite_attack),
+    SAVE_FUNCTION(parasite_die),
+    SAVE_FUNCTION(parasite_drain_attack),
+    SAVE_FUNCTION(parasite_idle),
+    SAVE_FUNCTION(parasite_launch),
+    SAVE_FUNCTION(parasite_pain),
+    SAVE_FUNCTION(parasite_reel_in),
+    SAVE_FUNCTION(parasite_scratch),
+    SAVE_FUNCTION(parasite_sight),
+    SAVE_FUNCTION(parasite_stand),
+    SAVE_FUNCTION(parasite_start_run),
+    SAVE_FUNCTION(parasite_start_walk),
+    SAVE_FUNCTION(parasite_tap),
+    SAVE_FUNCTION(path_corner_touch),
+    SAVE_FUNCTION(plat_blocked),
+    SAVE_FUNCTION(plat_go_down),
+    SAVE_FUNCTION(plat_hit_bottom),
+    SAVE_FUNCTION(plat_hit_top),
+    SAVE_FUNCTION(player_die),
+    SAVE_FUNCTION(player_pain),
+    SAVE_FUNCTION(point_combat_touch),
+    SAVE_FUNCTION(redeploy_touch),
+    SAVE_FUNCTION(rocket_touch),
+    SAVE_FUNCTION(rotating_blocked),
+    SAVE_FUNCTION(rotating_touch),
+    SAVE_FUNCTION(rotating_use),
+    SAVE_FUNCTION(soldier_attack),
+    SAVE_FUNCTION(soldier_attack1_refire1),
+    SAVE_FUNCTION(soldier_attack1_refire2),
+    SAVE_FUNCTION(soldier_attack2_refire1),
+    SAVE_FUNCTION(soldier_attack2_refire2),
+    SAVE_FUNCTION(soldier_attack3_refire),
+    SAVE_FUNCTION(soldier_cock),
+    SAVE_FUNCTION(soldier_die),
+    SAVE_FUNCTION(soldier_dodge),
+    SAVE_FUNCTION(soldier_duck_down),
+    SAVE_FUNCTION(soldier_duck_hold),
+    SAVE_FUNCTION(soldier_duck_up),
+    SAVE_FUNCTION(soldier_fire1),
+    SAVE_FUNCTION(soldier_fire2),
+    SAVE_FUNCTION(soldier_fire3),
+    SAVE_FUNCTION(soldier_fire4),
+    SAVE_FUNCTION(soldier_fire5),
+    SAVE_FUNCTION(soldier_fire6),
+    SAVE_FUNCTION(soldier_fire7),
+    SAVE_FUNCTION(soldier_fire8),
+    SAVE_FUNCTION(soldier_idle),
+    SAVE_FUNCTION(soldier_pain),
+    SAVE_FUNCTION(soldier_run),
+    SAVE_FUNCTION(soldier_sight),
+    SAVE_FUNCTION(soldier_stand),
+    SAVE_FUNCTION(soldier_walk),
+    SAVE_FUNCTION(soldier_walk1_random),
+    SAVE_FUNCTION(supertankMachineGun),
+    SAVE_FUNCTION(supertankRocket),
+    SAVE_FUNCTION(supertank_attack),
+    SAVE_FUNCTION(supertank_die),
+    SAVE_FUNCTION(supertank_pain),
+    SAVE_FUNCTION(supertank_run),
+    SAVE_FUNCTION(supertank_search),
+    SAVE_FUNCTION(supertank_stand),
+    SAVE_FUNCTION(supertank_walk),
+    SAVE_FUNCTION(swimmonster_start_go),
+    SAVE_FUNCTION(tank_attack),
+    SAVE_FUNCTION(tank_die),
+    SAVE_FUNCTION(tank_footstep),
+    SAVE_FUNCTION(tank_idle),
+    SAVE_FUNCTION(tank_pain),
+    SAVE_FUNCTION(tank_run),
+    SAVE_FUNCTION(tank_sight),
+    SAVE_FUNCTION(tank_stand),
+    SAVE_FUNCTION(tank_thud),
+    SAVE_FUNCTION(tank_walk),
+    SAVE_FUNCTION(tank_windup),
+    SAVE_FUNCTION(target_actor_touch),
+    SAVE_FUNCTION(target_crosslevel_target_think),
+    SAVE_FUNCTION(target_earthquake_think),
+    SAVE_FUNCTION(target_earthquake_use),
+    SAVE_FUNCTION(target_explosion_explode),
+    SAVE_FUNCTION(target_laser_start),
+    SAVE_FUNCTION(target_laser_think),
+    SAVE_FUNCTION(target_laser_use),
+    SAVE_FUNCTION(target_lightramp_think),
+    SAVE_FUNCTION(target_lightramp_use),
+    SAVE_FUNCTION(target_string_use),
+    SAVE_FUNCTION(teleporter_touch),
+    SAVE_FUNCTION(train_blocked),
+    SAVE_FUNCTION(train_next),
+    SAVE_FUNCTION(train_use),
+    SAVE_FUNCTION(train_wait),
+    SAVE_FUNCTION(trigger_counter_use),
+    SAVE_FUNCTION(trigger_crosslevel_trigger_use),
+    SAVE_FUNCTION(trigger_elevator_init),
+    SAVE_FUNCTION(trigger_elevator_use),
+    SAVE_FUNCTION(trigger_enable),
+    SAVE_FUNCTION(trigger_gravity_touch),
+    SAVE_FUNCTION(trigger_key_use),
+    SAVE_FUNCTION(trigger_monsterjump_touch),
+    SAVE_FUNCTION(trigger_push_touch),
+    SAVE_FUNCTION(trigger_relay_use),
+    SAVE_FUNCTION(turret_blocked),
+    SAVE_FUNCTION(turret_breach_finish_init),
+    SAVE_FUNCTION(turret_breach_think),
+    SAVE_FUNCTION(turret_driver_die),
+    SAVE_FUNCTION(turret_driver_link),
+    SAVE_FUNCTION(turret_driver_think),
+    SAVE_FUNCTION(use_killbox),
+    SAVE_FUNCTION(use_target_blaster),
+    SAVE_FUNCTION(use_target_changelevel),
+    SAVE_FUNCTION(use_target_explosion),
+    SAVE_FUNCTION(use_target_goal),
+    SAVE_FUNCTION(use_target_secret),
+    SAVE_FUNCTION(use_target_spawner),
+    SAVE_FUNCTION(use_target_splash),
+    SAVE_FUNCTION(walkmonster_start_go),
+    SAVE_FUNCTION(weapon_bfg_fire),
+    SAVE_FUNCTION(weapon_grenadelauncher_fire),
+    SAVE_FUNCTION(weapon_railgun_fire),
+    SAVE_FUNCTION(weapon_shotgun_fire),
+    SAVE_FUNCTION(weapon_supershotgun_fire),
+};
+
+static savepointer_t save_mmoves[] = {
+    SAVE_MMOVE(actor_move_attack),
+    SAVE_MMOVE(actor_move_death1),
+    SAVE_MMOVE(actor_move_death2),
+    SAVE_MMOVE(actor_move_flipoff),
+    SAVE_MMOVE(actor_move_pain1),
+    SAVE_MMOVE(actor_move_pain2),
+    SAVE_MMOVE(actor_move_pain3),
+    SAVE_MMOVE(actor_move_run),
+    SAVE_MMOVE(actor_move_stand),
+    SAVE_MMOVE(actor_move_taunt),
+    SAVE_MMOVE(actor_move_walk),
+    SAVE_MMOVE(berserk_move_attack_club),
+    SAVE_MMOVE(berserk_move_attack_spike),
+    SAVE_MMOVE(berserk_move_attack_strike),
+    SAVE_MMOVE(berserk_move_death1),
+    SAVE_MMOVE(berserk_move_death2),
+    SAVE_MMOVE(berserk_move_pain1),
+    SAVE_MMOVE(berserk_move_pain2),
+    SAVE_MMOVE(berserk_move_run1),
+    SAVE_MMOVE(berserk_move_stand),
+    SAVE_MMOVE(berserk_move_stand_fidget),
+    SAVE_MMOVE(berserk_move_walk),
+    SAVE_MMOVE(boss2_move_attack_mg),
+    SAVE_MMOVE(boss2_move_attack_post_mg),
+    SAVE_MMOVE(boss2_move_attack_pre_mg),
+    SAVE_MMOVE(boss2_move_attack_rocket),
+    SAVE_MMOVE(boss2_move_death),
+    SAVE_MMOVE(boss2_move_fidget),
+    SAVE_MMOVE(boss2_move_pain_heavy),
+    SAVE_MMOVE(boss2_move_pain_light),
+    SAVE_MMOVE(boss2_move_run),
+    SAVE_MMOVE(boss2_move_stand),
+    SAVE_MMOVE(boss2_move_walk),
+    SAVE_MMOVE(brain_move_attack1),
+    SAVE_MMOVE(brain_move_attack2),
+    SAVE_MMOVE(brain_move_death1),
+    SAVE_MMOVE(brain_move_death2),
+    SAVE_MMOVE(brain_move_defense),
+    SAVE_MMOVE(brain_move_duck),
+    SAVE_MMOVE(brain_move_idle),
+    SAVE_MMOVE(brain_move_pain1),
+    SAVE_MMOVE(brain_move_pain2),
+    SAVE_MMOVE(brain_move_pain3),
+    SAVE_MMOVE(brain_move_run),
+    SAVE_MMOVE(brain_move_stand),
+    SAVE_MMOVE(brain_move_walk1),
+    SAVE_MMOVE(brain_move_walk2),
+    SAVE_MMOVE(chick_move_attack1),
+    SAVE_MMOVE(chick_move_death1),
+    SAVE_MMOVE(chick_move_death2),
+    SAVE_MMOVE(chick_move_duck),
+    SAVE_MMOVE(chick_move_end_attack1),
+    SAVE_MMOVE(chick_move_end_slash),
+    SAVE_MMOVE(chick_move_fidget),
+    SAVE_MMOVE(chick_move_pain1),
+    SAVE_MMOVE(chick_move_pain2),
+    SAVE_MMOVE(chick_move_pain3),
+    SAVE_MMOVE(chick_move_run),
+    SAVE_MMOVE(chick_move_slash),
+    SAVE_MMOVE(chick_move_stand),
+    SAVE_MMOVE(chick_move_start_attack1),
+    SAVE_MMOVE(chick_move_start_run),
+    SAVE_MMOVE(chick_move_start_slash),
+    SAVE_MMOVE(chick_move_walk),
+    SAVE_MMOVE(flipper_move_attack),
+    SAVE_MMOVE(flipper_move_death),
+    SAVE_MMOVE(flipper_move_pain1),
+    SAVE_MMOVE(flipper_move_pain2),
+    SAVE_MMOVE(flipper_move_run_loop),
+    SAVE_MMOVE(flipper_move_run_start),
+    SAVE_MMOVE(flipper_move_stand),
+    SAVE_MMOVE(flipper_move_start_run),
+    SAVE_MMOVE(flipper_move_walk),
+    SAVE_MMOVE(floater_move_activate),
+    SAVE_MMOVE(floater_move_attack1),
+    SAVE_MMOVE(floater_move_attack2),
+    SAVE_MMOVE(floater_move_attack3),
+    SAVE_MMOVE(floater_move_death),
+    SAVE_MMOVE(floater_move_pain1),
+    SAVE_MMOVE(floater_move_pain2),
+    SAVE_MMOVE(floater_move_pain3),
+    SAVE_MMOVE(floater_move_run),
+    SAVE_MMOVE(floater_move_stand1),
+    SAVE_MMOVE(floater_move_stand2),
+    SAVE_MMOVE(floater_move_walk),
+    SAVE_MMOVE(flyer_move_attack2),
+    SAVE_MMOVE(flyer_move_bankleft),
+    SAVE_MMOVE(flyer_move_bankright),
+    SAVE_MMOVE(flyer_move_defense),
+    SAVE_MMOVE(flyer_move_end_melee),
+    SAVE_MMOVE(flyer_move_loop_melee),
+    SAVE_MMOVE(flyer_move_pain1),
+    SAVE_MMOVE(flyer_move_pain2),
+    SAVE_MMOVE(flyer_move_pain3),
+    SAVE_MMOVE(flyer_move_rollleft),
+    SAVE_MMOVE(flyer_move_rollright),
+    SAVE_MMOVE(flyer_move_run),
+    SAVE_MMOVE(flyer_move_stand),
+    SAVE_MMOVE(flyer_move_start),
+    SAVE_MMOVE(flyer_move_start_melee),
+    SAVE_MMOVE(flyer_move_stop),
+    SAVE_MMOVE(flyer_move_walk),
+    SAVE_MMOVE(gladiator_move_attack_gun),
+    SAVE_MMOVE(gladiator_move_attack_melee),
+    SAVE_MMOVE(gladiator_move_death),
+    SAVE_MMOVE(gladiator_move_pain),
+    SAVE_MMOVE(gladiator_move_pain_air),
+    SAVE_MMOVE(gladiator_move_run),
+    SAVE_MMOVE(gladiator_move_stand),
+    SAVE_MMOVE(gladiator_move_walk),
+    SAVE_MMOVE(gunner_move_attack_chain),
+    SAVE_MMOVE(gunner_move_attack_grenade),
+    SAVE_MMOVE(gunner_move_death),
+    SAVE_MMOVE(gunner_move_duck),
+    SAVE_MMOVE(gunner_move_endfire_chain),
+    SAVE_MMOVE(gunner_move_fidget),
+    SAVE_MMOVE(gunner_move_fire_chain),
+    SAVE_MMOVE(gunner_move_pain1),
+    SAVE_MMOVE(gunner_move_pain2),
+    SAVE_MMOVE(gunner_move_pain3),
+    SAVE_MMOVE(gunner_move_run),
+    SAVE_MMOVE(gunner_move_runandshoot),
+    SAVE_MMOVE(gunner_move_stand),
+    SAVE_MMOVE(gunner_move_walk),
+    SAVE_MMOVE(hover_move_attack1),
+    SAVE_MMOVE(hover_move_backward),
+    SAVE_MMOVE(hover_move_death1),
+    SAVE_MMOVE(hover_move_end_attack),
+    SAVE_MMOVE(hover_move_forward),
+    SAVE_MMOVE(hover_move_land),
+    SAVE_MMOVE(hover_move_pain1),
+    SAVE_MMOVE(hover_move_pain2),
+    SAVE_MMOVE(hover_move_pain3),
+    SAVE_MMOVE(hover_move_run),
+    SAVE_MMOVE(hover_move_stand),
+    SAVE_MMOVE(hover_move_start_attack),
+    SAVE_MMOVE(hover_move_stop1),
+    SAVE_MMOVE(hover_move_stop2),
+    SAVE_MMOVE(hover_move_takeoff),
+    SAVE_MMOVE(hover_move_walk),
+    SAVE_MMOVE(infantry_move_attack1),
+    SAVE_MMOVE(infantry_move_attack2),
+    SAVE_MMOVE(infantry_move_death1),
+    SAVE_MMOVE(infantry_move_death2),
+    SAVE_MMOVE(infantry_move_death3),
+    SAVE_MMOVE(infantry_move_duck),
+    SAVE_MMOVE(infantry_move_fidget),
+    SAVE_MMOVE(infantry_move_pain1),
+    SAVE_MMOVE(infantry_move_pain2),
+    SAVE_MMOVE(infantry_move_run),
+    SAVE_MMOVE(infantry_move_stand),
+    SAVE_MMOVE(infantry_move_walk),
+    SAVE_MMOVE(insane_move_crawl),
+    SAVE_MMOVE(insane_move_crawl_death),
+    SAVE_MMOVE(insane_move_crawl_pain),
+    SAVE_MMOVE(insane_move_cross),
+    SAVE_MMOVE(insane_move_down),
+    SAVE_MMOVE(insane_move_downtoup),
+    SAVE_MMOVE(insane_move_jumpdown),
+    SAVE_MMOVE(insane_move_run_insane),
+    SAVE_MMOVE(insane_move_run_normal),
+    SAVE_MMOVE(insane_move_runcrawl),
+    SAVE_MMOVE(insane_move_stand_death),
+    SAVE_MMOVE(insane_move_stand_insane),
+    SAVE_MMOVE(insane_move_stand_normal),
+    SAVE_MMOVE(insane_move_stand_pain),
+    SAVE_MMOVE(insane_move_struggle_cross),
+    SAVE_MMOVE(insane_move_uptodown),
+    SAVE_MMOVE(insane_move_walk_insane),
+    SAVE_MMOVE(insane_move_walk_normal),
+    SAVE_MMOVE(jorg_move_attack1),
+    SAVE_MMOVE(jorg_move_attack2),
+    SAVE_MMOVE(jorg_move_death),
+    SAVE_MMOVE(jorg_move_end_attack1),
+    SAVE_MMOVE(jorg_move_end_walk),
+    SAVE_MMOVE(jorg_move_pain1),
+    SAVE_MMOVE(jorg_move_pain2),
+    SAVE_MMOVE(jorg_move_pain3),
+    SAVE_MMOVE(jorg_move_run),
+    SAVE_MMOVE(jorg_move_stand),
+    SAVE_MMOVE(jorg_move_start_attack1),
+    SAVE_MMOVE(jorg_move_start_walk),
+    SAVE_MMOVE(jorg_move_walk),
+    SAVE_MMOVE(makron_move_attack3),
+    SAVE_MMOVE(makron_move_attack4),
+    SAVE_MMOVE(makron_move_attack5),
+    SAVE_MMOVE(makron_move_death2),
+    SAVE_MMOVE(makron_move_death3),
+    SAVE_MMOVE(makron_move_pain4),
+    SAVE_MMOVE(makron_move_pain5),
+    SAVE_MMOVE(makron_move_pain6),
+    SAVE_MMOVE(makron_move_run),
+    SAVE_MMOVE(makron_move_sight),
+    SAVE_MMOVE(makron_move_stand),
+    SAVE_MMOVE(makron_move_walk),
+    SAVE_MMOVE(medic_move_attackBlaster),
+    SAVE_MMOVE(medic_move_attackCable),
+    SAVE_MMOVE(medic_move_attackHyperBlaster),
+    SAVE_MMOVE(medic_move_death),
+    SAVE_MMOVE(medic_move_duck),
+    SAVE_MMOVE(medic_move_pain1),
+    SAVE_MMOVE(medic_move_pain2),
+    SAVE_MMOVE(medic_move_run),
+    SAVE_MMOVE(medic_move_stand),
+    SAVE_MMOVE(medic_move_walk),
+    SAVE_MMOVE(mutant_move_attack),
+    SAVE_MMOVE(mutant_move_death1),
+    SAVE_MMOVE(mutant_move_death2),
+    SAVE_MMOVE(mutant_move_idle),
+    SAVE_MMOVE(mutant_move_jump),
+    SAVE_MMOVE(mutant_move_pain1),
+    SAVE_MMOVE(mutant_move_pain2),
+    SAVE_MMOVE(mutant_move_pain3),
+    SAVE_MMOVE(mutant_move_run),
+    SAVE_MMOVE(mutant_move_stand),
+    SAVE_MMOVE(mutant_move_start_walk),
+    SAVE_MMOVE(mutant_move_walk),
+    SAVE_MMOVE(parasite_move_break),
+    SAVE_MMOVE(parasite_move_death),
+    SAVE_MMOVE(parasite_move_drain),
+    SAVE_MMOVE(parasite_move_end_fidget),
+    SAVE_MMOVE(parasite_move_fidget),
+    SAVE_MMOVE(parasite_move_pain1),
+    SAVE_MMOVE(parasite_move_run),
+    SAVE_MMOVE(parasite_move_stand),
+    SAVE_MMOVE(parasite_move_start_fidget),
+    SAVE_MMOVE(parasite_move_start_run),
+    SAVE_MMOVE(parasite_move_start_walk),
+    SAVE_MMOVE(parasite_move_stop_run),
+    SAVE_MMOVE(parasite_move_stop_walk),
+    SAVE_MMOVE(parasite_move_walk),
+    SAVE_MMOVE(soldier_move_attack1),
+    SAVE_MMOVE(soldier_move_attack2),
+    SAVE_MMOVE(soldier_move_attack3),
+    SAVE_MMOVE(soldier_move_attack4),
+    SAVE_MMOVE(soldier_move_attack5),
+    SAVE_MMOVE(soldier_move_attack6),
+    SAVE_MMOVE(soldier_move_death1),
+    SAVE_MMOVE(soldier_move_death2),
+    SAVE_MMOVE(soldier_move_death3),
+    SAVE_MMOVE(soldier_move_death4),
+    SAVE_MMOVE(soldier_move_death5),
+    SAVE_MMOVE(soldier_move_death6),
+    SAVE_MMOVE(soldier_move_duck),
+    SAVE_MMOVE(soldier_move_pain1),
+    SAVE_MMOVE(soldier_move_pain2),
+    SAVE_MMOVE(soldier_move_pain3),
+    SAVE_MMOVE(soldier_move_pain4),
+    SAVE_MMOVE(soldier_move_run),
+    SAVE_MMOVE(soldier_move_stand1),
+    SAVE_MMOVE(soldier_move_stand3),
+    SAVE_MMOVE(soldier_move_stand4),
+    SAVE_MMOVE(soldier_move_start_run),
+    SAVE_MMOVE(soldier_move_walk1),
+    SAVE_MMOVE(soldier_move_walk2),
+    SAVE_MMOVE(supertank_move_attack1),
+    SAVE_MMOVE(supertank_move_attack2),
+    SAVE_MMOVE(supertank_move_attack3),
+    SAVE_MMOVE(supertank_move_attack4),
+    SAVE_MMOVE(supertank_move_backward),
+    SAVE_MMOVE(supertank_move_death),
+    SAVE_MMOVE(supertank_move_end_attack1),
+    SAVE_MMOVE(supertank_move_forward),
+    SAVE_MMOVE(supertank_move_pain1),
+    SAVE_MMOVE(supertank_move_pain2),
+    SAVE_MMOVE(supertank_move_pain3),
+    SAVE_MMOVE(supertank_move_run),
+    SAVE_MMOVE(supertank_move_stand),
+    SAVE_MMOVE(supertank_move_turn_left),
+    SAVE_MMOVE(supertank_move_turn_right),
+    SAVE_MMOVE(tank_move_attack_blast),
+    SAVE_MMOVE(tank_move_attack_chain),
+    SAVE_MMOVE(tank_move_attack_fire_rocket),
+    SAVE_MMOVE(tank_move_attack_post_blast),
+    SAVE_MMOVE(tank_move_attack_post_rocket),
+    SAVE_MMOVE(tank_move_attack_pre_rocket),
+    SAVE_MMOVE(tank_move_attack_strike),
+    SAVE_MMOVE(tank_move_death),
+    SAVE_MMOVE(tank_move_pain1),
+    SAVE_MMOVE(tank_move_pain2),
+    SAVE_MMOVE(tank_move_pain3),
+    SAVE_MMOVE(tank_move_reattack_blast),
+    SAVE_MMOVE(tank_move_run),
+    SAVE_MMOVE(tank_move_stand),
+    SAVE_MMOVE(tank_move_start_run),
+    SAVE_MMOVE(tank_move_start_walk),
+    SAVE_MMOVE(tank_move_stop_run),
+    SAVE_MMOVE(tank_move_stop_walk),
+    SAVE_MMOVE(tank_move_walk),
+};
@@ -265,6 +265,47 @@ spawn_t spawns[] = {{"item_health", SP_item_health},
 
                     {NULL, NULL}};
 
+// items then spawns[], an index past game.num_items is a spawn function
+static nametable_t *spawn_names;
+static int num_spawn_names;
+
+// every field an entity string may set
+static nametable_t *field_names;
+static int num_field_names;
+
+/*
+===============
+ED_InitSpawnTables
+
+Sorts the classnames and field names once for the whole game, called
+after InitItems
+===============
+*/
+void ED_InitSpawnTables(void) {
+  int i, count;
+
+  count = game.num_items;
+  for(i = 0; spawns[i].name; i++)
+    count++;
+  spawn_names = gi.TagMalloc(count * sizeof(*spawn_names), TAG_GAME);
+  num_spawn_names = 0;
+  for(i = 0; i < game.num_items; i++)
+    if(itemlist[i].classname)
+      spawn_names[num_spawn_names++] = (nametable_t){itemlist[i].classname, i};
+  for(i = 0; spawns[i].name; i++)
+    spawn_names[num_spawn_names++] = (nametable_t){spawns[i].name, game.num_items + i};
+  G_SortNames(spawn_names, num_spawn_names, false);
+
+  for(count = 0; fields[count].name; count++)
+    ;
+  field_names = gi.TagMalloc(count * sizeof(*field_names), TAG_GAME);
+  num_field_names = 0;
+  for(i = 0; i < count; i++)
+    if(!(fields[i].flags & FFL_NOSPAWN))
+      field_names[num_field_names++] = (nametable_t){fields[i].name, i};
+  G_SortNames(field_names, num_field_names, true);
+}
+
 /*
 ===============
 ED_CallSpawn
@@ -273,8 +314,6 @@ Finds the spawn function for the entity and calls it
 ===============
 */
 void ED_CallSpawn(edict_t *ent) {
-  spawn_t *s;
-  gitem_t *item;
   int i;
 
   if(!ent->classname) {
@@ -282,24 +321,13 @@ void ED_CallSpawn(edict_t *ent) {
     return;
   }
 
-  // check item spawn functions
-  for(i = 0, item = itemlist; i < game.num_items; i++, item++) {
-    if(!item->classname)
-      continue;
-    if(!strcmp(item->classname, ent->classname)) { // found it
-      SpawnItem(ent, item);
-      return;
-    }
-  }
-
-  // check normal spawn functions
-  for(s = spawns; s->name; s++) {
-    if(!strcmp(s->name, ent->classname)) { // found it
-      s->spawn(ent);
-      return;
-    }
-  }
-  gi.dprintf("%s doesn't have a spawn function\n", ent->classname);
+  i = G_FindName(spawn_names, num_spawn_names, ent->classname, strlen(ent->classname), false);
+  if(i < 0)
+    gi.dprintf("%s doesn't have a spawn function\n", ent->classname);
+  else if(i < game.num_items)
+    SpawnItem(ent, &itemlist[i]);
+  else
+    spawns[i - game.num_items].spawn(ent);
 }
 
 /*
@@ -307,13 +335,11 @@ void ED_CallSpawn(edict_t *ent) {
 ED_NewString
 =============
 */
-char *ED_NewString(const char *string) {
+char *ED_NewString(const char *string, int l) {
   char *newb, *new_p;
-  int i, l;
-
-  l = strlen(string) + 1;
+  int i;
 
-  newb = gi.TagMalloc(l, TAG_LEVEL);
+  newb = gi.TagMalloc(l + 1, TAG_LEVEL);
 
   new_p = newb;
 
@@ -327,6 +353,7 @@ char *ED_NewString(const char *string) {
     } else
       *new_p++ = string[i];
   }
+  *new_p = 0;
 
   return newb;
 }
@@ -339,43 +366,113 @@ Takes a key/value pair and sets the binary values
 in an edict
 ===============
 */
-void ED_ParseField(const char *key, const char *value, edict_t *ent) {
+void ED_ParseField(const char *key, int keylen, const char *value, int valuelen, edict_t *ent) {
   field_t *f;
+  char number[64];
+  int i;
 
-  for(f = fields; f->name; f++) {
-    if((f->flags & FFL_NOSPAWN) || Q_stricmp(f->name, key)) {
-      continue;
-    }
+  i = G_FindName(field_names, num_field_names, key, keylen, true);
+  if(i < 0) {
+    gi.dprintf("%.*s is not a field\n", keylen, key);
+    return;
+  }
+  f = &fields[i];
+
+  // numbers are the only values that need terminating
+  if(f->type != F_LSTRING) {
+    if(valuelen > sizeof(number) - 1)
+      valuelen = sizeof(number) - 1;
+    memcpy(number, value, valuelen);
+    number[valuelen] = 0;
+  }
 
-    // found it
-    struct field_value fv = {.type = f->type};
-    switch(fv.type) {
-    case F_LSTRING:
-      fv.string = ED_NewString(value);
-      break;
-    case F_VECTOR:
-      sscanf(value, "%f %f %f", &fv.vector[0], &fv.vector[1], &fv.vector[2]);
-      break;
-    case F_INT:
-      fv.integer = atoi(value);
-      break;
-    case F_FLOAT:
-    case F_ANGLEHACK:
-      fv.floating = atof(value);
-      break;
-    case F_IGNORE:
-      return;
-    }
+  struct field_value fv = {.type = f->type};
+  switch(fv.type) {
+  case F_LSTRING:
+    fv.string = ED_NewString(value, valuelen);
+    break;
+  case F_VECTOR:
+    sscanf(number, "%f %f %f", &fv.vector[0], &fv.vector[1], &fv.vector[2]);
+    break;
+  case F_INT:
+    fv.integer = atoi(number);
+    break;
+  case F_FLOAT:
+  case F_ANGLEHACK:
+    fv.floating = atof(number);
+    break;
+  case F_IGNORE:
+    return;
+  }
+
+  if(f->flags & FFL_SPAWNTEMP) {
+    f->set_temp(&st, fv);
+  } else {
+    f->set(ent, fv);
+  }
+}
+
+/*
+====================
+ED_ParseToken
+
+COM_Parse without the copy into com_token, the token is left in place
+in the entity string and its length returned through len
+====================
+*/
+static const char *ED_ParseToken(const char **data_p, int *len) {
+  const char *data, *start;
+  int c;
+
+  data = *data_p;
+  *len = 0;
+
+  if(!data) {
+    *data_p = NULL;
+    return "";
+  }
 
-    if(f->flags & FFL_SPAWNTEMP) {
-      f->set_temp(&st, fv);
-    } else {
-      f->set(ent, fv);
+// skip whitespace
+skipwhite:
+  while((c = *data) <= ' ') {
+    if(c == 0) {
+      *data_p = NULL;
+      return "";
     }
+    data++;
+  }
 
-    return;
+  // skip // comments
+  if(c == '/' && data[1] == '/') {
+    while(*data && *data != '\n')
+      data++;
+    goto skipwhite;
   }
-  gi.dprintf("%s is not a field\n", key);
+
+  // handle quoted strings specially
+  if(c == '\"') {
+    start = ++data;
+    while(*data && *data != '\"')
+      data++;
+    *len = data - start;
+    if(*len > MAX_TOKEN_CHARS - 1)
+      *len = MAX_TOKEN_CHARS - 1;
+    if(*data)
+      data++;
+    *data_p = data;
+    return start;
+  }
+
+  // parse a regular word
+  start = data;
+  while(*data > 32)
+    data++;
+  *len = data - start;
+  if(*len >= MAX_TOKEN_CHARS)
+    *len = 0;
+
+  *data_p = data;
+  return start;
 }
 
 /*
@@ -388,8 +485,8 @@ ed should be a properly initialized empty edict.
 */
 const char *ED_ParseEdict(const char *data, edict_t *ent) {
   bool init;
-  char keyname[256];
-  const char *com_token;
+  const char *key, *value;
+  int keylen, valuelen;
 
   init = false;
   memset(&st, 0, sizeof(st));
@@ -397,34 +494,34 @@ const char *ED_ParseEdict(const char *data, edict_t *ent) {
   // go through all the dictionary pairs
   while(1) {
     // parse key
-    com_token = COM_Parse(&data);
-    if(com_token[0] == '}')
+    key = ED_ParseToken(&data, &keylen);
+    if(keylen && key[0] == '}')
       break;
     if(!data)
       gi.error("ED_ParseEntity: EOF without closing brace");
 
-    strncpy(keyname, com_token, sizeof(keyname) - 1);
-
     // parse value
-    com_token = COM_Parse(&data);
+    value = ED_ParseToken(&data, &valuelen);
     if(!data)
       gi.error("ED_ParseEntity: EOF without closing brace");
 
-    if(com_token[0] == '}')
+    if(valuelen && value[0] == '}')
       gi.error("ED_ParseEntity: closing brace without data");
 
     init = true;
 
     // keynames with a leading underscore are used for utility comments,
     // and are immediately discarded by quake
-    if(keyname[0] == '_')
+    if(keylen && key[0] == '_')
       continue;
 
-    ED_ParseField(keyname, com_token, ent);
+    ED_ParseField(key, keylen, value, valuelen, ent);
   }
 
-  if(!init)
+  if(!init) {
+    G_UnlinkNames(ent);
     memset(ent, 0, sizeof(*ent));
+  }
 
   return data;
 }
@@ -490,8 +587,8 @@ parsing textual entity definitions out of an ent file.
 void SpawnEntities(int cmodel_index, const char *mapname, const char *entities, const char *spawnpoint) {
   edict_t *ent;
   int inhibit;
-  char *com_token;
-  int i;
+  const char *token;
+  int i, len;
   float skill_level;
 
   skill_level = floor(skill->value);
@@ -509,6 +606,7 @@ void SpawnEntities(int cmodel_index, const char *mapname, const char *entities,
 
     memset(&level, 0, sizeof(level));
     memset(g_edicts, 0, game.maxentities * sizeof(g_edicts[0]));
+    G_ClearNameIndex();
 
     strncpy(level.mapname, mapname, sizeof(level.mapname) - 1);
     strncpy(game.spawnpoint, spawnpoint, sizeof(game.spawnpoint) - 1);
@@ -526,11 +624,11 @@ void SpawnEntities(int cmodel_index, const char *mapname, const char *entities,
   // parse ents
   while(1) {
     // parse the opening brace
-    com_token = COM_Parse(&entities);
+    token = ED_ParseToken(&entities, &len);
     if(!entities)
       break;
-    if(com_token[0] != '{')
-      gi.error("ED_LoadFromFile: found %s when expecting {", com_token);
+    if(!len || token[0] != '{')
+      gi.error("ED_LoadFromFile: found %.*s when expecting {", len, token);
 
     if(cmodel_index == CMODEL_A && !ent)
       ent = g_edicts;
@@ -548,7 +646,7 @@ void SpawnEntities(int cmodel_index, const char *mapname, const char *entities,
       if(deathmatch->value) {
         if(strcmp(ent->classname, "info_player_start") == 0) {
           ent->spawnflags &= ~SPAWNFLAG_NOT_DEATHMATCH;
-          ent->classname = "misc_redeploy";
+          G_SetClassname(ent, "misc_redeploy");
         }
 
         if(ent->spawnflags & SPAWNFLAG_NOT_DEATHMATCH) {
@@ -252,6 +252,55 @@ void SVCmd_WriteIP_f(void) {
   fclose(f);
 }
 
+/*
+=================
+SVCmd_FindCheck_f
+
+Looks up every classname and targetname on the level with G_Find and
+with G_FindLinear, in the entity's world and in all of them, and counts
+the lookups that come back different
+=================
+*/
+void SVCmd_FindCheck_f(void) {
+  static const int fields[2] = {FOFS(classname), FOFS(targetname)};
+  edict_t *e, *a, *b;
+  char *name;
+  int i, f, w, cmodel_index, lookups, disagree;
+
+  lookups = disagree = 0;
+  for(i = 0; i < globals.num_edicts; i++) {
+    e = &g_edicts[i];
+    if(!e->inuse)
+      continue;
+
+    for(f = 0; f < 2; f++) {
+      name = *(char **)((byte *)e + fields[f]);
+      if(!name)
+        continue;
+
+      for(w = 0; w < 2; w++) {
+        cmodel_index = w ? CMODEL_COUNT : e->s.cmodel_index;
+        a = b = NULL;
+        do {
+          a = G_Find(cmodel_index, a, fields[f], name);
+          b = G_FindLinear(cmodel_index, b, fields[f], name);
+          lookups++;
+          if(a != b) {
+            if(disagree < 10)
+              gi.cprintf(NULL, PRINT_HIGH, "%s \"%s\" world %i: edict %i indexed, %i linear\n",
+                         f ? "targetname" : "classname", name, cmodel_index, a ? (int)(a - g_edicts) : -1,
+                         b ? (int)(b - g_edicts) : -1);
+            disagree++;
+            break;
+          }
+        } while(a);
+      }
+    }
+  }
+
+  gi.cprintf(NULL, PRINT_HIGH, "%i lookups, %i disagree\n", lookups, disagree);
+}
+
 /*
 =================
 ServerCommand
@@ -275,6 +324,8 @@ void ServerCommand(void) {
     SVCmd_ListIP_f();
   else if(Q_stricmp(cmd, "writeip") == 0)
     SVCmd_WriteIP_f();
+  else if(Q_stricmp(cmd, "findcheck") == 0)
+    SVCmd_FindCheck_f();
   else
     gi.cprintf(NULL, PRINT_HIGH, "Unknown server command \"%s\"\n", cmd);
 }
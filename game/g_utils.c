@@ -27,6 +27,118 @@ void G_ProjectSource(vec3_t point, vec3_t distance, vec3_t forward, vec3_t right
   result[2] = point[2] + forward[2] * distance[0] + right[2] * distance[1] + distance[2];
 }
 
+/*
+===============================================================================
+
+NAME INDEX
+
+classname and targetname are hashed case insensitively into chains kept in
+edict order, so G_Find visits the same entities in the same order as a
+walk over g_edicts would while only looking at the ones that can match
+
+===============================================================================
+*/
+
+#define NAME_HASH_SIZE 256
+
+typedef struct {
+  uintptr_t fieldofs;
+  uintptr_t nextofs;
+  uintptr_t bucketofs;
+  edict_t *chains[NAME_HASH_SIZE];
+} nameindex_t;
+
+static nameindex_t classname_index = {FOFS(classname), FOFS(classname_next), FOFS(classname_bucket)};
+static nameindex_t targetname_index = {FOFS(targetname), FOFS(targetname_next), FOFS(targetname_bucket)};
+
+#define NAME_FIELD(index, e) (*(char **)((byte *)(e) + (index)->fieldofs))
+#define NAME_NEXT(index, e) (*(edict_t **)((byte *)(e) + (index)->nextofs))
+#define NAME_BUCKET(index, e) (*(int *)((byte *)(e) + (index)->bucketofs))
+
+static int G_HashName(const char *name) {
+  unsigned hash = 2166136261u;
+
+  while(*name) {
+    int c = *name++;
+    if(c >= 'A' && c <= 'Z')
+      c += 'a' - 'A';
+    hash = (hash ^ c) * 16777619u;
+  }
+  return hash & (NAME_HASH_SIZE - 1);
+}
+
+static void G_UnlinkName(nameindex_t *index, edict_t *ent) {
+  edict_t **link;
+  int bucket;
+
+  bucket = NAME_BUCKET(index, ent);
+  if(!bucket)
+    return;
+
+  for(link = &index->chains[bucket - 1]; *link; link = &NAME_NEXT(index, *link)) {
+    if(*link == ent) {
+      *link = NAME_NEXT(index, ent);
+      break;
+    }
+  }
+  NAME_NEXT(index, ent) = NULL;
+  NAME_BUCKET(index, ent) = 0;
+}
+
+static void G_LinkName(nameindex_t *index, edict_t *ent, char *name) {
+  edict_t **link;
+  int bucket;
+
+  G_UnlinkName(index, ent);
+  NAME_FIELD(index, ent) = name;
+  if(!name)
+    return;
+
+  // keep the chain sorted so lookups come back in edict order
+  bucket = G_HashName(name);
+  for(link = &index->chains[bucket]; *link && *link < ent; link = &NAME_NEXT(index, *link))
+    ;
+  NAME_NEXT(index, ent) = *link;
+  NAME_BUCKET(index, ent) = bucket + 1;
+  *link = ent;
+}
+
+/*
+=============
+G_SetClassname
+
+All writes to classname and targetname have to come through here
+or the entity will not be found by G_Find
+=============
+*/
+void G_SetClassname(edict_t *ent, char *classname) { G_LinkName(&classname_index, ent, classname); }
+
+void G_SetTargetname(edict_t *ent, char *targetname) { G_LinkName(&targetname_index, ent, targetname); }
+
+/*
+=============
+G_UnlinkNames
+
+Takes the entity out of the index before its memory is cleared
+=============
+*/
+void G_UnlinkNames(edict_t *ent) {
+  G_UnlinkName(&classname_index, ent);
+  G_UnlinkName(&targetname_index, ent);
+}
+
+/*
+=============
+G_ClearNameIndex
+
+Forgets every entity, for when g_edicts is cleared wholesale
+=============
+*/
+void G_ClearNameIndex(void) {
+  memset(classname_index.chains, 0, sizeof(classname_index.chains));
+  memset(targetname_index.chains, 0, sizeof(targetname_index.chains));
+}
+
 /*
 =============
 G_Find
@@ -40,6 +152,52 @@ NULL will be returned if the end of the list is reached.
 =============
 */
 edict_t *G_Find(int cmodel_index, edict_t *from, int fieldofs, char *match) {
+  nameindex_t *index;
+  edict_t *e;
+  int bucket;
+
+  if(fieldofs == FOFS(classname))
+    index = &classname_index;
+  else if(fieldofs == FOFS(targetname))
+    index = &targetname_index;
+  else
+    index = NULL;
+
+  if(index) {
+    bucket = G_HashName(match);
+
+    // carry on from the last match while it is still in this chain,
+    // otherwise skip up to it from the head
+    if(from && NAME_BUCKET(index, from) == bucket + 1)
+      e = NAME_NEXT(index, from);
+    else
+      for(e = index->chains[bucket]; e && e <= from; e = NAME_NEXT(index, e))
+        ;
+
+    for(; e; e = NAME_NEXT(index, e)) {
+      if(e >= &g_edicts[globals.num_edicts])
+        break;
+      if(!e->inuse)
+        continue;
+      if(cmodel_index < CMODEL_COUNT && e->s.cmodel_index != cmodel_index)
+        continue;
+      if(!Q_stricmp(NAME_FIELD(index, e), match))
+        return e;
+    }
+    return NULL;
+  }
+
+  return G_FindLinear(cmodel_index, from, fieldofs, match);
+}
+
+/*
+=============
+G_FindLinear
+
+G_Find without the name index, a walk over every edict
+=============
+*/
+edict_t *G_FindLinear(int cmodel_index, edict_t *from, int fieldofs, char *match) {
   char *s;
 
   if(!from)
@@ -69,28 +227,99 @@ findradius
 Returns entities that have origins within a spherical area
 
 findradius (origin, radius)
+
+The candidates come from one gi.SphereEdicts query per search.  Asking
+for anything but the sphere and entity returned last, as a nested search
+from inside a damage loop does, queries again and skips past from.
+
+The area lists only know where each entity was last linked, so the
+edicts that are unlinked, or whose center has left the box they were
+linked with, are checked directly as well.  The results are the ones the
+old walk over g_edicts gave.
 =================
 */
-edict_t *findradius(edict_t *from, vec3_t org, float rad) {
+static bool G_InRadius(edict_t *e, vec3_t org, float rad) {
   vec3_t eorg;
   int j;
 
-  if(!from)
-    from = g_edicts;
-  else
-    from++;
-  for(; from < &g_edicts[globals.num_edicts]; from++) {
-    if(!from->inuse)
-      continue;
-    if(from->solid == SOLID_NOT)
-      continue;
-    for(j = 0; j < 3; j++)
-      eorg[j] = org[j] - (from->s.origin[j] + (from->mins[j] + from->maxs[j]) * 0.5);
-    if(VectorLength(eorg) > rad)
+  if(!e->inuse)
+    return false;
+  if(e->solid == SOLID_NOT)
+    return false;
+  for(j = 0; j < 3; j++)
+    eorg[j] = org[j] - (e->s.origin[j] + (e->mins[j] + e->maxs[j]) * 0.5);
+  return VectorLength(eorg) <= rad;
+}
+
+// never linked, or moved off the box it was last linked with
+static bool G_UnlinkedMove(edict_t *e) {
+  int j;
+
+  if(!e->inuse || e->solid == SOLID_NOT)
+    return false;
+  if(!e->area.prev)
+    return true;
+  for(j = 0; j < 3; j++) {
+    float center = e->s.origin[j] + (e->mins[j] + e->maxs[j]) * 0.5;
+    if(center < e->absmin[j] || center > e->absmax[j])
+      return true;
+  }
+  return false;
+}
+
+static int G_CompareEdicts(const void *a, const void *b) {
+  const edict_t *ea = *(edict_t *const *)a;
+  const edict_t *eb = *(edict_t *const *)b;
+
+  return ea < eb ? -1 : ea > eb;
+}
+
+edict_t *findradius(edict_t *from, vec3_t org, float rad) {
+  static edict_t *found[MAX_EDICTS];
+  static int numfound, next;
+  static vec3_t found_org;
+  static float found_rad;
+  static edict_t *last;
+  edict_t *e;
+  int i, n;
+
+  if(!from || from != last || !VectorCompare(org, found_org) || rad != found_rad) {
+    VectorCopy(org, found_org);
+    found_rad = rad;
+
+    // the world is never linked, so it is not in the area lists
+    numfound = 0;
+    if(G_InRadius(g_edicts, org, rad))
+      found[numfound++] = g_edicts;
+    for(i = 0; i < CMODEL_COUNT; i++)
+      numfound += gi.SphereEdicts(i, org, rad, found + numfound, MAX_EDICTS - numfound);
+    for(i = 1; i < globals.num_edicts && numfound < MAX_EDICTS; i++) {
+      e = &g_edicts[i];
+      if(G_UnlinkedMove(e) && G_InRadius(e, org, rad))
+        found[numfound++] = e;
+    }
+    qsort(found, numfound, sizeof(found[0]), G_CompareEdicts);
+
+    // a moved entity can also come back from its old linked box
+    for(i = n = 0; i < numfound; i++)
+      if(!n || found[i] != found[n - 1])
+        found[n++] = found[i];
+    numfound = n;
+
+    for(next = 0; from && next < numfound && found[next] <= from; next++)
+      ;
+  }
+
+  // the search may have moved or freed entities since the query
+  while(next < numfound) {
+    e = found[next++];
+    if(e >= &g_edicts[globals.num_edicts] || !G_InRadius(e, org, rad))
       continue;
-    return from;
+    last = e;
+    return e;
   }
 
+  last = NULL;
   return NULL;
 }
 
@@ -165,7 +394,7 @@ void G_UseTargets(edict_t *ent, edict_t *activator) {
   if(ent->delay) {
     // create a temp object to fire at a later time
     t = G_Spawn(ent->s.cmodel_index);
-    t->classname = "DelayedUse";
+    G_SetClassname(t, "DelayedUse");
     t->nextthink = level.time + ent->delay;
     t->think = Think_Delay;
     t->activator = activator;
@@ -348,26 +577,118 @@ char *G_CopyString(char *in) {
   return out;
 }
 
-void G_InitEdict(int cmodel_index, edict_t *e) {
-  e->inuse = true;
-  e->classname = "noclass";
-  e->gravity = 1.0;
-  e->s.number = e - g_edicts;
-  e->s.cmodel_index = cmodel_index;
+/*
+=============================================================================
+
+SORTED NAME TABLES
+
+Lookups of spawn functions, fields and items by name go through tables
+sorted once at InitGame.  Equal names keep their original order, so the
+search returns the same entry the old front to back scans found first.
 
+=============================================================================
+*/
+
+// orders name against the first len characters of key, folding case
+// the same way Q_strcasecmp does when nocase is set
+static int G_CompareName(const char *name, const char *key, int len, bool nocase) {
+  int c1, c2;
+
+  for(; len; len--) {
+    c1 = *(const unsigned char *)name++;
+    c2 = *(const unsigned char *)key++;
+    if(nocase) {
+      if(c1 >= 'a' && c1 <= 'z')
+        c1 -= 'a' - 'A';
+      if(c2 >= 'a' && c2 <= 'z')
+        c2 -= 'a' - 'A';
+    }
+    if(c1 != c2)
+      return c1 - c2;
+    if(!c1)
+      return 0;
+  }
+  return *name ? 1 : 0;
+}
+
+static bool g_sortnocase;
+
+static int G_SortNamesCompare(const void *a, const void *b) {
+  const nametable_t *x = a, *y = b;
+  int c;
+
+  c = G_CompareName(x->name, y->name, strlen(y->name) + 1, g_sortnocase);
+  return c ? c : x->index - y->index;
+}
+
+/*
+=============
+G_SortNames
+=============
+*/
+void G_SortNames(nametable_t *names, int count, bool nocase) {
+  g_sortnocase = nocase;
+  qsort(names, count, sizeof(names[0]), G_SortNamesCompare);
+}
+
+/*
+=============
+G_FindName
+
+Returns the original index of the first entry named by the len
+characters at key, or -1
+=============
+*/
+int G_FindName(const nametable_t *names, int count, const char *key, int len, bool nocase) {
+  int lo, hi, mid;
+
+  lo = 0;
+  hi = count;
+  while(lo < hi) {
+    mid = (lo + hi) / 2;
+    if(G_CompareName(names[mid].name, key, len, nocase) < 0)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+
+  if(lo < count && !G_CompareName(names[lo].name, key, len, nocase))
+    return names[lo].index;
+  return -1;
+}
+
+/*
+=================
+G_SpawnEntityHandle
+
+Gives the edict its alias ECS entity if it does not have one yet, in the
+layer of its cmodel
+=================
+*/
+void G_SpawnEntityHandle(edict_t *e) {
   if(e->entity_handle == 0 &&
      alias_ecs_spawn(
          GAME_ECS_INSTANCE(),
          &(alias_ecs_EntitySpawnInfo){
              .count = 1,
              .num_components = 1,
-             .layer = GAME_MAIN_LAYER(cmodel_index),
+             .layer = GAME_MAIN_LAYER(e->s.cmodel_index),
              .components = &(alias_ecs_EntitySpawnComponent){.component = GAME_EDICT_COMPONENT_HANDLE(), .data = &e}},
          &e->entity_handle) != ALIAS_ECS_SUCCESS) {
     gi.error("failed to spawn alias ECS entity with edict\n");
   }
 }
 
+void G_InitEdict(int cmodel_index, edict_t *e) {
+  e->inuse = true;
+  G_SetClassname(e, "noclass");
+  e->gravity = 1.0;
+  e->s.number = e - g_edicts;
+  e->s.cmodel_index = cmodel_index;
+
+  G_SpawnEntityHandle(e);
+}
+
 /*
 =================
 G_Spawn
@@ -420,7 +741,9 @@ void G_FreeEdict(edict_t *ed) {
     gi.error("failed to despawn alias ECS entity with edict\n");
   }
 
+  G_UnlinkNames(ed);
   memset(ed, 0, sizeof(*ed));
+  // not indexed, freed edicts are never found
   ed->classname = "freed";
   ed->freetime = level.time;
   ed->inuse = false;
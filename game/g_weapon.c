@@ -339,7 +339,7 @@ void fire_blaster(edict_t *self, vec3_t start, vec3_t dir, int damage, int speed
   bolt->nextthink = level.time + 2;
   bolt->think = G_FreeEdict;
   bolt->dmg = damage;
-  bolt->classname = "bolt";
+  G_SetClassname(bolt, "bolt");
   if(hyper)
     bolt->spawnflags = 1;
   gi.linkentity(bolt);
@@ -359,7 +359,7 @@ void fire_blaster(edict_t *self, vec3_t start, vec3_t dir, int damage, int speed
 fire_grenade
 =================
 */
-static void Grenade_Explode(edict_t *ent) {
+void Grenade_Explode(edict_t *ent) {
   vec3_t origin;
   int mod;
 
@@ -412,7 +412,7 @@ static void Grenade_Explode(edict_t *ent) {
   G_FreeEdict(ent);
 }
 
-static void Grenade_Touch(edict_t *ent, edict_t *other, cplane_t *plane, csurface_t *surf) {
+void Grenade_Touch(edict_t *ent, edict_t *other, cplane_t *plane, csurface_t *surf) {
   if(other == ent->owner)
     return;
 
@@ -464,7 +464,7 @@ void fire_grenade(edict_t *self, vec3_t start, vec3_t aimdir, int damage, int sp
   grenade->think = Grenade_Explode;
   grenade->dmg = damage;
   grenade->dmg_radius = damage_radius;
-  grenade->classname = "grenade";
+  G_SetClassname(grenade, "grenade");
 
   gi.linkentity(grenade);
 }
@@ -497,7 +497,7 @@ void fire_grenade2(edict_t *self, vec3_t start, vec3_t aimdir, int damage, int s
   grenade->think = Grenade_Explode;
   grenade->dmg = damage;
   grenade->dmg_radius = damage_radius;
-  grenade->classname = "hgrenade";
+  G_SetClassname(grenade, "hgrenade");
   if(held)
     grenade->spawnflags = 3;
   else
@@ -585,7 +585,7 @@ void fire_rocket(edict_t *self, vec3_t start, vec3_t dir, int damage, int speed,
   rocket->radius_dmg = radius_damage;
   rocket->dmg_radius = damage_radius;
   rocket->s.sound = gi.soundindex("weapons/rockfly.wav");
-  rocket->classname = "rocket";
+  G_SetClassname(rocket, "rocket");
 
   if(self->client)
     check_dodge(self, rocket->s.origin, dir, speed);
@@ -827,7 +827,7 @@ void fire_bfg(edict_t *self, vec3_t start, vec3_t dir, int damage, int speed, fl
   bfg->think = G_FreeEdict;
   bfg->radius_dmg = damage;
   bfg->dmg_radius = damage_radius;
-  bfg->classname = "bfg blast";
+  G_SetClassname(bfg, "bfg blast");
   bfg->s.sound = gi.soundindex("weapons/bfg__l1a.wav");
 
   bfg->think = bfg_think;
@@ -39,7 +39,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 // game.h -- game dll information visible to server
 
-#define GAME_API_VERSION 3
+#define GAME_API_VERSION 4
 #define GAME_API_VERSION_MSUNICAT ((('M' << 0) | ('s' << 8) | ('U' << 16) | ('C' << 24)) ^ (('g' << 0) | ('a' << 8) | ('m' << 16) | ('e' << 24))
 
 // edict->svflags
@@ -187,6 +187,22 @@ typedef struct {
   void (*AddCommandString)(const char *text);
 
   void (*DebugGraph)(float value, int color);
+
+  // frame profiler zones, must nest
+  void (*ProfileBegin)(const char *name);
+  void (*ProfileEnd)(void);
+
+  // savegame storage, a file or a row of the server database, the data
+  // ReadSave returns is freed with TagFree, -1 if there is none
+  bool (*WriteSave)(const char *name, const void *data, int length);
+  int (*ReadSave)(const char *name, void **data);
+
+  // trace for each start and end pair, out gets n results
+  void (*tracebatch)(int cmodel_index, int n, vec3_t *starts, vec3_t *ends, vec3_t mins, vec3_t maxs, edict_t *passent,
+                     int contentmask, trace_t *out);
+  // linked edicts with their box center inside the sphere, in edict order.
+  // Only as current as the last linkentity of each edict
+  int (*SphereEdicts)(int cmodel_index, vec3_t origin, float radius, edict_t **list, int maxcount);
 } game_import_t;
 
 //
@@ -44,7 +44,13 @@ static int sound_hook_retract;
 edict_t *medic_FindDeadMonster(edict_t *self) {
   edict_t *ent = NULL;
   edict_t *best = NULL;
+  edict_t *candidates[MAX_EDICTS];
+  bool seen[MAX_EDICTS];
+  int i, count;
 
+  // gather everything that could be healed, then do the sight
+  // checks for all of them together
+  count = 0;
   while((ent = findradius(ent, self->s.origin, 1024)) != NULL) {
     if(ent == self)
       continue;
@@ -58,7 +64,14 @@ edict_t *medic_FindDeadMonster(edict_t *self) {
       continue;
     if(ent->nextthink)
       continue;
-    if(!visible(self, ent))
+    candidates[count++] = ent;
+  }
+
+  visible_batch(self, candidates, count, seen);
+
+  for(i = 0; i < count; i++) {
+    ent = candidates[i];
+    if(!seen[i])
       continue;
     if(!best) {
       best = ent;
@@ -397,7 +410,7 @@ void medic_cable_attack(edict_t *self) {
     self->enemy->spawnflags = 0;
     self->enemy->monsterinfo.aiflags = 0;
     self->enemy->target = NULL;
-    self->enemy->targetname = NULL;
+    G_SetTargetname(self->enemy, NULL);
     self->enemy->combattarget = NULL;
     self->enemy->deathtarget = NULL;
     self->enemy->owner = self;
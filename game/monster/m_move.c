@@ -36,8 +36,9 @@ int c_yes, c_no;
 
 bool M_CheckBottom(edict_t *ent) {
   vec3_t mins, maxs, start, stop;
-  trace_t trace;
-  int x, y;
+  vec3_t starts[4], ends[4];
+  trace_t trace, corners[4];
+  int x, y, i;
   float mid, bottom;
 
   VectorAdd(ent->s.origin, ent->mins, mins);
@@ -75,19 +76,22 @@ realcheck:
     return false;
   mid = bottom = trace.endpos[2];
 
-  // the corners must be within 16 of the midpoint
-  for(x = 0; x <= 1; x++)
-    for(y = 0; y <= 1; y++) {
-      start[0] = stop[0] = x ? maxs[0] : mins[0];
-      start[1] = stop[1] = y ? maxs[1] : mins[1];
-
-      trace = gi.trace(ent->s.cmodel_index, start, vec3_origin, vec3_origin, stop, ent, MASK_MONSTERSOLID);
+  // the corners must be within 16 of the midpoint, the four probes
+  // don't change anything so they are traced together
+  for(i = 0; i < 4; i++) {
+    starts[i][0] = ends[i][0] = (i & 2) ? maxs[0] : mins[0];
+    starts[i][1] = ends[i][1] = (i & 1) ? maxs[1] : mins[1];
+    starts[i][2] = start[2];
+    ends[i][2] = stop[2];
+  }
+  gi.tracebatch(ent->s.cmodel_index, 4, starts, ends, vec3_origin, vec3_origin, ent, MASK_MONSTERSOLID, corners);
 
-      if(trace.fraction != 1.0 && trace.endpos[2] > bottom)
-        bottom = trace.endpos[2];
-      if(trace.fraction == 1.0 || mid - trace.endpos[2] > STEPSIZE)
-        return false;
-    }
+  for(i = 0; i < 4; i++) {
+    if(corners[i].fraction != 1.0 && corners[i].endpos[2] > bottom)
+      bottom = corners[i].endpos[2];
+    if(corners[i].fraction == 1.0 || mid - corners[i].endpos[2] > STEPSIZE)
+      return false;
+  }
 
   c_yes++;
   return true;
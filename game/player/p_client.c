@@ -36,7 +36,7 @@ void SP_misc_teleporter_dest(edict_t *ent);
 // we use carnal knowledge of the maps to fix the coop spot targetnames to match
 // that of the nearest named single player spot
 
-static void SP_FixCoopSpots(edict_t *self) {
+void SP_FixCoopSpots(edict_t *self) {
   edict_t *spot;
   vec3_t d;
 
@@ -53,7 +53,7 @@ static void SP_FixCoopSpots(edict_t *self) {
       if((!self->targetname) || Q_stricmp(self->targetname, spot->targetname) != 0) {
         //				gi.dprintf("FixCoopSpots changed %s at %s targetname from %s to %s\n", self->classname,
         // vtos(self->s.origin), self->targetname, spot->targetname);
-        self->targetname = spot->targetname;
+        G_SetTargetname(self, spot->targetname);
       }
       return;
     }
@@ -64,32 +64,32 @@ static void SP_FixCoopSpots(edict_t *self) {
 // some maps don't have any coop spots at all, so we need to create them
 // where they should have been
 
-static void SP_CreateCoopSpots(edict_t *self) {
+void SP_CreateCoopSpots(edict_t *self) {
   edict_t *spot;
 
   if(Q_stricmp(level.mapname, "security") == 0) {
     spot = G_Spawn(self->s.cmodel_index);
-    spot->classname = "info_player_coop";
+    G_SetClassname(spot, "info_player_coop");
     spot->s.origin[0] = 188 - 64;
     spot->s.origin[1] = -164;
     spot->s.origin[2] = 80;
-    spot->targetname = "jail3";
+    G_SetTargetname(spot, "jail3");
     spot->s.angles[1] = 90;
 
     spot = G_Spawn(self->s.cmodel_index);
-    spot->classname = "info_player_coop";
+    G_SetClassname(spot, "info_player_coop");
     spot->s.origin[0] = 188 + 64;
     spot->s.origin[1] = -164;
     spot->s.origin[2] = 80;
-    spot->targetname = "jail3";
+    G_SetTargetname(spot, "jail3");
     spot->s.angles[1] = 90;
 
     spot = G_Spawn(self->s.cmodel_index);
-    spot->classname = "info_player_coop";
+    G_SetClassname(spot, "info_player_coop");
     spot->s.origin[0] = 188 + 128;
     spot->s.origin[1] = -164;
     spot->s.origin[2] = 80;
-    spot->targetname = "jail3";
+    G_SetTargetname(spot, "jail3");
     spot->s.angles[1] = 90;
 
     return;
@@ -827,7 +827,7 @@ void InitBodyQue(void) {
   level.body_que = 0;
   for(i = 0; i < BODY_QUEUE_SIZE; i++) {
     ent = G_Spawn(0);
-    ent->classname = "bodyque";
+    G_SetClassname(ent, "bodyque");
   }
 }
 
@@ -1054,7 +1054,7 @@ void PutClientInServer(edict_t *ent) {
   ent->movetype = MOVETYPE_WALK;
   ent->viewheight = 22;
   ent->inuse = true;
-  ent->classname = "player";
+  G_SetClassname(ent, "player");
   ent->mass = 200;
   ent->solid = SOLID_BBOX;
   ent->deadflag = DEAD_NO;
@@ -1202,7 +1202,7 @@ void ClientBegin(edict_t *ent) {
     // except for the persistant data that was initialized at
     // ClientConnect() time
     G_InitEdict(ent->s.cmodel_index, ent);
-    ent->classname = "player";
+    G_SetClassname(ent, "player");
     InitClientResp(ent->client);
     PutClientInServer(ent);
   }
@@ -1383,7 +1383,7 @@ void ClientDisconnect(edict_t *ent) {
   ent->s.modelindex = 0;
   ent->solid = SOLID_NOT;
   ent->inuse = false;
-  ent->classname = "disconnected";
+  G_SetClassname(ent, "disconnected");
   ent->client->pers.connected = false;
 
   playernum = ent - g_edicts - 1;
@@ -69,7 +69,7 @@ void PlayerNoise(edict_t *who, vec3_t where, int type) {
 
   if(!who->mynoise) {
     noise = G_Spawn(who->s.cmodel_index);
-    noise->classname = "player_noise";
+    G_SetClassname(noise, "player_noise");
     VectorSet(noise->mins, -8, -8, -8);
     VectorSet(noise->maxs, 8, 8, 8);
     noise->owner = who;
@@ -77,7 +77,7 @@ void PlayerNoise(edict_t *who, vec3_t where, int type) {
     who->mynoise = noise;
 
     noise = G_Spawn(who->s.cmodel_index);
-    noise->classname = "player_noise";
+    G_SetClassname(noise, "player_noise");
     VectorSet(noise->mins, -8, -8, -8);
     VectorSet(noise->maxs, 8, 8, 8);
     noise->owner = who;
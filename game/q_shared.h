@@ -359,6 +359,7 @@ typedef struct cvar_s {
   bool modified; // set each time the cvar is changed
   float value;
   struct cvar_s *next;
+  struct cvar_s *hash_next; // engine lookup chain, after next so old game dlls still line up
 } cvar_t;
 
 #endif // CVAR
@@ -1116,7 +1117,7 @@ ROGUE - VERSIONS
 #define CS_STATUSBAR 5 // display program string
 #define CS_AIRACCEL 29 // air acceleration control
 #define CS_MAXCLIENTS 30
-// #define CS_MAPCHECKSUM 31 // for catching cheater maps
+#define CS_FRAMETIME 31   // msec per server frame, 100 when empty
 
 #define CS_MODELS 32
 #define CS_SOUNDS (CS_MODELS + MAX_MODELS)
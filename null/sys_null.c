@@ -1,127 +1,220 @@
-// sys_null.h -- null system driver to aid porting efforts
+// sys_null.c -- headless system driver for the dedicated server on
+// platforms without a system layer of their own
 
 #include "../qcommon/qcommon.h"
-#include "errno.h"
 
-int	curtime;
+#include <uv.h>
 
-unsigned	sys_frame_time;
+#include <dirent.h>
+#include <errno.h>
+#include <fnmatch.h>
+#include <sys/select.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
+unsigned int curtime;
 
-void Sys_mkdir (char *path)
-{
-}
+/*
+===============================================================================
 
-void Sys_Error (char *error, ...)
-{
-	va_list		argptr;
+SYSTEM IO
 
-	printf ("Sys_Error: ");	
-	va_start (argptr,error);
-	vprintf (error,argptr);
-	va_end (argptr);
-	printf ("\n");
+===============================================================================
+*/
 
-	exit (1);
-}
+void Sys_Error(char *error, ...) {
+  va_list argptr;
 
-void Sys_Quit (void)
-{
-	exit (0);
-}
+  CL_Shutdown();
+  Qcommon_Shutdown();
 
-void	Sys_UnloadGame (void)
-{
-}
+  fprintf(stderr, "Sys_Error: ");
+  va_start(argptr, error);
+  vfprintf(stderr, error, argptr);
+  va_end(argptr);
+  fprintf(stderr, "\n");
 
-void	*Sys_GetGameAPI (void *parms)
-{
-	return NULL;
+  exit(1);
 }
 
-char *Sys_ConsoleInput (void)
-{
-	return NULL;
-}
+void Sys_Quit(void) {
+  CL_Shutdown();
+  Qcommon_Shutdown();
 
-void	Sys_ConsoleOutput (char *string)
-{
+  exit(0);
 }
 
-void Sys_SendKeyEvents (void)
-{
-}
+void Sys_Init(void) {}
 
-void Sys_AppActivate (void)
-{
-}
+/*
+================
+Sys_ConsoleInput
 
-void Sys_CopyProtect (void)
-{
-}
+Polls stdin, the frame timer is what keeps this from spinning
+================
+*/
+char *Sys_ConsoleInput(void) {
+  static char text[256];
+  static bool stdin_closed;
+  struct timeval timeout;
+  fd_set fdset;
+  int len;
 
-char *Sys_GetClipboardData( void )
-{
-	return NULL;
-}
+  if(!dedicated || !dedicated->value || stdin_closed)
+    return NULL;
 
-void	*Hunk_Begin (int maxsize)
-{
-	return NULL;
-}
+  FD_ZERO(&fdset);
+  FD_SET(0, &fdset);
+  timeout.tv_sec = 0;
+  timeout.tv_usec = 0;
+  if(select(1, &fdset, NULL, NULL, &timeout) <= 0 || !FD_ISSET(0, &fdset))
+    return NULL;
 
-void	*Hunk_Alloc (int size)
-{
-	return NULL;
-}
+  len = read(0, text, sizeof(text) - 1);
+  if(len <= 0) {
+    // detached from the terminal, stop asking
+    stdin_closed = true;
+    return NULL;
+  }
+  if(len == 1 && text[0] == '\n')
+    return NULL;
 
-void	Hunk_Free (void *buf)
-{
+  text[len] = 0;
+  if(text[len - 1] == '\n')
+    text[len - 1] = 0;
+  return text;
 }
 
-int		Hunk_End (void)
-{
-	return 0;
-}
+/*
+================
+Sys_ConsoleOutput
+================
+*/
+void Sys_ConsoleOutput(char *string) {
+  char text[1024];
+  int i;
+
+  if(!dedicated || !dedicated->value)
+    return;
+
+  // strip the colored text bit
+  for(i = 0; string[i] && i < sizeof(text) - 1; i++)
+    text[i] = string[i] & 127;
+  text[i] = 0;
 
-int		Sys_Milliseconds (void)
-{
-	return 0;
+  fputs(text, stdout);
+  fflush(stdout);
 }
 
-void	Sys_Mkdir (char *path)
-{
+void Sys_SendKeyEvents(void) {}
+
+void Sys_AppActivate(void) {}
+
+void Sys_CopyProtect(void) {}
+
+char *Sys_GetClipboardData(void) { return NULL; }
+
+/*
+================
+Sys_Milliseconds
+================
+*/
+static unsigned int sys_milliseconds_base;
+
+static void sys_milliseconds_init(void) { sys_milliseconds_base = (unsigned int)(uv_hrtime() / (uint64_t)1000000); }
+
+unsigned int Sys_Milliseconds(void) {
+  static uv_once_t init = UV_ONCE_INIT;
+  uv_once(&init, sys_milliseconds_init);
+  curtime = (unsigned int)(uv_hrtime() / (uint64_t)1000000) - sys_milliseconds_base;
+  return curtime;
 }
 
-char	*Sys_FindFirst (char *path, unsigned musthave, unsigned canthave)
-{
-	return NULL;
+void Sys_Mkdir(char *path) { mkdir(path, 0777); }
+
+//============================================
+
+static char findbase[MAX_OSPATH];
+static char findpath[MAX_OSPATH];
+static char findpattern[MAX_OSPATH];
+static DIR *fdir;
+
+static bool CompareAttributes(const char *path, unsigned musthave, unsigned canthave) {
+  struct stat st;
+
+  // . and .. never match
+  if(!strcmp(path + strlen(path) - 2, "/.") || !strcmp(path + strlen(path) - 3, "/.."))
+    return false;
+
+  if(stat(path, &st) == -1)
+    return false;
+
+  if((st.st_mode & S_IFDIR) && (canthave & SFF_SUBDIR))
+    return false;
+
+  if((musthave & SFF_SUBDIR) && !(st.st_mode & S_IFDIR))
+    return false;
+
+  return true;
 }
 
-char	*Sys_FindNext (unsigned musthave, unsigned canthave)
-{
-	return NULL;
+char *Sys_FindNext(unsigned musthave, unsigned canthave) {
+  struct dirent *d;
+
+  if(fdir == NULL)
+    return NULL;
+  while((d = readdir(fdir)) != NULL) {
+    if(*findpattern && fnmatch(findpattern, d->d_name, 0))
+      continue;
+    Com_sprintf(findpath, sizeof(findpath), "%s/%s", findbase, d->d_name);
+    if(CompareAttributes(findpath, musthave, canthave))
+      return findpath;
+  }
+  return NULL;
 }
 
-void	Sys_FindClose (void)
-{
+char *Sys_FindFirst(char *path, unsigned musthave, unsigned canthave) {
+  char *p;
+
+  if(fdir)
+    Sys_Error("Sys_BeginFind without close");
+
+  COM_FilePath(path, findbase);
+  p = strrchr(path, '/');
+  strcpy(findpattern, p ? p + 1 : path);
+  if(!strcmp(findpattern, "*.*"))
+    strcpy(findpattern, "*");
+
+  fdir = opendir(findbase);
+  if(fdir == NULL)
+    return NULL;
+  return Sys_FindNext(musthave, canthave);
 }
 
-void	Sys_Init (void)
-{
+void Sys_FindClose(void) {
+  if(fdir != NULL)
+    closedir(fdir);
+  fdir = NULL;
 }
 
+/*
+========================================================================
 
-//=============================================================================
+GAME DLL
+
+========================================================================
+*/
 
-void main (int argc, char **argv)
-{
-	Qcommon_Init (argc, argv);
+void Sys_UnloadGame(void) {}
 
-	while (1)
-	{
-		Qcommon_Frame (0.1);
-	}
+void *Sys_GetGameAPI(void *parms) {
+  extern void *GetGameAPI(void *);
+  return GetGameAPI(parms);
 }
 
+//=============================================================================
 
+int main(int argc, char **argv) {
+  Qcommon_Init(argc, argv);
+  return Qcommon_RunFrames();
+}
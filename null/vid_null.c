@@ -110,6 +110,9 @@ void	VID_Init (void)
     ri.Cvar_Set = Cvar_Set;
     ri.Cvar_SetValue = Cvar_SetValue;
     ri.Vid_GetModeInfo = VID_GetModeInfo;
+    ri.Job_CreatePool = Job_CreatePool;
+    ri.Job_DestroyPool = Job_DestroyPool;
+    ri.Job_Run = Job_Run;
 
     re = GetRefAPI(ri);
 
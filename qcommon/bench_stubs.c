@@ -0,0 +1,70 @@
+/*
+Copyright (C) 1997-2001 Id Software, Inc.
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+// bench_stubs.c -- the little of qcommon the standalone benches link against
+//
+// Memory comes straight from calloc, errors exit, printing goes to stdout
+// and every cvar and command argument reads as unset.
+
+#include "qcommon.h"
+
+void *Z_Malloc(int size) { return calloc(1, size); }
+
+void Z_Free(void *ptr) { free(ptr); }
+
+void Com_Error(int code, char *fmt, ...) {
+  va_list argptr;
+
+  va_start(argptr, fmt);
+  vfprintf(stderr, fmt, argptr);
+  va_end(argptr);
+  fprintf(stderr, "\n");
+  exit(1);
+}
+
+void Com_Printf(char *fmt, ...) {
+  va_list argptr;
+
+  va_start(argptr, fmt);
+  vprintf(fmt, argptr);
+  va_end(argptr);
+}
+
+void Com_DPrintf(char *fmt, ...) {}
+
+cvar_t *Cvar_Get(const char *var_name, const char *value, int flags) {
+  cvar_t *var = calloc(1, sizeof(*var));
+
+  var->name = (char *)var_name;
+  var->string = (char *)value;
+  var->value = atof(value);
+  return var;
+}
+
+float Cvar_VariableValue(const char *var_name) { return 0; }
+
+char *Cvar_VariableString(const char *var_name) { return ""; }
+
+int Cmd_Argc(void) { return 0; }
+
+char *Cmd_Argv(int arg) { return ""; }
+
+void Prof_Begin(const char *name) {}
+
+void Prof_End(void) {}
@@ -21,17 +21,25 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 #include "qcommon.h"
 
+#include <uv.h>
+
 void Cmd_ForwardToServer(void);
 
 #define MAX_ALIAS_NAME 32
 
+// commands and aliases are found through Com_HashKey chains, the plain
+// lists keep the newest first order the listings show
+#define CMD_HASH_SIZE 512 // power of two
+
 typedef struct cmdalias_s {
   struct cmdalias_s *next;
+  struct cmdalias_s *hash_next;
   char name[MAX_ALIAS_NAME];
   char *value;
 } cmdalias_t;
 
 cmdalias_t *cmd_alias;
+static cmdalias_t *cmd_alias_hash[CMD_HASH_SIZE];
 
 bool cmd_wait;
 
@@ -382,6 +390,7 @@ void Cmd_Alias_f(void) {
   cmdalias_t *a;
   char cmd[1024];
   int i, c;
+  unsigned h;
   char *s;
 
   if(Cmd_Argc() == 1) {
@@ -398,7 +407,8 @@ void Cmd_Alias_f(void) {
   }
 
   // if the alias already exists, reuse it
-  for(a = cmd_alias; a; a = a->next) {
+  h = Com_HashKey(s) & (CMD_HASH_SIZE - 1);
+  for(a = cmd_alias_hash[h]; a; a = a->hash_next) {
     if(!strcmp(s, a->name)) {
       Z_Free(a->value);
       break;
@@ -409,6 +419,8 @@ void Cmd_Alias_f(void) {
     a = Z_Malloc(sizeof(cmdalias_t));
     a->next = cmd_alias;
     cmd_alias = a;
+    a->hash_next = cmd_alias_hash[h];
+    cmd_alias_hash[h] = a;
   }
   strcpy(a->name, s);
 
@@ -435,6 +447,7 @@ void Cmd_Alias_f(void) {
 
 typedef struct cmd_function_s {
   struct cmd_function_s *next;
+  struct cmd_function_s *hash_next;
   const char *name;
   xcommand_t function;
 } cmd_function_t;
@@ -445,6 +458,35 @@ static char *cmd_null_string = "";
 static char cmd_args[MAX_STRING_CHARS];
 
 static cmd_function_t *cmd_functions; // possible commands to execute
+static cmd_function_t *cmd_function_hash[CMD_HASH_SIZE];
+
+/*
+============
+Cmd_FindFunction
+
+Exact or case insensitive, either way the newest command wins like it
+did walking cmd_functions
+============
+*/
+static cmd_function_t *Cmd_FindFunction(const char *cmd_name, bool nocase) {
+  cmd_function_t *cmd;
+
+  for(cmd = cmd_function_hash[Com_HashKey(cmd_name) & (CMD_HASH_SIZE - 1)]; cmd; cmd = cmd->hash_next)
+    if(nocase ? !Q_strcasecmp(cmd_name, cmd->name) : !strcmp(cmd_name, cmd->name))
+      return cmd;
+
+  return NULL;
+}
+
+static cmdalias_t *Cmd_FindAlias(const char *alias_name, bool nocase) {
+  cmdalias_t *a;
+
+  for(a = cmd_alias_hash[Com_HashKey(alias_name) & (CMD_HASH_SIZE - 1)]; a; a = a->hash_next)
+    if(nocase ? !Q_strcasecmp(alias_name, a->name) : !strcmp(alias_name, a->name))
+      return a;
+
+  return NULL;
+}
 
 /*
 ============
@@ -614,6 +656,7 @@ Cmd_AddCommand
 */
 void Cmd_AddCommand(const char *cmd_name, xcommand_t function) {
   cmd_function_t *cmd;
+  unsigned h;
 
   // fail if the command is a variable name
   if(Cvar_VariableString(cmd_name)[0]) {
@@ -622,11 +665,9 @@ void Cmd_AddCommand(const char *cmd_name, xcommand_t function) {
   }
 
   // fail if the command already exists
-  for(cmd = cmd_functions; cmd; cmd = cmd->next) {
-    if(!strcmp(cmd_name, cmd->name)) {
-      Com_Printf("Cmd_AddCommand: %s already defined\n", cmd_name);
-      return;
-    }
+  if(Cmd_FindFunction(cmd_name, false)) {
+    Com_Printf("Cmd_AddCommand: %s already defined\n", cmd_name);
+    return;
   }
 
   cmd = Z_Malloc(sizeof(cmd_function_t));
@@ -634,6 +675,9 @@ void Cmd_AddCommand(const char *cmd_name, xcommand_t function) {
   cmd->function = function;
   cmd->next = cmd_functions;
   cmd_functions = cmd;
+  h = Com_HashKey(cmd_name) & (CMD_HASH_SIZE - 1);
+  cmd->hash_next = cmd_function_hash[h];
+  cmd_function_hash[h] = cmd;
 }
 
 /*
@@ -653,11 +697,17 @@ void Cmd_RemoveCommand(const char *cmd_name) {
     }
     if(!strcmp(cmd_name, cmd->name)) {
       *back = cmd->next;
-      Z_Free(cmd);
-      return;
+      break;
     }
     back = &cmd->next;
   }
+
+  back = &cmd_function_hash[Com_HashKey(cmd_name) & (CMD_HASH_SIZE - 1)];
+  while(*back != cmd)
+    back = &(*back)->hash_next;
+  *back = cmd->hash_next;
+
+  Z_Free(cmd);
 }
 
 /*
@@ -665,16 +715,7 @@ void Cmd_RemoveCommand(const char *cmd_name) {
 Cmd_Exists
 ============
 */
-bool Cmd_Exists(const char *cmd_name) {
-  cmd_function_t *cmd;
-
-  for(cmd = cmd_functions; cmd; cmd = cmd->next) {
-    if(!strcmp(cmd_name, cmd->name))
-      return true;
-  }
-
-  return false;
-}
+bool Cmd_Exists(const char *cmd_name) { return Cmd_FindFunction(cmd_name, false) != NULL; }
 
 /*
 ============
@@ -692,12 +733,12 @@ const char *Cmd_CompleteCommand(const char *partial) {
     return NULL;
 
   // check for exact match
-  for(cmd = cmd_functions; cmd; cmd = cmd->next)
-    if(!strcmp(partial, cmd->name))
-      return cmd->name;
-  for(a = cmd_alias; a; a = a->next)
-    if(!strcmp(partial, a->name))
-      return a->name;
+  cmd = Cmd_FindFunction(partial, false);
+  if(cmd)
+    return cmd->name;
+  a = Cmd_FindAlias(partial, false);
+  if(a)
+    return a->name;
 
   // check for partial match
   for(cmd = cmd_functions; cmd; cmd = cmd->next)
@@ -715,7 +756,6 @@ const char *Cmd_CompleteCommand(const char *partial) {
 Cmd_ExecuteString
 
 A complete command line has been parsed, so try to execute it
-FIXME: lookupnoadd the token to speed search?
 ============
 */
 void Cmd_ExecuteString(const char *text) {
@@ -729,26 +769,24 @@ void Cmd_ExecuteString(const char *text) {
     return; // no tokens
 
   // check functions
-  for(cmd = cmd_functions; cmd; cmd = cmd->next) {
-    if(!Q_strcasecmp(cmd_argv[0], cmd->name)) {
-      if(!cmd->function) { // forward to server command
-        Cmd_ExecuteString(va("cmd %s", text));
-      } else
-        cmd->function();
-      return;
-    }
+  cmd = Cmd_FindFunction(cmd_argv[0], true);
+  if(cmd) {
+    if(!cmd->function) { // forward to server command
+      Cmd_ExecuteString(va("cmd %s", text));
+    } else
+      cmd->function();
+    return;
   }
 
   // check alias
-  for(a = cmd_alias; a; a = a->next) {
-    if(!Q_strcasecmp(cmd_argv[0], a->name)) {
-      if(++alias_count == ALIAS_LOOP_COUNT) {
-        Com_Printf("ALIAS_LOOP_COUNT\n");
-        return;
-      }
-      Cbuf_InsertText(a->value);
+  a = Cmd_FindAlias(cmd_argv[0], true);
+  if(a) {
+    if(++alias_count == ALIAS_LOOP_COUNT) {
+      Com_Printf("ALIAS_LOOP_COUNT\n");
       return;
     }
+    Cbuf_InsertText(a->value);
+    return;
   }
 
   // check cvars
@@ -774,6 +812,116 @@ void Cmd_List_f(void) {
   Com_Printf("%i commands\n", i);
 }
 
+/*
+============
+Cmd_Bench_f
+
+cmd_bench [passes] replays the name lookups an exec'd config and a burst
+of rcon junk make, once through the hash chains and once with the list
+walks they replaced.  The config sets every cvar both through "set" and
+by name, and binds a few keys; the junk misses every list.
+============
+*/
+#define BENCH_BINDS 128
+#define BENCH_SPAM 1024
+
+static int Cmd_BenchLinear(const char *name, const char *var) {
+  cmd_function_t *cmd;
+  cmdalias_t *a;
+  cvar_t *v;
+
+  for(cmd = cmd_functions; cmd; cmd = cmd->next)
+    if(!Q_strcasecmp(name, cmd->name))
+      break;
+  if(!cmd) {
+    for(a = cmd_alias; a; a = a->next)
+      if(!Q_strcasecmp(name, a->name))
+        return 1;
+    for(v = cvar_vars; v; v = v->next)
+      if(!strcmp(name, v->name))
+        return 1;
+    return 0;
+  }
+  if(!var)
+    return 1;
+  for(v = cvar_vars; v; v = v->next)
+    if(!strcmp(var, v->name))
+      return 2;
+  return 1;
+}
+
+static int Cmd_BenchHashed(const char *name, const char *var) {
+  if(!Cmd_FindFunction(name, true)) {
+    if(Cmd_FindAlias(name, true) || Cvar_Get(name, NULL, 0))
+      return 1;
+    return 0;
+  }
+  if(!var)
+    return 1;
+  return Cvar_Get(var, NULL, 0) ? 2 : 1;
+}
+
+static void Cmd_Bench_f(void) {
+  static char spam[BENCH_SPAM][16];
+  const char **names, **vars;
+  int numlines, numconfig;
+  int passes, p, i, w;
+  int found[2];
+  uint64_t start, elapsed[2][2];
+  cvar_t *var;
+
+  passes = Cmd_Argc() > 1 ? atoi(Cmd_Argv(1)) : 100;
+  if(passes < 1)
+    passes = 1;
+
+  numconfig = BENCH_BINDS;
+  for(var = cvar_vars; var; var = var->next)
+    numconfig += 2;
+  numlines = numconfig + BENCH_SPAM;
+  names = Z_Malloc(numlines * sizeof(*names));
+  vars = Z_Malloc(numlines * sizeof(*vars));
+
+  i = 0;
+  for(var = cvar_vars; var; var = var->next) {
+    names[i] = "set";
+    vars[i++] = var->name;
+    names[i++] = var->name;
+  }
+  for(; i < numconfig; i++)
+    names[i] = "bind";
+  for(; i < numlines; i++) {
+    Com_sprintf(spam[i - numconfig], sizeof(spam[0]), "junk%i", i - numconfig);
+    names[i] = spam[i - numconfig];
+  }
+
+  found[0] = found[1] = 0;
+  for(w = 0; w < 2; w++) {
+    start = uv_hrtime();
+    for(p = 0; p < passes; p++)
+      for(i = w ? numconfig : 0; i < (w ? numlines : numconfig); i++)
+        found[0] += Cmd_BenchLinear(names[i], vars[i]);
+    elapsed[w][0] = uv_hrtime() - start;
+
+    start = uv_hrtime();
+    for(p = 0; p < passes; p++)
+      for(i = w ? numconfig : 0; i < (w ? numlines : numconfig); i++)
+        found[1] += Cmd_BenchHashed(names[i], vars[i]);
+    elapsed[w][1] = uv_hrtime() - start;
+  }
+
+  Z_Free(names);
+  Z_Free(vars);
+
+  if(found[0] != found[1])
+    Com_Printf("lookups disagree: %i linear, %i hashed\n", found[0], found[1]);
+  Com_Printf("%i passes, msec per pass\n", passes);
+  Com_Printf("workload   lines     linear     hashed\n");
+  Com_Printf("config   %7i %10.4f %10.4f\n", numconfig, elapsed[0][0] / 1000000.0 / passes,
+             elapsed[0][1] / 1000000.0 / passes);
+  Com_Printf("rcon     %7i %10.4f %10.4f\n", BENCH_SPAM, elapsed[1][0] / 1000000.0 / passes,
+             elapsed[1][1] / 1000000.0 / passes);
+}
+
 /*
 ============
 Cmd_Init
@@ -788,4 +936,5 @@ void Cmd_Init(void) {
   Cmd_AddCommand("echo", Cmd_Echo_f);
   Cmd_AddCommand("alias", Cmd_Alias_f);
   Cmd_AddCommand("wait", Cmd_Wait_f);
+  Cmd_AddCommand("cmd_bench", Cmd_Bench_f);
 }
@@ -21,6 +21,13 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 #include "qcommon.h"
 
+#include <uv.h>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define CM_SSE
+#include <xmmintrin.h>
+#endif
+
 typedef struct {
   cplane_t *plane;
   int children[2]; // negative numbers are leafs
@@ -46,6 +53,22 @@ typedef struct {
   int checkcount; // to avoid repeated testings
 } cbrush_t;
 
+// the nodes and brush side planes are also kept in a flat form with the
+// plane data inline, built at load time, so the trace and point walks
+// don't have to chase the plane pointers
+typedef struct {
+  float normal[3];
+  float dist;
+  int type;
+  int children[2];
+  int pad; // keep two nodes to a cache line
+} cflatnode_t;
+
+typedef struct {
+  float normal[3];
+  float dist;
+} cflatplane_t; // one for each brush side, in brush side order
+
 typedef struct {
   int numareaportals;
   int firstareaportal;
@@ -70,6 +93,8 @@ struct cmodel {
 
   int numnodes;
   cnode_t map_nodes[MAX_MAP_NODES + 6]; // extra for box hull
+  cflatnode_t map_flatnodes[MAX_MAP_NODES + 6];
+  cflatplane_t map_flatplanes[MAX_MAP_BRUSHSIDES];
 
   int numleafs;
   cleaf_t map_leafs[MAX_MAP_LEAFS];
@@ -84,12 +109,18 @@ struct cmodel {
   int numbrushes;
   cbrush_t map_brushes[MAX_MAP_BRUSHES];
 
+  // the visibility and entity lumps are used in place in the mapped bsp
+  // when they can be, otherwise from a copy
+  const void *map_file;
+
   int numvisibility;
-  byte map_visibility[MAX_MAP_VISIBILITY];
-  dvis_t *map_vis;
+  const byte *map_visibility;
+  const dvis_t *map_vis;
+  byte *map_viscopy;
 
   int numentitychars;
-  char map_entitystring[MAX_MAP_ENTSTRING];
+  const char *map_entitystring;
+  char *map_entitycopy;
 
   int numareas;
   carea_t map_areas[MAX_MAP_AREAS];
@@ -114,6 +145,7 @@ struct cmodel {
 cvar_t *map_noareas;
 
 void CM_InitBoxHull(int index);
+static void CM_FlattenMap(struct cmodel *cm);
 void FloodAreaConnections(struct cmodel *cm);
 
 int c_pointcontents;
@@ -127,7 +159,7 @@ int c_traces, c_brush_traces;
 ===============================================================================
 */
 
-byte *cmod_base;
+const byte *cmod_base;
 
 /*
 =================
@@ -476,19 +508,35 @@ CMod_LoadVisibility
 =================
 */
 static void CMod_LoadVisibility(struct cmodel *cm, lump_t *l) {
+  dvis_t *vis;
   int i;
 
   cm->numvisibility = l->filelen;
   if(l->filelen > MAX_MAP_VISIBILITY)
     Com_Error(ERR_DROP, "Map has too large visibility lump");
+  if(!l->filelen)
+    return;
 
-  memcpy(cm->map_visibility, cmod_base + l->fileofs, l->filelen);
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+  if(!((uintptr_t)(cmod_base + l->fileofs) & 3)) {
+    cm->map_visibility = cmod_base + l->fileofs;
+    cm->map_vis = (const dvis_t *)cm->map_visibility;
+    return;
+  }
+#endif
 
-  cm->map_vis->numclusters = LittleLong(cm->map_vis->numclusters);
-  for(i = 0; i < cm->map_vis->numclusters; i++) {
-    cm->map_vis->bitofs[i][0] = LittleLong(cm->map_vis->bitofs[i][0]);
-    cm->map_vis->bitofs[i][1] = LittleLong(cm->map_vis->bitofs[i][1]);
+  cm->map_viscopy = Z_Malloc(l->filelen);
+  memcpy(cm->map_viscopy, cmod_base + l->fileofs, l->filelen);
+
+  vis = (dvis_t *)cm->map_viscopy;
+  vis->numclusters = LittleLong(vis->numclusters);
+  for(i = 0; i < vis->numclusters; i++) {
+    vis->bitofs[i][0] = LittleLong(vis->bitofs[i][0]);
+    vis->bitofs[i][1] = LittleLong(vis->bitofs[i][1]);
   }
+
+  cm->map_visibility = cm->map_viscopy;
+  cm->map_vis = vis;
 }
 
 /*
@@ -500,8 +548,41 @@ static void CMod_LoadEntityString(struct cmodel *cm, lump_t *l) {
   cm->numentitychars = l->filelen;
   if(l->filelen > MAX_MAP_ENTSTRING)
     Com_Error(ERR_DROP, "Map has too large entity lump");
+  if(!l->filelen)
+    return;
 
-  memcpy(cm->map_entitystring, cmod_base + l->fileofs, l->filelen);
+  // the lump normally carries its terminator
+  if(!cmod_base[l->fileofs + l->filelen - 1]) {
+    cm->map_entitystring = (const char *)cmod_base + l->fileofs;
+    return;
+  }
+
+  cm->map_entitycopy = Z_Malloc(l->filelen + 1);
+  memcpy(cm->map_entitycopy, cmod_base + l->fileofs, l->filelen);
+  cm->map_entitystring = cm->map_entitycopy;
+}
+
+/*
+=================
+CM_FreeMap
+
+Drops the view of the bsp and anything copied out of it
+=================
+*/
+static void CM_FreeMap(struct cmodel *cm) {
+  if(cm->map_viscopy)
+    Z_Free(cm->map_viscopy);
+  if(cm->map_entitycopy)
+    Z_Free(cm->map_entitycopy);
+  if(cm->map_file)
+    FS_UnmapFile(cm->map_file);
+
+  cm->map_file = NULL;
+  cm->map_viscopy = NULL;
+  cm->map_entitycopy = NULL;
+  cm->map_visibility = NULL;
+  cm->map_vis = NULL;
+  cm->map_entitystring = "";
 }
 
 /*
@@ -519,7 +600,7 @@ cmodel_t *CM_LoadMap(int index, char *name, bool clientload, unsigned *checksum)
   }
   struct cmodel *cm = &global_cmodels[index];
 
-  unsigned *buf;
+  const void *buf;
   int i;
   dheader_t header;
   int length;
@@ -537,7 +618,6 @@ cmodel_t *CM_LoadMap(int index, char *name, bool clientload, unsigned *checksum)
 
   // initialize
   cm->numleafs = 1; // allow leaf funcs to be called without a map
-  cm->map_vis = (dvis_t *)cm->map_visibility;
   cm->numareas = 1;
   cm->numclusters = 1;
 
@@ -548,8 +628,8 @@ cmodel_t *CM_LoadMap(int index, char *name, bool clientload, unsigned *checksum)
   cm->numcmodels = 0;
   cm->numvisibility = 0;
   cm->numentitychars = 0;
-  cm->map_entitystring[0] = 0;
   cm->map_name[0] = 0;
+  CM_FreeMap(cm);
 
   if(!name || !name[0]) {
     cm->numleafs = 1;
@@ -562,14 +642,15 @@ cmodel_t *CM_LoadMap(int index, char *name, bool clientload, unsigned *checksum)
   //
   // load the file
   //
-  length = FS_LoadFile(name, (void **)&buf);
+  length = FS_MapFile(name, &buf);
   if(!buf)
     Com_Error(ERR_DROP, "Couldn't load %s", name);
+  cm->map_file = buf;
 
-  cm->checksum = LittleLong(Com_BlockChecksum(buf, length));
+  cm->checksum = LittleLong(Com_BlockChecksum((void *)buf, length));
   *checksum = cm->checksum;
 
-  header = *(dheader_t *)buf;
+  header = *(const dheader_t *)buf;
   for(i = 0; i < sizeof(dheader_t) / 4; i++)
     ((int *)&header)[i] = LittleLong(((int *)&header)[i]);
 
@@ -577,7 +658,7 @@ cmodel_t *CM_LoadMap(int index, char *name, bool clientload, unsigned *checksum)
     Com_Error(ERR_DROP, "CMod_LoadBrushModel: %s has wrong version number (%i should be %i)", name, header.version,
               BSPVERSION);
 
-  cmod_base = (byte *)buf;
+  cmod_base = buf;
 
   // load into heap
   CMod_LoadSurfaces(cm, &header.lumps[LUMP_TEXINFO]);
@@ -593,9 +674,8 @@ cmodel_t *CM_LoadMap(int index, char *name, bool clientload, unsigned *checksum)
   CMod_LoadVisibility(cm, &header.lumps[LUMP_VISIBILITY]);
   CMod_LoadEntityString(cm, &header.lumps[LUMP_ENTITIES]);
 
-  FS_FreeFile(buf);
-
   CM_InitBoxHull(index);
+  CM_FlattenMap(cm);
 
   memset(cm->portalopen, 0, sizeof(cm->portalopen));
   FloodAreaConnections(cm);
@@ -648,7 +728,8 @@ char *CM_EntityString(int index) {
     Com_Error(ERR_DROP, "CMod_LoadBrushModel: %i is an invalid index (must be 0, 1, or 2)", index);
   }
   struct cmodel *cm = &global_cmodels[index];
-  return cm->map_entitystring;
+  // points into the read only map view, the game only parses it
+  return (char *)cm->map_entitystring;
 }
 
 int CM_LeafContents(int index, int leafnum) {
@@ -768,6 +849,8 @@ int CM_HeadnodeForBox(int index, vec3_t mins, vec3_t maxs) {
   }
   struct cmodel *cm = &global_cmodels[index];
 
+  int i;
+
   cm->box_planes[0].dist = maxs[0];
   cm->box_planes[1].dist = -maxs[0];
   cm->box_planes[2].dist = mins[0];
@@ -781,9 +864,44 @@ int CM_HeadnodeForBox(int index, vec3_t mins, vec3_t maxs) {
   cm->box_planes[10].dist = mins[2];
   cm->box_planes[11].dist = -mins[2];
 
+  for(i = 0; i < 6; i++) {
+    cm->map_flatnodes[cm->box_headnode + i].dist = cm->box_planes[i * 2].dist;
+    cm->map_flatplanes[cm->box_brush->firstbrushside + i].dist = cm->box_planes[i * 2 + (i & 1)].dist;
+  }
+
   return cm->box_headnode;
 }
 
+/*
+===================
+CM_FlattenMap
+
+Copies the planes of the nodes and brush sides, box hull included, into
+the flat arrays used by the traces
+===================
+*/
+static void CM_FlattenMap(struct cmodel *cm) {
+  cflatnode_t *out;
+  cflatplane_t *pout;
+  cnode_t *in;
+  cbrushside_t *side;
+  int i;
+
+  for(i = 0, in = cm->map_nodes, out = cm->map_flatnodes; i < cm->numnodes + 6; i++, in++, out++) {
+    VectorCopy(in->plane->normal, out->normal);
+    out->dist = in->plane->dist;
+    out->type = in->plane->type;
+    out->children[0] = in->children[0];
+    out->children[1] = in->children[1];
+    out->pad = 0;
+  }
+
+  for(i = 0, side = cm->map_brushsides, pout = cm->map_flatplanes; i < cm->numbrushsides + 6; i++, side++, pout++) {
+    VectorCopy(side->plane->normal, pout->normal);
+    pout->dist = side->plane->dist;
+  }
+}
+
 /*
 ==================
 CM_PointLeafnum_r
@@ -792,17 +910,15 @@ CM_PointLeafnum_r
 */
 static int CM_PointLeafnum_r(struct cmodel *cm, vec3_t p, int num) {
   float d;
-  cnode_t *node;
-  cplane_t *plane;
+  cflatnode_t *node;
 
   while(num >= 0) {
-    node = cm->map_nodes + num;
-    plane = node->plane;
+    node = cm->map_flatnodes + num;
 
-    if(plane->type < 3)
-      d = p[plane->type] - plane->dist;
+    if(node->type < 3)
+      d = p[node->type] - node->dist;
     else
-      d = DotProduct(plane->normal, p) - plane->dist;
+      d = DotProduct(node->normal, p) - node->dist;
     if(d < 0)
       num = node->children[1];
     else
@@ -986,18 +1102,18 @@ CM_ClipBoxToBrush
 void CM_ClipBoxToBrush(struct cmodel *cm, vec3_t mins, vec3_t maxs, vec3_t p1, vec3_t p2, trace_t *trace,
                        cbrush_t *brush) {
   int i, j;
-  cplane_t *plane, *clipplane;
+  cflatplane_t *plane;
   float dist;
   float enterfrac, leavefrac;
   vec3_t ofs;
   float d1, d2;
   bool getout, startout;
   float f;
-  cbrushside_t *side, *leadside;
+  cbrushside_t *leadside;
+  int lead;
 
   enterfrac = -1;
   leavefrac = 1;
-  clipplane = NULL;
 
   if(!brush->numsides)
     return;
@@ -1006,11 +1122,10 @@ void CM_ClipBoxToBrush(struct cmodel *cm, vec3_t mins, vec3_t maxs, vec3_t p1, v
 
   getout = false;
   startout = false;
-  leadside = NULL;
+  lead = -1;
 
   for(i = 0; i < brush->numsides; i++) {
-    side = &cm->map_brushsides[brush->firstbrushside + i];
-    plane = side->plane;
+    plane = &cm->map_flatplanes[brush->firstbrushside + i];
 
     // FIXME: special case for axial
 
@@ -1051,8 +1166,7 @@ void CM_ClipBoxToBrush(struct cmodel *cm, vec3_t mins, vec3_t maxs, vec3_t p1, v
       f = (d1 - DIST_EPSILON) / (d1 - d2);
       if(f > enterfrac) {
         enterfrac = f;
-        clipplane = plane;
-        leadside = side;
+        lead = i;
       }
     } else { // leave
       f = (d1 + DIST_EPSILON) / (d1 - d2);
@@ -1071,8 +1185,9 @@ void CM_ClipBoxToBrush(struct cmodel *cm, vec3_t mins, vec3_t maxs, vec3_t p1, v
     if(enterfrac > -1 && enterfrac < trace->fraction) {
       if(enterfrac < 0)
         enterfrac = 0;
+      leadside = &cm->map_brushsides[brush->firstbrushside + lead];
       trace->fraction = enterfrac;
-      trace->plane = *clipplane;
+      trace->plane = *leadside->plane;
       trace->surface = &(leadside->surface->c);
       trace->contents = brush->contents;
     }
@@ -1086,18 +1201,16 @@ CM_TestBoxInBrush
 */
 static void CM_TestBoxInBrush(struct cmodel *cm, vec3_t mins, vec3_t maxs, vec3_t p1, trace_t *trace, cbrush_t *brush) {
   int i, j;
-  cplane_t *plane;
+  cflatplane_t *plane;
   float dist;
   vec3_t ofs;
   float d1;
-  cbrushside_t *side;
 
   if(!brush->numsides)
     return;
 
   for(i = 0; i < brush->numsides; i++) {
-    side = &cm->map_brushsides[brush->firstbrushside + i];
-    plane = side->plane;
+    plane = &cm->map_flatplanes[brush->firstbrushside + i];
 
     // FIXME: special case for axial
 
@@ -1195,8 +1308,7 @@ CM_RecursiveHullCheck
 ==================
 */
 static void CM_RecursiveHullCheck(struct cmodel *cm, int num, float p1f, float p2f, vec3_t p1, vec3_t p2) {
-  cnode_t *node;
-  cplane_t *plane;
+  cflatnode_t *node;
   float t1, t2, offset;
   float frac, frac2;
   float idist;
@@ -1218,21 +1330,20 @@ static void CM_RecursiveHullCheck(struct cmodel *cm, int num, float p1f, float p
   // find the point distances to the seperating plane
   // and the offset for the size of the box
   //
-  node = cm->map_nodes + num;
-  plane = node->plane;
+  node = cm->map_flatnodes + num;
 
-  if(plane->type < 3) {
-    t1 = p1[plane->type] - plane->dist;
-    t2 = p2[plane->type] - plane->dist;
-    offset = trace_extents[plane->type];
+  if(node->type < 3) {
+    t1 = p1[node->type] - node->dist;
+    t2 = p2[node->type] - node->dist;
+    offset = trace_extents[node->type];
   } else {
-    t1 = DotProduct(plane->normal, p1) - plane->dist;
-    t2 = DotProduct(plane->normal, p2) - plane->dist;
+    t1 = DotProduct(node->normal, p1) - node->dist;
+    t2 = DotProduct(node->normal, p2) - node->dist;
     if(trace_ispoint)
       offset = 0;
     else
-      offset = fabs(trace_extents[0] * plane->normal[0]) + fabs(trace_extents[1] * plane->normal[1]) +
-               fabs(trace_extents[2] * plane->normal[2]);
+      offset = fabs(trace_extents[0] * node->normal[0]) + fabs(trace_extents[1] * node->normal[1]) +
+               fabs(trace_extents[2] * node->normal[2]);
   }
 
 #if 0
@@ -1300,12 +1411,33 @@ return;
 CM_BoxTrace
 ==================
 */
+static trace_t CM_BoxTraceFrom(struct cmodel *cm, vec3_t start, vec3_t end, vec3_t mins, vec3_t maxs, int headnode,
+                               int topnode, int brushmask);
+
 trace_t CM_BoxTrace(int index, vec3_t start, vec3_t end, vec3_t mins, vec3_t maxs, int headnode, int brushmask) {
   if(index < 0 || index >= 3) {
     Com_Error(ERR_DROP, "CMod_LoadBrushModel: %i is an invalid index (must be 0, 1, or 2)", index);
   }
   struct cmodel *cm = &global_cmodels[index];
+  trace_t trace;
+
+  Prof_Begin("CM_BoxTrace");
+  trace = CM_BoxTraceFrom(cm, start, end, mins, maxs, headnode, headnode, brushmask);
+  Prof_End();
+
+  return trace;
+}
+
+/*
+==================
+CM_BoxTraceFrom
 
+Sweeps starting at topnode, which must be headnode or a node that
+the whole move is known to stay on one side of all the way down
+==================
+*/
+static trace_t CM_BoxTraceFrom(struct cmodel *cm, vec3_t start, vec3_t end, vec3_t mins, vec3_t maxs, int headnode,
+                               int topnode, int brushmask) {
   int i;
 
   cm->checkcount++; // for multi-check avoidance
@@ -1368,7 +1500,7 @@ trace_t CM_BoxTrace(int index, vec3_t start, vec3_t end, vec3_t mins, vec3_t max
   //
   // general sweeping through world
   //
-  CM_RecursiveHullCheck(cm, headnode, 0, 1, start, end);
+  CM_RecursiveHullCheck(cm, topnode, 0, 1, start, end);
 
   if(trace_trace.fraction == 1) {
     VectorCopy(end, trace_trace.endpos);
@@ -1379,6 +1511,232 @@ trace_t CM_BoxTrace(int index, vec3_t start, vec3_t end, vec3_t mins, vec3_t max
   return trace_trace;
 }
 
+/*
+==================
+CM_BatchTopnode
+
+Walks a group of up to four moves down from the world headnode as long
+as every one of them stays entirely on the same side of each plane, and
+returns the node where they split up.  Below that node CM_RecursiveHullCheck
+would have taken exactly the same steps for every move in the group, so
+each one can start from there.  The plane tests use the same float
+operations as CM_RecursiveHullCheck, four moves at a time.
+==================
+*/
+static int CM_BatchTopnode(struct cmodel *cm, int num, int n, vec3_t *starts, vec3_t *ends, vec3_t extents,
+                           bool ispoint) {
+  cflatnode_t *node;
+  float offset;
+  int side, allside;
+#ifdef CM_SSE
+  __m128 p1[3], p2[3], t1, t2, off, negoff;
+  float lanes[4][6];
+  int i;
+
+  // pad short groups by repeating the first move
+  for(i = 0; i < 4; i++) {
+    VectorCopy(starts[i < n ? i : 0], lanes[i]);
+    VectorCopy(ends[i < n ? i : 0], (lanes[i] + 3));
+  }
+  for(i = 0; i < 3; i++) {
+    p1[i] = _mm_setr_ps(lanes[0][i], lanes[1][i], lanes[2][i], lanes[3][i]);
+    p2[i] = _mm_setr_ps(lanes[0][i + 3], lanes[1][i + 3], lanes[2][i + 3], lanes[3][i + 3]);
+  }
+#else
+  float t1, t2;
+  int j;
+#endif
+
+  while(num >= 0) {
+    node = cm->map_flatnodes + num;
+
+    if(node->type < 3)
+      offset = extents[node->type];
+    else if(ispoint)
+      offset = 0;
+    else
+      offset = fabs(extents[0] * node->normal[0]) + fabs(extents[1] * node->normal[1]) +
+               fabs(extents[2] * node->normal[2]);
+
+#ifdef CM_SSE
+    if(node->type < 3) {
+      t1 = _mm_sub_ps(p1[node->type], _mm_set1_ps(node->dist));
+      t2 = _mm_sub_ps(p2[node->type], _mm_set1_ps(node->dist));
+    } else {
+      __m128 n0 = _mm_set1_ps(node->normal[0]);
+      __m128 n1 = _mm_set1_ps(node->normal[1]);
+      __m128 n2 = _mm_set1_ps(node->normal[2]);
+      __m128 dist = _mm_set1_ps(node->dist);
+
+      t1 = _mm_sub_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(n0, p1[0]), _mm_mul_ps(n1, p1[1])), _mm_mul_ps(n2, p1[2])), dist);
+      t2 = _mm_sub_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(n0, p2[0]), _mm_mul_ps(n1, p2[1])), _mm_mul_ps(n2, p2[2])), dist);
+    }
+
+    off = _mm_set1_ps(offset);
+    negoff = _mm_set1_ps(-offset);
+    if(_mm_movemask_ps(_mm_and_ps(_mm_cmpge_ps(t1, off), _mm_cmpge_ps(t2, off))) == 15)
+      allside = 0;
+    else if(_mm_movemask_ps(_mm_and_ps(_mm_cmplt_ps(t1, negoff), _mm_cmplt_ps(t2, negoff))) == 15)
+      allside = 1;
+    else
+      allside = -1;
+#else
+    allside = -2;
+    for(j = 0; j < n; j++) {
+      if(node->type < 3) {
+        t1 = starts[j][node->type] - node->dist;
+        t2 = ends[j][node->type] - node->dist;
+      } else {
+        t1 = DotProduct(node->normal, starts[j]) - node->dist;
+        t2 = DotProduct(node->normal, ends[j]) - node->dist;
+      }
+      if(t1 >= offset && t2 >= offset)
+        side = 0;
+      else if(t1 < -offset && t2 < -offset)
+        side = 1;
+      else
+        side = -1;
+      if(allside == -2)
+        allside = side;
+      else if(allside != side)
+        allside = -1;
+      if(allside == -1)
+        break;
+    }
+#endif
+
+    if(allside < 0)
+      break;
+    side = allside;
+    num = node->children[side];
+  }
+
+  return num;
+}
+
+/*
+==================
+CM_BoxTraceBatch
+
+Traces n moves of the same box through the world model, giving the
+same results as n calls to CM_BoxTrace with headnode 0.  Moves are taken
+four at a time and share the walk down the tree until they split up.
+==================
+*/
+void CM_BoxTraceBatch(int index, int n, vec3_t *starts, vec3_t *ends, vec3_t mins, vec3_t maxs, int brushmask,
+                      trace_t *out) {
+  if(index < 0 || index >= 3) {
+    Com_Error(ERR_DROP, "CMod_LoadBrushModel: %i is an invalid index (must be 0, 1, or 2)", index);
+  }
+  struct cmodel *cm = &global_cmodels[index];
+
+  vec3_t extents;
+  bool ispoint;
+  int i, j, count, topnode;
+
+  if(!mins)
+    mins = vec3_origin;
+  if(!maxs)
+    maxs = vec3_origin;
+
+  ispoint = mins[0] == 0 && mins[1] == 0 && mins[2] == 0 && maxs[0] == 0 && maxs[1] == 0 && maxs[2] == 0;
+  if(ispoint) {
+    VectorClear(extents);
+  } else {
+    extents[0] = -mins[0] > maxs[0] ? -mins[0] : maxs[0];
+    extents[1] = -mins[1] > maxs[1] ? -mins[1] : maxs[1];
+    extents[2] = -mins[2] > maxs[2] ? -mins[2] : maxs[2];
+  }
+
+  for(i = 0; i < n; i += 4) {
+    count = n - i < 4 ? n - i : 4;
+
+    topnode = 0;
+    if(cm->numnodes)
+      topnode = CM_BatchTopnode(cm, 0, count, starts + i, ends + i, extents, ispoint);
+
+    // position tests don't walk the tree, CM_BoxTraceFrom
+    // will ignore topnode for them
+    for(j = 0; j < count; j++)
+      out[i + j] = CM_BoxTraceFrom(cm, starts[i + j], ends[i + j], mins, maxs, 0, topnode, brushmask);
+  }
+}
+
+/*
+==================
+CM_TraceBench_f
+
+Times CM_BoxTrace against CM_BoxTraceBatch on groups of rays fanned
+out from random points in a loaded map, the way shotgun pellets are
+==================
+*/
+void CM_TraceBench_f(void) {
+#define BENCH_GROUP 12
+  static vec3_t starts[BENCH_GROUP], ends[BENCH_GROUP];
+  static trace_t serial[BENCH_GROUP], batch[BENCH_GROUP];
+  struct cmodel *cm;
+  cmodel_t *world;
+  int index, groups;
+  int g, i, j;
+  int mismatches;
+  unsigned seed;
+  uint64_t serialtime, batchtime;
+  uint64_t start;
+  double rays;
+  vec3_t dir;
+
+  index = Cmd_Argc() > 1 ? atoi(Cmd_Argv(1)) : 0;
+  if(index < 0 || index >= 3 || !global_cmodels[index].numnodes) {
+    Com_Printf("usage: cm_tracebench [index] [groups], with a map loaded\n");
+    return;
+  }
+  groups = Cmd_Argc() > 2 ? atoi(Cmd_Argv(2)) : 10000;
+  if(groups < 1)
+    groups = 1;
+
+  cm = &global_cmodels[index];
+  world = &cm->map_cmodels[0];
+  mismatches = 0;
+  serialtime = batchtime = 0;
+
+  for(seed = 1, g = 0; g < groups; g++) {
+    for(j = 0; j < 3; j++) {
+      seed = seed * 1103515245 + 12345;
+      starts[0][j] = world->mins[j] + (world->maxs[j] - world->mins[j]) * ((seed >> 8) & 0xffff) / 65535.0f;
+      seed = seed * 1103515245 + 12345;
+      dir[j] = ((seed >> 8) & 0xffff) / 32767.5f - 1.0f;
+    }
+    VectorNormalize(dir);
+    for(i = 0; i < BENCH_GROUP; i++) {
+      VectorCopy(starts[0], starts[i]);
+      for(j = 0; j < 3; j++) {
+        seed = seed * 1103515245 + 12345;
+        ends[i][j] = starts[i][j] + 8192 * dir[j] + (((seed >> 8) & 0xffff) / 65535.0f - 0.5f) * 1000;
+      }
+    }
+
+    start = uv_hrtime();
+    for(i = 0; i < BENCH_GROUP; i++)
+      serial[i] = CM_BoxTrace(index, starts[i], ends[i], vec3_origin, vec3_origin, 0, MASK_SHOT);
+    serialtime += uv_hrtime() - start;
+
+    start = uv_hrtime();
+    CM_BoxTraceBatch(index, BENCH_GROUP, starts, ends, vec3_origin, vec3_origin, MASK_SHOT, batch);
+    batchtime += uv_hrtime() - start;
+
+    for(i = 0; i < BENCH_GROUP; i++)
+      if(serial[i].fraction != batch[i].fraction || serial[i].startsolid != batch[i].startsolid ||
+         !VectorCompare(serial[i].endpos, batch[i].endpos))
+        mismatches++;
+  }
+
+  rays = groups * BENCH_GROUP;
+  Com_Printf("%.0f rays, %i mismatches\n", rays, mismatches);
+  Com_Printf("CM_BoxTrace      %8.2f msec %10.0f rays/sec\n", serialtime / 1e6, rays * 1e9 / (serialtime ? serialtime : 1));
+  Com_Printf("CM_BoxTraceBatch %8.2f msec %10.0f rays/sec\n", batchtime / 1e6, rays * 1e9 / (batchtime ? batchtime : 1));
+#undef BENCH_GROUP
+}
+
 /*
 ==================
 CM_TransformedBoxTrace
@@ -1467,7 +1825,7 @@ PVS / PHS
 CM_DecompressVis
 ===================
 */
-static void CM_DecompressVis(struct cmodel *cm, byte *in, byte *out) {
+static void CM_DecompressVis(struct cmodel *cm, const byte *in, byte *out) {
   int c;
   byte *out_p;
   int row;
@@ -1505,32 +1863,48 @@ static void CM_DecompressVis(struct cmodel *cm, byte *in, byte *out) {
 static byte pvsrow[MAX_MAP_LEAFS / 8];
 static byte phsrow[MAX_MAP_LEAFS / 8];
 
-byte *CM_ClusterPVS(int index, int cluster) {
+/*
+===================
+CM_CopyClusterPVS
+
+Decompresses into a caller supplied row of at least MAX_MAP_LEAFS / 8
+bytes, so it is safe to call from worker threads
+===================
+*/
+byte *CM_CopyClusterPVS(int index, int cluster, byte *row) {
   if(index < 0 || index >= 3) {
     Com_Error(ERR_DROP, "CMod_LoadBrushModel: %i is an invalid index (must be 0, 1, or 2)", index);
   }
   struct cmodel *cm = &global_cmodels[index];
 
   if(cluster == -1)
-    memset(pvsrow, 0, (cm->numclusters + 7) >> 3);
+    memset(row, 0, (cm->numclusters + 7) >> 3);
+  else if(!cm->numvisibility)
+    CM_DecompressVis(cm, NULL, row);
   else
-    CM_DecompressVis(cm, cm->map_visibility + cm->map_vis->bitofs[cluster][DVIS_PVS], pvsrow);
-  return pvsrow;
+    CM_DecompressVis(cm, cm->map_visibility + cm->map_vis->bitofs[cluster][DVIS_PVS], row);
+  return row;
 }
 
-byte *CM_ClusterPHS(int index, int cluster) {
+byte *CM_CopyClusterPHS(int index, int cluster, byte *row) {
   if(index < 0 || index >= 3) {
     Com_Error(ERR_DROP, "CMod_LoadBrushModel: %i is an invalid index (must be 0, 1, or 2)", index);
   }
   struct cmodel *cm = &global_cmodels[index];
 
   if(cluster == -1)
-    memset(phsrow, 0, (cm->numclusters + 7) >> 3);
+    memset(row, 0, (cm->numclusters + 7) >> 3);
+  else if(!cm->numvisibility)
+    CM_DecompressVis(cm, NULL, row);
   else
-    CM_DecompressVis(cm, cm->map_visibility + cm->map_vis->bitofs[cluster][DVIS_PHS], phsrow);
-  return phsrow;
+    CM_DecompressVis(cm, cm->map_visibility + cm->map_vis->bitofs[cluster][DVIS_PHS], row);
+  return row;
 }
 
+byte *CM_ClusterPVS(int index, int cluster) { return CM_CopyClusterPVS(index, cluster, pvsrow); }
+
+byte *CM_ClusterPHS(int index, int cluster) { return CM_CopyClusterPHS(index, cluster, phsrow); }
+
 /*
 ===============================================================================
 
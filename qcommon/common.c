@@ -49,12 +49,6 @@ FILE *logfile;
 
 int server_state;
 
-// host_speeds times
-int time_before_game;
-int time_after_game;
-int time_before_ref;
-int time_after_ref;
-
 uv_loop_t global_uv_loop_value;
 void *global_uv_loop(void) { return &global_uv_loop_value; }
 
@@ -235,601 +229,6 @@ Com_SetServerState
 */
 void Com_SetServerState(int state) { server_state = state; }
 
-/*
-==============================================================================
-
-      MESSAGE IO FUNCTIONS
-
-Handles byte ordering and avoids alignment errors
-==============================================================================
-*/
-
-vec3_t bytedirs[NUMVERTEXNORMALS] = {
-#include "../client/anorms.h"
-};
-
-//
-// writing functions
-//
-
-void MSG_WriteChar(sizebuf_t *sb, int c) {
-  byte *buf;
-
-#ifdef PARANOID
-  if(c < -128 || c > 127)
-    Com_Error(ERR_FATAL, "MSG_WriteChar: range error");
-#endif
-
-  buf = SZ_GetSpace(sb, 1);
-  buf[0] = c;
-}
-
-void MSG_WriteByte(sizebuf_t *sb, int c) {
-  byte *buf;
-
-#ifdef PARANOID
-  if(c < 0 || c > 255)
-    Com_Error(ERR_FATAL, "MSG_WriteByte: range error");
-#endif
-
-  buf = SZ_GetSpace(sb, 1);
-  buf[0] = c;
-}
-
-void MSG_WriteShort(sizebuf_t *sb, int c) {
-  byte *buf;
-
-#ifdef PARANOID
-  if(c < ((short)0x8000) || c > (short)0x7fff)
-    Com_Error(ERR_FATAL, "MSG_WriteShort: range error");
-#endif
-
-  buf = SZ_GetSpace(sb, 2);
-  buf[0] = c & 0xff;
-  buf[1] = c >> 8;
-}
-
-void MSG_WriteLong(sizebuf_t *sb, int c) {
-  byte *buf;
-
-  buf = SZ_GetSpace(sb, 4);
-  buf[0] = c & 0xff;
-  buf[1] = (c >> 8) & 0xff;
-  buf[2] = (c >> 16) & 0xff;
-  buf[3] = c >> 24;
-}
-
-void MSG_WriteFloat(sizebuf_t *sb, float f) {
-  union {
-    float f;
-    int l;
-  } dat;
-
-  dat.f = f;
-  dat.l = LittleLong(dat.l);
-
-  SZ_Write(sb, &dat.l, 4);
-}
-
-void MSG_WriteString(sizebuf_t *sb, char *s) {
-  if(!s)
-    SZ_Write(sb, "", 1);
-  else
-    SZ_Write(sb, s, strlen(s) + 1);
-}
-
-void MSG_WriteCoord(sizebuf_t *sb, float f) { MSG_WriteShort(sb, (int)(f * 8)); }
-
-void MSG_WritePos(sizebuf_t *sb, vec3_t pos) {
-  MSG_WriteShort(sb, (int)(pos[0] * 8));
-  MSG_WriteShort(sb, (int)(pos[1] * 8));
-  MSG_WriteShort(sb, (int)(pos[2] * 8));
-}
-
-void MSG_WriteAngle(sizebuf_t *sb, float f) { MSG_WriteByte(sb, (int)(f * 256 / 360) & 255); }
-
-void MSG_WriteAngle16(sizebuf_t *sb, float f) { MSG_WriteShort(sb, ANGLE2SHORT(f)); }
-
-void MSG_WriteDeltaUsercmd(sizebuf_t *buf, usercmd_t *from, usercmd_t *cmd) {
-  int bits;
-
-  //
-  // send the movement message
-  //
-  bits = 0;
-  if(cmd->angles[0] != from->angles[0])
-    bits |= CM_ANGLE1;
-  if(cmd->angles[1] != from->angles[1])
-    bits |= CM_ANGLE2;
-  if(cmd->angles[2] != from->angles[2])
-    bits |= CM_ANGLE3;
-  if(cmd->forwardmove != from->forwardmove)
-    bits |= CM_FORWARD;
-  if(cmd->sidemove != from->sidemove)
-    bits |= CM_SIDE;
-  if(cmd->upmove != from->upmove)
-    bits |= CM_UP;
-  if(cmd->buttons != from->buttons)
-    bits |= CM_BUTTONS;
-  if(cmd->impulse != from->impulse)
-    bits |= CM_IMPULSE;
-
-  MSG_WriteByte(buf, bits);
-
-  if(bits & CM_ANGLE1)
-    MSG_WriteShort(buf, cmd->angles[0]);
-  if(bits & CM_ANGLE2)
-    MSG_WriteShort(buf, cmd->angles[1]);
-  if(bits & CM_ANGLE3)
-    MSG_WriteShort(buf, cmd->angles[2]);
-
-  if(bits & CM_FORWARD)
-    MSG_WriteShort(buf, cmd->forwardmove);
-  if(bits & CM_SIDE)
-    MSG_WriteShort(buf, cmd->sidemove);
-  if(bits & CM_UP)
-    MSG_WriteShort(buf, cmd->upmove);
-
-  if(bits & CM_BUTTONS)
-    MSG_WriteByte(buf, cmd->buttons);
-  if(bits & CM_IMPULSE)
-    MSG_WriteByte(buf, cmd->impulse);
-
-  MSG_WriteByte(buf, cmd->msec);
-  MSG_WriteByte(buf, cmd->lightlevel);
-}
-
-void MSG_WriteDir(sizebuf_t *sb, vec3_t dir) {
-  int i, best;
-  float d, bestd;
-
-  if(!dir) {
-    MSG_WriteByte(sb, 0);
-    return;
-  }
-
-  bestd = 0;
-  best = 0;
-  for(i = 0; i < NUMVERTEXNORMALS; i++) {
-    d = DotProduct(dir, bytedirs[i]);
-    if(d > bestd) {
-      bestd = d;
-      best = i;
-    }
-  }
-  MSG_WriteByte(sb, best);
-}
-
-void MSG_ReadDir(sizebuf_t *sb, vec3_t dir) {
-  int b;
-
-  b = MSG_ReadByte(sb);
-  if(b >= NUMVERTEXNORMALS)
-    Com_Error(ERR_DROP, "MSF_ReadDir: out of range");
-  VectorCopy(bytedirs[b], dir);
-}
-
-/*
-==================
-MSG_WriteDeltaEntity
-
-Writes part of a packetentities message.
-Can delta from either a baseline or a previous packet_entity
-==================
-*/
-void MSG_WriteDeltaEntity(entity_state_t *from, entity_state_t *to, sizebuf_t *msg, bool force, bool newentity) {
-  int bits;
-
-  if(!to->number)
-    Com_Error(ERR_FATAL, "Unset entity number");
-  if(to->number >= MAX_EDICTS)
-    Com_Error(ERR_FATAL, "Entity number >= MAX_EDICTS");
-
-  // send an update
-  bits = 0;
-
-  if(to->number >= 256)
-    bits |= U_NUMBER16; // number8 is implicit otherwise
-
-  if(to->origin[0] != from->origin[0])
-    bits |= U_ORIGIN1;
-  if(to->origin[1] != from->origin[1])
-    bits |= U_ORIGIN2;
-  if(to->origin[2] != from->origin[2])
-    bits |= U_ORIGIN3;
-
-  if(to->angles[0] != from->angles[0])
-    bits |= U_ANGLE1;
-  if(to->angles[1] != from->angles[1])
-    bits |= U_ANGLE2;
-  if(to->angles[2] != from->angles[2])
-    bits |= U_ANGLE3;
-
-  if(to->skinnum != from->skinnum) {
-    if((unsigned)to->skinnum < 256)
-      bits |= U_SKIN8;
-    else if((unsigned)to->skinnum < 0x10000)
-      bits |= U_SKIN16;
-    else
-      bits |= (U_SKIN8 | U_SKIN16);
-  }
-
-  if(to->frame != from->frame) {
-    if(to->frame < 256)
-      bits |= U_FRAME8;
-    else
-      bits |= U_FRAME16;
-  }
-
-  if(to->effects != from->effects) {
-    if(to->effects < 256)
-      bits |= U_EFFECTS8;
-    else if(to->effects < 0x8000)
-      bits |= U_EFFECTS16;
-    else
-      bits |= U_EFFECTS8 | U_EFFECTS16;
-  }
-
-  if(to->renderfx != from->renderfx) {
-    if(to->renderfx < 256)
-      bits |= U_RENDERFX8;
-    else if(to->renderfx < 0x8000)
-      bits |= U_RENDERFX16;
-    else
-      bits |= U_RENDERFX8 | U_RENDERFX16;
-  }
-
-  if(to->cmodel_index != from->cmodel_index) {
-    bits |= U_CMODEL_INDEX;
-  }
-
-  if(to->solid != from->solid)
-    bits |= U_SOLID;
-
-  // event is not delta compressed, just 0 compressed
-  if(to->event)
-    bits |= U_EVENT;
-
-  if(to->modelindex != from->modelindex)
-    bits |= U_MODEL;
-  if(to->modelindex2 != from->modelindex2)
-    bits |= U_MODEL2;
-  if(to->modelindex3 != from->modelindex3)
-    bits |= U_MODEL3;
-  if(to->modelindex4 != from->modelindex4)
-    bits |= U_MODEL4;
-
-  if(to->sound != from->sound)
-    bits |= U_SOUND;
-
-  if(newentity || (to->renderfx & RF_BEAM))
-    bits |= U_OLDORIGIN;
-
-  //
-  // write the message
-  //
-  if(!bits && !force)
-    return; // nothing to send!
-
-  //----------
-
-  if(bits & 0xff000000)
-    bits |= U_MOREBITS3 | U_MOREBITS2 | U_MOREBITS1;
-  else if(bits & 0x00ff0000)
-    bits |= U_MOREBITS2 | U_MOREBITS1;
-  else if(bits & 0x0000ff00)
-    bits |= U_MOREBITS1;
-
-  MSG_WriteByte(msg, bits & 255);
-
-  if(bits & 0xff000000) {
-    MSG_WriteByte(msg, (bits >> 8) & 255);
-    MSG_WriteByte(msg, (bits >> 16) & 255);
-    MSG_WriteByte(msg, (bits >> 24) & 255);
-  } else if(bits & 0x00ff0000) {
-    MSG_WriteByte(msg, (bits >> 8) & 255);
-    MSG_WriteByte(msg, (bits >> 16) & 255);
-  } else if(bits & 0x0000ff00) {
-    MSG_WriteByte(msg, (bits >> 8) & 255);
-  }
-
-  //----------
-
-  if(bits & U_NUMBER16)
-    MSG_WriteShort(msg, to->number);
-  else
-    MSG_WriteByte(msg, to->number);
-
-  if(bits & U_MODEL)
-    MSG_WriteByte(msg, to->modelindex);
-  if(bits & U_MODEL2)
-    MSG_WriteByte(msg, to->modelindex2);
-  if(bits & U_MODEL3)
-    MSG_WriteByte(msg, to->modelindex3);
-  if(bits & U_MODEL4)
-    MSG_WriteByte(msg, to->modelindex4);
-
-  if(bits & U_FRAME8)
-    MSG_WriteByte(msg, to->frame);
-  if(bits & U_FRAME16)
-    MSG_WriteShort(msg, to->frame);
-
-  if((bits & U_SKIN8) && (bits & U_SKIN16)) // used for laser colors
-    MSG_WriteLong(msg, to->skinnum);
-  else if(bits & U_SKIN8)
-    MSG_WriteByte(msg, to->skinnum);
-  else if(bits & U_SKIN16)
-    MSG_WriteShort(msg, to->skinnum);
-
-  if((bits & (U_EFFECTS8 | U_EFFECTS16)) == (U_EFFECTS8 | U_EFFECTS16))
-    MSG_WriteLong(msg, to->effects);
-  else if(bits & U_EFFECTS8)
-    MSG_WriteByte(msg, to->effects);
-  else if(bits & U_EFFECTS16)
-    MSG_WriteShort(msg, to->effects);
-
-  if((bits & (U_RENDERFX8 | U_RENDERFX16)) == (U_RENDERFX8 | U_RENDERFX16))
-    MSG_WriteLong(msg, to->renderfx);
-  else if(bits & U_RENDERFX8)
-    MSG_WriteByte(msg, to->renderfx);
-  else if(bits & U_RENDERFX16)
-    MSG_WriteShort(msg, to->renderfx);
-
-  if(bits & U_ORIGIN1)
-    MSG_WriteCoord(msg, to->origin[0]);
-  if(bits & U_ORIGIN2)
-    MSG_WriteCoord(msg, to->origin[1]);
-  if(bits & U_ORIGIN3)
-    MSG_WriteCoord(msg, to->origin[2]);
-
-  if(bits & U_ANGLE1)
-    MSG_WriteAngle(msg, to->angles[0]);
-  if(bits & U_ANGLE2)
-    MSG_WriteAngle(msg, to->angles[1]);
-  if(bits & U_ANGLE3)
-    MSG_WriteAngle(msg, to->angles[2]);
-
-  if(bits & U_OLDORIGIN) {
-    MSG_WriteCoord(msg, to->old_origin[0]);
-    MSG_WriteCoord(msg, to->old_origin[1]);
-    MSG_WriteCoord(msg, to->old_origin[2]);
-  }
-
-  if(bits & U_SOUND)
-    MSG_WriteByte(msg, to->sound);
-  if(bits & U_EVENT)
-    MSG_WriteByte(msg, to->event);
-  if(bits & U_SOLID)
-    MSG_WriteShort(msg, to->solid);
-
-  if(bits & U_CMODEL_INDEX)
-    MSG_WriteByte(msg, to->cmodel_index);
-}
-
-//============================================================
-
-//
-// reading functions
-//
-
-void MSG_BeginReading(sizebuf_t *msg) { msg->readcount = 0; }
-
-// returns -1 if no more characters are available
-int MSG_ReadChar(sizebuf_t *msg_read) {
-  int c;
-
-  if(msg_read->readcount + 1 > msg_read->cursize)
-    c = -1;
-  else
-    c = (signed char)msg_read->data[msg_read->readcount];
-  msg_read->readcount++;
-
-  return c;
-}
-
-int MSG_ReadByte(sizebuf_t *msg_read) {
-  int c;
-
-  if(msg_read->readcount + 1 > msg_read->cursize)
-    c = -1;
-  else
-    c = (unsigned char)msg_read->data[msg_read->readcount];
-  msg_read->readcount++;
-
-  return c;
-}
-
-int MSG_ReadShort(sizebuf_t *msg_read) {
-  int c;
-
-  if(msg_read->readcount + 2 > msg_read->cursize)
-    c = -1;
-  else
-    c = (short)(msg_read->data[msg_read->readcount] + (msg_read->data[msg_read->readcount + 1] << 8));
-
-  msg_read->readcount += 2;
-
-  return c;
-}
-
-int MSG_ReadLong(sizebuf_t *msg_read) {
-  int c;
-
-  if(msg_read->readcount + 4 > msg_read->cursize)
-    c = -1;
-  else
-    c = msg_read->data[msg_read->readcount] + (msg_read->data[msg_read->readcount + 1] << 8) +
-        (msg_read->data[msg_read->readcount + 2] << 16) + (msg_read->data[msg_read->readcount + 3] << 24);
-
-  msg_read->readcount += 4;
-
-  return c;
-}
-
-float MSG_ReadFloat(sizebuf_t *msg_read) {
-  union {
-    byte b[4];
-    float f;
-    int l;
-  } dat;
-
-  if(msg_read->readcount + 4 > msg_read->cursize)
-    dat.f = -1;
-  else {
-    dat.b[0] = msg_read->data[msg_read->readcount];
-    dat.b[1] = msg_read->data[msg_read->readcount + 1];
-    dat.b[2] = msg_read->data[msg_read->readcount + 2];
-    dat.b[3] = msg_read->data[msg_read->readcount + 3];
-  }
-  msg_read->readcount += 4;
-
-  dat.l = LittleLong(dat.l);
-
-  return dat.f;
-}
-
-char *MSG_ReadString(sizebuf_t *msg_read) {
-  static char string[2048];
-  int l, c;
-
-  l = 0;
-  do {
-    c = MSG_ReadChar(msg_read);
-    if(c == -1 || c == 0)
-      break;
-    string[l] = c;
-    l++;
-  } while(l < sizeof(string) - 1);
-
-  string[l] = 0;
-
-  return string;
-}
-
-char *MSG_ReadStringLine(sizebuf_t *msg_read) {
-  static char string[2048];
-  int l, c;
-
-  l = 0;
-  do {
-    c = MSG_ReadChar(msg_read);
-    if(c == -1 || c == 0 || c == '\n')
-      break;
-    string[l] = c;
-    l++;
-  } while(l < sizeof(string) - 1);
-
-  string[l] = 0;
-
-  return string;
-}
-
-float MSG_ReadCoord(sizebuf_t *msg_read) { return MSG_ReadShort(msg_read) * (1.0 / 8); }
-
-void MSG_ReadPos(sizebuf_t *msg_read, vec3_t pos) {
-  pos[0] = MSG_ReadShort(msg_read) * (1.0 / 8);
-  pos[1] = MSG_ReadShort(msg_read) * (1.0 / 8);
-  pos[2] = MSG_ReadShort(msg_read) * (1.0 / 8);
-}
-
-float MSG_ReadAngle(sizebuf_t *msg_read) { return MSG_ReadChar(msg_read) * (360.0 / 256); }
-
-float MSG_ReadAngle16(sizebuf_t *msg_read) { return SHORT2ANGLE(MSG_ReadShort(msg_read)); }
-
-void MSG_ReadDeltaUsercmd(sizebuf_t *msg_read, usercmd_t *from, usercmd_t *move) {
-  int bits;
-
-  memcpy(move, from, sizeof(*move));
-
-  bits = MSG_ReadByte(msg_read);
-
-  // read current angles
-  if(bits & CM_ANGLE1)
-    move->angles[0] = MSG_ReadShort(msg_read);
-  if(bits & CM_ANGLE2)
-    move->angles[1] = MSG_ReadShort(msg_read);
-  if(bits & CM_ANGLE3)
-    move->angles[2] = MSG_ReadShort(msg_read);
-
-  // read movement
-  if(bits & CM_FORWARD)
-    move->forwardmove = MSG_ReadShort(msg_read);
-  if(bits & CM_SIDE)
-    move->sidemove = MSG_ReadShort(msg_read);
-  if(bits & CM_UP)
-    move->upmove = MSG_ReadShort(msg_read);
-
-  // read buttons
-  if(bits & CM_BUTTONS)
-    move->buttons = MSG_ReadByte(msg_read);
-
-  if(bits & CM_IMPULSE)
-    move->impulse = MSG_ReadByte(msg_read);
-
-  // read time to run command
-  move->msec = MSG_ReadByte(msg_read);
-
-  // read the light level
-  move->lightlevel = MSG_ReadByte(msg_read);
-}
-
-void MSG_ReadData(sizebuf_t *msg_read, void *data, int len) {
-  int i;
-
-  for(i = 0; i < len; i++)
-    ((byte *)data)[i] = MSG_ReadByte(msg_read);
-}
-
-//===========================================================================
-
-void SZ_Init(sizebuf_t *buf, byte *data, int length) {
-  memset(buf, 0, sizeof(*buf));
-  buf->data = data;
-  buf->maxsize = length;
-}
-
-void SZ_Clear(sizebuf_t *buf) {
-  buf->cursize = 0;
-  buf->overflowed = false;
-}
-
-void *SZ_GetSpace(sizebuf_t *buf, int length) {
-  void *data;
-
-  if(buf->cursize + length > buf->maxsize) {
-    if(!buf->allowoverflow)
-      Com_Error(ERR_FATAL, "SZ_GetSpace: overflow without allowoverflow set");
-
-    if(length > buf->maxsize)
-      Com_Error(ERR_FATAL, "SZ_GetSpace: %i is > full buffer size", length);
-
-    Com_Printf("SZ_GetSpace: overflow\n");
-    SZ_Clear(buf);
-    buf->overflowed = true;
-  }
-
-  data = buf->data + buf->cursize;
-  buf->cursize += length;
-
-  return data;
-}
-
-void SZ_Write(sizebuf_t *buf, const void *data, int length) { memcpy(SZ_GetSpace(buf, length), data, length); }
-
-void SZ_Print(sizebuf_t *buf, const char *data) {
-  int len;
-
-  len = strlen(data) + 1;
-
-  if(buf->cursize) {
-    if(buf->data[buf->cursize - 1])
-      memcpy((byte *)SZ_GetSpace(buf, len), data, len); // no trailing 0
-    else
-      memcpy((byte *)SZ_GetSpace(buf, len - 1) - 1, data, len); // write over trailing 0
-  } else
-    memcpy((byte *)SZ_GetSpace(buf, len), data, len);
-}
-
 //============================================================================
 
 /*
@@ -915,6 +314,27 @@ char *CopyString(const char *in) {
   return out;
 }
 
+/*
+============
+Com_HashKey
+
+FNV-1a over the name, folding case the same way Q_strcasecmp does so
+names that only differ in case land in the same chain
+============
+*/
+unsigned Com_HashKey(const char *name) {
+  unsigned hash;
+  int c;
+
+  hash = 2166136261u;
+  while((c = *name++)) {
+    if(c >= 'a' && c <= 'z')
+      c -= 'a' - 'A';
+    hash = (hash ^ c) * 16777619u;
+  }
+  return hash;
+}
+
 void Info_Print(char *s) {
   char key[512];
   char value[512];
@@ -958,23 +378,166 @@ void Info_Print(char *s) {
 
             ZONE MEMORY ALLOCATION
 
-just cleared malloc with counters now...
+Every tag owns an arena.  Small blocks are carved out of the arena's pages
+in a fixed set of size classes and recycled through per class free lists,
+larger ones come straight from malloc and are chained to the arena.
+Z_FreeTags hands the pages back wholesale instead of visiting every block.
+Tags past the last arena share one more, where every block is malloc'd and
+Z_FreeTags has to pick out the blocks of its tag.  SV_SpawnServer gives the
+arenas of tags with nothing left allocated back through Z_ReleaseArenas.
 
 ==============================================================================
 */
 
 #define Z_MAGIC 0x1d1d
 
+#define Z_PAGE_SIZE 0x10000
+#define Z_MAX_ARENAS 64
+
 typedef struct zhead_s {
-  struct zhead_s *prev, *next;
+  struct zhead_s *prev, *next; // free list for small blocks, arena chain for large
   short magic;
   short tag; // for group free
   int size;
+  int sequence; // allocation number, for z_trace
+  int pad;
 } zhead_t;
 
-zhead_t z_chain;
+// block sizes including the header, multiples of 16 so the data stays aligned
+static const int z_classsizes[] = {48, 64, 96, 128, 192, 256, 384, 512, 768, 1024, 1536, 2048, 3072, 4096};
+#define Z_NUM_CLASSES (int)(sizeof(z_classsizes) / sizeof(z_classsizes[0]))
+#define Z_LARGE Z_NUM_CLASSES // class index of malloc'd blocks
+#define Z_MAX_SMALL 4096
+
+typedef struct zpage_s {
+  struct zpage_s *next;
+  int pad[2];
+} zpage_t;
+
+typedef struct {
+  int inuse, peak;
+  int allocs;
+} zclass_t;
+
+typedef struct {
+  bool inuse;
+  bool released; // held a tag once, lookups probe past it
+  short tag;
+
+  zpage_t *pages; // released together by Z_FreeTags
+  byte *cursor, *limit;
+  zhead_t *free[Z_NUM_CLASSES];
+  zhead_t large;
+
+  int count, bytes, numpages;
+  int peakcount, peakbytes, peakpages;
+  int classcount[Z_NUM_CLASSES + 1];
+} zarena_t;
+
+static zarena_t z_arenas[Z_MAX_ARENAS];
+static zarena_t z_sharedarena; // every tag that didn't get an arena of its own
+static zclass_t z_classes[Z_NUM_CLASSES + 1];
+static byte z_classforsize[Z_MAX_SMALL / 16 + 1]; // by block size in 16 byte units
+
 int z_count, z_bytes;
 
+static int z_sequence;
+static bool z_tracing;
+
+static void Z_TraceAlloc(zhead_t *z);
+static void Z_TraceFree(zhead_t *z);
+static void Z_TraceFreeTags(int tag);
+
+static void Z_InitClasses(void) {
+  int i, c;
+
+  for(i = 0, c = 0; i < (int)sizeof(z_classforsize); i++) {
+    while(z_classsizes[c] < i * 16)
+      c++;
+    z_classforsize[i] = c;
+  }
+}
+
+static bool Z_SharedArenaHasTag(int tag) {
+  zhead_t *z;
+
+  if(!z_sharedarena.count)
+    return false;
+  for(z = z_sharedarena.large.next; z != &z_sharedarena.large; z = z->next)
+    if(z->tag == tag)
+      return true;
+  return false;
+}
+
+static zarena_t *Z_ArenaForTag(int tag) {
+  zarena_t *arena, *empty;
+  int i, h;
+
+  h = (unsigned short)tag % Z_MAX_ARENAS;
+  empty = NULL;
+  for(i = 0; i < Z_MAX_ARENAS; i++) {
+    arena = &z_arenas[(h + i) % Z_MAX_ARENAS];
+    if(arena->inuse && arena->tag == tag)
+      return arena;
+    if(arena->inuse)
+      continue;
+    if(!empty)
+      empty = arena;
+    if(!arena->released)
+      break; // the tag would have gone here, it has no arena
+  }
+
+  // a tag that overflowed into the shared arena stays there while it
+  // has blocks in it, Z_Free finds them by tag
+  if(empty && !Z_SharedArenaHasTag(tag)) {
+    if(!z_classforsize[Z_MAX_SMALL / 16])
+      Z_InitClasses();
+
+    empty->inuse = true;
+    empty->tag = tag;
+    empty->large.prev = empty->large.next = &empty->large;
+    return empty;
+  }
+
+  if(!z_sharedarena.inuse) {
+    Com_DPrintf("Z_TagMalloc: more than %i tags in use, sharing an arena\n", Z_MAX_ARENAS);
+    z_sharedarena.inuse = true;
+    z_sharedarena.tag = -1;
+    z_sharedarena.large.prev = z_sharedarena.large.next = &z_sharedarena.large;
+  }
+  return &z_sharedarena;
+}
+
+static int Z_ClassForSize(zarena_t *arena, int size) {
+  if(size > Z_MAX_SMALL || arena == &z_sharedarena)
+    return Z_LARGE;
+  return z_classforsize[(size + 15) / 16];
+}
+
+static void Z_FreeBlock(zarena_t *arena, zhead_t *z) {
+  int c;
+
+  c = Z_ClassForSize(arena, z->size);
+
+  arena->count--;
+  arena->bytes -= z->size;
+  arena->classcount[c]--;
+  z_classes[c].inuse--;
+  z_count--;
+  z_bytes -= z->size;
+  z->magic = 0;
+
+  if(c == Z_LARGE) {
+    z->prev->next = z->next;
+    z->next->prev = z->prev;
+    free(z);
+    return;
+  }
+
+  z->next = arena->free[c];
+  arena->free[c] = z;
+}
+
 /*
 ========================
 Z_Free
@@ -988,12 +551,10 @@ void Z_Free(void *ptr) {
   if(z->magic != Z_MAGIC)
     Com_Error(ERR_FATAL, "Z_Free: bad magic");
 
-  z->prev->next = z->next;
-  z->next->prev = z->prev;
+  if(z_tracing)
+    Z_TraceFree(z);
 
-  z_count--;
-  z_bytes -= z->size;
-  free(z);
+  Z_FreeBlock(Z_ArenaForTag(z->tag), z);
 }
 
 /*
@@ -1001,20 +562,110 @@ void Z_Free(void *ptr) {
 Z_Stats_f
 ========================
 */
-void Z_Stats_f(void) { Com_Printf("%i bytes in %i blocks\n", z_bytes, z_count); }
+void Z_Stats_f(void) {
+  zarena_t *arena;
+  zclass_t *zc;
+  int i;
+
+  Com_Printf("%i bytes in %i blocks\n", z_bytes, z_count);
+
+  Com_Printf("   tag  blocks     bytes pages   peak blocks  peak bytes peak pages\n");
+  for(i = 0, arena = z_arenas; i < Z_MAX_ARENAS; i++, arena++) {
+    if(!arena->inuse)
+      continue;
+    Com_Printf("%6i %7i %9i %5i %13i %11i %10i\n", arena->tag, arena->count, arena->bytes, arena->numpages,
+               arena->peakcount, arena->peakbytes, arena->peakpages);
+  }
+  if(z_sharedarena.inuse)
+    Com_Printf("shared %7i %9i %5i %13i %11i %10i\n", z_sharedarena.count, z_sharedarena.bytes, 0,
+               z_sharedarena.peakcount, z_sharedarena.peakbytes, 0);
+
+  Com_Printf(" class   inuse      peak     allocs\n");
+  for(i = 0, zc = z_classes; i <= Z_NUM_CLASSES; i++, zc++) {
+    if(!zc->allocs)
+      continue;
+    if(i == Z_LARGE)
+      Com_Printf(" large %7i %9i %10i\n", zc->inuse, zc->peak, zc->allocs);
+    else
+      Com_Printf("%6i %7i %9i %10i\n", z_classsizes[i], zc->inuse, zc->peak, zc->allocs);
+  }
+}
 
 /*
 ========================
 Z_FreeTags
+
+Only the large blocks are visited, the small ones go with their pages
 ========================
 */
 void Z_FreeTags(int tag) {
+  zarena_t *arena;
   zhead_t *z, *next;
+  zpage_t *page, *nextpage;
+  int c;
+
+  arena = Z_ArenaForTag(tag);
 
-  for(z = z_chain.next; z != &z_chain; z = next) {
+  if(z_tracing)
+    Z_TraceFreeTags(tag);
+
+  if(arena == &z_sharedarena) {
+    for(z = arena->large.next; z != &arena->large; z = next) {
+      next = z->next;
+      if(z->tag == tag)
+        Z_FreeBlock(arena, z);
+    }
+    return;
+  }
+
+  for(z = arena->large.next; z != &arena->large; z = next) {
     next = z->next;
-    if(z->tag == tag)
-      Z_Free((void *)(z + 1));
+    free(z);
+  }
+
+  for(page = arena->pages; page; page = nextpage) {
+    nextpage = page->next;
+    free(page);
+  }
+
+  for(c = 0; c <= Z_NUM_CLASSES; c++)
+    z_classes[c].inuse -= arena->classcount[c];
+  z_count -= arena->count;
+  z_bytes -= arena->bytes;
+
+  arena->pages = NULL;
+  arena->cursor = arena->limit = NULL;
+  memset(arena->free, 0, sizeof(arena->free));
+  memset(arena->classcount, 0, sizeof(arena->classcount));
+  arena->large.prev = arena->large.next = &arena->large;
+  arena->count = arena->bytes = arena->numpages = 0;
+}
+
+/*
+========================
+Z_ReleaseArenas
+
+Frees the pages of every arena with no blocks left and lets another tag
+have its slot.  Without this a slot stays with the first tag that used
+it, and once all of them are taken every new tag shares the slow arena
+========================
+*/
+void Z_ReleaseArenas(void) {
+  zarena_t *arena;
+  zpage_t *page, *nextpage;
+  int i;
+
+  for(i = 0, arena = z_arenas; i < Z_MAX_ARENAS; i++, arena++) {
+    if(!arena->inuse || arena->count)
+      continue;
+
+    for(page = arena->pages; page; page = nextpage) {
+      nextpage = page->next;
+      free(page);
+    }
+
+    memset(arena, 0, sizeof(*arena));
+    arena->released = true;
   }
 }
 
@@ -1024,23 +675,65 @@ Z_TagMalloc
 ========================
 */
 void *Z_TagMalloc(int size, int tag) {
+  zarena_t *arena;
+  zclass_t *zc;
+  zpage_t *page;
   zhead_t *z;
+  int c;
 
   size = size + sizeof(zhead_t);
-  z = malloc(size);
-  if(!z)
-    Com_Error(ERR_FATAL, "Z_Malloc: failed on allocation of %i bytes", size);
-  memset(z, 0, size);
-  z_count++;
-  z_bytes += size;
+  arena = Z_ArenaForTag(tag);
+  c = Z_ClassForSize(arena, size);
+
+  if(c == Z_LARGE) {
+    z = malloc(size);
+    if(!z)
+      Com_Error(ERR_FATAL, "Z_Malloc: failed on allocation of %i bytes", size);
+    z->next = arena->large.next;
+    z->prev = &arena->large;
+    arena->large.next->prev = z;
+    arena->large.next = z;
+  } else if(arena->free[c]) {
+    z = arena->free[c];
+    arena->free[c] = z->next;
+  } else {
+    if(arena->cursor + z_classsizes[c] > arena->limit) {
+      // the tail of the old page is lost until the tag is freed
+      page = malloc(Z_PAGE_SIZE);
+      if(!page)
+        Com_Error(ERR_FATAL, "Z_Malloc: failed on allocation of %i bytes", Z_PAGE_SIZE);
+      page->next = arena->pages;
+      arena->pages = page;
+      arena->cursor = (byte *)(page + 1);
+      arena->limit = (byte *)page + Z_PAGE_SIZE;
+      if(++arena->numpages > arena->peakpages)
+        arena->peakpages = arena->numpages;
+    }
+    z = (zhead_t *)arena->cursor;
+    arena->cursor += z_classsizes[c];
+  }
+
+  memset(&z->magic, 0, size - offsetof(zhead_t, magic));
   z->magic = Z_MAGIC;
   z->tag = tag;
   z->size = size;
+  z->sequence = z_sequence++;
 
-  z->next = z_chain.next;
-  z->prev = &z_chain;
-  z_chain.next->prev = z;
-  z_chain.next = z;
+  z_count++;
+  z_bytes += size;
+  zc = &z_classes[c];
+  zc->allocs++;
+  if(++zc->inuse > zc->peak)
+    zc->peak = zc->inuse;
+  arena->classcount[c]++;
+  arena->bytes += size;
+  if(arena->bytes > arena->peakbytes)
+    arena->peakbytes = arena->bytes;
+  if(++arena->count > arena->peakcount)
+    arena->peakcount = arena->count;
+
+  if(z_tracing)
+    Z_TraceAlloc(z);
 
   return (void *)(z + 1);
 }
@@ -1052,6 +745,263 @@ Z_Malloc
 */
 void *Z_Malloc(int size) { return Z_TagMalloc(size, 0); }
 
+/*
+==============================================================================
+
+            ZONE TRACE
+
+z_trace records every zone call so z_bench can replay it, for example
+across a map load:  z_trace start; map base1 ... z_trace stop; z_bench 20
+
+==============================================================================
+*/
+
+typedef enum { ZOP_ALLOC, ZOP_FREE, ZOP_FREETAGS } zop_t;
+
+typedef struct {
+  byte op;
+  short tag;
+  int size; // ZOP_ALLOC
+  int id;   // index of the ZOP_ALLOC, for ZOP_FREE
+} ztraceop_t;
+
+static ztraceop_t *z_trace;
+static int z_tracecount, z_tracemax;
+static int z_tracefirst; // sequence number of the first traced allocation
+
+// sequence number - z_tracefirst -> index of the ZOP_ALLOC
+static int *z_traceids;
+static int z_traceidmax;
+
+static ztraceop_t *Z_TraceOp(zop_t op, int tag) {
+  ztraceop_t *t;
+
+  if(z_tracecount == z_tracemax) {
+    z_tracemax = z_tracemax ? z_tracemax * 2 : 65536;
+    t = realloc(z_trace, z_tracemax * sizeof(*t));
+    if(!t)
+      Com_Error(ERR_FATAL, "Z_TraceOp: out of memory");
+    z_trace = t;
+  }
+
+  t = &z_trace[z_tracecount++];
+  t->op = op;
+  t->tag = tag;
+  t->size = 0;
+  t->id = -1;
+  return t;
+}
+
+static void Z_TraceAlloc(zhead_t *z) {
+  ztraceop_t *t;
+  int *ids;
+  int seq;
+
+  seq = z->sequence - z_tracefirst;
+  if(seq >= z_traceidmax) {
+    z_traceidmax = z_traceidmax ? z_traceidmax * 2 : 65536;
+    ids = realloc(z_traceids, z_traceidmax * sizeof(*ids));
+    if(!ids)
+      Com_Error(ERR_FATAL, "Z_TraceAlloc: out of memory");
+    z_traceids = ids;
+  }
+  z_traceids[seq] = z_tracecount;
+
+  t = Z_TraceOp(ZOP_ALLOC, z->tag);
+  t->size = z->size - sizeof(zhead_t);
+}
+
+static void Z_TraceFree(zhead_t *z) {
+  // blocks from before the trace started are left out of the replay
+  if(z->sequence < z_tracefirst)
+    return;
+  Z_TraceOp(ZOP_FREE, z->tag)->id = z_traceids[z->sequence - z_tracefirst];
+}
+
+static void Z_TraceFreeTags(int tag) { Z_TraceOp(ZOP_FREETAGS, tag); }
+
+/*
+========================
+Z_Trace_f
+========================
+*/
+static void Z_Trace_f(void) {
+  if(Cmd_Argc() == 2 && !strcmp(Cmd_Argv(1), "start")) {
+    z_tracecount = 0;
+    z_tracefirst = z_sequence;
+    z_tracing = true;
+  } else if(Cmd_Argc() == 2 && !strcmp(Cmd_Argv(1), "stop")) {
+    z_tracing = false;
+  } else {
+    Com_Printf("usage: z_trace <start | stop>\n");
+    return;
+  }
+  Com_Printf("%i zone operations traced\n", z_tracecount);
+}
+
+// the allocator this one replaced, kept for comparison
+typedef struct zbenchhead_s {
+  struct zbenchhead_s *prev, *next;
+  short tag;
+  int size;
+} zbenchhead_t;
+
+static zbenchhead_t z_benchchain;
+
+static void *Z_BenchChainAlloc(int size, int tag) {
+  zbenchhead_t *z;
+
+  size = size + sizeof(zbenchhead_t);
+  z = malloc(size);
+  if(!z)
+    Com_Error(ERR_FATAL, "Z_BenchChainAlloc: failed on allocation of %i bytes", size);
+  memset(z, 0, size);
+  z->tag = tag;
+  z->size = size;
+  z->next = z_benchchain.next;
+  z->prev = &z_benchchain;
+  z_benchchain.next->prev = z;
+  z_benchchain.next = z;
+  return (void *)(z + 1);
+}
+
+static void Z_BenchChainFree(void *ptr) {
+  zbenchhead_t *z;
+
+  z = ((zbenchhead_t *)ptr) - 1;
+  z->prev->next = z->next;
+  z->next->prev = z->prev;
+  free(z);
+}
+
+static void Z_BenchChainFreeTags(int tag) {
+  zbenchhead_t *z, *next;
+
+  for(z = z_benchchain.next; z != &z_benchchain; z = next) {
+    next = z->next;
+    if(z->tag == tag)
+      Z_BenchChainFree((void *)(z + 1));
+  }
+}
+
+/*
+========================
+Z_Replay
+
+Runs the trace once, live tags are moved out of the way so the replay
+can't free anything that belongs to the running game.  Trace tags past
+the first few all share the last bench tag, freeing one of those frees
+its own blocks one at a time so the others' stay allocated.
+========================
+*/
+#define Z_BENCH_TAGS 8
+#define Z_BENCH_TAGBASE 0x7f00
+
+static uint64_t Z_Replay(bool chain, void **blocks) {
+  short tags[Z_BENCH_TAGS];
+  ztraceop_t *t;
+  uint64_t start;
+  int i, j, k, numtags, tag;
+
+  numtags = 0;
+  start = uv_hrtime();
+
+  for(i = 0, t = z_trace; i < z_tracecount; i++, t++) {
+    for(j = 0; j < numtags && tags[j] != t->tag; j++)
+      ;
+    if(j == numtags) {
+      if(numtags < Z_BENCH_TAGS)
+        tags[numtags++] = t->tag;
+      else
+        j = Z_BENCH_TAGS - 1;
+    }
+    tag = Z_BENCH_TAGBASE + j;
+
+    switch(t->op) {
+    case ZOP_ALLOC:
+      blocks[i] = chain ? Z_BenchChainAlloc(t->size, tag) : Z_TagMalloc(t->size, tag);
+      break;
+    case ZOP_FREE:
+      if(chain)
+        Z_BenchChainFree(blocks[t->id]);
+      else
+        Z_Free(blocks[t->id]);
+      blocks[t->id] = NULL;
+      break;
+    case ZOP_FREETAGS:
+      if(j < Z_BENCH_TAGS - 1) {
+        if(chain)
+          Z_BenchChainFreeTags(tag);
+        else
+          Z_FreeTags(tag);
+        break;
+      }
+      for(k = 0; k < i; k++) {
+        if(z_trace[k].op != ZOP_ALLOC || z_trace[k].tag != t->tag || !blocks[k])
+          continue;
+        if(chain)
+          Z_BenchChainFree(blocks[k]);
+        else
+          Z_Free(blocks[k]);
+        blocks[k] = NULL;
+      }
+      break;
+    }
+  }
+
+  // whatever the trace left allocated
+  for(j = 0; j < numtags; j++) {
+    if(chain)
+      Z_BenchChainFreeTags(Z_BENCH_TAGBASE + j);
+    else
+      Z_FreeTags(Z_BENCH_TAGBASE + j);
+  }
+
+  return uv_hrtime() - start;
+}
+
+/*
+========================
+Z_Bench_f
+========================
+*/
+static void Z_Bench_f(void) {
+  uint64_t arena, chain;
+  void **blocks;
+  bool tracing;
+  int i, runs;
+
+  if(!z_tracecount) {
+    Com_Printf("Nothing traced, use z_trace start / stop around a map load\n");
+    return;
+  }
+
+  runs = Cmd_Argc() > 1 ? atoi(Cmd_Argv(1)) : 10;
+  if(runs < 1)
+    runs = 1;
+
+  blocks = calloc(z_tracecount, sizeof(*blocks));
+  if(!blocks)
+    return;
+
+  tracing = z_tracing;
+  z_tracing = false;
+  z_benchchain.prev = z_benchchain.next = &z_benchchain;
+
+  arena = chain = 0;
+  for(i = 0; i < runs; i++) {
+    chain += Z_Replay(true, blocks);
+    arena += Z_Replay(false, blocks);
+  }
+
+  z_tracing = tracing;
+  free(blocks);
+
+  Com_Printf("%i operations, %i runs\n", z_tracecount, runs);
+  Com_Printf("malloc chain: %8.3f ms per run\n", chain / 1e6 / runs);
+  Com_Printf("tag arenas:   %8.3f ms per run\n", arena / 1e6 / runs);
+}
+
 //============================================================================
 
 static byte chktbl[1024] = {
@@ -1166,9 +1116,18 @@ test error shutdown procedures
 */
 void Com_Error_f(void) { Com_Error(ERR_FATAL, "%s", Cmd_Argv(1)); }
 
+static uv_timer_t frame_uv_timer;
+
+#define COM_FRAME_MSEC 10 // client frames, just above 90fps
+#define COM_IDLE_MSEC 100 // dedicated without a server running, only the console to poll
+#define COM_WAKE_MSEC 1   // least gap before a dedicated frame Qcommon_Sleep asked for
+
+static bool com_inframe;
+static uint64_t com_nextframe; // loop time a dedicated frame timer is due
+static uint64_t com_lastframe; // loop time the last dedicated frame ran
+
 static void frame_uv_timer_cb(uv_timer_t *timer) {
   static uint64_t old_time;
-  (void)timer;
 
   uint64_t time = uv_now(global_uv_loop());
   uint64_t delta = time - old_time;
@@ -1176,7 +1135,53 @@ static void frame_uv_timer_cb(uv_timer_t *timer) {
 
   curtime = Sys_Milliseconds();
 
+  // anything with a client renders every frame
+  if(!dedicated->value) {
+    if(!uv_timer_get_repeat(timer))
+      uv_timer_start(timer, frame_uv_timer_cb, COM_FRAME_MSEC, COM_FRAME_MSEC);
+    Qcommon_Frame((int)delta);
+    return;
+  }
+
+  com_inframe = true;
+  com_lastframe = time;
+  com_nextframe = time + COM_IDLE_MSEC;
   Qcommon_Frame((int)delta);
+  com_inframe = false;
+
+  uv_timer_start(timer, frame_uv_timer_cb, com_nextframe > time ? com_nextframe - time : 0, 0);
+}
+
+/*
+=================
+Qcommon_Sleep
+
+Asks for the next frame to run within msec.  Clients run frames off a
+fixed 10 msec timer and ignore this, a dedicated server leaves the loop
+asleep until its next tick is due or a packet comes in.  Frames asked for
+this way are at least COM_WAKE_MSEC apart, so a packet flood can't run
+one after another
+=================
+*/
+void Qcommon_Sleep(int msec) {
+  uint64_t now, due;
+
+  if(!dedicated || !dedicated->value)
+    return;
+
+  if(msec < 0)
+    msec = 0;
+  now = uv_now(global_uv_loop());
+  due = now + msec;
+  if(due < com_lastframe + COM_WAKE_MSEC)
+    due = com_lastframe + COM_WAKE_MSEC;
+  if(due >= com_nextframe)
+    return;
+  com_nextframe = due;
+
+  // called from a socket callback between frames, pull the timer in
+  if(!com_inframe)
+    uv_timer_start(&frame_uv_timer, frame_uv_timer_cb, due - now, 0);
 }
 
 /*
@@ -1194,11 +1199,10 @@ void Qcommon_Init(int argc, char **argv) {
 
   srand(uv_hrtime());
 
-  static uv_timer_t frame_uv_timer;
+  // the first frame picks between the fixed client rate and sleeping
+  // until the server's next tick
   uv_timer_init(global_uv_loop(), &frame_uv_timer);
-  uv_timer_start(&frame_uv_timer, frame_uv_timer_cb, 0, 10); // just above 90fps
-
-  z_chain.next = z_chain.prev = &z_chain;
+  uv_timer_start(&frame_uv_timer, frame_uv_timer_cb, 0, 0);
 
   // prepare enough of the subsystems to handle
   // cvar and command buffer management
@@ -1231,6 +1235,10 @@ void Qcommon_Init(int argc, char **argv) {
   // init commands and vars
   //
   Cmd_AddCommand("z_stats", Z_Stats_f);
+  Cmd_AddCommand("z_trace", Z_Trace_f);
+  Cmd_AddCommand("z_bench", Z_Bench_f);
+  Prof_Init();
+  Cmd_AddCommand("cm_tracebench", CM_TraceBench_f);
   Cmd_AddCommand("error", Com_Error_f);
 
   host_speeds = Cvar_Get("host_speeds", "0", 0);
@@ -1284,11 +1292,12 @@ Qcommon_Frame
 */
 void Qcommon_Frame(int msec) {
   char *s;
-  int time_before, time_between, time_after;
 
   if(setjmp(abortframe))
     return; // an ERR_DROP was thrown
 
+  Prof_BeginFrame();
+
   if(log_stats->modified) {
     log_stats->modified = false;
     if(log_stats->value) {
@@ -1332,31 +1341,28 @@ void Qcommon_Frame(int msec) {
   } while(s);
   Cbuf_Execute();
 
-  if(host_speeds->value)
-    time_before = Sys_Milliseconds();
-
+  Prof_Begin("SV_Frame");
   SV_Frame(msec);
+  Prof_End();
 
-  if(host_speeds->value)
-    time_between = Sys_Milliseconds();
-
+  Prof_Begin("CL_Frame");
   CL_Frame(msec);
+  Prof_End();
 
-  if(host_speeds->value)
-    time_after = Sys_Milliseconds();
-
+  // host_speeds is read off the profiler zones, it turns them on
   if(host_speeds->value) {
-    int all, sv, gm, cl, rf;
-
-    all = time_after - time_before;
-    sv = time_between - time_before;
-    cl = time_after - time_between;
-    gm = time_after_game - time_before_game;
-    rf = time_after_ref - time_before_ref;
-    sv -= gm;
-    cl -= rf;
-    Com_Printf("all:%3i sv:%3i gm:%3i cl:%3i rf:%3i\n", all, sv, gm, cl, rf);
+    float sv, gm, cl, rf;
+
+    sv = Prof_ZoneMsec("SV_Frame");
+    cl = Prof_ZoneMsec("CL_Frame");
+    gm = Prof_ZoneMsec("SV_RunGameFrame");
+    rf = Prof_ZoneMsec("SCR_UpdateScreen");
+    Com_Printf("all:%5.1f sv:%5.1f gm:%5.1f cl:%5.1f rf:%5.1f\n", sv + cl, sv - gm, gm, cl - rf, rf);
   }
+
+  NET_Flush();
+
+  Prof_EndFrame();
 }
 
 int Qcommon_RunFrames(void) { return uv_run(global_uv_loop(), UV_RUN_DEFAULT); }
@@ -0,0 +1,187 @@
+/*
+Copyright (C) 1997-2001 Id Software, Inc.
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+// compress.c -- fast LZ77 block compression
+//
+// A block is a run of sequences.  Each starts with a token byte, the
+// literal count in the high nibble and the match length less four in the
+// low one, a nibble of 15 being continued by bytes until one under 255.
+// Then come the literals and a two byte little endian match offset.  The
+// last sequence has literals only and ends the block.
+
+#include "qcommon.h"
+
+#define LZ_HASH_BITS 13
+#define LZ_MIN_MATCH 4
+#define LZ_MAX_OFFSET 65535
+#define LZ_TAIL 12 // bytes at the end never searched for matches
+
+static unsigned LZ_Hash(const byte *p) {
+  unsigned v;
+
+  v = p[0] | p[1] << 8 | p[2] << 16 | (unsigned)p[3] << 24;
+  return (v * 2654435761u) >> (32 - LZ_HASH_BITS);
+}
+
+static byte *LZ_WriteToken(byte *op, int litlen, int matchlen) {
+  *op++ = (litlen < 15 ? litlen : 15) << 4 | (matchlen < 15 ? matchlen : 15);
+  if(litlen >= 15) {
+    for(litlen -= 15; litlen >= 255; litlen -= 255)
+      *op++ = 255;
+    *op++ = litlen;
+  }
+  return op;
+}
+
+static int LZ_ReadLength(const byte **ip, const byte *end, int len) {
+  int b;
+
+  if(len != 15)
+    return len;
+  do {
+    if(*ip >= end)
+      return -1;
+    b = *(*ip)++;
+    len += b;
+  } while(b == 255);
+  return len;
+}
+
+/*
+================
+LZ_CompressBound
+
+The most LZ_Compress can write for inlen bytes
+================
+*/
+int LZ_CompressBound(int inlen) { return inlen + inlen / 255 + 16; }
+
+/*
+================
+LZ_Compress
+
+Returns the compressed length, or -1 if out is smaller than LZ_CompressBound
+================
+*/
+int LZ_Compress(const byte *in, int inlen, byte *out, int outmax) {
+  int table[1 << LZ_HASH_BITS];
+  const byte *ip, *anchor, *end, *limit, *match;
+  byte *op;
+  int h, pos, matchlen, offset, extra;
+
+  if(outmax < LZ_CompressBound(inlen))
+    return -1;
+
+  memset(table, -1, sizeof(table));
+  ip = anchor = in;
+  end = in + inlen;
+  limit = inlen > LZ_TAIL ? end - LZ_TAIL : in;
+  op = out;
+
+  while(ip < limit) {
+    h = LZ_Hash(ip);
+    pos = table[h];
+    table[h] = ip - in;
+
+    if(pos < 0 || ip - (in + pos) > LZ_MAX_OFFSET || memcmp(in + pos, ip, LZ_MIN_MATCH)) {
+      // step faster through data that isn't compressing
+      ip += 1 + ((ip - anchor) >> 6);
+      continue;
+    }
+
+    match = in + pos;
+    matchlen = LZ_MIN_MATCH;
+    while(ip + matchlen < end && match[matchlen] == ip[matchlen])
+      matchlen++;
+    offset = ip - match;
+
+    op = LZ_WriteToken(op, ip - anchor, matchlen - LZ_MIN_MATCH);
+    memcpy(op, anchor, ip - anchor);
+    op += ip - anchor;
+    *op++ = offset & 255;
+    *op++ = offset >> 8;
+    if(matchlen - LZ_MIN_MATCH >= 15) {
+      for(extra = matchlen - LZ_MIN_MATCH - 15; extra >= 255; extra -= 255)
+        *op++ = 255;
+      *op++ = extra;
+    }
+
+    ip += matchlen;
+    anchor = ip;
+  }
+
+  op = LZ_WriteToken(op, end - anchor, 0);
+  memcpy(op, anchor, end - anchor);
+  op += end - anchor;
+
+  return op - out;
+}
+
+/*
+================
+LZ_Decompress
+
+Returns the decompressed length, or -1 if the block is damaged or does
+not fit in outmax bytes
+================
+*/
+int LZ_Decompress(const byte *in, int inlen, byte *out, int outmax) {
+  const byte *ip, *end, *match;
+  byte *op, *oend;
+  int token, len, offset;
+
+  ip = in;
+  end = in + inlen;
+  op = out;
+  oend = out + outmax;
+
+  while(ip < end) {
+    token = *ip++;
+
+    len = LZ_ReadLength(&ip, end, token >> 4);
+    if(len < 0 || len > end - ip || len > oend - op)
+      return -1;
+    memcpy(op, ip, len);
+    op += len;
+    ip += len;
+    if(ip == end)
+      break; // the last sequence has no match
+
+    if(end - ip < 2)
+      return -1;
+    offset = ip[0] | ip[1] << 8;
+    ip += 2;
+    if(!offset || offset > op - out)
+      return -1;
+
+    len = LZ_ReadLength(&ip, end, token & 15);
+    if(len < 0)
+      return -1;
+    len += LZ_MIN_MATCH;
+    if(len > oend - op)
+      return -1;
+
+    // byte at a time, the match may overlap what it writes
+    match = op - offset;
+    while(len--)
+      *op++ = *match++;
+  }
+
+  return op - out;
+}
@@ -21,7 +21,11 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 #include "qcommon.h"
 
-cvar_t *cvar_vars;
+cvar_t *cvar_vars; // newest first, the order cvarlist and config.cfg see
+
+#define CVAR_HASH_SIZE 512 // power of two
+
+static cvar_t *cvar_hash[CVAR_HASH_SIZE];
 
 /*
 ============
@@ -46,7 +50,7 @@ Cvar_FindVar
 static cvar_t *Cvar_FindVar(const char *var_name) {
   cvar_t *var;
 
-  for(var = cvar_vars; var; var = var->next)
+  for(var = cvar_hash[Com_HashKey(var_name) & (CVAR_HASH_SIZE - 1)]; var; var = var->hash_next)
     if(!strcmp(var_name, var->name))
       return var;
 
@@ -96,9 +100,9 @@ char *Cvar_CompleteVariable(const char *partial) {
     return NULL;
 
   // check exact match
-  for(cvar = cvar_vars; cvar; cvar = cvar->next)
-    if(!strcmp(partial, cvar->name))
-      return cvar->name;
+  cvar = Cvar_FindVar(partial);
+  if(cvar)
+    return cvar->name;
 
   // check partial match
   for(cvar = cvar_vars; cvar; cvar = cvar->next)
@@ -118,6 +122,7 @@ The flags will be or'ed in if the variable exists.
 */
 cvar_t *Cvar_Get(const char *var_name, const char *var_value, int flags) {
   cvar_t *var;
+  unsigned h;
 
   if(flags & (CVAR_USERINFO | CVAR_SERVERINFO)) {
     if(!Cvar_InfoValidate(var_name)) {
@@ -151,6 +156,9 @@ cvar_t *Cvar_Get(const char *var_name, const char *var_value, int flags) {
   // link the variable in
   var->next = cvar_vars;
   cvar_vars = var;
+  h = Com_HashKey(var_name) & (CVAR_HASH_SIZE - 1);
+  var->hash_next = cvar_hash[h];
+  cvar_hash[h] = var;
 
   var->flags = flags;
 
@@ -0,0 +1,376 @@
+/*
+Copyright (C) 1997-2001 Id Software, Inc.
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+// delta_bench.c -- round trips the PROTOCOL_VERSION deltas, no server or client
+//
+// usage: delta_bench [frames] [seed]
+//
+// Plays a made up stream of entities and a player through the writers and
+// readers the server and client use, every frame delta compressed from
+// what the reader ended up with.  Anything read back that differs from
+// what was written is a mismatch.  Then reports the bytes per frame
+// against protocol 34 and times writing and reading.
+
+#include "qcommon.h"
+
+#include <uv.h>
+
+#define BENCH_ENTITIES 128
+#define BENCH_MSEC 100 // between frames
+
+typedef struct {
+  entity_state_t server[BENCH_ENTITIES + 1]; // what the frame writes
+  entity_state_t client[BENCH_ENTITIES + 1]; // what the reader holds, the next base
+  bool present[BENCH_ENTITIES + 1];
+  player_state_t ps, ops;
+} benchstate_t;
+
+static benchstate_t bench;
+static unsigned bench_seed;
+
+static int Bench_Rand(int range) {
+  bench_seed = bench_seed * 1103515245 + 12345;
+  return (bench_seed >> 8) % range;
+}
+
+static float Bench_Coord(int packed) { return (short)packed * (1.0 / 8); }
+
+static float Bench_Angle(int packed) { return (signed char)packed * (360.0 / 256); }
+
+static float Bench_Quarter(int packed) { return (signed char)packed * 0.25; }
+
+/*
+================
+Bench_MoveEntity
+
+Makes the next state of an entity.  Most keep moving the way they were,
+which is what the origin guess counts on, the rest change at random
+================
+*/
+static void Bench_MoveEntity(entity_state_t *s, const entity_state_t *base, int number, bool spawned) {
+  int i, step;
+
+  if(spawned) {
+    memset(s, 0, sizeof(*s));
+    s->number = number;
+    s->modelindex = 1 + Bench_Rand(255);
+    if(!Bench_Rand(4))
+      s->modelindex2 = Bench_Rand(256);
+    if(!Bench_Rand(8))
+      s->renderfx = RF_BEAM;
+    s->solid = Bench_Rand(65536);
+    for(i = 0; i < 3; i++) {
+      s->origin[i] = Bench_Coord(Bench_Rand(65536));
+      s->old_origin[i] = Bench_Coord(Bench_Rand(65536));
+      s->angles[i] = Bench_Angle(Bench_Rand(256));
+    }
+    return;
+  }
+
+  *s = *base;
+  s->event = 0;
+  if(!Bench_Rand(64))
+    s->renderfx ^= 1 << Bench_Rand(16);
+
+  for(i = 0; i < 3; i++) {
+    // keep the last step, the reader's old_origin is the origin before
+    step = MSG_PackCoord(base->origin[i]) - MSG_PackCoord(base->old_origin[i]);
+    if(s->renderfx & RF_BEAM || !Bench_Rand(16))
+      step = Bench_Rand(512) - 256;
+    else if(!Bench_Rand(4))
+      step += Bench_Rand(17) - 8;
+    s->origin[i] = Bench_Coord(MSG_PackCoord(base->origin[i]) + step);
+  }
+
+  // the writer's old_origin is what the client will hold, unless a beam
+  // sends its other end
+  if(s->renderfx & RF_BEAM) {
+    for(i = 0; i < 3; i++)
+      s->old_origin[i] = Bench_Coord(MSG_PackCoord(s->origin[i]) + Bench_Rand(1024) - 512);
+  } else
+    VectorCopy(base->origin, s->old_origin);
+
+  if(!Bench_Rand(3))
+    s->angles[YAW] = Bench_Angle(MSG_PackAngle(base->angles[YAW]) + Bench_Rand(33) - 16);
+  if(!Bench_Rand(16))
+    s->angles[PITCH] = Bench_Angle(Bench_Rand(256));
+  if(Bench_Rand(2))
+    s->frame = (base->frame + 1) % 200;
+  if(!Bench_Rand(32))
+    s->frame = Bench_Rand(65536) - 32768;
+  if(!Bench_Rand(64))
+    s->skinnum = Bench_Rand(2) ? Bench_Rand(256) : (int)(Bench_Rand(65536) * 65536u + Bench_Rand(65536));
+  if(!Bench_Rand(32))
+    s->effects = Bench_Rand(65536) << Bench_Rand(16);
+  if(!Bench_Rand(64))
+    s->modelindex3 = Bench_Rand(256);
+  if(!Bench_Rand(64))
+    s->modelindex4 = Bench_Rand(256);
+  if(!Bench_Rand(16))
+    s->sound = Bench_Rand(256);
+  if(!Bench_Rand(8))
+    s->event = 1 + Bench_Rand(255);
+  if(!Bench_Rand(128))
+    s->solid = Bench_Rand(65536);
+  if(!Bench_Rand(128))
+    s->cmodel_index = Bench_Rand(CMODEL_COUNT);
+}
+
+/*
+================
+Bench_MovePlayer
+================
+*/
+static void Bench_MovePlayer(player_state_t *ps) {
+  int i;
+
+  for(i = 0; i < 3; i++) {
+    if(!Bench_Rand(4))
+      ps->pmove.velocity[i] += Bench_Rand(201) - 100;
+    ps->pmove.origin[i] += ps->pmove.velocity[i] * BENCH_MSEC / 1000 + (Bench_Rand(8) ? 0 : Bench_Rand(33) - 16);
+  }
+  if(!Bench_Rand(16))
+    ps->pmove.pm_flags = Bench_Rand(256);
+  if(!Bench_Rand(16))
+    ps->pmove.pm_time = Bench_Rand(256);
+  if(!Bench_Rand(64))
+    ps->pmove.pm_type = Bench_Rand(5);
+  if(!Bench_Rand(64))
+    ps->pmove.gravity = Bench_Rand(2) ? 800 : Bench_Rand(2000);
+  if(!Bench_Rand(128))
+    for(i = 0; i < 3; i++)
+      ps->pmove.delta_angles[i] = Bench_Rand(65536) - 32768;
+
+  for(i = 0; i < 3; i++)
+    ps->viewangles[i] = SHORT2ANGLE((short)(ANGLE2SHORT(ps->viewangles[i]) + Bench_Rand(513) - 256));
+  if(!Bench_Rand(8))
+    ps->viewoffset[2] = Bench_Quarter(Bench_Rand(256));
+  if(!Bench_Rand(8))
+    for(i = 0; i < 3; i++)
+      ps->kick_angles[i] = Bench_Quarter(Bench_Rand(256));
+
+  if(!Bench_Rand(64))
+    ps->gunindex = Bench_Rand(256);
+  // the offsets only go out with a new gunframe, like the game sends them
+  if(Bench_Rand(2)) {
+    ps->gunframe = (ps->gunframe + 1 + Bench_Rand(255)) & 255;
+    for(i = 0; i < 3; i++) {
+      ps->gunoffset[i] = Bench_Quarter(Bench_Rand(256));
+      ps->gunangles[i] = Bench_Quarter(Bench_Rand(256));
+    }
+  }
+  if(!Bench_Rand(16))
+    for(i = 0; i < 4; i++)
+      ps->blend[i] = Bench_Rand(256) / 255.0;
+  if(!Bench_Rand(64))
+    ps->fov = Bench_Rand(256);
+  if(!Bench_Rand(64))
+    ps->rdflags = Bench_Rand(256);
+  if(!Bench_Rand(128))
+    ps->cmodel_index = Bench_Rand(CMODEL_COUNT);
+
+  for(i = 0; i < MAX_STATS; i++)
+    if(!Bench_Rand(32))
+      ps->stats[i] = Bench_Rand(2) ? ps->stats[i] + Bench_Rand(21) - 10 : Bench_Rand(65536) - 32768;
+}
+
+static bool Bench_EntitiesEqual(const entity_state_t *a, const entity_state_t *b) {
+  return a->number == b->number && VectorCompare((float *)a->origin, (float *)b->origin) &&
+         VectorCompare((float *)a->angles, (float *)b->angles) &&
+         VectorCompare((float *)a->old_origin, (float *)b->old_origin) && a->modelindex == b->modelindex &&
+         a->modelindex2 == b->modelindex2 && a->modelindex3 == b->modelindex3 && a->modelindex4 == b->modelindex4 &&
+         a->frame == b->frame && a->skinnum == b->skinnum && a->effects == b->effects && a->renderfx == b->renderfx &&
+         a->solid == b->solid && a->sound == b->sound && a->event == b->event && a->cmodel_index == b->cmodel_index;
+}
+
+static bool Bench_PlayersEqual(const player_state_t *a, const player_state_t *b) {
+  int i;
+
+  for(i = 0; i < 3; i++)
+    if(a->pmove.origin[i] != b->pmove.origin[i] || a->pmove.velocity[i] != b->pmove.velocity[i] ||
+       a->pmove.delta_angles[i] != b->pmove.delta_angles[i] || a->viewangles[i] != b->viewangles[i] ||
+       a->viewoffset[i] != b->viewoffset[i] || a->kick_angles[i] != b->kick_angles[i] ||
+       a->gunoffset[i] != b->gunoffset[i] || a->gunangles[i] != b->gunangles[i])
+      return false;
+  for(i = 0; i < 4; i++)
+    if(a->blend[i] != b->blend[i])
+      return false;
+  for(i = 0; i < MAX_STATS; i++)
+    if(a->stats[i] != b->stats[i])
+      return false;
+  return a->pmove.pm_type == b->pmove.pm_type && a->pmove.pm_flags == b->pmove.pm_flags &&
+         a->pmove.pm_time == b->pmove.pm_time && a->pmove.gravity == b->pmove.gravity && a->gunindex == b->gunindex &&
+         a->gunframe == b->gunframe && a->fov == b->fov && a->rdflags == b->rdflags &&
+         a->cmodel_index == b->cmodel_index;
+}
+
+/*
+================
+Bench_WriteFrame
+
+The entities and the player of one frame, the way SV_WriteFrameToClient
+writes them for each protocol
+================
+*/
+static void Bench_WriteFrame(sizebuf_t *msg, int protocol) {
+  entity_state_t nostate;
+  int e;
+
+  memset(&nostate, 0, sizeof(nostate));
+
+  if(protocol == PROTOCOL_VERSION)
+    MSG_WritePackedPlayerstate(&bench.ops, &bench.ps, msg, BENCH_MSEC);
+
+  for(e = 1; e <= BENCH_ENTITIES; e++) {
+    if(!bench.present[e])
+      continue;
+    if(protocol == PROTOCOL_VERSION)
+      MSG_WritePackedDeltaEntity(bench.client[e].number ? &bench.client[e] : &nostate, &bench.server[e], msg, false,
+                                 !bench.client[e].number);
+    else
+      MSG_WriteDeltaEntity(bench.client[e].number ? &bench.client[e] : &nostate, &bench.server[e], msg, false,
+                           !bench.client[e].number);
+  }
+
+  if(protocol == PROTOCOL_VERSION)
+    MSG_WritePackedEntityHeader(msg, 0, 0);
+  else
+    MSG_WriteShort(msg, 0);
+}
+
+/*
+================
+Bench_ReadFrame
+
+Reads a PROTOCOL_VERSION frame over bench.client the way
+CL_ParsePacketEntities and CL_ParseDelta do
+================
+*/
+static void Bench_ReadFrame(sizebuf_t *msg, entity_state_t *client, player_state_t *ps) {
+  entity_state_t nostate, base;
+  unsigned bits;
+  int number;
+
+  memset(&nostate, 0, sizeof(nostate));
+
+  MSG_BeginReading(msg);
+  MSG_ReadPackedPlayerstate(msg, ps, BENCH_MSEC);
+
+  for(;;) {
+    number = MSG_ReadPackedEntityBits(msg, &bits);
+    if(!number)
+      break;
+    if(number > BENCH_ENTITIES || msg->readcount > msg->cursize)
+      Com_Error(ERR_FATAL, "bad entity %i", number);
+
+    base = client[number].number ? client[number] : nostate;
+    client[number] = base;
+    VectorCopy(base.origin, client[number].old_origin);
+    client[number].number = number;
+    MSG_ReadPackedDeltaEntity(msg, &base, &client[number], bits);
+  }
+}
+
+int main(int argc, char **argv) {
+  static byte data[MAX_MSGLEN * 16];
+  static entity_state_t client[BENCH_ENTITIES + 1];
+  player_state_t ps;
+  sizebuf_t msg;
+  int frames, f, e, mismatches, protocol, pass;
+  int64_t bytes[2];
+  uint64_t start, time[2];
+
+  frames = argc > 1 ? atoi(argv[1]) : 20000;
+  if(frames < 1)
+    frames = 1;
+  bench_seed = argc > 2 ? atoi(argv[2]) : 1;
+
+  //
+  // round trip, every frame delta compressed from what was read
+  //
+  mismatches = 0;
+  bytes[0] = bytes[1] = 0;
+  time[0] = time[1] = 0;
+  for(f = 0; f < frames; f++) {
+    for(e = 1; e <= BENCH_ENTITIES; e++) {
+      if(bench.present[e] && !Bench_Rand(200)) {
+        bench.present[e] = false; // removed, the next one spawns fresh
+        memset(&bench.client[e], 0, sizeof(bench.client[e]));
+      } else if(!bench.present[e] && Bench_Rand(4)) {
+        bench.present[e] = true;
+        Bench_MoveEntity(&bench.server[e], NULL, e, true);
+      } else if(bench.present[e])
+        Bench_MoveEntity(&bench.server[e], &bench.client[e], e, false);
+    }
+    bench.ops = bench.ps;
+    Bench_MovePlayer(&bench.ps);
+
+    for(protocol = PROTOCOL_VERSION_OLD; protocol <= PROTOCOL_VERSION; protocol++) {
+      SZ_Init(&msg, data, sizeof(data));
+      Bench_WriteFrame(&msg, protocol);
+      bytes[protocol == PROTOCOL_VERSION] += msg.cursize;
+    }
+
+    memcpy(client, bench.client, sizeof(client));
+    ps = bench.ops;
+    Bench_ReadFrame(&msg, client, &ps);
+
+    for(e = 1; e <= BENCH_ENTITIES; e++)
+      if(bench.present[e] && !Bench_EntitiesEqual(&client[e], &bench.server[e])) {
+        if(mismatches < 10)
+          printf("frame %i: entity %i mismatch\n", f, e);
+        mismatches++;
+      }
+    if(!Bench_PlayersEqual(&ps, &bench.ps)) {
+      if(mismatches < 10)
+        printf("frame %i: playerstate mismatch\n", f);
+      mismatches++;
+    }
+
+    // carry on from what was read, like the server's copy of the frame
+    memcpy(bench.client, client, sizeof(client));
+    bench.ps = ps;
+  }
+
+  printf("%i frames of up to %i entities, %i mismatches\n", frames, BENCH_ENTITIES, mismatches);
+  printf("protocol  bytes/frame\n");
+  printf("%-9i %11.1f\n", PROTOCOL_VERSION_OLD, (double)bytes[0] / frames);
+  printf("%-9i %11.1f\n", PROTOCOL_VERSION, (double)bytes[1] / frames);
+
+  //
+  // timing, the last frame over and over, written then written and read
+  //
+  for(pass = 0; pass < 2; pass++) {
+    start = uv_hrtime();
+    for(f = 0; f < frames; f++) {
+      SZ_Init(&msg, data, sizeof(data));
+      Bench_WriteFrame(&msg, PROTOCOL_VERSION);
+      if(pass) {
+        memcpy(client, bench.client, sizeof(client));
+        ps = bench.ops;
+        Bench_ReadFrame(&msg, client, &ps);
+      }
+    }
+    time[pass] = uv_hrtime() - start;
+  }
+  printf("write %8.3f usec/frame\n", time[0] / 1e3 / frames);
+  printf("read  %8.3f usec/frame\n", (time[1] - time[0]) / 1e3 / frames);
+
+  return mismatches != 0;
+}
@@ -22,6 +22,11 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 #include <uv.h>
 
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
 // define this to dissalow any data but the demo pak file
 //#define	NO_ADDONS
 
@@ -55,12 +60,20 @@ typedef struct pack_s {
   uv_file handle;
   int numfiles;
   packfile_t *files;
+
+  // case insensitive name lookup, chains run in directory order
+  int hashsize; // power of two
+  int *hash;    // hashsize chain heads, then numfiles links
+
+  int64_t mtime, size; // of the pak file, to validate the pak index
+  unsigned checksum;
 } pack_t;
 
 char fs_gamedir[MAX_OSPATH];
 cvar_t *fs_basedir;
 cvar_t *fs_cddir;
 cvar_t *fs_gamedirvar;
+cvar_t *fs_pakindex;
 
 typedef struct filelink_s {
   struct filelink_s *next;
@@ -187,6 +200,248 @@ int Developer_searchpath(int who) {
   return (0);
 }
 
+/*
+=============================================================================
+
+PAK DIRECTORY LOOKUP
+
+=============================================================================
+*/
+
+/*
+=================
+FS_HashPack
+
+Builds the lookup chains, inserting back to front so the first match
+is the first entry in the directory, as with a linear scan
+=================
+*/
+static void FS_HashPack(pack_t *pack) {
+  int *next;
+  int i, h;
+
+  for(pack->hashsize = 16; pack->hashsize < pack->numfiles; pack->hashsize <<= 1)
+    ;
+  pack->hash = Z_Malloc((pack->hashsize + pack->numfiles) * sizeof(int));
+  next = pack->hash + pack->hashsize;
+
+  for(i = 0; i < pack->hashsize; i++)
+    pack->hash[i] = -1;
+  for(i = pack->numfiles - 1; i >= 0; i--) {
+    h = Com_HashKey(pack->files[i].name) & (pack->hashsize - 1);
+    next[i] = pack->hash[h];
+    pack->hash[h] = i;
+  }
+}
+
+/*
+=================
+FS_FindInPack
+
+Returns the index of the file in the pack directory, or -1
+=================
+*/
+static int FS_FindInPack(pack_t *pack, const char *filename) {
+  int *next;
+  int i;
+
+  next = pack->hash + pack->hashsize;
+  for(i = pack->hash[Com_HashKey(filename) & (pack->hashsize - 1)]; i >= 0; i = next[i])
+    if(!Q_strcasecmp(pack->files[i].name, filename))
+      return i;
+  return -1;
+}
+
+/*
+=============================================================================
+
+PAK INDEX
+
+The directories of every pak on the search path are kept in one file so
+a start up doesn't have to read and hash each of them again.  An entry
+is only used while the pak's modification time and size still match.
+
+=============================================================================
+*/
+
+#define PAKINDEX_IDENT (('X' << 24) + ('D' << 16) + ('I' << 8) + 'P')
+#define PAKINDEX_VERSION 1
+#define PAKINDEX_NAME "pakindex.dat"
+
+typedef struct {
+  int ident;
+  int version;
+  int numpaks;
+} dpakindexheader_t;
+
+typedef struct {
+  char filename[MAX_OSPATH];
+  int64_t mtime, size;
+  unsigned checksum;
+  int numfiles;
+  int hashsize;
+  // followed by numfiles packfile_t and hashsize + numfiles ints
+} dpakindexentry_t;
+
+static byte *fs_pakindexdata; // whole file, while the search path is built
+static int fs_pakindexlen;
+static bool fs_pakindexloaded;
+static bool fs_pakindexdirty; // a pak was read from disk
+
+static void FS_PakIndexPath(char *path, int size) {
+  Com_sprintf(path, size, "%s/" BASEDIRNAME "/" PAKINDEX_NAME, fs_basedir->string);
+}
+
+static int FS_PakIndexEntryLength(const dpakindexentry_t *entry) {
+  return sizeof(*entry) + entry->numfiles * sizeof(packfile_t) + (entry->hashsize + entry->numfiles) * sizeof(int);
+}
+
+static void FS_LoadPakIndex(void) {
+  char path[MAX_OSPATH];
+  FILE *f;
+  int len;
+
+  fs_pakindexloaded = true;
+  if(!fs_pakindex->value)
+    return;
+
+  FS_PakIndexPath(path, sizeof(path));
+  f = fopen(path, "rb");
+  if(!f)
+    return;
+
+  len = FS_filelength(f);
+  if(len >= (int)sizeof(dpakindexheader_t)) {
+    fs_pakindexdata = malloc(len);
+    if(fs_pakindexdata && fread(fs_pakindexdata, 1, len, f) == (size_t)len)
+      fs_pakindexlen = len;
+  }
+  fclose(f);
+}
+
+static void FS_FreePakIndex(void) {
+  free(fs_pakindexdata);
+  fs_pakindexdata = NULL;
+  fs_pakindexlen = 0;
+  fs_pakindexloaded = false;
+}
+
+/*
+=================
+FS_PackFromIndex
+
+Fills in the directory and lookup chains from the index if it has a
+current entry for the pak
+=================
+*/
+static bool FS_PackFromIndex(pack_t *pack) {
+  dpakindexheader_t *header;
+  dpakindexentry_t *entry;
+  byte *p, *end;
+  int i, j;
+
+  if(!fs_pakindexloaded)
+    FS_LoadPakIndex();
+  if(!fs_pakindexlen)
+    return false;
+
+  header = (dpakindexheader_t *)fs_pakindexdata;
+  if(header->ident != PAKINDEX_IDENT || header->version != PAKINDEX_VERSION)
+    return false;
+
+  p = fs_pakindexdata + sizeof(*header);
+  end = fs_pakindexdata + fs_pakindexlen;
+  for(i = 0; i < header->numpaks; i++) {
+    entry = (dpakindexentry_t *)p;
+    if(end - p < (int)sizeof(*entry) || entry->numfiles < 0 || entry->numfiles > MAX_FILES_IN_PACK ||
+       entry->hashsize < 16 || entry->hashsize & (entry->hashsize - 1) || entry->hashsize > 2 * MAX_FILES_IN_PACK ||
+       end - p < FS_PakIndexEntryLength(entry))
+      return false; // truncated or garbage
+    p += FS_PakIndexEntryLength(entry);
+
+    if(strncmp(entry->filename, pack->filename, sizeof(entry->filename)) || entry->mtime != pack->mtime ||
+       entry->size != pack->size)
+      continue;
+
+    pack->checksum = entry->checksum;
+    pack->numfiles = entry->numfiles;
+    pack->hashsize = entry->hashsize;
+    pack->files = Z_Malloc(pack->numfiles * sizeof(packfile_t));
+    pack->hash = Z_Malloc((pack->hashsize + pack->numfiles) * sizeof(int));
+    memcpy(pack->files, entry + 1, pack->numfiles * sizeof(packfile_t));
+    memcpy(pack->hash, (packfile_t *)(entry + 1) + pack->numfiles, (pack->hashsize + pack->numfiles) * sizeof(int));
+
+    for(j = 0; j < pack->numfiles; j++)
+      pack->files[j].name[MAX_QPATH - 1] = 0;
+    // chains only ever run forward through the directory
+    for(j = 0; j < pack->hashsize; j++)
+      if(pack->hash[j] >= pack->numfiles)
+        pack->hash[j] = -1;
+    for(j = 0; j < pack->numfiles; j++)
+      if(pack->hash[pack->hashsize + j] <= j || pack->hash[pack->hashsize + j] >= pack->numfiles)
+        pack->hash[pack->hashsize + j] = -1;
+
+    return true;
+  }
+
+  return false;
+}
+
+/*
+=================
+FS_WritePakIndex
+
+Called once the search path is complete
+=================
+*/
+static void FS_WritePakIndex(void) {
+  char path[MAX_OSPATH];
+  dpakindexheader_t header;
+  dpakindexentry_t entry;
+  searchpath_t *search;
+  pack_t *pack;
+  FILE *f;
+
+  if(!fs_pakindex->value || !fs_pakindexdirty) {
+    FS_FreePakIndex();
+    return;
+  }
+  fs_pakindexdirty = false;
+  FS_FreePakIndex();
+
+  FS_PakIndexPath(path, sizeof(path));
+  FS_CreatePath(path);
+  f = fopen(path, "wb");
+  if(!f)
+    return;
+
+  header.ident = PAKINDEX_IDENT;
+  header.version = PAKINDEX_VERSION;
+  header.numpaks = 0;
+  for(search = fs_searchpaths; search; search = search->next)
+    if(search->pack)
+      header.numpaks++;
+  fwrite(&header, sizeof(header), 1, f);
+
+  for(search = fs_searchpaths; search; search = search->next) {
+    pack = search->pack;
+    if(!pack)
+      continue;
+    memset(&entry, 0, sizeof(entry));
+    strcpy(entry.filename, pack->filename);
+    entry.mtime = pack->mtime;
+    entry.size = pack->size;
+    entry.checksum = pack->checksum;
+    entry.numfiles = pack->numfiles;
+    entry.hashsize = pack->hashsize;
+    fwrite(&entry, sizeof(entry), 1, f);
+    fwrite(pack->files, sizeof(packfile_t), pack->numfiles, f);
+    fwrite(pack->hash, sizeof(int), pack->hashsize + pack->numfiles, f);
+  }
+
+  fclose(f);
+}
+
 /*
 ===========
 FS_FOpenFile
@@ -229,17 +484,17 @@ int FS_FOpenFile(const char *filename, FILE **file) {
     if(search->pack) {
       // look through all the pak file elements
       pak = search->pack;
-      for(i = 0; i < pak->numfiles; i++)
-        if(!Q_strcasecmp(pak->files[i].name, filename)) { // found it!
-          file_from_pak = 1;
-          Com_DPrintf("PackFile: %s : %s\n", pak->filename, filename);
-          // open a new file on the pakfile
-          *file = fopen(pak->filename, "rb");
-          if(!*file)
-            Com_Error(ERR_FATAL, "Couldn't reopen %s", pak->filename);
-          fseek(*file, pak->files[i].filepos, SEEK_SET);
-          return pak->files[i].filelen;
-        }
+      i = FS_FindInPack(pak, filename);
+      if(i >= 0) { // found it!
+        file_from_pak = 1;
+        Com_DPrintf("PackFile: %s : %s\n", pak->filename, filename);
+        // open a new file on the pakfile
+        *file = fopen(pak->filename, "rb");
+        if(!*file)
+          Com_Error(ERR_FATAL, "Couldn't reopen %s", pak->filename);
+        fseek(*file, pak->files[i].filepos, SEEK_SET);
+        return pak->files[i].filelen;
+      }
     } else {
       // check a file in the directory tree
 
@@ -295,17 +550,17 @@ int FS_FOpenFile(char *filename, FILE **file) {
   }
 
   pak = search->pack;
-  for(i = 0; i < pak->numfiles; i++)
-    if(!Q_strcasecmp(pak->files[i].name, filename)) { // found it!
-      file_from_pak = 1;
-      Com_DPrintf("PackFile: %s : %s\n", pak->filename, filename);
-      // open a new file on the pakfile
-      *file = fopen(pak->filename, "rb");
-      if(!*file)
-        Com_Error(ERR_FATAL, "Couldn't reopen %s", pak->filename);
-      fseek(*file, pak->files[i].filepos, SEEK_SET);
-      return pak->files[i].filelen;
-    }
+  i = FS_FindInPack(pak, filename);
+  if(i >= 0) { // found it!
+    file_from_pak = 1;
+    Com_DPrintf("PackFile: %s : %s\n", pak->filename, filename);
+    // open a new file on the pakfile
+    *file = fopen(pak->filename, "rb");
+    if(!*file)
+      Com_Error(ERR_FATAL, "Couldn't reopen %s", pak->filename);
+    fseek(*file, pak->files[i].filepos, SEEK_SET);
+    return pak->files[i].filelen;
+  }
 
   Com_DPrintf("FindFile: can't find %s\n", filename);
 
@@ -407,52 +662,168 @@ FS_FreeFile
 void FS_FreeFile(void *buffer) { Z_Free(buffer); }
 
 /*
-=================
-FS_LoadPackFile
+=============================================================================
 
-Takes an explicit (not game tree related) path to a pak file.
+MAPPED FILES
 
-Loads the header and directory, adding the files at the beginning
-of the list so they override previous pack files.
+Read only views of whole files, shared by name.  Inside a pak only the
+pages covering the file are mapped.
+
+=============================================================================
+*/
+
+#define MAX_MAPPED_FILES 32
+
+typedef struct {
+  char name[MAX_QPATH];
+  int refcount;
+  void *base; // mapping or buffer that gets released
+  size_t maplen;
+  const byte *data;
+  int length;
+} mappedfile_t;
+
+static mappedfile_t fs_mappedfiles[MAX_MAPPED_FILES];
+
+/*
+============
+FS_MapFile
+
+Returns the file length and a read only view of it, or -1 and NULL if
+the file isn't found.  The view stays valid until the matching
+FS_UnmapFile, even across a gamedir change.
+============
+*/
+int FS_MapFile(const char *path, const void **data) {
+  static const byte empty[1];
+  mappedfile_t *mf, *freeslot;
+  FILE *h;
+  int i, len;
+#ifndef _WIN32
+  long offset, pagesize, aligned;
+#endif
+
+  *data = NULL;
+
+  freeslot = NULL;
+  for(i = 0, mf = fs_mappedfiles; i < MAX_MAPPED_FILES; i++, mf++) {
+    if(!mf->refcount) {
+      if(!freeslot)
+        freeslot = mf;
+      continue;
+    }
+    if(!Q_strcasecmp(mf->name, path)) {
+      mf->refcount++;
+      *data = mf->data;
+      return mf->length;
+    }
+  }
+  if(!freeslot)
+    Com_Error(ERR_FATAL, "FS_MapFile: more than %i files mapped", MAX_MAPPED_FILES);
+  if(strlen(path) >= MAX_QPATH)
+    return -1;
+
+  len = FS_FOpenFile(path, &h);
+  if(!h)
+    return -1;
+
+  mf = freeslot;
+  memset(mf, 0, sizeof(*mf));
+  strcpy(mf->name, path);
+  mf->length = len;
+
+  if(!len) {
+    mf->data = empty;
+  } else {
+#ifndef _WIN32
+    offset = ftell(h);
+    pagesize = sysconf(_SC_PAGESIZE);
+    aligned = offset & ~(pagesize - 1);
+    mf->maplen = len + (offset - aligned);
+    mf->base = mmap(NULL, mf->maplen, PROT_READ, MAP_PRIVATE, fileno(h), aligned);
+    if(mf->base == MAP_FAILED)
+      Com_Error(ERR_FATAL, "FS_MapFile: couldn't map %s", path);
+    mf->data = (byte *)mf->base + (offset - aligned);
+#else
+    mf->base = Z_Malloc(len);
+    FS_Read(mf->base, len, h);
+    mf->data = mf->base;
+#endif
+  }
+  fclose(h);
+
+  mf->refcount = 1;
+  *data = mf->data;
+  return len;
+}
+
+/*
+============
+FS_UnmapFile
+============
+*/
+void FS_UnmapFile(const void *data) {
+  mappedfile_t *mf;
+  int i;
+
+  for(i = 0, mf = fs_mappedfiles; i < MAX_MAPPED_FILES; i++, mf++) {
+    if(!mf->refcount || mf->data != data)
+      continue;
+    if(--mf->refcount)
+      return;
+#ifndef _WIN32
+    if(mf->base)
+      munmap(mf->base, mf->maplen);
+#else
+    if(mf->base)
+      Z_Free(mf->base);
+#endif
+    memset(mf, 0, sizeof(*mf));
+    return;
+  }
+
+  Com_Error(ERR_FATAL, "FS_UnmapFile: not a mapped file");
+}
+
+/*
+=================
+FS_ReadPackDirectory
+
+Loads the header and directory from the pak itself
 =================
 */
-pack_t *FS_LoadPackFile(char *packfile) {
+static bool FS_ReadPackDirectory(pack_t *pack) {
   dpackheader_t header;
   int i;
   packfile_t *newfiles;
   int numpackfiles;
-  pack_t *pack;
   FILE *packhandle;
   dpackfile_t info[MAX_FILES_IN_PACK];
-  unsigned checksum;
 
-  packhandle = fopen(packfile, "rb");
+  packhandle = fopen(pack->filename, "rb");
   if(!packhandle)
-    return NULL;
+    return false;
 
   fread(&header, 1, sizeof(header), packhandle);
   if(LittleLong(header.ident) != IDPAKHEADER)
-    Com_Error(ERR_FATAL, "%s is not a packfile", packfile);
+    Com_Error(ERR_FATAL, "%s is not a packfile", pack->filename);
   header.dirofs = LittleLong(header.dirofs);
   header.dirlen = LittleLong(header.dirlen);
 
   numpackfiles = header.dirlen / sizeof(dpackfile_t);
 
   if(numpackfiles > MAX_FILES_IN_PACK)
-    Com_Error(ERR_FATAL, "%s has %i files", packfile, numpackfiles);
+    Com_Error(ERR_FATAL, "%s has %i files", pack->filename, numpackfiles);
 
   newfiles = Z_Malloc(numpackfiles * sizeof(packfile_t));
 
   fseek(packhandle, header.dirofs, SEEK_SET);
   fread(info, 1, header.dirlen, packhandle);
+  fclose(packhandle);
 
   // crc the directory to check for modifications
-  checksum = Com_BlockChecksum((void *)info, header.dirlen);
+  pack->checksum = Com_BlockChecksum((void *)info, header.dirlen);
 
-#ifdef NO_ADDONS
-  if(checksum != PAK0_CHECKSUM)
-    return NULL;
-#endif
   // parse the directory
   for(i = 0; i < numpackfiles; i++) {
     strcpy(newfiles[i].name, info[i].name);
@@ -460,18 +831,62 @@ pack_t *FS_LoadPackFile(char *packfile) {
     newfiles[i].filelen = LittleLong(info[i].filelen);
   }
 
-  pack = Z_Malloc(sizeof(pack_t));
-  strcpy(pack->filename, packfile);
-  // pack->handle = packhandle;
   pack->numfiles = numpackfiles;
   pack->files = newfiles;
+  FS_HashPack(pack);
+
+  return true;
+}
+
+/*
+=================
+FS_LoadPackFile
+
+Takes an explicit (not game tree related) path to a pak file.
 
+Loads the header and directory, adding the files at the beginning
+of the list so they override previous pack files.
+=================
+*/
+pack_t *FS_LoadPackFile(char *packfile) {
+  pack_t *pack;
   uv_fs_t req;
+  uv_stat_t *st;
+
+  if(uv_fs_stat(global_uv_loop(), &req, packfile, NULL) < 0) {
+    uv_fs_req_cleanup(&req);
+    return NULL;
+  }
+  st = uv_fs_get_statbuf(&req);
+
+  pack = Z_Malloc(sizeof(pack_t));
+  strcpy(pack->filename, packfile);
+  pack->mtime = (int64_t)st->st_mtim.tv_sec * 1000000000 + st->st_mtim.tv_nsec;
+  pack->size = st->st_size;
+  uv_fs_req_cleanup(&req);
+
+  if(!FS_PackFromIndex(pack)) {
+    if(!FS_ReadPackDirectory(pack)) {
+      Z_Free(pack);
+      return NULL;
+    }
+    fs_pakindexdirty = true;
+  }
+
+#ifdef NO_ADDONS
+  if(pack->checksum != PAK0_CHECKSUM) {
+    Z_Free(pack->hash);
+    Z_Free(pack->files);
+    Z_Free(pack);
+    return NULL;
+  }
+#endif
+
   uv_fs_open(global_uv_loop(), &req, packfile, O_RDONLY, 0, NULL);
   pack->handle = uv_fs_get_result(&req);
   uv_fs_req_cleanup(&req);
 
-  Com_Printf("Added packfile %s (%i files)\n", packfile, numpackfiles);
+  Com_Printf("Added packfile %s (%i files)\n", packfile, pack->numfiles);
   return pack;
 }
 
@@ -567,6 +982,7 @@ void FS_SetGamedir(const char *dir) {
       uv_fs_close(global_uv_loop(), &req, fs_searchpaths->pack->handle, NULL);
       uv_fs_req_cleanup(&req);
 
+      Z_Free(fs_searchpaths->pack->hash);
       Z_Free(fs_searchpaths->pack->files);
       Z_Free(fs_searchpaths->pack);
     }
@@ -593,6 +1009,8 @@ void FS_SetGamedir(const char *dir) {
       FS_AddGameDirectory(va("%s/%s", fs_cddir->string, dir));
     FS_AddGameDirectory(va("%s/%s", fs_basedir->string, dir));
   }
+
+  FS_WritePakIndex();
 }
 
 /*
@@ -773,6 +1191,102 @@ const char *FS_NextPath(const char *prevpath) {
   return NULL;
 }
 
+static int FS_FindInPackLinear(pack_t *pack, const char *filename) {
+  int i;
+
+  for(i = 0; i < pack->numfiles; i++)
+    if(!Q_strcasecmp(pack->files[i].name, filename))
+      return i;
+  return -1;
+}
+
+/*
+================
+FS_Bench_f
+
+Looks every pak file name up through the whole search path, hashed and
+with the old linear scan, then reloads the pak directories from the paks
+and from the index
+================
+*/
+void FS_Bench_f(void) {
+  searchpath_t *search, *s;
+  pack_t *pack, temp;
+  uint64_t start, linear, hashed, disk, index;
+  int i, run, runs, lookups, found[2];
+
+  runs = Cmd_Argc() > 1 ? atoi(Cmd_Argv(1)) : 10;
+  if(runs < 1)
+    runs = 1;
+
+  linear = hashed = 0;
+  lookups = found[0] = found[1] = 0;
+  for(run = 0; run < runs; run++) {
+    for(search = fs_searchpaths; search; search = search->next) {
+      if(!(pack = search->pack))
+        continue;
+      for(i = 0; i < pack->numfiles; i++) {
+        start = uv_hrtime();
+        for(s = fs_searchpaths; s; s = s->next)
+          if(s->pack && FS_FindInPackLinear(s->pack, pack->files[i].name) >= 0) {
+            found[0]++;
+            break;
+          }
+        linear += uv_hrtime() - start;
+
+        start = uv_hrtime();
+        for(s = fs_searchpaths; s; s = s->next)
+          if(s->pack && FS_FindInPack(s->pack, pack->files[i].name) >= 0) {
+            found[1]++;
+            break;
+          }
+        hashed += uv_hrtime() - start;
+        lookups++;
+      }
+    }
+  }
+
+  if(!lookups) {
+    Com_Printf("No pak files on the search path\n");
+    return;
+  }
+  if(found[0] != found[1])
+    Com_Printf("WARNING: linear scan found %i, hash found %i\n", found[0], found[1]);
+
+  disk = index = 0;
+  for(run = 0; run < runs; run++) {
+    for(search = fs_searchpaths; search; search = search->next) {
+      if(!search->pack)
+        continue;
+      memset(&temp, 0, sizeof(temp));
+      strcpy(temp.filename, search->pack->filename);
+      temp.mtime = search->pack->mtime;
+      temp.size = search->pack->size;
+
+      start = uv_hrtime();
+      if(FS_ReadPackDirectory(&temp)) {
+        Z_Free(temp.hash);
+        Z_Free(temp.files);
+      }
+      disk += uv_hrtime() - start;
+
+      start = uv_hrtime();
+      if(FS_PackFromIndex(&temp)) {
+        Z_Free(temp.hash);
+        Z_Free(temp.files);
+      }
+      index += uv_hrtime() - start;
+    }
+    FS_FreePakIndex(); // reread it on every run
+  }
+
+  Com_Printf("%i lookups\n", lookups);
+  Com_Printf("linear scan: %8.3f ms, %6.3f usec per lookup\n", linear / 1e6, linear / 1e3 / lookups);
+  Com_Printf("hashed:      %8.3f ms, %6.3f usec per lookup\n", hashed / 1e6, hashed / 1e3 / lookups);
+  Com_Printf("directories from paks:  %8.3f ms per search path\n", disk / 1e6 / runs);
+  Com_Printf("directories from index: %8.3f ms per search path\n", index / 1e6 / runs);
+}
+
 /*
 ================
 FS_InitFilesystem
@@ -782,6 +1296,7 @@ void FS_InitFilesystem(void) {
   Cmd_AddCommand("path", FS_Path_f);
   Cmd_AddCommand("link", FS_Link_f);
   Cmd_AddCommand("dir", FS_Dir_f);
+  Cmd_AddCommand("fs_bench", FS_Bench_f);
 
   //
   // basedir <path>
@@ -795,6 +1310,12 @@ void FS_InitFilesystem(void) {
   // allows the game to run from outside the data tree
   //
   fs_cddir = Cvar_Get("cddir", "", CVAR_NOSET);
+
+  //
+  // pakindex <0|1>
+  // keep the pak directories in baseq2/pakindex.dat between runs
+  //
+  fs_pakindex = Cvar_Get("fs_pakindex", "1", CVAR_NOSET);
   if(fs_cddir->string[0])
     FS_AddGameDirectory(va("%s/" BASEDIRNAME, fs_cddir->string));
 
@@ -810,6 +1331,8 @@ void FS_InitFilesystem(void) {
   fs_gamedirvar = Cvar_Get("game", "", CVAR_LATCH | CVAR_SERVERINFO);
   if(fs_gamedirvar->string[0])
     FS_SetGamedir(fs_gamedirvar->string);
+  else
+    FS_WritePakIndex();
 }
 
 struct LoadAsyncState {
@@ -829,7 +1352,6 @@ struct LoadAsyncState {
   // iteration
   filelink_t *link;
   searchpath_t *search;
-  int pack_file_index;
 };
 
 void LoadAsync_continue(struct LoadAsyncState *state);
@@ -914,21 +1436,18 @@ void LoadAsync_continue(struct LoadAsyncState *state) {
     searchpath_t *search = state->search;
 
     if(search->pack) {
-      while(state->pack_file_index < search->pack->numfiles) {
-        packfile_t *pack_file = &search->pack->files[state->pack_file_index++];
-        if(!Q_strcasecmp(pack_file->name, (char *)state->path)) {
-          state->size = pack_file->filelen;
-          state->offset = pack_file->filepos;
-          state->buffer = Z_Malloc(state->size);
-
-          uv_fs_read(global_uv_loop(), &state->req, state->search->pack->handle,
-                     &(uv_buf_t){.base = state->buffer, .len = state->size}, 1, state->offset, LoadAsync_process_read);
-          return;
-        }
-      }
-
-      state->pack_file_index = 0;
+      int index = FS_FindInPack(search->pack, state->path);
       state->search = search->next;
+      if(index >= 0) {
+        packfile_t *pack_file = &search->pack->files[index];
+        state->size = pack_file->filelen;
+        state->offset = pack_file->filepos;
+        state->buffer = Z_Malloc(state->size);
+
+        uv_fs_read(global_uv_loop(), &state->req, search->pack->handle,
+                   &(uv_buf_t){.base = state->buffer, .len = state->size}, 1, state->offset, LoadAsync_process_read);
+        return;
+      }
       continue;
     } else {
       state->search = search->next;
@@ -0,0 +1,151 @@
+/*
+Copyright (C) 1997-2001 Id Software, Inc.
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+// jobs.c -- fork/join worker threads for data parallel loops
+
+#include "qcommon.h"
+
+#include <uv.h>
+
+#define MAX_JOB_THREADS 32
+
+typedef struct {
+  struct jobpool_s *pool;
+  int worker;
+  uv_thread_t thread;
+  uv_sem_t start;
+} jobthread_t;
+
+struct jobpool_s {
+  int numthreads;
+  jobthread_t threads[MAX_JOB_THREADS];
+  uv_sem_t done;
+
+  bool quit;
+  jobfunc_t func;
+  void *data;
+};
+
+static void Job_Thread(void *arg) {
+  jobthread_t *thread = arg;
+  jobpool_t *pool = thread->pool;
+
+  while(1) {
+    uv_sem_wait(&thread->start);
+    if(pool->quit)
+      break;
+    pool->func(pool->data, thread->worker, pool->numthreads + 1);
+    uv_sem_post(&pool->done);
+  }
+}
+
+/*
+================
+Job_CreatePool
+
+Starts numthreads worker threads.  The thread calling Job_Run always
+takes part as worker 0, so a pool of zero threads is valid and simply
+runs everything inline.
+================
+*/
+jobpool_t *Job_CreatePool(int numthreads) {
+  jobpool_t *pool;
+  int i;
+
+  if(numthreads < 0)
+    numthreads = 0;
+  if(numthreads > MAX_JOB_THREADS)
+    numthreads = MAX_JOB_THREADS;
+
+  pool = Z_Malloc(sizeof(*pool));
+  pool->numthreads = numthreads;
+  uv_sem_init(&pool->done, 0);
+
+  for(i = 0; i < numthreads; i++) {
+    pool->threads[i].pool = pool;
+    pool->threads[i].worker = i + 1;
+    uv_sem_init(&pool->threads[i].start, 0);
+    if(uv_thread_create(&pool->threads[i].thread, Job_Thread, &pool->threads[i]))
+      Com_Error(ERR_FATAL, "Job_CreatePool: couldn't create thread %i", i);
+  }
+
+  return pool;
+}
+
+/*
+================
+Job_DestroyPool
+================
+*/
+void Job_DestroyPool(jobpool_t *pool) {
+  int i;
+
+  if(!pool)
+    return;
+
+  pool->quit = true;
+  for(i = 0; i < pool->numthreads; i++)
+    uv_sem_post(&pool->threads[i].start);
+  for(i = 0; i < pool->numthreads; i++) {
+    uv_thread_join(&pool->threads[i].thread);
+    uv_sem_destroy(&pool->threads[i].start);
+  }
+  uv_sem_destroy(&pool->done);
+
+  Z_Free(pool);
+}
+
+/*
+================
+Job_PoolWorkers
+
+Number of workers that will call the function passed to Job_Run,
+including the calling thread
+================
+*/
+int Job_PoolWorkers(jobpool_t *pool) { return pool ? pool->numthreads + 1 : 1; }
+
+/*
+================
+Job_Run
+
+Calls func once on every worker and returns when all of them are done.
+func must not touch the zone, cvars or anything else that is not
+explicitly safe to share, and must not Com_Error.
+================
+*/
+void Job_Run(jobpool_t *pool, jobfunc_t func, void *data) {
+  int i;
+
+  if(!pool || !pool->numthreads) {
+    func(data, 0, 1);
+    return;
+  }
+
+  pool->func = func;
+  pool->data = data;
+
+  for(i = 0; i < pool->numthreads; i++)
+    uv_sem_post(&pool->threads[i].start);
+
+  func(data, 0, pool->numthreads + 1);
+
+  for(i = 0; i < pool->numthreads; i++)
+    uv_sem_wait(&pool->done);
+}
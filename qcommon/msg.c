@@ -0,0 +1,1665 @@
+/*
+Copyright (C) 1997-2001 Id Software, Inc.
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+// msg.c -- message io, the sizebufs and the entity and playerstate deltas
+#include "qcommon.h"
+
+/*
+==============================================================================
+
+      MESSAGE IO FUNCTIONS
+
+Handles byte ordering and avoids alignment errors
+==============================================================================
+*/
+
+vec3_t bytedirs[NUMVERTEXNORMALS] = {
+#include "../client/anorms.h"
+};
+
+//
+// writing functions
+//
+
+void MSG_WriteChar(sizebuf_t *sb, int c) {
+  byte *buf;
+
+#ifdef PARANOID
+  if(c < -128 || c > 127)
+    Com_Error(ERR_FATAL, "MSG_WriteChar: range error");
+#endif
+
+  buf = SZ_GetSpace(sb, 1);
+  buf[0] = c;
+}
+
+void MSG_WriteByte(sizebuf_t *sb, int c) {
+  byte *buf;
+
+#ifdef PARANOID
+  if(c < 0 || c > 255)
+    Com_Error(ERR_FATAL, "MSG_WriteByte: range error");
+#endif
+
+  buf = SZ_GetSpace(sb, 1);
+  buf[0] = c;
+}
+
+void MSG_WriteShort(sizebuf_t *sb, int c) {
+  byte *buf;
+
+#ifdef PARANOID
+  if(c < ((short)0x8000) || c > (short)0x7fff)
+    Com_Error(ERR_FATAL, "MSG_WriteShort: range error");
+#endif
+
+  buf = SZ_GetSpace(sb, 2);
+  buf[0] = c & 0xff;
+  buf[1] = c >> 8;
+}
+
+void MSG_WriteLong(sizebuf_t *sb, int c) {
+  byte *buf;
+
+  buf = SZ_GetSpace(sb, 4);
+  buf[0] = c & 0xff;
+  buf[1] = (c >> 8) & 0xff;
+  buf[2] = (c >> 16) & 0xff;
+  buf[3] = c >> 24;
+}
+
+void MSG_WriteFloat(sizebuf_t *sb, float f) {
+  union {
+    float f;
+    int l;
+  } dat;
+
+  dat.f = f;
+  dat.l = LittleLong(dat.l);
+
+  SZ_Write(sb, &dat.l, 4);
+}
+
+void MSG_WriteString(sizebuf_t *sb, char *s) {
+  if(!s)
+    SZ_Write(sb, "", 1);
+  else
+    SZ_Write(sb, s, strlen(s) + 1);
+}
+
+void MSG_WriteCoord(sizebuf_t *sb, float f) { MSG_WriteShort(sb, (int)(f * 8)); }
+
+void MSG_WritePos(sizebuf_t *sb, vec3_t pos) {
+  MSG_WriteShort(sb, (int)(pos[0] * 8));
+  MSG_WriteShort(sb, (int)(pos[1] * 8));
+  MSG_WriteShort(sb, (int)(pos[2] * 8));
+}
+
+void MSG_WriteAngle(sizebuf_t *sb, float f) { MSG_WriteByte(sb, (int)(f * 256 / 360) & 255); }
+
+void MSG_WriteAngle16(sizebuf_t *sb, float f) { MSG_WriteShort(sb, ANGLE2SHORT(f)); }
+
+void MSG_WriteDeltaUsercmd(sizebuf_t *buf, usercmd_t *from, usercmd_t *cmd) {
+  int bits;
+
+  //
+  // send the movement message
+  //
+  bits = 0;
+  if(cmd->angles[0] != from->angles[0])
+    bits |= CM_ANGLE1;
+  if(cmd->angles[1] != from->angles[1])
+    bits |= CM_ANGLE2;
+  if(cmd->angles[2] != from->angles[2])
+    bits |= CM_ANGLE3;
+  if(cmd->forwardmove != from->forwardmove)
+    bits |= CM_FORWARD;
+  if(cmd->sidemove != from->sidemove)
+    bits |= CM_SIDE;
+  if(cmd->upmove != from->upmove)
+    bits |= CM_UP;
+  if(cmd->buttons != from->buttons)
+    bits |= CM_BUTTONS;
+  if(cmd->impulse != from->impulse)
+    bits |= CM_IMPULSE;
+
+  MSG_WriteByte(buf, bits);
+
+  if(bits & CM_ANGLE1)
+    MSG_WriteShort(buf, cmd->angles[0]);
+  if(bits & CM_ANGLE2)
+    MSG_WriteShort(buf, cmd->angles[1]);
+  if(bits & CM_ANGLE3)
+    MSG_WriteShort(buf, cmd->angles[2]);
+
+  if(bits & CM_FORWARD)
+    MSG_WriteShort(buf, cmd->forwardmove);
+  if(bits & CM_SIDE)
+    MSG_WriteShort(buf, cmd->sidemove);
+  if(bits & CM_UP)
+    MSG_WriteShort(buf, cmd->upmove);
+
+  if(bits & CM_BUTTONS)
+    MSG_WriteByte(buf, cmd->buttons);
+  if(bits & CM_IMPULSE)
+    MSG_WriteByte(buf, cmd->impulse);
+
+  MSG_WriteByte(buf, cmd->msec);
+  MSG_WriteByte(buf, cmd->lightlevel);
+}
+
+void MSG_WriteDir(sizebuf_t *sb, vec3_t dir) {
+  int i, best;
+  float d, bestd;
+
+  if(!dir) {
+    MSG_WriteByte(sb, 0);
+    return;
+  }
+
+  bestd = 0;
+  best = 0;
+  for(i = 0; i < NUMVERTEXNORMALS; i++) {
+    d = DotProduct(dir, bytedirs[i]);
+    if(d > bestd) {
+      bestd = d;
+      best = i;
+    }
+  }
+  MSG_WriteByte(sb, best);
+}
+
+void MSG_ReadDir(sizebuf_t *sb, vec3_t dir) {
+  int b;
+
+  b = MSG_ReadByte(sb);
+  if(b >= NUMVERTEXNORMALS)
+    Com_Error(ERR_DROP, "MSF_ReadDir: out of range");
+  VectorCopy(bytedirs[b], dir);
+}
+
+/*
+==================
+MSG_WriteDeltaEntity
+
+Writes part of a packetentities message.
+Can delta from either a baseline or a previous packet_entity
+==================
+*/
+void MSG_WriteDeltaEntity(entity_state_t *from, entity_state_t *to, sizebuf_t *msg, bool force, bool newentity) {
+  int bits;
+
+  if(!to->number)
+    Com_Error(ERR_FATAL, "Unset entity number");
+  if(to->number >= MAX_EDICTS)
+    Com_Error(ERR_FATAL, "Entity number >= MAX_EDICTS");
+
+  // send an update
+  bits = 0;
+
+  if(to->number >= 256)
+    bits |= U_NUMBER16; // number8 is implicit otherwise
+
+  if(to->origin[0] != from->origin[0])
+    bits |= U_ORIGIN1;
+  if(to->origin[1] != from->origin[1])
+    bits |= U_ORIGIN2;
+  if(to->origin[2] != from->origin[2])
+    bits |= U_ORIGIN3;
+
+  if(to->angles[0] != from->angles[0])
+    bits |= U_ANGLE1;
+  if(to->angles[1] != from->angles[1])
+    bits |= U_ANGLE2;
+  if(to->angles[2] != from->angles[2])
+    bits |= U_ANGLE3;
+
+  if(to->skinnum != from->skinnum) {
+    if((unsigned)to->skinnum < 256)
+      bits |= U_SKIN8;
+    else if((unsigned)to->skinnum < 0x10000)
+      bits |= U_SKIN16;
+    else
+      bits |= (U_SKIN8 | U_SKIN16);
+  }
+
+  if(to->frame != from->frame) {
+    if(to->frame < 256)
+      bits |= U_FRAME8;
+    else
+      bits |= U_FRAME16;
+  }
+
+  if(to->effects != from->effects) {
+    if(to->effects < 256)
+      bits |= U_EFFECTS8;
+    else if(to->effects < 0x8000)
+      bits |= U_EFFECTS16;
+    else
+      bits |= U_EFFECTS8 | U_EFFECTS16;
+  }
+
+  if(to->renderfx != from->renderfx) {
+    if(to->renderfx < 256)
+      bits |= U_RENDERFX8;
+    else if(to->renderfx < 0x8000)
+      bits |= U_RENDERFX16;
+    else
+      bits |= U_RENDERFX8 | U_RENDERFX16;
+  }
+
+  if(to->cmodel_index != from->cmodel_index) {
+    bits |= U_CMODEL_INDEX;
+  }
+
+  if(to->solid != from->solid)
+    bits |= U_SOLID;
+
+  // event is not delta compressed, just 0 compressed
+  if(to->event)
+    bits |= U_EVENT;
+
+  if(to->modelindex != from->modelindex)
+    bits |= U_MODEL;
+  if(to->modelindex2 != from->modelindex2)
+    bits |= U_MODEL2;
+  if(to->modelindex3 != from->modelindex3)
+    bits |= U_MODEL3;
+  if(to->modelindex4 != from->modelindex4)
+    bits |= U_MODEL4;
+
+  if(to->sound != from->sound)
+    bits |= U_SOUND;
+
+  if(newentity || (to->renderfx & RF_BEAM))
+    bits |= U_OLDORIGIN;
+
+  //
+  // write the message
+  //
+  if(!bits && !force)
+    return; // nothing to send!
+
+  //----------
+
+  if(bits & 0xff000000)
+    bits |= U_MOREBITS3 | U_MOREBITS2 | U_MOREBITS1;
+  else if(bits & 0x00ff0000)
+    bits |= U_MOREBITS2 | U_MOREBITS1;
+  else if(bits & 0x0000ff00)
+    bits |= U_MOREBITS1;
+
+  MSG_WriteByte(msg, bits & 255);
+
+  if(bits & 0xff000000) {
+    MSG_WriteByte(msg, (bits >> 8) & 255);
+    MSG_WriteByte(msg, (bits >> 16) & 255);
+    MSG_WriteByte(msg, (bits >> 24) & 255);
+  } else if(bits & 0x00ff0000) {
+    MSG_WriteByte(msg, (bits >> 8) & 255);
+    MSG_WriteByte(msg, (bits >> 16) & 255);
+  } else if(bits & 0x0000ff00) {
+    MSG_WriteByte(msg, (bits >> 8) & 255);
+  }
+
+  //----------
+
+  if(bits & U_NUMBER16)
+    MSG_WriteShort(msg, to->number);
+  else
+    MSG_WriteByte(msg, to->number);
+
+  if(bits & U_MODEL)
+    MSG_WriteByte(msg, to->modelindex);
+  if(bits & U_MODEL2)
+    MSG_WriteByte(msg, to->modelindex2);
+  if(bits & U_MODEL3)
+    MSG_WriteByte(msg, to->modelindex3);
+  if(bits & U_MODEL4)
+    MSG_WriteByte(msg, to->modelindex4);
+
+  if(bits & U_FRAME8)
+    MSG_WriteByte(msg, to->frame);
+  if(bits & U_FRAME16)
+    MSG_WriteShort(msg, to->frame);
+
+  if((bits & U_SKIN8) && (bits & U_SKIN16)) // used for laser colors
+    MSG_WriteLong(msg, to->skinnum);
+  else if(bits & U_SKIN8)
+    MSG_WriteByte(msg, to->skinnum);
+  else if(bits & U_SKIN16)
+    MSG_WriteShort(msg, to->skinnum);
+
+  if((bits & (U_EFFECTS8 | U_EFFECTS16)) == (U_EFFECTS8 | U_EFFECTS16))
+    MSG_WriteLong(msg, to->effects);
+  else if(bits & U_EFFECTS8)
+    MSG_WriteByte(msg, to->effects);
+  else if(bits & U_EFFECTS16)
+    MSG_WriteShort(msg, to->effects);
+
+  if((bits & (U_RENDERFX8 | U_RENDERFX16)) == (U_RENDERFX8 | U_RENDERFX16))
+    MSG_WriteLong(msg, to->renderfx);
+  else if(bits & U_RENDERFX8)
+    MSG_WriteByte(msg, to->renderfx);
+  else if(bits & U_RENDERFX16)
+    MSG_WriteShort(msg, to->renderfx);
+
+  if(bits & U_ORIGIN1)
+    MSG_WriteCoord(msg, to->origin[0]);
+  if(bits & U_ORIGIN2)
+    MSG_WriteCoord(msg, to->origin[1]);
+  if(bits & U_ORIGIN3)
+    MSG_WriteCoord(msg, to->origin[2]);
+
+  if(bits & U_ANGLE1)
+    MSG_WriteAngle(msg, to->angles[0]);
+  if(bits & U_ANGLE2)
+    MSG_WriteAngle(msg, to->angles[1]);
+  if(bits & U_ANGLE3)
+    MSG_WriteAngle(msg, to->angles[2]);
+
+  if(bits & U_OLDORIGIN) {
+    MSG_WriteCoord(msg, to->old_origin[0]);
+    MSG_WriteCoord(msg, to->old_origin[1]);
+    MSG_WriteCoord(msg, to->old_origin[2]);
+  }
+
+  if(bits & U_SOUND)
+    MSG_WriteByte(msg, to->sound);
+  if(bits & U_EVENT)
+    MSG_WriteByte(msg, to->event);
+  if(bits & U_SOLID)
+    MSG_WriteShort(msg, to->solid);
+
+  if(bits & U_CMODEL_INDEX)
+    MSG_WriteByte(msg, to->cmodel_index);
+}
+
+/*
+==================
+MSG_WriteDeltaPlayerstate
+
+The protocol 34 playerstate that follows svc_playerinfo.  from is NULL
+when there is no frame to delta from
+==================
+*/
+void MSG_WriteDeltaPlayerstate(player_state_t *from, player_state_t *to, sizebuf_t *msg) {
+  int i;
+  int pflags;
+  player_state_t *ps, *ops;
+  player_state_t dummy;
+  int statbits;
+
+  ps = to;
+  if(!from) {
+    memset(&dummy, 0, sizeof(dummy));
+    ops = &dummy;
+  } else
+    ops = from;
+
+  //
+  // determine what needs to be sent
+  //
+  pflags = 0;
+
+  if(ps->pmove.pm_type != ops->pmove.pm_type)
+    pflags |= PS_M_TYPE;
+
+  if(ps->pmove.origin[0] != ops->pmove.origin[0] || ps->pmove.origin[1] != ops->pmove.origin[1] ||
+     ps->pmove.origin[2] != ops->pmove.origin[2])
+    pflags |= PS_M_ORIGIN;
+
+  if(ps->pmove.velocity[0] != ops->pmove.velocity[0] || ps->pmove.velocity[1] != ops->pmove.velocity[1] ||
+     ps->pmove.velocity[2] != ops->pmove.velocity[2])
+    pflags |= PS_M_VELOCITY;
+
+  if(ps->pmove.pm_time != ops->pmove.pm_time)
+    pflags |= PS_M_TIME;
+
+  if(ps->pmove.pm_flags != ops->pmove.pm_flags)
+    pflags |= PS_M_FLAGS;
+
+  if(ps->pmove.gravity != ops->pmove.gravity)
+    pflags |= PS_M_GRAVITY;
+
+  if(ps->pmove.delta_angles[0] != ops->pmove.delta_angles[0] ||
+     ps->pmove.delta_angles[1] != ops->pmove.delta_angles[1] || ps->pmove.delta_angles[2] != ops->pmove.delta_angles[2])
+    pflags |= PS_M_DELTA_ANGLES;
+
+  if(ps->viewoffset[0] != ops->viewoffset[0] || ps->viewoffset[1] != ops->viewoffset[1] ||
+     ps->viewoffset[2] != ops->viewoffset[2])
+    pflags |= PS_VIEWOFFSET;
+
+  if(ps->viewangles[0] != ops->viewangles[0] || ps->viewangles[1] != ops->viewangles[1] ||
+     ps->viewangles[2] != ops->viewangles[2])
+    pflags |= PS_VIEWANGLES;
+
+  if(ps->kick_angles[0] != ops->kick_angles[0] || ps->kick_angles[1] != ops->kick_angles[1] ||
+     ps->kick_angles[2] != ops->kick_angles[2])
+    pflags |= PS_KICKANGLES;
+
+  if(ps->blend[0] != ops->blend[0] || ps->blend[1] != ops->blend[1] || ps->blend[2] != ops->blend[2] ||
+     ps->blend[3] != ops->blend[3])
+    pflags |= PS_BLEND;
+
+  if(ps->fov != ops->fov)
+    pflags |= PS_FOV;
+
+  if(ps->rdflags != ops->rdflags)
+    pflags |= PS_RDFLAGS;
+
+  if(ps->gunframe != ops->gunframe)
+    pflags |= PS_WEAPONFRAME;
+
+  if(ps->cmodel_index != ops->cmodel_index)
+    pflags |= PS_CMODEL_INDEX;
+
+  pflags |= PS_WEAPONINDEX;
+
+  //
+  // write it
+  //
+  MSG_WriteShort(msg, pflags);
+
+  //
+  // write the pmove_state_t
+  //
+  if(pflags & PS_M_TYPE)
+    MSG_WriteByte(msg, ps->pmove.pm_type);
+
+  if(pflags & PS_M_ORIGIN) {
+    MSG_WriteShort(msg, ps->pmove.origin[0]);
+    MSG_WriteShort(msg, ps->pmove.origin[1]);
+    MSG_WriteShort(msg, ps->pmove.origin[2]);
+  }
+
+  if(pflags & PS_M_VELOCITY) {
+    MSG_WriteShort(msg, ps->pmove.velocity[0]);
+    MSG_WriteShort(msg, ps->pmove.velocity[1]);
+    MSG_WriteShort(msg, ps->pmove.velocity[2]);
+  }
+
+  if(pflags & PS_M_TIME)
+    MSG_WriteByte(msg, ps->pmove.pm_time);
+
+  if(pflags & PS_M_FLAGS)
+    MSG_WriteByte(msg, ps->pmove.pm_flags);
+
+  if(pflags & PS_M_GRAVITY)
+    MSG_WriteShort(msg, ps->pmove.gravity);
+
+  if(pflags & PS_M_DELTA_ANGLES) {
+    MSG_WriteShort(msg, ps->pmove.delta_angles[0]);
+    MSG_WriteShort(msg, ps->pmove.delta_angles[1]);
+    MSG_WriteShort(msg, ps->pmove.delta_angles[2]);
+  }
+
+  //
+  // write the rest of the player_state_t
+  //
+  if(pflags & PS_VIEWOFFSET) {
+    MSG_WriteChar(msg, ps->viewoffset[0] * 4);
+    MSG_WriteChar(msg, ps->viewoffset[1] * 4);
+    MSG_WriteChar(msg, ps->viewoffset[2] * 4);
+  }
+
+  if(pflags & PS_VIEWANGLES) {
+    MSG_WriteAngle16(msg, ps->viewangles[0]);
+    MSG_WriteAngle16(msg, ps->viewangles[1]);
+    MSG_WriteAngle16(msg, ps->viewangles[2]);
+  }
+
+  if(pflags & PS_KICKANGLES) {
+    MSG_WriteChar(msg, ps->kick_angles[0] * 4);
+    MSG_WriteChar(msg, ps->kick_angles[1] * 4);
+    MSG_WriteChar(msg, ps->kick_angles[2] * 4);
+  }
+
+  if(pflags & PS_WEAPONINDEX) {
+    MSG_WriteByte(msg, ps->gunindex);
+  }
+
+  if(pflags & PS_WEAPONFRAME) {
+    MSG_WriteByte(msg, ps->gunframe);
+    MSG_WriteChar(msg, ps->gunoffset[0] * 4);
+    MSG_WriteChar(msg, ps->gunoffset[1] * 4);
+    MSG_WriteChar(msg, ps->gunoffset[2] * 4);
+    MSG_WriteChar(msg, ps->gunangles[0] * 4);
+    MSG_WriteChar(msg, ps->gunangles[1] * 4);
+    MSG_WriteChar(msg, ps->gunangles[2] * 4);
+  }
+
+  if(pflags & PS_BLEND) {
+    MSG_WriteByte(msg, ps->blend[0] * 255);
+    MSG_WriteByte(msg, ps->blend[1] * 255);
+    MSG_WriteByte(msg, ps->blend[2] * 255);
+    MSG_WriteByte(msg, ps->blend[3] * 255);
+  }
+  if(pflags & PS_FOV)
+    MSG_WriteByte(msg, ps->fov);
+  if(pflags & PS_RDFLAGS)
+    MSG_WriteByte(msg, ps->rdflags);
+  if(pflags & PS_CMODEL_INDEX)
+    MSG_WriteByte(msg, ps->cmodel_index);
+
+  // send stats
+  statbits = 0;
+  for(i = 0; i < MAX_STATS; i++)
+    if(ps->stats[i] != ops->stats[i])
+      statbits |= 1 << i;
+  MSG_WriteLong(msg, statbits);
+  for(i = 0; i < MAX_STATS; i++)
+    if(statbits & (1 << i))
+      MSG_WriteShort(msg, ps->stats[i]);
+}
+
+/*
+==============================================================================
+
+BIT PACKED DELTAS
+
+The PROTOCOL_VERSION entity and playerstate encoding.  Fields are packed
+least significant bit first, sized to the value instead of the type, and
+positions are sent as the error from a guess both ends make from the
+delta base.  Anything the guess reads has to be what the client holds
+for the base, so it works on the quantized values only.
+
+==============================================================================
+*/
+
+#define PREDICT_MAXSTEP (256 * 8) // larger steps are teleports, not motion
+
+int MSG_PackCoord(float f) { return (short)(int)(f * 8); }
+
+int MSG_PackAngle(float f) { return (int)(f * 256 / 360) & 255; }
+
+/*
+==================
+MSG_PredictEntityOrigin
+
+Carries on the last step, old_origin is the origin of the state the
+base was itself delta'd from
+==================
+*/
+void MSG_PredictEntityOrigin(const entity_state_t *from, int *origin) {
+  int i, step;
+
+  for(i = 0; i < 3; i++) {
+    origin[i] = MSG_PackCoord(from->origin[i]);
+    step = origin[i] - MSG_PackCoord(from->old_origin[i]);
+
+    // beams keep their other end in old_origin
+    if(!(from->renderfx & RF_BEAM) && step > -PREDICT_MAXSTEP && step < PREDICT_MAXSTEP)
+      origin[i] += step;
+  }
+}
+
+void MSG_PredictPmoveOrigin(const pmove_state_t *from, int msec, int *origin) {
+  int i;
+
+  for(i = 0; i < 3; i++)
+    origin[i] = from->origin[i] + from->velocity[i] * msec / 1000;
+}
+
+void MSG_WriteBits(sizebuf_t *sb, unsigned value, int bits) {
+  int put;
+
+  // carry on in the last byte if the previous write left room in it
+  if(sb->bitcursize <= (sb->cursize - 1) * 8 || sb->bitcursize >= sb->cursize * 8)
+    sb->bitcursize = sb->cursize * 8;
+
+  for(; bits > 0; bits -= put) {
+    if(sb->bitcursize == sb->cursize * 8) {
+      *(byte *)SZ_GetSpace(sb, 1) = 0;
+      sb->bitcursize = (sb->cursize - 1) * 8;
+    }
+
+    put = 8 - (sb->bitcursize & 7);
+    if(put > bits)
+      put = bits;
+    sb->data[sb->bitcursize >> 3] |= (value & ((1 << put) - 1)) << (sb->bitcursize & 7);
+    sb->bitcursize += put;
+    value >>= put;
+  }
+}
+
+void MSG_WriteVarBits(sizebuf_t *sb, unsigned value) {
+  if(value < 0x10) {
+    MSG_WriteBits(sb, 0, 2);
+    MSG_WriteBits(sb, value, 4);
+  } else if(value < 0x100) {
+    MSG_WriteBits(sb, 1, 2);
+    MSG_WriteBits(sb, value, 8);
+  } else if(value < 0x10000) {
+    MSG_WriteBits(sb, 2, 2);
+    MSG_WriteBits(sb, value, 16);
+  } else {
+    MSG_WriteBits(sb, 3, 2);
+    MSG_WriteBits(sb, value, 32);
+  }
+}
+
+void MSG_WriteSignedVarBits(sizebuf_t *sb, int value) {
+  MSG_WriteVarBits(sb, ((unsigned)value << 1) ^ (value < 0 ? ~0u : 0));
+}
+
+void MSG_WriteAlign(sizebuf_t *sb) { sb->bitcursize = sb->cursize * 8; }
+
+/*
+==================
+MSG_WritePackedEntityHeader
+
+Starts an entity on a new byte.  A zero number ends the packet entities
+and a number with EB_REMOVE drops that entity
+==================
+*/
+void MSG_WritePackedEntityHeader(sizebuf_t *sb, int number, unsigned bits) {
+  MSG_WriteAlign(sb);
+
+  MSG_WriteBits(sb, number >= 256, 1);
+  MSG_WriteBits(sb, number, number >= 256 ? 10 : 8);
+  if(!number)
+    return;
+
+  MSG_WriteBits(sb, (bits & EB_REMOVE) != 0, 1);
+  if(bits & EB_REMOVE)
+    return;
+
+  MSG_WriteBits(sb, (bits & EB_ORIGIN) != 0, 1);
+  if(bits & EB_ORIGIN)
+    MSG_WriteBits(sb, bits & EB_ORIGIN, 3);
+  MSG_WriteBits(sb, (bits & EB_ANGLES) != 0, 1);
+  if(bits & EB_ANGLES)
+    MSG_WriteBits(sb, (bits & EB_ANGLES) >> 3, 3);
+  MSG_WriteBits(sb, (bits & EB_FRAME) != 0, 1);
+  MSG_WriteBits(sb, (bits & EB_EVENT) != 0, 1);
+  MSG_WriteBits(sb, (bits & EB_MORE) != 0, 1);
+  if(bits & EB_MORE)
+    MSG_WriteBits(sb, (bits & EB_MORE) >> 9, EB_MOREBITS);
+}
+
+/*
+==================
+MSG_WritePackedDeltaEntity
+
+MSG_WriteDeltaEntity for PROTOCOL_VERSION.  An origin that is not sent
+stays at the base, so an entity that did not change writes nothing
+==================
+*/
+void MSG_WritePackedDeltaEntity(entity_state_t *from, entity_state_t *to, sizebuf_t *msg, bool force,
+                                bool newentity) {
+  int origin[3], predicted[3], angles[3];
+  unsigned bits;
+  int i;
+
+  if(!to->number)
+    Com_Error(ERR_FATAL, "Unset entity number");
+  if(to->number >= MAX_EDICTS)
+    Com_Error(ERR_FATAL, "Entity number >= MAX_EDICTS");
+
+  bits = 0;
+
+  MSG_PredictEntityOrigin(from, predicted);
+  for(i = 0; i < 3; i++) {
+    origin[i] = MSG_PackCoord(to->origin[i]);
+    if(origin[i] != MSG_PackCoord(from->origin[i]))
+      bits |= EB_ORIGIN1 << i;
+
+    angles[i] = MSG_PackAngle(to->angles[i]);
+    if(angles[i] != MSG_PackAngle(from->angles[i]))
+      bits |= EB_ANGLE1 << i;
+  }
+
+  if(to->frame != from->frame)
+    bits |= EB_FRAME;
+  if(to->skinnum != from->skinnum)
+    bits |= EB_SKIN;
+  if(to->effects != from->effects)
+    bits |= EB_EFFECTS;
+  if(to->renderfx != from->renderfx)
+    bits |= EB_RENDERFX;
+  if(to->cmodel_index != from->cmodel_index)
+    bits |= EB_CMODEL_INDEX;
+  if(to->solid != from->solid)
+    bits |= EB_SOLID;
+
+  // event is not delta compressed, just 0 compressed
+  if(to->event)
+    bits |= EB_EVENT;
+
+  if(to->modelindex != from->modelindex)
+    bits |= EB_MODEL;
+  if(to->modelindex2 != from->modelindex2)
+    bits |= EB_MODEL2;
+  if(to->modelindex3 != from->modelindex3)
+    bits |= EB_MODEL3;
+  if(to->modelindex4 != from->modelindex4)
+    bits |= EB_MODEL4;
+
+  if(to->sound != from->sound)
+    bits |= EB_SOUND;
+
+  if(newentity || (to->renderfx & RF_BEAM))
+    bits |= EB_OLDORIGIN;
+
+  if(!bits && !force)
+    return; // nothing to send!
+
+  MSG_WritePackedEntityHeader(msg, to->number, bits);
+
+  if(bits & EB_MODEL)
+    MSG_WriteBits(msg, to->modelindex, 8);
+  if(bits & EB_MODEL2)
+    MSG_WriteBits(msg, to->modelindex2, 8);
+  if(bits & EB_MODEL3)
+    MSG_WriteBits(msg, to->modelindex3, 8);
+  if(bits & EB_MODEL4)
+    MSG_WriteBits(msg, to->modelindex4, 8);
+
+  if(bits & EB_FRAME)
+    MSG_WriteSignedVarBits(msg, to->frame - from->frame);
+  if(bits & EB_SKIN)
+    MSG_WriteVarBits(msg, to->skinnum);
+  if(bits & EB_EFFECTS)
+    MSG_WriteVarBits(msg, to->effects);
+  if(bits & EB_RENDERFX)
+    MSG_WriteVarBits(msg, to->renderfx);
+
+  for(i = 0; i < 3; i++)
+    if(bits & (EB_ORIGIN1 << i))
+      MSG_WriteSignedVarBits(msg, origin[i] - predicted[i]);
+
+  for(i = 0; i < 3; i++)
+    if(bits & (EB_ANGLE1 << i))
+      MSG_WriteSignedVarBits(msg, (signed char)(angles[i] - MSG_PackAngle(from->angles[i])));
+
+  if(bits & EB_OLDORIGIN)
+    for(i = 0; i < 3; i++)
+      MSG_WriteSignedVarBits(msg, MSG_PackCoord(to->old_origin[i]) - origin[i]);
+
+  if(bits & EB_SOUND)
+    MSG_WriteBits(msg, to->sound, 8);
+  if(bits & EB_EVENT)
+    MSG_WriteBits(msg, to->event, 8);
+  if(bits & EB_SOLID)
+    MSG_WriteVarBits(msg, to->solid);
+  if(bits & EB_CMODEL_INDEX)
+    MSG_WriteBits(msg, to->cmodel_index, 8);
+}
+
+/*
+==================
+MSG_WritePackedPlayerstate
+
+The PROTOCOL_VERSION playerstate that follows svc_playerinfo.  from is
+NULL when there is no frame to delta from, msec is the time since it
+==================
+*/
+void MSG_WritePackedPlayerstate(player_state_t *from, player_state_t *to, sizebuf_t *msg, int msec) {
+  int i;
+  int pflags;
+  player_state_t *ps, *ops;
+  player_state_t dummy;
+  int predicted[3];
+  unsigned statbits;
+
+  ps = to;
+  if(!from) {
+    memset(&dummy, 0, sizeof(dummy));
+    ops = &dummy;
+  } else
+    ops = from;
+
+  MSG_PredictPmoveOrigin(&ops->pmove, msec, predicted);
+
+  //
+  // determine what needs to be sent
+  //
+  pflags = 0;
+
+  if(ps->pmove.pm_type != ops->pmove.pm_type)
+    pflags |= PS_M_TYPE;
+
+  if(ps->pmove.origin[0] != ops->pmove.origin[0] || ps->pmove.origin[1] != ops->pmove.origin[1] ||
+     ps->pmove.origin[2] != ops->pmove.origin[2])
+    pflags |= PS_M_ORIGIN;
+
+  if(ps->pmove.velocity[0] != ops->pmove.velocity[0] || ps->pmove.velocity[1] != ops->pmove.velocity[1] ||
+     ps->pmove.velocity[2] != ops->pmove.velocity[2])
+    pflags |= PS_M_VELOCITY;
+
+  if(ps->pmove.pm_time != ops->pmove.pm_time)
+    pflags |= PS_M_TIME;
+
+  if(ps->pmove.pm_flags != ops->pmove.pm_flags)
+    pflags |= PS_M_FLAGS;
+
+  if(ps->pmove.gravity != ops->pmove.gravity)
+    pflags |= PS_M_GRAVITY;
+
+  if(ps->pmove.delta_angles[0] != ops->pmove.delta_angles[0] ||
+     ps->pmove.delta_angles[1] != ops->pmove.delta_angles[1] || ps->pmove.delta_angles[2] != ops->pmove.delta_angles[2])
+    pflags |= PS_M_DELTA_ANGLES;
+
+  if(ps->viewoffset[0] != ops->viewoffset[0] || ps->viewoffset[1] != ops->viewoffset[1] ||
+     ps->viewoffset[2] != ops->viewoffset[2])
+    pflags |= PS_VIEWOFFSET;
+
+  for(i = 0; i < 3; i++)
+    if(ANGLE2SHORT(ps->viewangles[i]) != ANGLE2SHORT(ops->viewangles[i]))
+      pflags |= PS_VIEWANGLES;
+
+  if(ps->kick_angles[0] != ops->kick_angles[0] || ps->kick_angles[1] != ops->kick_angles[1] ||
+     ps->kick_angles[2] != ops->kick_angles[2])
+    pflags |= PS_KICKANGLES;
+
+  if(ps->blend[0] != ops->blend[0] || ps->blend[1] != ops->blend[1] || ps->blend[2] != ops->blend[2] ||
+     ps->blend[3] != ops->blend[3])
+    pflags |= PS_BLEND;
+
+  if(ps->fov != ops->fov)
+    pflags |= PS_FOV;
+
+  if(ps->rdflags != ops->rdflags)
+    pflags |= PS_RDFLAGS;
+
+  if(ps->gunframe != ops->gunframe)
+    pflags |= PS_WEAPONFRAME;
+
+  if(ps->cmodel_index != ops->cmodel_index)
+    pflags |= PS_CMODEL_INDEX;
+
+  pflags |= PS_WEAPONINDEX;
+
+  //
+  // write it
+  //
+  MSG_WriteAlign(msg);
+
+  for(i = 0; i < 16; i++)
+    if(PS_COMMON & (1 << i))
+      MSG_WriteBits(msg, (pflags >> i) & 1, 1);
+  MSG_WriteBits(msg, (pflags & ~PS_COMMON) != 0, 1);
+  if(pflags & ~PS_COMMON)
+    for(i = 0; i < 16; i++)
+      if(!(PS_COMMON & (1 << i)))
+        MSG_WriteBits(msg, (pflags >> i) & 1, 1);
+
+  //
+  // write the pmove_state_t
+  //
+  if(pflags & PS_M_TYPE)
+    MSG_WriteBits(msg, ps->pmove.pm_type, 8);
+
+  if(pflags & PS_M_ORIGIN)
+    for(i = 0; i < 3; i++)
+      MSG_WriteSignedVarBits(msg, ps->pmove.origin[i] - predicted[i]);
+
+  if(pflags & PS_M_VELOCITY)
+    for(i = 0; i < 3; i++)
+      MSG_WriteSignedVarBits(msg, ps->pmove.velocity[i] - ops->pmove.velocity[i]);
+
+  if(pflags & PS_M_TIME)
+    MSG_WriteBits(msg, ps->pmove.pm_time, 8);
+
+  if(pflags & PS_M_FLAGS)
+    MSG_WriteBits(msg, ps->pmove.pm_flags, 8);
+
+  if(pflags & PS_M_GRAVITY)
+    MSG_WriteSignedVarBits(msg, ps->pmove.gravity - ops->pmove.gravity);
+
+  if(pflags & PS_M_DELTA_ANGLES)
+    for(i = 0; i < 3; i++)
+      MSG_WriteBits(msg, ps->pmove.delta_angles[i], 16);
+
+  //
+  // write the rest of the player_state_t
+  //
+  if(pflags & PS_VIEWOFFSET)
+    for(i = 0; i < 3; i++)
+      MSG_WriteBits(msg, (int)(ps->viewoffset[i] * 4), 8);
+
+  if(pflags & PS_VIEWANGLES)
+    for(i = 0; i < 3; i++)
+      MSG_WriteSignedVarBits(msg, (short)(ANGLE2SHORT(ps->viewangles[i]) - ANGLE2SHORT(ops->viewangles[i])));
+
+  if(pflags & PS_KICKANGLES)
+    for(i = 0; i < 3; i++)
+      MSG_WriteBits(msg, (int)(ps->kick_angles[i] * 4), 8);
+
+  if(pflags & PS_WEAPONINDEX)
+    MSG_WriteBits(msg, ps->gunindex, 8);
+
+  if(pflags & PS_WEAPONFRAME) {
+    MSG_WriteBits(msg, ps->gunframe, 8);
+    for(i = 0; i < 3; i++)
+      MSG_WriteBits(msg, (int)(ps->gunoffset[i] * 4), 8);
+    for(i = 0; i < 3; i++)
+      MSG_WriteBits(msg, (int)(ps->gunangles[i] * 4), 8);
+  }
+
+  if(pflags & PS_BLEND)
+    for(i = 0; i < 4; i++)
+      MSG_WriteBits(msg, (int)(ps->blend[i] * 255), 8);
+  if(pflags & PS_FOV)
+    MSG_WriteBits(msg, (int)ps->fov, 8);
+  if(pflags & PS_RDFLAGS)
+    MSG_WriteBits(msg, ps->rdflags, 8);
+  if(pflags & PS_CMODEL_INDEX)
+    MSG_WriteBits(msg, ps->cmodel_index, 8);
+
+  // send stats
+  statbits = 0;
+  for(i = 0; i < MAX_STATS; i++)
+    if(ps->stats[i] != ops->stats[i])
+      statbits |= 1u << i;
+  MSG_WriteBits(msg, statbits != 0, 1);
+  if(statbits) {
+    MSG_WriteBits(msg, statbits, 32);
+    for(i = 0; i < MAX_STATS; i++)
+      if(statbits & (1u << i))
+        MSG_WriteSignedVarBits(msg, ps->stats[i] - ops->stats[i]);
+  }
+}
+
+//============================================================
+
+//
+// reading functions
+//
+
+void MSG_BeginReading(sizebuf_t *msg) {
+  msg->readcount = 0;
+  msg->bitreadcount = 0;
+}
+
+// returns -1 if no more characters are available
+int MSG_ReadChar(sizebuf_t *msg_read) {
+  int c;
+
+  if(msg_read->readcount + 1 > msg_read->cursize)
+    c = -1;
+  else
+    c = (signed char)msg_read->data[msg_read->readcount];
+  msg_read->readcount++;
+
+  return c;
+}
+
+int MSG_ReadByte(sizebuf_t *msg_read) {
+  int c;
+
+  if(msg_read->readcount + 1 > msg_read->cursize)
+    c = -1;
+  else
+    c = (unsigned char)msg_read->data[msg_read->readcount];
+  msg_read->readcount++;
+
+  return c;
+}
+
+int MSG_ReadShort(sizebuf_t *msg_read) {
+  int c;
+
+  if(msg_read->readcount + 2 > msg_read->cursize)
+    c = -1;
+  else
+    c = (short)(msg_read->data[msg_read->readcount] + (msg_read->data[msg_read->readcount + 1] << 8));
+
+  msg_read->readcount += 2;
+
+  return c;
+}
+
+int MSG_ReadLong(sizebuf_t *msg_read) {
+  int c;
+
+  if(msg_read->readcount + 4 > msg_read->cursize)
+    c = -1;
+  else
+    c = msg_read->data[msg_read->readcount] + (msg_read->data[msg_read->readcount + 1] << 8) +
+        (msg_read->data[msg_read->readcount + 2] << 16) + (msg_read->data[msg_read->readcount + 3] << 24);
+
+  msg_read->readcount += 4;
+
+  return c;
+}
+
+float MSG_ReadFloat(sizebuf_t *msg_read) {
+  union {
+    byte b[4];
+    float f;
+    int l;
+  } dat;
+
+  if(msg_read->readcount + 4 > msg_read->cursize)
+    dat.f = -1;
+  else {
+    dat.b[0] = msg_read->data[msg_read->readcount];
+    dat.b[1] = msg_read->data[msg_read->readcount + 1];
+    dat.b[2] = msg_read->data[msg_read->readcount + 2];
+    dat.b[3] = msg_read->data[msg_read->readcount + 3];
+  }
+  msg_read->readcount += 4;
+
+  dat.l = LittleLong(dat.l);
+
+  return dat.f;
+}
+
+char *MSG_ReadString(sizebuf_t *msg_read) {
+  static char string[2048];
+  int l, c;
+
+  l = 0;
+  do {
+    c = MSG_ReadChar(msg_read);
+    if(c == -1 || c == 0)
+      break;
+    string[l] = c;
+    l++;
+  } while(l < sizeof(string) - 1);
+
+  string[l] = 0;
+
+  return string;
+}
+
+char *MSG_ReadStringLine(sizebuf_t *msg_read) {
+  static char string[2048];
+  int l, c;
+
+  l = 0;
+  do {
+    c = MSG_ReadChar(msg_read);
+    if(c == -1 || c == 0 || c == '\n')
+      break;
+    string[l] = c;
+    l++;
+  } while(l < sizeof(string) - 1);
+
+  string[l] = 0;
+
+  return string;
+}
+
+float MSG_ReadCoord(sizebuf_t *msg_read) { return MSG_ReadShort(msg_read) * (1.0 / 8); }
+
+void MSG_ReadPos(sizebuf_t *msg_read, vec3_t pos) {
+  pos[0] = MSG_ReadShort(msg_read) * (1.0 / 8);
+  pos[1] = MSG_ReadShort(msg_read) * (1.0 / 8);
+  pos[2] = MSG_ReadShort(msg_read) * (1.0 / 8);
+}
+
+float MSG_ReadAngle(sizebuf_t *msg_read) { return MSG_ReadChar(msg_read) * (360.0 / 256); }
+
+float MSG_ReadAngle16(sizebuf_t *msg_read) { return SHORT2ANGLE(MSG_ReadShort(msg_read)); }
+
+void MSG_ReadDeltaUsercmd(sizebuf_t *msg_read, usercmd_t *from, usercmd_t *move) {
+  int bits;
+
+  memcpy(move, from, sizeof(*move));
+
+  bits = MSG_ReadByte(msg_read);
+
+  // read current angles
+  if(bits & CM_ANGLE1)
+    move->angles[0] = MSG_ReadShort(msg_read);
+  if(bits & CM_ANGLE2)
+    move->angles[1] = MSG_ReadShort(msg_read);
+  if(bits & CM_ANGLE3)
+    move->angles[2] = MSG_ReadShort(msg_read);
+
+  // read movement
+  if(bits & CM_FORWARD)
+    move->forwardmove = MSG_ReadShort(msg_read);
+  if(bits & CM_SIDE)
+    move->sidemove = MSG_ReadShort(msg_read);
+  if(bits & CM_UP)
+    move->upmove = MSG_ReadShort(msg_read);
+
+  // read buttons
+  if(bits & CM_BUTTONS)
+    move->buttons = MSG_ReadByte(msg_read);
+
+  if(bits & CM_IMPULSE)
+    move->impulse = MSG_ReadByte(msg_read);
+
+  // read time to run command
+  move->msec = MSG_ReadByte(msg_read);
+
+  // read the light level
+  move->lightlevel = MSG_ReadByte(msg_read);
+}
+
+void MSG_ReadData(sizebuf_t *msg_read, void *data, int len) {
+  int i;
+
+  for(i = 0; i < len; i++)
+    ((byte *)data)[i] = MSG_ReadByte(msg_read);
+}
+
+/*
+==================
+MSG_ReadEntityBits
+
+Reads a protocol 34 entity header, returns the entity number and the U_*
+bits
+==================
+*/
+int MSG_ReadEntityBits(sizebuf_t *msg_read, unsigned *bits) {
+  unsigned b, total;
+  int number;
+
+  total = MSG_ReadByte(msg_read);
+  if(total & U_MOREBITS1) {
+    b = MSG_ReadByte(msg_read);
+    total |= b << 8;
+  }
+  if(total & U_MOREBITS2) {
+    b = MSG_ReadByte(msg_read);
+    total |= b << 16;
+  }
+  if(total & U_MOREBITS3) {
+    b = MSG_ReadByte(msg_read);
+    total |= b << 24;
+  }
+
+  if(total & U_NUMBER16)
+    number = MSG_ReadShort(msg_read);
+  else
+    number = MSG_ReadByte(msg_read);
+
+  *bits = total;
+
+  return number;
+}
+
+/*
+==================
+MSG_ReadDeltaEntity
+
+The fields MSG_WriteDeltaEntity wrote, to already holds the base with
+old_origin set to the base origin
+==================
+*/
+void MSG_ReadDeltaEntity(sizebuf_t *msg_read, entity_state_t *to, int bits) {
+  if(bits & U_MODEL)
+    to->modelindex = MSG_ReadByte(msg_read);
+  if(bits & U_MODEL2)
+    to->modelindex2 = MSG_ReadByte(msg_read);
+  if(bits & U_MODEL3)
+    to->modelindex3 = MSG_ReadByte(msg_read);
+  if(bits & U_MODEL4)
+    to->modelindex4 = MSG_ReadByte(msg_read);
+
+  if(bits & U_FRAME8)
+    to->frame = MSG_ReadByte(msg_read);
+  if(bits & U_FRAME16)
+    to->frame = MSG_ReadShort(msg_read);
+
+  if((bits & U_SKIN8) && (bits & U_SKIN16)) // used for laser colors
+    to->skinnum = MSG_ReadLong(msg_read);
+  else if(bits & U_SKIN8)
+    to->skinnum = MSG_ReadByte(msg_read);
+  else if(bits & U_SKIN16)
+    to->skinnum = MSG_ReadShort(msg_read);
+
+  if((bits & (U_EFFECTS8 | U_EFFECTS16)) == (U_EFFECTS8 | U_EFFECTS16))
+    to->effects = MSG_ReadLong(msg_read);
+  else if(bits & U_EFFECTS8)
+    to->effects = MSG_ReadByte(msg_read);
+  else if(bits & U_EFFECTS16)
+    to->effects = MSG_ReadShort(msg_read);
+
+  if((bits & (U_RENDERFX8 | U_RENDERFX16)) == (U_RENDERFX8 | U_RENDERFX16))
+    to->renderfx = MSG_ReadLong(msg_read);
+  else if(bits & U_RENDERFX8)
+    to->renderfx = MSG_ReadByte(msg_read);
+  else if(bits & U_RENDERFX16)
+    to->renderfx = MSG_ReadShort(msg_read);
+
+  if(bits & U_ORIGIN1)
+    to->origin[0] = MSG_ReadCoord(msg_read);
+  if(bits & U_ORIGIN2)
+    to->origin[1] = MSG_ReadCoord(msg_read);
+  if(bits & U_ORIGIN3)
+    to->origin[2] = MSG_ReadCoord(msg_read);
+
+  if(bits & U_ANGLE1)
+    to->angles[0] = MSG_ReadAngle(msg_read);
+  if(bits & U_ANGLE2)
+    to->angles[1] = MSG_ReadAngle(msg_read);
+  if(bits & U_ANGLE3)
+    to->angles[2] = MSG_ReadAngle(msg_read);
+
+  if(bits & U_OLDORIGIN)
+    MSG_ReadPos(msg_read, to->old_origin);
+
+  if(bits & U_SOUND)
+    to->sound = MSG_ReadByte(msg_read);
+
+  if(bits & U_EVENT)
+    to->event = MSG_ReadByte(msg_read);
+  else
+    to->event = 0;
+
+  if(bits & U_SOLID)
+    to->solid = MSG_ReadShort(msg_read);
+
+  if(bits & U_CMODEL_INDEX)
+    to->cmodel_index = MSG_ReadByte(msg_read);
+}
+
+/*
+==================
+MSG_ReadDeltaPlayerstate
+
+What MSG_WriteDeltaPlayerstate wrote, state already holds the base
+==================
+*/
+void MSG_ReadDeltaPlayerstate(sizebuf_t *msg_read, player_state_t *state) {
+  int flags;
+  int i;
+  int statbits;
+
+  flags = MSG_ReadShort(msg_read);
+
+  //
+  // parse the pmove_state_t
+  //
+  if(flags & PS_M_TYPE)
+    state->pmove.pm_type = MSG_ReadByte(msg_read);
+
+  if(flags & PS_M_ORIGIN) {
+    state->pmove.origin[0] = MSG_ReadShort(msg_read);
+    state->pmove.origin[1] = MSG_ReadShort(msg_read);
+    state->pmove.origin[2] = MSG_ReadShort(msg_read);
+  }
+
+  if(flags & PS_M_VELOCITY) {
+    state->pmove.velocity[0] = MSG_ReadShort(msg_read);
+    state->pmove.velocity[1] = MSG_ReadShort(msg_read);
+    state->pmove.velocity[2] = MSG_ReadShort(msg_read);
+  }
+
+  if(flags & PS_M_TIME)
+    state->pmove.pm_time = MSG_ReadByte(msg_read);
+
+  if(flags & PS_M_FLAGS)
+    state->pmove.pm_flags = MSG_ReadByte(msg_read);
+
+  if(flags & PS_M_GRAVITY)
+    state->pmove.gravity = MSG_ReadShort(msg_read);
+
+  if(flags & PS_M_DELTA_ANGLES) {
+    state->pmove.delta_angles[0] = MSG_ReadShort(msg_read);
+    state->pmove.delta_angles[1] = MSG_ReadShort(msg_read);
+    state->pmove.delta_angles[2] = MSG_ReadShort(msg_read);
+  }
+
+  //
+  // parse the rest of the player_state_t
+  //
+  if(flags & PS_VIEWOFFSET) {
+    state->viewoffset[0] = MSG_ReadChar(msg_read) * 0.25;
+    state->viewoffset[1] = MSG_ReadChar(msg_read) * 0.25;
+    state->viewoffset[2] = MSG_ReadChar(msg_read) * 0.25;
+  }
+
+  if(flags & PS_VIEWANGLES) {
+    state->viewangles[0] = MSG_ReadAngle16(msg_read);
+    state->viewangles[1] = MSG_ReadAngle16(msg_read);
+    state->viewangles[2] = MSG_ReadAngle16(msg_read);
+  }
+
+  if(flags & PS_KICKANGLES) {
+    state->kick_angles[0] = MSG_ReadChar(msg_read) * 0.25;
+    state->kick_angles[1] = MSG_ReadChar(msg_read) * 0.25;
+    state->kick_angles[2] = MSG_ReadChar(msg_read) * 0.25;
+  }
+
+  if(flags & PS_WEAPONINDEX) {
+    state->gunindex = MSG_ReadByte(msg_read);
+  }
+
+  if(flags & PS_WEAPONFRAME) {
+    state->gunframe = MSG_ReadByte(msg_read);
+    state->gunoffset[0] = MSG_ReadChar(msg_read) * 0.25;
+    state->gunoffset[1] = MSG_ReadChar(msg_read) * 0.25;
+    state->gunoffset[2] = MSG_ReadChar(msg_read) * 0.25;
+    state->gunangles[0] = MSG_ReadChar(msg_read) * 0.25;
+    state->gunangles[1] = MSG_ReadChar(msg_read) * 0.25;
+    state->gunangles[2] = MSG_ReadChar(msg_read) * 0.25;
+  }
+
+  if(flags & PS_BLEND) {
+    state->blend[0] = MSG_ReadByte(msg_read) / 255.0;
+    state->blend[1] = MSG_ReadByte(msg_read) / 255.0;
+    state->blend[2] = MSG_ReadByte(msg_read) / 255.0;
+    state->blend[3] = MSG_ReadByte(msg_read) / 255.0;
+  }
+
+  if(flags & PS_FOV)
+    state->fov = MSG_ReadByte(msg_read);
+
+  if(flags & PS_RDFLAGS)
+    state->rdflags = MSG_ReadByte(msg_read);
+
+  if(flags & PS_CMODEL_INDEX)
+    state->cmodel_index = MSG_ReadByte(msg_read);
+
+  // parse stats
+  statbits = MSG_ReadLong(msg_read);
+  for(i = 0; i < MAX_STATS; i++)
+    if(statbits & (1 << i))
+      state->stats[i] = MSG_ReadShort(msg_read);
+}
+
+unsigned MSG_ReadBits(sizebuf_t *msg_read, int bits) {
+  unsigned value;
+  int shift, get, b;
+
+  // carry on in the last byte if the previous read left bits in it
+  if(msg_read->bitreadcount <= (msg_read->readcount - 1) * 8 || msg_read->bitreadcount >= msg_read->readcount * 8)
+    msg_read->bitreadcount = msg_read->readcount * 8;
+
+  value = 0;
+  for(shift = 0; shift < bits; shift += get) {
+    if(msg_read->bitreadcount == msg_read->readcount * 8)
+      msg_read->readcount++;
+    b = msg_read->readcount <= msg_read->cursize ? msg_read->data[msg_read->readcount - 1] : 0;
+
+    get = 8 - (msg_read->bitreadcount & 7);
+    if(get > bits - shift)
+      get = bits - shift;
+    value |= (unsigned)((b >> (msg_read->bitreadcount & 7)) & ((1 << get) - 1)) << shift;
+    msg_read->bitreadcount += get;
+  }
+
+  return value;
+}
+
+unsigned MSG_ReadVarBits(sizebuf_t *msg_read) {
+  static const int widths[4] = {4, 8, 16, 32};
+
+  return MSG_ReadBits(msg_read, widths[MSG_ReadBits(msg_read, 2)]);
+}
+
+int MSG_ReadSignedVarBits(sizebuf_t *msg_read) {
+  unsigned value;
+
+  value = MSG_ReadVarBits(msg_read);
+  return (int)(value >> 1) ^ -(int)(value & 1);
+}
+
+void MSG_ReadAlign(sizebuf_t *msg_read) { msg_read->bitreadcount = msg_read->readcount * 8; }
+
+/*
+==================
+MSG_ReadPackedEntityBits
+
+Reads what MSG_WritePackedEntityHeader wrote, returns the entity number
+and the EB_* bits
+==================
+*/
+int MSG_ReadPackedEntityBits(sizebuf_t *msg_read, unsigned *bits) {
+  int number;
+
+  MSG_ReadAlign(msg_read);
+
+  number = MSG_ReadBits(msg_read, MSG_ReadBits(msg_read, 1) ? 10 : 8);
+  *bits = 0;
+  if(!number)
+    return 0;
+
+  if(MSG_ReadBits(msg_read, 1)) {
+    *bits = EB_REMOVE;
+    return number;
+  }
+
+  if(MSG_ReadBits(msg_read, 1))
+    *bits |= MSG_ReadBits(msg_read, 3);
+  if(MSG_ReadBits(msg_read, 1))
+    *bits |= MSG_ReadBits(msg_read, 3) << 3;
+  if(MSG_ReadBits(msg_read, 1))
+    *bits |= EB_FRAME;
+  if(MSG_ReadBits(msg_read, 1))
+    *bits |= EB_EVENT;
+  if(MSG_ReadBits(msg_read, 1))
+    *bits |= MSG_ReadBits(msg_read, EB_MOREBITS) << 9;
+
+  return number;
+}
+
+/*
+==================
+MSG_ReadPackedDeltaEntity
+
+The fields MSG_WritePackedDeltaEntity wrote, to already holds the base
+with old_origin set to the base origin
+==================
+*/
+void MSG_ReadPackedDeltaEntity(sizebuf_t *msg_read, entity_state_t *from, entity_state_t *to, int bits) {
+  int predicted[3];
+  int i;
+
+  MSG_PredictEntityOrigin(from, predicted);
+
+  if(bits & EB_MODEL)
+    to->modelindex = MSG_ReadBits(msg_read, 8);
+  if(bits & EB_MODEL2)
+    to->modelindex2 = MSG_ReadBits(msg_read, 8);
+  if(bits & EB_MODEL3)
+    to->modelindex3 = MSG_ReadBits(msg_read, 8);
+  if(bits & EB_MODEL4)
+    to->modelindex4 = MSG_ReadBits(msg_read, 8);
+
+  if(bits & EB_FRAME)
+    to->frame += MSG_ReadSignedVarBits(msg_read);
+  if(bits & EB_SKIN)
+    to->skinnum = MSG_ReadVarBits(msg_read);
+  if(bits & EB_EFFECTS)
+    to->effects = MSG_ReadVarBits(msg_read);
+  if(bits & EB_RENDERFX)
+    to->renderfx = MSG_ReadVarBits(msg_read);
+
+  for(i = 0; i < 3; i++)
+    if(bits & (EB_ORIGIN1 << i))
+      to->origin[i] = (short)(predicted[i] + MSG_ReadSignedVarBits(msg_read)) * (1.0 / 8);
+
+  for(i = 0; i < 3; i++)
+    if(bits & (EB_ANGLE1 << i))
+      to->angles[i] =
+          (signed char)((MSG_PackAngle(from->angles[i]) + MSG_ReadSignedVarBits(msg_read)) & 255) * (360.0 / 256);
+
+  if(bits & EB_OLDORIGIN)
+    for(i = 0; i < 3; i++)
+      to->old_origin[i] = (short)(MSG_PackCoord(to->origin[i]) + MSG_ReadSignedVarBits(msg_read)) * (1.0 / 8);
+
+  if(bits & EB_SOUND)
+    to->sound = MSG_ReadBits(msg_read, 8);
+
+  if(bits & EB_EVENT)
+    to->event = MSG_ReadBits(msg_read, 8);
+  else
+    to->event = 0;
+
+  if(bits & EB_SOLID)
+    to->solid = MSG_ReadVarBits(msg_read);
+
+  if(bits & EB_CMODEL_INDEX)
+    to->cmodel_index = MSG_ReadBits(msg_read, 8);
+}
+
+/*
+==================
+MSG_ReadPackedPlayerstate
+
+What MSG_WritePackedPlayerstate wrote, state already holds the base and
+msec is the time since it
+==================
+*/
+void MSG_ReadPackedPlayerstate(sizebuf_t *msg_read, player_state_t *state, int msec) {
+  int flags;
+  int predicted[3];
+  unsigned statbits;
+  int i;
+
+  // the server guesses from the frame it deltas from
+  MSG_PredictPmoveOrigin(&state->pmove, msec, predicted);
+
+  MSG_ReadAlign(msg_read);
+
+  flags = 0;
+  for(i = 0; i < 16; i++)
+    if(PS_COMMON & (1 << i))
+      flags |= MSG_ReadBits(msg_read, 1) << i;
+  if(MSG_ReadBits(msg_read, 1))
+    for(i = 0; i < 16; i++)
+      if(!(PS_COMMON & (1 << i)))
+        flags |= MSG_ReadBits(msg_read, 1) << i;
+
+  //
+  // parse the pmove_state_t
+  //
+  if(flags & PS_M_TYPE)
+    state->pmove.pm_type = MSG_ReadBits(msg_read, 8);
+
+  if(flags & PS_M_ORIGIN)
+    for(i = 0; i < 3; i++)
+      state->pmove.origin[i] = predicted[i] + MSG_ReadSignedVarBits(msg_read);
+
+  if(flags & PS_M_VELOCITY)
+    for(i = 0; i < 3; i++)
+      state->pmove.velocity[i] += MSG_ReadSignedVarBits(msg_read);
+
+  if(flags & PS_M_TIME)
+    state->pmove.pm_time = MSG_ReadBits(msg_read, 8);
+
+  if(flags & PS_M_FLAGS)
+    state->pmove.pm_flags = MSG_ReadBits(msg_read, 8);
+
+  if(flags & PS_M_GRAVITY)
+    state->pmove.gravity += MSG_ReadSignedVarBits(msg_read);
+
+  if(flags & PS_M_DELTA_ANGLES)
+    for(i = 0; i < 3; i++)
+      state->pmove.delta_angles[i] = MSG_ReadBits(msg_read, 16);
+
+  //
+  // parse the rest of the player_state_t
+  //
+  if(flags & PS_VIEWOFFSET)
+    for(i = 0; i < 3; i++)
+      state->viewoffset[i] = (signed char)MSG_ReadBits(msg_read, 8) * 0.25;
+
+  if(flags & PS_VIEWANGLES)
+    for(i = 0; i < 3; i++)
+      state->viewangles[i] =
+          SHORT2ANGLE((short)(ANGLE2SHORT(state->viewangles[i]) + MSG_ReadSignedVarBits(msg_read)));
+
+  if(flags & PS_KICKANGLES)
+    for(i = 0; i < 3; i++)
+      state->kick_angles[i] = (signed char)MSG_ReadBits(msg_read, 8) * 0.25;
+
+  if(flags & PS_WEAPONINDEX)
+    state->gunindex = MSG_ReadBits(msg_read, 8);
+
+  if(flags & PS_WEAPONFRAME) {
+    state->gunframe = MSG_ReadBits(msg_read, 8);
+    for(i = 0; i < 3; i++)
+      state->gunoffset[i] = (signed char)MSG_ReadBits(msg_read, 8) * 0.25;
+    for(i = 0; i < 3; i++)
+      state->gunangles[i] = (signed char)MSG_ReadBits(msg_read, 8) * 0.25;
+  }
+
+  if(flags & PS_BLEND)
+    for(i = 0; i < 4; i++)
+      state->blend[i] = MSG_ReadBits(msg_read, 8) / 255.0;
+
+  if(flags & PS_FOV)
+    state->fov = MSG_ReadBits(msg_read, 8);
+
+  if(flags & PS_RDFLAGS)
+    state->rdflags = MSG_ReadBits(msg_read, 8);
+
+  if(flags & PS_CMODEL_INDEX)
+    state->cmodel_index = MSG_ReadBits(msg_read, 8);
+
+  // parse stats
+  if(MSG_ReadBits(msg_read, 1)) {
+    statbits = MSG_ReadBits(msg_read, 32);
+    for(i = 0; i < MAX_STATS; i++)
+      if(statbits & (1u << i))
+        state->stats[i] += MSG_ReadSignedVarBits(msg_read);
+  }
+}
+
+//===========================================================================
+
+void SZ_Init(sizebuf_t *buf, byte *data, int length) {
+  memset(buf, 0, sizeof(*buf));
+  buf->data = data;
+  buf->maxsize = length;
+}
+
+void SZ_Clear(sizebuf_t *buf) {
+  buf->cursize = 0;
+  buf->bitcursize = 0;
+  buf->overflowed = false;
+}
+
+void *SZ_GetSpace(sizebuf_t *buf, int length) {
+  void *data;
+
+  if(buf->cursize + length > buf->maxsize) {
+    if(!buf->allowoverflow)
+      Com_Error(ERR_FATAL, "SZ_GetSpace: overflow without allowoverflow set");
+
+    if(length > buf->maxsize)
+      Com_Error(ERR_FATAL, "SZ_GetSpace: %i is > full buffer size", length);
+
+    Com_Printf("SZ_GetSpace: overflow\n");
+    SZ_Clear(buf);
+    buf->overflowed = true;
+  }
+
+  data = buf->data + buf->cursize;
+  buf->cursize += length;
+
+  return data;
+}
+
+void SZ_Write(sizebuf_t *buf, const void *data, int length) { memcpy(SZ_GetSpace(buf, length), data, length); }
+
+void SZ_Print(sizebuf_t *buf, const char *data) {
+  int len;
+
+  len = strlen(data) + 1;
+
+  if(buf->cursize) {
+    if(buf->data[buf->cursize - 1])
+      memcpy((byte *)SZ_GetSpace(buf, len), data, len); // no trailing 0
+    else
+      memcpy((byte *)SZ_GetSpace(buf, len - 1) - 1, data, len); // write over trailing 0
+  } else
+    memcpy((byte *)SZ_GetSpace(buf, len), data, len);
+}
+
@@ -17,10 +17,21 @@ along with this program; if not, write to the Free Software
 Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 */
-// net_wins.c
+// net_libuv.c -- udp sockets on the global uv loop
+
+#ifdef __linux__
+#define _GNU_SOURCE // sendmmsg
+#endif
 
 #include "../qcommon/qcommon.h"
 
+#include <uv.h>
+
+#ifdef __linux__
+#include <errno.h>
+#include <sys/socket.h>
+#endif
+
 #define MAX_LOOPBACK 4
 
 typedef struct {
@@ -37,12 +48,79 @@ cvar_t *net_shownet;
 
 loopback_t loopbacks[2];
 
+/*
+=============================================================================
+
+The receive buffers come from a pool.  libuv reads a batch of datagrams
+into one buffer with recvmmsg, one datagram per 64k chunk, and the
+buffer goes back to the pool once every datagram in it has been read by
+NET_GetPacket.  Only the pages that datagrams land in are ever touched.
+
+Outgoing packets are queued and written with one sendmmsg per frame by
+NET_Flush.
+
+=============================================================================
+*/
+
+#define NET_DGRAM_CHUNK 0x10000 // libuv's recvmmsg slot size
+#define NET_RECV_BATCH 16
+#define NET_POOL_BUFFERS 32
+#define NET_MAX_QUEUED 1024 // received, per socket
+#define NET_MAX_SENDS 1024  // queued for the flush, per socket
+
+typedef struct netbuf_s {
+  struct netbuf_s *next; // free list
+  int refcount;          // queued datagrams, plus one while libuv holds it
+  byte *data;
+} netbuf_t;
+
+typedef struct {
+  netbuf_t *buf;
+  const byte *data;
+  int length;
+  netadr_t from;
+} netqueued_t;
+
+typedef struct {
+  struct sockaddr_in to;
+  int length;
+  byte data[MAX_MSGLEN];
+} netsend_t;
+
+typedef struct {
+  bool open;
+  uv_udp_t *handle; // a new one for every open, closing frees it later
+  int port;         // host order, as bound
+
+  netqueued_t queue[NET_MAX_QUEUED];
+  int get, put;
+
+  netsend_t *sends;
+  int numsends;
+} netsocket_t;
+
+typedef struct {
+  int frames;
+  int packets_in, packets_out;
+  int bytes_in, bytes_out;
+  int recv_calls, send_calls;
+  int dropped;      // received with the queue full
+  int send_dropped; // refused by sendmmsg
+} netstats_t;
+
+static netsocket_t ip_sockets[2];
+
+static netbuf_t net_pool[NET_POOL_BUFFERS];
+static netbuf_t *net_freebufs;
+
+static netstats_t net_stats;
+
 bool NET_CompareAdr(netadr_t a, netadr_t b) {
   if(a.type != b.type)
     return false;
 
   if(a.type == NA_LOOPBACK)
-    return TRUE;
+    return true;
 
   if(a.type == NA_IP) {
     if(a.ip[0] == b.ip[0] && a.ip[1] == b.ip[1] && a.ip[2] == b.ip[2] && a.ip[3] == b.ip[3] && a.port == b.port)
@@ -58,7 +136,7 @@ bool NET_CompareBaseAdr(netadr_t a, netadr_t b) {
     return false;
 
   if(a.type == NA_LOOPBACK)
-    return TRUE;
+    return true;
 
   if(a.type == NA_IP) {
     if(a.ip[0] == b.ip[0] && a.ip[1] == b.ip[1] && a.ip[2] == b.ip[2] && a.ip[3] == b.ip[3])
@@ -80,47 +158,55 @@ char *NET_AdrToString(netadr_t a) {
   return s;
 }
 
-static inline bool StringToSockaddr(char *s, struct sockaddr *sadr) {
+static inline bool StringToSockaddr(const char *s, struct sockaddr_in *sadr) {
   struct hostent *h;
   char *colon;
-  int val;
   char copy[128];
 
   memset(sadr, 0, sizeof(*sadr));
 
-  ((struct sockaddr_in *)sadr)->sin_family = AF_INET;
+  sadr->sin_family = AF_INET;
 
-  ((struct sockaddr_in *)sadr)->sin_port = 0;
+  sadr->sin_port = 0;
 
-  strcpy(copy, s);
+  Com_sprintf(copy, sizeof(copy), "%s", s);
   // strip off a trailing :port if present
   for(colon = copy; *colon; colon++)
     if(*colon == ':') {
       *colon = 0;
-      ((struct sockaddr_in *)sadr)->sin_port = htons((short)atoi(colon + 1));
+      sadr->sin_port = htons((short)atoi(colon + 1));
     }
 
   if(copy[0] >= '0' && copy[0] <= '9') {
-    *(int *)&((struct sockaddr_in *)sadr)->sin_addr = inet_addr(copy);
+    sadr->sin_addr.s_addr = inet_addr(copy);
   } else {
     if(!(h = gethostbyname(copy)))
-      return 0;
-    *(int *)&((struct sockaddr_in *)sadr)->sin_addr = *(int *)h->h_addr_list[0];
+      return false;
+    memcpy(&sadr->sin_addr, h->h_addr_list[0], 4);
   }
 
   return true;
 }
 
-static inline void SockadrToNetadr(struct sockaddr *s, netadr_t *a) {
-  if(s->sa_family == AF_INET) {
-    a->type = NA_IP;
-    *(int *)&a->ip = ((struct sockaddr_in *)s)->sin_addr.s_addr;
-    a->port = ((struct sockaddr_in *)s)->sin_port;
-  }
+static inline void SockadrToNetadr(const struct sockaddr_in *s, netadr_t *a) {
+  memset(a, 0, sizeof(*a));
+  a->type = NA_IP;
+  memcpy(a->ip, &s->sin_addr.s_addr, 4);
+  a->port = s->sin_port;
+}
+
+static inline void NetadrToSockaddr(const netadr_t *a, struct sockaddr_in *s) {
+  memset(s, 0, sizeof(*s));
+  s->sin_family = AF_INET;
+  if(a->type == NA_BROADCAST)
+    s->sin_addr.s_addr = INADDR_BROADCAST;
+  else
+    memcpy(&s->sin_addr.s_addr, a->ip, 4);
+  s->sin_port = a->port;
 }
 
 bool NET_StringToAdr(char *s, netadr_t *a) {
-  struct sockaddr sadr;
+  struct sockaddr_in sadr;
 
   if(!strcmp(s, "localhost")) {
     memset(a, 0, sizeof(*a));
@@ -173,75 +259,576 @@ void NET_SendLoopPacket(netsrc_t sock, int length, void *data, netadr_t to) {
   loop->msgs[i].datalen = length;
 }
 
+//=============================================================================
+
+// uv_close finishes on a later loop pass, so handles live on the heap
+// and are freed by the close callback
+static void NET_FreeHandle(uv_handle_t *handle) { free(handle); }
+
+static uv_udp_t *NET_AllocHandle(void) {
+  uv_udp_t *handle;
+
+  handle = malloc(sizeof(*handle));
+  if(!handle)
+    Com_Error(ERR_FATAL, "NET_AllocHandle: out of memory");
+  return handle;
+}
+
+static void NET_ReleaseBuffer(netbuf_t *buf) {
+  if(--buf->refcount)
+    return;
+  buf->next = net_freebufs;
+  net_freebufs = buf;
+}
+
+static void NET_RecvAllocate(uv_handle_t *handle, size_t suggested_size, uv_buf_t *buf) {
+  netbuf_t *nb;
+
+  (void)handle;
+  (void)suggested_size;
+
+  // a zero length buffer makes libuv report UV_ENOBUFS and try again on the
+  // next readable event, the datagrams wait in the socket buffer meanwhile
+  nb = net_freebufs;
+  if(!nb) {
+    buf->base = NULL;
+    buf->len = 0;
+    return;
+  }
+  net_freebufs = nb->next;
+
+  if(!nb->data) {
+    nb->data = malloc(NET_RECV_BATCH * NET_DGRAM_CHUNK);
+    if(!nb->data)
+      Com_Error(ERR_FATAL, "NET_RecvAllocate: out of memory");
+  }
+  nb->refcount = 1;
+
+  buf->base = (char *)nb->data;
+  buf->len = NET_RECV_BATCH * NET_DGRAM_CHUNK;
+}
+
+static netbuf_t *NET_BufferForData(const void *data) {
+  int i;
+
+  for(i = 0; i < NET_POOL_BUFFERS; i++)
+    if(net_pool[i].data && (const byte *)data >= net_pool[i].data &&
+       (const byte *)data < net_pool[i].data + NET_RECV_BATCH * NET_DGRAM_CHUNK)
+      return &net_pool[i];
+  return NULL;
+}
+
+// a server packet came in since the last wakeup.  A dedicated server runs a
+// frame for it instead of waiting for the next tick, once per read rather
+// than once per packet
+static bool net_wakeserver;
+
+static void NET_WakeServer(void) {
+  if(!net_wakeserver)
+    return;
+  net_wakeserver = false;
+  Qcommon_Sleep(0);
+}
+
+static void NET_Recv(uv_udp_t *handle, ssize_t nread, const uv_buf_t *buf, const struct sockaddr *addr,
+                     unsigned flags) {
+  netsocket_t *ns;
+  netqueued_t *q;
+  netbuf_t *nb;
+
+  ns = handle->data;
+  nb = buf->base ? NET_BufferForData(buf->base) : NULL;
+  if(!nb)
+    return;
+
+  // the end of a recvmmsg batch, libuv is done with the buffer
+  if(flags & UV_UDP_MMSG_FREE) {
+    net_stats.recv_calls++;
+    NET_ReleaseBuffer(nb);
+    NET_WakeServer();
+    return;
+  }
+
+  if(!(flags & UV_UDP_MMSG_CHUNK))
+    net_stats.recv_calls++;
+
+  if(nread > 0 && addr && addr->sa_family == AF_INET) {
+    if(nread > MAX_MSGLEN) {
+      Com_Printf("Oversize packet from %s\n", inet_ntoa(((const struct sockaddr_in *)addr)->sin_addr));
+    } else if(ns->put - ns->get >= NET_MAX_QUEUED) {
+      net_stats.dropped++;
+    } else {
+      q = &ns->queue[ns->put++ % NET_MAX_QUEUED];
+      q->buf = nb;
+      q->data = (const byte *)buf->base;
+      q->length = nread;
+      SockadrToNetadr((const struct sockaddr_in *)addr, &q->from);
+      nb->refcount++;
+
+      if(ns == &ip_sockets[NS_SERVER])
+        net_wakeserver = true;
+    }
+  }
+
+  // a single datagram read, the buffer isn't shared with a batch
+  if(!(flags & UV_UDP_MMSG_CHUNK)) {
+    NET_ReleaseBuffer(nb);
+    NET_WakeServer();
+  }
+}
+
 bool NET_GetPacket(netsrc_t sock, netadr_t *net_from, sizebuf_t *net_message) {
+  netsocket_t *ns;
+  netqueued_t *q;
+
   if(NET_GetLoopPacket(sock, net_from, net_message))
     return true;
+
+  ns = &ip_sockets[sock];
+  if(ns->get == ns->put)
+    return false;
+
+  q = &ns->queue[ns->get++ % NET_MAX_QUEUED];
+  memcpy(net_message->data, q->data, q->length);
+  net_message->cursize = q->length;
+  *net_from = q->from;
+  NET_ReleaseBuffer(q->buf);
+
+  net_stats.packets_in++;
+  net_stats.bytes_in += q->length;
+
+  return true;
+}
+
+/*
+==================
+NET_FlushSocket
+
+Writes everything queued on the socket, with sendmmsg where there is one
+==================
+*/
+static void NET_FlushSocket(netsocket_t *ns) {
+  netsend_t *s;
+  int i;
+#ifdef __linux__
+  struct mmsghdr msgs[64];
+  struct iovec iovs[64];
+  uv_os_fd_t fd;
+  int n, done, sent;
+#endif
+
+  if(!ns->numsends)
+    return;
+
+  net_stats.packets_out += ns->numsends;
+
+#ifdef __linux__
+  if(!uv_fileno((uv_handle_t *)ns->handle, &fd)) {
+    for(i = 0; i < ns->numsends; i += n) {
+      n = ns->numsends - i;
+      if(n > 64)
+        n = 64;
+      memset(msgs, 0, n * sizeof(msgs[0]));
+      for(sent = 0; sent < n; sent++) {
+        s = &ns->sends[i + sent];
+        iovs[sent].iov_base = s->data;
+        iovs[sent].iov_len = s->length;
+        msgs[sent].msg_hdr.msg_name = &s->to;
+        msgs[sent].msg_hdr.msg_namelen = sizeof(s->to);
+        msgs[sent].msg_hdr.msg_iov = &iovs[sent];
+        msgs[sent].msg_hdr.msg_iovlen = 1;
+        net_stats.bytes_out += s->length;
+      }
+
+      // a short count leaves the rest to another call, an error is about
+      // the first packet left, which is dropped
+      for(done = 0; done < n; done += sent) {
+        net_stats.send_calls++;
+        sent = sendmmsg(fd, msgs + done, n - done, 0);
+        if(sent >= 0)
+          continue;
+        if(errno == EINTR) {
+          sent = 0;
+          continue;
+        }
+        if(net_shownet->value)
+          Com_Printf("NET_Flush: sendmmsg: %s\n", strerror(errno));
+        net_stats.send_dropped++;
+        sent = 1;
+      }
+    }
+    ns->numsends = 0;
+    return;
+  }
+#endif
+
+  for(i = 0, s = ns->sends; i < ns->numsends; i++, s++) {
+    net_stats.send_calls++;
+    net_stats.bytes_out += s->length;
+    uv_udp_try_send(ns->handle, &(uv_buf_t){.base = (char *)s->data, .len = s->length}, 1,
+                    (const struct sockaddr *)&s->to);
+  }
+  ns->numsends = 0;
+}
+
+/*
+==================
+NET_Flush
+
+Called once at the end of every frame
+==================
+*/
+void NET_Flush(void) {
+  NET_FlushSocket(&ip_sockets[NS_CLIENT]);
+  NET_FlushSocket(&ip_sockets[NS_SERVER]);
+  net_stats.frames++;
 }
 
 void NET_SendPacket(netsrc_t sock, int length, void *data, netadr_t to) {
+  netsocket_t *ns;
+  netsend_t *s;
+
   if(to.type == NA_LOOPBACK) {
     NET_SendLoopPacket(sock, length, data, to);
     return;
   }
+
+  if(to.type != NA_IP && to.type != NA_BROADCAST)
+    Com_Error(ERR_FATAL, "NET_SendPacket: bad address type");
+
+  ns = &ip_sockets[sock];
+  if(!ns->open)
+    return;
+  if(length > MAX_MSGLEN) {
+    Com_Printf("NET_SendPacket: %i byte packet to %s\n", length, NET_AdrToString(to));
+    return;
+  }
+
+  if(ns->numsends == NET_MAX_SENDS)
+    NET_FlushSocket(ns);
+
+  s = &ns->sends[ns->numsends++];
+  NetadrToSockaddr(&to, &s->to);
+  s->length = length;
+  memcpy(s->data, data, length);
 }
 
-static uv_udp_t ip_sockets[2];
+//=============================================================================
+
+static void NET_CloseSocket(netsocket_t *ns) {
+  if(!ns->open)
+    return;
+
+  NET_FlushSocket(ns);
+  uv_udp_recv_stop(ns->handle);
+  uv_close((uv_handle_t *)ns->handle, NET_FreeHandle);
+  ns->handle = NULL;
+  ns->open = false;
 
-static void RecvAllocate(uv_handle_t *handle, size_t suggested_size, uv_buf_t *buf) {
-  buf->base = malloc(suggested_size);
-  buf->len = suggested_size;
+  // anything still queued points into buffers that are about to be reused
+  while(ns->get != ns->put)
+    NET_ReleaseBuffer(ns->queue[ns->get++ % NET_MAX_QUEUED].buf);
+  ns->get = ns->put = 0;
 }
 
+static bool NET_OpenSocket(netsrc_t sock, const char *ip, int port) {
+  netsocket_t *ns;
+  struct sockaddr_in addr;
+  int err, namelen;
+
+  ns = &ip_sockets[sock];
+
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  if(!ip || !ip[0] || !Q_stricmp(ip, "localhost"))
+    addr.sin_addr.s_addr = INADDR_ANY;
+  else if(!StringToSockaddr(ip, &addr)) {
+    Com_Printf("WARNING: NET_OpenSocket: bad address %s\n", ip);
+    return false;
+  }
+  addr.sin_port = port == PORT_ANY ? 0 : htons((short)port);
+
+  // the handle of a socket closed earlier in this loop pass may still be
+  // closing, so this is always a fresh one
+  ns->handle = NET_AllocHandle();
+  err = uv_udp_init_ex(global_uv_loop(), ns->handle, AF_INET | UV_UDP_RECVMMSG);
+  if(err) {
+    Com_Printf("WARNING: NET_OpenSocket: %s\n", uv_strerror(err));
+    free(ns->handle);
+    ns->handle = NULL;
+    return false;
+  }
+  ns->handle->data = ns;
+
+  err = uv_udp_bind(ns->handle, (const struct sockaddr *)&addr, 0);
+  if(!err)
+    err = uv_udp_set_broadcast(ns->handle, 1);
+  if(!err)
+    err = uv_udp_recv_start(ns->handle, NET_RecvAllocate, NET_Recv);
+  if(err) {
+    Com_Printf("WARNING: NET_OpenSocket: %s:%i: %s\n", ip, port, uv_strerror(err));
+    uv_close((uv_handle_t *)ns->handle, NET_FreeHandle);
+    ns->handle = NULL;
+    return false;
+  }
+
+  namelen = sizeof(addr);
+  if(!uv_udp_getsockname(ns->handle, (struct sockaddr *)&addr, &namelen))
+    ns->port = ntohs(addr.sin_port);
 
+  if(!ns->sends) {
+    ns->sends = malloc(NET_MAX_SENDS * sizeof(netsend_t));
+    if(!ns->sends)
+      Com_Error(ERR_FATAL, "NET_OpenSocket: out of memory");
+  }
+  ns->open = true;
+  return true;
+}
 
-void NET_Config(bool enable) {
-  static bool server_on;
-  static bool client_on;
+/*
+====================
+NET_Config
 
-  const char *ip = Cvar_Get("ip", "localhost", CVAR_NOSET)->value;
-  int dedicated = Cvar_VariableValue("dedicated");
+A single player game will only use the loopback code
+====================
+*/
+void NET_Config(bool multiplayer) {
+  static bool old_config;
+  cvar_t *ip;
+  int port;
 
-  if(server_on != enable) {
-    server_on = enable;
+  if(old_config == multiplayer)
+    return;
+  old_config = multiplayer;
 
-    if(server_on) {
-      struct sockaddr_in addr;
-      addr.sin_port = Cvar_Get("ip_hostport", "0", CVAR_NOSET)->value;
-      if(!addr.sin_port) {
-        addr.sin_port = Cvar_Get("hostport", "0", CVAR_NOSET)->value;
-        if(!addr.sin_port) {
-          addr.sin_port = Cvar_Get("port", va("%i", PORT_SERVER), CVAR_NOSET)->value;
-        }
-      }
+  if(!multiplayer) { // shut down any existing sockets
+    NET_CloseSocket(&ip_sockets[NS_CLIENT]);
+    NET_CloseSocket(&ip_sockets[NS_SERVER]);
+    return;
+  }
 
-      if(!ip || !ip[0] || !stricmp(ip, "localhost"))
-        addr.sin_addr.s_addr = INADDR_ANY;
-      else
-        NET_StringToSockaddr(ip, (struct sockaddr *)&addr);
+  ip = Cvar_Get("ip", "localhost", CVAR_NOSET);
 
-      uv_udp_init(&global_uv_loop, &ip_sockets[NS_SERVER]);
-      uv_udp_connect(&ip_sockets[NS_SERVER], (const struct sockaddr *)&addr);
-      uv_udp_recv_start(&ip_sockets[NS_SERVER], RecvAllocate, SV_Recv);
-    } else {
-      uv_udp_recv_stop(&ip_sockets[NS_SERVER]);
+  port = Cvar_Get("ip_hostport", "0", CVAR_NOSET)->value;
+  if(!port) {
+    port = Cvar_Get("hostport", "0", CVAR_NOSET)->value;
+    if(!port)
+      port = Cvar_Get("port", va("%i", PORT_SERVER), CVAR_NOSET)->value;
+  }
+  NET_OpenSocket(NS_SERVER, ip->string, port);
+
+  // dedicated servers don't need client ports
+  if(!Cvar_VariableValue("dedicated")) {
+    port = Cvar_Get("ip_clientport", "0", CVAR_NOSET)->value;
+    if(!port) {
+      port = Cvar_Get("clientport", va("%i", PORT_CLIENT), CVAR_NOSET)->value;
+      if(!port)
+        port = PORT_ANY;
     }
+    if(!NET_OpenSocket(NS_CLIENT, ip->string, port))
+      NET_OpenSocket(NS_CLIENT, ip->string, PORT_ANY);
+  }
+}
 
-    if(multiplayer) {
-      int port;
+/*
+====================
+NET_Sleep
 
-      cvar_t *ip = Cvar_Get("ip", "localhost", CVAR_NOSET);
+The uv loop already waits for the sockets and the frame timer, a
+dedicated server just pushes its frame timer out to the next tick
+====================
+*/
+void NET_Sleep(int msec) { Qcommon_Sleep(msec); }
 
-      int dedicated = Cvar_VariableValue("dedicated");
+/*
+=============================================================================
 
-      uv_udp_init(&global_uv_loop, &ip_sockets[NS_SERVER]);
+LOAD GENERATOR
 
-    } else {
+net_loadgen <clients> [packets per second] [seconds] opens a socket per
+fake client and has each of them ping the local server at the given
+rate.  When it finishes it reports the server side packet rates and how
+many receive and send syscalls each frame took.
+
+=============================================================================
+*/
+
+typedef struct {
+  uv_udp_t *handle;
+  bool open;
+} loadclient_t;
+
+static loadclient_t *loadgen_clients;
+static int loadgen_numclients;
+static int loadgen_replies;
+static uv_timer_t loadgen_timer;
+static bool loadgen_timerinit;
+static uint64_t loadgen_start, loadgen_end;
+static netstats_t loadgen_stats;
+static byte loadgen_buffer[MAX_MSGLEN];
+
+static void NET_LoadgenAllocate(uv_handle_t *handle, size_t suggested_size, uv_buf_t *buf) {
+  (void)handle;
+  (void)suggested_size;
+  buf->base = (char *)loadgen_buffer;
+  buf->len = sizeof(loadgen_buffer);
+}
+
+static void NET_LoadgenRecv(uv_udp_t *handle, ssize_t nread, const uv_buf_t *buf, const struct sockaddr *addr,
+                            unsigned flags) {
+  (void)handle;
+  (void)buf;
+  (void)flags;
+  if(nread > 0 && addr)
+    loadgen_replies++;
+}
+
+static void NET_LoadgenStop(void) {
+  netstats_t d;
+  double secs;
+  int i, frames;
+
+  uv_timer_stop(&loadgen_timer);
+  for(i = 0; i < loadgen_numclients; i++) {
+    if(!loadgen_clients[i].open)
+      continue;
+    uv_udp_recv_stop(loadgen_clients[i].handle);
+    uv_close((uv_handle_t *)loadgen_clients[i].handle, NET_FreeHandle);
+  }
+
+  d = net_stats;
+  d.frames -= loadgen_stats.frames;
+  d.packets_in -= loadgen_stats.packets_in;
+  d.packets_out -= loadgen_stats.packets_out;
+  d.recv_calls -= loadgen_stats.recv_calls;
+  d.send_calls -= loadgen_stats.send_calls;
+  d.dropped -= loadgen_stats.dropped;
+  d.send_dropped -= loadgen_stats.send_dropped;
+
+  secs = (uv_hrtime() - loadgen_start) / 1e9;
+  frames = d.frames ? d.frames : 1;
+  Com_Printf("%i clients over %.1f seconds, %i frames\n", loadgen_numclients, secs, d.frames);
+  Com_Printf("in:  %8.0f packets/s, %6.2f recv calls/frame, %i dropped\n", d.packets_in / secs,
+             (float)d.recv_calls / frames, d.dropped);
+  Com_Printf("out: %8.0f packets/s, %6.2f send calls/frame, %i dropped\n", d.packets_out / secs,
+             (float)d.send_calls / frames, d.send_dropped);
+  Com_Printf("replies seen by the clients: %i\n", loadgen_replies);
+
+  // the handles are released by the loop after the close callbacks
+  loadgen_numclients = 0;
+}
+
+static void NET_LoadgenTick(uv_timer_t *timer) {
+  static const char ping[] = "\xff\xff\xff\xffping";
+  struct sockaddr_in to;
+  int i;
+
+  (void)timer;
+
+  if(uv_hrtime() >= loadgen_end) {
+    NET_LoadgenStop();
+    return;
+  }
+
+  memset(&to, 0, sizeof(to));
+  to.sin_family = AF_INET;
+  to.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  to.sin_port = htons((short)ip_sockets[NS_SERVER].port);
+
+  for(i = 0; i < loadgen_numclients; i++)
+    if(loadgen_clients[i].open)
+      uv_udp_try_send(loadgen_clients[i].handle, &(uv_buf_t){.base = (char *)ping, .len = sizeof(ping) - 1}, 1,
+                      (const struct sockaddr *)&to);
+}
+
+static void NET_Loadgen_f(void) {
+  struct sockaddr_in addr;
+  int i, rate, seconds;
+
+  if(Cmd_Argc() < 2) {
+    Com_Printf("usage: net_loadgen <clients> [packets per second] [seconds]\n");
+    return;
+  }
+  if(loadgen_numclients) {
+    Com_Printf("Load generator already running\n");
+    return;
+  }
+  if(!ip_sockets[NS_SERVER].open) {
+    Com_Printf("No server socket, start a multiplayer server first\n");
+    return;
+  }
+
+  loadgen_numclients = atoi(Cmd_Argv(1));
+  rate = Cmd_Argc() > 2 ? atoi(Cmd_Argv(2)) : 30;
+  seconds = Cmd_Argc() > 3 ? atoi(Cmd_Argv(3)) : 10;
+  if(loadgen_numclients < 1 || rate < 1 || seconds < 1) {
+    loadgen_numclients = 0;
+    return;
+  }
+
+  free(loadgen_clients);
+  loadgen_clients = calloc(loadgen_numclients, sizeof(*loadgen_clients));
+
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  for(i = 0; i < loadgen_numclients; i++) {
+    loadgen_clients[i].handle = NET_AllocHandle();
+    if(uv_udp_init(global_uv_loop(), loadgen_clients[i].handle)) {
+      free(loadgen_clients[i].handle);
+      break;
+    }
+    if(uv_udp_bind(loadgen_clients[i].handle, (const struct sockaddr *)&addr, 0) ||
+       uv_udp_recv_start(loadgen_clients[i].handle, NET_LoadgenAllocate, NET_LoadgenRecv)) {
+      uv_close((uv_handle_t *)loadgen_clients[i].handle, NET_FreeHandle);
+      break;
     }
+    loadgen_clients[i].open = true;
+  }
+  if(i < loadgen_numclients)
+    Com_Printf("Only %i sockets could be opened\n", i);
+
+  loadgen_replies = 0;
+  loadgen_stats = net_stats;
+  loadgen_start = uv_hrtime();
+  loadgen_end = loadgen_start + (uint64_t)seconds * 1000000000;
+
+  if(!loadgen_timerinit) {
+    uv_timer_init(global_uv_loop(), &loadgen_timer);
+    loadgen_timerinit = true;
   }
+  uv_timer_start(&loadgen_timer, NET_LoadgenTick, 0, 1000 / rate > 0 ? 1000 / rate : 1);
+}
 
-  // sleeps msec or until net socket is ready
-  void NET_Sleep(int msec) {}
+static void NET_Stats_f(void) {
+  Com_Printf("%i frames\n", net_stats.frames);
+  Com_Printf("in:  %i packets, %i bytes, %i recv calls, %i dropped\n", net_stats.packets_in, net_stats.bytes_in,
+             net_stats.recv_calls, net_stats.dropped);
+  Com_Printf("out: %i packets, %i bytes, %i send calls, %i dropped\n", net_stats.packets_out, net_stats.bytes_out,
+             net_stats.send_calls, net_stats.send_dropped);
+}
 
-  void NET_Init(void) { net_shownet = Cvar_Get("net_shownet", "0", 0); }
+/*
+====================
+NET_Init
+====================
+*/
+void NET_Init(void) {
+  int i;
 
-  void NET_Shutdown(void) {}
+  for(i = 0; i < NET_POOL_BUFFERS; i++) {
+    net_pool[i].next = net_freebufs;
+    net_freebufs = &net_pool[i];
+  }
+
+  net_shownet = Cvar_Get("net_shownet", "0", 0);
+  Cmd_AddCommand("net_stats", NET_Stats_f);
+  Cmd_AddCommand("net_loadgen", NET_Loadgen_f);
+}
+
+/*
+====================
+NET_Shutdown
+====================
+*/
+void NET_Shutdown(void) { NET_Config(false); }
@@ -1230,3 +1230,62 @@ void Pmove(pmove_t *pmove) {
 
   PM_SnapPosition();
 }
+
+static bool PM_SameState(const pmove_state_t *a, const pmove_state_t *b) {
+  // field by field, the struct has padding
+  return a->pm_type == b->pm_type && !memcmp(a->origin, b->origin, sizeof(a->origin)) &&
+         !memcmp(a->velocity, b->velocity, sizeof(a->velocity)) && a->pm_flags == b->pm_flags &&
+         a->pm_time == b->pm_time && a->gravity == b->gravity &&
+         !memcmp(a->delta_angles, b->delta_angles, sizeof(a->delta_angles));
+}
+
+/*
+================
+Pmove_Predict
+
+Pmove is deterministic, so a command run from the same state against the
+same world ends up where it did the last time.  When the state the server
+acknowledged matches the one cached for that sequence, only the commands
+sent since the last call have to be run.  The commands themselves never
+change once sent.
+================
+*/
+int Pmove_Predict(pmcache_t *cache, pmove_t *pm, const usercmd_t *cmds, int ack, int current, unsigned world) {
+  int seq, frame, count;
+
+  if(!cache->valid || cache->world != world || cache->airaccelerate != pm_airaccelerate ||
+     cache->cmodel_index != pm->cmodel_index || ack < cache->base || ack > cache->sequence ||
+     cache->sequence >= current || !PM_SameState(&cache->states[ack & (PM_CACHE_SIZE - 1)], &pm->s)) {
+    // start over from the server's state
+    cache->valid = true;
+    cache->world = world;
+    cache->airaccelerate = pm_airaccelerate;
+    cache->cmodel_index = pm->cmodel_index;
+    cache->sequence = ack;
+    cache->states[ack & (PM_CACHE_SIZE - 1)] = pm->s;
+  }
+  cache->base = ack;
+
+  count = 0;
+  for(seq = cache->sequence + 1; seq < current; seq++) {
+    frame = seq & (PM_CACHE_SIZE - 1);
+
+    pm->s = cache->states[(seq - 1) & (PM_CACHE_SIZE - 1)];
+    pm->cmd = cmds[frame];
+    Pmove(pm);
+
+    cache->states[frame] = pm->s;
+    VectorCopy(pm->viewangles, cache->viewangles[frame]);
+    cache->sequence = seq;
+    count++;
+  }
+
+  if(current - 1 > ack) {
+    frame = (current - 1) & (PM_CACHE_SIZE - 1);
+    pm->s = cache->states[frame];
+    VectorCopy(cache->viewangles[frame], pm->viewangles);
+  } else
+    VectorClear(pm->viewangles);
+
+  return count;
+}
@@ -0,0 +1,425 @@
+/*
+Copyright (C) 1997-2001 Id Software, Inc.
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+// profile.c -- hierarchical frame profiler
+
+#include "qcommon.h"
+
+#include <uv.h>
+
+#define PROF_MAX_ZONES 64
+#define PROF_MAX_DEPTH 32
+#define PROF_MAX_THREADS 64
+#define PROF_MAX_EVENTS 65536 // per thread, while capturing
+#define PROF_HISTORY 256      // frames kept for the percentile summary
+
+typedef struct {
+  const char *name;
+  unsigned short zone;
+  unsigned short depth;
+  uint64_t start, end;
+} profevent_t;
+
+// every thread that enters a zone gets one of these, only that thread
+// writes to it while a frame is running
+typedef struct {
+  int index;
+  int depth;
+  int zonestack[PROF_MAX_DEPTH];
+  uint64_t startstack[PROF_MAX_DEPTH];
+
+  uint64_t frametime[PROF_MAX_ZONES]; // inclusive nanoseconds this frame
+
+  int numevents;
+  profevent_t *events;
+} profthread_t;
+
+typedef struct {
+  const char *name;
+  unsigned history[PROF_HISTORY]; // microseconds per frame
+} profzone_t;
+
+cvar_t *profile;
+
+static bool prof_initialized;
+static bool prof_active; // latched from the cvar at the start of the frame
+
+static uv_key_t prof_threadkey;
+static uv_mutex_t prof_lock;
+static profthread_t *prof_threads[PROF_MAX_THREADS];
+static int prof_numthreads;
+
+static profzone_t prof_zones[PROF_MAX_ZONES];
+static int prof_numzones;
+
+static int prof_framecount; // frames summed into the history
+
+static int prof_captureframes; // frames left to capture
+static int prof_capturetotal;
+static uint64_t prof_capturestart;
+
+static profthread_t *Prof_Thread(void) {
+  profthread_t *thread;
+
+  thread = uv_key_get(&prof_threadkey);
+  if(thread)
+    return thread;
+
+  // can't use the zone here, worker threads come through as well
+  thread = calloc(1, sizeof(*thread));
+  if(!thread)
+    return NULL;
+
+  uv_mutex_lock(&prof_lock);
+  if(prof_numthreads == PROF_MAX_THREADS) {
+    uv_mutex_unlock(&prof_lock);
+    free(thread);
+    return NULL;
+  }
+  thread->index = prof_numthreads;
+  prof_threads[prof_numthreads++] = thread;
+  uv_mutex_unlock(&prof_lock);
+
+  if(prof_captureframes)
+    thread->events = malloc(PROF_MAX_EVENTS * sizeof(profevent_t));
+
+  uv_key_set(&prof_threadkey, thread);
+  return thread;
+}
+
+static int Prof_ZoneForName(const char *name) {
+  int i;
+
+  // another thread may be adding a zone, so even the pointer scan is
+  // done under the lock.  Zone names are string constants, so the
+  // pointer is nearly always enough; the string compare catches the
+  // same name in two modules
+  uv_mutex_lock(&prof_lock);
+  for(i = 0; i < prof_numzones; i++)
+    if(prof_zones[i].name == name)
+      break;
+  if(i == prof_numzones)
+    for(i = 0; i < prof_numzones; i++)
+      if(!strcmp(prof_zones[i].name, name))
+        break;
+  if(i == prof_numzones && prof_numzones < PROF_MAX_ZONES) {
+    memset(&prof_zones[i], 0, sizeof(prof_zones[i]));
+    prof_zones[i].name = name;
+    prof_numzones++;
+  }
+  uv_mutex_unlock(&prof_lock);
+
+  return i < PROF_MAX_ZONES ? i : -1;
+}
+
+/*
+================
+Prof_Begin
+
+Opens a zone on the calling thread, zones must nest
+================
+*/
+void Prof_Begin(const char *name) {
+  profthread_t *thread;
+  int zone;
+
+  if(!prof_active)
+    return;
+
+  thread = Prof_Thread();
+  if(!thread)
+    return;
+
+  if(thread->depth < PROF_MAX_DEPTH) {
+    zone = Prof_ZoneForName(name);
+    thread->zonestack[thread->depth] = zone;
+    thread->startstack[thread->depth] = uv_hrtime();
+  }
+  thread->depth++;
+}
+
+/*
+================
+Prof_End
+================
+*/
+void Prof_End(void) {
+  profthread_t *thread;
+  profevent_t *event;
+  uint64_t end;
+  int zone;
+
+  if(!prof_active)
+    return;
+
+  thread = Prof_Thread();
+  if(!thread || !thread->depth)
+    return;
+
+  thread->depth--;
+  if(thread->depth >= PROF_MAX_DEPTH)
+    return;
+
+  zone = thread->zonestack[thread->depth];
+  if(zone < 0)
+    return;
+
+  end = uv_hrtime();
+  thread->frametime[zone] += end - thread->startstack[thread->depth];
+
+  if(prof_captureframes && thread->events && thread->numevents < PROF_MAX_EVENTS) {
+    event = &thread->events[thread->numevents++];
+    event->name = prof_zones[zone].name;
+    event->zone = zone;
+    event->depth = thread->depth;
+    event->start = thread->startstack[thread->depth];
+    event->end = end;
+  }
+}
+
+/*
+================
+Prof_WriteCapture
+
+Writes the captured events in the Chrome trace event format, which
+chrome://tracing and Perfetto can load
+================
+*/
+static void Prof_WriteCapture(void) {
+  char name[MAX_OSPATH];
+  profthread_t *thread;
+  profevent_t *event;
+  FILE *f;
+  bool first;
+  int i, j, count;
+
+  Com_sprintf(name, sizeof(name), "%s/profile/%u.json", FS_Gamedir(), (unsigned)(prof_capturestart / 1000000000));
+  FS_CreatePath(name);
+  f = fopen(name, "w");
+  if(!f) {
+    Com_Printf("Couldn't write %s\n", name);
+    return;
+  }
+
+  fprintf(f, "{\"traceEvents\":[\n");
+  first = true;
+  count = 0;
+  for(i = 0; i < prof_numthreads; i++) {
+    thread = prof_threads[i];
+    fprintf(f, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%i,\"args\":{\"name\":\"%s %i\"}}",
+            first ? "" : ",\n", i, i ? "worker" : "main", i);
+    first = false;
+
+    for(j = 0, event = thread->events; j < thread->numevents; j++, event++) {
+      fprintf(f, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":0,\"tid\":%i,\"ts\":%.3f,\"dur\":%.3f}", event->name, i,
+              (event->start - prof_capturestart) / 1000.0, (event->end - event->start) / 1000.0);
+      count++;
+    }
+  }
+  fprintf(f, "\n]}\n");
+  fclose(f);
+
+  Com_Printf("Wrote %i events from %i frames to %s\n", count, prof_capturetotal, name);
+}
+
+static void Prof_FreeCapture(void) {
+  int i;
+
+  for(i = 0; i < prof_numthreads; i++) {
+    free(prof_threads[i]->events);
+    prof_threads[i]->events = NULL;
+    prof_threads[i]->numevents = 0;
+  }
+}
+
+/*
+================
+Prof_BeginFrame
+
+Called by the main thread at the top of each frame, when no other
+thread is inside a zone
+================
+*/
+void Prof_BeginFrame(void) {
+  profthread_t *thread;
+
+  if(!prof_initialized)
+    return;
+
+  prof_active = profile->value || prof_captureframes || host_speeds->value;
+  if(!prof_active)
+    return;
+
+  // an error can longjmp out of a frame with zones still open
+  thread = Prof_Thread();
+  if(thread)
+    thread->depth = 0;
+
+  Prof_Begin("frame");
+}
+
+/*
+================
+Prof_EndFrame
+
+Folds every thread's totals into the per zone history
+================
+*/
+void Prof_EndFrame(void) {
+  uint64_t total;
+  int i, z;
+
+  if(!prof_active)
+    return;
+
+  Prof_End();
+
+  for(z = 0; z < prof_numzones; z++) {
+    total = 0;
+    for(i = 0; i < prof_numthreads; i++) {
+      total += prof_threads[i]->frametime[z];
+      prof_threads[i]->frametime[z] = 0;
+    }
+    prof_zones[z].history[prof_framecount % PROF_HISTORY] = total / 1000;
+  }
+  prof_framecount++;
+
+  if(prof_captureframes && !--prof_captureframes) {
+    Prof_WriteCapture();
+    Prof_FreeCapture();
+  }
+
+  if(profile->value > 1 && !(prof_framecount % PROF_HISTORY))
+    Cbuf_AddText("profile_summary\n");
+}
+
+/*
+================
+Prof_ZoneMsec
+
+Inclusive time of a zone so far this frame, over all threads, for
+host_speeds
+================
+*/
+float Prof_ZoneMsec(const char *name) {
+  uint64_t total;
+  int i, z;
+
+  if(!prof_active)
+    return 0;
+
+  uv_mutex_lock(&prof_lock);
+  for(z = 0; z < prof_numzones; z++)
+    if(!strcmp(prof_zones[z].name, name))
+      break;
+  if(z == prof_numzones)
+    z = -1;
+  uv_mutex_unlock(&prof_lock);
+  if(z == -1)
+    return 0;
+
+  total = 0;
+  for(i = 0; i < prof_numthreads; i++)
+    total += prof_threads[i]->frametime[z];
+  return total / 1e6;
+}
+
+static int Prof_SortUnsigned(const void *a, const void *b) {
+  unsigned x = *(const unsigned *)a, y = *(const unsigned *)b;
+
+  return x < y ? -1 : x > y;
+}
+
+/*
+================
+Prof_Summary_f
+
+Percentiles of the inclusive time of each zone over the last frames
+================
+*/
+static void Prof_Summary_f(void) {
+  unsigned sorted[PROF_HISTORY];
+  int count;
+  int z;
+
+  count = prof_framecount < PROF_HISTORY ? prof_framecount : PROF_HISTORY;
+  if(!count) {
+    Com_Printf("No frames profiled, set profile 1\n");
+    return;
+  }
+
+  Com_Printf("%i frames, msec per frame\n", count);
+  Com_Printf("zone                         p50     p95     p99     max\n");
+  for(z = 0; z < prof_numzones; z++) {
+    memcpy(sorted, prof_zones[z].history, count * sizeof(sorted[0]));
+    qsort(sorted, count, sizeof(sorted[0]), Prof_SortUnsigned);
+    Com_Printf("%-24s %7.3f %7.3f %7.3f %7.3f\n", prof_zones[z].name, sorted[count * 50 / 100] / 1000.0,
+               sorted[count * 95 / 100] / 1000.0, sorted[count * 99 / 100] / 1000.0, sorted[count - 1] / 1000.0);
+  }
+}
+
+/*
+================
+Prof_Capture_f
+================
+*/
+static void Prof_Capture_f(void) {
+  int frames;
+  int i;
+
+  if(Cmd_Argc() != 2) {
+    Com_Printf("usage: profile_capture <frames>\n");
+    return;
+  }
+  if(prof_captureframes) {
+    Com_Printf("Already capturing\n");
+    return;
+  }
+
+  frames = atoi(Cmd_Argv(1));
+  if(frames < 1)
+    return;
+
+  Prof_Thread(); // make sure the main thread is the first one
+
+  for(i = 0; i < prof_numthreads; i++) {
+    prof_threads[i]->events = malloc(PROF_MAX_EVENTS * sizeof(profevent_t));
+    prof_threads[i]->numevents = 0;
+  }
+
+  // starts with the next frame
+  prof_capturestart = uv_hrtime();
+  prof_captureframes = prof_capturetotal = frames;
+}
+
+/*
+================
+Prof_Init
+================
+*/
+void Prof_Init(void) {
+  if(uv_key_create(&prof_threadkey) || uv_mutex_init(&prof_lock))
+    Com_Error(ERR_FATAL, "Prof_Init: couldn't create thread key");
+
+  profile = Cvar_Get("profile", "0", 0);
+  Cmd_AddCommand("profile_capture", Prof_Capture_f);
+  Cmd_AddCommand("profile_summary", Prof_Summary_f);
+
+  prof_initialized = true;
+}
@@ -80,6 +80,8 @@ typedef struct sizebuf_s {
   int maxsize;
   int cursize;
   int readcount;
+  int bitcursize;   // bits written by MSG_WriteBits, only used while inside data[cursize - 1]
+  int bitreadcount; // bits read by MSG_ReadBits, only used while inside data[readcount - 1]
 } sizebuf_t;
 
 void SZ_Init(sizebuf_t *buf, byte *data, int length);
@@ -106,8 +108,20 @@ void MSG_WriteAngle16(sizebuf_t *sb, float f);
 void MSG_WriteDeltaUsercmd(sizebuf_t *sb, struct usercmd_s *from, struct usercmd_s *cmd);
 void MSG_WriteDeltaEntity(struct entity_state_s *from, struct entity_state_s *to, sizebuf_t *msg, bool force,
                           bool newentity);
+void MSG_WriteDeltaPlayerstate(player_state_t *from, player_state_t *to, sizebuf_t *msg);
 void MSG_WriteDir(sizebuf_t *sb, vec3_t vector);
 
+// bit packed fields, least significant bit first.  Consecutive MSG_WriteBits
+// share bytes, any other write starts a new byte
+void MSG_WriteBits(sizebuf_t *sb, unsigned value, int bits);
+void MSG_WriteVarBits(sizebuf_t *sb, unsigned value); // 2 bit width selector, then 4, 8, 16 or 32 bits
+void MSG_WriteSignedVarBits(sizebuf_t *sb, int value); // zigzag, so small magnitudes stay short
+void MSG_WriteAlign(sizebuf_t *sb);                   // the next MSG_WriteBits starts a new byte
+void MSG_WritePackedEntityHeader(sizebuf_t *sb, int number, unsigned bits);
+void MSG_WritePackedDeltaEntity(struct entity_state_s *from, struct entity_state_s *to, sizebuf_t *msg, bool force,
+                                bool newentity);
+void MSG_WritePackedPlayerstate(player_state_t *from, player_state_t *to, sizebuf_t *msg, int msec);
+
 void MSG_BeginReading(sizebuf_t *sb);
 
 int MSG_ReadChar(sizebuf_t *sb);
@@ -127,6 +141,23 @@ void MSG_ReadDeltaUsercmd(sizebuf_t *sb, struct usercmd_s *from, struct usercmd_
 void MSG_ReadDir(sizebuf_t *sb, vec3_t vector);
 
 void MSG_ReadData(sizebuf_t *sb, void *buffer, int size);
+int MSG_ReadEntityBits(sizebuf_t *sb, unsigned *bits);
+void MSG_ReadDeltaEntity(sizebuf_t *sb, struct entity_state_s *to, int bits);
+void MSG_ReadDeltaPlayerstate(sizebuf_t *sb, player_state_t *state);
+
+unsigned MSG_ReadBits(sizebuf_t *sb, int bits);
+unsigned MSG_ReadVarBits(sizebuf_t *sb);
+int MSG_ReadSignedVarBits(sizebuf_t *sb);
+void MSG_ReadAlign(sizebuf_t *sb); // the next MSG_ReadBits starts a new byte
+int MSG_ReadPackedEntityBits(sizebuf_t *sb, unsigned *bits);
+void MSG_ReadPackedDeltaEntity(sizebuf_t *sb, struct entity_state_s *from, struct entity_state_s *to, int bits);
+void MSG_ReadPackedPlayerstate(sizebuf_t *sb, player_state_t *state, int msec);
+
+// what both ends of a packed delta guess before the error is applied
+int MSG_PackCoord(float f);
+int MSG_PackAngle(float f);
+void MSG_PredictEntityOrigin(const struct entity_state_s *from, int *origin);
+void MSG_PredictPmoveOrigin(const pmove_state_t *from, int msec, int *origin);
 
 //============================================================================
 
@@ -153,6 +184,7 @@ void COM_Init(void);
 void COM_InitArgv(int argc, char **argv);
 
 char *CopyString(const char *in);
+unsigned Com_HashKey(const char *name); // case insensitive
 
 //============================================================================
 
@@ -175,7 +207,8 @@ PROTOCOL
 
 // protocol.h -- communications protocols
 
-#define PROTOCOL_VERSION 34
+#define PROTOCOL_VERSION 35     // bit packed entity and playerstate deltas
+#define PROTOCOL_VERSION_OLD 34 // byte aligned deltas, still spoken to old clients and in server demos
 
 //=========================================
 
@@ -185,10 +218,20 @@ PROTOCOL
 
 //=========================================
 
-#define UPDATE_BACKUP 16 // copies of entity_state_t to keep buffered
+#define UPDATE_BACKUP 256 // copies of entity_state_t to keep buffered
 // must be power of two
 #define UPDATE_MASK (UPDATE_BACKUP - 1)
 
+// how far back a server deltas from, the 16 frames of a 10 Hz server.
+// At higher sv_fps this is more frames, 160 at the 100 Hz limit, never
+// more than UPDATE_BACKUP.  The server allocates only svs.update_backup
+// frames per client; the client does not know sv_fps until it has
+// connected, so it always keeps UPDATE_BACKUP
+#define UPDATE_BACKUP_MSEC 1600
+
+// the game dll's FRAMETIME, entities only move this often whatever sv_fps is
+#define GAME_FRAMEMSEC 100
+
 //==================
 // the svc_strings[] array in cl_parse.c should mirror this
 //==================
@@ -259,6 +302,13 @@ enum clc_ops_e {
 #define PS_RDFLAGS (1 << 14)
 #define PS_CMODEL_INDEX (1 << 15)
 
+// in PROTOCOL_VERSION the flags are one bit each, PS_COMMON first and the
+// rest behind a more bit.  PS_M_ORIGIN is the error from
+// MSG_PredictPmoveOrigin, the velocity, gravity and view angles are sent
+// as changes, and the stats follow a one bit changed flag
+#define PS_COMMON                                                                                                      \
+  (PS_M_ORIGIN | PS_M_VELOCITY | PS_VIEWOFFSET | PS_VIEWANGLES | PS_KICKANGLES | PS_WEAPONINDEX | PS_WEAPONFRAME)
+
 //==============================================
 
 // user_cmd_t communication
@@ -325,6 +375,46 @@ enum clc_ops_e {
 #define U_SOLID (1 << 27)
 #define U_CMODEL_INDEX (1 << 26)
 
+// entity_state_t communication in PROTOCOL_VERSION, bit packed
+//
+// [1] number >= 256 [8 or 10] number, a zero number ends the packet
+// [1] remove, nothing else follows
+// [1] origin changed [3] which axes
+// [1] angles changed [3] which angles
+// [1] frame [1] event
+// [1] more [11] the rarely changed fields below
+//
+// Origins are sent as the error from MSG_PredictEntityOrigin, the frame
+// and angles as the change from the delta base.  Every entity starts on
+// a byte boundary, so encoded entities can be copied between messages.
+#define EB_ORIGIN1 (1 << 0)
+#define EB_ORIGIN2 (1 << 1)
+#define EB_ORIGIN3 (1 << 2)
+#define EB_ANGLE1 (1 << 3)
+#define EB_ANGLE2 (1 << 4)
+#define EB_ANGLE3 (1 << 5)
+#define EB_REMOVE U_REMOVE // so the packet parser checks one bit for both protocols
+#define EB_FRAME (1 << 7)
+#define EB_EVENT (1 << 8)
+
+// behind the more bit
+#define EB_MODEL (1 << 9)
+#define EB_MODEL2 (1 << 10)
+#define EB_MODEL3 (1 << 11)
+#define EB_MODEL4 (1 << 12)
+#define EB_SKIN (1 << 13)
+#define EB_EFFECTS (1 << 14)
+#define EB_RENDERFX (1 << 15)
+#define EB_OLDORIGIN (1 << 16) // relative to the new origin
+#define EB_SOUND (1 << 17)
+#define EB_SOLID (1 << 18)
+#define EB_CMODEL_INDEX (1 << 19)
+
+#define EB_ORIGIN (EB_ORIGIN1 | EB_ORIGIN2 | EB_ORIGIN3)
+#define EB_ANGLES (EB_ANGLE1 | EB_ANGLE2 | EB_ANGLE3)
+#define EB_MORE 0x000ffe00
+#define EB_MOREBITS 11
+
 /*
 ==============================================================
 
@@ -541,6 +631,7 @@ void NET_Config(bool multiplayer);
 
 bool NET_GetPacket(netsrc_t sock, netadr_t *net_from, sizebuf_t *net_message);
 void NET_SendPacket(netsrc_t sock, int length, void *data, netadr_t to);
+void NET_Flush(void); // writes the packets queued by NET_SendPacket
 
 bool NET_CompareAdr(netadr_t a, netadr_t b);
 bool NET_CompareBaseAdr(netadr_t a, netadr_t b);
@@ -631,9 +722,18 @@ trace_t CM_BoxTrace(int cmodel_index, vec3_t start, vec3_t end, vec3_t mins, vec
 trace_t CM_TransformedBoxTrace(int cmodel_index, vec3_t start, vec3_t end, vec3_t mins, vec3_t maxs, int headnode,
                                int brushmask, vec3_t origin, vec3_t angles);
 
+// same as n calls to CM_BoxTrace with headnode 0, mins and maxs may be NULL
+void CM_BoxTraceBatch(int cmodel_index, int n, vec3_t *starts, vec3_t *ends, vec3_t mins, vec3_t maxs, int brushmask,
+                      trace_t *out);
+void CM_TraceBench_f(void);
+
 byte *CM_ClusterPVS(int cmodel_index, int cluster);
 byte *CM_ClusterPHS(int cmodel_index, int cluster);
 
+// thread safe versions, row must hold MAX_MAP_LEAFS / 8 bytes
+byte *CM_CopyClusterPVS(int cmodel_index, int cluster, byte *row);
+byte *CM_CopyClusterPHS(int cmodel_index, int cluster, byte *row);
+
 int CM_PointLeafnum(int cmodel_index, vec3_t p);
 
 // call with topnode set to the headnode, returns with topnode
@@ -672,6 +772,26 @@ extern float pm_airaccelerate;
 
 void Pmove(pmove_t *pmove);
 
+#define PM_CACHE_SIZE 64 // must match the client's CMD_BACKUP
+
+// the states earlier predictions reached, by command sequence
+typedef struct {
+  bool valid;
+  int base;     // sequence of the acknowledged state the moves start from
+  int sequence; // last command run
+  unsigned world;
+  float airaccelerate;
+  int cmodel_index;
+  pmove_state_t states[PM_CACHE_SIZE];
+  vec3_t viewangles[PM_CACHE_SIZE];
+} pmcache_t;
+
+// runs cmds ack + 1 to current - 1 from pm->s, the state the server
+// acknowledged ack with, reusing what cache holds while the server agrees
+// with it and world, a key for whatever pm->trace collides with, is the
+// same.  Only pm->s and pm->viewangles are set.  Returns the Pmove count.
+int Pmove_Predict(pmcache_t *cache, pmove_t *pm, const usercmd_t *cmds, int ack, int current, unsigned world);
+
 /*
 ==============================================================
 
@@ -699,6 +819,11 @@ void FS_Read(void *buffer, int len, FILE *f);
 
 void FS_FreeFile(void *buffer);
 
+int FS_MapFile(const char *path, const void **data);
+// read only view of the whole file, shared and reference counted by name
+// a -1 length is not present
+void FS_UnmapFile(const void *data);
+
 void FS_CreatePath(const char *path);
 
 int FS_LoadAsync(const char *path, void (*error)(void *ud), void (*done)(const void *, int, void *ud), void *ud);
@@ -706,6 +831,65 @@ int FS_LoadAsync(const char *path, void (*error)(void *ud), void (*done)(const v
 /*
 ==============================================================
 
+JOBS
+
+Fork/join worker threads for data parallel loops
+
+==============================================================
+*/
+
+typedef struct jobpool_s jobpool_t;
+typedef void (*jobfunc_t)(void *data, int worker, int numworkers);
+
+jobpool_t *Job_CreatePool(int numthreads);
+void Job_DestroyPool(jobpool_t *pool);
+int Job_PoolWorkers(jobpool_t *pool);
+// includes the calling thread, which is always worker 0
+
+void Job_Run(jobpool_t *pool, jobfunc_t func, void *data);
+// calls func on every worker and waits for all of them to return
+
+/*
+==============================================================
+
+PROFILER
+
+Nested timing zones, per thread, collected while "profile" is set
+or a profile_capture is running
+
+==============================================================
+*/
+
+void Prof_Init(void);
+void Prof_BeginFrame(void);
+void Prof_EndFrame(void);
+
+void Prof_Begin(const char *name);
+void Prof_End(void);
+// name must stay valid for the rest of the run, use string constants
+
+float Prof_ZoneMsec(const char *name);
+
+/*
+==============================================================
+
+COMPRESSION
+
+Fast LZ77 blocks, for data written often and read rarely
+
+==============================================================
+*/
+
+int LZ_CompressBound(int inlen);
+int LZ_Compress(const byte *in, int inlen, byte *out, int outmax);
+// returns the compressed length, -1 if outmax is under LZ_CompressBound
+
+int LZ_Decompress(const byte *in, int inlen, byte *out, int outmax);
+// returns the decompressed length, -1 for a damaged block
+
+/*
+==============================================================
+
 MISC
 
 ==============================================================
@@ -745,20 +929,16 @@ extern cvar_t *log_stats;
 
 extern FILE *log_stats_file;
 
-// host_speeds times
-extern int time_before_game;
-extern int time_after_game;
-extern int time_before_ref;
-extern int time_after_ref;
-
 void Z_Free(void *ptr);
 void *Z_Malloc(int size); // returns 0 filled memory
 void *Z_TagMalloc(int size, int tag);
 void Z_FreeTags(int tag);
+void Z_ReleaseArenas(void); // frees the arenas of tags with nothing allocated
 
 void Qcommon_Init(int argc, char **argv);
 void Qcommon_Frame(int msec);
 int Qcommon_RunFrames(void);
+void Qcommon_Sleep(int msec); // next frame within msec, dedicated servers only
 void Qcommon_Shutdown(void);
 
 #define NUMVERTEXNORMALS 162
@@ -8,27 +8,39 @@
 
 #define SQL_QUERY_BIND_ARGS_column_text(...)
 #define SQL_QUERY_BIND_ARGS_column_int64(...)
+#define SQL_QUERY_BIND_ARGS_column_blob(...)
 #define SQL_QUERY_BIND_ARGS_bind_text(index, name) const char *name,
+#define SQL_QUERY_BIND_ARGS_bind_blob(index, name) const void *name, int name##_size,
 #define SQL_QUERY_BIND_ARGS(X) ALIAS_CPP_CAT(SQL_QUERY_BIND_ARGS_, X)
 
 #define SQL_QUERY_BIND_column_text(...)
 #define SQL_QUERY_BIND_column_int64(...)
+#define SQL_QUERY_BIND_column_blob(...)
 #define SQL_QUERY_BIND_bind_text(index, name) sqlite3_bind_text(stmt, index + 1, name, -1, SQLITE_STATIC);
+#define SQL_QUERY_BIND_bind_blob(index, name) sqlite3_bind_blob(stmt, index + 1, name, name##_size, SQLITE_STATIC);
 #define SQL_QUERY_BIND(X) ALIAS_CPP_CAT(SQL_QUERY_BIND_, X)
 
 #define SQL_QUERY_CALLBACK_ARGS_bind_text(...)
 #define SQL_QUERY_CALLBACK_ARGS_column_text(index, name) , const char *name
 #define SQL_QUERY_CALLBACK_ARGS_column_int64(index, name) , int64_t name
+#define SQL_QUERY_CALLBACK_ARGS_bind_blob(...)
+#define SQL_QUERY_CALLBACK_ARGS_column_blob(index, name) , const void *name, int name##_size
 #define SQL_QUERY_CALLBACK_ARGS(X) ALIAS_CPP_CAT(SQL_QUERY_CALLBACK_ARGS_, X)
 
 #define SQL_QUERY_EXTRACT_bind_text(...)
 #define SQL_QUERY_EXTRACT_column_text(index, name) const char *name = sqlite3_column_text(stmt, index);
 #define SQL_QUERY_EXTRACT_column_int64(index, name) sqlite3_int64 name = sqlite3_column_int64(stmt, index);
+#define SQL_QUERY_EXTRACT_bind_blob(...)
+#define SQL_QUERY_EXTRACT_column_blob(index, name)                                                                     \
+  const void *name = sqlite3_column_blob(stmt, index);                                                                 \
+  int name##_size = sqlite3_column_bytes(stmt, index);
 #define SQL_QUERY_EXTRACT(X) ALIAS_CPP_CAT(SQL_QUERY_EXTRACT_, X)
 
 #define SQL_QUERY_PASS_bind_text(...)
 #define SQL_QUERY_PASS_column_text(index, name) , name
 #define SQL_QUERY_PASS_column_int64(index, name) , name
+#define SQL_QUERY_PASS_bind_blob(...)
+#define SQL_QUERY_PASS_column_blob(index, name) , name, name##_size
 #define SQL_QUERY_PASS(X) ALIAS_CPP_CAT(SQL_QUERY_PASS_, X)
 
 #define SQL_QUERY(NAME, DB, SQL, ...)                                                                                  \
@@ -278,32 +278,24 @@ struct SH1 R_LightPoint(int cmodel_index, vec3_t p) {
 
 //===================================================================
 
-static struct {
-  uint32_t num_blocklights;
-  struct SH1 *blocklights;
-} _ = {0};
-
 /*
 ===============
-R_AddDynamicLights
+R_SurfaceDynamicLights
+
+Projects the dynamic lights that touch surf onto its lightmap, returns
+how many were written to dlights
 ===============
 */
-void R_AddDynamicLights(msurface_t *surf) {
+int R_SurfaceDynamicLights(msurface_t *surf, lmdlight_t *dlights) {
   int lnum;
-  int sd, td;
   float fdist, frad, fminlight;
-  vec3_t impact, local;
-  int s, t;
-  int i;
-  int smax, tmax;
+  vec3_t impact;
+  int i, numdlights;
   mtexinfo_t *tex;
   dlight_t *dl;
-  struct SH1 *pfBL;
-  float fsacc, ftacc;
 
-  smax = (surf->extents[0] >> 4) + 1;
-  tmax = (surf->extents[1] >> 4) + 1;
   tex = surf->texinfo;
+  numdlights = 0;
 
   for(lnum = 0; lnum < r_newrefdef.num_dlights; lnum++) {
     if(!(surf->dlightbits & (1 << lnum)))
@@ -324,32 +316,15 @@ void R_AddDynamicLights(msurface_t *surf) {
       impact[i] = dl->origin[i] - surf->plane->normal[i] * fdist;
     }
 
-    local[0] = DotProduct(impact, tex->vecs[0]) + tex->vecs[0][3] - surf->texturemins[0];
-    local[1] = DotProduct(impact, tex->vecs[1]) + tex->vecs[1][3] - surf->texturemins[1];
-
-    pfBL = _.blocklights;
-    for(t = 0, ftacc = 0; t < tmax; t++, ftacc += 16) {
-      td = local[1] - ftacc;
-      if(td < 0)
-        td = -td;
-
-      for(s = 0, fsacc = 0; s < smax; s++, fsacc += 16, pfBL++) {
-        sd = (int)(local[0] - fsacc);
-
-        if(sd < 0)
-          sd = -sd;
-
-        if(sd > td)
-          fdist = sd + (td >> 1);
-        else
-          fdist = td + (sd >> 1);
-
-        if(fdist < fminlight) {
-          *pfBL = SH1_Add(*pfBL, SH1_Scale(SH1_FromDirectionalLight(vec3_origin, dl->color), frad - fdist));
-        }
-      }
-    }
+    dlights[numdlights].local[0] = DotProduct(impact, tex->vecs[0]) + tex->vecs[0][3] - surf->texturemins[0];
+    dlights[numdlights].local[1] = DotProduct(impact, tex->vecs[1]) + tex->vecs[1][3] - surf->texturemins[1];
+    dlights[numdlights].rad = frad;
+    dlights[numdlights].minlight = fminlight;
+    VectorCopy(dl->color, dlights[numdlights].color);
+    numdlights++;
   }
+
+  return numdlights;
 }
 
 /*
@@ -365,186 +340,50 @@ void R_SetCacheState(msurface_t *surf) {
 
 /*
 ===============
-R_BuildLightMap
+R_SetupLightMap
 
-Combine and scale multiple lightmaps into the floating format in blocklights
+Fills in what LM_BuildLightmap needs from the surface and the current
+lightstyles and dynamic lights.  dlights must hold MAX_DLIGHTS.
 ===============
 */
-void R_BuildLightMap(msurface_t *surf, byte *dest_rgb0, byte *dest_r1, byte *dest_g1, byte *dest_b1, int stride) {
-  int smax, tmax;
-  float max;
-  int i, j, size;
-  byte *lightmap_rgb0, *lightmap_r1, *lightmap_g1, *lightmap_b1;
-  float scale[4];
-  int nummaps;
-  struct SH1 *bl;
-  lightstyle_t *style;
-  int monolightmap;
-
-  smax = (surf->extents[0] >> 4) + 1;
-  tmax = (surf->extents[1] >> 4) + 1;
-  size = smax * tmax;
-  if(size > _.num_blocklights) {
-    _.num_blocklights = size + 1;
-    _.num_blocklights += _.num_blocklights >> 1;
-    _.blocklights = realloc(_.blocklights, _.num_blocklights * sizeof(*_.blocklights));
-  }
-
-  // set to half bright if no light data
-  if(!surf->samples) {
-    int maps;
+void R_SetupLightMap(msurface_t *surf, lmsurface_t *out, lmdlight_t *dlights) {
+  int maps, i;
 
-    for(i = 0; i < size; i++) {
-      _.blocklights[i].f[0] = _.blocklights[i].f[4] = _.blocklights[i].f[8] = 127;
-      _.blocklights[i].f[1] = _.blocklights[i].f[2] = _.blocklights[i].f[3] = 0;
-      _.blocklights[i].f[5] = _.blocklights[i].f[6] = _.blocklights[i].f[7] = 0;
-      _.blocklights[i].f[9] = _.blocklights[i].f[10] = _.blocklights[i].f[11] = 0;
-    }
-
-    for(maps = 0; maps < MAXLIGHTMAPS && surf->styles[maps] != 255; maps++) {
-      style = &r_newrefdef.lightstyles[surf->styles[maps]];
-    }
-    goto store;
-  }
-
-  // count the # of maps
-  for(nummaps = 0; nummaps < MAXLIGHTMAPS && surf->styles[nummaps] != 255; nummaps++)
-    ;
-
-  lightmap_rgb0 = surf->samples + (size * 3) * 0;
-  lightmap_r1 = surf->samples + (size * 3) * 1;
-  lightmap_g1 = surf->samples + (size * 3) * 2;
-  lightmap_b1 = surf->samples + (size * 3) * 3;
-
-  // add all the lightmaps
-  if(nummaps == 1) {
-    int maps;
-
-    for(maps = 0; maps < MAXLIGHTMAPS && surf->styles[maps] != 255; maps++) {
-      bl = _.blocklights;
-
-      for(i = 0; i < 3; i++)
-        scale[i] = gl_modulate->value * r_newrefdef.lightstyles[surf->styles[maps]].rgb[i];
-
-      for(i = 0; i < size; i++) {
-        struct SH1 color;
-
-        color.f[0] = lightmap_rgb0[i * 3 + 0] - 0.5f;
-        color.f[4] = lightmap_rgb0[i * 3 + 1] - 0.5f;
-        color.f[8] = lightmap_rgb0[i * 3 + 2] - 0.5f;
-        color.f[1] = lightmap_r1[i * 3 + 0] - 0.5f;
-        color.f[2] = lightmap_r1[i * 3 + 1] - 0.5f;
-        color.f[3] = lightmap_r1[i * 3 + 2] - 0.5f;
-        color.f[5] = lightmap_g1[i * 3 + 0] - 0.5f;
-        color.f[6] = lightmap_g1[i * 3 + 1] - 0.5f;
-        color.f[7] = lightmap_g1[i * 3 + 2] - 0.5f;
-        color.f[9] = lightmap_b1[i * 3 + 0] - 0.5f;
-        color.f[10] = lightmap_b1[i * 3 + 1] - 0.5f;
-        color.f[11] = lightmap_b1[i * 3 + 2] - 0.5f;
-
-        for(int component = 0; component < 3; component++) {
-          for(int basis = 0; basis < 3; basis++) {
-            color.f[component * 4 + basis + 1] -= 127.0f;
-            color.f[component * 4 + basis + 1] *= 2;
-          }
-        }
-
-        bl[i] = SH1_ColorScale(color, scale);
-      }
+  out->smax = (surf->extents[0] >> 4) + 1;
+  out->tmax = (surf->extents[1] >> 4) + 1;
+  out->samples = surf->samples;
 
-      // skip to next lightmap
-      lightmap_rgb0 += size * 3 * 4;
-      lightmap_r1 += size * 3 * 4;
-      lightmap_g1 += size * 3 * 4;
-      lightmap_b1 += size * 3 * 4;
-    }
-  } else {
-    int maps;
-
-    memset(_.blocklights, 0, sizeof(_.blocklights[0]) * size);
-
-    for(maps = 0; maps < MAXLIGHTMAPS && surf->styles[maps] != 255; maps++) {
-      bl = _.blocklights;
-
-      for(i = 0; i < 3; i++)
-        scale[i] = gl_modulate->value * r_newrefdef.lightstyles[surf->styles[maps]].rgb[i];
-
-      for(i = 0; i < size; i++) {
-        struct SH1 color;
-
-        color.f[0] = lightmap_rgb0[i * 3 + 0] - 0.5f;
-        color.f[4] = lightmap_rgb0[i * 3 + 1] - 0.5f;
-        color.f[8] = lightmap_rgb0[i * 3 + 2] - 0.5f;
-        color.f[1] = lightmap_r1[i * 3 + 0] - 0.5f;
-        color.f[2] = lightmap_r1[i * 3 + 1] - 0.5f;
-        color.f[3] = lightmap_r1[i * 3 + 2] - 0.5f;
-        color.f[5] = lightmap_g1[i * 3 + 0] - 0.5f;
-        color.f[6] = lightmap_g1[i * 3 + 1] - 0.5f;
-        color.f[7] = lightmap_g1[i * 3 + 2] - 0.5f;
-        color.f[9] = lightmap_b1[i * 3 + 0] - 0.5f;
-        color.f[10] = lightmap_b1[i * 3 + 1] - 0.5f;
-        color.f[11] = lightmap_b1[i * 3 + 2] - 0.5f;
-
-        for(int component = 0; component < 3; component++) {
-          for(int basis = 0; basis < 3; basis++) {
-            color.f[component * 4 + basis + 1] -= 127.0f;
-            color.f[component * 4 + basis + 1] *= 2;
-          }
-        }
-
-        bl[i] = SH1_ColorScale(color, scale);
-      }
-    }
-    // skip to next lightmap
-    lightmap_rgb0 += size * 3 * 4;
-    lightmap_r1 += size * 3 * 4;
-    lightmap_g1 += size * 3 * 4;
-    lightmap_b1 += size * 3 * 4;
+  for(maps = 0; maps < MAXLIGHTMAPS && surf->styles[maps] != 255; maps++) {
+    for(i = 0; i < 3; i++)
+      out->stylescale[maps][i] = gl_modulate->value * r_newrefdef.lightstyles[surf->styles[maps]].rgb[i];
   }
+  out->numstyles = maps;
 
   // add all the dynamic lights
+  out->numdlights = 0;
+  out->dlights = dlights;
   if(surf->dlightframe == r_framecount)
-    R_AddDynamicLights(surf);
-
-// put into texture format
-store:
-  // stride -= (smax << 2);
-  bl = _.blocklights;
-
-  for(i = 0; i < tmax; i++, dest_rgb0 += stride, dest_r1 += stride, dest_g1 += stride, dest_b1 += stride) {
-    for(j = 0; j < smax; j++) {
-      struct SH1 color = SH1_NormalizeMaximum(*bl, 254.5f, NULL);
-
-      for(int component = 0; component < 3; component++) {
-        if(color.f[component * 4 + 0] > 255)
-          assert(0);
-
-        for(int basis = 0; basis < 3; basis++) {
-          color.f[component * 4 + basis + 1] *= 0.5f;
-          color.f[component * 4 + basis + 1] += 127.0f;
-
-          if(color.f[component * 4 + basis + 1] > 255)
-            assert(0);
-        }
-      }
-
-      dest_rgb0[j * 3 + 0] = (byte)(color.f[0] + 0.5f);
-      dest_rgb0[j * 3 + 1] = (byte)(color.f[4] + 0.5f);
-      dest_rgb0[j * 3 + 2] = (byte)(color.f[8] + 0.5f);
-
-      dest_r1[j * 3 + 0] = (byte)(color.f[1] + 0.5f);
-      dest_r1[j * 3 + 1] = (byte)(color.f[2] + 0.5f);
-      dest_r1[j * 3 + 2] = (byte)(color.f[3] + 0.5f);
-
-      dest_g1[j * 3 + 0] = (byte)(color.f[5] + 0.5f);
-      dest_g1[j * 3 + 1] = (byte)(color.f[6] + 0.5f);
-      dest_g1[j * 3 + 2] = (byte)(color.f[7] + 0.5f);
+    out->numdlights = R_SurfaceDynamicLights(surf, dlights);
+}
 
-      dest_b1[j * 3 + 0] = (byte)(color.f[9] + 0.5f);
-      dest_b1[j * 3 + 1] = (byte)(color.f[10] + 0.5f);
-      dest_b1[j * 3 + 2] = (byte)(color.f[11] + 0.5f);
+/*
+===============
+R_BuildLightMap
 
-      bl++;
-    }
-  }
+Combine and scale multiple lightmaps into the four planes at dest_*
+===============
+*/
+void R_BuildLightMap(msurface_t *surf, byte *dest_rgb0, byte *dest_r1, byte *dest_g1, byte *dest_b1, int stride) {
+  static lmscratch_t scratch;
+  lmdlight_t dlights[MAX_DLIGHTS];
+  lmsurface_t lm;
+
+  R_SetupLightMap(surf, &lm, dlights);
+  lm.dest[0] = dest_rgb0;
+  lm.dest[1] = dest_r1;
+  lm.dest[2] = dest_g1;
+  lm.dest[3] = dest_b1;
+  lm.stride = stride;
+
+  LM_BuildLightmap(&lm, &scratch);
 }
@@ -0,0 +1,341 @@
+/*
+Copyright (C) 1997-2001 Id Software, Inc.
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+// gl_lightmap.c -- lightstyle blending, dynamic light falloff and packing
+// of surface lightmaps
+//
+// The working space keeps the four sample planes (rgb0, r1, g1, b1) as
+// floats in the same interleaved layout as the bsp samples and the
+// textures, so every pass is a straight run over memory.  Nothing here
+// touches GL or the refresh globals, the caller fills in an lmsurface_t.
+
+#include "../qcommon/qcommon.h"
+
+#include "gl_lightmap.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define LM_SSE2
+#include <emmintrin.h>
+#endif
+
+static bool lm_simd = true;
+
+void LM_SetSIMD(bool enable) { lm_simd = enable; }
+
+bool LM_SIMD(void) {
+#ifdef LM_SSE2
+  return lm_simd;
+#else
+  return false;
+#endif
+}
+
+/*
+================
+LM_BlendPlane
+
+dst[k] = (first ? 0 : dst[k]) + src[k] * mul[k % 3] + add[k % 3]
+================
+*/
+static void LM_BlendPlane(float *dst, const byte *src, int n, const float mul[3], const float add[3], bool first) {
+  int k = 0;
+
+#ifdef LM_SSE2
+  if(lm_simd) {
+    __m128i zero = _mm_setzero_si128();
+    __m128 m[3], a[3];
+    int r, j, i;
+
+    // 48 values are a whole number of both triplets and vectors, so the
+    // channel pattern of the n-th vector in a block is always n % 3
+    for(r = 0; r < 3; r++) {
+      m[r] = _mm_setr_ps(mul[r], mul[(r + 1) % 3], mul[(r + 2) % 3], mul[r]);
+      a[r] = _mm_setr_ps(add[r], add[(r + 1) % 3], add[(r + 2) % 3], add[r]);
+    }
+
+    for(; k + 48 <= n; k += 48) {
+      for(j = 0; j < 3; j++) {
+        __m128i bytes = _mm_loadu_si128((const __m128i *)(src + k + j * 16));
+        __m128i lo = _mm_unpacklo_epi8(bytes, zero);
+        __m128i hi = _mm_unpackhi_epi8(bytes, zero);
+        __m128 v[4];
+
+        v[0] = _mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, zero));
+        v[1] = _mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, zero));
+        v[2] = _mm_cvtepi32_ps(_mm_unpacklo_epi16(hi, zero));
+        v[3] = _mm_cvtepi32_ps(_mm_unpackhi_epi16(hi, zero));
+
+        for(i = 0; i < 4; i++) {
+          float *out = dst + k + j * 16 + i * 4;
+          int p = (j * 4 + i) % 3;
+          __m128 x = _mm_add_ps(_mm_mul_ps(v[i], m[p]), a[p]);
+
+          if(!first)
+            x = _mm_add_ps(_mm_loadu_ps(out), x);
+          _mm_storeu_ps(out, x);
+        }
+      }
+    }
+  }
+#endif
+
+  for(; k < n; k++) {
+    float x = src[k] * mul[k % 3] + add[k % 3];
+
+    dst[k] = first ? x : dst[k] + x;
+  }
+}
+
+/*
+================
+LM_AddDynamicLights
+
+Dynamic lights only add to the ambient rgb0 plane
+================
+*/
+static void LM_AddDynamicLights(float *bl, int smax, int tmax, const lmdlight_t *dlights, int numdlights) {
+  const lmdlight_t *dl;
+  float *row;
+  float fsacc, ftacc, fdist;
+  int n, s, t, sd, td;
+
+  for(n = 0, dl = dlights; n < numdlights; n++, dl++) {
+    row = bl;
+    for(t = 0, ftacc = 0; t < tmax; t++, ftacc += 16, row += smax * 3) {
+      td = dl->local[1] - ftacc;
+      if(td < 0)
+        td = -td;
+
+      s = 0;
+
+#ifdef LM_SSE2
+      if(lm_simd) {
+        __m128i vtd = _mm_set1_epi32(td);
+        __m128i vtd2 = _mm_set1_epi32(td >> 1);
+        __m128 local = _mm_set1_ps(dl->local[0]);
+        __m128 rad = _mm_set1_ps(dl->rad);
+        __m128 minlight = _mm_set1_ps(dl->minlight);
+        __m128 c0 = _mm_setr_ps(dl->color[0], dl->color[1], dl->color[2], dl->color[0]);
+        __m128 c1 = _mm_setr_ps(dl->color[1], dl->color[2], dl->color[0], dl->color[1]);
+        __m128 c2 = _mm_setr_ps(dl->color[2], dl->color[0], dl->color[1], dl->color[2]);
+        __m128 fs = _mm_setr_ps(0, 16, 32, 48);
+        __m128 step = _mm_set1_ps(64);
+
+        for(; s + 4 <= smax; s += 4, fs = _mm_add_ps(fs, step)) {
+          __m128i vsd = _mm_cvttps_epi32(_mm_sub_ps(local, fs));
+          __m128i sign = _mm_srai_epi32(vsd, 31);
+          __m128i gt, far, near;
+          __m128 w, vdist;
+          float *out = row + s * 3;
+
+          vsd = _mm_sub_epi32(_mm_xor_si128(vsd, sign), sign);
+
+          // the same octagonal distance as the scalar loop
+          gt = _mm_cmpgt_epi32(vsd, vtd);
+          far = _mm_add_epi32(vsd, vtd2);
+          near = _mm_add_epi32(vtd, _mm_srai_epi32(vsd, 1));
+          vdist = _mm_cvtepi32_ps(_mm_or_si128(_mm_and_si128(gt, far), _mm_andnot_si128(gt, near)));
+          w = _mm_and_ps(_mm_cmplt_ps(vdist, minlight), _mm_sub_ps(rad, vdist));
+
+          // spread the four weights over the twelve interleaved channels
+          _mm_storeu_ps(out + 0, _mm_add_ps(_mm_loadu_ps(out + 0),
+                                            _mm_mul_ps(_mm_shuffle_ps(w, w, _MM_SHUFFLE(1, 0, 0, 0)), c0)));
+          _mm_storeu_ps(out + 4, _mm_add_ps(_mm_loadu_ps(out + 4),
+                                            _mm_mul_ps(_mm_shuffle_ps(w, w, _MM_SHUFFLE(2, 2, 1, 1)), c1)));
+          _mm_storeu_ps(out + 8, _mm_add_ps(_mm_loadu_ps(out + 8),
+                                            _mm_mul_ps(_mm_shuffle_ps(w, w, _MM_SHUFFLE(3, 3, 3, 2)), c2)));
+        }
+      }
+#endif
+
+      for(fsacc = s * 16; s < smax; s++, fsacc += 16) {
+        sd = (int)(dl->local[0] - fsacc);
+        if(sd < 0)
+          sd = -sd;
+
+        if(sd > td)
+          fdist = sd + (td >> 1);
+        else
+          fdist = td + (sd >> 1);
+
+        if(fdist < dl->minlight) {
+          row[s * 3 + 0] += dl->color[0] * (dl->rad - fdist);
+          row[s * 3 + 1] += dl->color[1] * (dl->rad - fdist);
+          row[s * 3 + 2] += dl->color[2] * (dl->rad - fdist);
+        }
+      }
+    }
+  }
+}
+
+/*
+================
+LM_StoreRow
+
+dest[k] = clamp(src[k] * scales[k] * mul + add), truncated
+================
+*/
+static void LM_StoreRow(byte *dest, const float *src, const float *scales, int n, float mul, float add) {
+  int k = 0;
+
+#ifdef LM_SSE2
+  if(lm_simd) {
+    __m128 m = _mm_set1_ps(mul);
+    __m128 a = _mm_set1_ps(add);
+    __m128i i0, i1, i2, i3;
+
+#define LM_STORE_CONVERT(o)                                                                                            \
+  _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(_mm_mul_ps(_mm_loadu_ps(src + k + o), _mm_loadu_ps(scales + k + o)), m), a))
+
+    // the saturating packs do the clamping
+    for(; k + 16 <= n; k += 16) {
+      i0 = LM_STORE_CONVERT(0);
+      i1 = LM_STORE_CONVERT(4);
+      i2 = LM_STORE_CONVERT(8);
+      i3 = LM_STORE_CONVERT(12);
+      _mm_storeu_si128((__m128i *)(dest + k), _mm_packus_epi16(_mm_packs_epi32(i0, i1), _mm_packs_epi32(i2, i3)));
+    }
+
+#undef LM_STORE_CONVERT
+  }
+#endif
+
+  for(; k < n; k++) {
+    float x = src[k] * scales[k] * mul + add;
+
+    dest[k] = x < 0 ? 0 : x > 255 ? 255 : (byte)x;
+  }
+}
+
+/*
+================
+LM_StoreLightmap
+
+Luxels brighter than the texture can hold are scaled down as a whole,
+keeping their hue and direction.  The direction planes are stored at
+half scale around 127.5.
+================
+*/
+static void LM_StoreLightmap(const lmsurface_t *surf, lmscratch_t *scratch) {
+  int size = surf->smax * surf->tmax;
+  int rowsize = surf->smax * 3;
+  const float *bl = scratch->blocklights;
+  const float *src, *scales;
+  float *sc = scratch->scales;
+  float max, scale;
+  byte *dest;
+  int i, p, t;
+
+  for(i = 0; i < size; i++, bl += 3, sc += 3) {
+    max = bl[0] > bl[1] ? bl[0] : bl[1];
+    max = max > bl[2] ? max : bl[2];
+    scale = max > 254.5f ? 254.5f / max : 1;
+    sc[0] = sc[1] = sc[2] = scale;
+  }
+
+  for(p = 0; p < 4; p++) {
+    src = scratch->blocklights + p * size * 3;
+    scales = scratch->scales;
+    dest = surf->dest[p];
+
+    for(t = 0; t < surf->tmax; t++, src += rowsize, scales += rowsize, dest += surf->stride)
+      LM_StoreRow(dest, src, scales, rowsize, p ? 0.5f : 1, p ? 127.5f : 0.5f);
+  }
+}
+
+/*
+================
+LM_BuildLightmap
+
+Combine and scale the lightstyles of a surface, add its dynamic lights
+and write the four planes out in texture format
+================
+*/
+void LM_BuildLightmap(const lmsurface_t *surf, lmscratch_t *scratch) {
+  const byte *samples;
+  float mul[3], add[3];
+  float *bl;
+  int size, map, p, c, i;
+
+  size = surf->smax * surf->tmax;
+  if(size > scratch->size) {
+    scratch->size = size + (size >> 1);
+    scratch->blocklights = realloc(scratch->blocklights, scratch->size * 12 * sizeof(float));
+    scratch->scales = realloc(scratch->scales, scratch->size * 3 * sizeof(float));
+  }
+  bl = scratch->blocklights;
+
+  // set to half bright if no light data
+  if(!surf->samples) {
+    for(i = 0; i < size * 3; i++)
+      bl[i] = 127;
+    memset(bl + size * 3, 0, size * 9 * sizeof(float));
+    LM_StoreLightmap(surf, scratch);
+    return;
+  }
+
+  if(!surf->numstyles)
+    memset(bl, 0, size * 12 * sizeof(float));
+
+  samples = surf->samples;
+  for(map = 0; map < surf->numstyles; map++, samples += size * 3 * 4) {
+    const float *scale = surf->stylescale[map];
+
+    // rgb0 is the ambient color
+    for(c = 0; c < 3; c++) {
+      mul[c] = scale[c];
+      add[c] = -0.5f * scale[c];
+    }
+    LM_BlendPlane(bl, samples, size * 3, mul, add, map == 0);
+
+    // r1, g1 and b1 are the directions of one color each, biased and halved
+    for(p = 1; p < 4; p++) {
+      for(c = 0; c < 3; c++) {
+        mul[c] = 2 * scale[p - 1];
+        add[c] = -255 * scale[p - 1];
+      }
+      LM_BlendPlane(bl + p * size * 3, samples + p * size * 3, size * 3, mul, add, map == 0);
+    }
+  }
+
+  LM_AddDynamicLights(bl, surf->smax, surf->tmax, surf->dlights, surf->numdlights);
+
+  LM_StoreLightmap(surf, scratch);
+}
+
+/*
+================
+LM_BuildLightmapsJob
+
+Every worker builds every Nth surface of the batch into its own scratch
+================
+*/
+void LM_BuildLightmapsJob(void *data, int worker, int numworkers) {
+  lmbatch_t *batch = data;
+  int i;
+
+  for(i = worker; i < batch->numsurfaces; i += numworkers)
+    LM_BuildLightmap(&batch->surfaces[i], &batch->scratch[worker]);
+}
+
+void LM_FreeScratch(lmscratch_t *scratch) {
+  free(scratch->blocklights);
+  free(scratch->scales);
+  memset(scratch, 0, sizeof(*scratch));
+}
@@ -0,0 +1,71 @@
+/*
+Copyright (C) 1997-2001 Id Software, Inc.
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+// gl_lightmap.h -- lightmap building kernels, free of any GL state
+//
+// include qcommon.h (or gl_local.h) first
+
+#ifndef GL_LIGHTMAP_H
+#define GL_LIGHTMAP_H
+
+#include <stdbool.h>
+
+// a dynamic light already projected onto a surface
+typedef struct {
+  float local[2]; // texture space position relative to texturemins
+  float rad;      // intensity left on the plane
+  float minlight; // luxels at this distance or further are not lit
+  float color[3];
+} lmdlight_t;
+
+// everything needed to build one surface lightmap
+typedef struct {
+  int smax, tmax;
+  const byte *samples; // NULL is half bright
+  int numstyles;
+  float stylescale[MAXLIGHTMAPS][3]; // gl_modulate * lightstyle rgb
+
+  int numdlights;
+  const lmdlight_t *dlights;
+
+  byte *dest[4]; // rgb0, r1, g1, b1
+  int stride;
+} lmsurface_t;
+
+// per thread working space, grown on demand
+typedef struct {
+  int size;
+  float *blocklights; // four planes of size * 3, laid out like the samples
+  float *scales;      // size * 3
+} lmscratch_t;
+
+typedef struct {
+  int numsurfaces;
+  lmsurface_t *surfaces;
+  lmscratch_t *scratch; // one per worker
+} lmbatch_t;
+
+void LM_SetSIMD(bool enable);
+bool LM_SIMD(void);
+
+void LM_BuildLightmap(const lmsurface_t *surf, lmscratch_t *scratch);
+void LM_BuildLightmapsJob(void *data, int worker, int numworkers);
+void LM_FreeScratch(lmscratch_t *scratch);
+
+#endif
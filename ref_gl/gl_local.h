@@ -305,6 +305,7 @@ typedef enum {
 } rserr_t;
 
 #include "gl_model.h"
+#include "gl_lightmap.h"
 
 void GL_BeginRendering(int *x, int *y, int *width, int *height);
 void GL_EndRendering(void);
@@ -365,6 +366,10 @@ extern cvar_t *r_fullbright;
 extern cvar_t *r_novis;
 extern cvar_t *r_nocull;
 extern cvar_t *r_lerpmodels;
+extern cvar_t *gl_mesh_threads;
+extern cvar_t *gl_mesh_simd;
+extern cvar_t *gl_lightmap_threads;
+extern cvar_t *gl_lightmap_simd;
 
 extern cvar_t *r_lightlevel; // FIXME: This is a HACK to get the client's light level
 
@@ -444,12 +449,17 @@ bool R_Init(void *hinstance, void *hWnd);
 void R_Shutdown(void);
 
 void R_RenderView(refdef_t *fd);
+jobpool_t *R_CreateJobPool(cvar_t *threads, int *numworkers);
 void GL_ScreenShot_f(void);
 void R_DrawAliasModel(entity_t *e);
+void R_InitMeshThreads(void);
+void R_ShutdownMeshThreads(void);
 void R_DrawBrushModel(entity_t *e);
 void R_DrawSpriteModel(entity_t *e);
 void R_DrawBeam(entity_t *e);
 void R_DrawWorld(int cmodel_index);
+void R_InitLightmapThreads(void);
+void R_ShutdownLightmapThreads(void);
 void R_RenderDlights(void);
 void R_DrawAlphaSurfaces(void);
 void R_RenderBrushPoly(msurface_t *fa);
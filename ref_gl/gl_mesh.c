@@ -145,6 +145,30 @@ static struct GL_DrawState draw_state_opaque_depthhack = {DRAW_STATE, NO_SHELL,
 static struct GL_DrawState draw_state_transparent = {DRAW_STATE, NO_SHELL, TRANSPARENT, NO_DEPTH_HACK};
 static struct GL_DrawState draw_state_transparent_depthhack = {DRAW_STATE, NO_SHELL, TRANSPARENT, DEPTH_HACK};
 
+// meshes smaller than this are not worth waking the workers for
+#define MESH_THREAD_VERTEXES 256
+
+static jobpool_t *mesh_pool;
+
+/*
+=================
+R_InitMeshThreads
+
+gl_mesh_threads is the number of threads that skin and blend alias
+models, 0 or 1 keeps it all on the render thread.  Read on vid_restart.
+=================
+*/
+void R_InitMeshThreads(void) {
+  int numworkers;
+
+  mesh_pool = R_CreateJobPool(gl_mesh_threads, &numworkers);
+}
+
+void R_ShutdownMeshThreads(void) {
+  ri.Job_DestroyPool(mesh_pool);
+  mesh_pool = NULL;
+}
+
 /*
 =================
 R_DrawAliasModel
@@ -399,8 +423,18 @@ void R_DrawAliasModel(entity_t *e) {
                        .type_length = 4},
     };
 
-    RenderMesh_render_lerp_shaped(render_mesh, &output, currententity->frame, currententity->oldframe,
-                                  currententity->backlerp);
+    struct RenderMesh_frame frame;
+    struct RenderMesh_job job = {.frame = &frame, .output = &output};
+
+    RenderMesh_set_simd(gl_mesh_simd->value);
+    RenderMesh_begin_shaped(&frame, render_mesh, currententity->frame, currententity->oldframe,
+                            currententity->backlerp);
+
+    // the workers write straight into the mapped buffers
+    if(render_mesh->num_vertexes >= MESH_THREAD_VERTEXES)
+      ri.Job_Run(mesh_pool, RenderMesh_render_job, &job);
+    else
+      RenderMesh_render_job(&job, 0, 1);
 
     float alpha = (currententity->flags & RF_TRANSLUCENT) ? currententity->alpha : 1;
 
@@ -25,7 +25,7 @@ model_t *loadmodel;
 int modfilelen;
 
 void Mod_LoadSpriteModel(model_t *mod, struct HunkAllocator *hunk, void *buffer);
-void Mod_LoadBrushModel(model_t *mod, struct HunkAllocator *hunk, void *buffer);
+void Mod_LoadBrushModel(model_t *mod, struct HunkAllocator *hunk, const void *buffer);
 void Mod_LoadAliasModel(model_t *mod, struct HunkAllocator *hunk, void *buffer);
 model_t *Mod_LoadModel(model_t *mod, bool crash);
 
@@ -185,7 +185,7 @@ static void mod_load_done(const void *buffer, int len, void *ud) {
 
   case IDBSPHEADER:
     loadmodel->extradata = HunkAllocator_Begin(&hunk, 0x1000000);
-    Mod_LoadBrushModel(mod, &hunk, (void *)buffer);
+    Mod_LoadBrushModel(mod, &hunk, buffer);
     break;
 
   default:
@@ -196,6 +196,10 @@ static void mod_load_done(const void *buffer, int len, void *ud) {
   loadmodel->extradatasize = HunkAllocator_End(&hunk);
 }
 
+// a mapped map whose loader hasn't returned yet, the loaders drop
+// with Sys_Error so a failed one is only noticed on the next load
+static model_t *mod_mappedload;
+
 /*
 ==================
 Mod_ForName
@@ -211,6 +215,12 @@ model_t *Mod_ForName(int cmodel_index, char *name, bool crash) {
   if(!name[0])
     ri.Sys_Error(ERR_DROP, "Mod_ForName: NULL name");
 
+  // release the mapping and the half built model of a load that dropped
+  if(mod_mappedload) {
+    Mod_Free(mod_mappedload);
+    mod_mappedload = NULL;
+  }
+
   //
   // inline models are grabbed only from worldmodel
   //
@@ -256,6 +266,24 @@ model_t *Mod_ForName(int cmodel_index, char *name, bool crash) {
   }
 
   mod->cmodel_index = cmodel_index;
+
+  // maps are used straight from a view of the file, shared with the
+  // collision model when the server has the same map loaded
+  i = strlen(mod->name);
+  if(i > 4 && !Q_strcasecmp(mod->name + i - 4, ".bsp")) {
+    const void *data;
+    int len = FS_MapFile(mod->name, &data);
+    if(len < 0) {
+      mod_load_error(mod);
+    } else {
+      mod->mapping = data;
+      mod_mappedload = mod;
+      mod_load_done(data, len, mod);
+      mod_mappedload = NULL;
+    }
+    return mod;
+  }
+
   FS_LoadAsync(mod->name, mod_load_error, mod_load_done, mod);
 
   return mod;
@@ -269,7 +297,7 @@ model_t *Mod_ForName(int cmodel_index, char *name, bool crash) {
 ===============================================================================
 */
 
-byte *mod_base;
+const byte *mod_base;
 
 /*
 =================
@@ -281,6 +309,10 @@ void Mod_LoadLighting(lump_t *l, struct HunkAllocator *hunk) {
     loadmodel->lightdata = NULL;
     return;
   }
+  if(loadmodel->mapping) {
+    loadmodel->lightdata = (byte *)mod_base + l->fileofs; // read only
+    return;
+  }
   loadmodel->lightdata = HunkAllocator_Alloc(hunk, l->filelen);
   memcpy(loadmodel->lightdata, mod_base + l->fileofs, l->filelen);
 }
@@ -297,6 +329,12 @@ void Mod_LoadVisibility(lump_t *l, struct HunkAllocator *hunk) {
     loadmodel->vis = NULL;
     return;
   }
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+  if(loadmodel->mapping && !((uintptr_t)(mod_base + l->fileofs) & 3)) {
+    loadmodel->vis = (dvis_t *)(mod_base + l->fileofs); // read only
+    return;
+  }
+#endif
   loadmodel->vis = HunkAllocator_Alloc(hunk, l->filelen);
   memcpy(loadmodel->vis, mod_base + l->fileofs, l->filelen);
 
@@ -867,15 +905,17 @@ void Mod_LoadPlanes(lump_t *l, struct HunkAllocator *hunk) {
 Mod_LoadBrushModel
 =================
 */
-void Mod_LoadBrushModel(model_t *mod, struct HunkAllocator *hunk, void *buffer) {
+void Mod_LoadBrushModel(model_t *mod, struct HunkAllocator *hunk, const void *buffer) {
   int i;
-  dheader_t *header;
+  dheader_t header_swapped, *header;
   mmodel_t *bm;
 
   // if(loadmodel != mod_known)
   //   ri.Sys_Error(ERR_DROP, "Loaded a brush model after the world");
 
-  header = (dheader_t *)buffer;
+  // the buffer may be a read only mapping
+  header_swapped = *(const dheader_t *)buffer;
+  header = &header_swapped;
 
   i = LittleLong(header->version);
   if(i != BSPVERSION)
@@ -883,7 +923,7 @@ void Mod_LoadBrushModel(model_t *mod, struct HunkAllocator *hunk, void *buffer)
                  BSPVERSION);
 
   // swap all the lumps
-  mod_base = (byte *)header;
+  mod_base = buffer;
 
   for(i = 0; i < sizeof(dheader_t) / 4; i++)
     ((int *)header)[i] = LittleLong(((int *)header)[i]);
@@ -1201,6 +1241,8 @@ void Mod_Free(model_t *mod) {
   }
 
   HunkAllocator_Free(mod->extradata);
+  if(mod->mapping)
+    FS_UnmapFile(mod->mapping);
   memset(mod, 0, sizeof(*mod));
 }
 
@@ -64,6 +64,7 @@ typedef struct {
 #define SURF_DRAWTURB 0x10
 #define SURF_DRAWBACKGROUND 0x40
 #define SURF_UNDERWATER 0x80
+#define SURF_DLIGHTMAP 0x100 // the static lightmap holds dynamic lights
 
 // !!! if this is changed, it must be changed in asm_draw.h too !!!
 typedef struct {
@@ -118,6 +119,7 @@ typedef struct msurface_s {
   // lighting info
   int dlightframe;
   int dlightbits;
+  int lightmapframe; // rebuilt by R_UpdateLightmaps this frame
 
   int lightmaptexturenum;
   byte styles[MAXLIGHTMAPS];
@@ -240,6 +242,8 @@ typedef struct model_s {
   int extradatasize;
   void *extradata;
 
+  const void *mapping; // FS_MapFile view that brush model lumps point into
+
   struct GL_Buffer element_buffer;   // triangles
   struct GL_Buffer position_buffer;  // position float[3]
   struct GL_Buffer attribute_buffer; // st unorm16[2] / 2, lightmap_st unorm16[2], quat snorm16[4]
@@ -137,6 +137,10 @@ cvar_t *r_fullbright;
 cvar_t *r_novis;
 cvar_t *r_nocull;
 cvar_t *r_lerpmodels;
+cvar_t *gl_mesh_threads;
+cvar_t *gl_mesh_simd;
+cvar_t *gl_lightmap_threads;
+cvar_t *gl_lightmap_simd;
 cvar_t *r_lefthand;
 
 cvar_t *r_lightlevel; // FIXME: This is a HACK to get the client's light level
@@ -594,6 +598,10 @@ void R_Register(void) {
   r_novis = ri.Cvar_Get("r_novis", "0", 0);
   r_nocull = ri.Cvar_Get("r_nocull", "0", 0);
   r_lerpmodels = ri.Cvar_Get("r_lerpmodels", "1", 0);
+  gl_mesh_threads = ri.Cvar_Get("gl_mesh_threads", "0", 0);
+  gl_mesh_simd = ri.Cvar_Get("gl_mesh_simd", "1", 0);
+  gl_lightmap_threads = ri.Cvar_Get("gl_lightmap_threads", "0", 0);
+  gl_lightmap_simd = ri.Cvar_Get("gl_lightmap_simd", "1", 0);
   r_speeds = ri.Cvar_Get("r_speeds", "0", 0);
 
   r_lightlevel = ri.Cvar_Get("r_lightlevel", "0", 0);
@@ -700,6 +708,27 @@ bool R_SetMode(void) {
   return true;
 }
 
+/*
+=================
+R_CreateJobPool
+
+A pool for the threads a gl_*_threads cvar asks for, the render thread
+counted as one of them, so 0 or 1 keeps the work on the render thread.
+numworkers gets the number of threads that run each job.
+=================
+*/
+jobpool_t *R_CreateJobPool(cvar_t *threads, int *numworkers) {
+  int numthreads;
+
+  numthreads = threads->value;
+  if(numthreads < 1)
+    numthreads = 1;
+  *numworkers = numthreads;
+
+  // the render thread is a worker too
+  return ri.Job_CreatePool(numthreads - 1);
+}
+
 static inline void debug_callback(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length,
                                   const GLchar *message, const void *userParam) {
   if(type == GL_DEBUG_TYPE_ERROR || type == GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR ||
@@ -790,6 +819,8 @@ bool R_Init(void *hinstance, void *hWnd) {
 
   GL_InitImages();
   Mod_Init();
+  R_InitMeshThreads();
+  R_InitLightmapThreads();
   R_InitParticleTexture();
   Draw_InitLocal();
 
@@ -810,6 +841,8 @@ void R_Shutdown(void) {
   ri.Cmd_RemoveCommand("gl_strings");
 
   Mod_FreeAll();
+  R_ShutdownMeshThreads();
+  R_ShutdownLightmapThreads();
 
   GL_ShutdownImages();
 
@@ -69,6 +69,7 @@ static bool LM_AllocBlock(int w, int h, int *x, int *y);
 
 extern void R_SetCacheState(msurface_t *surf);
 extern void R_BuildLightMap(msurface_t *surf, byte *dest_rgb0, byte *dest_r1, byte *dest_g1, byte *dest_b1, int stride);
+extern void R_SetupLightMap(msurface_t *surf, lmsurface_t *out, lmdlight_t *dlights);
 
 /*
 =============================================================
@@ -269,32 +270,40 @@ struct ImageSet R_TextureAnimation(mtexinfo_t *tex) {
   return result;
 }
 
-static void GL_RenderLightmappedPoly(msurface_t *surf, float alpha) {
-  int i;
-  int map;
-  float *v;
-  bool is_dynamic = false;
-  unsigned lmtex = surf->lightmaptexturenum;
-  glpoly_t *p;
-
-  struct ImageSet image_set = R_TextureAnimation(surf->texinfo);
+/*
+================
+R_DynamicLightmap
 
-  for(map = 0; map < MAXLIGHTMAPS && surf->styles[map] != 255; map++) {
-    if(r_newrefdef.lightstyles[surf->styles[map]].white != surf->cached_light[map])
+True when the lightmap of surf has to be rebuilt this frame, for a
+lightstyle that changed or a dynamic light.  map is left at the first
+style that changed.
+================
+*/
+static bool R_DynamicLightmap(msurface_t *surf, int *map) {
+  for(*map = 0; *map < MAXLIGHTMAPS && surf->styles[*map] != 255; (*map)++) {
+    if(r_newrefdef.lightstyles[surf->styles[*map]].white != surf->cached_light[*map])
       goto dynamic;
   }
 
   // dynamic this frame or dynamic previously
-  if((surf->dlightframe == r_framecount)) {
-  dynamic:
-    if(gl_dynamic->value) {
-      if(!(surf->texinfo->flags & (SURF_SKY | SURF_TRANS33 | SURF_TRANS66 | SURF_WARP))) {
-        is_dynamic = true;
-      }
-    }
-  }
+  if(surf->dlightframe != r_framecount)
+    return false;
+
+dynamic:
+  if(!gl_dynamic->value)
+    return false;
+
+  return !(surf->texinfo->flags & (SURF_SKY | SURF_TRANS33 | SURF_TRANS66 | SURF_WARP));
+}
+
+static void GL_RenderLightmappedPoly(msurface_t *surf, float alpha) {
+  int map;
+  unsigned lmtex = surf->lightmaptexturenum;
+
+  struct ImageSet image_set = R_TextureAnimation(surf->texinfo);
 
-  if(is_dynamic) {
+  // world surfaces were already rebuilt by R_UpdateLightmaps
+  if(surf->lightmapframe != r_framecount && R_DynamicLightmap(surf, &map)) {
     uint8_t temp_rgb0[128 * 128 * 3];
     uint8_t temp_r1[128 * 128 * 3];
     uint8_t temp_g1[128 * 128 * 3];
@@ -489,6 +498,159 @@ void R_DrawBrushModel(entity_t *e) {
   R_DrawInlineBModel(r_newrefdef.cmodel_index);
 }
 
+/*
+=============================================================
+
+  DYNAMIC LIGHTMAPS
+
+=============================================================
+*/
+
+// below this many surfaces to rebuild the workers are left asleep
+#define LIGHTMAP_THREAD_SURFACES 8
+
+static struct {
+  jobpool_t *pool;
+  int numworkers;
+  lmscratch_t *scratch; // one per worker
+
+  // opaque world surfaces in drawing order
+  int numsurfaces, maxsurfaces;
+  msurface_t **surfaces;
+
+  // lightmaps rebuilt this frame
+  int maxdirty;
+  msurface_t **dirty;
+  lmsurface_t *builds;
+  lmdlight_t *dlights; // MAX_DLIGHTS per dirty surface
+
+  int datasize;
+  byte *data;
+} lm_batch;
+
+/*
+=================
+R_InitLightmapThreads
+
+gl_lightmap_threads is the number of threads that rebuild dynamic
+lightmaps, 0 or 1 keeps it all on the render thread.  Read on vid_restart.
+=================
+*/
+void R_InitLightmapThreads(void) {
+  lm_batch.pool = R_CreateJobPool(gl_lightmap_threads, &lm_batch.numworkers);
+  lm_batch.scratch = calloc(lm_batch.numworkers, sizeof(*lm_batch.scratch));
+}
+
+void R_ShutdownLightmapThreads(void) {
+  int i;
+
+  ri.Job_DestroyPool(lm_batch.pool);
+
+  for(i = 0; i < lm_batch.numworkers; i++)
+    LM_FreeScratch(&lm_batch.scratch[i]);
+  free(lm_batch.scratch);
+  free(lm_batch.surfaces);
+  free(lm_batch.dirty);
+  free(lm_batch.builds);
+  free(lm_batch.dlights);
+  free(lm_batch.data);
+
+  memset(&lm_batch, 0, sizeof(lm_batch));
+}
+
+static void R_AddLightmapSurface(msurface_t *surf) {
+  if(lm_batch.numsurfaces == lm_batch.maxsurfaces) {
+    lm_batch.maxsurfaces = lm_batch.maxsurfaces ? lm_batch.maxsurfaces * 2 : 1024;
+    lm_batch.surfaces = realloc(lm_batch.surfaces, lm_batch.maxsurfaces * sizeof(*lm_batch.surfaces));
+  }
+  lm_batch.surfaces[lm_batch.numsurfaces++] = surf;
+}
+
+/*
+=================
+R_UpdateLightmaps
+
+Rebuilds every dirty lightmap among the collected world surfaces at
+once, spread over the lightmap workers, then uploads them on the render
+thread.  The results go straight into the surface's own lightmap page;
+a page that picked up dynamic lights is rebuilt again once they leave.
+=================
+*/
+static void R_UpdateLightmaps(void) {
+  lmbatch_t batch;
+  lmsurface_t *lm;
+  msurface_t *surf;
+  byte *data;
+  int i, p, map, numdirty, size;
+
+  numdirty = 0;
+  size = 0;
+
+  for(i = 0; i < lm_batch.numsurfaces; i++) {
+    surf = lm_batch.surfaces[i];
+
+    if(surf->lightmapframe == r_framecount)
+      continue;
+    if(!R_DynamicLightmap(surf, &map) && !(surf->flags & SURF_DLIGHTMAP))
+      continue;
+
+    if(numdirty == lm_batch.maxdirty) {
+      lm_batch.maxdirty = lm_batch.maxdirty ? lm_batch.maxdirty * 2 : 64;
+      lm_batch.dirty = realloc(lm_batch.dirty, lm_batch.maxdirty * sizeof(*lm_batch.dirty));
+      lm_batch.builds = realloc(lm_batch.builds, lm_batch.maxdirty * sizeof(*lm_batch.builds));
+      lm_batch.dlights = realloc(lm_batch.dlights, lm_batch.maxdirty * MAX_DLIGHTS * sizeof(*lm_batch.dlights));
+    }
+
+    surf->lightmapframe = r_framecount;
+    lm_batch.dirty[numdirty] = surf;
+    R_SetupLightMap(surf, &lm_batch.builds[numdirty], lm_batch.dlights + numdirty * MAX_DLIGHTS);
+    size += lm_batch.builds[numdirty].smax * lm_batch.builds[numdirty].tmax * 3 * 4;
+    numdirty++;
+  }
+
+  if(!numdirty)
+    return;
+
+  if(size > lm_batch.datasize) {
+    lm_batch.datasize = size + (size >> 1);
+    lm_batch.data = realloc(lm_batch.data, lm_batch.datasize);
+  }
+
+  // the arrays may have moved while growing
+  for(i = 0, data = lm_batch.data; i < numdirty; i++) {
+    lm = &lm_batch.builds[i];
+    lm->dlights = lm_batch.dlights + i * MAX_DLIGHTS;
+    lm->stride = lm->smax * 3;
+    for(p = 0; p < 4; p++, data += lm->smax * lm->tmax * 3)
+      lm->dest[p] = data;
+  }
+
+  LM_SetSIMD(gl_lightmap_simd->value);
+
+  batch.numsurfaces = numdirty;
+  batch.surfaces = lm_batch.builds;
+  batch.scratch = lm_batch.scratch;
+
+  if(numdirty >= LIGHTMAP_THREAD_SURFACES)
+    ri.Job_Run(lm_batch.pool, LM_BuildLightmapsJob, &batch);
+  else
+    LM_BuildLightmapsJob(&batch, 0, 1);
+
+  for(i = 0; i < numdirty; i++) {
+    surf = lm_batch.dirty[i];
+    lm = &lm_batch.builds[i];
+
+    for(p = 0; p < 4; p++)
+      update_lightmap(surf->lightmaptexturenum + p, surf->light_s, surf->light_t, lm->smax, lm->tmax, lm->dest[p]);
+
+    R_SetCacheState(surf);
+    if(lm->numdlights)
+      surf->flags |= SURF_DLIGHTMAP;
+    else
+      surf->flags &= ~SURF_DLIGHTMAP;
+  }
+}
+
 /*
 =============================================================
 
@@ -585,7 +747,7 @@ void R_RecursiveWorldNode(int cmodel_index, mnode_t *node) {
       surf->texturechain = r_alpha_surfaces;
       r_alpha_surfaces = surf;
     } else {
-      GL_RenderLightmappedPoly(surf, 1);
+      R_AddLightmapSurface(surf);
     }
   }
 
@@ -600,6 +762,7 @@ R_DrawWorld
 */
 void R_DrawWorld(int cmodel_index) {
   entity_t ent;
+  int i;
 
   if(!r_drawworld->value)
     return;
@@ -623,8 +786,14 @@ void R_DrawWorld(int cmodel_index) {
 
   GL_matrix_identity(u_model_matrix.uniform.data.mat);
 
+  lm_batch.numsurfaces = 0;
   R_RecursiveWorldNode(cmodel_index, r_worldmodel[cmodel_index]->nodes);
 
+  // every lightmap is ready before the first surface is drawn
+  R_UpdateLightmaps();
+  for(i = 0; i < lm_batch.numsurfaces; i++)
+    GL_RenderLightmappedPoly(lm_batch.surfaces[i], 1);
+
   // R_DrawSkyBox();
   {
     extern void GL_draw_sky(uint32_t cmodel_index);
@@ -0,0 +1,278 @@
+/*
+Copyright (C) 1997-2001 Id Software, Inc.
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+// lightmap_bench.c -- times lightmap building on the CPU alone, no GL context
+//
+// usage: lightmap_bench <file.bsp> [threads] [frames]
+//
+// Rebuilds the lightmap of every lit face of the map from its lighting
+// lump, once with no dynamic lights and once with two lights on every
+// face, the way a frame full of rockets and muzzle flashes would.  Every
+// mode is run with and without SIMD and with one and with all threads.
+// Reads the bsp on a little endian host.
+
+#include "../qcommon/qcommon.h"
+
+#include "gl_lightmap.h"
+
+#include <uv.h>
+
+#define BENCH_DLIGHTS 2
+
+static byte *bsp;
+static dheader_t *header;
+
+static int numsurfaces;
+static lmsurface_t *surfaces;
+static lmdlight_t *dlights;
+static int numluxels;
+
+static void *Bench_Lump(int lump, int size, int *count) {
+  lump_t *l = &header->lumps[lump];
+
+  if(l->filelen % size)
+    Com_Error(ERR_FATAL, "funny lump size");
+  *count = l->filelen / size;
+  return bsp + l->fileofs;
+}
+
+/*
+================
+Bench_LoadMap
+
+The same extents as CalcSurfaceExtents and the same faces as
+Mod_LoadFaces gives samples to
+================
+*/
+static void Bench_LoadMap(const char *name) {
+  dvertex_t *vertexes;
+  dedge_t *edges;
+  int *surfedges;
+  texinfo_t *texinfo;
+  dface_t *faces;
+  byte *lighting;
+  int numvertexes, numedges, numsurfedges, numtexinfo, numfaces, lightinglen;
+  int f, i, j, e, size, numstyles, skipped;
+  float mins[2], maxs[2], val, *v;
+  FILE *file;
+  long len;
+
+  file = fopen(name, "rb");
+  if(!file)
+    Com_Error(ERR_FATAL, "couldn't open %s", name);
+  fseek(file, 0, SEEK_END);
+  len = ftell(file);
+  fseek(file, 0, SEEK_SET);
+  bsp = malloc(len);
+  if(fread(bsp, 1, len, file) != len)
+    Com_Error(ERR_FATAL, "couldn't read %s", name);
+  fclose(file);
+
+  header = (dheader_t *)bsp;
+  if(header->ident != IDBSPHEADER || header->version != BSPVERSION)
+    Com_Error(ERR_FATAL, "%s is not a version %i bsp", name, BSPVERSION);
+
+  vertexes = Bench_Lump(LUMP_VERTEXES, sizeof(*vertexes), &numvertexes);
+  edges = Bench_Lump(LUMP_EDGES, sizeof(*edges), &numedges);
+  surfedges = Bench_Lump(LUMP_SURFEDGES, sizeof(*surfedges), &numsurfedges);
+  texinfo = Bench_Lump(LUMP_TEXINFO, sizeof(*texinfo), &numtexinfo);
+  faces = Bench_Lump(LUMP_FACES, sizeof(*faces), &numfaces);
+  lighting = Bench_Lump(LUMP_LIGHTING, 1, &lightinglen);
+
+  surfaces = calloc(numfaces, sizeof(*surfaces));
+  dlights = calloc(numfaces * BENCH_DLIGHTS, sizeof(*dlights));
+  skipped = 0;
+
+  for(f = 0; f < numfaces; f++) {
+    texinfo_t *tex = &texinfo[faces[f].texinfo];
+    lmsurface_t *lm = &surfaces[numsurfaces];
+
+    if(faces[f].lightofs == -1 || (tex->flags & (SURF_SKY | SURF_WARP | SURF_TRANS33 | SURF_TRANS66)))
+      continue;
+
+    mins[0] = mins[1] = 999999;
+    maxs[0] = maxs[1] = -99999;
+    for(i = 0; i < faces[f].numedges; i++) {
+      e = surfedges[faces[f].firstedge + i];
+      if(e >= 0)
+        v = vertexes[edges[e].v[0]].point;
+      else
+        v = vertexes[edges[-e].v[1]].point;
+
+      for(j = 0; j < 2; j++) {
+        val = v[0] * tex->vecs[j][0] + v[1] * tex->vecs[j][1] + v[2] * tex->vecs[j][2] + tex->vecs[j][3];
+        if(val < mins[j])
+          mins[j] = val;
+        if(val > maxs[j])
+          maxs[j] = val;
+      }
+    }
+
+    lm->smax = ceil(maxs[0] / 16) - floor(mins[0] / 16) + 1;
+    lm->tmax = ceil(maxs[1] / 16) - floor(mins[1] / 16) + 1;
+    size = lm->smax * lm->tmax;
+
+    for(numstyles = 0; numstyles < MAXLIGHTMAPS && faces[f].styles[numstyles] != 255; numstyles++)
+      ;
+
+    // a lighting lump without the direction planes runs short
+    if(faces[f].lightofs + numstyles * size * 3 * 4 > lightinglen) {
+      skipped++;
+      continue;
+    }
+
+    lm->samples = lighting + faces[f].lightofs;
+    lm->numstyles = numstyles;
+    for(i = 0; i < numstyles; i++)
+      lm->stylescale[i][0] = lm->stylescale[i][1] = lm->stylescale[i][2] = 1;
+
+    // lights a little off the plane, somewhere over the face
+    lm->dlights = &dlights[numsurfaces * BENCH_DLIGHTS];
+    for(i = 0; i < BENCH_DLIGHTS; i++) {
+      lmdlight_t *dl = &dlights[numsurfaces * BENCH_DLIGHTS + i];
+
+      dl->local[0] = (float)rand() / RAND_MAX * lm->smax * 16;
+      dl->local[1] = (float)rand() / RAND_MAX * lm->tmax * 16;
+      dl->rad = 200 + (float)rand() / RAND_MAX * 100;
+      dl->minlight = dl->rad - 64;
+      dl->color[0] = 1;
+      dl->color[1] = 0.8f;
+      dl->color[2] = 0.6f;
+    }
+
+    numluxels += size;
+    numsurfaces++;
+  }
+
+  printf("%s: %i lit faces, %i luxels", name, numsurfaces, numluxels);
+  if(skipped)
+    printf(", %i faces skipped for a short lighting lump", skipped);
+  printf("\n");
+}
+
+/*
+================
+Bench_SetOutput
+
+Points every surface at its own four planes in data
+================
+*/
+static void Bench_SetOutput(byte *data) {
+  int i, p;
+
+  for(i = 0; i < numsurfaces; i++) {
+    surfaces[i].stride = surfaces[i].smax * 3;
+    for(p = 0; p < 4; p++, data += surfaces[i].smax * surfaces[i].tmax * 3)
+      surfaces[i].dest[p] = data;
+  }
+}
+
+static void Bench_SetDynamic(bool dynamic) {
+  int i;
+
+  for(i = 0; i < numsurfaces; i++)
+    surfaces[i].numdlights = dynamic ? BENCH_DLIGHTS : 0;
+}
+
+/*
+================
+Bench_Run
+
+Rebuilds every surface for the given number of frames, returns luxels per second
+================
+*/
+static double Bench_Run(jobpool_t *pool, lmbatch_t *batch, int frames) {
+  uint64_t start;
+  int f;
+
+  start = uv_hrtime();
+  for(f = 0; f < frames; f++)
+    Job_Run(pool, LM_BuildLightmapsJob, batch);
+
+  return (double)numluxels * frames / ((uv_hrtime() - start) / 1e9);
+}
+
+int main(int argc, char **argv) {
+  jobpool_t *pools[2];
+  lmbatch_t batch;
+  byte *data[2];
+  int threads, frames;
+  int i, p, dynamic, simd, maxdiff;
+
+  if(argc < 2) {
+    printf("usage: lightmap_bench <file.bsp> [threads] [frames]\n");
+    return 1;
+  }
+
+  threads = argc > 2 ? atoi(argv[2]) : 4;
+  if(threads < 1)
+    threads = 1;
+  frames = argc > 3 ? atoi(argv[3]) : 20;
+  if(frames < 1)
+    frames = 1;
+
+  Bench_LoadMap(argv[1]);
+
+  pools[0] = Job_CreatePool(0);
+  pools[1] = Job_CreatePool(threads - 1);
+
+  batch.numsurfaces = numsurfaces;
+  batch.surfaces = surfaces;
+  batch.scratch = calloc(threads, sizeof(*batch.scratch));
+
+  data[0] = malloc(numluxels * 3 * 4);
+  data[1] = malloc(numluxels * 3 * 4);
+
+  // the SIMD kernels have to give the bytes the scalar ones do
+  Bench_SetDynamic(true);
+  for(simd = 0; simd < 2; simd++) {
+    LM_SetSIMD(simd);
+    Bench_SetOutput(data[simd]);
+    Job_Run(pools[0], LM_BuildLightmapsJob, &batch);
+  }
+  maxdiff = 0;
+  for(i = 0; i < numluxels * 3 * 4; i++) {
+    if(abs(data[0][i] - data[1][i]) > maxdiff)
+      maxdiff = abs(data[0][i] - data[1][i]);
+  }
+
+  LM_SetSIMD(true);
+  printf("%i frames, SIMD %s, largest difference to scalar %i\n", frames, LM_SIMD() ? "available" : "not available",
+         maxdiff);
+  printf("mode      simd threads  Mluxels/sec\n");
+  for(dynamic = 0; dynamic < 2; dynamic++) {
+    Bench_SetDynamic(dynamic);
+    for(simd = 0; simd < 2; simd++) {
+      LM_SetSIMD(simd);
+      for(p = 0; p < 2; p++) {
+        int workers = p ? threads : 1;
+        printf("%-8s %5s %7i %12.2f\n", dynamic ? "dynamic" : "static", simd ? "yes" : "no", workers,
+               Bench_Run(pools[p], &batch, frames) / 1e6);
+      }
+    }
+  }
+
+  Job_DestroyPool(pools[0]);
+  Job_DestroyPool(pools[1]);
+
+  for(i = 0; i < threads; i++)
+    LM_FreeScratch(&batch.scratch[i]);
+
+  return 0;
+}
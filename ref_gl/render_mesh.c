@@ -2,6 +2,8 @@
 
 #include <alias/math.h>
 
+#include <math.h>
+
 static inline alias_pga3d_10101 decompress_motor(const float s[8]) {
   alias_pga3d_10101 result;
   result.one = s[0];
@@ -182,27 +184,29 @@ static inline void RenderMesh_finalize_bones(const struct RenderMesh *render_mes
 }
 
 static inline void RenderMesh_init_vertexes_static(const struct RenderMesh *render_mesh, alias_pga3d_10101 *vertexes,
-                                                   uint32_t shape_index) {
-  const struct RenderMesh_vertex *in_vertex = &render_mesh->vertexes[shape_index * render_mesh->num_vertexes];
-  for(int i = 0; i < render_mesh->num_vertexes; i++) {
+                                                   uint32_t shape_index, uint32_t first, uint32_t count) {
+  const struct RenderMesh_vertex *in_vertex = &render_mesh->vertexes[shape_index * render_mesh->num_vertexes + first];
+  for(int i = 0; i < count; i++) {
     vertexes[i] = decompress_motor(in_vertex[i].motor);
   }
 }
 
 static inline void RenderMesh_init_vertexes_weight(const struct RenderMesh *render_mesh, alias_pga3d_10101 *vertexes,
-                                                   uint32_t shape_index, float weight) {
-  const struct RenderMesh_vertex *in_vertex = &render_mesh->vertexes[shape_index * render_mesh->num_vertexes];
-  for(int i = 0; i < render_mesh->num_vertexes; i++) {
+                                                   uint32_t shape_index, float weight, uint32_t first,
+                                                   uint32_t count) {
+  const struct RenderMesh_vertex *in_vertex = &render_mesh->vertexes[shape_index * render_mesh->num_vertexes + first];
+  for(int i = 0; i < count; i++) {
     alias_pga3d_10101 vertex = decompress_motor(in_vertex[i].motor);
     vertexes[i] = alias_pga3d_mul_sm(weight, vertex);
   }
 }
 
 static inline void RenderMesh_init_vertexes_masked(const struct RenderMesh *render_mesh, alias_pga3d_10101 *vertexes,
-                                                   const uint8_t *mask, uint32_t shape_index, float weight) {
-  const struct RenderMesh_vertex *in_vertex = &render_mesh->vertexes[shape_index * render_mesh->num_vertexes];
-  for(int i = 0; i < render_mesh->num_vertexes; i++) {
-    if(!(mask[i >> 3] & (1 << (i & 7))))
+                                                   const uint8_t *mask, uint32_t shape_index, float weight,
+                                                   uint32_t first, uint32_t count) {
+  const struct RenderMesh_vertex *in_vertex = &render_mesh->vertexes[shape_index * render_mesh->num_vertexes + first];
+  for(int i = 0; i < count; i++) {
+    if(!(mask[(first + i) >> 3] & (1 << ((first + i) & 7))))
       continue;
     alias_pga3d_10101 vertex = decompress_motor(in_vertex[i].motor);
     vertexes[i] = alias_pga3d_mul_sm(weight, vertex);
@@ -210,19 +214,20 @@ static inline void RenderMesh_init_vertexes_masked(const struct RenderMesh *rend
 }
 
 static inline void RenderMesh_add_vertexes_weight(const struct RenderMesh *render_mesh, alias_pga3d_10101 *vertexes,
-                                                  uint32_t shape_index, float weight) {
-  const struct RenderMesh_vertex *in_vertex = &render_mesh->vertexes[shape_index * render_mesh->num_vertexes];
-  for(int i = 0; i < render_mesh->num_vertexes; i++) {
+                                                  uint32_t shape_index, float weight, uint32_t first, uint32_t count) {
+  const struct RenderMesh_vertex *in_vertex = &render_mesh->vertexes[shape_index * render_mesh->num_vertexes + first];
+  for(int i = 0; i < count; i++) {
     alias_pga3d_10101 vertex = decompress_motor(in_vertex[i].motor);
     vertexes[i] = alias_pga3d_add(alias_pga3d_m(vertexes[i]), alias_pga3d_mul_sm(weight, vertex));
   }
 }
 
 static inline void RenderMesh_add_vertexes_masked(const struct RenderMesh *render_mesh, alias_pga3d_10101 *vertexes,
-                                                  const uint8_t *mask, uint32_t shape_index, float weight) {
-  const struct RenderMesh_vertex *in_vertex = &render_mesh->vertexes[shape_index * render_mesh->num_vertexes];
-  for(int i = 0; i < render_mesh->num_vertexes; i++) {
-    if(!(mask[i >> 3] & (1 << (i & 7))))
+                                                  const uint8_t *mask, uint32_t shape_index, float weight,
+                                                  uint32_t first, uint32_t count) {
+  const struct RenderMesh_vertex *in_vertex = &render_mesh->vertexes[shape_index * render_mesh->num_vertexes + first];
+  for(int i = 0; i < count; i++) {
+    if(!(mask[(first + i) >> 3] & (1 << ((first + i) & 7))))
       continue;
     alias_pga3d_10101 vertex = decompress_motor(in_vertex[i].motor);
     vertexes[i] = alias_pga3d_add(alias_pga3d_m(vertexes[i]), alias_pga3d_mul_sm(weight, vertex));
@@ -230,36 +235,297 @@ static inline void RenderMesh_add_vertexes_masked(const struct RenderMesh *rende
 }
 
 static inline void RenderMesh_skin_vertexes(const struct RenderMesh *render_mesh, const alias_pga3d_10101 bones[256],
-                                            alias_pga3d_10101 *vertexes) {
-  for(int i = 0; i < render_mesh->num_vertexes; i++) {
+                                            alias_pga3d_10101 *vertexes, uint32_t first, uint32_t count) {
+  const struct RenderMesh_vertex_bone *in_bone = &render_mesh->vertexes_bone[first];
+  for(int i = 0; i < count; i++) {
     alias_pga3d_10101 bone = {.one = 0.0f};
     for(int b = 0; b < 4; b++) {
-      float w = render_mesh->vertexes_bone[i].weight[b] / 255.0f;
-      bone = alias_pga3d_add(alias_pga3d_m(bone), alias_pga3d_mul_sm(w, bones[render_mesh->vertexes_bone[i].index[b]]));
+      float w = in_bone[i].weight[b] / 255.0f;
+      bone = alias_pga3d_add(alias_pga3d_m(bone), alias_pga3d_mul_sm(w, bones[in_bone[i].index[b]]));
     }
     vertexes[i] = alias_pga3d_mul_mm(bone, vertexes[i]);
   }
 }
 
+// the motor product and the sandwich of the origin, written out for
+// RENDER_MESH_LANES vertexes at a time with one motor component per
+// register.  They assume alias_pga3d uses the plain basis its field
+// names spell out, RenderMesh_check_lanes makes sure before they are used.
+#if defined(__AVX__)
+#define RENDER_MESH_LANES 8
+#include <immintrin.h>
+typedef __m256 RenderMesh_lane;
+#define lane_set1 _mm256_set1_ps
+#define lane_load _mm256_loadu_ps
+#define lane_store _mm256_storeu_ps
+#define lane_add _mm256_add_ps
+#define lane_sub _mm256_sub_ps
+#define lane_mul _mm256_mul_ps
+#elif defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define RENDER_MESH_LANES 4
+#include <xmmintrin.h>
+typedef __m128 RenderMesh_lane;
+#define lane_set1 _mm_set1_ps
+#define lane_load _mm_loadu_ps
+#define lane_store _mm_storeu_ps
+#define lane_add _mm_add_ps
+#define lane_sub _mm_sub_ps
+#define lane_mul _mm_mul_ps
+#else
+#define RENDER_MESH_LANES 1
+#endif
+
+#if RENDER_MESH_LANES > 1
+struct RenderMesh_lanes {
+  RenderMesh_lane one, e01, e02, e03, e12, e13, e23, e0123;
+};
+
+static inline void RenderMesh_load_lanes(struct RenderMesh_lanes *l, const alias_pga3d_10101 *m) {
+  float c[8][RENDER_MESH_LANES];
+  for(int i = 0; i < RENDER_MESH_LANES; i++) {
+    c[0][i] = m[i].one;
+    c[1][i] = m[i].e01;
+    c[2][i] = m[i].e02;
+    c[3][i] = m[i].e03;
+    c[4][i] = m[i].e12;
+    c[5][i] = m[i].e13;
+    c[6][i] = m[i].e23;
+    c[7][i] = m[i].e0123;
+  }
+  l->one = lane_load(c[0]);
+  l->e01 = lane_load(c[1]);
+  l->e02 = lane_load(c[2]);
+  l->e03 = lane_load(c[3]);
+  l->e12 = lane_load(c[4]);
+  l->e13 = lane_load(c[5]);
+  l->e23 = lane_load(c[6]);
+  l->e0123 = lane_load(c[7]);
+}
+
+static inline void RenderMesh_store_lanes(alias_pga3d_10101 *m, const struct RenderMesh_lanes *l) {
+  float c[8][RENDER_MESH_LANES];
+  lane_store(c[0], l->one);
+  lane_store(c[1], l->e01);
+  lane_store(c[2], l->e02);
+  lane_store(c[3], l->e03);
+  lane_store(c[4], l->e12);
+  lane_store(c[5], l->e13);
+  lane_store(c[6], l->e23);
+  lane_store(c[7], l->e0123);
+  for(int i = 0; i < RENDER_MESH_LANES; i++) {
+    m[i].one = c[0][i];
+    m[i].e01 = c[1][i];
+    m[i].e02 = c[2][i];
+    m[i].e03 = c[3][i];
+    m[i].e12 = c[4][i];
+    m[i].e13 = c[5][i];
+    m[i].e23 = c[6][i];
+    m[i].e0123 = c[7][i];
+  }
+}
+
+#define LM(x, y) lane_mul(a.x, b.y)
+
+static inline struct RenderMesh_lanes RenderMesh_lanes_mul_mm(struct RenderMesh_lanes a, struct RenderMesh_lanes b) {
+  struct RenderMesh_lanes r;
+  r.one = lane_sub(LM(one, one), lane_add(LM(e12, e12), lane_add(LM(e13, e13), LM(e23, e23))));
+  r.e01 = lane_sub(lane_add(lane_add(LM(e01, one), LM(e12, e02)), lane_add(LM(e13, e03), LM(one, e01))),
+                   lane_add(lane_add(LM(e0123, e23), LM(e02, e12)), lane_add(LM(e03, e13), LM(e23, e0123))));
+  r.e02 = lane_sub(lane_add(lane_add(LM(e01, e12), lane_add(LM(e0123, e13), LM(e02, one))),
+                            lane_add(LM(e13, e0123), lane_add(LM(e23, e03), LM(one, e02)))),
+                   lane_add(LM(e03, e23), LM(e12, e01)));
+  r.e03 = lane_sub(lane_add(lane_add(LM(e01, e13), LM(e02, e23)), lane_add(LM(e03, one), LM(one, e03))),
+                   lane_add(lane_add(LM(e0123, e12), LM(e12, e0123)), lane_add(LM(e13, e01), LM(e23, e02))));
+  r.e12 = lane_sub(lane_add(LM(e12, one), lane_add(LM(e23, e13), LM(one, e12))), LM(e13, e23));
+  r.e13 = lane_sub(lane_add(LM(e12, e23), lane_add(LM(e13, one), LM(one, e13))), LM(e23, e12));
+  r.e23 = lane_sub(lane_add(LM(e13, e12), lane_add(LM(e23, one), LM(one, e23))), LM(e12, e13));
+  r.e0123 = lane_sub(lane_add(lane_add(LM(e01, e23), lane_add(LM(e0123, one), LM(e03, e12))),
+                              lane_add(LM(e12, e03), lane_add(LM(e23, e01), LM(one, e0123)))),
+                     lane_add(LM(e02, e13), LM(e13, e02)));
+  return r;
+}
+
+#undef LM
+
+static inline struct RenderMesh_lanes RenderMesh_lanes_mul_sm(RenderMesh_lane s, struct RenderMesh_lanes m) {
+  m.one = lane_mul(s, m.one);
+  m.e01 = lane_mul(s, m.e01);
+  m.e02 = lane_mul(s, m.e02);
+  m.e03 = lane_mul(s, m.e03);
+  m.e12 = lane_mul(s, m.e12);
+  m.e13 = lane_mul(s, m.e13);
+  m.e23 = lane_mul(s, m.e23);
+  m.e0123 = lane_mul(s, m.e0123);
+  return m;
+}
+
+static inline struct RenderMesh_lanes RenderMesh_lanes_add(struct RenderMesh_lanes a, struct RenderMesh_lanes b) {
+  a.one = lane_add(a.one, b.one);
+  a.e01 = lane_add(a.e01, b.e01);
+  a.e02 = lane_add(a.e02, b.e02);
+  a.e03 = lane_add(a.e03, b.e03);
+  a.e12 = lane_add(a.e12, b.e12);
+  a.e13 = lane_add(a.e13, b.e13);
+  a.e23 = lane_add(a.e23, b.e23);
+  a.e0123 = lane_add(a.e0123, b.e0123);
+  return a;
+}
+
+// m e123 ~m, the origin carried by each motor
+static inline void RenderMesh_lanes_origin(const struct RenderMesh_lanes *m, alias_pga3d_00010 *points) {
+  RenderMesh_lane two = lane_set1(2.0f);
+  float e012[RENDER_MESH_LANES], e013[RENDER_MESH_LANES], e023[RENDER_MESH_LANES], e123[RENDER_MESH_LANES];
+
+#define MM(x, y) lane_mul(m->x, m->y)
+  lane_store(e012, lane_mul(two, lane_sub(lane_add(MM(e0123, e12), MM(e03, one)), lane_add(MM(e01, e13), MM(e02, e23)))));
+  lane_store(e013, lane_mul(two, lane_sub(lane_add(MM(e01, e12), MM(e0123, e13)), lane_add(MM(e02, one), MM(e03, e23)))));
+  lane_store(e023, lane_mul(two, lane_add(lane_add(MM(e01, one), MM(e0123, e23)), lane_add(MM(e02, e12), MM(e03, e13)))));
+  lane_store(e123, lane_add(lane_add(MM(e12, e12), MM(e13, e13)), lane_add(MM(e23, e23), MM(one, one))));
+#undef MM
+
+  for(int i = 0; i < RENDER_MESH_LANES; i++) {
+    points[i] = (alias_pga3d_00010){.e012 = e012[i], .e013 = e013[i], .e023 = e023[i], .e123 = e123[i]};
+  }
+}
+
+static inline void RenderMesh_skin_vertexes_lanes(const struct RenderMesh *render_mesh,
+                                                  const alias_pga3d_10101 bones[256], alias_pga3d_10101 *vertexes,
+                                                  uint32_t first, uint32_t count) {
+  const struct RenderMesh_vertex_bone *in_bone = &render_mesh->vertexes_bone[first];
+  uint32_t i;
+
+  for(i = 0; i + RENDER_MESH_LANES <= count; i += RENDER_MESH_LANES) {
+    struct RenderMesh_lanes vertex, bone, part;
+    alias_pga3d_10101 gathered[RENDER_MESH_LANES];
+    float w[RENDER_MESH_LANES];
+
+    RenderMesh_load_lanes(&vertex, vertexes + i);
+    for(int b = 0; b < 4; b++) {
+      for(int l = 0; l < RENDER_MESH_LANES; l++) {
+        w[l] = in_bone[i + l].weight[b] / 255.0f;
+        gathered[l] = bones[in_bone[i + l].index[b]];
+      }
+      RenderMesh_load_lanes(&part, gathered);
+      part = RenderMesh_lanes_mul_sm(lane_load(w), part);
+      bone = b ? RenderMesh_lanes_add(bone, part) : part;
+    }
+    vertex = RenderMesh_lanes_mul_mm(bone, vertex);
+    RenderMesh_store_lanes(vertexes + i, &vertex);
+  }
+
+  RenderMesh_skin_vertexes(render_mesh, bones, vertexes + i, first + i, count - i);
+}
+#endif
+
+// -1 until RenderMesh_check_lanes has run
+static int render_mesh_lanes_ok = -1;
+static bool render_mesh_simd_enabled = true;
+
+#if RENDER_MESH_LANES > 1
+static bool RenderMesh_fuzzy_eq(float a, float b) { return fabsf(a - b) <= 1e-4f * (1.0f + fabsf(a) + fabsf(b)); }
+
+/*
+RenderMesh_check_lanes
+
+Runs a few arbitrary motors through both the lane and the alias_pga3d
+paths and only lets the lanes be used if they agree
+*/
+static bool RenderMesh_check_lanes(void) {
+  alias_pga3d_10101 a[RENDER_MESH_LANES], b[RENDER_MESH_LANES], r[RENDER_MESH_LANES];
+  alias_pga3d_00010 points[RENDER_MESH_LANES];
+  struct RenderMesh_lanes la, lb, lr;
+  uint32_t seed = 12345;
+  float c[16];
+
+  for(int i = 0; i < RENDER_MESH_LANES; i++) {
+    for(int j = 0; j < 16; j++) {
+      seed = seed * 1664525 + 1013904223;
+      c[j] = (float)(seed >> 8) / (float)(1 << 24) * 2.0f - 1.0f;
+    }
+    a[i] = decompress_motor(c);
+    b[i] = decompress_motor(c + 8);
+  }
+
+  RenderMesh_load_lanes(&la, a);
+  RenderMesh_load_lanes(&lb, b);
+  lr = RenderMesh_lanes_mul_mm(la, lb);
+  RenderMesh_store_lanes(r, &lr);
+  RenderMesh_lanes_origin(&la, points);
+
+  for(int i = 0; i < RENDER_MESH_LANES; i++) {
+    float want[8], got[8];
+    compress_motor(want, alias_pga3d_mul_mm(a[i], b[i]));
+    compress_motor(got, r[i]);
+    for(int j = 0; j < 8; j++)
+      if(!RenderMesh_fuzzy_eq(want[j], got[j]))
+        return false;
+
+    alias_pga3d_00010 origin = alias_pga3d_point(0, 0, 0);
+    origin = alias_pga3d_grade_3(alias_pga3d_sandwich(alias_pga3d_t(origin), alias_pga3d_m(a[i])));
+    if(!RenderMesh_fuzzy_eq(origin.e012, points[i].e012) || !RenderMesh_fuzzy_eq(origin.e013, points[i].e013) ||
+       !RenderMesh_fuzzy_eq(origin.e023, points[i].e023) || !RenderMesh_fuzzy_eq(origin.e123, points[i].e123))
+      return false;
+  }
+
+  return true;
+}
+#endif
+
+static inline bool RenderMesh_use_lanes(void) {
+#if RENDER_MESH_LANES > 1
+  if(render_mesh_lanes_ok < 0)
+    render_mesh_lanes_ok = RenderMesh_check_lanes();
+  return render_mesh_simd_enabled && render_mesh_lanes_ok;
+#else
+  return false;
+#endif
+}
+
+void RenderMesh_set_simd(bool enable) { render_mesh_simd_enabled = enable; }
+
+bool RenderMesh_simd(void) { return RenderMesh_use_lanes(); }
+
 static inline void RenderMesh_output_indexes(const struct RenderMesh *render_mesh, alias_memory_SubBuffer *subbuffer) {
   alias_memory_SubBuffer_write(subbuffer, 0, render_mesh->num_indexes, alias_memory_Format_Uint32, 0,
                                render_mesh->indexes);
 }
 
-static inline void RenderMesh_output_position(const struct RenderMesh *render_mesh, const alias_pga3d_10101 *vertexes,
-                                              alias_memory_SubBuffer *subbuffer) {
-  for(int i = 0; i < render_mesh->num_vertexes; i++) {
+static inline void RenderMesh_output_position(const alias_pga3d_10101 *vertexes, bool lanes, uint32_t first,
+                                              uint32_t count, alias_memory_SubBuffer *subbuffer) {
+  uint32_t i = 0;
+
+#if RENDER_MESH_LANES > 1
+  if(lanes) {
+    for(; i + RENDER_MESH_LANES <= count; i += RENDER_MESH_LANES) {
+      struct RenderMesh_lanes motors;
+      alias_pga3d_00010 points[RENDER_MESH_LANES];
+      float positions[RENDER_MESH_LANES][3];
+
+      RenderMesh_load_lanes(&motors, vertexes + i);
+      RenderMesh_lanes_origin(&motors, points);
+      for(int l = 0; l < RENDER_MESH_LANES; l++) {
+        positions[l][0] = alias_pga3d_point_x(points[l]);
+        positions[l][1] = alias_pga3d_point_y(points[l]);
+        positions[l][2] = alias_pga3d_point_z(points[l]);
+      }
+      alias_memory_SubBuffer_write(subbuffer, first + i, RENDER_MESH_LANES, alias_memory_Format_Float32, 0,
+                                   &positions[0][0]);
+    }
+  }
+#endif
+
+  for(; i < count; i++) {
     alias_pga3d_00010 position_1 = alias_pga3d_point(0, 0, 0);
     position_1 = alias_pga3d_grade_3(alias_pga3d_sandwich(alias_pga3d_t(position_1), alias_pga3d_m(vertexes[i])));
     float position_2[3];
     position_2[0] = alias_pga3d_point_x(position_1);
     position_2[1] = alias_pga3d_point_y(position_1);
     position_2[2] = alias_pga3d_point_z(position_1);
-    alias_memory_SubBuffer_write(subbuffer, i, 1, alias_memory_Format_Float32, 0, &position_2[0]);
+    alias_memory_SubBuffer_write(subbuffer, first + i, 1, alias_memory_Format_Float32, 0, &position_2[0]);
   }
 }
 
-static inline void RenderMesh_output_quaternion(const struct RenderMesh *render_mesh, const alias_pga3d_10101 *vertexes,
+static inline void RenderMesh_output_quaternion(const alias_pga3d_10101 *vertexes, uint32_t first, uint32_t count,
                                                 alias_memory_SubBuffer *subbuffer) {
   alias_memory_SubBuffer one = *subbuffer;
   alias_memory_SubBuffer ijk = *subbuffer;
@@ -269,49 +535,47 @@ static inline void RenderMesh_output_quaternion(const struct RenderMesh *render_
   ijk.type_length = 3;
   ijk.pointer = (void *)((uint8_t *)ijk.pointer + alias_memory_Format_size(ijk.type_format));
 
-  alias_memory_SubBuffer_write(&one, 0, render_mesh->num_vertexes, alias_memory_Format_Float32, sizeof(*vertexes),
-                               &vertexes->one);
+  alias_memory_SubBuffer_write(&one, first, count, alias_memory_Format_Float32, sizeof(*vertexes), &vertexes->one);
 
-  alias_memory_SubBuffer_write(&ijk, 0, render_mesh->num_vertexes, alias_memory_Format_Float32, sizeof(*vertexes),
-                               &vertexes->e12);
+  alias_memory_SubBuffer_write(&ijk, first, count, alias_memory_Format_Float32, sizeof(*vertexes), &vertexes->e12);
 }
 
-static inline void RenderMesh_output_normal(const struct RenderMesh *render_mesh, const alias_pga3d_10101 *vertexes,
+static inline void RenderMesh_output_normal(const alias_pga3d_10101 *vertexes, uint32_t first, uint32_t count,
                                             alias_memory_SubBuffer *subbuffer) {
-  for(int i = 0; i < render_mesh->num_vertexes; i++) {
+  for(int i = 0; i < count; i++) {
     alias_pga3d_00010 normal_1 = alias_pga3d_direction(0, 0, 1);
     normal_1 = alias_pga3d_grade_3(alias_pga3d_sandwich(alias_pga3d_t(normal_1), alias_pga3d_m(vertexes[i])));
     float normal_2[3];
     normal_2[0] = alias_pga3d_direction_x(normal_1);
     normal_2[1] = alias_pga3d_direction_y(normal_1);
     normal_2[2] = alias_pga3d_direction_z(normal_1);
-    alias_memory_SubBuffer_write(subbuffer, i, 1, alias_memory_Format_Float32, 0, &normal_2[0]);
+    alias_memory_SubBuffer_write(subbuffer, first + i, 1, alias_memory_Format_Float32, 0, &normal_2[0]);
   }
 }
 
-static inline void RenderMesh_output_tangent(const struct RenderMesh *render_mesh, const alias_pga3d_10101 *vertexes,
+static inline void RenderMesh_output_tangent(const alias_pga3d_10101 *vertexes, uint32_t first, uint32_t count,
                                              alias_memory_SubBuffer *subbuffer) {
-  for(int i = 0; i < render_mesh->num_vertexes; i++) {
+  for(int i = 0; i < count; i++) {
     alias_pga3d_00010 tangent_1 = alias_pga3d_direction(1, 0, 0);
     tangent_1 = alias_pga3d_grade_3(alias_pga3d_sandwich(alias_pga3d_t(tangent_1), alias_pga3d_m(vertexes[i])));
     float tangent_2[3];
     tangent_2[0] = alias_pga3d_direction_x(tangent_1);
     tangent_2[1] = alias_pga3d_direction_y(tangent_1);
     tangent_2[2] = alias_pga3d_direction_z(tangent_1);
-    alias_memory_SubBuffer_write(subbuffer, i, 1, alias_memory_Format_Float32, 0, &tangent_2[0]);
+    alias_memory_SubBuffer_write(subbuffer, first + i, 1, alias_memory_Format_Float32, 0, &tangent_2[0]);
   }
 }
 
-static inline void RenderMesh_output_bitangent(const struct RenderMesh *render_mesh, const alias_pga3d_10101 *vertexes,
+static inline void RenderMesh_output_bitangent(const alias_pga3d_10101 *vertexes, uint32_t first, uint32_t count,
                                                alias_memory_SubBuffer *subbuffer) {
-  for(int i = 0; i < render_mesh->num_vertexes; i++) {
+  for(int i = 0; i < count; i++) {
     alias_pga3d_00010 bitangent_1 = alias_pga3d_direction(0, 1, 0);
     bitangent_1 = alias_pga3d_grade_3(alias_pga3d_sandwich(alias_pga3d_t(bitangent_1), alias_pga3d_m(vertexes[i])));
     float bitangent_2[3];
     bitangent_2[0] = alias_pga3d_direction_x(bitangent_1);
     bitangent_2[1] = alias_pga3d_direction_y(bitangent_1);
     bitangent_2[2] = alias_pga3d_direction_z(bitangent_1);
-    alias_memory_SubBuffer_write(subbuffer, i, 1, alias_memory_Format_Float32, 0, &bitangent_2[0]);
+    alias_memory_SubBuffer_write(subbuffer, first + i, 1, alias_memory_Format_Float32, 0, &bitangent_2[0]);
   }
 }
 
@@ -326,26 +590,48 @@ static inline void RenderMesh_output_color(const struct RenderMesh *render_mesh,
                                render_mesh->vertexes_color);
 }
 
-static inline void RenderMesh_output_all(const struct RenderMesh *render_mesh, const alias_pga3d_10101 *vertexes,
-                                         struct RenderMesh_output *output) {
+static void RenderMesh_begin(struct RenderMesh_frame *frame, const struct RenderMesh *render_mesh,
+                             uint32_t shape_index_a, uint32_t shape_index_b, float shape_t) {
+  frame->render_mesh = render_mesh;
+  frame->shape_index_a = shape_index_a;
+  frame->shape_index_b = shape_index_b;
+  frame->shape_t = shape_t;
+  frame->skinned = false;
+  frame->lanes = RenderMesh_use_lanes();
+}
+
+void RenderMesh_begin_shaped(struct RenderMesh_frame *frame, const struct RenderMesh *render_mesh,
+                             uint32_t shape_index_a, uint32_t shape_index_b, float t) {
+  // an exact key frame is copied rather than blended
+  if(shape_index_a == shape_index_b || t <= alias_R_EPSILON) {
+    t = 0.0f;
+  } else if((t - 1.0f) >= 0.0f) {
+    shape_index_a = shape_index_b;
+    t = 0.0f;
+  }
+
+  RenderMesh_begin(frame, render_mesh, shape_index_a, shape_index_b, t);
+}
+
+void RenderMesh_begin_skinned(struct RenderMesh_frame *frame, const struct RenderMesh *render_mesh,
+                              uint32_t pose_index_a, uint32_t pose_index_b, float pose_t, uint32_t shape_index_a,
+                              uint32_t shape_index_b, float shape_t) {
+  alias_pga3d_10101 poses[256];
+
+  RenderMesh_begin(frame, render_mesh, shape_index_a, shape_index_b, shape_t);
+  frame->skinned = true;
+
+  RenderMesh_init_pose_weight(render_mesh, poses, pose_index_a, 1.0f - pose_t);
+  RenderMesh_add_pose(render_mesh, poses, pose_index_b, pose_t);
+  RenderMesh_finalize_bones(render_mesh, poses, frame->bones);
+}
+
+void RenderMesh_render_static(const struct RenderMesh_frame *frame, struct RenderMesh_output *output) {
+  const struct RenderMesh *render_mesh = frame->render_mesh;
+
   if(output->indexes.pointer) {
     RenderMesh_output_indexes(render_mesh, &output->indexes);
   }
-  if(output->position.pointer) {
-    RenderMesh_output_position(render_mesh, vertexes, &output->position);
-  }
-  if(output->quaternion.pointer) {
-    RenderMesh_output_quaternion(render_mesh, vertexes, &output->quaternion);
-  }
-  if(output->normal.pointer) {
-    RenderMesh_output_normal(render_mesh, vertexes, &output->normal);
-  }
-  if(output->tangent.pointer) {
-    RenderMesh_output_tangent(render_mesh, vertexes, &output->tangent);
-  }
-  if(output->bitangent.pointer) {
-    RenderMesh_output_bitangent(render_mesh, vertexes, &output->bitangent);
-  }
   if(output->texture_coord_1.pointer) {
     RenderMesh_output_texture_coord(render_mesh, render_mesh->vertexes_st_1, &output->texture_coord_1);
   }
@@ -357,107 +643,124 @@ static inline void RenderMesh_output_all(const struct RenderMesh *render_mesh, c
   }
 }
 
-void RenderMesh_render(const struct RenderMesh *render_mesh, struct RenderMesh_output *output) {
-  alias_pga3d_10101 *vertexes = alias_malloc(NULL, sizeof(*vertexes) * render_mesh->num_vertexes, 4);
-  RenderMesh_init_vertexes_static(render_mesh, vertexes, 0);
-  RenderMesh_output_all(render_mesh, vertexes, output);
-  alias_free(NULL, vertexes, sizeof(*vertexes) * render_mesh->num_vertexes, 4);
-}
+void RenderMesh_render_vertexes(const struct RenderMesh_frame *frame, struct RenderMesh_output *output,
+                                uint32_t first_vertex, uint32_t num_vertexes) {
+  const struct RenderMesh *render_mesh = frame->render_mesh;
+  alias_pga3d_10101 vertexes[RENDER_MESH_CHUNK];
 
-void RenderMesh_render_skinned(const struct RenderMesh *render_mesh, struct RenderMesh_output *output,
-                               uint32_t pose_index) {
-  alias_pga3d_10101 bones[256], poses[256];
+  for(uint32_t first = first_vertex; first < first_vertex + num_vertexes; first += RENDER_MESH_CHUNK) {
+    uint32_t count = first_vertex + num_vertexes - first;
+    if(count > RENDER_MESH_CHUNK)
+      count = RENDER_MESH_CHUNK;
 
-  RenderMesh_init_pose(render_mesh, poses, pose_index);
-  RenderMesh_finalize_bones(render_mesh, poses, bones);
+    if(frame->shape_t == 0.0f) {
+      RenderMesh_init_vertexes_static(render_mesh, vertexes, frame->shape_index_a, first, count);
+    } else {
+      RenderMesh_init_vertexes_weight(render_mesh, vertexes, frame->shape_index_a, 1.0f - frame->shape_t, first,
+                                      count);
+      RenderMesh_add_vertexes_weight(render_mesh, vertexes, frame->shape_index_b, frame->shape_t, first, count);
+    }
 
-  alias_pga3d_10101 *vertexes = alias_malloc(NULL, sizeof(*vertexes) * render_mesh->num_vertexes, 4);
-  RenderMesh_init_vertexes_static(render_mesh, vertexes, 0);
-  RenderMesh_skin_vertexes(render_mesh, bones, vertexes);
+    if(frame->skinned) {
+#if RENDER_MESH_LANES > 1
+      if(frame->lanes)
+        RenderMesh_skin_vertexes_lanes(render_mesh, frame->bones, vertexes, first, count);
+      else
+#endif
+        RenderMesh_skin_vertexes(render_mesh, frame->bones, vertexes, first, count);
+    }
 
-  RenderMesh_output_all(render_mesh, vertexes, output);
-  alias_free(NULL, vertexes, sizeof(*vertexes) * render_mesh->num_vertexes, 4);
+    if(output->position.pointer) {
+      RenderMesh_output_position(vertexes, frame->lanes, first, count, &output->position);
+    }
+    if(output->quaternion.pointer) {
+      RenderMesh_output_quaternion(vertexes, first, count, &output->quaternion);
+    }
+    if(output->normal.pointer) {
+      RenderMesh_output_normal(vertexes, first, count, &output->normal);
+    }
+    if(output->tangent.pointer) {
+      RenderMesh_output_tangent(vertexes, first, count, &output->tangent);
+    }
+    if(output->bitangent.pointer) {
+      RenderMesh_output_bitangent(vertexes, first, count, &output->bitangent);
+    }
+  }
 }
 
-void RenderMesh_render_lerp_skinned(const struct RenderMesh *render_mesh, struct RenderMesh_output *output,
-                                    uint32_t pose_index_a, uint32_t pose_index_b, float t) {
-  alias_pga3d_10101 bones[256], poses[256];
+void RenderMesh_render_job(void *data, int worker, int numworkers) {
+  struct RenderMesh_job *job = data;
+  uint32_t num_vertexes = job->frame->render_mesh->num_vertexes;
+  uint32_t share, first, last;
 
-  RenderMesh_init_pose_weight(render_mesh, poses, pose_index_a, 1.0f - t);
-  RenderMesh_add_pose(render_mesh, poses, pose_index_b, t);
-  RenderMesh_finalize_bones(render_mesh, poses, bones);
+  if(worker == 0)
+    RenderMesh_render_static(job->frame, job->output);
 
-  alias_pga3d_10101 *vertexes = alias_malloc(NULL, sizeof(*vertexes) * render_mesh->num_vertexes, 4);
-  RenderMesh_init_vertexes_static(render_mesh, vertexes, 0);
-  RenderMesh_skin_vertexes(render_mesh, bones, vertexes);
+  // whole chunks per worker keep the lanes full
+  share = (num_vertexes + numworkers - 1) / numworkers;
+  share = (share + RENDER_MESH_CHUNK - 1) / RENDER_MESH_CHUNK * RENDER_MESH_CHUNK;
+  first = share * worker;
+  last = first + share;
+  if(last > num_vertexes)
+    last = num_vertexes;
+  if(first < last)
+    RenderMesh_render_vertexes(job->frame, job->output, first, last - first);
+}
 
-  RenderMesh_output_all(render_mesh, vertexes, output);
-  alias_free(NULL, vertexes, sizeof(*vertexes) * render_mesh->num_vertexes, 4);
+static void RenderMesh_render_frame(const struct RenderMesh_frame *frame, struct RenderMesh_output *output) {
+  RenderMesh_render_static(frame, output);
+  RenderMesh_render_vertexes(frame, output, 0, frame->render_mesh->num_vertexes);
 }
 
-void RenderMesh_render_shaped(const struct RenderMesh *render_mesh, struct RenderMesh_output *output,
-                              uint32_t shape_index) {
+void RenderMesh_render(const struct RenderMesh *render_mesh, struct RenderMesh_output *output) {
+  struct RenderMesh_frame frame;
+  RenderMesh_begin(&frame, render_mesh, 0, 0, 0.0f);
+  RenderMesh_render_frame(&frame, output);
+}
 
-  alias_pga3d_10101 *vertexes = alias_malloc(NULL, sizeof(*vertexes) * render_mesh->num_vertexes, 4);
-  RenderMesh_init_vertexes_static(render_mesh, vertexes, shape_index);
+void RenderMesh_render_skinned(const struct RenderMesh *render_mesh, struct RenderMesh_output *output,
+                               uint32_t pose_index) {
+  struct RenderMesh_frame frame;
+  RenderMesh_begin_skinned(&frame, render_mesh, pose_index, pose_index, 0.0f, 0, 0, 0.0f);
+  RenderMesh_render_frame(&frame, output);
+}
+
+void RenderMesh_render_lerp_skinned(const struct RenderMesh *render_mesh, struct RenderMesh_output *output,
+                                    uint32_t pose_index_a, uint32_t pose_index_b, float t) {
+  struct RenderMesh_frame frame;
+  RenderMesh_begin_skinned(&frame, render_mesh, pose_index_a, pose_index_b, t, 0, 0, 0.0f);
+  RenderMesh_render_frame(&frame, output);
+}
 
-  RenderMesh_output_all(render_mesh, vertexes, output);
-  alias_free(NULL, vertexes, sizeof(*vertexes) * render_mesh->num_vertexes, 4);
+void RenderMesh_render_shaped(const struct RenderMesh *render_mesh, struct RenderMesh_output *output,
+                              uint32_t shape_index) {
+  struct RenderMesh_frame frame;
+  RenderMesh_begin(&frame, render_mesh, shape_index, shape_index, 0.0f);
+  RenderMesh_render_frame(&frame, output);
 }
 
 void RenderMesh_render_lerp_shaped(const struct RenderMesh *render_mesh, struct RenderMesh_output *output,
                                    uint32_t shape_index_a, uint32_t shape_index_b, float t) {
-  if(shape_index_a == shape_index_b || t <= alias_R_EPSILON) {
-    RenderMesh_render_shaped(render_mesh, output, shape_index_a);
-    return;
-  }
-
-  if((t - 1.0f) >= 0.0f) {
-    RenderMesh_render_shaped(render_mesh, output, shape_index_b);
-    return;
-  }
-
-  alias_pga3d_10101 *vertexes = alias_malloc(NULL, sizeof(*vertexes) * render_mesh->num_vertexes, 4);
-  RenderMesh_init_vertexes_weight(render_mesh, vertexes, shape_index_a, 1.0f - t);
-  RenderMesh_add_vertexes_weight(render_mesh, vertexes, shape_index_b, t);
-
-  RenderMesh_output_all(render_mesh, vertexes, output);
-  alias_free(NULL, vertexes, sizeof(*vertexes) * render_mesh->num_vertexes, 4);
+  struct RenderMesh_frame frame;
+  RenderMesh_begin_shaped(&frame, render_mesh, shape_index_a, shape_index_b, t);
+  RenderMesh_render_frame(&frame, output);
 }
 
 void RenderMesh_render_lerp_shaped_skinned(const struct RenderMesh *render_mesh, struct RenderMesh_output *output,
                                            uint32_t pose_index, uint32_t shape_index_a, uint32_t shape_index_b,
                                            float t) {
-  alias_pga3d_10101 bones[256], poses[256];
-
-  RenderMesh_init_pose(render_mesh, poses, pose_index);
-  RenderMesh_finalize_bones(render_mesh, poses, bones);
-
-  alias_pga3d_10101 *vertexes = alias_malloc(NULL, sizeof(*vertexes) * render_mesh->num_vertexes, 4);
-  RenderMesh_init_vertexes_weight(render_mesh, vertexes, shape_index_a, 1.0f - t);
-  RenderMesh_add_vertexes_weight(render_mesh, vertexes, shape_index_b, t);
-  RenderMesh_skin_vertexes(render_mesh, bones, vertexes);
-
-  RenderMesh_output_all(render_mesh, vertexes, output);
-  alias_free(NULL, vertexes, sizeof(*vertexes) * render_mesh->num_vertexes, 4);
+  struct RenderMesh_frame frame;
+  RenderMesh_begin_skinned(&frame, render_mesh, pose_index, pose_index, 0.0f, shape_index_a, shape_index_b, t);
+  RenderMesh_render_frame(&frame, output);
 }
 
 void RenderMesh_render_lerp_shaped_lerp_skinned(const struct RenderMesh *render_mesh, struct RenderMesh_output *output,
                                                 uint32_t pose_index_a, uint32_t pose_index_b, float pose_t,
                                                 uint32_t shape_index_a, uint32_t shape_index_b, float shape_t) {
-  alias_pga3d_10101 bones[256], poses[256];
-
-  RenderMesh_init_pose_weight(render_mesh, poses, pose_index_a, 1.0f - pose_t);
-  RenderMesh_add_pose(render_mesh, poses, pose_index_b, pose_t);
-  RenderMesh_finalize_bones(render_mesh, poses, bones);
-
-  alias_pga3d_10101 *vertexes = alias_malloc(NULL, sizeof(*vertexes) * render_mesh->num_vertexes, 4);
-  RenderMesh_init_vertexes_weight(render_mesh, vertexes, shape_index_a, 1.0f - shape_t);
-  RenderMesh_add_vertexes_weight(render_mesh, vertexes, shape_index_b, shape_t);
-  RenderMesh_skin_vertexes(render_mesh, bones, vertexes);
-
-  RenderMesh_output_all(render_mesh, vertexes, output);
-  alias_free(NULL, vertexes, sizeof(*vertexes) * render_mesh->num_vertexes, 4);
+  struct RenderMesh_frame frame;
+  RenderMesh_begin_skinned(&frame, render_mesh, pose_index_a, pose_index_b, pose_t, shape_index_a, shape_index_b,
+                           shape_t);
+  RenderMesh_render_frame(&frame, output);
 }
 
 void RenderMesh_set_position(struct RenderMesh *render_mesh, uint32_t shape_index, uint32_t vertex_index,
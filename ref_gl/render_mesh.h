@@ -4,10 +4,15 @@
 #include <alias/pga3d.h>
 #include <alias/memory.h>
 
+#include <stdbool.h>
+
 #define RENDER_MESH_FLAG_TEXTURE_COORD_1 0x01
 #define RENDER_MESH_FLAG_TEXTURE_COORD_2 0x02
 #define RENDER_MESH_FLAG_TEXTURE_COLOR 0x04
 
+// vertexes are blended, skinned and written out this many at a time
+#define RENDER_MESH_CHUNK 64
+
 struct RenderMesh_vertex {
   float motor[8];
 };
@@ -73,6 +78,23 @@ struct RenderMesh_output {
   alias_memory_SubBuffer color;
 };
 
+// everything a render shares between its vertexes, filled in by one of the
+// RenderMesh_begin functions so the vertexes can be split between threads
+struct RenderMesh_frame {
+  const struct RenderMesh *render_mesh;
+  uint32_t shape_index_a;
+  uint32_t shape_index_b;
+  float shape_t;
+  bool skinned;
+  bool lanes;
+  alias_pga3d_10101 bones[256];
+};
+
+struct RenderMesh_job {
+  const struct RenderMesh_frame *frame;
+  struct RenderMesh_output *output;
+};
+
 struct RenderMesh *allocate_RenderMesh(uint32_t flags, uint32_t num_indexes, uint32_t num_submeshes,
                                        uint32_t num_vertexes, uint32_t num_shapes, uint32_t num_joints,
                                        uint32_t num_poses);
@@ -99,6 +121,29 @@ void RenderMesh_render_lerp_shaped_lerp_skinned(const struct RenderMesh *render_
                                                 uint32_t pose_index_a, uint32_t pose_index_b, float pose_t,
                                                 uint32_t shape_index_a, uint32_t shape_index_b, float shape_t);
 
+void RenderMesh_begin_shaped(struct RenderMesh_frame *frame, const struct RenderMesh *render_mesh,
+                             uint32_t shape_index_a, uint32_t shape_index_b, float t);
+
+void RenderMesh_begin_skinned(struct RenderMesh_frame *frame, const struct RenderMesh *render_mesh,
+                              uint32_t pose_index_a, uint32_t pose_index_b, float pose_t, uint32_t shape_index_a,
+                              uint32_t shape_index_b, float shape_t);
+
+// indexes, texture coordinates and colors, none of which change with the frame
+void RenderMesh_render_static(const struct RenderMesh_frame *frame, struct RenderMesh_output *output);
+
+// separate ranges of one frame can be rendered from different threads at once
+void RenderMesh_render_vertexes(const struct RenderMesh_frame *frame, struct RenderMesh_output *output,
+                                uint32_t first_vertex, uint32_t num_vertexes);
+
+// a jobfunc_t over a struct RenderMesh_job, every worker renders its share of
+// whole chunks and worker 0 the static outputs too
+void RenderMesh_render_job(void *data, int worker, int numworkers);
+
+// the SSE/AVX paths are only used once they have been checked against
+// alias_pga3d, RenderMesh_simd says if they are
+void RenderMesh_set_simd(bool enable);
+bool RenderMesh_simd(void);
+
 void RenderMesh_set_position(struct RenderMesh *render_mesh, uint32_t shape_index, uint32_t vertex_index,
                              const float position[3]);
 
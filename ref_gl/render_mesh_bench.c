@@ -0,0 +1,222 @@
+/*
+Copyright (C) 1997-2001 Id Software, Inc.
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+// render_mesh_bench.c -- times RenderMesh on the CPU alone, no GL context
+//
+// usage: render_mesh_bench [threads] [frames]
+//
+// Builds 100 meshes the size of MD2 monsters and players, each with MD2
+// style vertex animation and a small skeleton on top, and renders every
+// one of them into plain memory for a number of frames.  Every mode is
+// run with and without the SIMD lanes and with one and with all threads.
+
+#include "../qcommon/qcommon.h"
+
+#include "render_mesh.h"
+
+#include <uv.h>
+
+#define NUM_MESHES 100
+#define NUM_SHAPES 40
+#define NUM_JOINTS 16
+
+typedef struct {
+  struct RenderMesh *render_mesh;
+  float *positions;
+  int16_t *quaternions;
+  uint16_t *st;
+} benchmesh_t;
+
+static benchmesh_t meshes[NUM_MESHES];
+
+/*
+================
+Bench_BuildMesh
+
+A lat/long sphere that breathes over its frames, between 300 and 800
+vertexes like the stock models, with every vertex bound to two joints
+================
+*/
+static void Bench_BuildMesh(benchmesh_t *mesh, int rows, int cols) {
+  struct RenderMesh *render_mesh;
+  uint32_t num_vertexes, num_indexes;
+  uint32_t i, r, c, s;
+
+  num_vertexes = rows * cols;
+  num_indexes = (rows - 1) * (cols - 1) * 6;
+  render_mesh = allocate_RenderMesh(RENDER_MESH_FLAG_TEXTURE_COORD_1, num_indexes, 1, num_vertexes, NUM_SHAPES,
+                                    NUM_JOINTS, NUM_SHAPES);
+
+  render_mesh->submeshes[0].first_index = 0;
+  render_mesh->submeshes[0].num_indexes = num_indexes;
+
+  i = 0;
+  for(r = 0; r + 1 < rows; r++) {
+    for(c = 0; c + 1 < cols; c++) {
+      render_mesh->indexes[i++] = r * cols + c;
+      render_mesh->indexes[i++] = (r + 1) * cols + c;
+      render_mesh->indexes[i++] = r * cols + c + 1;
+      render_mesh->indexes[i++] = r * cols + c + 1;
+      render_mesh->indexes[i++] = (r + 1) * cols + c;
+      render_mesh->indexes[i++] = (r + 1) * cols + c + 1;
+    }
+  }
+
+  for(s = 0; s < NUM_SHAPES; s++) {
+    float radius = 24.0f + 4.0f * sinf(s * 2.0f * M_PI / NUM_SHAPES);
+    for(r = 0; r < rows; r++) {
+      float lat = M_PI * r / (rows - 1);
+      for(c = 0; c < cols; c++) {
+        float lon = 2.0f * M_PI * c / cols;
+        float position[3] = {radius * sinf(lat) * cosf(lon), radius * sinf(lat) * sinf(lon), radius * cosf(lat)};
+        RenderMesh_set_position(render_mesh, s, r * cols + c, position);
+      }
+    }
+  }
+
+  for(i = 0; i < num_vertexes; i++) {
+    float st[2] = {(float)(i % cols) / cols, (float)(i / cols) / rows};
+    RenderMesh_set_texture_coord_1(render_mesh, i, st);
+
+    render_mesh->vertexes_bone[i].index[0] = (i / cols) * NUM_JOINTS / rows;
+    render_mesh->vertexes_bone[i].index[1] = ((i / cols) * NUM_JOINTS / rows + 1) % NUM_JOINTS;
+    render_mesh->vertexes_bone[i].index[2] = 0;
+    render_mesh->vertexes_bone[i].index[3] = 0;
+    render_mesh->vertexes_bone[i].weight[0] = 192;
+    render_mesh->vertexes_bone[i].weight[1] = 63;
+    render_mesh->vertexes_bone[i].weight[2] = 0;
+    render_mesh->vertexes_bone[i].weight[3] = 0;
+  }
+
+  // a chain of joints swaying a little about z
+  for(i = 0; i < NUM_JOINTS; i++)
+    render_mesh->joints[i].parent = i ? i - 1 : 255;
+  for(s = 0; s < NUM_SHAPES; s++) {
+    for(i = 0; i < NUM_JOINTS; i++) {
+      float angle = 0.05f * sinf((s + i) * 2.0f * M_PI / NUM_SHAPES);
+      float *motor = render_mesh->poses[s * NUM_JOINTS + i].motor;
+      memset(motor, 0, sizeof(render_mesh->poses[0].motor));
+      motor[0] = cosf(angle);
+      motor[4] = sinf(angle);
+    }
+  }
+
+  mesh->render_mesh = render_mesh;
+  mesh->positions = malloc(sizeof(float) * 3 * num_vertexes);
+  mesh->quaternions = malloc(sizeof(int16_t) * 4 * num_vertexes);
+  mesh->st = malloc(sizeof(uint16_t) * 2 * num_vertexes);
+}
+
+static struct RenderMesh_output Bench_Output(benchmesh_t *mesh) {
+  uint32_t num_vertexes = mesh->render_mesh->num_vertexes;
+
+  // the same layout R_DrawAliasModel asks for
+  return (struct RenderMesh_output){
+      .position = {.count = num_vertexes,
+                   .pointer = mesh->positions,
+                   .stride = sizeof(float) * 3,
+                   .type_format = alias_memory_Format_Float32,
+                   .type_length = 3},
+      .texture_coord_1 = {.count = num_vertexes,
+                          .pointer = mesh->st,
+                          .stride = sizeof(uint16_t) * 2,
+                          .type_format = alias_memory_Format_Unorm16,
+                          .type_length = 2},
+      .quaternion = {.count = num_vertexes,
+                     .pointer = mesh->quaternions,
+                     .stride = sizeof(int16_t) * 4,
+                     .type_format = alias_memory_Format_Snorm16,
+                     .type_length = 4},
+  };
+}
+
+/*
+================
+Bench_Run
+
+Renders every mesh for the given number of frames, returns vertexes per second
+================
+*/
+static double Bench_Run(jobpool_t *pool, bool skinned, int frames) {
+  struct RenderMesh_frame frame;
+  struct RenderMesh_output output;
+  struct RenderMesh_job job = {.frame = &frame, .output = &output};
+  uint64_t start, vertexes;
+  int f, m;
+
+  vertexes = 0;
+  start = uv_hrtime();
+  for(f = 0; f < frames; f++) {
+    for(m = 0; m < NUM_MESHES; m++) {
+      struct RenderMesh *render_mesh = meshes[m].render_mesh;
+      uint32_t a = (f + m) % NUM_SHAPES;
+      uint32_t b = (a + 1) % NUM_SHAPES;
+      float t = (float)(f % 10) / 10.0f;
+
+      if(skinned)
+        RenderMesh_begin_skinned(&frame, render_mesh, a, b, t, a, b, t);
+      else
+        RenderMesh_begin_shaped(&frame, render_mesh, a, b, t);
+      output = Bench_Output(&meshes[m]);
+      Job_Run(pool, RenderMesh_render_job, &job);
+      vertexes += render_mesh->num_vertexes;
+    }
+  }
+
+  return vertexes / ((uv_hrtime() - start) / 1e9);
+}
+
+int main(int argc, char **argv) {
+  jobpool_t *pools[2];
+  int threads, frames;
+  int m, p, skinned, simd;
+
+  threads = argc > 1 ? atoi(argv[1]) : 4;
+  if(threads < 1)
+    threads = 1;
+  frames = argc > 2 ? atoi(argv[2]) : 100;
+  if(frames < 1)
+    frames = 1;
+
+  for(m = 0; m < NUM_MESHES; m++)
+    Bench_BuildMesh(&meshes[m], 12 + m % 8, 24 + (m * 7) % 40);
+
+  pools[0] = Job_CreatePool(0);
+  pools[1] = Job_CreatePool(threads - 1);
+
+  RenderMesh_set_simd(true);
+  printf("%i meshes, %i frames, SIMD lanes %s\n", NUM_MESHES, frames,
+         RenderMesh_simd() ? "available" : "not available");
+  printf("mode      simd threads  Mvertexes/sec\n");
+  for(skinned = 0; skinned < 2; skinned++) {
+    for(simd = 0; simd < 2; simd++) {
+      RenderMesh_set_simd(simd);
+      for(p = 0; p < 2; p++) {
+        int workers = p ? threads : 1;
+        printf("%-8s %5s %7i %14.2f\n", skinned ? "skinned" : "shaped", simd ? "yes" : "no", workers,
+               Bench_Run(pools[p], skinned, frames) / 1e6);
+      }
+    }
+  }
+
+  Job_DestroyPool(pools[0]);
+  Job_DestroyPool(pools[1]);
+
+  return 0;
+}
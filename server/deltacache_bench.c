@@ -0,0 +1,551 @@
+/*
+Copyright (C) 1997-2001 Id Software, Inc.
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+// deltacache_bench.c -- SV_EmitPacketEntities for many clients, with and without sv_deltacache
+//
+// usage: deltacache_bench [clients] [loss] [demo.dm2]
+//
+// Takes the entities of every frame of a protocol 34 demo, or of a made up
+// game when no demo is given, and sends each frame to every client through
+// SV_EmitPacketEntities, delta compressed from the last frame that client
+// acknowledged.  loss is the percentage of frames a client never
+// acknowledges.  Every client sees the whole frame, as if they all stood
+// where the demo was recorded.  Runs once with sv_deltacache 0 and once
+// with 1 for each protocol, checks that both wrote the same bytes, and
+// reports the encode time per frame and the sv_deltastats counters.
+
+#include "server.h"
+
+#include <uv.h>
+
+#define BENCH_ENTITIES 128 // in the made up game
+#define BENCH_FRAMES 3000  // of the made up game
+#define BENCH_BACKUP 16    // svs.update_backup of a 10 Hz server
+#define BENCH_MSGLEN 0x40000 // no message overflows, whatever the frame
+
+// what sv_ents.c needs from the rest of the server
+server_static_t svs;
+server_t sv;
+game_export_t *ge;
+cvar_t *maxclients;
+cvar_t *sv_deltacache;
+cvar_t *sv_snapshot_threads;
+
+// only the frame building sv_ents.c does for a real server calls these
+int CM_NumClusters(int cmodel_index) { return 0; }
+byte *CM_CopyClusterPVS(int cmodel_index, int cluster, byte *row) { return row; }
+byte *CM_CopyClusterPHS(int cmodel_index, int cluster, byte *row) { return row; }
+int CM_PointLeafnum(int cmodel_index, vec3_t p) { return 0; }
+int CM_BoxLeafnums(int cmodel_index, vec3_t mins, vec3_t maxs, int *list, int listsize, int *topnode) { return 0; }
+int CM_LeafCluster(int cmodel_index, int leafnum) { return 0; }
+int CM_LeafArea(int cmodel_index, int leafnum) { return 0; }
+bool CM_AreasConnected(int cmodel_index, int area1, int area2) { return true; }
+int CM_WriteAreaBits(int cmodel_index, byte *buffer, int area) { return 0; }
+bool CM_HeadnodeVisible(int cmodel_index, int headnode, byte *visbits) { return true; }
+jobpool_t *Job_CreatePool(int numthreads) { return NULL; }
+void Job_DestroyPool(jobpool_t *pool) {}
+int Job_PoolWorkers(jobpool_t *pool) { return 0; }
+void Job_Run(jobpool_t *pool, jobfunc_t func, void *data) { func(data, 0, 1); }
+void SV_ClusterEdicts(int cmodel_index, const byte *visbits, unsigned *edictbits) {}
+
+typedef struct {
+  int first, num; // in bench_states
+} benchframe_t;
+
+typedef struct {
+  client_frame_t frames[BENCH_BACKUP];
+  int lastframe; // the last sv.framenum the client acknowledged, -1 for none
+} benchclient_t;
+
+static benchframe_t *bench_frames;
+static int bench_numframes, bench_maxframes;
+static entity_state_t *bench_states;
+static int bench_numstates, bench_maxstates;
+static int bench_maxentities; // in any one frame
+
+static benchclient_t *bench_clients;
+static int bench_numclients;
+static int bench_loss;
+static unsigned bench_seed;
+
+// what a client holds while it reads the demo
+static bool demo_present[MAX_EDICTS];
+static entity_state_t demo_states[MAX_EDICTS];
+static player_state_t demo_ps;
+static int demo_framenum;
+
+static int Bench_Rand(int range) {
+  bench_seed = bench_seed * 1103515245 + 12345;
+  return (bench_seed >> 8) % range;
+}
+
+static float Bench_Coord(int packed) { return (short)packed * (1.0 / 8); }
+
+static float Bench_Angle(int packed) { return (signed char)packed * (360.0 / 256); }
+
+/*
+================
+Bench_AddFrame
+
+Keeps the entities present in states, in entity order, as the next frame
+================
+*/
+static void Bench_AddFrame(const bool *present, const entity_state_t *states) {
+  benchframe_t *frame;
+  int e;
+
+  if(bench_numframes == bench_maxframes) {
+    bench_maxframes = bench_maxframes ? bench_maxframes * 2 : 1024;
+    bench_frames = realloc(bench_frames, bench_maxframes * sizeof(*bench_frames));
+  }
+  frame = &bench_frames[bench_numframes++];
+  frame->first = bench_numstates;
+  frame->num = 0;
+
+  for(e = 1; e < MAX_EDICTS; e++) {
+    if(!present[e])
+      continue;
+    if(bench_numstates == bench_maxstates) {
+      bench_maxstates = bench_maxstates ? bench_maxstates * 2 : 65536;
+      bench_states = realloc(bench_states, bench_maxstates * sizeof(*bench_states));
+    }
+    bench_states[bench_numstates++] = states[e];
+    frame->num++;
+  }
+
+  if(frame->num > bench_maxentities)
+    bench_maxentities = frame->num;
+}
+
+/*
+================
+Bench_MakeGame
+
+A made up game for when there is no demo: a few players running about,
+monsters and projectiles moving, and items and doors that mostly stand
+still
+================
+*/
+static void Bench_MakeGame(void) {
+  static bool present[MAX_EDICTS];
+  static entity_state_t states[MAX_EDICTS];
+  entity_state_t *s;
+  int f, e, i;
+
+  bench_seed = 1;
+  maxclients->value = 8;
+
+  for(e = 1; e <= BENCH_ENTITIES; e++) {
+    s = &states[e];
+    s->number = e;
+    s->modelindex = e <= maxclients->value ? 255 : 1 + Bench_Rand(200);
+    s->solid = Bench_Rand(32768);
+    for(i = 0; i < 3; i++) {
+      s->origin[i] = Bench_Coord(Bench_Rand(65536));
+      s->angles[i] = Bench_Angle(Bench_Rand(256));
+    }
+    VectorCopy(s->origin, s->old_origin);
+    sv.baselines[e] = *s;
+    present[e] = true;
+  }
+
+  for(f = 0; f < BENCH_FRAMES; f++) {
+    for(e = 1; e <= BENCH_ENTITIES; e++) {
+      s = &states[e];
+      s->event = 0;
+      VectorCopy(s->origin, s->old_origin);
+
+      // a third stand still, like items and closed doors
+      if(e > maxclients->value && e % 3 == 0)
+        continue;
+
+      if(e > maxclients->value && !Bench_Rand(200)) {
+        present[e] = !present[e];
+        continue;
+      }
+
+      for(i = 0; i < 2; i++)
+        s->origin[i] = Bench_Coord(MSG_PackCoord(s->origin[i]) + Bench_Rand(129) - 64);
+      if(!Bench_Rand(4))
+        s->origin[2] = Bench_Coord(MSG_PackCoord(s->origin[2]) + Bench_Rand(33) - 16);
+      if(Bench_Rand(2))
+        s->angles[YAW] = Bench_Angle(MSG_PackAngle(s->angles[YAW]) + Bench_Rand(17) - 8);
+      s->frame = (s->frame + 1) % 200;
+      if(!Bench_Rand(32))
+        s->event = 1 + Bench_Rand(10);
+    }
+    Bench_AddFrame(present, states);
+  }
+}
+
+/*
+================
+Bench_SkipSound
+
+CL_ParseStartSoundPacket, only to get past it
+================
+*/
+static void Bench_SkipSound(sizebuf_t *msg) {
+  int flags;
+
+  flags = MSG_ReadByte(msg);
+  MSG_ReadByte(msg);
+  if(flags & SND_VOLUME)
+    MSG_ReadByte(msg);
+  if(flags & SND_ATTENUATION)
+    MSG_ReadByte(msg);
+  if(flags & SND_OFFSET)
+    MSG_ReadByte(msg);
+  if(flags & SND_ENT)
+    MSG_ReadShort(msg);
+  if(flags & SND_POS) {
+    MSG_ReadShort(msg);
+    MSG_ReadShort(msg);
+    MSG_ReadShort(msg);
+  }
+}
+
+/*
+================
+Bench_ParseFrame
+
+CL_ParseFrame for protocol 34, over an array of every entity rather
+than the client's frame ring.  Returns false when the frame is delta
+compressed from one that was not read, after which no later frame can
+be rebuilt either.
+================
+*/
+static bool Bench_ParseFrame(sizebuf_t *msg) {
+  entity_state_t *to;
+  int serverframe, deltaframe, len, number, i;
+  unsigned bits;
+
+  serverframe = MSG_ReadLong(msg);
+  deltaframe = MSG_ReadLong(msg);
+  MSG_ReadByte(msg); // surpressCount
+
+  if(deltaframe > 0 && deltaframe != demo_framenum) {
+    Com_Printf("frame %i is delta compressed from %i, which was not read\n", serverframe, deltaframe);
+    return false;
+  }
+
+  len = MSG_ReadByte(msg);
+  msg->readcount += len; // areabits
+
+  if(MSG_ReadByte(msg) != svc_playerinfo)
+    Com_Error(ERR_FATAL, "frame %i: not playerinfo", serverframe);
+  if(deltaframe <= 0)
+    memset(&demo_ps, 0, sizeof(demo_ps));
+  MSG_ReadDeltaPlayerstate(msg, &demo_ps);
+
+  if(MSG_ReadByte(msg) != svc_packetentities)
+    Com_Error(ERR_FATAL, "frame %i: not packetentities", serverframe);
+
+  // the entities a delta leaves out go on unchanged with no event
+  if(deltaframe <= 0)
+    memset(demo_present, 0, sizeof(demo_present));
+  for(i = 0; i < MAX_EDICTS; i++) {
+    VectorCopy(demo_states[i].origin, demo_states[i].old_origin);
+    demo_states[i].event = 0;
+  }
+
+  while(1) {
+    number = MSG_ReadEntityBits(msg, &bits);
+    if(msg->readcount > msg->cursize)
+      Com_Error(ERR_FATAL, "frame %i: end of message", serverframe);
+    if(number < 0 || number >= MAX_EDICTS)
+      Com_Error(ERR_FATAL, "frame %i: bad entity %i", serverframe, number);
+    if(!number)
+      break;
+
+    if(bits & U_REMOVE) {
+      demo_present[number] = false;
+      continue;
+    }
+
+    to = &demo_states[number];
+    if(!demo_present[number]) {
+      *to = sv.baselines[number];
+      VectorCopy(to->origin, to->old_origin);
+    }
+    to->number = number;
+    MSG_ReadDeltaEntity(msg, to, bits);
+    demo_present[number] = true;
+  }
+
+  demo_framenum = serverframe;
+  Bench_AddFrame(demo_present, demo_states);
+  return true;
+}
+
+/*
+================
+Bench_ParseMessage
+
+CL_ParseServerMessage up to the frame.  The sounds and temp entities
+after it are not needed.  A message with anything before its frame that
+is not parsed here is skipped.  Returns false when no later frame can be
+read.
+================
+*/
+static bool Bench_ParseMessage(sizebuf_t *msg) {
+  entity_state_t nullstate, *es;
+  unsigned bits;
+  int cmd, i, number;
+  char *s;
+
+  while(1) {
+    if(msg->readcount > msg->cursize)
+      Com_Error(ERR_FATAL, "read past the end of a message");
+
+    cmd = MSG_ReadByte(msg);
+    if(cmd == -1)
+      return true;
+
+    switch(cmd) {
+    case svc_nop:
+    case svc_disconnect:
+    case svc_reconnect:
+      break;
+
+    case svc_muzzleflash:
+    case svc_muzzleflash2:
+      MSG_ReadShort(msg);
+      MSG_ReadByte(msg);
+      break;
+
+    case svc_layout:
+    case svc_stufftext:
+    case svc_centerprint:
+      MSG_ReadString(msg);
+      break;
+
+    case svc_print:
+      MSG_ReadByte(msg);
+      MSG_ReadString(msg);
+      break;
+
+    case svc_inventory:
+      for(i = 0; i < MAX_ITEMS; i++)
+        MSG_ReadShort(msg);
+      break;
+
+    case svc_sound:
+      Bench_SkipSound(msg);
+      break;
+
+    case svc_serverdata:
+      i = MSG_ReadLong(msg);
+      if(i != PROTOCOL_VERSION_OLD)
+        Com_Error(ERR_FATAL, "protocol %i demo, only %i is read", i, PROTOCOL_VERSION_OLD);
+      MSG_ReadLong(msg);   // servercount
+      MSG_ReadByte(msg);   // attractloop
+      MSG_ReadString(msg); // gamedir
+      MSG_ReadShort(msg);  // playernum
+      MSG_ReadString(msg); // levelname
+      memset(sv.baselines, 0, sizeof(sv.baselines));
+      demo_framenum = -1;
+      break;
+
+    case svc_configstring:
+      i = MSG_ReadShort(msg);
+      s = MSG_ReadString(msg);
+      if(i == CS_MAXCLIENTS)
+        maxclients->value = atoi(s);
+      break;
+
+    case svc_spawnbaseline:
+      memset(&nullstate, 0, sizeof(nullstate));
+      number = MSG_ReadEntityBits(msg, &bits);
+      if(number < 0 || number >= MAX_EDICTS)
+        Com_Error(ERR_FATAL, "baseline for entity %i", number);
+      es = &sv.baselines[number];
+      *es = nullstate;
+      es->number = number;
+      MSG_ReadDeltaEntity(msg, es, bits);
+      break;
+
+    case svc_frame:
+      return Bench_ParseFrame(msg);
+
+    default:
+      Com_Printf("skipped a message with svc %i before its frame\n", cmd);
+      return true;
+    }
+  }
+}
+
+/*
+================
+Bench_ReadDemo
+
+A .dm2 file is the server messages the client got, each with its length
+in front and a length of -1 at the end
+================
+*/
+static void Bench_ReadDemo(const char *name) {
+  static byte data[MAX_MSGLEN];
+  sizebuf_t msg;
+  FILE *file;
+  int len;
+
+  file = fopen(name, "rb");
+  if(!file)
+    Com_Error(ERR_FATAL, "couldn't read %s", name);
+
+  demo_framenum = -1;
+
+  while(fread(&len, 4, 1, file) == 1) {
+    len = LittleLong(len);
+    if(len == -1)
+      break;
+    if(len < 0 || len > MAX_MSGLEN)
+      Com_Error(ERR_FATAL, "%s: message of %i bytes", name, len);
+    if(fread(data, len, 1, file) != 1)
+      Com_Error(ERR_FATAL, "%s: ends in a message", name);
+
+    SZ_Init(&msg, data, sizeof(data));
+    msg.cursize = len;
+    if(!Bench_ParseMessage(&msg))
+      break;
+  }
+
+  fclose(file);
+
+  if(!bench_numframes)
+    Com_Error(ERR_FATAL, "%s: no frames read", name);
+}
+
+/*
+================
+Bench_Send
+
+Sends every frame to every client, returns the nanoseconds spent in
+SV_EmitPacketEntities.  The same clients lose the same frames on every
+run, so the bytes written only depend on the encoder.
+================
+*/
+static uint64_t Bench_Send(int protocol, int64_t *bytes, unsigned *hash) {
+  static byte data[BENCH_MSGLEN];
+  benchclient_t *cl;
+  benchframe_t *frame;
+  client_frame_t *from, *to;
+  sizebuf_t msg;
+  uint64_t start, elapsed;
+  int f, c, i;
+
+  bench_seed = 1;
+  for(c = 0; c < bench_numclients; c++)
+    bench_clients[c].lastframe = -1;
+  svs.next_client_entities = 0;
+
+  SZ_Init(&msg, data, sizeof(data));
+  elapsed = 0;
+  *bytes = 0;
+  *hash = 2166136261u;
+
+  for(f = 0; f < bench_numframes; f++) {
+    frame = &bench_frames[f];
+    sv.framenum++; // never reused, the cache tells frames apart by it
+
+    for(c = 0; c < bench_numclients; c++) {
+      cl = &bench_clients[c];
+
+      // what SV_BuildClientFrame leaves behind
+      to = &cl->frames[sv.framenum % BENCH_BACKUP];
+      to->first_entity = svs.next_client_entities;
+      to->num_entities = frame->num;
+      for(i = 0; i < frame->num; i++)
+        svs.client_entities[(to->first_entity + i) % svs.num_client_entities] = bench_states[frame->first + i];
+      svs.next_client_entities += frame->num;
+
+      // what SV_WriteFrameToClient deltas from
+      from = NULL;
+      if(cl->lastframe > 0 && sv.framenum - cl->lastframe < BENCH_BACKUP - 3)
+        from = &cl->frames[cl->lastframe % BENCH_BACKUP];
+
+      SZ_Clear(&msg);
+      start = uv_hrtime();
+      SV_EmitPacketEntities(from, to, &msg, protocol);
+      elapsed += uv_hrtime() - start;
+
+      *bytes += msg.cursize;
+      for(i = 0; i < msg.cursize; i++)
+        *hash = (*hash ^ msg.data[i]) * 16777619u;
+
+      if(Bench_Rand(100) >= bench_loss)
+        cl->lastframe = sv.framenum;
+    }
+  }
+
+  return elapsed;
+}
+
+int main(int argc, char **argv) {
+  static const int protocols[] = {PROTOCOL_VERSION_OLD, PROTOCOL_VERSION};
+  uint64_t time[2];
+  int64_t bytes[2];
+  unsigned hash[2];
+  int p, cache, mismatches;
+
+  bench_numclients = argc > 1 ? atoi(argv[1]) : 64;
+  if(bench_numclients < 1)
+    bench_numclients = 1;
+  bench_loss = argc > 2 ? atoi(argv[2]) : 5;
+
+  maxclients = Cvar_Get("maxclients", "1", 0);
+  sv_deltacache = Cvar_Get("sv_deltacache", "1", 0);
+  sv_snapshot_threads = Cvar_Get("sv_snapshot_threads", "0", 0);
+
+  if(argc > 3) {
+    Bench_ReadDemo(argv[3]);
+    printf("%s: ", argv[3]);
+  } else {
+    Bench_MakeGame();
+    printf("made up game: ");
+  }
+  printf("%i frames, up to %i entities, maxclients %g\n", bench_numframes, bench_maxentities, maxclients->value);
+  printf("%i clients, %i%% of frames not acknowledged\n", bench_numclients, bench_loss);
+
+  bench_clients = calloc(bench_numclients, sizeof(*bench_clients));
+  svs.num_client_entities = bench_numclients * BENCH_BACKUP * (bench_maxentities ? bench_maxentities : 1);
+  svs.client_entities = calloc(svs.num_client_entities, sizeof(entity_state_t));
+
+  mismatches = 0;
+  for(p = 0; p < 2; p++) {
+    for(cache = 0; cache < 2; cache++) {
+      sv_deltacache->value = cache;
+      time[cache] = Bench_Send(protocols[p], &bytes[cache], &hash[cache]);
+    }
+
+    printf("\nprotocol %i, %.1f bytes/frame to each client\n", protocols[p],
+           (double)bytes[0] / bench_numframes / bench_numclients);
+    printf("sv_deltacache 0 %10.3f usec/frame\n", time[0] / 1e3 / bench_numframes);
+    printf("sv_deltacache 1 %10.3f usec/frame, %.2fx\n", time[1] / 1e3 / bench_numframes,
+           (double)time[0] / (time[1] ? time[1] : 1));
+    SV_DeltaStats_f();
+
+    if(bytes[0] != bytes[1] || hash[0] != hash[1]) {
+      printf("the cache changed what was written\n");
+      mismatches++;
+    }
+  }
+
+  return mismatches != 0;
+}
@@ -0,0 +1,604 @@
+/*
+Copyright (C) 1997-2001 Id Software, Inc.
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+// demo_bench.c -- records a serverrecord demo and plays it back the way a client reads it
+//
+// usage: demo_bench [frames] [seed]
+//
+// Runs a made up game through SV_RecordDemoMessage, with a map change
+// half way, into demo_bench.svd in the current directory.  Then reads the
+// demo back through SV_DemoReadPlayback, as demomap sends it, and parses
+// every message the way a protocol 34 client does, with the client's own
+// readers.  Every frame has to show the entities, the view and the prints
+// that were recorded, once from the start and once from a keyframe in the
+// middle.  Then reports the demo size and times recording and playback.
+
+#include "server.h"
+
+#include <uv.h>
+
+#define BENCH_ENTITIES 24 // few enough that every frame fits in one message
+#define BENCH_MSEC 100    // between frames
+
+// what sv_demo.c needs from the rest of the server
+server_static_t svs;
+server_t sv;
+game_export_t *ge;
+cvar_t *maxclients;
+cvar_t *sv_demokeyframe;
+
+static uv_loop_t bench_loop;
+
+void *global_uv_loop(void) { return &bench_loop; }
+
+const char *FS_Gamedir(void) { return "."; }
+
+typedef struct {
+  int spawncount;
+  bool visible[BENCH_ENTITIES + 1];
+  entity_state_t states[BENCH_ENTITIES + 1];
+  player_state_t ps; // the view the demo is watched from
+  char print[32];
+} benchframe_t;
+
+// what a client holds while it reads the demo
+typedef struct {
+  int spawncount;
+  int playernum;
+  bool precached; // since the last serverdata
+  int framenum;   // of the last frame read, -1 after a serverdata
+  bool present[MAX_EDICTS];
+  entity_state_t states[MAX_EDICTS];
+  player_state_t ps;
+  char print[32];
+} benchclient_t;
+
+static edict_t bench_edicts[MAX_EDICTS];
+static gclient_t bench_gclient;
+static client_t bench_client;
+static game_export_t bench_ge;
+
+static benchframe_t *bench_frames;
+static int *bench_framenums; // the demo's number for each frame recorded
+static int bench_numframes;
+static int bench_mismatches;
+static unsigned bench_seed;
+
+static int Bench_Rand(int range) {
+  bench_seed = bench_seed * 1103515245 + 12345;
+  return (bench_seed >> 8) % range;
+}
+
+static float Bench_Coord(int packed) { return (short)packed * (1.0 / 8); }
+
+static float Bench_Angle(int packed) { return (signed char)packed * (360.0 / 256); }
+
+static float Bench_Quarter(int packed) { return (signed char)packed * 0.25; }
+
+static void Bench_Mismatch(int frame, const char *what) {
+  if(bench_mismatches < 10)
+    printf("frame %i: %s\n", frame, what);
+  bench_mismatches++;
+}
+
+/*
+================
+Bench_MovePlayer
+
+The one client in the game, whose eyes the demo is watched from
+================
+*/
+static void Bench_MovePlayer(edict_t *ent) {
+  player_state_t *ps = &ent->client->ps;
+  int i;
+
+  for(i = 0; i < 3; i++) {
+    ps->pmove.origin[i] += Bench_Rand(65) - 32;
+    ps->viewangles[i] = SHORT2ANGLE((short)(ANGLE2SHORT(ps->viewangles[i]) + Bench_Rand(513) - 256));
+    ent->s.origin[i] = ps->pmove.origin[i] * 0.125;
+  }
+  if(!Bench_Rand(8))
+    ps->viewoffset[2] = Bench_Quarter(Bench_Rand(256));
+  if(!Bench_Rand(64))
+    ps->fov = 60 + Bench_Rand(60);
+  if(!Bench_Rand(64))
+    ps->rdflags = Bench_Rand(256);
+
+  // none of these are the spectator's
+  ps->pmove.velocity[0] = Bench_Rand(801) - 400;
+  ps->gunindex = 1 + Bench_Rand(255);
+  ps->gunframe = Bench_Rand(256);
+  ps->blend[3] = Bench_Rand(256) / 255.0;
+  for(i = 0; i < MAX_STATS; i++)
+    ps->stats[i] = Bench_Rand(65536) - 32768;
+
+  ent->s.frame = (ent->s.frame + 1) % 200;
+}
+
+/*
+================
+Bench_MoveEntity
+
+Spawns, removes, hides and moves the other entities
+================
+*/
+static void Bench_MoveEntity(edict_t *ent, int number) {
+  entity_state_t *s = &ent->s;
+  int i;
+
+  s->event = 0;
+
+  if(ent->inuse && !Bench_Rand(100)) {
+    ent->inuse = false;
+    return;
+  }
+
+  if(!ent->inuse) {
+    if(Bench_Rand(4))
+      return;
+    memset(s, 0, sizeof(*s));
+    s->number = number;
+    s->modelindex = 1 + Bench_Rand(255);
+    s->solid = Bench_Rand(32768);
+    for(i = 0; i < 3; i++) {
+      s->origin[i] = Bench_Coord(Bench_Rand(65536));
+      s->angles[i] = Bench_Angle(Bench_Rand(256));
+    }
+    ent->inuse = true;
+    ent->svflags = 0;
+    return;
+  }
+
+  if(!Bench_Rand(50))
+    ent->svflags ^= SVF_NOCLIENT;
+
+  for(i = 0; i < 3; i++)
+    s->origin[i] = Bench_Coord(MSG_PackCoord(s->origin[i]) + Bench_Rand(65) - 32);
+  if(!Bench_Rand(3))
+    s->angles[YAW] = Bench_Angle(MSG_PackAngle(s->angles[YAW]) + Bench_Rand(17) - 8);
+  if(Bench_Rand(2))
+    s->frame = (s->frame + 1) % 300;
+  if(!Bench_Rand(32))
+    s->effects = Bench_Rand(65536) << Bench_Rand(16);
+  // protocol 34 reads a 16 bit skin back signed
+  if(!Bench_Rand(64))
+    s->skinnum = Bench_Rand(2) ? Bench_Rand(32768) : Bench_Rand(32768) << 16;
+  if(!Bench_Rand(64))
+    s->modelindex2 = Bench_Rand(256);
+  if(!Bench_Rand(16))
+    s->sound = Bench_Rand(256);
+  if(!Bench_Rand(10))
+    s->event = 1 + Bench_Rand(255);
+}
+
+/*
+================
+Bench_RunFrame
+
+Moves the game on a frame, multicasts a print now and then, and notes
+what a client should see of it
+================
+*/
+static void Bench_RunFrame(benchframe_t *frame, int f) {
+  player_state_t *view;
+  edict_t *ent;
+  int e;
+
+  for(e = 1; e <= BENCH_ENTITIES; e++) {
+    ent = EDICT_NUM(e);
+    if(ent->client)
+      Bench_MovePlayer(ent);
+    else
+      Bench_MoveEntity(ent, e);
+
+    frame->visible[e] = ent->inuse && !(ent->svflags & SVF_NOCLIENT);
+    frame->states[e] = ent->s;
+  }
+
+  if(!Bench_Rand(3)) {
+    sprintf(frame->print, "frame %i\n", f);
+    MSG_WriteByte(&svs.demo_multicast, svc_print);
+    MSG_WriteByte(&svs.demo_multicast, PRINT_HIGH);
+    MSG_WriteString(&svs.demo_multicast, frame->print);
+  }
+
+  view = &bench_gclient.ps;
+  VectorCopy(view->pmove.origin, frame->ps.pmove.origin);
+  VectorCopy(view->viewoffset, frame->ps.viewoffset);
+  VectorCopy(view->viewangles, frame->ps.viewangles);
+  frame->ps.fov = view->fov;
+  frame->ps.rdflags = view->rdflags;
+  frame->ps.pmove.pm_type = PM_FREEZE;
+  frame->ps.pmove.pm_flags = PMF_NO_PREDICTION;
+  frame->spawncount = svs.spawncount;
+}
+
+/*
+================
+Bench_SpawnMap
+
+What SV_SpawnServer leaves behind that the recording looks at
+================
+*/
+static void Bench_SpawnMap(int map) {
+  svs.spawncount++;
+  sv.state = ss_game;
+  sv.framenum = 0;
+  sv.frametime = BENCH_MSEC;
+  memset(sv.configstrings, 0, sizeof(sv.configstrings));
+  Com_sprintf(sv.configstrings[CS_NAME], sizeof(sv.configstrings[CS_NAME]), "bench map %i", map);
+  Com_sprintf(sv.configstrings[CS_MODELS + 1], sizeof(sv.configstrings[CS_MODELS + 1]), "maps/bench%i.bsp;%i", map,
+              map);
+  Com_sprintf(sv.configstrings[CS_FRAMETIME], sizeof(sv.configstrings[CS_FRAMETIME]), "%i", BENCH_MSEC);
+}
+
+static void Bench_InitGame(void) {
+  edict_t *ent;
+
+  bench_ge.edicts = bench_edicts;
+  bench_ge.edict_size = sizeof(edict_t);
+  bench_ge.num_edicts = MAX_EDICTS;
+  bench_ge.max_edicts = MAX_EDICTS;
+  ge = &bench_ge;
+
+  maxclients = Cvar_Get("maxclients", "1", 0);
+  sv_demokeyframe = Cvar_Get("sv_demokeyframe", "1", 0);
+
+  ent = EDICT_NUM(1);
+  ent->inuse = true;
+  ent->client = &bench_gclient;
+  ent->s.number = 1;
+  ent->s.modelindex = 255;
+  bench_gclient.ps.fov = 90;
+  bench_client.state = cs_spawned;
+  bench_client.edict = ent;
+  svs.clients = &bench_client;
+
+  // the entity of the client playing the demo back, it is never recorded
+  ent = EDICT_NUM(MAX_EDICTS - 1);
+  ent->inuse = true;
+  ent->s.number = MAX_EDICTS - 1;
+  ent->s.modelindex = 1;
+}
+
+/*
+================
+Bench_ParseFrame
+
+CL_ParseFrame for protocol 34, over an array of every entity rather
+than the client's frame ring.  Every delta has to be from the frame
+read before it.
+================
+*/
+static int Bench_ParseFrame(benchclient_t *cl, sizebuf_t *msg) {
+  entity_state_t nostate, *to;
+  byte areabits[MAX_MAP_AREAS / 8];
+  int serverframe, deltaframe, len, number, i;
+  unsigned bits;
+
+  serverframe = MSG_ReadLong(msg);
+  deltaframe = MSG_ReadLong(msg);
+  MSG_ReadByte(msg); // surpressCount
+
+  if(!cl->precached)
+    Com_Error(ERR_FATAL, "frame %i before the precache", serverframe);
+  if(deltaframe > 0 && deltaframe != cl->framenum)
+    Com_Error(ERR_FATAL, "frame %i is delta compressed from %i, not %i", serverframe, deltaframe, cl->framenum);
+
+  len = MSG_ReadByte(msg);
+  if(len != sizeof(areabits))
+    Com_Error(ERR_FATAL, "frame %i has %i bytes of areabits", serverframe, len);
+  MSG_ReadData(msg, areabits, len);
+  for(i = 0; i < len; i++)
+    if(areabits[i] != 255)
+      Com_Error(ERR_FATAL, "frame %i closes an area", serverframe);
+
+  if(MSG_ReadByte(msg) != svc_playerinfo)
+    Com_Error(ERR_FATAL, "frame %i: not playerinfo", serverframe);
+  if(deltaframe <= 0)
+    memset(&cl->ps, 0, sizeof(cl->ps));
+  MSG_ReadDeltaPlayerstate(msg, &cl->ps);
+
+  if(MSG_ReadByte(msg) != svc_packetentities)
+    Com_Error(ERR_FATAL, "frame %i: not packetentities", serverframe);
+
+  // a keyframe starts from the baselines, which the demo leaves empty,
+  // the entities a delta leaves out go on unchanged with no event
+  if(deltaframe <= 0)
+    memset(cl->present, 0, sizeof(cl->present));
+  for(i = 0; i < MAX_EDICTS; i++) {
+    VectorCopy(cl->states[i].origin, cl->states[i].old_origin);
+    cl->states[i].event = 0;
+  }
+
+  memset(&nostate, 0, sizeof(nostate));
+  for(;;) {
+    number = MSG_ReadEntityBits(msg, &bits);
+    if(!number)
+      break;
+    if(number >= MAX_EDICTS || msg->readcount > msg->cursize)
+      Com_Error(ERR_FATAL, "frame %i: bad entity %i", serverframe, number);
+    if(number == cl->playernum + 1)
+      Com_Error(ERR_FATAL, "frame %i sends the viewer's own entity", serverframe);
+
+    if(bits & U_REMOVE) {
+      cl->present[number] = false;
+      continue;
+    }
+
+    to = &cl->states[number];
+    if(!cl->present[number])
+      *to = nostate;
+    VectorCopy(to->origin, to->old_origin);
+    to->number = number;
+    MSG_ReadDeltaEntity(msg, to, bits);
+    cl->present[number] = true;
+  }
+
+  cl->framenum = serverframe;
+  return serverframe;
+}
+
+/*
+================
+Bench_ParseMessage
+
+CL_ParseServerMessage for what a demo holds.  Returns the number of the
+frame in the message, or -1 when there is none.
+================
+*/
+static int Bench_ParseMessage(benchclient_t *cl, sizebuf_t *msg) {
+  int cmd, framenum;
+  char *s;
+
+  framenum = -1;
+  cl->print[0] = 0;
+
+  MSG_BeginReading(msg);
+  for(;;) {
+    if(msg->readcount > msg->cursize)
+      Com_Error(ERR_FATAL, "message read past its end");
+
+    cmd = MSG_ReadByte(msg);
+    if(cmd == -1)
+      break;
+
+    switch(cmd) {
+    case svc_serverdata:
+      if(MSG_ReadLong(msg) != PROTOCOL_VERSION_OLD)
+        Com_Error(ERR_FATAL, "serverdata is not protocol %i", PROTOCOL_VERSION_OLD);
+      cl->spawncount = MSG_ReadLong(msg);
+      if(!MSG_ReadByte(msg))
+        Com_Error(ERR_FATAL, "serverdata is not an attract loop");
+      MSG_ReadString(msg); // gamedir
+      cl->playernum = MSG_ReadShort(msg);
+      if(cl->playernum < 0 || cl->playernum >= MAX_EDICTS - 1)
+        Com_Error(ERR_FATAL, "serverdata playernum %i plays a cinematic", cl->playernum);
+      MSG_ReadString(msg); // levelname
+      cl->precached = false;
+      cl->framenum = -1;
+      memset(cl->present, 0, sizeof(cl->present));
+      break;
+
+    case svc_configstring:
+      if((unsigned)MSG_ReadShort(msg) >= MAX_CONFIGSTRINGS)
+        Com_Error(ERR_FATAL, "configstring > MAX_CONFIGSTRINGS");
+      MSG_ReadString(msg);
+      break;
+
+    case svc_stufftext:
+      s = MSG_ReadString(msg);
+      if(!strcmp(s, "precache\n"))
+        cl->precached = true;
+      break;
+
+    case svc_print:
+      MSG_ReadByte(msg);
+      strncpy(cl->print, MSG_ReadString(msg), sizeof(cl->print) - 1);
+      break;
+
+    case svc_frame:
+      framenum = Bench_ParseFrame(cl, msg);
+      break;
+
+    default:
+      Com_Error(ERR_FATAL, "unexpected server message %i", cmd);
+    }
+  }
+
+  return framenum;
+}
+
+/*
+================
+Bench_CheckFrame
+
+What the client read against what frame f recorded
+================
+*/
+static void Bench_CheckFrame(benchclient_t *cl, int f) {
+  benchframe_t *frame = &bench_frames[f];
+  entity_state_t *a, *b;
+  player_state_t *ps = &cl->ps;
+  int e, i;
+
+  if(cl->spawncount != frame->spawncount)
+    Bench_Mismatch(f, "from the wrong map");
+
+  for(e = 1; e <= BENCH_ENTITIES; e++) {
+    if(cl->present[e] != frame->visible[e]) {
+      Bench_Mismatch(f, cl->present[e] ? "an entity that isn't there" : "an entity missing");
+      continue;
+    }
+    if(!frame->visible[e])
+      continue;
+
+    a = &cl->states[e];
+    b = &frame->states[e];
+    for(i = 0; i < 3; i++)
+      if(MSG_PackCoord(a->origin[i]) != MSG_PackCoord(b->origin[i]) ||
+         MSG_PackAngle(a->angles[i]) != MSG_PackAngle(b->angles[i]))
+        break;
+    if(i < 3 || a->modelindex != b->modelindex || a->modelindex2 != b->modelindex2 || a->frame != b->frame ||
+       a->skinnum != b->skinnum || a->effects != b->effects || a->solid != b->solid || a->sound != b->sound ||
+       a->event != b->event)
+      Bench_Mismatch(f, "entity state");
+  }
+
+  for(i = 0; i < 3; i++)
+    if(ps->pmove.origin[i] != frame->ps.pmove.origin[i] ||
+       ANGLE2SHORT(ps->viewangles[i]) != ANGLE2SHORT(frame->ps.viewangles[i]) ||
+       ps->viewoffset[i] != frame->ps.viewoffset[i])
+      break;
+  if(i < 3 || ps->fov != frame->ps.fov || ps->rdflags != frame->ps.rdflags ||
+     ps->pmove.pm_type != frame->ps.pmove.pm_type || ps->pmove.pm_flags != frame->ps.pmove.pm_flags)
+    Bench_Mismatch(f, "view");
+  if(ps->gunindex || ps->gunframe || ps->blend[3] || ps->pmove.velocity[0])
+    Bench_Mismatch(f, "the recorded client's gun or movement in the view");
+  for(i = 0; i < MAX_STATS; i++)
+    if(ps->stats[i])
+      break;
+  if(i < MAX_STATS)
+    Bench_Mismatch(f, "the recorded client's stats in the view");
+
+  if(strcmp(cl->print, frame->print))
+    Bench_Mismatch(f, "multicast print");
+}
+
+/*
+================
+Bench_Play
+
+Plays the demo back from its first frame, or from the keyframe frame f
+was recorded as, checking every frame on the way.  Returns the frames
+read.
+================
+*/
+static int Bench_Play(demoreader_t *r, int f) {
+  static benchclient_t cl;
+  sizebuf_t msg;
+  int framenum;
+
+  memset(&cl, 0, sizeof(cl));
+  cl.framenum = -1;
+
+  if(f && SV_DemoSeek(r, bench_framenums[f]) != bench_framenums[f])
+    Com_Error(ERR_FATAL, "couldn't seek to frame %i", bench_framenums[f]);
+
+  while(SV_DemoReadPlayback(r, &msg)) {
+    framenum = Bench_ParseMessage(&cl, &msg);
+    if(framenum == -1)
+      continue;
+    if(f == bench_numframes)
+      Com_Error(ERR_FATAL, "frame %i past the end", framenum);
+    if(bench_framenums[f] == -1)
+      bench_framenums[f] = framenum;
+    else if(framenum != bench_framenums[f])
+      Com_Error(ERR_FATAL, "frame %i where %i should be", framenum, bench_framenums[f]);
+    Bench_CheckFrame(&cl, f);
+    f++;
+  }
+
+  return f;
+}
+
+int main(int argc, char **argv) {
+  const char *name = "demo_bench.svd";
+  demoreader_t *r;
+  FILE *file;
+  long size;
+  int f, seekframe, key, keyframes;
+  uint64_t start, recordtime, playtime;
+
+  bench_numframes = argc > 1 ? atoi(argv[1]) : 6000;
+  if(bench_numframes < 2)
+    bench_numframes = 2;
+  bench_seed = argc > 2 ? atoi(argv[2]) : 1;
+
+  bench_frames = calloc(bench_numframes, sizeof(*bench_frames));
+  bench_framenums = malloc(bench_numframes * sizeof(*bench_framenums));
+  for(f = 0; f < bench_numframes; f++)
+    bench_framenums[f] = -1;
+
+  uv_loop_init(&bench_loop);
+  Bench_InitGame();
+  Bench_SpawnMap(1);
+
+  //
+  // record, letting every write finish so no block is dropped
+  //
+  if(!SV_DemoStartRecord(name))
+    Com_Error(ERR_FATAL, "couldn't write %s", name);
+
+  recordtime = 0;
+  for(f = 0; f < bench_numframes; f++) {
+    if(f == bench_numframes / 2)
+      Bench_SpawnMap(2);
+    sv.framenum++;
+    sv.time = sv.framenum * sv.frametime;
+    Bench_RunFrame(&bench_frames[f], f);
+
+    start = uv_hrtime();
+    SV_RecordDemoMessage();
+    recordtime += uv_hrtime() - start;
+
+    uv_run(&bench_loop, UV_RUN_DEFAULT);
+  }
+
+  SV_DemoStopRecord();
+  uv_run(&bench_loop, UV_RUN_DEFAULT);
+
+  file = fopen(name, "rb");
+  if(!file)
+    Com_Error(ERR_FATAL, "couldn't read %s", name);
+  fseek(file, 0, SEEK_END);
+  size = ftell(file);
+  fclose(file);
+
+  //
+  // play it back from the start, then from a keyframe in the middle
+  //
+  r = SV_DemoOpen(name);
+  if(!r)
+    Com_Error(ERR_FATAL, "couldn't open %s", name);
+  start = uv_hrtime();
+  f = Bench_Play(r, 0);
+  playtime = uv_hrtime() - start;
+  if(f != bench_numframes)
+    Com_Error(ERR_FATAL, "%i of %i frames played back", f, bench_numframes);
+  keyframes = SV_DemoNumKeyframes(r);
+  key = SV_DemoKeyframe(r, keyframes / 2);
+  SV_DemoCloseReader(r);
+
+  for(seekframe = 0; bench_framenums[seekframe] != key; seekframe++)
+    ;
+  r = SV_DemoOpen(name);
+  if(Bench_Play(r, seekframe) != bench_numframes)
+    Com_Error(ERR_FATAL, "playing back from frame %i stopped early", key);
+  SV_DemoCloseReader(r);
+
+  remove(name);
+
+  printf("%i frames, %i keyframes, %i mismatches\n", bench_numframes, keyframes, bench_mismatches);
+  printf("%.1f bytes/frame on disk\n", (double)size / bench_numframes);
+  printf("record %8.3f usec/frame\n", recordtime / 1e3 / bench_numframes);
+  printf("play   %8.3f usec/frame\n", playtime / 1e3 / bench_numframes);
+
+  return bench_mismatches != 0;
+}
@@ -47,8 +47,10 @@ typedef struct {
   bool attractloop; // running cinematics and demos for the local system only
   bool loadgame;    // client begins should reuse existing entity
 
-  unsigned time; // always sv.framenum * 100 msec
+  unsigned time;  // always sv.framenum * sv.frametime msec
   int framenum;
+  int frametime;     // msec per server frame, from sv_fps when the server was spawned
+  unsigned gametime; // sv.time the next game frame is due at
 
   char name[MAX_QPATH]; // map name, or cinematic name
   struct cmodel_s *models[CMODEL_COUNT][MAX_MODELS];
@@ -63,7 +65,8 @@ typedef struct {
 
   // demo server information
   FILE *demofile;
-  bool timedemo; // don't time sync
+  struct demoreader_s *demoreader; // a serverrecord .svd instead of demofile
+  bool timedemo;                   // don't time sync
 } server_t;
 
 #define EDICT_NUM(n) ((edict_t *)((byte *)ge->edicts + ge->edict_size * (n)))
@@ -116,7 +119,7 @@ typedef struct client_s {
   sizebuf_t datagram;
   byte datagram_buf[MAX_MSGLEN];
 
-  client_frame_t frames[UPDATE_BACKUP]; // updates can be delta'd from here
+  client_frame_t *frames; // [svs.update_backup], updates can be delta'd from here
 
   byte *download;    // file being downloaded
   int downloadsize;  // total bytes (can't use EOF because of paks)
@@ -126,6 +129,7 @@ typedef struct client_s {
   int lastconnect;
 
   int challenge; // challenge of this user, randomly generated
+  int protocol;  // PROTOCOL_VERSION, or PROTOCOL_VERSION_OLD for old clients
 
   netchan_t netchan;
 } client_t;
@@ -149,6 +153,8 @@ typedef struct {
   int time;
 } challenge_t;
 
+typedef struct demowriter_s demowriter_t; // sv_demo.c
+
 typedef struct {
   bool initialized; // sv_init has completed
   int realtime;     // always increasing, no clamping, etc
@@ -159,7 +165,8 @@ typedef struct {
                   // used to check late spawns
 
   client_t *clients;               // [maxclients->value];
-  int num_client_entities;         // maxclients->value*UPDATE_BACKUP*MAX_PACKET_ENTITIES
+  int update_backup;               // frames a client can delta from, UPDATE_BACKUP_MSEC at sv_fps
+  int num_client_entities;         // maxclients->value*update_backup*MAX_PACKET_ENTITIES
   int next_client_entities;        // next client_entity to use
   entity_state_t *client_entities; // [num_client_entities]
 
@@ -168,7 +175,7 @@ typedef struct {
   challenge_t challenges[MAX_CHALLENGES]; // to prevent invalid IPs from connecting
 
   // serverrecord values
-  FILE *demofile;
+  demowriter_t *demowriter;
   sizebuf_t demo_multicast;
   byte demo_multicast_buf[MAX_MSGLEN];
 } server_static_t;
@@ -191,6 +198,12 @@ extern cvar_t *sv_noreload;      // don't reload level state when reentering
 extern cvar_t *sv_airaccelerate; // don't reload level state when reentering
                                  // development tool
 extern cvar_t *sv_enforcetime;
+extern cvar_t *sv_snapshot_threads; // build client frames on this many workers, 0 = serial
+extern cvar_t *sv_broadphase;       // 0 = areanode tree, 1 = loose grid, applied when the world is cleared
+extern cvar_t *sv_fps;              // server frames per second, the game still runs every GAME_FRAMEMSEC
+extern cvar_t *sv_deltacache;       // encode each distinct entity delta once and copy it to every client
+extern cvar_t *sv_savedatabase;     // keep game and level saves as blobs in sv_database instead of files
+extern cvar_t *sv_demokeyframe;     // seconds between the keyframes of a serverrecord demo
 
 extern client_t *sv_client;
 extern edict_t *sv_player;
@@ -218,6 +231,8 @@ void SV_UserinfoChanged(client_t *cl);
 void Master_Heartbeat(void);
 void Master_Packet(void);
 
+void SV_TickStats_f(void);
+
 //
 // sv_init.c
 //
@@ -247,6 +262,7 @@ void SV_StartSound(vec3_t origin, edict_t *entity, int channel, int soundindex,
                    float timeofs);
 void SV_ClientPrintf(client_t *cl, int level, char *fmt, ...);
 void SV_BroadcastPrintf(int level, char *fmt, ...);
+void SV_MulticastBench_f(void);
 void SV_BroadcastCommand(char *fmt, ...);
 
 //
@@ -260,13 +276,37 @@ void SV_ExecuteClientMessage(client_t *cl);
 //
 void SV_ReadLevelFile(void);
 void SV_Status_f(void);
+bool SV_WriteSave(const char *name, const void *data, int length);
+int SV_ReadSave(const char *name, void **data);
+
+//
+// sv_demo.c
+//
+typedef struct demoreader_s demoreader_t;
+
+bool SV_DemoStartRecord(const char *name);
+void SV_DemoStopRecord(void);
+void SV_RecordDemoMessage(void);
+
+demoreader_t *SV_DemoOpen(const char *name);
+void SV_DemoCloseReader(demoreader_t *r);
+int SV_DemoFrameTime(demoreader_t *r);
+int SV_DemoNumKeyframes(demoreader_t *r);
+int SV_DemoKeyframe(demoreader_t *r, int i);
+int SV_DemoSeek(demoreader_t *r, int framenum);
+bool SV_DemoReadMessage(demoreader_t *r, sizebuf_t *msg);
+bool SV_DemoReadPlayback(demoreader_t *r, sizebuf_t *msg);
+void SV_ServerDemoInfo_f(void);
 
 //
 // sv_ents.c
 //
 void SV_WriteFrameToClient(client_t *client, sizebuf_t *msg);
-void SV_RecordDemoMessage(void);
+void SV_EmitPacketEntities(client_frame_t *from, client_frame_t *to, sizebuf_t *msg, int protocol);
 void SV_BuildClientFrame(client_t *client);
+void SV_BuildClientFrames(const bool *build); // build[maxclients->value]
+void SV_ShutdownSnapshotThreads(void);
+void SV_DeltaStats_f(void);
 
 void SV_Error(char *error, ...);
 
@@ -299,6 +339,20 @@ void SV_LinkEdict(edict_t *ent);
 // sets ent->leafnums[] for pvs determination even if the entity
 // is not solid
 
+void SV_ClusterEdicts(int cmodel_index, const byte *visbits, unsigned *edictbits);
+// sets the bit for every entity that was last linked into one of the
+// clusters in visbits, plus every entity that must always be checked
+// (too many leafs, or beams).  edictbits holds MAX_EDICTS bits.
+
+void SV_UpdateClientLeafs(void);
+// looks up the cluster and area of every client again, called once a
+// frame, linking a client edict updates it as well
+
+void SV_ClusterClients(int cmodel_index, int area, const byte *visbits, unsigned *clientbits);
+// sets the bit for every client on the collision map in one of the
+// clusters in visbits and an area connected to area.  clientbits holds
+// MAX_CLIENTS bits.
+
 int SV_AreaEdicts(int cmodel_index, vec3_t mins, vec3_t maxs, edict_t **list, int maxcount, int areatype);
 // fills in a table of edict pointers with edicts that have bounding boxes
 // that intersect the given area.  It is possible for a non-axial bmodel
@@ -307,6 +361,19 @@ int SV_AreaEdicts(int cmodel_index, vec3_t mins, vec3_t maxs, edict_t **list, in
 // returns the number of pointers filled in
 // ??? does this always return the world?
 
+int SV_SphereEdicts(int cmodel_index, vec3_t origin, float radius, edict_t **list, int maxcount);
+// fills in a table of edict pointers, sorted by edict number, with the
+// linked edicts whose bounding box center is within radius of origin.
+// This is the test the game's findradius makes.
+// returns the number of pointers filled in
+
+void SV_BroadphaseBench_f(void);
+// times SV_AreaEdicts queries on the current entity layout with
+// every broadphase
+
+void SV_RadiusBench_f(void);
+// times SV_SphereEdicts against a walk over every edict
+
 //===================================================================
 
 //
@@ -327,3 +394,7 @@ trace_t SV_Trace(int cmodel_index, vec3_t start, vec3_t mins, vec3_t maxs, vec3_
 // to an open area
 
 // passedict is explicitly excluded from clipping checks (normally NULL)
+
+void SV_TraceBatch(int cmodel_index, int n, vec3_t *starts, vec3_t *ends, vec3_t mins, vec3_t maxs,
+                   edict_t *passedict, int contentmask, trace_t *out);
+// same as n calls to SV_Trace with the same box, mask and passedict
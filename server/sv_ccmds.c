@@ -20,6 +20,8 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 #include "server.h"
 
+#include <uv.h>
+
 /*
 ===============================================================================
 
@@ -133,6 +135,103 @@ SAVEGAME FILES
 ===============================================================================
 */
 
+// game and level saves kept in sv_database, keyed by the file name they would have
+SQL_QUERY(SV_SelectSaveRow, sv_database, "SELECT data FROM savegame WHERE name = ?", bind_text(0, name),
+          column_blob(0, data))
+SQL_QUERY(SV_ReplaceSaveRow, sv_database, "INSERT OR REPLACE INTO savegame(name, data) VALUES(?, ?)",
+          bind_text(0, name), bind_blob(1, data))
+SQL_QUERY(SV_DeleteSaveRows, sv_database, "DELETE FROM savegame WHERE substr(name, 1, length(?1)) = ?1",
+          bind_text(0, prefix))
+SQL_QUERY(SV_CopySaveRows, sv_database,
+          "INSERT OR REPLACE INTO savegame(name, data) SELECT ?1 || substr(name, length(?2) + 1), data FROM savegame "
+          "WHERE substr(name, 1, length(?2)) = ?2",
+          bind_text(0, dst), bind_text(1, src))
+
+typedef struct {
+  void *data;
+  int length;
+} saverow_t;
+
+static void SV_SaveRow(void *ud, const void *data, int data_size) {
+  saverow_t *row = ud;
+
+  row->data = Z_Malloc(data_size);
+  memcpy(row->data, data, data_size);
+  row->length = data_size;
+}
+
+/*
+=====================
+SV_WriteSave
+
+Stores a save the game built in memory with a single write, as a row of
+sv_database when sv_savedatabase is set and the database is open.  The
+row is stepped here instead of through SV_ReplaceSaveRow, which makes any
+failure fatal, so a full disk or a locked database only fails the save
+=====================
+*/
+bool SV_WriteSave(const char *name, const void *data, int length) {
+  sqlite3_stmt *stmt;
+  FILE *f;
+  bool ok;
+  int code;
+
+  if(sv_savedatabase->value && sv_database) {
+    stmt = SV_ReplaceSaveRow_stmt();
+    sqlite3_reset(stmt);
+    sqlite3_clear_bindings(stmt);
+    sqlite3_bind_text(stmt, 1, name, -1, SQLITE_STATIC);
+    sqlite3_bind_blob(stmt, 2, data, length, SQLITE_STATIC);
+    code = sqlite3_step(stmt);
+    sqlite3_reset(stmt);
+    if(code != SQLITE_DONE) {
+      Com_Printf("Couldn't store %s: %s\n", name, sqlite3_errstr(code));
+      return false;
+    }
+    return true;
+  }
+
+  f = fopen(name, "wb");
+  if(!f)
+    return false;
+  ok = fwrite(data, 1, length, f) == length;
+  fclose(f);
+  return ok;
+}
+
+/*
+=====================
+SV_ReadSave
+
+Reads a whole save into one Z_Malloc block, from sv_database first when
+sv_savedatabase is set so saves made before it still load from files
+=====================
+*/
+int SV_ReadSave(const char *name, void **data) {
+  saverow_t row = {NULL, -1};
+  FILE *f;
+
+  if(sv_savedatabase->value && sv_database && SV_SelectSaveRow(name, SV_SaveRow, &row)) {
+    *data = row.data;
+    return row.length;
+  }
+
+  f = fopen(name, "rb");
+  if(!f) {
+    *data = NULL;
+    return -1;
+  }
+  fseek(f, 0, SEEK_END);
+  row.length = ftell(f);
+  fseek(f, 0, SEEK_SET);
+  row.data = Z_Malloc(row.length);
+  FS_Read(row.data, row.length, f);
+  fclose(f);
+
+  *data = row.data;
+  return row.length;
+}
+
 /*
 =====================
 SV_WipeSavegame
@@ -146,6 +245,11 @@ void SV_WipeSavegame(char *savename) {
 
   Com_DPrintf("SV_WipeSaveGame(%s)\n", savename);
 
+  if(sv_database) {
+    Com_sprintf(name, sizeof(name), "%s/save/%s/", FS_Gamedir(), savename);
+    SV_DeleteSaveRows(name, NULL, NULL);
+  }
+
   Com_sprintf(name, sizeof(name), "%s/save/%s/server.ssv", FS_Gamedir(), savename);
   remove(name);
   Com_sprintf(name, sizeof(name), "%s/save/%s/game.ssv", FS_Gamedir(), savename);
@@ -223,9 +327,16 @@ void SV_CopySaveGame(char *src, char *dst) {
   Com_sprintf(name2, sizeof(name2), "%s/save/%s/game.ssv", FS_Gamedir(), dst);
   SV_CopyFile(name, name2);
 
+  if(sv_database) {
+    Com_sprintf(name, sizeof(name), "%s/save/%s/", FS_Gamedir(), src);
+    Com_sprintf(name2, sizeof(name2), "%s/save/%s/", FS_Gamedir(), dst);
+    SV_CopySaveRows(name2, name, NULL, NULL);
+  }
+
+  // every level has a sv2 file, its sav may be a database row
   Com_sprintf(name, sizeof(name), "%s/save/%s/", FS_Gamedir(), src);
   len = strlen(name);
-  Com_sprintf(name, sizeof(name), "%s/save/%s/*.sav", FS_Gamedir(), src);
+  Com_sprintf(name, sizeof(name), "%s/save/%s/*.sv2", FS_Gamedir(), src);
   found = Sys_FindFirst(name, 0, 0);
   while(found) {
     strcpy(name + len, found + len);
@@ -233,11 +344,11 @@ void SV_CopySaveGame(char *src, char *dst) {
     Com_sprintf(name2, sizeof(name2), "%s/save/%s/%s", FS_Gamedir(), dst, found + len);
     SV_CopyFile(name, name2);
 
-    // change sav to sv2
+    // change sv2 to sav
     l = strlen(name);
-    strcpy(name + l - 3, "sv2");
+    strcpy(name + l - 3, "sav");
     l = strlen(name2);
-    strcpy(name2 + l - 3, "sv2");
+    strcpy(name2 + l - 3, "sav");
     SV_CopyFile(name, name2);
 
     found = Sys_FindNext(0, 0);
@@ -254,6 +365,7 @@ SV_WriteLevelFile
 void SV_WriteLevelFile(void) {
   char name[MAX_OSPATH];
   FILE *f;
+  uint64_t start;
 
   Com_DPrintf("SV_WriteLevelFile()\n");
 
@@ -268,7 +380,9 @@ void SV_WriteLevelFile(void) {
   fclose(f);
 
   Com_sprintf(name, sizeof(name), "%s/save/current/%s.sav", FS_Gamedir(), sv.name);
+  start = uv_hrtime();
   ge->WriteLevel(name);
+  Com_DPrintf("WriteLevel: %.2f ms\n", (uv_hrtime() - start) / 1e6);
 }
 
 /*
@@ -280,6 +394,7 @@ SV_ReadLevelFile
 void SV_ReadLevelFile(void) {
   char name[MAX_OSPATH];
   FILE *f;
+  uint64_t start;
 
   Com_DPrintf("SV_ReadLevelFile()\n");
 
@@ -294,7 +409,9 @@ void SV_ReadLevelFile(void) {
   fclose(f);
 
   Com_sprintf(name, sizeof(name), "%s/save/current/%s.sav", FS_Gamedir(), sv.name);
+  start = uv_hrtime();
   ge->ReadLevel(name);
+  Com_DPrintf("ReadLevel: %.2f ms\n", (uv_hrtime() - start) / 1e6);
 }
 
 /*
@@ -787,17 +904,13 @@ recorded, but no playerinfo will be stored.  Primarily for demo merging.
 */
 void SV_ServerRecord_f(void) {
   char name[MAX_OSPATH];
-  char buf_data[32768];
-  sizebuf_t buf;
-  int len;
-  int i;
 
   if(Cmd_Argc() != 2) {
     Com_Printf("serverrecord <demoname>\n");
     return;
   }
 
-  if(svs.demofile) {
+  if(svs.demowriter) {
     Com_Printf("Already recording.\n");
     return;
   }
@@ -810,53 +923,14 @@ void SV_ServerRecord_f(void) {
   //
   // open the demo file
   //
-  Com_sprintf(name, sizeof(name), "%s/demos/%s.dm2", FS_Gamedir(), Cmd_Argv(1));
+  Com_sprintf(name, sizeof(name), "%s/demos/%s.svd", FS_Gamedir(), Cmd_Argv(1));
 
   Com_Printf("recording to %s.\n", name);
   FS_CreatePath(name);
-  svs.demofile = fopen(name, "wb");
-  if(!svs.demofile) {
+  if(!SV_DemoStartRecord(name)) {
     Com_Printf("ERROR: couldn't open.\n");
     return;
   }
-
-  // setup a buffer to catch all multicasts
-  SZ_Init(&svs.demo_multicast, svs.demo_multicast_buf, sizeof(svs.demo_multicast_buf));
-
-  //
-  // write a single giant fake message with all the startup info
-  //
-  SZ_Init(&buf, buf_data, sizeof(buf_data));
-
-  //
-  // serverdata needs to go over for all types of servers
-  // to make sure the protocol is right, and to set the gamedir
-  //
-  // send the serverdata
-  MSG_WriteByte(&buf, svc_serverdata);
-  MSG_WriteLong(&buf, PROTOCOL_VERSION);
-  MSG_WriteLong(&buf, svs.spawncount);
-  // 2 means server demo
-  MSG_WriteByte(&buf, 2); // demos are always attract loops
-  MSG_WriteString(&buf, Cvar_VariableString("gamedir"));
-  MSG_WriteShort(&buf, -1);
-  // send full levelname
-  MSG_WriteString(&buf, sv.configstrings[CS_NAME]);
-
-  for(i = 0; i < MAX_CONFIGSTRINGS; i++)
-    if(sv.configstrings[i][0]) {
-      MSG_WriteByte(&buf, svc_configstring);
-      MSG_WriteShort(&buf, i);
-      MSG_WriteString(&buf, sv.configstrings[i]);
-    }
-
-  // write it to the demo file
-  Com_DPrintf("signon message length: %i\n", buf.cursize);
-  len = LittleLong(buf.cursize);
-  fwrite(&len, 4, 1, svs.demofile);
-  fwrite(buf.data, buf.cursize, 1, svs.demofile);
-
-  // the rest of the demo file will be individual frames
 }
 
 /*
@@ -867,13 +941,11 @@ Ends server demo recording
 ==============
 */
 void SV_ServerStop_f(void) {
-  if(!svs.demofile) {
+  if(!svs.demowriter) {
     Com_Printf("Not doing a serverrecord.\n");
     return;
   }
-  fclose(svs.demofile);
-  svs.demofile = NULL;
-  Com_Printf("Recording completed.\n");
+  SV_DemoStopRecord();
 }
 
 /*
@@ -910,14 +982,18 @@ void SV_ServerCommand_f(void) {
 static int get_user_version(void *ud_, int ncols, char **column_names, char **data) {
   int *ud = (int *)ud_;
   *ud = atoi(data[0]);
+  return 0;
 }
 
 #define SQL(...) #__VA_ARGS__
 
 static const char *database_setup_scripts[] = {
-    SQL(                                                                         //
-        CREATE TABLE character(name TEXT, account_uuid TEXT, configstring TEXT); //
-    )                                                                            //
+    SQL(                                                                                       //
+        CREATE TABLE IF NOT EXISTS character(name TEXT, account_uuid TEXT, configstring TEXT); //
+    ),                                                                                         //
+    SQL(                                                                                       //
+        CREATE TABLE savegame(name TEXT PRIMARY KEY, data BLOB);                               //
+    )                                                                                          //
 };
 
 void SV_ReloadDatabase_f(void) {
@@ -952,7 +1028,9 @@ void SV_ReloadDatabase_f(void) {
     }
   }
 
-  sprintf(temp, "PRAGMA user_version = %i;", user_version);
+  // remember how far the setup got so the scripts only run once
+  sprintf(temp, "PRAGMA user_version = %i;",
+          (int)(sizeof(database_setup_scripts) / sizeof(database_setup_scripts[0])));
   if(!SQLite_exec(sv_database, temp, NULL, NULL)) {
     sqlite3_close(sv_database);
     sv_database = NULL;
@@ -986,6 +1064,7 @@ void SV_InitOperatorCommands(void) {
 
   Cmd_AddCommand("serverrecord", SV_ServerRecord_f);
   Cmd_AddCommand("serverstop", SV_ServerStop_f);
+  Cmd_AddCommand("serverdemo_info", SV_ServerDemoInfo_f);
 
   Cmd_AddCommand("save", SV_Savegame_f);
   Cmd_AddCommand("load", SV_Loadgame_f);
@@ -995,4 +1074,9 @@ void SV_InitOperatorCommands(void) {
   Cmd_AddCommand("sv", SV_ServerCommand_f);
 
   Cmd_AddCommand("sv_reload_database", SV_ReloadDatabase_f);
+  Cmd_AddCommand("sv_broadphase_bench", SV_BroadphaseBench_f);
+  Cmd_AddCommand("sv_radius_bench", SV_RadiusBench_f);
+  Cmd_AddCommand("sv_multicast_bench", SV_MulticastBench_f);
+  Cmd_AddCommand("sv_tickstats", SV_TickStats_f);
+  Cmd_AddCommand("sv_deltastats", SV_DeltaStats_f);
 }
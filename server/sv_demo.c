@@ -0,0 +1,1015 @@
+/*
+Copyright (C) 1997-2001 Id Software, Inc.
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+// sv_demo.c -- serverrecord demos, compressed and written off the game thread
+
+#include "server.h"
+
+#include <uv.h>
+
+/*
+=============================================================================
+
+SERVER DEMO FILES
+
+  demoheader_t
+  demoblock_t, compressed messages
+  ...
+  demoblock_t with a framenum of -1, demoindex_t for every block
+  offset of that last demoblock_t, DEMO_INDEX_IDENT
+
+Every block decompresses to length prefixed messages, laid out like
+the old .dm2 files.  No message is larger than a netchan can carry, so
+demomap plays them back the same way.  A block starts with the signon
+and a keyframe, and every later frame in it is delta compressed from the
+one before, so playback can start at the beginning of any block.  The
+index is written when the recording stops, a demo without one is read by
+walking the block headers.
+
+The signon and the frames are what a protocol 34 client expects from a
+server.  The viewer is given DEMO_PLAYERNUM, which no recorded entity
+uses, and watches from the eyes of the first client in the game, with
+every area open.
+=============================================================================
+*/
+
+#define DEMO_IDENT (('M' << 24) + ('D' << 16) + ('V' << 8) + 'S') // little-endian "SVDM"
+#define DEMO_INDEX_IDENT (('X' << 24) + ('D' << 16) + ('V' << 8) + 'S')
+#define DEMO_VERSION 3
+
+#define DEMO_BLOCK_SIZE 0x40000 // uncompressed bytes in a block
+#define DEMO_MSGLEN (MAX_MSGLEN - 16) // the most a message may take, room for the netchan header
+#define DEMO_ENTITY_SIZE 64           // more than any one entity delta takes
+#define DEMO_WRITES 4           // blocks that may wait on the disk before frames are dropped
+#define DEMO_PLAYERNUM (MAX_EDICTS - 2) // the client playing a demo back, its entity is never recorded
+
+typedef struct {
+  int ident;
+  int version;
+  int frametime; // msec per frame, sv_fps doesn't change while recording
+} demoheader_t;
+
+typedef struct {
+  int framenum; // of the keyframe the block starts with, -1 for the index
+  int rawlen;
+  int complen; // bytes following the header
+} demoblock_t;
+
+typedef struct {
+  int framenum;
+  int offset; // of the demoblock_t
+} demoindex_t;
+
+typedef struct {
+  uv_work_t req;
+  struct demowriter_s *writer;
+  bool busy;
+  byte *data;
+  int size;
+  int offset;
+  ssize_t result; // set on the worker
+} demowrite_t;
+
+struct demowriter_s {
+  uv_file file;
+  int offset;  // where the next block goes
+  int pending; // writes whose completion hasn't run on the loop
+  bool closing;
+  bool failed;
+
+  // writes still on a worker, SV_DemoStopRecord waits for these without
+  // running the loop, which it may have been called from
+  uv_mutex_t lock;
+  uv_cond_t done;
+  int working;
+
+  byte *raw; // the block being built
+  int rawlen;
+  int blockframe;
+  int blockframes;
+
+  demowrite_t writes[DEMO_WRITES];
+  demowrite_t tail; // the index, written when recording stops
+
+  demoindex_t *index;
+  int numindex, maxindex;
+
+  int lastframe; // -1 sends the next frame as a keyframe
+  int framenum;  // of the last frame recorded
+  player_state_t ps; // the view of the last frame recorded
+
+  // sv.framenum starts over with every map, frames are numbered from
+  // framebase on so they keep rising through the whole demo
+  int spawncount;
+  int framebase;
+
+  int frames;
+  int dropped;
+  int rawbytes;
+  int filebytes;
+
+  unsigned present[MAX_EDICTS / 32];
+  entity_state_t states[MAX_EDICTS];
+};
+
+struct demoreader_s {
+  FILE *file;
+  int frametime;
+  demoindex_t *index;
+  int numindex;
+
+  // playback sends the signon of a block only for a new map
+  int spawncount; // of the last signon sent, -1 before the first
+  bool skipping;
+
+  int block; // index of the block in raw, -1 before the first
+  byte *raw;
+  int rawlen;
+  int readcount;
+  byte *comp;
+  int compsize;
+};
+
+static void SV_DemoFree(demowriter_t *w);
+
+/*
+==================
+SV_DemoBeginMessage
+
+Messages are built straight into the block, the length goes in front of
+them when they are done
+==================
+*/
+static void SV_DemoBeginMessage(demowriter_t *w, sizebuf_t *buf, int maxsize) {
+  SZ_Init(buf, w->raw + w->rawlen + 4, maxsize);
+}
+
+static void SV_DemoEndMessage(demowriter_t *w, sizebuf_t *buf) {
+  int len;
+
+  len = LittleLong(buf->cursize);
+  memcpy(w->raw + w->rawlen, &len, 4);
+  w->rawlen += 4 + buf->cursize;
+}
+
+/*
+==================
+SV_DemoWriteWork
+
+On a worker, a synchronous write of the whole request
+==================
+*/
+static void SV_DemoWriteWork(uv_work_t *req) {
+  demowrite_t *write = uv_req_get_data((uv_req_t *)req);
+  demowriter_t *w = write->writer;
+  uv_fs_t fs;
+  uv_buf_t buf;
+
+  buf = uv_buf_init((char *)write->data, write->size);
+  write->result = uv_fs_write(global_uv_loop(), &fs, w->file, &buf, 1, write->offset, NULL);
+  uv_fs_req_cleanup(&fs);
+
+  uv_mutex_lock(&w->lock);
+  w->working--;
+  uv_cond_signal(&w->done);
+  uv_mutex_unlock(&w->lock);
+}
+
+/*
+==================
+SV_DemoWriteDone
+==================
+*/
+static void SV_DemoWriteDone(uv_work_t *req, int status) {
+  demowrite_t *write = uv_req_get_data((uv_req_t *)req);
+  demowriter_t *w = write->writer;
+
+  if(status < 0)
+    write->result = status;
+  if(write->result < 0 && !w->failed) {
+    Com_Printf("serverrecord: write failed, %s\n", uv_strerror(write->result));
+    w->failed = true;
+  }
+
+  write->busy = false;
+  w->pending--;
+  if(w->closing && !w->pending)
+    SV_DemoFree(w);
+}
+
+/*
+==================
+SV_DemoWrite
+
+Queues size bytes of write->data at the end of the file
+==================
+*/
+static void SV_DemoWrite(demowriter_t *w, demowrite_t *write, int size) {
+  write->writer = w;
+  write->size = size;
+  write->offset = w->offset;
+  write->result = 0;
+  uv_req_set_data((uv_req_t *)&write->req, write);
+
+  uv_mutex_lock(&w->lock);
+  w->working++;
+  uv_mutex_unlock(&w->lock);
+
+  if(uv_queue_work(global_uv_loop(), &write->req, SV_DemoWriteWork, SV_DemoWriteDone) < 0) {
+    uv_mutex_lock(&w->lock);
+    w->working--;
+    uv_mutex_unlock(&w->lock);
+    if(!w->failed)
+      Com_Printf("serverrecord: couldn't queue a write\n");
+    w->failed = true;
+    return;
+  }
+
+  write->busy = true;
+  w->pending++;
+  w->offset += size;
+  w->filebytes += size;
+}
+
+/*
+==================
+SV_DemoFlush
+
+Compresses the block and hands it to the disk.  When every write slot is
+still busy the block is dropped instead, recording never waits on the
+disk.
+==================
+*/
+static void SV_DemoFlush(demowriter_t *w) {
+  demowrite_t *write;
+  demoblock_t block;
+  int i, complen;
+
+  if(!w->rawlen)
+    return;
+
+  write = NULL;
+  for(i = 0; i < DEMO_WRITES; i++) {
+    if(!w->writes[i].busy) {
+      write = &w->writes[i];
+      break;
+    }
+  }
+
+  if(!write || w->failed) {
+    w->dropped += w->blockframes;
+  } else {
+    complen = LZ_Compress(w->raw, w->rawlen, write->data + sizeof(block), LZ_CompressBound(DEMO_BLOCK_SIZE));
+
+    if(w->numindex == w->maxindex) {
+      demoindex_t *index;
+
+      w->maxindex = w->maxindex ? w->maxindex * 2 : 64;
+      index = Z_Malloc(w->maxindex * sizeof(*index));
+      if(w->index) {
+        memcpy(index, w->index, w->numindex * sizeof(*index));
+        Z_Free(w->index);
+      }
+      w->index = index;
+    }
+    w->index[w->numindex].framenum = w->blockframe;
+    w->index[w->numindex].offset = w->offset;
+    w->numindex++;
+
+    block.framenum = LittleLong(w->blockframe);
+    block.rawlen = LittleLong(w->rawlen);
+    block.complen = LittleLong(complen);
+    memcpy(write->data, &block, sizeof(block));
+
+    w->rawbytes += w->rawlen;
+    SV_DemoWrite(w, write, sizeof(block) + complen);
+  }
+
+  w->rawlen = 0;
+  w->blockframes = 0;
+  w->lastframe = -1;
+}
+
+/*
+==================
+SV_DemoWriteSignon
+
+The serverdata and every configstring, at the start of every block, and
+the precache the client loads the map on.  The configstrings go in as
+many messages as they need.
+==================
+*/
+static void SV_DemoWriteSignon(demowriter_t *w) {
+  sizebuf_t buf;
+  int i;
+
+  SV_DemoBeginMessage(w, &buf, DEMO_MSGLEN);
+
+  //
+  // serverdata needs to go over for all types of servers
+  // to make sure the protocol is right, and to set the gamedir
+  //
+  // send the serverdata
+  MSG_WriteByte(&buf, svc_serverdata);
+  MSG_WriteLong(&buf, PROTOCOL_VERSION_OLD); // any client can play it back
+  MSG_WriteLong(&buf, svs.spawncount);
+  // 2 means server demo
+  MSG_WriteByte(&buf, 2); // demos are always attract loops
+  MSG_WriteString(&buf, Cvar_VariableString("gamedir"));
+  MSG_WriteShort(&buf, DEMO_PLAYERNUM);
+  // send full levelname
+  MSG_WriteString(&buf, sv.configstrings[CS_NAME]);
+
+  for(i = 0; i < MAX_CONFIGSTRINGS; i++)
+    if(sv.configstrings[i][0]) {
+      if(buf.cursize + 4 + strlen(sv.configstrings[i]) > buf.maxsize) {
+        SV_DemoEndMessage(w, &buf);
+        SV_DemoBeginMessage(w, &buf, DEMO_MSGLEN);
+      }
+      MSG_WriteByte(&buf, svc_configstring);
+      MSG_WriteShort(&buf, i);
+      MSG_WriteString(&buf, sv.configstrings[i]);
+    }
+
+  if(buf.cursize + 16 > buf.maxsize) {
+    SV_DemoEndMessage(w, &buf);
+    SV_DemoBeginMessage(w, &buf, DEMO_MSGLEN);
+  }
+  MSG_WriteByte(&buf, svc_stufftext);
+  MSG_WriteString(&buf, "precache\n");
+
+  SV_DemoEndMessage(w, &buf);
+}
+
+/*
+==================
+SV_DemoViewState
+
+Looks from where the first client in the game looks, or from the last
+view when there is none, with no gun or status bar and no prediction
+==================
+*/
+static void SV_DemoViewState(player_state_t *ps) {
+  player_state_t *view;
+  client_t *cl;
+  int i;
+
+  for(i = 0, cl = svs.clients; i < maxclients->value; i++, cl++) {
+    if(cl->state != cs_spawned || !cl->edict || !cl->edict->client)
+      continue;
+
+    view = &cl->edict->client->ps;
+    memset(ps, 0, sizeof(*ps));
+    VectorCopy(view->pmove.origin, ps->pmove.origin);
+    VectorCopy(view->viewoffset, ps->viewoffset);
+    VectorCopy(view->viewangles, ps->viewangles);
+    ps->fov = view->fov;
+    ps->rdflags = view->rdflags;
+    ps->cmodel_index = view->cmodel_index;
+    break;
+  }
+
+  ps->pmove.pm_type = PM_FREEZE;
+  ps->pmove.pm_flags = PMF_NO_PREDICTION;
+  if(!ps->fov)
+    ps->fov = 90;
+}
+
+static void SV_DemoWriteRemove(sizebuf_t *msg, int number) {
+  int bits;
+
+  bits = U_REMOVE;
+  if(number >= 256)
+    bits |= U_NUMBER16 | U_MOREBITS1;
+
+  MSG_WriteByte(msg, bits & 255);
+  if(bits & 0x0000ff00)
+    MSG_WriteByte(msg, (bits >> 8) & 255);
+
+  if(bits & U_NUMBER16)
+    MSG_WriteShort(msg, number);
+  else
+    MSG_WriteByte(msg, number);
+}
+
+/*
+==================
+SV_RecordDemoMessage
+
+Save everything in the world out, delta compressed from the last frame
+recorded.  Used for recording footage for merged or assembled demos
+==================
+*/
+void SV_RecordDemoMessage(void) {
+  demowriter_t *w = svs.demowriter;
+  entity_state_t nostate;
+  player_state_t ps;
+  byte areabits[MAX_MAP_AREAS / 8];
+  sizebuf_t buf;
+  edict_t *ent = NULL;
+  int keyframe, framenum, room;
+  bool visible, present;
+  int e;
+
+  // cinematics and pics between maps have no world to record
+  if(!w || sv.state != ss_game)
+    return;
+
+  keyframe = sv_demokeyframe->value * 1000 / sv.frametime;
+  if(keyframe < 1)
+    keyframe = 1;
+
+  // a new map needs its own signon and a keyframe against its own entities
+  if(w->spawncount != svs.spawncount) {
+    SV_DemoFlush(w);
+    w->spawncount = svs.spawncount;
+    w->framebase = w->framenum + 1 - sv.framenum;
+  }
+  framenum = w->framebase + sv.framenum;
+
+  // start a new block when this one is due a keyframe or might not fit
+  // the next frame
+  if(w->rawlen && (framenum - w->blockframe >= keyframe || w->rawlen + 4 + DEMO_MSGLEN > DEMO_BLOCK_SIZE))
+    SV_DemoFlush(w);
+
+  if(!w->rawlen) {
+    SV_DemoWriteSignon(w);
+    w->blockframe = framenum;
+    w->lastframe = -1;
+  }
+
+  if(w->lastframe == -1)
+    memset(w->present, 0, sizeof(w->present));
+
+  // multicasts that would crowd out the entities are dropped, as they are
+  // for clients
+  if(svs.demo_multicast.cursize > DEMO_MSGLEN / 2)
+    SZ_Clear(&svs.demo_multicast);
+  room = DEMO_MSGLEN - svs.demo_multicast.cursize - 2;
+
+  memset(&nostate, 0, sizeof(nostate));
+  SV_DemoBeginMessage(w, &buf, DEMO_MSGLEN);
+
+  MSG_WriteByte(&buf, svc_frame);
+  MSG_WriteLong(&buf, framenum);
+  MSG_WriteLong(&buf, w->lastframe);
+  MSG_WriteByte(&buf, 0); // surpressCount
+
+  // the demo holds the whole world, every area is open
+  memset(areabits, 255, sizeof(areabits));
+  MSG_WriteByte(&buf, sizeof(areabits));
+  SZ_Write(&buf, areabits, sizeof(areabits));
+
+  ps = w->ps;
+  SV_DemoViewState(&ps);
+  MSG_WriteByte(&buf, svc_playerinfo);
+  MSG_WriteDeltaPlayerstate(w->lastframe == -1 ? NULL : &w->ps, &ps, &buf);
+  w->ps = ps;
+
+  MSG_WriteByte(&buf, svc_packetentities);
+
+  for(e = 1; e < MAX_EDICTS; e++) {
+    present = (w->present[e >> 5] & (1u << (e & 31))) != 0;
+    if(e >= ge->num_edicts && !present) {
+      if(!w->present[e >> 5])
+        e |= 31; // skip the whole word
+      continue;
+    }
+
+    // ignore ents without visible models unless they have an effect
+    visible = false;
+    if(e < ge->num_edicts && e != DEMO_PLAYERNUM + 1) {
+      ent = EDICT_NUM(e);
+      visible = ent->inuse && ent->s.number && (ent->s.modelindex || ent->s.effects || ent->s.sound || ent->s.event) &&
+                !(ent->svflags & SVF_NOCLIENT);
+    }
+
+    // out of room, the entity keeps the state the demo last gave it and
+    // is caught up in a later frame
+    if(buf.cursize + DEMO_ENTITY_SIZE > room)
+      continue;
+
+    if(visible) {
+      MSG_WriteDeltaEntity(present ? &w->states[e] : &nostate, &ent->s, &buf, false, !present);
+      w->states[e] = ent->s;
+      w->present[e >> 5] |= 1u << (e & 31);
+    } else if(present) {
+      SV_DemoWriteRemove(&buf, e);
+      w->present[e >> 5] &= ~(1u << (e & 31));
+    }
+  }
+
+  MSG_WriteShort(&buf, 0); // end of packetentities
+
+  // now add the accumulated multicast information
+  SZ_Write(&buf, svs.demo_multicast.data, svs.demo_multicast.cursize);
+  SZ_Clear(&svs.demo_multicast);
+
+  SV_DemoEndMessage(w, &buf);
+  w->lastframe = w->framenum = framenum;
+  w->blockframes++;
+  w->frames++;
+}
+
+/*
+==================
+SV_DemoStartRecord
+
+name is the full path of the file
+==================
+*/
+bool SV_DemoStartRecord(const char *name) {
+  demowriter_t *w;
+  demoheader_t header;
+  uv_fs_t req;
+  uv_buf_t buf;
+  int file, i;
+
+  file = uv_fs_open(global_uv_loop(), &req, name, O_WRONLY | O_CREAT | O_TRUNC, 0666, NULL);
+  uv_fs_req_cleanup(&req);
+  if(file < 0)
+    return false;
+
+  header.ident = LittleLong(DEMO_IDENT);
+  header.version = LittleLong(DEMO_VERSION);
+  header.frametime = LittleLong(sv.frametime);
+  buf = uv_buf_init((char *)&header, sizeof(header));
+  if(uv_fs_write(global_uv_loop(), &req, file, &buf, 1, 0, NULL) != sizeof(header)) {
+    uv_fs_req_cleanup(&req);
+    uv_fs_close(global_uv_loop(), &req, file, NULL);
+    uv_fs_req_cleanup(&req);
+    return false;
+  }
+  uv_fs_req_cleanup(&req);
+
+  w = Z_Malloc(sizeof(*w));
+  uv_mutex_init(&w->lock);
+  uv_cond_init(&w->done);
+  w->file = file;
+  w->offset = sizeof(header);
+  w->lastframe = -1;
+  w->spawncount = svs.spawncount;
+  w->framebase = 1 - sv.framenum; // a delta from frame 0 reads as no delta
+  w->raw = Z_Malloc(DEMO_BLOCK_SIZE);
+  for(i = 0; i < DEMO_WRITES; i++)
+    w->writes[i].data = Z_Malloc(sizeof(demoblock_t) + LZ_CompressBound(DEMO_BLOCK_SIZE));
+
+  // setup a buffer to catch all multicasts
+  SZ_Init(&svs.demo_multicast, svs.demo_multicast_buf, sizeof(svs.demo_multicast_buf));
+
+  svs.demowriter = w;
+  return true;
+}
+
+/*
+==================
+SV_DemoFree
+
+Once the loop has run the completion of every write
+==================
+*/
+static void SV_DemoFree(demowriter_t *w) {
+  int i;
+
+  for(i = 0; i < DEMO_WRITES; i++)
+    Z_Free(w->writes[i].data);
+  if(w->tail.data)
+    Z_Free(w->tail.data);
+  if(w->index)
+    Z_Free(w->index);
+  uv_cond_destroy(&w->done);
+  uv_mutex_destroy(&w->lock);
+  Z_Free(w->raw);
+  Z_Free(w);
+}
+
+/*
+==================
+SV_DemoStopRecord
+
+Writes out the last block and the index and closes the file.  This waits
+for the disk, so a quit straight after it loses nothing.  The writer
+itself is freed once the loop catches up with the completions.
+==================
+*/
+void SV_DemoStopRecord(void) {
+  demowriter_t *w = svs.demowriter;
+  demoblock_t block;
+  demoindex_t *index;
+  uv_fs_t req;
+  uv_buf_t buf;
+  int i, size, trailer[2];
+
+  if(!w)
+    return;
+  svs.demowriter = NULL;
+
+  SV_DemoFlush(w);
+
+  uv_mutex_lock(&w->lock);
+  while(w->working)
+    uv_cond_wait(&w->done, &w->lock);
+  uv_mutex_unlock(&w->lock);
+
+  // the completions may not have run yet
+  for(i = 0; i < DEMO_WRITES; i++)
+    if(w->writes[i].busy && w->writes[i].result < 0)
+      w->failed = true;
+
+  size = sizeof(block) + w->numindex * sizeof(demoindex_t) + sizeof(trailer);
+  w->tail.data = Z_Malloc(size);
+
+  block.framenum = LittleLong(-1);
+  block.rawlen = block.complen = LittleLong(w->numindex * sizeof(demoindex_t));
+  memcpy(w->tail.data, &block, sizeof(block));
+
+  index = (demoindex_t *)(w->tail.data + sizeof(block));
+  for(i = 0; i < w->numindex; i++) {
+    index[i].framenum = LittleLong(w->index[i].framenum);
+    index[i].offset = LittleLong(w->index[i].offset);
+  }
+
+  trailer[0] = LittleLong(w->offset);
+  trailer[1] = LittleLong(DEMO_INDEX_IDENT);
+  memcpy(w->tail.data + size - sizeof(trailer), trailer, sizeof(trailer));
+
+  if(!w->failed) {
+    buf = uv_buf_init((char *)w->tail.data, size);
+    if(uv_fs_write(global_uv_loop(), &req, w->file, &buf, 1, w->offset, NULL) == size)
+      w->filebytes += size;
+    else
+      w->failed = true;
+    uv_fs_req_cleanup(&req);
+  }
+
+  uv_fs_close(global_uv_loop(), &req, w->file, NULL);
+  uv_fs_req_cleanup(&req);
+
+  Com_Printf("Recording completed, %i frames in %i KB (%i KB uncompressed)", w->frames, w->filebytes / 1024,
+             w->rawbytes / 1024);
+  if(w->dropped)
+    Com_Printf(", %i frames lost to a slow disk", w->dropped);
+  if(w->failed)
+    Com_Printf(", the file is incomplete");
+  Com_Printf(".\n");
+
+  w->closing = true;
+  if(!w->pending)
+    SV_DemoFree(w);
+}
+
+/*
+=============================================================================
+
+SERVER DEMO READER
+
+=============================================================================
+*/
+
+static bool SV_DemoReadIndex(demoreader_t *r) {
+  demoblock_t block;
+  int trailer[2];
+  long end;
+
+  if(fseek(r->file, -(long)sizeof(trailer), SEEK_END) || fread(trailer, sizeof(trailer), 1, r->file) != 1)
+    return false;
+  if(LittleLong(trailer[1]) != DEMO_INDEX_IDENT)
+    return false;
+  end = ftell(r->file) - sizeof(trailer);
+
+  if(fseek(r->file, LittleLong(trailer[0]), SEEK_SET) || fread(&block, sizeof(block), 1, r->file) != 1)
+    return false;
+  block.framenum = LittleLong(block.framenum);
+  block.rawlen = LittleLong(block.rawlen);
+  if(block.framenum != -1 || block.rawlen < 0 || block.rawlen % sizeof(demoindex_t) ||
+     LittleLong(trailer[0]) + sizeof(block) + block.rawlen != end)
+    return false;
+
+  r->numindex = block.rawlen / sizeof(demoindex_t);
+  r->index = Z_Malloc(block.rawlen + sizeof(demoindex_t));
+  if(r->numindex && fread(r->index, block.rawlen, 1, r->file) != 1) {
+    Z_Free(r->index);
+    r->index = NULL;
+    r->numindex = 0;
+    return false;
+  }
+  return true;
+}
+
+/*
+==================
+SV_DemoScanBlocks
+
+For a recording that never got its index
+==================
+*/
+static void SV_DemoScanBlocks(demoreader_t *r) {
+  demoblock_t block;
+  int offset, maxindex;
+  demoindex_t *index;
+  long end;
+
+  fseek(r->file, 0, SEEK_END);
+  end = ftell(r->file);
+
+  maxindex = 0;
+  offset = sizeof(demoheader_t);
+  while(!fseek(r->file, offset, SEEK_SET) && fread(&block, sizeof(block), 1, r->file) == 1) {
+    block.framenum = LittleLong(block.framenum);
+    block.complen = LittleLong(block.complen);
+    if(block.framenum < 0 || block.complen < 0 || offset + sizeof(block) + block.complen > end)
+      break;
+
+    if(r->numindex == maxindex) {
+      maxindex = maxindex ? maxindex * 2 : 64;
+      index = Z_Malloc(maxindex * sizeof(*index));
+      if(r->index) {
+        memcpy(index, r->index, r->numindex * sizeof(*index));
+        Z_Free(r->index);
+      }
+      r->index = index;
+    }
+    r->index[r->numindex].framenum = block.framenum;
+    r->index[r->numindex].offset = offset;
+    r->numindex++;
+
+    offset += sizeof(block) + block.complen;
+  }
+}
+
+/*
+==================
+SV_DemoOpen
+
+name is the full path of the file, returns NULL if it can't be read
+==================
+*/
+demoreader_t *SV_DemoOpen(const char *name) {
+  demoreader_t *r;
+  demoheader_t header;
+  FILE *file;
+  int i;
+
+  file = fopen(name, "rb");
+  if(!file)
+    return NULL;
+  if(fread(&header, sizeof(header), 1, file) != 1 || LittleLong(header.ident) != DEMO_IDENT ||
+     LittleLong(header.version) != DEMO_VERSION) {
+    fclose(file);
+    return NULL;
+  }
+
+  r = Z_Malloc(sizeof(*r));
+  r->file = file;
+  r->frametime = LittleLong(header.frametime);
+  if(r->frametime < 1)
+    r->frametime = 100;
+  r->block = -1;
+  r->spawncount = -1;
+  r->raw = Z_Malloc(DEMO_BLOCK_SIZE);
+
+  if(SV_DemoReadIndex(r)) {
+    for(i = 0; i < r->numindex; i++) {
+      r->index[i].framenum = LittleLong(r->index[i].framenum);
+      r->index[i].offset = LittleLong(r->index[i].offset);
+    }
+  } else
+    SV_DemoScanBlocks(r);
+
+  return r;
+}
+
+void SV_DemoCloseReader(demoreader_t *r) {
+  fclose(r->file);
+  if(r->index)
+    Z_Free(r->index);
+  if(r->comp)
+    Z_Free(r->comp);
+  Z_Free(r->raw);
+  Z_Free(r);
+}
+
+/*
+==================
+SV_DemoLoadBlock
+==================
+*/
+static bool SV_DemoLoadBlock(demoreader_t *r, int b) {
+  demoblock_t block;
+
+  // a failed load still counts as being at b, reading goes on from b + 1
+  r->block = b;
+  r->rawlen = r->readcount = 0;
+  if(b < 0 || b >= r->numindex)
+    return false;
+
+  if(fseek(r->file, r->index[b].offset, SEEK_SET) || fread(&block, sizeof(block), 1, r->file) != 1)
+    return false;
+  block.rawlen = LittleLong(block.rawlen);
+  block.complen = LittleLong(block.complen);
+  if(block.rawlen < 0 || block.rawlen > DEMO_BLOCK_SIZE || block.complen < 0 ||
+     block.complen > LZ_CompressBound(DEMO_BLOCK_SIZE))
+    return false;
+
+  if(block.complen > r->compsize) {
+    if(r->comp)
+      Z_Free(r->comp);
+    r->compsize = block.complen;
+    r->comp = Z_Malloc(r->compsize);
+  }
+  if(block.complen && fread(r->comp, block.complen, 1, r->file) != 1)
+    return false;
+  if(LZ_Decompress(r->comp, block.complen, r->raw, DEMO_BLOCK_SIZE) != block.rawlen)
+    return false;
+
+  r->rawlen = block.rawlen;
+  return true;
+}
+
+/*
+==================
+SV_DemoNumKeyframes / SV_DemoKeyframe
+
+Every block starts with one
+==================
+*/
+int SV_DemoNumKeyframes(demoreader_t *r) { return r->numindex; }
+
+int SV_DemoFrameTime(demoreader_t *r) { return r->frametime; }
+
+int SV_DemoKeyframe(demoreader_t *r, int i) { return r->index[i].framenum; }
+
+/*
+==================
+SV_DemoSeek
+
+Moves to the last keyframe at or before framenum, or the first one, and
+returns its frame number.  The next message read is the signon of that
+block.  Returns -1 if the demo has no frames or the block is damaged.
+==================
+*/
+int SV_DemoSeek(demoreader_t *r, int framenum) {
+  int lo, hi, mid;
+
+  if(!r->numindex)
+    return -1;
+
+  // the last block starting at or before framenum
+  lo = 0;
+  hi = r->numindex - 1;
+  while(lo < hi) {
+    mid = (lo + hi + 1) / 2;
+    if(r->index[mid].framenum <= framenum)
+      lo = mid;
+    else
+      hi = mid - 1;
+  }
+
+  if(!SV_DemoLoadBlock(r, lo))
+    return -1;
+  return r->index[lo].framenum;
+}
+
+/*
+==================
+SV_DemoReadMessage
+
+Points msg at the next message, moving on to the next block at the end
+of one.  Returns false at the end of the demo.
+==================
+*/
+bool SV_DemoReadMessage(demoreader_t *r, sizebuf_t *msg) {
+  int len;
+
+  if(r->readcount >= r->rawlen && !SV_DemoLoadBlock(r, r->block + 1))
+    return false;
+
+  if(r->rawlen - r->readcount < 4)
+    return false;
+  memcpy(&len, r->raw + r->readcount, 4);
+  len = LittleLong(len);
+  if(len < 0 || len > r->rawlen - r->readcount - 4)
+    return false;
+
+  SZ_Init(msg, r->raw + r->readcount + 4, len);
+  msg->cursize = len;
+  r->readcount += 4 + len;
+  return true;
+}
+
+/*
+==================
+SV_DemoReadPlayback
+
+SV_DemoReadMessage for demomap.  Every block repeats the signon, but a
+client only wants it again when the map changed, which gives the
+serverdata a new spawncount.
+==================
+*/
+bool SV_DemoReadPlayback(demoreader_t *r, sizebuf_t *msg) {
+  int spawncount;
+
+  while(SV_DemoReadMessage(r, msg)) {
+    if(msg->cursize >= 9 && msg->data[0] == svc_serverdata) {
+      memcpy(&spawncount, msg->data + 5, 4);
+      spawncount = LittleLong(spawncount);
+      r->skipping = spawncount == r->spawncount;
+      r->spawncount = spawncount;
+    } else if(msg->cursize && msg->data[0] == svc_frame)
+      r->skipping = false;
+
+    if(!r->skipping)
+      return true;
+  }
+  return false;
+}
+
+/*
+==================
+SV_DemoMessageFrame
+
+The frame number of a frame message, -1 for anything else
+==================
+*/
+static int SV_DemoMessageFrame(sizebuf_t *msg) {
+  int framenum;
+
+  if(msg->cursize < 5 || msg->data[0] != svc_frame)
+    return -1;
+  memcpy(&framenum, msg->data + 1, 4);
+  return LittleLong(framenum);
+}
+
+/*
+==================
+SV_ServerDemoInfo_f
+
+serverdemo_info <demoname> [frame]
+
+Lists the keyframes of a serverrecord demo, and with a frame, times
+seeking to it and reading up to it
+==================
+*/
+void SV_ServerDemoInfo_f(void) {
+  char name[MAX_OSPATH];
+  demoreader_t *r;
+  sizebuf_t msg;
+  int i, target, keyframe, framenum, messages;
+  uint64_t start;
+
+  if(Cmd_Argc() < 2) {
+    Com_Printf("serverdemo_info <demoname> [frame]\n");
+    return;
+  }
+
+  Com_sprintf(name, sizeof(name), "%s/demos/%s.svd", FS_Gamedir(), Cmd_Argv(1));
+  r = SV_DemoOpen(name);
+  if(!r) {
+    Com_Printf("couldn't read %s.\n", name);
+    return;
+  }
+
+  Com_Printf("%s: %i keyframes\n", name, SV_DemoNumKeyframes(r));
+  if(Cmd_Argc() < 3) {
+    for(i = 0; i < SV_DemoNumKeyframes(r); i++)
+      Com_Printf("%6i\n", SV_DemoKeyframe(r, i));
+    SV_DemoCloseReader(r);
+    return;
+  }
+
+  target = atoi(Cmd_Argv(2));
+  start = uv_hrtime();
+  keyframe = SV_DemoSeek(r, target);
+  framenum = -1;
+  messages = 0;
+  if(keyframe != -1) {
+    while(framenum < target && SV_DemoReadMessage(r, &msg)) {
+      messages++;
+      if(SV_DemoMessageFrame(&msg) != -1)
+        framenum = SV_DemoMessageFrame(&msg);
+    }
+  }
+
+  if(framenum == -1)
+    Com_Printf("no frames to seek to.\n");
+  else
+    Com_Printf("frame %i from keyframe %i, %i messages in %.3f msec\n", framenum, keyframe, messages,
+               (uv_hrtime() - start) / 1000000.0);
+  SV_DemoCloseReader(r);
+}
@@ -115,6 +115,131 @@ void SV_EmitProjectileUpdate (sizebuf_t *msg)
 }
 #endif
 
+/*
+=============================================================================
+
+ENTITY DELTA CACHE
+
+Clients that delta from the same frame, or from the baseline, send the
+same bytes for an entity.  With sv_deltacache set the first client to
+need a delta encodes it and the others copy it.  The bytes only depend
+on the two states, the flags and the protocol, so a hit is taken when
+all of them match bit for bit and the wire format is whatever the
+encoder would have written.  Only the serial send path touches the cache.
+
+=============================================================================
+*/
+
+#define DELTACACHE_WAYS 4   // deltas kept per entity number
+#define DELTACACHE_BYTES 64 // more than either encoder ever writes
+
+typedef struct {
+  int framenum; // sv.framenum of the last use, for picking a victim
+  int protocol;
+  bool force, newentity;
+  entity_state_t from, to;
+  int length;
+  byte data[DELTACACHE_BYTES];
+} deltacache_t;
+
+static deltacache_t sv_deltacache_entries[MAX_EDICTS][DELTACACHE_WAYS];
+static int sv_deltacache_next[MAX_EDICTS];
+static int sv_deltacache_lastframe = -1; // sv.framenum the counters were last bumped in
+
+static int c_delta_hits, c_delta_misses;
+static int c_delta_frames;
+static int64_t c_delta_bytes; // copied from the cache instead of encoded
+
+static void SV_EncodeDeltaEntity(entity_state_t *from, entity_state_t *to, sizebuf_t *msg, bool force, bool newentity,
+                                 int protocol) {
+  if(protocol == PROTOCOL_VERSION)
+    MSG_WritePackedDeltaEntity(from, to, msg, force, newentity);
+  else
+    MSG_WriteDeltaEntity(from, to, msg, force, newentity);
+}
+
+/*
+=============
+SV_WriteDeltaEntity
+
+The client's entity encoder through the delta cache
+=============
+*/
+static void SV_WriteDeltaEntity(entity_state_t *from, entity_state_t *to, sizebuf_t *msg, bool force, bool newentity,
+                                int protocol) {
+  deltacache_t *ways, *cache;
+  int i, start;
+
+  if(!sv_deltacache->value) {
+    SV_EncodeDeltaEntity(from, to, msg, force, newentity, protocol);
+    return;
+  }
+
+  if(sv_deltacache_lastframe != sv.framenum) {
+    sv_deltacache_lastframe = sv.framenum;
+    c_delta_frames++;
+  }
+
+  ways = sv_deltacache_entries[to->number];
+  for(i = 0; i < DELTACACHE_WAYS; i++) {
+    cache = &ways[i];
+    if(cache->protocol == protocol && cache->force == force && cache->newentity == newentity &&
+       !memcmp(&cache->to, to, sizeof(*to)) && !memcmp(&cache->from, from, sizeof(*from))) {
+      c_delta_hits++;
+      c_delta_bytes += cache->length;
+      cache->framenum = sv.framenum;
+      SZ_Write(msg, cache->data, cache->length);
+      return;
+    }
+  }
+  c_delta_misses++;
+
+  start = msg->cursize;
+  SV_EncodeDeltaEntity(from, to, msg, force, newentity, protocol);
+  if(msg->overflowed || msg->cursize - start > DELTACACHE_BYTES)
+    return;
+
+  // replace a delta no client asked for this frame, if there is one
+  for(i = 0; i < DELTACACHE_WAYS; i++)
+    if(ways[i].framenum != sv.framenum)
+      break;
+  if(i == DELTACACHE_WAYS)
+    i = sv_deltacache_next[to->number]++ % DELTACACHE_WAYS;
+
+  cache = &ways[i];
+  cache->framenum = sv.framenum;
+  cache->protocol = protocol;
+  cache->force = force;
+  cache->newentity = newentity;
+  cache->from = *from;
+  cache->to = *to;
+  cache->length = msg->cursize - start;
+  memcpy(cache->data, msg->data + start, cache->length);
+}
+
+/*
+=============
+SV_DeltaStats_f
+
+Prints the delta cache counters since the last call and clears them
+=============
+*/
+void SV_DeltaStats_f(void) {
+  int total;
+
+  total = c_delta_hits + c_delta_misses;
+  if(!total) {
+    Com_Printf("No entity deltas through the cache\n");
+    return;
+  }
+
+  Com_Printf("%i frames, %i deltas, %i hits (%.1f%%), %i misses, %lli bytes copied\n", c_delta_frames, total,
+             c_delta_hits, 100.0 * c_delta_hits / total, c_delta_misses, (long long)c_delta_bytes);
+
+  c_delta_hits = c_delta_misses = c_delta_frames = 0;
+  c_delta_bytes = 0;
+}
+
 /*
 =============
 SV_EmitPacketEntities
@@ -122,7 +247,7 @@ SV_EmitPacketEntities
 Writes a delta update of an entity_state_t list to the message.
 =============
 */
-void SV_EmitPacketEntities(client_frame_t *from, client_frame_t *to, sizebuf_t *msg) {
+void SV_EmitPacketEntities(client_frame_t *from, client_frame_t *to, sizebuf_t *msg, int protocol) {
   entity_state_t *oldent, *newent;
   int oldindex, newindex;
   int oldnum, newnum;
@@ -163,19 +288,30 @@ void SV_EmitPacketEntities(client_frame_t *from, client_frame_t *to, sizebuf_t *
       // in any bytes being emited if the entity has not changed at all
       // note that players are always 'newentities', this updates their oldorigin always
       // and prevents warping
-      MSG_WriteDeltaEntity(oldent, newent, msg, false, newent->number <= maxclients->value);
+      SV_WriteDeltaEntity(oldent, newent, msg, false, newent->number <= maxclients->value, protocol);
+
+      // the client parses old_origin as the base origin unless it was sent,
+      // keep what it holds so the next origin is predicted the same way
+      if(protocol == PROTOCOL_VERSION && newent->number > maxclients->value && !(newent->renderfx & RF_BEAM))
+        VectorCopy(oldent->origin, newent->old_origin);
       oldindex++;
       newindex++;
       continue;
     }
 
     if(newnum < oldnum) { // this is a new entity, send it from the baseline
-      MSG_WriteDeltaEntity(&sv.baselines[newnum], newent, msg, true, true);
+      SV_WriteDeltaEntity(&sv.baselines[newnum], newent, msg, true, true, protocol);
       newindex++;
       continue;
     }
 
     if(newnum > oldnum) { // the old entity isn't present in the new message
+      if(protocol == PROTOCOL_VERSION) {
+        MSG_WritePackedEntityHeader(msg, oldnum, EB_REMOVE);
+        oldindex++;
+        continue;
+      }
+
       bits = U_REMOVE;
       if(oldnum >= 256)
         bits |= U_NUMBER16 | U_MOREBITS1;
@@ -194,7 +330,10 @@ void SV_EmitPacketEntities(client_frame_t *from, client_frame_t *to, sizebuf_t *
     }
   }
 
-  MSG_WriteShort(msg, 0); // end of packetentities
+  if(protocol == PROTOCOL_VERSION)
+    MSG_WritePackedEntityHeader(msg, 0, 0);
+  else
+    MSG_WriteShort(msg, 0); // end of packetentities
 
 #if 0
 	if (numprojs)
@@ -209,174 +348,21 @@ SV_WritePlayerstateToClient
 =============
 */
 void SV_WritePlayerstateToClient(client_frame_t *from, client_frame_t *to, sizebuf_t *msg) {
-  int i;
-  int pflags;
-  player_state_t *ps, *ops;
-  player_state_t dummy;
-  int statbits;
-
-  ps = &to->ps;
-  if(!from) {
-    memset(&dummy, 0, sizeof(dummy));
-    ops = &dummy;
-  } else
-    ops = &from->ps;
-
-  //
-  // determine what needs to be sent
-  //
-  pflags = 0;
-
-  if(ps->pmove.pm_type != ops->pmove.pm_type)
-    pflags |= PS_M_TYPE;
-
-  if(ps->pmove.origin[0] != ops->pmove.origin[0] || ps->pmove.origin[1] != ops->pmove.origin[1] ||
-     ps->pmove.origin[2] != ops->pmove.origin[2])
-    pflags |= PS_M_ORIGIN;
-
-  if(ps->pmove.velocity[0] != ops->pmove.velocity[0] || ps->pmove.velocity[1] != ops->pmove.velocity[1] ||
-     ps->pmove.velocity[2] != ops->pmove.velocity[2])
-    pflags |= PS_M_VELOCITY;
-
-  if(ps->pmove.pm_time != ops->pmove.pm_time)
-    pflags |= PS_M_TIME;
-
-  if(ps->pmove.pm_flags != ops->pmove.pm_flags)
-    pflags |= PS_M_FLAGS;
-
-  if(ps->pmove.gravity != ops->pmove.gravity)
-    pflags |= PS_M_GRAVITY;
-
-  if(ps->pmove.delta_angles[0] != ops->pmove.delta_angles[0] ||
-     ps->pmove.delta_angles[1] != ops->pmove.delta_angles[1] || ps->pmove.delta_angles[2] != ops->pmove.delta_angles[2])
-    pflags |= PS_M_DELTA_ANGLES;
-
-  if(ps->viewoffset[0] != ops->viewoffset[0] || ps->viewoffset[1] != ops->viewoffset[1] ||
-     ps->viewoffset[2] != ops->viewoffset[2])
-    pflags |= PS_VIEWOFFSET;
-
-  if(ps->viewangles[0] != ops->viewangles[0] || ps->viewangles[1] != ops->viewangles[1] ||
-     ps->viewangles[2] != ops->viewangles[2])
-    pflags |= PS_VIEWANGLES;
-
-  if(ps->kick_angles[0] != ops->kick_angles[0] || ps->kick_angles[1] != ops->kick_angles[1] ||
-     ps->kick_angles[2] != ops->kick_angles[2])
-    pflags |= PS_KICKANGLES;
-
-  if(ps->blend[0] != ops->blend[0] || ps->blend[1] != ops->blend[1] || ps->blend[2] != ops->blend[2] ||
-     ps->blend[3] != ops->blend[3])
-    pflags |= PS_BLEND;
-
-  if(ps->fov != ops->fov)
-    pflags |= PS_FOV;
-
-  if(ps->rdflags != ops->rdflags)
-    pflags |= PS_RDFLAGS;
-
-  if(ps->gunframe != ops->gunframe)
-    pflags |= PS_WEAPONFRAME;
-
-  if(ps->cmodel_index != ops->cmodel_index)
-    pflags |= PS_CMODEL_INDEX;
-
-  pflags |= PS_WEAPONINDEX;
-
-  //
-  // write it
-  //
   MSG_WriteByte(msg, svc_playerinfo);
-  MSG_WriteShort(msg, pflags);
-
-  //
-  // write the pmove_state_t
-  //
-  if(pflags & PS_M_TYPE)
-    MSG_WriteByte(msg, ps->pmove.pm_type);
-
-  if(pflags & PS_M_ORIGIN) {
-    MSG_WriteShort(msg, ps->pmove.origin[0]);
-    MSG_WriteShort(msg, ps->pmove.origin[1]);
-    MSG_WriteShort(msg, ps->pmove.origin[2]);
-  }
-
-  if(pflags & PS_M_VELOCITY) {
-    MSG_WriteShort(msg, ps->pmove.velocity[0]);
-    MSG_WriteShort(msg, ps->pmove.velocity[1]);
-    MSG_WriteShort(msg, ps->pmove.velocity[2]);
-  }
-
-  if(pflags & PS_M_TIME)
-    MSG_WriteByte(msg, ps->pmove.pm_time);
-
-  if(pflags & PS_M_FLAGS)
-    MSG_WriteByte(msg, ps->pmove.pm_flags);
-
-  if(pflags & PS_M_GRAVITY)
-    MSG_WriteShort(msg, ps->pmove.gravity);
-
-  if(pflags & PS_M_DELTA_ANGLES) {
-    MSG_WriteShort(msg, ps->pmove.delta_angles[0]);
-    MSG_WriteShort(msg, ps->pmove.delta_angles[1]);
-    MSG_WriteShort(msg, ps->pmove.delta_angles[2]);
-  }
-
-  //
-  // write the rest of the player_state_t
-  //
-  if(pflags & PS_VIEWOFFSET) {
-    MSG_WriteChar(msg, ps->viewoffset[0] * 4);
-    MSG_WriteChar(msg, ps->viewoffset[1] * 4);
-    MSG_WriteChar(msg, ps->viewoffset[2] * 4);
-  }
-
-  if(pflags & PS_VIEWANGLES) {
-    MSG_WriteAngle16(msg, ps->viewangles[0]);
-    MSG_WriteAngle16(msg, ps->viewangles[1]);
-    MSG_WriteAngle16(msg, ps->viewangles[2]);
-  }
-
-  if(pflags & PS_KICKANGLES) {
-    MSG_WriteChar(msg, ps->kick_angles[0] * 4);
-    MSG_WriteChar(msg, ps->kick_angles[1] * 4);
-    MSG_WriteChar(msg, ps->kick_angles[2] * 4);
-  }
-
-  if(pflags & PS_WEAPONINDEX) {
-    MSG_WriteByte(msg, ps->gunindex);
-  }
+  MSG_WriteDeltaPlayerstate(from ? &from->ps : NULL, &to->ps, msg);
+}
 
-  if(pflags & PS_WEAPONFRAME) {
-    MSG_WriteByte(msg, ps->gunframe);
-    MSG_WriteChar(msg, ps->gunoffset[0] * 4);
-    MSG_WriteChar(msg, ps->gunoffset[1] * 4);
-    MSG_WriteChar(msg, ps->gunoffset[2] * 4);
-    MSG_WriteChar(msg, ps->gunangles[0] * 4);
-    MSG_WriteChar(msg, ps->gunangles[1] * 4);
-    MSG_WriteChar(msg, ps->gunangles[2] * 4);
-  }
+/*
+=============
+SV_WritePackedPlayerstate
 
-  if(pflags & PS_BLEND) {
-    MSG_WriteByte(msg, ps->blend[0] * 255);
-    MSG_WriteByte(msg, ps->blend[1] * 255);
-    MSG_WriteByte(msg, ps->blend[2] * 255);
-    MSG_WriteByte(msg, ps->blend[3] * 255);
-  }
-  if(pflags & PS_FOV)
-    MSG_WriteByte(msg, ps->fov);
-  if(pflags & PS_RDFLAGS)
-    MSG_WriteByte(msg, ps->rdflags);
-  if(pflags & PS_CMODEL_INDEX)
-    MSG_WriteByte(msg, ps->cmodel_index);
-
-  // send stats
-  statbits = 0;
-  for(i = 0; i < MAX_STATS; i++)
-    if(ps->stats[i] != ops->stats[i])
-      statbits |= 1 << i;
-  MSG_WriteLong(msg, statbits);
-  for(i = 0; i < MAX_STATS; i++)
-    if(statbits & (1 << i))
-      MSG_WriteShort(msg, ps->stats[i]);
+SV_WritePlayerstateToClient for PROTOCOL_VERSION, msec is the time
+since the delta frame
+=============
+*/
+static void SV_WritePackedPlayerstate(client_frame_t *from, client_frame_t *to, sizebuf_t *msg, int msec) {
+  MSG_WriteByte(msg, svc_playerinfo);
+  MSG_WritePackedPlayerstate(from ? &from->ps : NULL, &to->ps, msg, msec);
 }
 
 /*
@@ -390,18 +376,18 @@ void SV_WriteFrameToClient(client_t *client, sizebuf_t *msg) {
 
   // Com_Printf ("%i -> %i\n", client->lastframe, sv.framenum);
   // this is the frame we are creating
-  frame = &client->frames[sv.framenum & UPDATE_MASK];
+  frame = &client->frames[sv.framenum % svs.update_backup];
 
   if(client->lastframe <= 0) { // client is asking for a retransmit
     oldframe = NULL;
     lastframe = -1;
   } else if(sv.framenum - client->lastframe >=
-            (UPDATE_BACKUP - 3)) { // client hasn't gotten a good message through in a long time
+            (svs.update_backup - 3)) { // client hasn't gotten a good message through in a long time
                                    //		Com_Printf ("%s: Delta request from out-of-date packet.\n", client->name);
     oldframe = NULL;
     lastframe = -1;
   } else { // we have a valid message to delta from
-    oldframe = &client->frames[client->lastframe & UPDATE_MASK];
+    oldframe = &client->frames[client->lastframe % svs.update_backup];
     lastframe = client->lastframe;
   }
 
@@ -416,10 +402,13 @@ void SV_WriteFrameToClient(client_t *client, sizebuf_t *msg) {
   SZ_Write(msg, frame->areabits, frame->areabytes);
 
   // delta encode the playerstate
-  SV_WritePlayerstateToClient(oldframe, frame, msg);
+  if(client->protocol == PROTOCOL_VERSION)
+    SV_WritePackedPlayerstate(oldframe, frame, msg, (sv.framenum - lastframe) * sv.frametime);
+  else
+    SV_WritePlayerstateToClient(oldframe, frame, msg);
 
   // delta encode the entities
-  SV_EmitPacketEntities(oldframe, frame, msg);
+  SV_EmitPacketEntities(oldframe, frame, msg, client->protocol);
 }
 
 /*
@@ -430,7 +419,28 @@ Build a client frame structure
 =============================================================================
 */
 
-byte fatpvs[65536 / 8]; // 32767 is MAX_MAP_LEAFS
+typedef struct {
+  byte fatpvs[65536 / 8]; // 32767 is MAX_MAP_LEAFS
+  byte pvsrow[MAX_MAP_LEAFS / 8];
+  byte phsrow[MAX_MAP_LEAFS / 8];
+  unsigned edictbits[MAX_EDICTS / 32]; // candidates from the cluster index
+} snapshot_scratch_t;
+
+// the visible entity numbers picked for one client, before they are
+// copied into the circular client_entities array
+typedef struct {
+  int num_entities; // -1 if the client is not in game yet
+  int first_entity;
+  unsigned short entities[MAX_EDICTS];
+} snapshot_t;
+
+static snapshot_scratch_t snapshot_serial;
+static unsigned short snapshot_serial_entities[MAX_EDICTS];
+
+static jobpool_t *snapshot_pool;
+static snapshot_scratch_t *snapshot_scratch; // [Job_PoolWorkers]
+static snapshot_t *snapshots;                // [maxclients->value]
+static int snapshot_maxclients;
 
 /*
 ============
@@ -440,7 +450,7 @@ The client will interpolate the view position,
 so we can't use a single PVS point
 ===========
 */
-void SV_FatPVS(int cmodel_index, vec3_t org) {
+static int SV_FatPVS(int cmodel_index, vec3_t org, snapshot_scratch_t *scratch) {
   int leafs[64];
   int i, j, count;
   int longs;
@@ -454,14 +464,14 @@ void SV_FatPVS(int cmodel_index, vec3_t org) {
 
   count = CM_BoxLeafnums(cmodel_index, mins, maxs, leafs, 64, NULL);
   if(count < 1)
-    Com_Error(ERR_FATAL, "SV_FatPVS: count < 1");
+    return count;
   longs = (CM_NumClusters(cmodel_index) + 31) >> 5;
 
   // convert leafs to clusters
   for(i = 0; i < count; i++)
     leafs[i] = CM_LeafCluster(cmodel_index, leafs[i]);
 
-  memcpy(fatpvs, CM_ClusterPVS(cmodel_index, leafs[0]), longs << 2);
+  memcpy(scratch->fatpvs, CM_CopyClusterPVS(cmodel_index, leafs[0], scratch->pvsrow), longs << 2);
   // or in all the other leaf bits
   for(i = 1; i < count; i++) {
     for(j = 0; j < i; j++)
@@ -469,46 +479,46 @@ void SV_FatPVS(int cmodel_index, vec3_t org) {
         break;
     if(j != i)
       continue; // already have the cluster we want
-    src = CM_ClusterPVS(cmodel_index, leafs[i]);
+    src = CM_CopyClusterPVS(cmodel_index, leafs[i], scratch->pvsrow);
     for(j = 0; j < longs; j++)
-      ((long *)fatpvs)[j] |= ((long *)src)[j];
+      ((long *)scratch->fatpvs)[j] |= ((long *)src)[j];
   }
+
+  return count;
 }
 
 /*
 =============
-SV_BuildClientFrame
+SV_CollectClientEntities
 
 Decides which entities are going to be visible to the client, and
-copies off the playerstat and areabits.
+copies off the playerstat and areabits.  Only the client's own frame
+and the scratch space are written, so this can run on a snapshot worker.
+Returns the number of entity numbers put in list, or -1 if the client
+is not in game yet.
 =============
 */
-void SV_BuildClientFrame(client_t *client) {
+static int SV_CollectClientEntities(client_t *client, snapshot_scratch_t *scratch, unsigned short *list) {
   int e, i;
   vec3_t org;
   edict_t *ent;
   edict_t *clent;
   client_frame_t *frame;
-  entity_state_t *state;
   int l;
   int clientarea, clientcluster;
   int leafnum;
-  int c_fullsend;
+  int count;
   byte *clientphs;
   byte *bitvector;
 
   clent = client->edict;
   if(!clent->client)
-    return; // not in game yet
+    return -1; // not in game yet
 
   int cmodel_index = clent->s.cmodel_index;
 
-#if 0
-	numprojs = 0; // no projectiles yet
-#endif
-
   // this is the frame we are creating
-  frame = &client->frames[sv.framenum & UPDATE_MASK];
+  frame = &client->frames[sv.framenum % svs.update_backup];
 
   frame->senttime = svs.realtime; // save it for ping calc later
 
@@ -526,16 +536,28 @@ void SV_BuildClientFrame(client_t *client) {
   // grab the current player_state_t
   frame->ps = clent->client->ps;
 
-  SV_FatPVS(cmodel_index, org);
-  clientphs = CM_ClusterPHS(cmodel_index, clientcluster);
+  if(SV_FatPVS(cmodel_index, org, scratch) < 1)
+    return -2;
+  clientphs = CM_CopyClusterPHS(cmodel_index, clientcluster, scratch->phsrow);
+
+  // only entities linked into a visible cluster can pass the checks
+  // below, the cluster index hands those out in edict order
+  memset(scratch->edictbits, 0, sizeof(scratch->edictbits));
+  SV_ClusterEdicts(cmodel_index, scratch->fatpvs, scratch->edictbits);
+  e = NUM_FOR_EDICT(clent);
+  scratch->edictbits[e >> 5] |= 1u << (e & 31);
 
   // build up the list of visible entities
-  frame->num_entities = 0;
-  frame->first_entity = svs.next_client_entities;
+  count = 0;
 
-  c_fullsend = 0;
+  for(e = 1; e < ge->num_edicts && e < MAX_EDICTS; e++) {
+    if(!scratch->edictbits[e >> 5]) {
+      e |= 31; // skip the whole word
+      continue;
+    }
+    if(!(scratch->edictbits[e >> 5] & (1u << (e & 31))))
+      continue;
 
-  for(e = 1; e < ge->num_edicts; e++) {
     ent = EDICT_NUM(e);
 
     // ignore ents without visible models
@@ -567,14 +589,13 @@ void SV_BuildClientFrame(client_t *client) {
         // FIXME: if an ent has a model and a sound, but isn't
         // in the PVS, only the PHS, clear the model
         if(ent->s.sound) {
-          bitvector = fatpvs; // clientphs;
+          bitvector = scratch->fatpvs; // clientphs;
         } else
-          bitvector = fatpvs;
+          bitvector = scratch->fatpvs;
 
         if(ent->num_clusters == -1) { // too many leafs for individual check, go by headnode
           if(!CM_HeadnodeVisible(cmodel_index, ent->headnode, bitvector))
             continue;
-          c_fullsend++;
         } else { // check individual leafs
           for(i = 0; i < ent->num_clusters; i++) {
             l = ent->clusternums[i];
@@ -597,76 +618,210 @@ void SV_BuildClientFrame(client_t *client) {
       }
     }
 
-#if 0
-		if (SV_AddProjectileUpdate(ent))
-			continue; // added as a special projectile
-#endif
+    list[count++] = e;
+  }
+
+  return count;
+}
+
+/*
+=============
+SV_WriteClientEntities
+
+Copies the collected entities into the circular client_entities
+array starting at first.  Slices for different clients never overlap
+within a frame, so workers can fill them in parallel.
+=============
+*/
+static void SV_WriteClientEntities(client_t *client, const unsigned short *list, int count, int first) {
+  entity_state_t *state;
+  edict_t *ent;
+  int i;
+
+  for(i = 0; i < count; i++) {
+    ent = EDICT_NUM(list[i]);
 
     // add it to the circular client_entities array
-    state = &svs.client_entities[svs.next_client_entities % svs.num_client_entities];
-    if(ent->s.number != e) {
-      Com_DPrintf("FIXING ENT->S.NUMBER!!!\n");
-      ent->s.number = e;
-    }
+    state = &svs.client_entities[(first + i) % svs.num_client_entities];
     *state = ent->s;
 
     // don't mark players missiles as solid
     if(ent->owner == client->edict)
       state->solid = 0;
+  }
+}
 
-    svs.next_client_entities++;
-    frame->num_entities++;
+/*
+=============
+SV_FixEntityNumbers
+=============
+*/
+static void SV_FixEntityNumbers(void) {
+  edict_t *ent;
+  int e;
+
+  for(e = 1; e < ge->num_edicts; e++) {
+    ent = EDICT_NUM(e);
+    if(ent->s.number != e) {
+      Com_DPrintf("FIXING ENT->S.NUMBER!!!\n");
+      ent->s.number = e;
+    }
   }
 }
 
 /*
-==================
-SV_RecordDemoMessage
+=============
+SV_BuildClientFrame
 
-Save everything in the world out without deltas.
-Used for recording footage for merged or assembled demos
-==================
+Decides which entities are going to be visible to the client, and
+copies off the playerstat and areabits.
+=============
 */
-void SV_RecordDemoMessage(void) {
-  int e;
-  edict_t *ent;
-  entity_state_t nostate;
-  sizebuf_t buf;
-  byte buf_data[32768];
-  int len;
+void SV_BuildClientFrame(client_t *client) {
+  client_frame_t *frame;
+  int count;
+  int i;
 
-  if(!svs.demofile)
-    return;
+  count = SV_CollectClientEntities(client, &snapshot_serial, snapshot_serial_entities);
+  if(count == -1)
+    return; // not in game yet
+  if(count < 0)
+    Com_Error(ERR_FATAL, "SV_FatPVS: count < 1");
 
-  memset(&nostate, 0, sizeof(nostate));
-  SZ_Init(&buf, buf_data, sizeof(buf_data));
+  for(i = 0; i < count; i++) {
+    edict_t *ent = EDICT_NUM(snapshot_serial_entities[i]);
+    if(ent->s.number != snapshot_serial_entities[i]) {
+      Com_DPrintf("FIXING ENT->S.NUMBER!!!\n");
+      ent->s.number = snapshot_serial_entities[i];
+    }
+  }
 
-  // write a frame message that doesn't contain a player_state_t
-  MSG_WriteByte(&buf, svc_frame);
-  MSG_WriteLong(&buf, sv.framenum);
+  frame = &client->frames[sv.framenum % svs.update_backup];
+  frame->first_entity = svs.next_client_entities;
+  frame->num_entities = count;
 
-  MSG_WriteByte(&buf, svc_packetentities);
+  SV_WriteClientEntities(client, snapshot_serial_entities, count, frame->first_entity);
+  svs.next_client_entities += count;
+}
 
-  e = 1;
-  ent = EDICT_NUM(e);
-  while(e < ge->num_edicts) {
-    // ignore ents without visible models unless they have an effect
-    if(ent->inuse && ent->s.number && (ent->s.modelindex || ent->s.effects || ent->s.sound || ent->s.event) &&
-       !(ent->svflags & SVF_NOCLIENT))
-      MSG_WriteDeltaEntity(&nostate, &ent->s, &buf, false, true);
+/*
+=============================================================================
 
-    e++;
-    ent = EDICT_NUM(e);
+Threaded client frame building
+
+Every worker takes every Nth client and picks its visible entities
+into a private list with its own fatpvs scratch.  The slices of the
+circular client_entities array are then handed out in client order, the
+same way the serial path does it, and the workers copy the entity states
+into their own slices.  The resulting frames are identical to calling
+SV_BuildClientFrame for each client in turn.
+
+=============================================================================
+*/
+
+static const bool *snapshot_build;
+
+static void SV_CollectClientEntitiesJob(void *data, int worker, int numworkers) {
+  int i;
+
+  (void)data;
+  Prof_Begin("SV_CollectClientEntities");
+  for(i = worker; i < snapshot_maxclients; i += numworkers) {
+    if(!snapshot_build[i])
+      continue;
+    snapshots[i].num_entities =
+        SV_CollectClientEntities(&svs.clients[i], &snapshot_scratch[worker], snapshots[i].entities);
   }
+  Prof_End();
+}
 
-  MSG_WriteShort(&buf, 0); // end of packetentities
+static void SV_WriteClientEntitiesJob(void *data, int worker, int numworkers) {
+  int i;
+
+  (void)data;
+  Prof_Begin("SV_WriteClientEntities");
+  for(i = worker; i < snapshot_maxclients; i += numworkers) {
+    if(!snapshot_build[i] || snapshots[i].num_entities < 0)
+      continue;
+    SV_WriteClientEntities(&svs.clients[i], snapshots[i].entities, snapshots[i].num_entities,
+                           snapshots[i].first_entity);
+  }
+  Prof_End();
+}
 
-  // now add the accumulated multicast information
-  SZ_Write(&buf, svs.demo_multicast.data, svs.demo_multicast.cursize);
-  SZ_Clear(&svs.demo_multicast);
+/*
+=============
+SV_ShutdownSnapshotThreads
+=============
+*/
+void SV_ShutdownSnapshotThreads(void) {
+  Job_DestroyPool(snapshot_pool);
+  snapshot_pool = NULL;
+
+  if(snapshot_scratch)
+    Z_Free(snapshot_scratch);
+  snapshot_scratch = NULL;
+
+  if(snapshots)
+    Z_Free(snapshots);
+  snapshots = NULL;
+  snapshot_maxclients = 0;
+}
+
+static void SV_InitSnapshotThreads(void) {
+  int numthreads;
+
+  numthreads = sv_snapshot_threads->value;
+  if(numthreads < 1)
+    numthreads = 1;
+
+  // the calling thread is a worker too
+  snapshot_pool = Job_CreatePool(numthreads - 1);
+  snapshot_scratch = Z_Malloc(sizeof(*snapshot_scratch) * Job_PoolWorkers(snapshot_pool));
+  snapshot_maxclients = maxclients->value;
+  snapshots = Z_Malloc(sizeof(*snapshots) * snapshot_maxclients);
+}
+
+/*
+=============
+SV_BuildClientFrames
+
+Builds the frames of every client flagged in build on the snapshot
+workers, in the same order and with the same results as calling
+SV_BuildClientFrame for each of them.
+=============
+*/
+void SV_BuildClientFrames(const bool *build) {
+  client_frame_t *frame;
+  int i;
+
+  if(sv_snapshot_threads->modified || snapshot_maxclients != (int)maxclients->value) {
+    sv_snapshot_threads->modified = false;
+    SV_ShutdownSnapshotThreads();
+    SV_InitSnapshotThreads();
+  }
+
+  // the serial path fixes these up as it goes, the workers only read them
+  SV_FixEntityNumbers();
+
+  snapshot_build = build;
+  Job_Run(snapshot_pool, SV_CollectClientEntitiesJob, NULL);
+
+  // hand out the slices of the entity ring in client order
+  for(i = 0; i < snapshot_maxclients; i++) {
+    if(!build[i] || snapshots[i].num_entities == -1)
+      continue;
+    if(snapshots[i].num_entities < 0)
+      Com_Error(ERR_FATAL, "SV_FatPVS: count < 1");
+
+    frame = &svs.clients[i].frames[sv.framenum % svs.update_backup];
+    frame->first_entity = svs.next_client_entities;
+    frame->num_entities = snapshots[i].num_entities;
+
+    snapshots[i].first_entity = svs.next_client_entities;
+    svs.next_client_entities += snapshots[i].num_entities;
+  }
 
-  // now write the entire message to the file, prefixed by the length
-  len = LittleLong(buf.cursize);
-  fwrite(&len, 4, 1, svs.demofile);
-  fwrite(buf.data, buf.cursize, 1, svs.demofile);
+  Job_Run(snapshot_pool, SV_WriteClientEntitiesJob, NULL);
+  snapshot_build = NULL;
 }
@@ -379,6 +379,12 @@ void SV_InitGameProgs(void) {
   import.AddCommandString = Cbuf_AddText;
 
   import.DebugGraph = SCR_DebugGraph;
+  import.ProfileBegin = Prof_Begin;
+  import.ProfileEnd = Prof_End;
+  import.WriteSave = SV_WriteSave;
+  import.ReadSave = SV_ReadSave;
+  import.tracebatch = SV_TraceBatch;
+  import.SphereEdicts = SV_SphereEdicts;
   import.SetAreaPortalState = SV_SetAreaPortalState;
   import.AreasConnected = SV_AreasConnected;
 
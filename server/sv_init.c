@@ -111,7 +111,8 @@ void SV_CheckForSavegame(void) {
   if(Cvar_VariableValue("deathmatch"))
     return;
 
-  Com_sprintf(name, sizeof(name), "%s/save/current/%s.sav", FS_Gamedir(), sv.name);
+  // the sav may be a database row, but the sv2 is always a file
+  Com_sprintf(name, sizeof(name), "%s/save/current/%s.sv2", FS_Gamedir(), sv.name);
   f = fopen(name, "rb");
   if(!f)
     return; // no savegame
@@ -142,6 +143,25 @@ void SV_CheckForSavegame(void) {
   }
 }
 
+/*
+================
+SV_FrameMsec
+
+The server frame length sv_fps asks for, in whole msec.  sv_fps is
+latched, so this holds from SV_InitGame to the next one
+================
+*/
+static int SV_FrameMsec(void) {
+  int fps;
+
+  fps = sv_fps->value;
+  if(fps < 10)
+    fps = 10;
+  else if(fps > 100)
+    fps = 100;
+  return 1000 / fps;
+}
+
 /*
 ================
 SV_SpawnServer
@@ -163,6 +183,11 @@ void SV_SpawnServer(char *server, char *spawnpoint, server_state_t serverstate,
   Com_DPrintf("SpawnServer: %s\n", server);
   if(sv.demofile)
     fclose(sv.demofile);
+  if(sv.demoreader)
+    SV_DemoCloseReader(sv.demoreader);
+
+  // zone tags the last map emptied give their arenas back
+  Z_ReleaseArenas();
 
   svs.spawncount++; // any partially connected client will be
                     // restarted
@@ -197,6 +222,10 @@ void SV_SpawnServer(char *server, char *spawnpoint, server_state_t serverstate,
     svs.clients[i].lastframe = -1;
   }
 
+  // whole msec server frames, the game itself keeps to GAME_FRAMEMSEC
+  sv.frametime = SV_FrameMsec();
+  sprintf(sv.configstrings[CS_FRAMETIME], "%i", sv.frametime);
+
   sv.time = 1000;
 
   strcpy(sv.name, server);
@@ -319,7 +348,13 @@ void SV_InitGame(void) {
 
   svs.spawncount = rand();
   svs.clients = Z_Malloc(sizeof(client_t) * maxclients->value);
-  svs.num_client_entities = maxclients->value * UPDATE_BACKUP * 64;
+  // the same delta window in time whatever the frame rate
+  svs.update_backup = UPDATE_BACKUP_MSEC / SV_FrameMsec();
+  if(svs.update_backup > UPDATE_BACKUP)
+    svs.update_backup = UPDATE_BACKUP;
+  for(i = 0; i < maxclients->value; i++)
+    svs.clients[i].frames = Z_Malloc(sizeof(client_frame_t) * svs.update_backup);
+  svs.num_client_entities = maxclients->value * svs.update_backup * 64;
   svs.client_entities = Z_Malloc(sizeof(entity_state_t) * svs.num_client_entities);
 
   // init network stuff
@@ -399,7 +434,7 @@ void SV_Map(bool attractloop, char *levelstring, bool loadgame) {
     SCR_BeginLoadingPlaque(); // for local system
     SV_BroadcastCommand("changing\n");
     SV_SpawnServer(level, spawnpoint, ss_cinematic, attractloop, loadgame);
-  } else if(l > 4 && !strcmp(level + l - 4, ".dm2")) {
+  } else if(l > 4 && (!strcmp(level + l - 4, ".dm2") || !strcmp(level + l - 4, ".svd"))) {
     SCR_BeginLoadingPlaque(); // for local system
     SV_BroadcastCommand("changing\n");
     SV_SpawnServer(level, spawnpoint, ss_demo, attractloop, loadgame);
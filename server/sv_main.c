@@ -20,6 +20,8 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 #include "server.h"
 
+#include <uv.h>
+
 netadr_t master_adr[MAX_MASTERS]; // address of group servers
 
 client_t *sv_client; // current client
@@ -52,6 +54,13 @@ cvar_t *public_server; // should heartbeats be sent
 
 cvar_t *sv_reconnect_limit; // minimum seconds between connect messages
 
+cvar_t *sv_snapshot_threads;
+cvar_t *sv_broadphase;
+cvar_t *sv_fps;
+cvar_t *sv_deltacache;
+cvar_t *sv_savedatabase;
+cvar_t *sv_demokeyframe;
+
 sqlite3 *sv_database;
 
 void Master_Shutdown(void);
@@ -171,7 +180,7 @@ void SVC_Info(void) {
 
   version = atoi(Cmd_Argv(1));
 
-  if(version != PROTOCOL_VERSION)
+  if(version != PROTOCOL_VERSION && version != PROTOCOL_VERSION_OLD)
     Com_sprintf(string, sizeof(string), "%s: wrong version\n", hostname->string, sizeof(string));
   else {
     count = 0;
@@ -278,12 +287,20 @@ void SVC_DirectConnect(void) {
   Com_DPrintf("SVC_DirectConnect ()\n");
 
   version = atoi(Cmd_Argv(1));
-  if(version != PROTOCOL_VERSION) {
+  if(version != PROTOCOL_VERSION && version != PROTOCOL_VERSION_OLD) {
     Netchan_OutOfBandPrint(NS_SERVER, adr, "print\nServer is version %4.2f.\n", VERSION);
     Com_DPrintf("    rejected connect from version %i\n", version);
     return;
   }
 
+  // protocol 34 has no CS_FRAMETIME, its clients assume 10 frames a second
+  if(version == PROTOCOL_VERSION_OLD && sv.frametime != GAME_FRAMEMSEC) {
+    Netchan_OutOfBandPrint(NS_SERVER, adr, "print\nServer runs at %i fps, protocol %i needs %i.\n",
+                           1000 / sv.frametime, PROTOCOL_VERSION_OLD, 1000 / GAME_FRAMEMSEC);
+    Com_DPrintf("    rejected protocol %i connect at %i msec frames\n", version, sv.frametime);
+    return;
+  }
+
   qport = atoi(Cmd_Argv(2));
 
   challenge = atoi(Cmd_Argv(3));
@@ -355,13 +372,17 @@ void SVC_DirectConnect(void) {
 gotnewcl:
   // build a new connection
   // accept the new client
-  // this is the only place a client_t is ever initialized
+  // this is the only place a client_t is ever initialized,
+  // the frames stay with the slot
+  temp.frames = newcl->frames;
+  memset(temp.frames, 0, sizeof(client_frame_t) * svs.update_backup);
   *newcl = temp;
   sv_client = newcl;
   edictnum = (newcl - svs.clients) + 1;
   ent = EDICT_NUM(edictnum);
   newcl->edict = ent;
   newcl->challenge = challenge; // save challenge for checksumming
+  newcl->protocol = version;
 
   // get the game a chance to reject this connection or modify the userinfo
   if(!(ge->ClientConnect(ent, userinfo))) {
@@ -542,7 +563,7 @@ void SV_GiveMsec(void) {
   int i;
   client_t *cl;
 
-  if(sv.framenum & 15)
+  if(sv.framenum % (1600 / sv.frametime))
     return;
 
   for(i = 0; i < maxclients->value; i++) {
@@ -675,36 +696,111 @@ void SV_PrepWorldFrame(void) {
   }
 }
 
+/*
+==============================================================================
+
+TICK JITTER
+
+Every server frame notes how far its start strayed from one frametime
+after the one before, sv_tickstats sums up the last TICK_HISTORY frames
+
+==============================================================================
+*/
+
+#define TICK_HISTORY 256
+
+static uint64_t sv_lasttick;            // uv_hrtime of the previous server frame
+static int sv_tickjitter[TICK_HISTORY]; // usec off the ideal interval
+static int sv_numticks;
+static int sv_lateticks; // started a whole frame late
+
+static void SV_MeasureTick(void) {
+  uint64_t now;
+  int jitter;
+
+  now = uv_hrtime();
+
+  // the first frame of a level has nothing to be measured against
+  if(sv.framenum) {
+    jitter = (int)((int64_t)(now - sv_lasttick) / 1000) - sv.frametime * 1000;
+    sv_tickjitter[sv_numticks++ % TICK_HISTORY] = jitter;
+    if(jitter >= sv.frametime * 1000)
+      sv_lateticks++;
+  }
+  sv_lasttick = now;
+}
+
+static int SV_SortJitter(const void *a, const void *b) {
+  int x = abs(*(const int *)a), y = abs(*(const int *)b);
+
+  return x < y ? -1 : x > y;
+}
+
+/*
+=================
+SV_TickStats_f
+=================
+*/
+void SV_TickStats_f(void) {
+  int sorted[TICK_HISTORY];
+  int count, i;
+  int64_t total;
+
+  count = sv_numticks < TICK_HISTORY ? sv_numticks : TICK_HISTORY;
+  if(!count) {
+    Com_Printf("No server frames measured\n");
+    return;
+  }
+
+  total = 0;
+  for(i = 0; i < count; i++)
+    total += sv_tickjitter[i];
+  memcpy(sorted, sv_tickjitter, count * sizeof(sorted[0]));
+  qsort(sorted, count, sizeof(sorted[0]), SV_SortJitter);
+
+  Com_Printf("%i frames of %i msec, %i started a frame late since startup\n", count, sv.frametime, sv_lateticks);
+  Com_Printf("jitter msec: mean %+.3f  p50 %.3f  p95 %.3f  p99 %.3f  max %.3f\n", total / (double)count / 1000.0,
+             abs(sorted[count * 50 / 100]) / 1000.0, abs(sorted[count * 95 / 100]) / 1000.0,
+             abs(sorted[count * 99 / 100]) / 1000.0, abs(sorted[count - 1]) / 1000.0);
+}
+
 /*
 =================
 SV_RunGameFrame
 =================
 */
 void SV_RunGameFrame(void) {
-  if(host_speeds->value)
-    time_before_game = Sys_Milliseconds();
-
   // we always need to bump framenum, even if we
   // don't run the world, otherwise the delta
   // compression can get confused when a client
   // has the "current" frame
   sv.framenum++;
-  sv.time = sv.framenum * 100;
-
-  // don't run if paused
-  if(!sv_paused->value || maxclients->value > 1) {
-    ge->RunFrame();
-
-    // never get more than one tic behind
-    if(sv.time < svs.realtime) {
-      if(sv_showclamp->value)
-        Com_Printf("sv highclamp\n");
-      svs.realtime = sv.time;
+  sv.time = sv.framenum * sv.frametime;
+
+  // catch clients the game moved without relinking
+  SV_UpdateClientLeafs();
+
+  // the game only moves in GAME_FRAMEMSEC steps, the server frames in
+  // between carry client moves and snapshots
+  if(sv.time >= sv.gametime) {
+    sv.gametime += GAME_FRAMEMSEC;
+    if(sv.gametime <= sv.time)
+      sv.gametime = sv.time + GAME_FRAMEMSEC;
+
+    // don't run if paused
+    if(!sv_paused->value || maxclients->value > 1) {
+      Prof_Begin("SV_RunGameFrame");
+      ge->RunFrame();
+      Prof_End();
     }
   }
 
-  if(host_speeds->value)
-    time_after_game = Sys_Milliseconds();
+  // never get more than one tic behind
+  if(sv.time < svs.realtime) {
+    if(sv_showclamp->value)
+      Com_Printf("sv highclamp\n");
+    svs.realtime = sv.time;
+  }
 }
 
 /*
@@ -714,8 +810,6 @@ SV_Frame
 ==================
 */
 void SV_Frame(int msec) {
-  time_before_game = time_after_game = 0;
-
   // if server is not active, do nothing
   if(!svs.initialized)
     return;
@@ -734,15 +828,17 @@ void SV_Frame(int msec) {
   // move autonomous things around if enough time has passed
   if(!sv_timedemo->value && svs.realtime < sv.time) {
     // never let the time get too far off
-    if(sv.time - svs.realtime > 100) {
+    if(sv.time - svs.realtime > sv.frametime) {
       if(sv_showclamp->value)
         Com_Printf("sv lowclamp\n");
-      svs.realtime = sv.time - 100;
+      svs.realtime = sv.time - sv.frametime;
     }
     NET_Sleep(sv.time - svs.realtime);
     return;
   }
 
+  SV_MeasureTick();
+
   // update ping based on the last known frame from all clients
   SV_CalcPings();
 
@@ -763,6 +859,9 @@ void SV_Frame(int msec) {
 
   // clear teleport flags, etc for next frame
   SV_PrepWorldFrame();
+
+  // come straight back if this frame fell behind
+  NET_Sleep(sv.time - svs.realtime);
 }
 
 //============================================================================
@@ -917,6 +1016,13 @@ void SV_Init(void) {
 
   sv_reconnect_limit = Cvar_Get("sv_reconnect_limit", "3", CVAR_ARCHIVE);
 
+  sv_snapshot_threads = Cvar_Get("sv_snapshot_threads", "0", 0);
+  sv_broadphase = Cvar_Get("sv_broadphase", "0", 0);
+  sv_fps = Cvar_Get("sv_fps", "10", CVAR_SERVERINFO | CVAR_LATCH);
+  sv_deltacache = Cvar_Get("sv_deltacache", "1", 0);
+  sv_savedatabase = Cvar_Get("sv_savedatabase", "0", CVAR_ARCHIVE);
+  sv_demokeyframe = Cvar_Get("sv_demokeyframe", "10", 0);
+
   SZ_Init(&net_message, net_message_buffer, sizeof(net_message_buffer));
 
   Cbuf_AddText("sv_reload_database\n");
@@ -967,24 +1073,31 @@ before Sys_Quit or Sys_Error
 ================
 */
 void SV_Shutdown(char *finalmsg, bool reconnect) {
+  int i;
+
   if(svs.clients)
     SV_FinalMessage(finalmsg, reconnect);
 
   Master_Shutdown();
+  SV_ShutdownSnapshotThreads();
   SV_ShutdownGameProgs();
 
   // free current level
   if(sv.demofile)
     fclose(sv.demofile);
+  if(sv.demoreader)
+    SV_DemoCloseReader(sv.demoreader);
   memset(&sv, 0, sizeof(sv));
   Com_SetServerState(sv.state);
 
   // free server static data
-  if(svs.clients)
+  if(svs.clients) {
+    for(i = 0; i < maxclients->value; i++)
+      Z_Free(svs.clients[i].frames);
     Z_Free(svs.clients);
+  }
   if(svs.client_entities)
     Z_Free(svs.client_entities);
-  if(svs.demofile)
-    fclose(svs.demofile);
+  SV_DemoStopRecord();
   memset(&svs, 0, sizeof(svs));
 }
@@ -21,6 +21,8 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 #include "server.h"
 
+#include <uv.h>
+
 /*
 =============================================================================
 
@@ -144,15 +146,18 @@ then clears sv.multicast.
 MULTICAST_ALL	same as broadcast (origin can be NULL)
 MULTICAST_PVS	send to clients potentially visible from org
 MULTICAST_PHS	send to clients potentially hearable from org
+
+Only clients on the same collision map get the PVS and PHS kinds.
 =================
 */
 void SV_Multicast(int cmodel_index, vec3_t origin, multicast_t to) {
+  unsigned clientbits[MAX_CLIENTS / 32];
   client_t *client;
   byte *mask;
   int leafnum, cluster;
   int j;
   bool reliable;
-  int area1, area2;
+  int area1;
 
   reliable = false;
 
@@ -165,7 +170,7 @@ void SV_Multicast(int cmodel_index, vec3_t origin, multicast_t to) {
   }
 
   // if doing a serverrecord, store everything
-  if(svs.demofile)
+  if(svs.demowriter)
     SZ_Write(&svs.demo_multicast, sv.multicast.data, sv.multicast.cursize);
 
   switch(to) {
@@ -197,23 +202,28 @@ void SV_Multicast(int cmodel_index, vec3_t origin, multicast_t to) {
     Com_Error(ERR_FATAL, "SV_Multicast: bad to:%i", to);
   }
 
+  // the client leaf groups pick out everyone who can see or hear it
+  if(mask) {
+    memset(clientbits, 0, sizeof(clientbits));
+    SV_ClusterClients(cmodel_index, area1, mask, clientbits);
+  } else
+    memset(clientbits, 0xff, sizeof(clientbits));
+
   // send the data to all relevent clients
-  for(j = 0, client = svs.clients; j < maxclients->value; j++, client++) {
+  for(j = 0; j < maxclients->value; j++) {
+    if(!clientbits[j >> 5]) {
+      j |= 31; // skip the whole word
+      continue;
+    }
+    if(!(clientbits[j >> 5] & (1u << (j & 31))))
+      continue;
+
+    client = &svs.clients[j];
     if(client->state == cs_free || client->state == cs_zombie)
       continue;
     if(client->state != cs_spawned && !reliable)
       continue;
 
-    if(mask) {
-      leafnum = CM_PointLeafnum(cmodel_index, client->edict->s.origin);
-      cluster = CM_LeafCluster(cmodel_index, leafnum);
-      area2 = CM_LeafArea(cmodel_index, leafnum);
-      if(!CM_AreasConnected(cmodel_index, area1, area2))
-        continue;
-      if(mask && (!(mask[cluster >> 3] & (1 << (cluster & 7)))))
-        continue;
-    }
-
     if(reliable)
       SZ_Write(&client->netchan.message, sv.multicast.data, sv.multicast.cursize);
     else
@@ -223,6 +233,113 @@ void SV_Multicast(int cmodel_index, vec3_t origin, multicast_t to) {
   SZ_Clear(&sv.multicast);
 }
 
+/*
+=================
+SV_MulticastBench_f
+
+Picks multicast recipients from the origin of every linked entity on a
+collision map, first with the three leaf lookups per client that
+SV_Multicast used to make and then from the client leaf groups.  Nothing
+is sent.  Fill a map with players and explosions before running it.
+=================
+*/
+void SV_MulticastBench_f(void) {
+  static vec3_t origins[MAX_EDICTS];
+  unsigned clientbits[MAX_CLIENTS / 32];
+  int cmodel_index;
+  int numorigins, iterations;
+  int i, j, c, e;
+  int leafnum, cluster, area, area2;
+  int results;
+  uint64_t start, elapsed;
+  client_t *client;
+  edict_t *check;
+  byte *mask;
+  bool phs;
+
+  if(sv.state != ss_game) {
+    Com_Printf("No map loaded.\n");
+    return;
+  }
+
+  cmodel_index = Cmd_Argc() > 1 ? atoi(Cmd_Argv(1)) : CMODEL_A;
+  if(cmodel_index < 0 || cmodel_index >= CMODEL_COUNT) {
+    Com_Printf("usage: sv_multicast_bench [cmodel_index] [pvs|phs] [iterations]\n");
+    return;
+  }
+  phs = Cmd_Argc() <= 2 || Q_stricmp(Cmd_Argv(2), "pvs");
+  iterations = Cmd_Argc() > 3 ? atoi(Cmd_Argv(3)) : 100;
+  if(iterations < 1)
+    iterations = 1;
+
+  numorigins = 0;
+  for(e = 1; e < ge->num_edicts; e++) {
+    check = EDICT_NUM(e);
+    if(!check->inuse || !check->linkcount || check->s.cmodel_index != cmodel_index)
+      continue;
+    VectorCopy(check->s.origin, origins[numorigins]);
+    numorigins++;
+  }
+
+  SV_UpdateClientLeafs();
+
+  Com_Printf("%i origins, %i clients, %s, %i iterations\n", numorigins, (int)maxclients->value, phs ? "phs" : "pvs",
+             iterations);
+  Com_Printf("name     multicasts    sent      msec\n");
+
+  results = 0;
+  start = uv_hrtime();
+  for(j = 0; j < iterations; j++) {
+    for(i = 0; i < numorigins; i++) {
+      leafnum = CM_PointLeafnum(cmodel_index, origins[i]);
+      area = CM_LeafArea(cmodel_index, leafnum);
+      cluster = CM_LeafCluster(cmodel_index, leafnum);
+      mask = phs ? CM_ClusterPHS(cmodel_index, cluster) : CM_ClusterPVS(cmodel_index, cluster);
+
+      for(c = 0, client = svs.clients; c < maxclients->value; c++, client++) {
+        if(client->state == cs_free || client->state == cs_zombie)
+          continue;
+        if(client->edict->s.cmodel_index != cmodel_index)
+          continue;
+        leafnum = CM_PointLeafnum(cmodel_index, client->edict->s.origin);
+        cluster = CM_LeafCluster(cmodel_index, leafnum);
+        area2 = CM_LeafArea(cmodel_index, leafnum);
+        if(!CM_AreasConnected(cmodel_index, area, area2))
+          continue;
+        if(cluster < 0 || !(mask[cluster >> 3] & (1 << (cluster & 7))))
+          continue;
+        results++;
+      }
+    }
+  }
+  elapsed = uv_hrtime() - start;
+  Com_Printf("%-8s %10i %7i %9.3f\n", "leafs", numorigins * iterations, results / iterations, elapsed / 1000000.0);
+
+  results = 0;
+  start = uv_hrtime();
+  for(j = 0; j < iterations; j++) {
+    for(i = 0; i < numorigins; i++) {
+      leafnum = CM_PointLeafnum(cmodel_index, origins[i]);
+      area = CM_LeafArea(cmodel_index, leafnum);
+      cluster = CM_LeafCluster(cmodel_index, leafnum);
+      mask = phs ? CM_ClusterPHS(cmodel_index, cluster) : CM_ClusterPVS(cmodel_index, cluster);
+
+      memset(clientbits, 0, sizeof(clientbits));
+      SV_ClusterClients(cmodel_index, area, mask, clientbits);
+
+      for(c = 0, client = svs.clients; c < maxclients->value; c++, client++) {
+        if(!(clientbits[c >> 5] & (1u << (c & 31))))
+          continue;
+        if(client->state == cs_free || client->state == cs_zombie)
+          continue;
+        results++;
+      }
+    }
+  }
+  elapsed = uv_hrtime() - start;
+  Com_Printf("%-8s %10i %7i %9.3f\n", "groups", numorigins * iterations, results / iterations, elapsed / 1000000.0);
+}
+
 /*
 ==================
 SV_StartSound
@@ -357,14 +474,14 @@ FRAME UPDATES
 /*
 =======================
 SV_SendClientDatagram
+
+The client's frame for this server frame must already be built
 =======================
 */
 bool SV_SendClientDatagram(client_t *client) {
   byte msg_buf[MAX_MSGLEN];
   sizebuf_t msg;
 
-  SV_BuildClientFrame(client);
-
   SZ_Init(&msg, msg_buf, sizeof(msg_buf));
   msg.allowoverflow = true;
 
@@ -406,6 +523,10 @@ void SV_DemoCompleted(void) {
     fclose(sv.demofile);
     sv.demofile = NULL;
   }
+  if(sv.demoreader) {
+    SV_DemoCloseReader(sv.demoreader);
+    sv.demoreader = NULL;
+  }
   SV_Nextserver();
 }
 
@@ -431,7 +552,8 @@ bool SV_RateDrop(client_t *c) {
     total += c->message_size[i];
   }
 
-  if(total > c->rate) {
+  // the last RATE_MESSAGES frames against a second's worth of rate
+  if(total > c->rate * RATE_MESSAGES * sv.frametime / 1000) {
     c->surpressCount++;
     c->message_size[sv.framenum % RATE_MESSAGES] = 0;
     return true;
@@ -451,11 +573,28 @@ void SV_SendClientMessages(void) {
   int msglen;
   byte msgbuf[MAX_MSGLEN];
   int r;
+  bool threaded;
+  bool build[MAX_CLIENTS];
 
   msglen = 0;
 
   // read the next demo message if needed
-  if(sv.state == ss_demo && sv.demofile) {
+  if(sv.state == ss_demo && sv.demoreader) {
+    if(sv_paused->value)
+      msglen = 0;
+    else {
+      sizebuf_t msg;
+
+      if(!SV_DemoReadPlayback(sv.demoreader, &msg)) {
+        SV_DemoCompleted();
+        return;
+      }
+      msglen = msg.cursize;
+      if(msglen > MAX_MSGLEN)
+        Com_Error(ERR_DROP, "SV_SendClientMessages: msglen > MAX_MSGLEN");
+      memcpy(msgbuf, msg.data, msglen);
+    }
+  } else if(sv.state == ss_demo && sv.demofile) {
     if(sv_paused->value)
       msglen = 0;
     else {
@@ -480,6 +619,23 @@ void SV_SendClientMessages(void) {
     }
   }
 
+  // build all the frames up front on the snapshot workers.  Dropping an
+  // overflowed client runs game code that can change what the clients
+  // after it see, so fall back to building in order when that happens.
+  threaded = sv.state == ss_game && sv_snapshot_threads->value > 0;
+  for(i = 0, c = svs.clients; threaded && i < maxclients->value; i++, c++) {
+    if(c->state && c->netchan.message.overflowed)
+      threaded = false;
+  }
+
+  if(threaded) {
+    for(i = 0, c = svs.clients; i < maxclients->value; i++, c++)
+      build[i] = c->state == cs_spawned && !SV_RateDrop(c); // don't overrun bandwidth
+    Prof_Begin("SV_BuildClientFrames");
+    SV_BuildClientFrames(build);
+    Prof_End();
+  }
+
   // send a message to each connected client
   for(i = 0, c = svs.clients; i < maxclients->value; i++, c++) {
     if(!c->state)
@@ -496,11 +652,22 @@ void SV_SendClientMessages(void) {
     if(sv.state == ss_cinematic || sv.state == ss_demo || sv.state == ss_pic)
       Netchan_Transmit(&c->netchan, msglen, msgbuf);
     else if(c->state == cs_spawned) {
-      // don't overrun bandwidth
-      if(SV_RateDrop(c))
-        continue;
+      if(threaded) {
+        if(!build[i])
+          continue;
+      } else {
+        // don't overrun bandwidth
+        if(SV_RateDrop(c))
+          continue;
+
+        Prof_Begin("SV_BuildClientFrame");
+        SV_BuildClientFrame(c);
+        Prof_End();
+      }
 
+      Prof_Begin("SV_SendClientDatagram");
       SV_SendClientDatagram(c);
+      Prof_End();
     } else {
       // just update reliable	if needed
       if(c->netchan.message.cursize || curtime - c->netchan.last_sent > 1000)
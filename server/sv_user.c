@@ -40,6 +40,22 @@ SV_BeginDemoServer
 void SV_BeginDemoserver (void)
 {
 	char		name[MAX_OSPATH];
+	int			l;
+
+	// serverrecord demos are read from the game directory, a block at a time
+	l = strlen (sv.name);
+	if (l > 4 && !strcmp (sv.name + l - 4, ".svd"))
+	{
+		if (sv.demoreader)
+			SV_DemoCloseReader (sv.demoreader);
+		Com_sprintf (name, sizeof(name), "%s/demos/%s", FS_Gamedir(), sv.name);
+		sv.demoreader = SV_DemoOpen (name);
+		if (!sv.demoreader)
+			Com_Error (ERR_DROP, "Couldn't open %s\n", name);
+		// play back at the rate it was recorded
+		sv.frametime = SV_DemoFrameTime (sv.demoreader);
+		return;
+	}
 
 	Com_sprintf (name, sizeof(name), "demos/%s", sv.name);
 	FS_FOpenFile (name, &sv.demofile);
@@ -84,7 +100,7 @@ void SV_New_f (void)
 
 	// send the serverdata
 	MSG_WriteByte (&sv_client->netchan.message, svc_serverdata);
-	MSG_WriteLong (&sv_client->netchan.message, PROTOCOL_VERSION);
+	MSG_WriteLong (&sv_client->netchan.message, sv_client->protocol);
 	MSG_WriteLong (&sv_client->netchan.message, svs.spawncount);
 	MSG_WriteByte (&sv_client->netchan.message, sv.attractloop);
 	MSG_WriteString (&sv_client->netchan.message, gamedir);
@@ -211,7 +227,10 @@ void SV_Baselines_f (void)
 		if (base->modelindex || base->sound || base->effects)
 		{
 			MSG_WriteByte (&sv_client->netchan.message, svc_spawnbaseline);
-			MSG_WriteDeltaEntity (&nullstate, base, &sv_client->netchan.message, true, true);
+			if (sv_client->protocol == PROTOCOL_VERSION)
+				MSG_WritePackedDeltaEntity (&nullstate, base, &sv_client->netchan.message, true, true);
+			else
+				MSG_WriteDeltaEntity (&nullstate, base, &sv_client->netchan.message, true, true);
 		}
 		start++;
 	}
@@ -591,7 +610,7 @@ void SV_ExecuteClientMessage (client_t *cl)
 				cl->lastframe = lastframe;
 				if (cl->lastframe > 0) {
 					cl->frame_latency[cl->lastframe&(LATENCY_COUNTS-1)] =
-						svs.realtime - cl->frames[cl->lastframe & UPDATE_MASK].senttime;
+						svs.realtime - cl->frames[cl->lastframe % svs.update_backup].senttime;
 				}
 			}
 
@@ -21,6 +21,8 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 #include "server.h"
 
+#include <uv.h>
+
 /*
 ===============================================================================
 
@@ -51,10 +53,39 @@ typedef struct areanode_s {
 areanode_t sv_areanodes[CMODEL_COUNT][AREA_NODES];
 int sv_numareanodes[CMODEL_COUNT];
 
+// loose grid: entities are filed in the cell holding the center of their
+// box, and anything up to half a cell wide fits, so a query only has to
+// grow by half a cell to find them.  Bigger entities go on the oversize
+// lists that every query walks.
+#define GRID_CELLS 64
+#define GRID_MIN_CELLSIZE 64
+
+typedef struct {
+  float origin[2];
+  float cellsize;
+  int size[2];
+  link_t trigger_edicts[GRID_CELLS * GRID_CELLS];
+  link_t solid_edicts[GRID_CELLS * GRID_CELLS];
+  link_t oversize_trigger_edicts;
+  link_t oversize_solid_edicts;
+} areagrid_t;
+
+areagrid_t sv_areagrids[CMODEL_COUNT];
+
+// the broadphase used for a collision map is picked from sv_broadphase
+// when the world is cleared
+typedef struct {
+  char *name;
+  void (*clear)(int cmodel_index, vec3_t mins, vec3_t maxs);
+  void (*link)(int cmodel_index, edict_t *ent);
+  void (*query)(int cmodel_index);
+} broadphase_t;
+
 float *area_mins, *area_maxs;
 edict_t **area_list;
 int area_count, area_maxcount;
 int area_type;
+int area_tested; // entities looked at by queries, for sv_broadphase_bench
 
 int SV_HullForEntity(edict_t *ent);
 
@@ -117,6 +148,539 @@ areanode_t *SV_CreateAreaNode(int cmodel_index, int depth, vec3_t mins, vec3_t m
   return anode;
 }
 
+/*
+====================
+SV_AreaEdictsList
+
+Adds the edicts on one list that touch the query box.
+Returns false when the output list is full.
+====================
+*/
+static bool SV_AreaEdictsList(link_t *start) {
+  link_t *l, *next;
+  edict_t *check;
+
+  for(l = start->next; l != start; l = next) {
+    next = l->next;
+    check = EDICT_FROM_AREA(l);
+    area_tested++;
+
+    if(check->solid == SOLID_NOT)
+      continue; // deactivated
+    if(check->absmin[0] > area_maxs[0] || check->absmin[1] > area_maxs[1] || check->absmin[2] > area_maxs[2] ||
+       check->absmax[0] < area_mins[0] || check->absmax[1] < area_mins[1] || check->absmax[2] < area_mins[2])
+      continue; // not touching
+
+    if(area_count == area_maxcount) {
+      Com_Printf("SV_AreaEdicts: MAXCOUNT\n");
+      return false;
+    }
+
+    area_list[area_count] = check;
+    area_count++;
+  }
+
+  return true;
+}
+
+static void SV_AreaNodeClear(int cmodel_index, vec3_t mins, vec3_t maxs) {
+  memset(sv_areanodes[cmodel_index], 0, sizeof(sv_areanodes[0]));
+  sv_numareanodes[cmodel_index] = 0;
+  SV_CreateAreaNode(cmodel_index, 0, mins, maxs);
+}
+
+static void SV_AreaNodeLink(int cmodel_index, edict_t *ent) {
+  areanode_t *node;
+
+  // find the first node that the ent's box crosses
+  node = sv_areanodes[cmodel_index];
+  while(1) {
+    if(node->axis == -1)
+      break;
+    if(ent->absmin[node->axis] > node->dist)
+      node = node->children[0];
+    else if(ent->absmax[node->axis] < node->dist)
+      node = node->children[1];
+    else
+      break; // crosses the node
+  }
+
+  // link it in
+  if(ent->solid == SOLID_TRIGGER)
+    InsertLinkBefore(&ent->area, &node->trigger_edicts);
+  else
+    InsertLinkBefore(&ent->area, &node->solid_edicts);
+}
+
+/*
+====================
+SV_AreaEdicts_r
+
+====================
+*/
+static void SV_AreaEdicts_r(areanode_t *node) {
+  // touch linked edicts
+  if(!SV_AreaEdictsList(area_type == AREA_SOLID ? &node->solid_edicts : &node->trigger_edicts))
+    return;
+
+  if(node->axis == -1)
+    return; // terminal node
+
+  // recurse down both sides
+  if(area_maxs[node->axis] > node->dist)
+    SV_AreaEdicts_r(node->children[0]);
+  if(area_mins[node->axis] < node->dist)
+    SV_AreaEdicts_r(node->children[1]);
+}
+
+static void SV_AreaNodeQuery(int cmodel_index) { SV_AreaEdicts_r(sv_areanodes[cmodel_index]); }
+
+/*
+===============
+SV_AreaGridClear
+
+Covers the world with at most GRID_CELLS x GRID_CELLS square cells
+===============
+*/
+static void SV_AreaGridClear(int cmodel_index, vec3_t mins, vec3_t maxs) {
+  areagrid_t *grid = &sv_areagrids[cmodel_index];
+  float extent;
+  int i;
+
+  extent = maxs[0] - mins[0];
+  if(maxs[1] - mins[1] > extent)
+    extent = maxs[1] - mins[1];
+  grid->cellsize = ceil(extent / GRID_CELLS);
+  if(grid->cellsize < GRID_MIN_CELLSIZE)
+    grid->cellsize = GRID_MIN_CELLSIZE;
+
+  for(i = 0; i < 2; i++) {
+    grid->origin[i] = mins[i];
+    grid->size[i] = ceil((maxs[i] - mins[i]) / grid->cellsize);
+    if(grid->size[i] < 1)
+      grid->size[i] = 1;
+    if(grid->size[i] > GRID_CELLS)
+      grid->size[i] = GRID_CELLS;
+  }
+
+  for(i = 0; i < GRID_CELLS * GRID_CELLS; i++) {
+    ClearLink(&grid->trigger_edicts[i]);
+    ClearLink(&grid->solid_edicts[i]);
+  }
+  ClearLink(&grid->oversize_trigger_edicts);
+  ClearLink(&grid->oversize_solid_edicts);
+}
+
+// cells outside the world are folded onto the border cells, which keeps
+// the mapping monotonic so a query can never miss a clamped entity
+static int SV_AreaGridCell(areagrid_t *grid, int axis, float v) {
+  int c;
+
+  c = floor((v - grid->origin[axis]) / grid->cellsize);
+  if(c < 0)
+    return 0;
+  if(c >= grid->size[axis])
+    return grid->size[axis] - 1;
+  return c;
+}
+
+static void SV_AreaGridLink(int cmodel_index, edict_t *ent) {
+  areagrid_t *grid = &sv_areagrids[cmodel_index];
+  int cell;
+
+  if(ent->absmax[0] - ent->absmin[0] > grid->cellsize || ent->absmax[1] - ent->absmin[1] > grid->cellsize) {
+    if(ent->solid == SOLID_TRIGGER)
+      InsertLinkBefore(&ent->area, &grid->oversize_trigger_edicts);
+    else
+      InsertLinkBefore(&ent->area, &grid->oversize_solid_edicts);
+    return;
+  }
+
+  cell = SV_AreaGridCell(grid, 1, ent->absmin[1] + (ent->absmax[1] - ent->absmin[1]) * 0.5f) * GRID_CELLS +
+         SV_AreaGridCell(grid, 0, ent->absmin[0] + (ent->absmax[0] - ent->absmin[0]) * 0.5f);
+
+  if(ent->solid == SOLID_TRIGGER)
+    InsertLinkBefore(&ent->area, &grid->trigger_edicts[cell]);
+  else
+    InsertLinkBefore(&ent->area, &grid->solid_edicts[cell]);
+}
+
+static void SV_AreaGridQuery(int cmodel_index) {
+  areagrid_t *grid = &sv_areagrids[cmodel_index];
+  link_t *lists;
+  float half;
+  int x0, x1, y0, y1;
+  int x, y;
+
+  half = 0.5f * grid->cellsize;
+  x0 = SV_AreaGridCell(grid, 0, area_mins[0] - half);
+  x1 = SV_AreaGridCell(grid, 0, area_maxs[0] + half);
+  y0 = SV_AreaGridCell(grid, 1, area_mins[1] - half);
+  y1 = SV_AreaGridCell(grid, 1, area_maxs[1] + half);
+
+  if(area_type == AREA_SOLID) {
+    lists = grid->solid_edicts;
+    if(!SV_AreaEdictsList(&grid->oversize_solid_edicts))
+      return;
+  } else {
+    lists = grid->trigger_edicts;
+    if(!SV_AreaEdictsList(&grid->oversize_trigger_edicts))
+      return;
+  }
+
+  for(y = y0; y <= y1; y++)
+    for(x = x0; x <= x1; x++)
+      if(!SV_AreaEdictsList(&lists[y * GRID_CELLS + x]))
+        return;
+}
+
+static broadphase_t sv_broadphases[] = {
+    {"areanode", SV_AreaNodeClear, SV_AreaNodeLink, SV_AreaNodeQuery},
+    {"grid", SV_AreaGridClear, SV_AreaGridLink, SV_AreaGridQuery},
+};
+
+#define NUM_BROADPHASES (sizeof(sv_broadphases) / sizeof(sv_broadphases[0]))
+
+static broadphase_t *area_broadphase[CMODEL_COUNT];
+
+/*
+===============================================================================
+
+ENTITY CLUSTER INDEX
+
+Every linked entity is kept on a list for each PVS cluster it touched
+when it was last linked, separately for each collision map, so building
+a client frame only has to look at the entities in the visible clusters.
+Entities that touch too many leafs to have cluster numbers, and beams,
+which are checked against the PHS, go on a list of their own that is
+always looked at.
+===============================================================================
+*/
+
+typedef struct {
+  int prev, next; // node numbers, -1 = end of list
+  int cluster;    // -1 = unclustered list
+} clusternode_t;
+
+typedef struct {
+  int cmodel_index; // -1 = not indexed
+  int numnodes;
+} clusterent_t;
+
+static clusternode_t sv_clusternodes[MAX_EDICTS * MAX_ENT_CLUSTERS];
+static clusterent_t sv_clusterents[MAX_EDICTS];
+static int sv_clusterheads[CMODEL_COUNT][MAX_MAP_LEAFS];
+static int sv_unclustered[CMODEL_COUNT];
+
+static int *SV_ClusterHead(int cmodel_index, int cluster) {
+  if(cluster == -1)
+    return &sv_unclustered[cmodel_index];
+  return &sv_clusterheads[cmodel_index][cluster];
+}
+
+/*
+===============
+SV_ClearClusters
+===============
+*/
+static void SV_ClearClusters(int cmodel_index) {
+  int e;
+
+  memset(sv_clusterheads[cmodel_index], -1, sizeof(sv_clusterheads[0]));
+  sv_unclustered[cmodel_index] = -1;
+
+  for(e = 0; e < MAX_EDICTS; e++) {
+    if(sv_clusterents[e].cmodel_index == cmodel_index) {
+      sv_clusterents[e].cmodel_index = -1;
+      sv_clusterents[e].numnodes = 0;
+    }
+  }
+}
+
+/*
+===============
+SV_UnlinkClusters
+===============
+*/
+static void SV_UnlinkClusters(int e) {
+  clusterent_t *cent = &sv_clusterents[e];
+  clusternode_t *node;
+  int i, n;
+
+  for(i = 0; i < cent->numnodes; i++) {
+    n = e * MAX_ENT_CLUSTERS + i;
+    node = &sv_clusternodes[n];
+    if(node->prev == -1)
+      *SV_ClusterHead(cent->cmodel_index, node->cluster) = node->next;
+    else
+      sv_clusternodes[node->prev].next = node->next;
+    if(node->next != -1)
+      sv_clusternodes[node->next].prev = node->prev;
+  }
+
+  cent->cmodel_index = -1;
+  cent->numnodes = 0;
+}
+
+static void SV_LinkCluster(int cmodel_index, int e, int cluster) {
+  clusterent_t *cent = &sv_clusterents[e];
+  clusternode_t *node;
+  int *head;
+  int n;
+
+  n = e * MAX_ENT_CLUSTERS + cent->numnodes++;
+  node = &sv_clusternodes[n];
+  head = SV_ClusterHead(cmodel_index, cluster);
+
+  node->cluster = cluster;
+  node->prev = -1;
+  node->next = *head;
+  if(*head != -1)
+    sv_clusternodes[*head].prev = n;
+  *head = n;
+}
+
+/*
+===============
+SV_LinkClusters
+
+Puts the entity on the lists for the clusters that SV_LinkEdict just
+found for it.  Unlinking an entity leaves its clusternums alone, so the
+entity stays indexed until it is linked again.
+===============
+*/
+static void SV_LinkClusters(edict_t *ent, int cmodel_index) {
+  int e, i;
+
+  e = NUM_FOR_EDICT(ent);
+  if(e < 0 || e >= MAX_EDICTS)
+    Com_Error(ERR_DROP, "SV_LinkClusters: bad edict number %i", e);
+
+  SV_UnlinkClusters(e);
+  sv_clusterents[e].cmodel_index = cmodel_index;
+
+  if(ent->num_clusters == -1 || (ent->s.renderfx & RF_BEAM)) {
+    SV_LinkCluster(cmodel_index, e, -1);
+    return;
+  }
+
+  for(i = 0; i < ent->num_clusters; i++)
+    SV_LinkCluster(cmodel_index, e, ent->clusternums[i]);
+}
+
+/*
+===============
+SV_ClusterEdicts
+
+Sets the bit in edictbits for every entity indexed on one of the
+clusters set in visbits, and for every unclustered entity.  Only reads
+the index, so it is safe to call from the snapshot workers.
+===============
+*/
+void SV_ClusterEdicts(int cmodel_index, const byte *visbits, unsigned *edictbits) {
+  int numclusters;
+  int cluster;
+  int n;
+
+  for(n = sv_unclustered[cmodel_index]; n != -1; n = sv_clusternodes[n].next)
+    edictbits[n / MAX_ENT_CLUSTERS >> 5] |= 1u << ((n / MAX_ENT_CLUSTERS) & 31);
+
+  numclusters = CM_NumClusters(cmodel_index);
+  for(cluster = 0; cluster < numclusters; cluster++) {
+    if(!visbits[cluster >> 3]) {
+      cluster |= 7; // skip the whole byte
+      continue;
+    }
+    if(!(visbits[cluster >> 3] & (1 << (cluster & 7))))
+      continue;
+    for(n = sv_clusterheads[cmodel_index][cluster]; n != -1; n = sv_clusternodes[n].next)
+      edictbits[n / MAX_ENT_CLUSTERS >> 5] |= 1u << ((n / MAX_ENT_CLUSTERS) & 31);
+  }
+}
+
+/*
+===============================================================================
+
+CLIENT LEAF GROUPS
+
+The cluster and area at every client's origin, kept for SV_Multicast.
+Clients on the same collision map in the same cluster and area share a
+group holding a bitmask of its members, so a multicast makes one PVS
+and area test per occupied group instead of three leaf lookups per
+client.  A client is looked up again whenever its edict is linked, and
+once a frame in case the game moved it without relinking.
+===============================================================================
+*/
+
+typedef struct {
+  bool indexed;
+  int cmodel_index;
+  int cluster;
+  int area;
+  int group;
+} clientleaf_t;
+
+typedef struct {
+  int cluster;
+  int area;
+  int numclients;
+  unsigned clients[MAX_CLIENTS / 32];
+} clientgroup_t;
+
+static clientleaf_t sv_clientleafs[MAX_CLIENTS];
+static clientgroup_t sv_clientgroups[CMODEL_COUNT][MAX_CLIENTS];
+static int sv_numclientgroups[CMODEL_COUNT];
+
+/*
+===============
+SV_ClearClientLeafs
+===============
+*/
+static void SV_ClearClientLeafs(int cmodel_index) {
+  int c;
+
+  for(c = 0; c < MAX_CLIENTS; c++)
+    if(sv_clientleafs[c].indexed && sv_clientleafs[c].cmodel_index == cmodel_index)
+      sv_clientleafs[c].indexed = false;
+  sv_numclientgroups[cmodel_index] = 0;
+}
+
+/*
+===============
+SV_RemoveClientLeaf
+
+Takes the client out of its group, an emptied group is replaced by the
+last one on the same collision map
+===============
+*/
+static void SV_RemoveClientLeaf(int c) {
+  clientleaf_t *leaf = &sv_clientleafs[c];
+  clientgroup_t *groups, *group;
+  int last, i;
+
+  if(!leaf->indexed)
+    return;
+  leaf->indexed = false;
+
+  groups = sv_clientgroups[leaf->cmodel_index];
+  group = &groups[leaf->group];
+  group->clients[c >> 5] &= ~(1u << (c & 31));
+  if(--group->numclients)
+    return;
+
+  last = --sv_numclientgroups[leaf->cmodel_index];
+  if(leaf->group == last)
+    return;
+
+  *group = groups[last];
+  for(i = 0; i < MAX_CLIENTS; i++)
+    if(group->clients[i >> 5] & (1u << (i & 31)))
+      sv_clientleafs[i].group = leaf->group;
+}
+
+/*
+===============
+SV_SetClientLeaf
+===============
+*/
+static void SV_SetClientLeaf(int c, int cmodel_index, vec3_t origin) {
+  clientleaf_t *leaf = &sv_clientleafs[c];
+  clientgroup_t *groups;
+  int leafnum, cluster, area;
+  int g;
+
+  if(cmodel_index < 0 || cmodel_index >= CMODEL_COUNT) {
+    SV_RemoveClientLeaf(c);
+    return;
+  }
+
+  leafnum = CM_PointLeafnum(cmodel_index, origin);
+  cluster = CM_LeafCluster(cmodel_index, leafnum);
+  area = CM_LeafArea(cmodel_index, leafnum);
+
+  if(leaf->indexed && leaf->cmodel_index == cmodel_index && leaf->cluster == cluster && leaf->area == area)
+    return;
+
+  SV_RemoveClientLeaf(c);
+
+  groups = sv_clientgroups[cmodel_index];
+  for(g = 0; g < sv_numclientgroups[cmodel_index]; g++)
+    if(groups[g].cluster == cluster && groups[g].area == area)
+      break;
+
+  if(g == sv_numclientgroups[cmodel_index]) {
+    memset(&groups[g], 0, sizeof(groups[g]));
+    groups[g].cluster = cluster;
+    groups[g].area = area;
+    sv_numclientgroups[cmodel_index]++;
+  }
+
+  groups[g].clients[c >> 5] |= 1u << (c & 31);
+  groups[g].numclients++;
+
+  leaf->indexed = true;
+  leaf->cmodel_index = cmodel_index;
+  leaf->cluster = cluster;
+  leaf->area = area;
+  leaf->group = g;
+}
+
+/*
+===============
+SV_LinkClientLeaf
+===============
+*/
+static void SV_LinkClientLeaf(edict_t *ent) {
+  int c;
+
+  c = NUM_FOR_EDICT(ent) - 1;
+  if(c < 0 || c >= maxclients->value)
+    return;
+
+  SV_SetClientLeaf(c, ent->s.cmodel_index, ent->s.origin);
+}
+
+/*
+===============
+SV_UpdateClientLeafs
+===============
+*/
+void SV_UpdateClientLeafs(void) {
+  client_t *client;
+  int c;
+
+  for(c = 0, client = svs.clients; c < maxclients->value; c++, client++) {
+    if(client->state == cs_free || !client->edict)
+      SV_RemoveClientLeaf(c);
+    else
+      SV_SetClientLeaf(c, client->edict->s.cmodel_index, client->edict->s.origin);
+  }
+}
+
+/*
+===============
+SV_ClusterClients
+
+Sets the bit in clientbits for every client on the collision map whose
+cluster is set in visbits and whose area is connected to area.  Clients
+in a solid leaf have no cluster and are never set.
+===============
+*/
+void SV_ClusterClients(int cmodel_index, int area, const byte *visbits, unsigned *clientbits) {
+  clientgroup_t *group;
+  int g, i;
+
+  for(g = 0; g < sv_numclientgroups[cmodel_index]; g++) {
+    group = &sv_clientgroups[cmodel_index][g];
+    if(group->cluster < 0 || !(visbits[group->cluster >> 3] & (1 << (group->cluster & 7))))
+      continue;
+    if(!CM_AreasConnected(cmodel_index, area, group->area))
+      continue;
+    for(i = 0; i < MAX_CLIENTS / 32; i++)
+      clientbits[i] |= group->clients[i];
+  }
+}
+
 /*
 ===============
 SV_ClearWorld
@@ -124,9 +688,16 @@ SV_ClearWorld
 ===============
 */
 void SV_ClearWorld(int cmodel_index) {
-  memset(sv_areanodes[cmodel_index], 0, sizeof(sv_areanodes[0]));
-  sv_numareanodes[cmodel_index] = 0;
-  SV_CreateAreaNode(cmodel_index, 0, sv.models[CMODEL_A][0]->mins, sv.models[CMODEL_A][0]->maxs);
+  int type;
+
+  type = sv_broadphase->value;
+  if(type < 0 || type >= NUM_BROADPHASES)
+    type = 0;
+  area_broadphase[cmodel_index] = &sv_broadphases[type];
+
+  area_broadphase[cmodel_index]->clear(cmodel_index, sv.models[CMODEL_A][0]->mins, sv.models[CMODEL_A][0]->maxs);
+  SV_ClearClusters(cmodel_index);
+  SV_ClearClientLeafs(cmodel_index);
 }
 
 /*
@@ -150,7 +721,6 @@ SV_LinkEdict
 */
 #define MAX_TOTAL_ENT_LEAFS 128
 void SV_LinkEdict(edict_t *ent) {
-  areanode_t *node;
   int leafs[MAX_TOTAL_ENT_LEAFS];
   int clusters[MAX_TOTAL_ENT_LEAFS];
   int num_leafs;
@@ -278,6 +848,9 @@ void SV_LinkEdict(edict_t *ent) {
     }
   }
 
+  SV_LinkClusters(ent, cmodel_index);
+  SV_LinkClientLeaf(ent);
+
   // if first time, make sure old_origin is valid
   if(!ent->linkcount) {
     VectorCopy(ent->s.origin, ent->s.old_origin);
@@ -287,90 +860,230 @@ void SV_LinkEdict(edict_t *ent) {
   if(ent->solid == SOLID_NOT)
     return;
 
-  // find the first node that the ent's box crosses
-  node = sv_areanodes[cmodel_index];
-  while(1) {
-    if(node->axis == -1)
-      break;
-    if(ent->absmin[node->axis] > node->dist)
-      node = node->children[0];
-    else if(ent->absmax[node->axis] < node->dist)
-      node = node->children[1];
-    else
-      break; // crosses the node
-  }
+  area_broadphase[cmodel_index]->link(cmodel_index, ent);
+}
 
-  // link it in
-  if(ent->solid == SOLID_TRIGGER)
-    InsertLinkBefore(&ent->area, &node->trigger_edicts);
-  else
-    InsertLinkBefore(&ent->area, &node->solid_edicts);
+/*
+================
+SV_AreaEdicts
+================
+*/
+int SV_AreaEdicts(int cmodel_index, vec3_t mins, vec3_t maxs, edict_t **list, int maxcount, int areatype) {
+  area_mins = mins;
+  area_maxs = maxs;
+  area_list = list;
+  area_count = 0;
+  area_maxcount = maxcount;
+  area_type = areatype;
+
+  area_broadphase[cmodel_index]->query(cmodel_index);
+
+  return area_count;
+}
+
+static int SV_CompareEdicts(const void *a, const void *b) {
+  const edict_t *ea = *(edict_t *const *)a;
+  const edict_t *eb = *(edict_t *const *)b;
+
+  return ea < eb ? -1 : ea > eb;
+}
+
+static bool SV_EdictInSphere(edict_t *check, vec3_t origin, float radius) {
+  vec3_t eorg;
+  int j;
+
+  for(j = 0; j < 3; j++)
+    eorg[j] = origin[j] - (check->s.origin[j] + (check->mins[j] + check->maxs[j]) * 0.5);
+  return VectorLength(eorg) <= radius;
 }
 
 /*
-====================
-SV_AreaEdicts_r
+================
+SV_SphereEdicts
 
-====================
+The box around the sphere goes through the broadphase for both lists,
+every linked entity with a center inside the sphere has a box touching
+that box
+================
 */
-void SV_AreaEdicts_r(areanode_t *node) {
-  link_t *l, *next, *start;
-  edict_t *check;
-  int count;
+int SV_SphereEdicts(int cmodel_index, vec3_t origin, float radius, edict_t **list, int maxcount) {
+  vec3_t mins, maxs;
+  int count, found;
+  int i, t;
+
+  if(cmodel_index < 0 || cmodel_index >= CMODEL_COUNT || !area_broadphase[cmodel_index])
+    return 0;
+
+  for(i = 0; i < 3; i++) {
+    mins[i] = origin[i] - radius;
+    maxs[i] = origin[i] + radius;
+  }
 
   count = 0;
+  for(t = AREA_SOLID; t <= AREA_TRIGGERS && count < maxcount; t++)
+    count += SV_AreaEdicts(cmodel_index, mins, maxs, list + count, maxcount - count, t);
 
-  // touch linked edicts
-  if(area_type == AREA_SOLID)
-    start = &node->solid_edicts;
-  else
-    start = &node->trigger_edicts;
+  found = 0;
+  for(i = 0; i < count; i++)
+    if(SV_EdictInSphere(list[i], origin, radius))
+      list[found++] = list[i];
 
-  for(l = start->next; l != start; l = next) {
-    next = l->next;
-    check = EDICT_FROM_AREA(l);
+  qsort(list, found, sizeof(list[0]), SV_CompareEdicts);
 
-    if(check->solid == SOLID_NOT)
-      continue; // deactivated
-    if(check->absmin[0] > area_maxs[0] || check->absmin[1] > area_maxs[1] || check->absmin[2] > area_maxs[2] ||
-       check->absmax[0] < area_mins[0] || check->absmax[1] < area_mins[1] || check->absmax[2] < area_mins[2])
-      continue; // not touching
+  return found;
+}
 
-    if(area_count == area_maxcount) {
-      Com_Printf("SV_AreaEdicts: MAXCOUNT\n");
-      return;
-    }
+/*
+================
+SV_RadiusBench_f
 
-    area_list[area_count] = check;
-    area_count++;
+A findradius around every linked entity on a collision map, first by
+walking every edict the way the game used to and then through
+SV_SphereEdicts.  Fill a map with grenades or monsters before running it.
+================
+*/
+void SV_RadiusBench_f(void) {
+  static edict_t *ents[MAX_EDICTS];
+  static edict_t *touch[MAX_EDICTS];
+  int cmodel_index;
+  int numents, iterations;
+  int i, j, e;
+  int results;
+  float radius;
+  uint64_t start, elapsed;
+  edict_t *check;
+
+  if(sv.state != ss_game) {
+    Com_Printf("No map loaded.\n");
+    return;
   }
 
-  if(node->axis == -1)
-    return; // terminal node
+  cmodel_index = Cmd_Argc() > 1 ? atoi(Cmd_Argv(1)) : CMODEL_A;
+  if(cmodel_index < 0 || cmodel_index >= CMODEL_COUNT || !area_broadphase[cmodel_index]) {
+    Com_Printf("usage: sv_radius_bench [cmodel_index] [radius] [iterations]\n");
+    return;
+  }
+  radius = Cmd_Argc() > 2 ? atof(Cmd_Argv(2)) : 256;
+  iterations = Cmd_Argc() > 3 ? atoi(Cmd_Argv(3)) : 100;
+  if(iterations < 1)
+    iterations = 1;
+
+  numents = 0;
+  for(i = 1; i < ge->num_edicts && numents < MAX_EDICTS; i++) {
+    check = EDICT_NUM(i);
+    if(!check->inuse || !check->area.prev || check->s.cmodel_index != cmodel_index)
+      continue;
+    ents[numents++] = check;
+  }
 
-  // recurse down both sides
-  if(area_maxs[node->axis] > node->dist)
-    SV_AreaEdicts_r(node->children[0]);
-  if(area_mins[node->axis] < node->dist)
-    SV_AreaEdicts_r(node->children[1]);
+  Com_Printf("%i linked entities, radius %g, %i iterations\n", numents, radius, iterations);
+  Com_Printf("name       queries   found      msec\n");
+
+  results = 0;
+  start = uv_hrtime();
+  for(j = 0; j < iterations; j++) {
+    for(i = 0; i < numents; i++) {
+      for(e = 1; e < ge->num_edicts; e++) {
+        check = EDICT_NUM(e);
+        if(!check->inuse || check->solid == SOLID_NOT || check->s.cmodel_index != cmodel_index)
+          continue;
+        if(SV_EdictInSphere(check, ents[i]->s.origin, radius))
+          results++;
+      }
+    }
+  }
+  elapsed = uv_hrtime() - start;
+  Com_Printf("%-8s %9i %7i %9.3f\n", "linear", numents * iterations, results / iterations, elapsed / 1000000.0);
+
+  results = 0;
+  start = uv_hrtime();
+  for(j = 0; j < iterations; j++)
+    for(i = 0; i < numents; i++)
+      results += SV_SphereEdicts(cmodel_index, ents[i]->s.origin, radius, touch, MAX_EDICTS);
+  elapsed = uv_hrtime() - start;
+  Com_Printf("%-8s %9i %7i %9.3f\n", "sphere", numents * iterations, results / iterations, elapsed / 1000000.0);
 }
 
 /*
 ================
-SV_AreaEdicts
+SV_BroadphaseBench_f
+
+Takes the current layout of the entities on a collision map and times
+the same set of box queries against every broadphase.  The entities are
+relinked into the broadphase that was in use when done, list order may
+differ from before.
 ================
 */
-int SV_AreaEdicts(int cmodel_index, vec3_t mins, vec3_t maxs, edict_t **list, int maxcount, int areatype) {
-  area_mins = mins;
-  area_maxs = maxs;
-  area_list = list;
-  area_count = 0;
-  area_maxcount = maxcount;
-  area_type = areatype;
+void SV_BroadphaseBench_f(void) {
+  static edict_t *ents[MAX_EDICTS];
+  static edict_t *touch[MAX_EDICTS];
+  broadphase_t *saved;
+  int cmodel_index;
+  int numents, iterations;
+  int b, i, j, t;
+  int results;
+  uint64_t start, elapsed;
+  vec3_t mins, maxs;
+  edict_t *ent;
+
+  if(sv.state != ss_game) {
+    Com_Printf("No map loaded.\n");
+    return;
+  }
 
-  SV_AreaEdicts_r(sv_areanodes[cmodel_index]);
+  cmodel_index = Cmd_Argc() > 1 ? atoi(Cmd_Argv(1)) : CMODEL_A;
+  if(cmodel_index < 0 || cmodel_index >= CMODEL_COUNT || !area_broadphase[cmodel_index]) {
+    Com_Printf("usage: sv_broadphase_bench [cmodel_index] [iterations]\n");
+    return;
+  }
+  iterations = Cmd_Argc() > 2 ? atoi(Cmd_Argv(2)) : 100;
+  if(iterations < 1)
+    iterations = 1;
+
+  // record the layout
+  numents = 0;
+  for(i = 1; i < ge->num_edicts && numents < MAX_EDICTS; i++) {
+    ent = EDICT_NUM(i);
+    if(!ent->inuse || !ent->area.prev || ent->s.cmodel_index != cmodel_index)
+      continue;
+    ents[numents++] = ent;
+  }
 
-  return area_count;
+  Com_Printf("%i linked entities, %i iterations\n", numents, iterations);
+  Com_Printf("name       queries   tested   found      msec\n");
+
+  saved = area_broadphase[cmodel_index];
+  for(b = 0; b <= NUM_BROADPHASES; b++) {
+    // the last pass just puts everything back where it was
+    area_broadphase[cmodel_index] = b < NUM_BROADPHASES ? &sv_broadphases[b] : saved;
+    area_broadphase[cmodel_index]->clear(cmodel_index, sv.models[CMODEL_A][0]->mins, sv.models[CMODEL_A][0]->maxs);
+    for(i = 0; i < numents; i++) {
+      ents[i]->area.prev = ents[i]->area.next = NULL;
+      area_broadphase[cmodel_index]->link(cmodel_index, ents[i]);
+    }
+    if(b == NUM_BROADPHASES)
+      break;
+
+    // one solid and one trigger query around every entity, about
+    // the size of a move
+    area_tested = 0;
+    results = 0;
+    start = uv_hrtime();
+    for(j = 0; j < iterations; j++) {
+      for(i = 0; i < numents; i++) {
+        VectorSet(mins, -64, -64, -64);
+        VectorSet(maxs, 64, 64, 64);
+        VectorAdd(mins, ents[i]->absmin, mins);
+        VectorAdd(maxs, ents[i]->absmax, maxs);
+        for(t = AREA_SOLID; t <= AREA_TRIGGERS; t++)
+          results += SV_AreaEdicts(cmodel_index, mins, maxs, touch, MAX_EDICTS, t);
+      }
+    }
+    elapsed = uv_hrtime() - start;
+
+    Com_Printf("%-8s %9i %8i %7i %9.3f\n", sv_broadphases[b].name, numents * iterations * 2, area_tested / iterations,
+               results / iterations, elapsed / 1000000.0);
+  }
 }
 
 //===========================================================================
@@ -537,27 +1250,18 @@ boxmaxs[0] = boxmaxs[1] = boxmaxs[2] = 9999;
 
 /*
 ==================
-SV_Trace
-
-Moves the given mins/maxs volume through the world from start to end.
-
-Passedict and edicts owned by passedict are explicitly not checked.
+SV_ClipTraceToEntities
 
+Finishes a trace that has already been clipped against the world
 ==================
 */
-trace_t SV_Trace(int cmodel_index, vec3_t start, vec3_t mins, vec3_t maxs, vec3_t end, edict_t *passedict,
-                 int contentmask) {
+static trace_t SV_ClipTraceToEntities(int cmodel_index, trace_t worldtrace, vec3_t start, vec3_t mins, vec3_t maxs,
+                                      vec3_t end, edict_t *passedict, int contentmask) {
   moveclip_t clip;
 
-  if(!mins)
-    mins = vec3_origin;
-  if(!maxs)
-    maxs = vec3_origin;
-
   memset(&clip, 0, sizeof(moveclip_t));
 
-  // clip to world
-  clip.trace = CM_BoxTrace(cmodel_index, start, end, mins, maxs, 0, contentmask);
+  clip.trace = worldtrace;
   clip.trace.ent = ge->edicts;
   if(clip.trace.fraction == 0)
     return clip.trace; // blocked by the world
@@ -580,3 +1284,47 @@ trace_t SV_Trace(int cmodel_index, vec3_t start, vec3_t mins, vec3_t maxs, vec3_
 
   return clip.trace;
 }
+
+/*
+==================
+SV_Trace
+
+Moves the given mins/maxs volume through the world from start to end.
+
+Passedict and edicts owned by passedict are explicitly not checked.
+
+==================
+*/
+trace_t SV_Trace(int cmodel_index, vec3_t start, vec3_t mins, vec3_t maxs, vec3_t end, edict_t *passedict,
+                 int contentmask) {
+  if(!mins)
+    mins = vec3_origin;
+  if(!maxs)
+    maxs = vec3_origin;
+
+  // clip to world
+  return SV_ClipTraceToEntities(cmodel_index, CM_BoxTrace(cmodel_index, start, end, mins, maxs, 0, contentmask),
+                                start, mins, maxs, end, passedict, contentmask);
+}
+
+/*
+==================
+SV_TraceBatch
+
+Same as calling SV_Trace for each move, but the moves are clipped
+against the world together
+==================
+*/
+void SV_TraceBatch(int cmodel_index, int n, vec3_t *starts, vec3_t *ends, vec3_t mins, vec3_t maxs,
+                   edict_t *passedict, int contentmask, trace_t *out) {
+  int i;
+
+  if(!mins)
+    mins = vec3_origin;
+  if(!maxs)
+    maxs = vec3_origin;
+
+  CM_BoxTraceBatch(cmodel_index, n, starts, ends, mins, maxs, contentmask, out);
+  for(i = 0; i < n; i++)
+    out[i] = SV_ClipTraceToEntities(cmodel_index, out[i], starts[i], mins, maxs, ends[i], passedict, contentmask);
+}
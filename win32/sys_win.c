@@ -34,7 +34,9 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include <io.h>
 #include <stdio.h>
 
+#ifndef DEDICATED_ONLY
 #include <GLFW/glfw3.h>
+#endif
 
 #define MINIMUM_WIN_MEMORY 0x0a00000
 #define MAXIMUM_WIN_MEMORY 0x1000000
@@ -119,6 +121,7 @@ void WinError(void) {
 
 //================================================================
 
+#ifndef DEDICATED_ONLY
 static void windows_uv_idle_cb(uv_idle_t *handle) {
   extern GLFWwindow *glfw_window;
 
@@ -130,6 +133,7 @@ static void windows_uv_idle_cb(uv_idle_t *handle) {
 
   glfwPollEvents();
 }
+#endif
 
 /*
 ================
@@ -137,9 +141,13 @@ Sys_Init
 ================
 */
 void Sys_Init(void) {
+#ifndef DEDICATED_ONLY
+  // the window has to be pumped every time around the loop, a dedicated
+  // server has nothing to pump and lets the loop sleep
   static uv_idle_t windows_uv_idle;
   uv_idle_init(global_uv_loop(), &windows_uv_idle);
   uv_idle_start(&windows_uv_idle, windows_uv_idle_cb);
+#endif
 
   OSVERSIONINFO vinfo;
 
@@ -276,6 +284,7 @@ Send Key_Event calls
 ================
 */
 void Sys_SendKeyEvents(void) {
+#ifndef DEDICATED_ONLY
   extern GLFWwindow *glfw_window;
 
   if(glfw_window != NULL && glfwWindowShouldClose(glfw_window)) {
@@ -283,6 +292,7 @@ void Sys_SendKeyEvents(void) {
   }
 
   glfwPollEvents();
+#endif
 
   // grab frame time
   sys_frame_time = Sys_Milliseconds(); // FIXME: should this be at start?
@@ -515,6 +515,9 @@ static bool load_refresh_api(GetRefAPI_t get_api, const char *name) {
   ri.Vid_GetModeInfo = VID_GetModeInfo;
   ri.Vid_MenuInit = VID_MenuInit;
   ri.Vid_NewWindow = VID_NewWindow;
+  ri.Job_CreatePool = Job_CreatePool;
+  ri.Job_DestroyPool = Job_DestroyPool;
+  ri.Job_Run = Job_Run;
 
   re = get_api(ri);
 